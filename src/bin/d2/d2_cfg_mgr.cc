@@ -14,7 +14,6 @@
 
 #include <d2/d2_log.h>
 #include <d2/d2_cfg_mgr.h>
-#include <util/encode/hex.h>
 
 #include <boost/foreach.hpp>
 
@@ -138,27 +137,7 @@ D2CfgMgr::reverseV4Address(const isc::asiolink::IOAddress& ioaddr) {
                   << ioaddr);
     }
 
-    // Get the address in byte vector form.
-    const ByteAddress bytes = ioaddr.toBytes();
-
-    // Walk backwards through vector outputting each octet and a dot.
-    std::ostringstream stream;
-
-    // We have to set the following variable to get
-    // const_reverse_iterator type of rend(), otherwise Solaris GCC
-    // complains on operator!= by trying to use the non-const variant.
-    const ByteAddress::const_reverse_iterator end = bytes.rend();
-
-    for (ByteAddress::const_reverse_iterator rit = bytes.rbegin();
-         rit != end;
-         ++rit)
-    {
-        stream << static_cast<unsigned int>(*rit) << ".";
-    }
-
-    // Tack on the suffix and we're done.
-    stream << IPV4_REV_ZONE_SUFFIX;
-    return(stream.str());
+    return (reverseIpName(ioaddr).toText());
 }
 
 std::string
@@ -167,28 +146,16 @@ D2CfgMgr::reverseV6Address(const isc::asiolink::IOAddress& ioaddr) {
         isc_throw(D2CfgError, "D2Cfg address is not IPv6 address: " << ioaddr);
     }
 
-    // Turn the address into a string of digits.
-    const ByteAddress bytes = ioaddr.toBytes();
-    const std::string digits = isc::util::encode::encodeHex(bytes);
-
-    // Walk backwards through string outputting each digits and a dot.
-    std::ostringstream stream;
-
-    // We have to set the following variable to get
-    // const_reverse_iterator type of rend(), otherwise Solaris GCC
-    // complains on operator!= by trying to use the non-const variant.
-    const std::string::const_reverse_iterator end = digits.rend();
-
-    for (std::string::const_reverse_iterator rit = digits.rbegin();
-         rit != end;
-         ++rit)
-    {
-        stream << static_cast<char>(*rit) << ".";
-    }
+    return (reverseIpName(ioaddr).toText());
+}
 
-    // Tack on the suffix and we're done.
-    stream << IPV6_REV_ZONE_SUFFIX;
-    return(stream.str());
+dns::Name
+D2CfgMgr::reverseIpName(const isc::asiolink::IOAddress& ioaddr) {
+    // Get the address in byte vector form and build the name from it: one
+    // label per octet (IPv4) or per nibble (IPv6) in reverse order, followed
+    // by the suffix.
+    const ByteAddress bytes = ioaddr.toBytes();
+    return (dns::Name::reverseLookupName(&bytes[0], bytes.size()));
 }
 
 const D2ParamsPtr&
@@ -265,7 +232,8 @@ D2CfgMgr::buildParams(isc::data::ConstElementPtr params_config) {
                   << strings->getPosition("ncr_protocol") << ")");
     }
 
-    if (ncr_protocol != dhcp_ddns::NCR_UDP) {
+    if ((ncr_protocol != dhcp_ddns::NCR_UDP) &&
+        (ncr_protocol != dhcp_ddns::NCR_SHM)) {
         isc_throw(D2CfgError, "ncr_protocol : "
                   << dhcp_ddns::ncrProtocolToString(ncr_protocol)
                   << " is not yet supported ("
@@ -286,17 +254,28 @@ D2CfgMgr::buildParams(isc::data::ConstElementPtr params_config) {
                   << strings->getPosition("ncr_format") << ")");
     }
 
-    if (ncr_format != dhcp_ddns::FMT_JSON) {
+    if ((ncr_format != dhcp_ddns::FMT_JSON) &&
+        (ncr_format != dhcp_ddns::FMT_BINARY)) {
         isc_throw(D2CfgError, "NCR Format:"
                   << dhcp_ddns::ncrFormatToString(ncr_format)
                   << " is not yet supported ("
                   << strings->getPosition("ncr_format") << ")");
     }
 
+    // Fetch and validate io_threads.
+    uint32_t io_threads = ints->getOptionalParam("io_threads",
+                                                 D2Params::DFT_IO_THREADS);
+
+    if ((io_threads < 1) || (io_threads > D2Params::MAX_IO_THREADS)) {
+        isc_throw(D2CfgError, "io_threads must be between 1 and "
+                  << D2Params::MAX_IO_THREADS << " ("
+                  << ints->getPosition("io_threads") << ")");
+    }
+
     // Attempt to create the new client config. This ought to fly as
     // we already validated everything.
     D2ParamsPtr params(new D2Params(ip_address, port, dns_server_timeout,
-                                    ncr_protocol, ncr_format));
+                                    ncr_protocol, ncr_format, io_threads));
 
     context->getD2Params() = params;
 }
@@ -310,7 +289,8 @@ D2CfgMgr::createConfigParser(const std::string& config_id,
     // Create parser instance based on element_id.
     isc::dhcp::ParserPtr parser;
     if ((config_id.compare("port") == 0) ||
-        (config_id.compare("dns_server_timeout") == 0)) {
+        (config_id.compare("dns_server_timeout") == 0) ||
+        (config_id.compare("io_threads") == 0)) {
         parser.reset(new isc::dhcp::Uint32Parser(config_id,
                                                  context->getUint32Storage()));
     } else if ((config_id.compare("ip_address") == 0) ||
@@ -225,7 +225,7 @@ public:
     /// IPv6 example:
     /// input:  2001:db8:302:99::
     /// output:
-    ///0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.9.9.0.0.2.0.3.0.8.B.D.0.1.0.0.2.ip6.arpa.
+    ///0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.9.9.0.0.2.0.3.0.8.b.d.0.1.0.0.2.ip6.arpa.
     ///
     /// @param ioaddr string containing a valid IPv6 address.
     ///
@@ -234,6 +234,17 @@ public:
     /// @throw D2CfgError if not given an IPv6 address.
     static std::string reverseV6Address(const isc::asiolink::IOAddress& ioaddr);
 
+    /// @brief Generate the reverse lookup name for the given IP address
+    ///
+    /// This method builds the DNS name of the reverse mapping of an IPv4
+    /// or IPv6 address, as returned in text by reverseV4Address and
+    /// reverseV6Address, directly from the bytes of the address.
+    ///
+    /// @param ioaddr is the IPv4 or IPv6 IOaddress to convert
+    ///
+    /// @return a dns::Name containing the reverse lookup name.
+    static dns::Name reverseIpName(const isc::asiolink::IOAddress& ioaddr);
+
     /// @brief Convenience method fetches the D2Params from context
     /// @return reference to const D2ParamsPtr
     const D2ParamsPtr& getD2Params();
@@ -263,8 +274,10 @@ protected:
     /// -# ip_address is 0.0.0.0 or ::
     /// -# port is 0
     /// -# dns_server_timeout is < 1
-    /// -# ncr_protocol is invalid, currently only NCR_UDP is supported
+    /// -# ncr_protocol is invalid, currently only NCR_UDP and NCR_SHM
+    /// are supported
     /// -# ncr_format is invalid, currently only FMT_JSON is supported
+    /// -# io_threads is < 1 or > D2Params::MAX_IO_THREADS
     virtual void buildParams(isc::data::ConstElementPtr params_config);
 
     /// @brief Given an element_id returns an instance of the appropriate
@@ -277,6 +290,7 @@ protected:
     ///     -# dns_server_timeout
     ///     -# ncr_protocol
     ///     -# ncr_format
+    ///     -# io_threads
     ///     -# tsig_keys
     ///     -# forward_ddns
     ///     -# reverse_ddns
@@ -35,17 +35,21 @@ const size_t D2Params::DFT_PORT = 53001;
 const size_t D2Params::DFT_DNS_SERVER_TIMEOUT = 100;
 const char *D2Params::DFT_NCR_PROTOCOL = "UDP";
 const char *D2Params::DFT_NCR_FORMAT = "JSON";
+const size_t D2Params::DFT_IO_THREADS = 1;
+const size_t D2Params::MAX_IO_THREADS;
 
 D2Params::D2Params(const isc::asiolink::IOAddress& ip_address,
                    const size_t port,
                    const size_t dns_server_timeout,
                    const dhcp_ddns::NameChangeProtocol& ncr_protocol,
-                   const dhcp_ddns::NameChangeFormat& ncr_format)
+                   const dhcp_ddns::NameChangeFormat& ncr_format,
+                   const size_t io_threads)
     : ip_address_(ip_address),
     port_(port),
     dns_server_timeout_(dns_server_timeout),
     ncr_protocol_(ncr_protocol),
-    ncr_format_(ncr_format) {
+    ncr_format_(ncr_format),
+    io_threads_(io_threads) {
     validateContents();
 }
 
@@ -54,7 +58,8 @@ D2Params::D2Params()
      port_(DFT_PORT),
      dns_server_timeout_(DFT_DNS_SERVER_TIMEOUT),
      ncr_protocol_(dhcp_ddns::NCR_UDP),
-     ncr_format_(dhcp_ddns::FMT_JSON) {
+     ncr_format_(dhcp_ddns::FMT_JSON),
+     io_threads_(DFT_IO_THREADS) {
     validateContents();
 }
 
@@ -76,17 +81,24 @@ D2Params::validateContents() {
                   "D2Params: DNS server timeout must be larger than 0");
     }
 
-    if (ncr_format_ != dhcp_ddns::FMT_JSON) {
+    if ((ncr_format_ != dhcp_ddns::FMT_JSON) &&
+        (ncr_format_ != dhcp_ddns::FMT_BINARY)) {
         isc_throw(D2CfgError, "D2Params: NCR Format:"
                   << dhcp_ddns::ncrFormatToString(ncr_format_)
                   << " is not yet supported");
     }
 
-    if (ncr_protocol_ != dhcp_ddns::NCR_UDP) {
+    if ((ncr_protocol_ != dhcp_ddns::NCR_UDP) &&
+        (ncr_protocol_ != dhcp_ddns::NCR_SHM)) {
         isc_throw(D2CfgError, "D2Params: NCR Protocol:"
                   << dhcp_ddns::ncrProtocolToString(ncr_protocol_)
                   << " is not yet supported");
     }
+
+    if ((io_threads_ < 1) || (io_threads_ > MAX_IO_THREADS)) {
+        isc_throw(D2CfgError, "D2Params: IO threads must be between 1 and "
+                  << MAX_IO_THREADS);
+    }
 }
 
 std::string
@@ -103,7 +115,8 @@ D2Params::operator == (const D2Params& other) const {
             (port_ == other.port_) &&
             (dns_server_timeout_ == other.dns_server_timeout_) &&
             (ncr_protocol_ == other.ncr_protocol_) &&
-            (ncr_format_ == other.ncr_format_));
+            (ncr_format_ == other.ncr_format_) &&
+            (io_threads_ == other.io_threads_));
 }
 
 bool
@@ -121,7 +134,8 @@ D2Params::toText() const {
            << ", ncr_protocol: "
            << dhcp_ddns::ncrProtocolToString(ncr_protocol_)
            << ", ncr_format: " << ncr_format_
-           << dhcp_ddns::ncrFormatToString(ncr_format_);
+           << dhcp_ddns::ncrFormatToString(ncr_format_)
+           << ", io_threads: " << io_threads_;
 
     return (stream.str());
 }
@@ -195,7 +209,7 @@ DnsServerInfo::DnsServerInfo(const std::string& hostname,
                              isc::asiolink::IOAddress ip_address, uint32_t port,
                              bool enabled)
     :hostname_(hostname), ip_address_(ip_address), port_(port),
-    enabled_(enabled) {
+    enabled_(enabled), throttle_(new DnsServerThrottle()) {
 }
 
 DnsServerInfo::~DnsServerInfo() {
@@ -18,6 +18,7 @@
 #include <cc/data.h>
 #include <d2/d2_asio.h>
 #include <d2/d_cfg_mgr.h>
+#include <d2/dns_server_throttle.h>
 #include <dhcpsrv/dhcp_parsers.h>
 #include <dns/tsig.h>
 #include <exceptions/exceptions.h>
@@ -156,8 +157,12 @@ public:
     static const size_t DFT_DNS_SERVER_TIMEOUT;
     static const char *DFT_NCR_PROTOCOL;
     static const char *DFT_NCR_FORMAT;
+    static const size_t DFT_IO_THREADS;
     //@}
 
+    /// @brief Maximum number of threads running the DNS update transactions.
+    static const size_t MAX_IO_THREADS = 64;
+
     /// @brief Constructor
     ///
     /// @param ip_address IP address at which D2 should listen for NCRs
@@ -166,18 +171,23 @@ public:
     /// wait for a response to a single DNS update request.
     /// @param ncr_protocol socket protocol D2 should use to receive NCRS
     /// @param ncr_format packet format of the inbound NCRs
+    /// @param io_threads number of threads running the DNS update
+    /// transactions, 1 means they run on the main thread
     ///
     /// @throw D2CfgError if:
     /// -# ip_address is 0.0.0.0 or ::
     /// -# port is 0
     /// -# dns_server_timeout is < 1
-    /// -# ncr_protocol is invalid, currently only NCR_UDP is supported
+    /// -# ncr_protocol is invalid, currently only NCR_UDP and NCR_SHM
+    /// are supported
     /// -# ncr_format is invalid, currently only FMT_JSON is supported
+    /// -# io_threads is < 1 or > MAX_IO_THREADS
     D2Params(const isc::asiolink::IOAddress& ip_address,
                    const size_t port,
                    const size_t dns_server_timeout,
                    const dhcp_ddns::NameChangeProtocol& ncr_protocol,
-                   const dhcp_ddns::NameChangeFormat& ncr_format);
+                   const dhcp_ddns::NameChangeFormat& ncr_format,
+                   const size_t io_threads = DFT_IO_THREADS);
 
     /// @brief Default constructor
     /// The default constructor creates an instance that has updates disabled.
@@ -211,6 +221,12 @@ public:
         return(ncr_format_);
     }
 
+    /// @brief Return the number of threads running the DNS update
+    /// transactions.
+    size_t getIoThreads() const {
+        return(io_threads_);
+    }
+
     /// @brief Return summary of the configuration used by D2.
     ///
     /// The returned summary of the configuration is meant to be appended to
@@ -239,6 +255,7 @@ protected:
     /// -# dns_server_timeout is 0
     /// -# ncr_protocol is UDP
     /// -# ncr_format is JSON
+    /// -# io_threads is between 1 and MAX_IO_THREADS
     ///
     /// @throw D2CfgError if contents are invalid
     virtual void validateContents();
@@ -260,6 +277,9 @@ private:
     /// @brief Format of the inbound requests (NCRs).
     /// Currently only JSON format is supported.
     dhcp_ddns::NameChangeFormat ncr_format_;
+
+    /// @brief Number of threads running the DNS update transactions.
+    size_t io_threads_;
 };
 
 /// @brief Dumps the contents of a D2Params as text to an output stream
@@ -279,6 +299,11 @@ typedef boost::shared_ptr<D2Params> D2ParamsPtr;
 /// instance of the actual key (@ref isc::dns::TSIGKey) that can be used
 /// by the IO layer for signing and verifying messages.
 ///
+/// The key instance is created once, when the configuration is parsed, and
+/// it keeps an HMAC object keyed with the secret.  The TSIG contexts of
+/// the individual DNS updates clone that object rather than keying a new
+/// one from the secret (see @ref isc::dns::TSIGKey::createHMAC).
+///
 class TSIGKeyInfo {
 public:
     /// @brief Defines string values for the supported TSIG algorithms
@@ -486,6 +511,11 @@ public:
         enabled_ = false;
     }
 
+    /// @brief Returns the throttle controlling the load put on the server.
+    const DnsServerThrottlePtr& getThrottle() const {
+        return (throttle_);
+    }
+
     /// @brief Returns a text representation for the server.
     std::string toText() const;
 
@@ -505,6 +535,10 @@ private:
     /// @param enabled is a flag that indicates whether this server is
     /// enabled for use. It defaults to true.
     bool enabled_;
+
+    /// @brief Throttle shared by the transactions sending updates to the
+    /// server.
+    DnsServerThrottlePtr throttle_;
 };
 
 std::ostream&
@@ -227,6 +227,10 @@ D2Process::configure(isc::data::ConstElementPtr config_set) {
     // did some analysis to decide what if anything we need to do.)
     reconf_queue_flag_ = true;
 
+    // The update manager applies a new number of IO threads once its
+    // current transactions have completed.
+    update_mgr_->setIoThreads(getD2CfgMgr()->getD2Params()->getIoThreads());
+
     // If we are here, configuration was valid, at least it parsed correctly
     // and therefore contained no invalid values.
     // Return the success answer from above.
@@ -342,6 +346,10 @@ D2Process::reconfigureQueueMgr() {
             queue_mgr_->initUDPListener(d2_params->getIpAddress(),
                                         d2_params->getPort(),
                                         d2_params->getNcrFormat(), true);
+        } else if (d2_params->getNcrProtocol() == dhcp_ddns::NCR_SHM) {
+            queue_mgr_->initShmListener(d2_params->getIpAddress(),
+                                        d2_params->getPort(),
+                                        d2_params->getNcrFormat());
         } else {
             /// @todo Add TCP/IP once it's supported
             // We should never get this far but if we do deal with it.
@@ -14,6 +14,7 @@
 
 #include <d2/d2_log.h>
 #include <d2/d2_queue_mgr.h>
+#include <dhcp_ddns/ncr_shm.h>
 #include <dhcp_ddns/ncr_udp.h>
 
 namespace isc {
@@ -115,6 +116,22 @@ D2QueueMgr::initUDPListener(const isc::asiolink::IOAddress& ip_address,
     mgr_state_ = INITTED;
 }
 
+void
+D2QueueMgr::initShmListener(const isc::asiolink::IOAddress& ip_address,
+                            const uint32_t port,
+                            const dhcp_ddns::NameChangeFormat format) {
+
+    if (listener_) {
+        isc_throw(D2QueueMgrError,
+                  "D2QueueMgr listener is already initialized");
+    }
+
+    // Instantiate a shared memory listener and set state to INITTED.
+    listener_.reset(new dhcp_ddns::
+                    NameChangeShmListener(ip_address, port, format, *this));
+    mgr_state_ = INITTED;
+}
+
 void
 D2QueueMgr::startListening() {
     // We can't listen if we haven't initialized the listener yet.
@@ -29,12 +29,27 @@ D2UpdateMessage::D2UpdateMessage(const Direction direction)
     // If this object is to create an outgoing message, we have to
     // set the proper Opcode field and QR flag here.
     if (direction == OUTBOUND) {
-        message_.setOpcode(Opcode(Opcode::UPDATE_CODE));
-        message_.setHeaderFlag(dns::Message::HEADERFLAG_QR, false);
-        message_.setRcode(Rcode::NOERROR());
+        initOutbound();
     }
 }
 
+void
+D2UpdateMessage::clear(const Direction direction) {
+    message_.clear(direction == INBOUND ?
+                   dns::Message::PARSE : dns::Message::RENDER);
+    zone_.reset();
+    if (direction == OUTBOUND) {
+        initOutbound();
+    }
+}
+
+void
+D2UpdateMessage::initOutbound() {
+    message_.setOpcode(Opcode(Opcode::UPDATE_CODE));
+    message_.setHeaderFlag(dns::Message::HEADERFLAG_QR, false);
+    message_.setRcode(Rcode::NOERROR());
+}
+
 D2UpdateMessage::QRFlag
 D2UpdateMessage::getQRFlag() const {
     return (message_.getHeaderFlag(dns::Message::HEADERFLAG_QR) ?
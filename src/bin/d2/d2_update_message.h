@@ -157,6 +157,19 @@ private:
 
 public:
 
+    /// @brief Resets the message to the state of a newly created message.
+    ///
+    /// All sections, the Zone record and the TSIG record are removed and
+    /// the header is reset as in the constructor. The storage allocated
+    /// by the underlying @c isc::dns::Message is retained, so a message
+    /// may be reused for another request or response without allocating
+    /// it from scratch. In particular, an inbound message has to be
+    /// cleared before @c D2UpdateMessage::fromWire is called on it again.
+    ///
+    /// @param direction indicates if the message is to be reused as an
+    /// inbound or outbound message.
+    void clear(const Direction direction);
+
     /// @brief Returns enum value indicating if the message is a
     /// REQUEST or RESPONSE
     ///
@@ -341,6 +354,12 @@ private:
     /// than one record.
     void validateResponse() const;
 
+    /// @brief Sets the header fields of the outgoing message.
+    ///
+    /// The Opcode is set to UPDATE, the QR flag is cleared and the RCode
+    /// is set to NOERROR.
+    void initOutbound();
+
     /// @brief An object representing DNS Message which is used by the
     /// implementation of @c D2UpdateMessage to perform low level.
     ///
@@ -0,0 +1,237 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <d2/d2_update_message_pool.h>
+#include <dns/messagerenderer.h>
+#include <util/threads/sync.h>
+
+#include <boost/weak_ptr.hpp>
+
+#include <vector>
+
+namespace isc {
+namespace d2 {
+
+using namespace isc::util;
+using isc::util::thread::Mutex;
+
+/// @brief Implementation of the @c D2UpdateMessagePool.
+class D2UpdateMessagePoolImpl {
+public:
+    /// @brief Constructor.
+    ///
+    /// The free lists are reserved up front, so returning an object to
+    /// the pool never throws.
+    ///
+    /// @param max_free maximum number of objects kept on each free list.
+    D2UpdateMessagePoolImpl(const size_t max_free)
+        : max_free_(max_free) {
+        free_messages_.reserve(max_free_);
+        free_buffers_.reserve(max_free_);
+        free_renderers_.reserve(max_free_);
+    }
+
+    /// @brief Destructor, deletes the objects on the free lists.
+    ~D2UpdateMessagePoolImpl() {
+        for (size_t i = 0; i < free_messages_.size(); ++i) {
+            delete free_messages_[i];
+        }
+        for (size_t i = 0; i < free_buffers_.size(); ++i) {
+            delete free_buffers_[i];
+        }
+        for (size_t i = 0; i < free_renderers_.size(); ++i) {
+            delete free_renderers_[i];
+        }
+    }
+
+    /// @brief Takes an object from a free list.
+    ///
+    /// @return the object or NULL if the list is empty.
+    template<typename T>
+    T* pop(std::vector<T*>& list) {
+        Mutex::Locker locker(mutex_);
+        if (list.empty()) {
+            return (NULL);
+        }
+        T* object = list.back();
+        list.pop_back();
+        return (object);
+    }
+
+    /// @brief Puts an object on a free list or deletes it if the list is
+    /// full.
+    template<typename T>
+    void push(std::vector<T*>& list, T* object) {
+        {
+            Mutex::Locker locker(mutex_);
+            if (list.size() < max_free_) {
+                list.push_back(object);
+                return;
+            }
+        }
+        delete object;
+    }
+
+    /// @brief Returns the size of a free list.
+    template<typename T>
+    size_t size(const std::vector<T*>& list) const {
+        Mutex::Locker locker(mutex_);
+        return (list.size());
+    }
+
+    /// @brief Clears the message and returns it to the pool.
+    ///
+    /// The message is cleared right away, so the RRsets it holds are
+    /// released.
+    void release(D2UpdateMessage* message) {
+        message->clear(D2UpdateMessage::INBOUND);
+        push(free_messages_, message);
+    }
+
+    /// @brief Clears the buffer and returns it to the pool.
+    void release(OutputBuffer* buffer) {
+        buffer->clear();
+        push(free_buffers_, buffer);
+    }
+
+    /// @brief Free messages.
+    std::vector<D2UpdateMessage*> free_messages_;
+
+    /// @brief Free buffers.
+    std::vector<OutputBuffer*> free_buffers_;
+
+    /// @brief Free renderers.
+    std::vector<dns::MessageRenderer*> free_renderers_;
+
+    /// @brief Maximum number of objects on each free list.
+    size_t max_free_;
+
+    /// @brief Protects the free lists.
+    mutable Mutex mutex_;
+};
+
+namespace {
+
+/// @brief Deleter of the objects handed out by the pool.
+///
+/// Returns the object to the pool if the pool still exists, otherwise
+/// deletes it.
+///
+/// @tparam T type of the object.
+template<typename T>
+class PoolReleaser {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param pool pool to which the object is returned.
+    PoolReleaser(const boost::shared_ptr<D2UpdateMessagePoolImpl>& pool)
+        : pool_(pool) {
+    }
+
+    /// @brief Returns the object to the pool or deletes it.
+    void operator()(T* object) const {
+        boost::shared_ptr<D2UpdateMessagePoolImpl> pool = pool_.lock();
+        if (pool) {
+            pool->release(object);
+        } else {
+            delete object;
+        }
+    }
+
+private:
+    /// @brief Weak reference to the pool.
+    boost::weak_ptr<D2UpdateMessagePoolImpl> pool_;
+};
+
+}
+
+const size_t D2UpdateMessagePool::DEFAULT_MAX_FREE;
+const size_t D2UpdateMessagePool::DEFAULT_BUFFER_SIZE;
+
+D2UpdateMessagePool::D2UpdateMessagePool(const size_t max_free)
+    : impl_(new D2UpdateMessagePoolImpl(max_free)) {
+}
+
+D2UpdateMessagePool::~D2UpdateMessagePool() {
+}
+
+D2UpdateMessagePool&
+D2UpdateMessagePool::instance() {
+    static D2UpdateMessagePool pool;
+    return (pool);
+}
+
+D2UpdateMessagePtr
+D2UpdateMessagePool::acquireMessage(const D2UpdateMessage::Direction
+                                    direction) {
+    D2UpdateMessage* message = impl_->pop(impl_->free_messages_);
+    if (message) {
+        message->clear(direction);
+    } else {
+        message = new D2UpdateMessage(direction);
+    }
+    return (D2UpdateMessagePtr(message,
+                               PoolReleaser<D2UpdateMessage>(impl_)));
+}
+
+OutputBufferPtr
+D2UpdateMessagePool::acquireBuffer() {
+    OutputBuffer* buffer = impl_->pop(impl_->free_buffers_);
+    if (!buffer) {
+        buffer = new OutputBuffer(DEFAULT_BUFFER_SIZE);
+    }
+    return (OutputBufferPtr(buffer, PoolReleaser<OutputBuffer>(impl_)));
+}
+
+OutputBufferPtr
+D2UpdateMessagePool::render(D2UpdateMessage& message,
+                            dns::TSIGContext* const tsig_context) {
+    OutputBufferPtr buffer = acquireBuffer();
+    dns::MessageRenderer* renderer = impl_->pop(impl_->free_renderers_);
+    if (!renderer) {
+        renderer = new dns::MessageRenderer();
+    }
+    // The renderer writes straight into the buffer from the pool. It is
+    // switched back to its internal buffer afterwards, which also clears
+    // its compression table for the next message.
+    renderer->setBuffer(buffer.get());
+    try {
+        message.toWire(*renderer, tsig_context);
+    } catch (...) {
+        renderer->setBuffer(NULL);
+        impl_->push(impl_->free_renderers_, renderer);
+        throw;
+    }
+    renderer->setBuffer(NULL);
+    impl_->push(impl_->free_renderers_, renderer);
+    return (buffer);
+}
+
+size_t
+D2UpdateMessagePool::getFreeMessageCount() const {
+    return (impl_->size(impl_->free_messages_));
+}
+
+size_t
+D2UpdateMessagePool::getFreeBufferCount() const {
+    return (impl_->size(impl_->free_buffers_));
+}
+
+size_t
+D2UpdateMessagePool::getFreeRendererCount() const {
+    return (impl_->size(impl_->free_renderers_));
+}
+
+} // namespace d2
+} // namespace isc
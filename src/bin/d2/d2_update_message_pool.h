@@ -0,0 +1,129 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef D2_UPDATE_MESSAGE_POOL_H
+#define D2_UPDATE_MESSAGE_POOL_H
+
+#include <d2/d2_update_message.h>
+#include <dns/tsig.h>
+#include <util/buffer.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace isc {
+namespace d2 {
+
+class D2UpdateMessagePoolImpl;
+
+/// @brief Pool of DNS Update messages and wire buffers.
+///
+/// Each DNS update carried out by D2 needs an outbound @c D2UpdateMessage,
+/// a renderer, a buffer holding the wire data of the request, a buffer for
+/// the response and an inbound @c D2UpdateMessage to parse the response
+/// into. Creating them from scratch for each update allocates the internals
+/// of @c isc::dns::Message, the compression table of the renderer and
+/// the buffers over and over again.
+///
+/// This class keeps the released messages and buffers on free lists and
+/// hands them out again, cleared but with their storage retained. The
+/// objects are handed out as shared pointers which return the object to
+/// the pool when the last reference is dropped, so the users need not
+/// release them explicitly. The number of objects kept on each free list
+/// is bounded; the objects released while the list is full are deleted.
+/// The objects may safely outlive the pool, in which case they are deleted
+/// when released.
+///
+/// The renderers used to render the outbound messages are kept on a free
+/// list as well, so a renderer keeps the storage of its compression table.
+///
+/// The pool is thread safe: the free lists are protected by a mutex, which
+/// is only held to take an object from a list or put it back, so the
+/// threads running DNS update transactions (see @c D2UpdateMgr) render and
+/// parse messages in parallel. An object may be released by another thread
+/// than the one which acquired it.
+class D2UpdateMessagePool : public boost::noncopyable {
+public:
+    /// @brief Default maximum number of objects kept on each free list.
+    static const size_t DEFAULT_MAX_FREE = 64;
+
+    /// @brief Default initial capacity of the buffers.
+    ///
+    /// The DNS Update messages sent by D2 and the responses to them
+    /// typically fit in a single UDP datagram of this size.
+    static const size_t DEFAULT_BUFFER_SIZE = 512;
+
+    /// @brief Constructor.
+    ///
+    /// @param max_free maximum number of messages and of buffers kept on
+    /// the free lists.
+    explicit D2UpdateMessagePool(const size_t max_free = DEFAULT_MAX_FREE);
+
+    /// @brief Destructor.
+    ///
+    /// Deletes the objects on the free lists. The objects still in use
+    /// are deleted when released.
+    ~D2UpdateMessagePool();
+
+    /// @brief Returns the pool used by D2.
+    static D2UpdateMessagePool& instance();
+
+    /// @brief Returns a blank DNS Update message.
+    ///
+    /// @param direction indicates if the message is to be used as an
+    /// inbound or outbound message.
+    ///
+    /// @return pointer to the message which is returned to the pool when
+    /// the last reference to it is dropped.
+    D2UpdateMessagePtr acquireMessage(const D2UpdateMessage::Direction
+                                      direction);
+
+    /// @brief Returns an empty buffer.
+    ///
+    /// @return pointer to the buffer which is returned to the pool when
+    /// the last reference to it is dropped.
+    util::OutputBufferPtr acquireBuffer();
+
+    /// @brief Renders an outbound message into a buffer from the pool.
+    ///
+    /// @param message message to be rendered.
+    /// @param tsig_context A TSIG context that is to be used for signing the
+    /// message. If NULL the message will not be signed.
+    ///
+    /// @return pointer to the buffer holding the wire data of the message.
+    /// @throw any exception thrown by @c D2UpdateMessage::toWire.
+    util::OutputBufferPtr render(D2UpdateMessage& message,
+                                 dns::TSIGContext* const tsig_context = NULL);
+
+    /// @brief Returns the number of messages on the free list.
+    size_t getFreeMessageCount() const;
+
+    /// @brief Returns the number of buffers on the free list.
+    size_t getFreeBufferCount() const;
+
+    /// @brief Returns the number of renderers on the free list.
+    size_t getFreeRendererCount() const;
+
+private:
+    /// @brief Pointer to the implementation.
+    ///
+    /// The implementation is shared with the deleters of the objects
+    /// handed out, which only hold weak references to it.
+    boost::shared_ptr<D2UpdateMessagePoolImpl> impl_;
+};
+
+} // namespace d2
+} // namespace isc
+
+#endif // D2_UPDATE_MESSAGE_POOL_H
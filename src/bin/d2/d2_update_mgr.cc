@@ -16,10 +16,14 @@
 #include <d2/nc_add.h>
 #include <d2/nc_remove.h>
 
+#include <boost/bind.hpp>
+
 #include <sstream>
 #include <iostream>
 #include <vector>
 
+using isc::util::thread::Thread;
+
 namespace isc {
 namespace d2 {
 
@@ -28,7 +32,9 @@ const size_t D2UpdateMgr::MAX_TRANSACTIONS_DEFAULT;
 D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
                          IOServicePtr& io_service,
                          const size_t max_transactions)
-    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service) {
+    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service),
+     io_threads_(1), pending_io_threads_(1), workers_(), threads_(),
+     next_worker_(0) {
     if (!queue_mgr_) {
         isc_throw(D2UpdateMgrError, "D2UpdateMgr queue manager cannot be null");
     }
@@ -47,6 +53,7 @@ D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
 }
 
 D2UpdateMgr::~D2UpdateMgr() {
+    stopIoThreads();
     transaction_list_.clear();
 }
 
@@ -54,6 +61,21 @@ void D2UpdateMgr::sweep() {
     // cleanup finished transactions;
     checkFinishedTransactions();
 
+    // A change in the number of IO threads waits for the current
+    // transactions to complete, as they are bound to their IOService.
+    if (pending_io_threads_ != io_threads_) {
+        if (getTransactionCount() > 0) {
+            return;
+        }
+
+        stopIoThreads();
+        if (pending_io_threads_ > 1) {
+            startIoThreads(pending_io_threads_);
+        }
+
+        io_threads_ = pending_io_threads_;
+    }
+
     // if the queue isn't empty, find the next suitable job and
     // start a transaction for it.
     // @todo - Do we want to queue max transactions? The logic here will only
@@ -74,8 +96,72 @@ void D2UpdateMgr::sweep() {
     }
 }
 
+void
+D2UpdateMgr::setIoThreads(const size_t io_threads) {
+    if (io_threads < 1) {
+        isc_throw(D2UpdateMgrError, "D2UpdateMgr"
+                  " number of IO threads must be greater than zero");
+    }
+
+    pending_io_threads_ = io_threads;
+}
+
+void
+D2UpdateMgr::startIoThreads(const size_t io_threads) {
+    for (size_t i = 0; i < io_threads; ++i) {
+        IOServicePtr worker(new asiolink::IOService());
+        workers_.push_back(worker);
+        threads_.push_back(boost::shared_ptr<Thread>(
+                           new Thread(boost::bind(&asiolink::IOService::run,
+                                                  worker.get()))));
+    }
+
+    next_worker_ = 0;
+    LOG_INFO(dctl_logger, DHCP_DDNS_IO_THREADS_STARTED).arg(io_threads);
+}
+
+void
+D2UpdateMgr::stopIoThreads() {
+    if (threads_.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->stop();
+    }
+
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i]->wait();
+    }
+
+    threads_.clear();
+
+    // Transactions refer to the IOService of their worker so they must go
+    // first.
+    transaction_list_.clear();
+    workers_.clear();
+    LOG_INFO(dctl_logger, DHCP_DDNS_IO_THREADS_STOPPED);
+}
+
+void
+D2UpdateMgr::onTransactionDone(const IOServicePtr& worker,
+                               const TransactionKey& key) {
+    // The transaction is still on the stack: the handler posted to the
+    // worker runs after it has returned.
+    worker->post(boost::bind(&asiolink::IOService::post, io_service_.get(),
+                             boost::function<void()>(
+                             boost::bind(&D2UpdateMgr::removeTransaction,
+                                         this, key))));
+}
+
 void
 D2UpdateMgr::checkFinishedTransactions() {
+    // Transactions run by the worker threads remove themselves, and their
+    // state may not be examined from this thread.
+    if (!workers_.empty()) {
+        return;
+    }
+
     // Cycle through transaction list and do whatever needs to be done
     // for finished transactions.
     // At the moment all we do is remove them from the list. This is likely
@@ -188,17 +274,20 @@ D2UpdateMgr::makeTransaction(dhcp_ddns::NameChangeRequestPtr& next_ncr) {
     }
 
     // We matched to the required servers, so construct the transaction.
-    // @todo If multi-threading is implemented, one would pass in an
-    // empty IOServicePtr, rather than our instance value.  This would cause
-    // the transaction to instantiate its own, separate IOService to handle
-    // the transaction's IO.
+    // With worker threads, it is given the IOService of the next worker.
+    IOServicePtr io_service = io_service_;
+    if (!workers_.empty()) {
+        io_service = workers_[next_worker_];
+        next_worker_ = (next_worker_ + 1) % workers_.size();
+    }
+
     NameChangeTransactionPtr trans;
     if (next_ncr->getChangeType() == dhcp_ddns::CHG_ADD) {
-        trans.reset(new NameAddTransaction(io_service_, next_ncr,
+        trans.reset(new NameAddTransaction(io_service, next_ncr,
                                            forward_domain, reverse_domain,
                                            cfg_mgr_));
     } else {
-        trans.reset(new NameRemoveTransaction(io_service_, next_ncr,
+        trans.reset(new NameRemoveTransaction(io_service, next_ncr,
                                               forward_domain, reverse_domain,
                                               cfg_mgr_));
     }
@@ -206,8 +295,16 @@ D2UpdateMgr::makeTransaction(dhcp_ddns::NameChangeRequestPtr& next_ncr) {
     // Add the new transaction to the list.
     transaction_list_[key] = trans;
 
-    // Start it.
-    trans->startTransaction();
+    // Start it, on its worker if there is one.  The transaction stays in
+    // the list until it is done, so the worker may use a plain pointer.
+    if (workers_.empty()) {
+        trans->startTransaction();
+    } else {
+        trans->setDoneHandler(boost::bind(&D2UpdateMgr::onTransactionDone,
+                                          this, io_service, key));
+        io_service->post(boost::bind(&NameChangeTransaction::startTransaction,
+                                     trans.get()));
+    }
 }
 
 TransactionList::iterator
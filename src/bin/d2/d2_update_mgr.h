@@ -23,10 +23,12 @@
 #include <d2/d2_queue_mgr.h>
 #include <d2/d2_cfg_mgr.h>
 #include <d2/nc_trans.h>
+#include <util/threads/thread.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <map>
+#include <vector>
 
 namespace isc {
 namespace d2 {
@@ -70,6 +72,16 @@ typedef std::map<TransactionKey, NameChangeTransactionPtr> TransactionList;
 /// The upper layer(s) are responsible for calling sweep in a timely and cyclic
 /// manner.
 ///
+/// By default transactions run on the upper layer's IOService.  When more
+/// than one IO thread is configured, D2UpdateMgr starts a pool of worker
+/// threads, each running its own IOService, and assigns each new transaction
+/// to one of them in turn.  All of a transaction's IO events are therefore
+/// handled by a single thread, one at a time, which is the same guarantee a
+/// strand would give.  The queue, the transaction list and the selection of
+/// requests remain owned by the thread calling sweep(): a worker reports the
+/// completion of a transaction by posting its removal to the upper layer's
+/// IOService.
+///
 class D2UpdateMgr : public boost::noncopyable {
 public:
     /// @brief Maximum number of concurrent transactions
@@ -122,6 +134,23 @@ public:
     /// add the transaction to the list of transactions.
     void sweep();
 
+    /// @brief Sets the number of threads used to run transactions.
+    ///
+    /// A value of one runs transactions on the upper layer's IOService.
+    /// Larger values run them on a pool of that many worker threads.  The
+    /// change takes effect once all of the current transactions have
+    /// completed; until then no new transaction is started.
+    ///
+    /// @param io_threads the number of IO threads
+    ///
+    /// @throw D2UpdateMgrError if the value is less than one.
+    void setIoThreads(const size_t io_threads);
+
+    /// @brief Returns the number of threads used to run transactions.
+    size_t getIoThreads() const {
+        return (io_threads_);
+    }
+
 protected:
     /// @brief Performs post-completion cleanup on completed transactions.
     ///
@@ -169,6 +198,30 @@ protected:
     /// exists. Note this would be programmatic error.
     void makeTransaction(isc::dhcp_ddns::NameChangeRequestPtr& ncr);
 
+    /// @brief Starts the pool of worker threads.
+    ///
+    /// @param io_threads the number of worker threads to start
+    void startIoThreads(const size_t io_threads);
+
+    /// @brief Stops the pool of worker threads.
+    ///
+    /// Stops each worker's IOService, waits for the threads to exit and
+    /// discards any transaction left in the list.  It has no effect if the
+    /// pool is not running.
+    void stopIoThreads();
+
+    /// @brief Handles the completion of a transaction run by a worker.
+    ///
+    /// Invoked on the worker thread by the transaction itself.  Posts the
+    /// removal of the transaction to the worker first, so it happens only
+    /// after the transaction's handler has returned, and from there to the
+    /// upper layer's IOService.
+    ///
+    /// @param worker the IOService of the worker running the transaction
+    /// @param key the key of the completed transaction
+    void onTransactionDone(const IOServicePtr& worker,
+                           const TransactionKey& key);
+
 public:
     /// @brief Gets the D2UpdateMgr's IOService.
     ///
@@ -243,9 +296,8 @@ private:
     /// @brief Primary IOService instance.
     /// This is the IOService that the upper layer(s) use for IO events, such
     /// as shutdown and configuration commands.  It is the IOService that is
-    /// passed into transactions to manager their IO events.
-    /// (For future reference, multi-threaded transactions would each use their
-    /// own IOService instance.)
+    /// passed into transactions to manager their IO events when there is
+    /// a single IO thread.
     IOServicePtr io_service_;
 
     /// @brief Maximum number of concurrent transactions.
@@ -253,6 +305,21 @@ private:
 
     /// @brief List of transactions.
     TransactionList transaction_list_;
+
+    /// @brief Number of IO threads in use.
+    size_t io_threads_;
+
+    /// @brief Number of IO threads to use once the transactions complete.
+    size_t pending_io_threads_;
+
+    /// @brief IOService of each worker thread.
+    std::vector<IOServicePtr> workers_;
+
+    /// @brief Worker threads.
+    std::vector<boost::shared_ptr<isc::util::thread::Thread> > threads_;
+
+    /// @brief Index of the worker to which the next transaction goes.
+    size_t next_worker_;
 };
 
 /// @brief Defines a pointer to a D2UpdateMgr instance.
@@ -34,6 +34,12 @@
         "item_optional": true,
         "item_default": "JSON"
     },
+    {
+        "item_name": "io_threads",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 1
+    },
     {
         "item_name": "tsig_keys",
         "item_type": "list",
@@ -14,21 +14,12 @@
 
 #include <d2/dns_client.h>
 #include <d2/d2_log.h>
-#include <dns/messagerenderer.h>
+#include <d2/d2_update_message_pool.h>
 #include <limits>
 
 namespace isc {
 namespace d2 {
 
-namespace {
-
-// OutputBuffer objects are pre-allocated before data is written to them.
-// This is a default number of bytes for the buffers we create within
-// DNSClient class.
-const size_t DEFAULT_BUFFER_SIZE = 128;
-
-}
-
 using namespace isc::util;
 using namespace isc::asiolink;
 using namespace isc::asiodns;
@@ -90,7 +81,7 @@ public:
 DNSClientImpl::DNSClientImpl(D2UpdateMessagePtr& response_placeholder,
                              DNSClient::Callback* callback,
                              const DNSClient::Protocol proto)
-    : in_buf_(new OutputBuffer(DEFAULT_BUFFER_SIZE)),
+    : in_buf_(D2UpdateMessagePool::instance().acquireBuffer()),
       response_(response_placeholder), callback_(callback), proto_(proto) {
 
     // Response should be an empty pointer. It gets populated by the
@@ -133,10 +124,12 @@ DNSClientImpl::operator()(asiodns::IOFetch::Result result) {
     // and pass the status code.
     DNSClient::Status status = getStatus(result);
     if (status == DNSClient::SUCCESS) {
-        // Allocate a new response message. (Note that Message::fromWire
+        // Get a blank response message. (Note that Message::fromWire
         // may only be run once per message, so we need to start fresh
-        // each time.)
-        response_.reset(new D2UpdateMessage(D2UpdateMessage::INBOUND));
+        // each time.) The message comes from the pool, which recycles
+        // the previous response once it is no longer referenced.
+        response_ = D2UpdateMessagePool::instance().
+            acquireMessage(D2UpdateMessage::INBOUND);
 
         // Server's response may be corrupted. In such case, fromWire will
         // throw an exception. We want to catch this exception to return
@@ -206,19 +199,13 @@ DNSClientImpl::doUpdate(asiolink::IOService& io_service,
         tsig_context_.reset();
     }
 
-    // A renderer is used by the toWire function which creates the on-wire data
-    // from the DNS Update message. A renderer has its internal buffer where it
-    // renders data by default. However, this buffer can't be directly accessed.
-    // Fortunately, the renderer's API accepts user-supplied buffers. So, let's
-    // create our own buffer and pass it to the renderer so as the message is
-    // rendered to this buffer. Finally, we pass this buffer to IOFetch.
-    dns::MessageRenderer renderer;
-    OutputBufferPtr msg_buf(new OutputBuffer(DEFAULT_BUFFER_SIZE));
-    renderer.setBuffer(msg_buf.get());
-
-    // Render DNS Update message. This may throw a bunch of exceptions if
-    // invalid message object is given.
-    update.toWire(renderer, tsig_context_.get());
+    // Render DNS Update message into a buffer which is then passed to
+    // IOFetch. The renderer and the buffer are taken from the pool, so
+    // neither of them is allocated per update. The buffer is returned to
+    // the pool when IOFetch is done with it. This may throw a bunch of
+    // exceptions if invalid message object is given.
+    OutputBufferPtr msg_buf =
+        D2UpdateMessagePool::instance().render(update, tsig_context_.get());
 
     // IOFetch has all the mechanisms that we need to perform asynchronous
     // communication with the DNS server. The last but one argument points to
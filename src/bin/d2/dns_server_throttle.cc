@@ -0,0 +1,244 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <d2/dns_server_throttle.h>
+
+#include <util/monotonic_clock.h>
+
+#include <algorithm>
+#include <cmath>
+
+using isc::util::thread::Mutex;
+
+namespace isc {
+namespace d2 {
+
+namespace {
+
+/// @brief Maximum number of times the timeout is doubled.
+const unsigned int MAX_BACKOFF = 6;
+
+/// @brief Interval to wait after being throttled until a round trip time
+/// has been measured, in milliseconds.
+const unsigned int DFT_WAIT_INTERVAL = 10;
+
+/// @brief Maximum interval to wait after being throttled, in milliseconds.
+const unsigned int MAX_WAIT_INTERVAL = 100;
+
+}
+
+const unsigned int DnsServerThrottle::INITIAL_WINDOW;
+const unsigned int DnsServerThrottle::MAX_WINDOW;
+const unsigned int DnsServerThrottle::MIN_TIMEOUT;
+const unsigned int DnsServerThrottle::FAILURE_THRESHOLD;
+const unsigned int DnsServerThrottle::MIN_COOL_DOWN;
+const unsigned int DnsServerThrottle::MAX_COOL_DOWN;
+const uint64_t DnsServerThrottle::NANOS_PER_MS;
+
+DnsServerThrottle::DnsServerThrottle()
+    : mutex_(), window_(INITIAL_WINDOW), ssthresh_(MAX_WINDOW), in_flight_(0),
+      srtt_(0.0), rttvar_(0.0), backoff_(0), failures_(0), state_(CLOSED),
+      cool_down_(MIN_COOL_DOWN), open_until_(0) {
+}
+
+DnsServerThrottle::~DnsServerThrottle() {
+}
+
+uint64_t
+DnsServerThrottle::now() {
+    return (isc::util::getMonotonicNanos());
+}
+
+bool
+DnsServerThrottle::isAvailable(const uint64_t now) const {
+    Mutex::Locker lock(mutex_);
+    switch (state_) {
+    case OPEN:
+        return (now >= open_until_ && in_flight_ == 0);
+    case HALF_OPEN:
+        return (in_flight_ == 0);
+    default:
+        return (true);
+    }
+}
+
+DnsServerThrottle::Admission
+DnsServerThrottle::acquire(const uint64_t now) {
+    Mutex::Locker lock(mutex_);
+    if (state_ == OPEN) {
+        if (now < open_until_) {
+            return (REFUSED);
+        }
+
+        state_ = HALF_OPEN;
+    }
+
+    if (state_ == HALF_OPEN) {
+        // Only the probe goes through.
+        if (in_flight_ > 0) {
+            return (REFUSED);
+        }
+    } else if (in_flight_ >= static_cast<unsigned int>(window_)) {
+        return (THROTTLED);
+    }
+
+    ++in_flight_;
+    return (ADMITTED);
+}
+
+bool
+DnsServerThrottle::onSuccess(const unsigned int rtt) {
+    Mutex::Locker lock(mutex_);
+    if (in_flight_ > 0) {
+        --in_flight_;
+    }
+
+    // Smooth the round trip time as RFC 6298 does.  A sample of zero is
+    // taken as one so that srtt_ tells whether there has been one.
+    const double sample = std::max(rtt, 1U);
+    if (srtt_ == 0.0) {
+        srtt_ = sample;
+        rttvar_ = sample / 2;
+    } else {
+        rttvar_ = 0.75 * rttvar_ + 0.25 * std::fabs(srtt_ - sample);
+        srtt_ = 0.875 * srtt_ + 0.125 * sample;
+    }
+
+    backoff_ = 0;
+    failures_ = 0;
+
+    if (window_ < ssthresh_) {
+        window_ += 1;
+    } else {
+        window_ += 1 / window_;
+    }
+
+    window_ = std::min(window_, static_cast<double>(MAX_WINDOW));
+
+    if (state_ == CLOSED) {
+        return (false);
+    }
+
+    state_ = CLOSED;
+    cool_down_ = MIN_COOL_DOWN;
+    return (true);
+}
+
+bool
+DnsServerThrottle::onFailure(const uint64_t now) {
+    Mutex::Locker lock(mutex_);
+    if (in_flight_ > 0) {
+        --in_flight_;
+    }
+
+    ++failures_;
+    if (backoff_ < MAX_BACKOFF) {
+        ++backoff_;
+    }
+
+    ssthresh_ = std::max(window_ / 2, 1.0);
+    window_ = ssthresh_;
+
+    if (state_ == HALF_OPEN) {
+        // The probe failed, wait twice as long before the next one.
+        cool_down_ = std::min(cool_down_ * 2, MAX_COOL_DOWN);
+        open(now);
+        return (true);
+    }
+
+    if ((state_ == CLOSED) && (failures_ >= FAILURE_THRESHOLD)) {
+        open(now);
+        return (true);
+    }
+
+    return (false);
+}
+
+void
+DnsServerThrottle::release() {
+    Mutex::Locker lock(mutex_);
+    if (in_flight_ > 0) {
+        --in_flight_;
+    }
+}
+
+unsigned int
+DnsServerThrottle::getTimeout(const unsigned int max_timeout) const {
+    Mutex::Locker lock(mutex_);
+    if (srtt_ == 0.0) {
+        return (max_timeout);
+    }
+
+    double timeout = std::max(srtt_ + 4 * rttvar_,
+                              static_cast<double>(MIN_TIMEOUT));
+    timeout *= (1 << backoff_);
+    return (static_cast<unsigned int>(std::min(timeout,
+                                      static_cast<double>(max_timeout))));
+}
+
+unsigned int
+DnsServerThrottle::getWaitInterval() const {
+    Mutex::Locker lock(mutex_);
+    if (srtt_ == 0.0) {
+        return (DFT_WAIT_INTERVAL);
+    }
+
+    return (std::max(1U, std::min(static_cast<unsigned int>(srtt_ / 2),
+                                  MAX_WAIT_INTERVAL)));
+}
+
+unsigned int
+DnsServerThrottle::getWindow() const {
+    Mutex::Locker lock(mutex_);
+    return (static_cast<unsigned int>(window_));
+}
+
+unsigned int
+DnsServerThrottle::getInFlight() const {
+    Mutex::Locker lock(mutex_);
+    return (in_flight_);
+}
+
+unsigned int
+DnsServerThrottle::getSrtt() const {
+    Mutex::Locker lock(mutex_);
+    return (static_cast<unsigned int>(srtt_));
+}
+
+unsigned int
+DnsServerThrottle::getFailures() const {
+    Mutex::Locker lock(mutex_);
+    return (failures_);
+}
+
+unsigned int
+DnsServerThrottle::getCoolDown() const {
+    Mutex::Locker lock(mutex_);
+    return (cool_down_);
+}
+
+DnsServerThrottle::CircuitState
+DnsServerThrottle::getCircuitState() const {
+    Mutex::Locker lock(mutex_);
+    return (state_);
+}
+
+void
+DnsServerThrottle::open(const uint64_t now) {
+    state_ = OPEN;
+    open_until_ = now + cool_down_ * NANOS_PER_MS;
+}
+
+} // namespace isc::d2
+} // namespace isc
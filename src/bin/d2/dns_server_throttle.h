@@ -0,0 +1,230 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DNS_SERVER_THROTTLE_H
+#define DNS_SERVER_THROTTLE_H
+
+/// @file dns_server_throttle.h This file defines the class DnsServerThrottle.
+
+#include <util/threads/sync.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <stdint.h>
+
+namespace isc {
+namespace d2 {
+
+/// @brief Controls the load D2 puts on a single DNS server.
+///
+/// Each DNS server has a throttle, shared by all of the transactions which
+/// send updates to it.  A transaction asks the throttle before each update
+/// is sent and reports the outcome of the exchange to it.  The throttle
+/// uses the outcomes for three things:
+///
+/// - a congestion window limiting the number of updates in flight to the
+/// server.  It grows by one for every success until it reaches a threshold
+/// (slow start), by one for every window's worth of successes above it, and
+/// is halved on every failure (additive increase, multiplicative decrease).
+///
+/// - an estimation of the round trip time of the server, from which the
+/// timeout of the next update is derived (as in RFC 6298, bounded by the
+/// configured DNS server timeout).  Each failure doubles the timeout until
+/// the next success.
+///
+/// - a circuit breaker.  After a number of consecutive failures the circuit
+/// opens and the server is refused all updates for a cool down period.  It
+/// is then half open: a single update is let through as a probe.  A success
+/// closes the circuit, a failure opens it again for twice as long.
+///
+/// The throttle may be used by several IO threads at once.
+class DnsServerThrottle : public boost::noncopyable {
+public:
+    /// @brief Initial size of the congestion window.
+    static const unsigned int INITIAL_WINDOW = 4;
+
+    /// @brief Maximum size of the congestion window.
+    static const unsigned int MAX_WINDOW = 64;
+
+    /// @brief Lower bound of the computed timeout in milliseconds.
+    static const unsigned int MIN_TIMEOUT = 100;
+
+    /// @brief Number of consecutive failures which opens the circuit.
+    static const unsigned int FAILURE_THRESHOLD = 5;
+
+    /// @brief Initial cool down period of an open circuit in milliseconds.
+    static const unsigned int MIN_COOL_DOWN = 1000;
+
+    /// @brief Maximum cool down period of an open circuit in milliseconds.
+    static const unsigned int MAX_COOL_DOWN = 60000;
+
+    /// @brief Number of nanoseconds in a millisecond, to convert the
+    /// values returned by now().
+    static const uint64_t NANOS_PER_MS = 1000000;
+
+    /// @brief States of the circuit breaker.
+    enum CircuitState {
+        CLOSED,
+        OPEN,
+        HALF_OPEN
+    };
+
+    /// @brief Answers to a request to send an update.
+    enum Admission {
+        /// The update may be sent.
+        ADMITTED,
+        /// The window is full, the update may be sent later.
+        THROTTLED,
+        /// The circuit is open, the update should go to another server.
+        REFUSED
+    };
+
+    /// @brief Constructor
+    DnsServerThrottle();
+
+    /// @brief Destructor
+    virtual ~DnsServerThrottle();
+
+    /// @brief Returns the current time, as used by the throttle.
+    ///
+    /// This is the monotonic clock (see isc::util::getMonotonicNanos()),
+    /// so the changes of the system time don't shorten or extend the cool
+    /// down periods, nor distort the measured round trip times.
+    ///
+    /// @return Number of nanoseconds since an unspecified point in time.
+    static uint64_t now();
+
+    /// @brief Checks if the server may be selected for an update.
+    ///
+    /// @param now the current time
+    ///
+    /// @return false if the circuit is open and the cool down period has
+    /// not elapsed, or if the circuit is half open and the probe is in
+    /// flight.  True otherwise.
+    bool isAvailable(const uint64_t now =
+                     DnsServerThrottle::now()) const;
+
+    /// @brief Asks to send an update to the server.
+    ///
+    /// If the update is admitted the caller must report its outcome with
+    /// exactly one of onSuccess, onFailure or release.
+    ///
+    /// @param now the current time
+    ///
+    /// @return ADMITTED, THROTTLED or REFUSED.
+    Admission acquire(const uint64_t now =
+                      DnsServerThrottle::now());
+
+    /// @brief Reports the server answered an update.
+    ///
+    /// @param rtt the round trip time of the exchange in milliseconds
+    ///
+    /// @return true if this closed the circuit.
+    bool onSuccess(const unsigned int rtt);
+
+    /// @brief Reports the server did not answer an update.
+    ///
+    /// @param now the current time
+    ///
+    /// @return true if this opened the circuit.
+    bool onFailure(const uint64_t now =
+                   DnsServerThrottle::now());
+
+    /// @brief Reports an update ended without telling anything about the
+    /// server, e.g. because IO was stopped.
+    void release();
+
+    /// @brief Returns the timeout to use for the next update.
+    ///
+    /// @param max_timeout the configured DNS server timeout in milliseconds
+    ///
+    /// @return max_timeout until a round trip time has been measured, the
+    /// computed timeout bounded by MIN_TIMEOUT and max_timeout afterwards.
+    unsigned int getTimeout(const unsigned int max_timeout) const;
+
+    /// @brief Returns how long to wait before asking again after being
+    /// throttled, in milliseconds.
+    unsigned int getWaitInterval() const;
+
+    /// @brief Returns the size of the congestion window.
+    unsigned int getWindow() const;
+
+    /// @brief Returns the number of updates in flight.
+    unsigned int getInFlight() const;
+
+    /// @brief Returns the smoothed round trip time in milliseconds, zero
+    /// until it has been measured.
+    unsigned int getSrtt() const;
+
+    /// @brief Returns the number of consecutive failures.
+    unsigned int getFailures() const;
+
+    /// @brief Returns the cool down period of the circuit in milliseconds.
+    unsigned int getCoolDown() const;
+
+    /// @brief Returns the state of the circuit breaker.
+    ///
+    /// An open circuit whose cool down period has elapsed is reported as
+    /// open until the next call to acquire.
+    CircuitState getCircuitState() const;
+
+private:
+    /// @brief Opens the circuit.
+    ///
+    /// @param now the current time
+    void open(const uint64_t now);
+
+    /// @brief Protects the members below.
+    mutable isc::util::thread::Mutex mutex_;
+
+    /// @brief Size of the congestion window, in updates.
+    double window_;
+
+    /// @brief Slow start threshold.
+    double ssthresh_;
+
+    /// @brief Number of updates in flight.
+    unsigned int in_flight_;
+
+    /// @brief Smoothed round trip time in milliseconds.
+    double srtt_;
+
+    /// @brief Round trip time variation in milliseconds.
+    double rttvar_;
+
+    /// @brief Number of times the timeout is doubled.
+    unsigned int backoff_;
+
+    /// @brief Number of consecutive failures.
+    unsigned int failures_;
+
+    /// @brief State of the circuit breaker.
+    CircuitState state_;
+
+    /// @brief Cool down period of the circuit in milliseconds.
+    unsigned int cool_down_;
+
+    /// @brief End of the cool down period of an open circuit, as returned
+    /// by now().
+    uint64_t open_until_;
+};
+
+/// @brief Defines a pointer to a DnsServerThrottle.
+typedef boost::shared_ptr<DnsServerThrottle> DnsServerThrottlePtr;
+
+} // namespace isc::d2
+} // namespace isc
+
+#endif
@@ -666,8 +666,7 @@ NameAddTransaction::buildReplaceRevPtrsRequest() {
     D2UpdateMessagePtr request = prepNewRequest(getReverseDomain());
 
     // Create the reverse IP address "FQDN".
-    std::string rev_addr = D2CfgMgr::reverseIpAddress(getNcr()->getIpAddress());
-    dns::Name rev_ip(rev_addr);
+    dns::Name rev_ip(D2CfgMgr::reverseIpName(getNcr()->getIpIoAddress()));
 
     // Create the TTL based on lease length.
     dns::RRTTL lease_ttl(getNcr()->getLeaseLength());
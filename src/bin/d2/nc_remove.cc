@@ -670,8 +670,7 @@ NameRemoveTransaction::buildRemoveRevPtrsRequest() {
     D2UpdateMessagePtr request = prepNewRequest(getReverseDomain());
 
     // Create the reverse IP address "FQDN".
-    std::string rev_addr = D2CfgMgr::reverseIpAddress(getNcr()->getIpAddress());
-    dns::Name rev_ip(rev_addr);
+    dns::Name rev_ip(D2CfgMgr::reverseIpName(getNcr()->getIpIoAddress()));
 
     // Content on this request is based on RFC 4703, section 5.5, paragraph 2.
     // First build the Prerequisite Section.
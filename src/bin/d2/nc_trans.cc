@@ -13,9 +13,12 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <d2/d2_log.h>
+#include <d2/d2_update_message_pool.h>
 #include <d2/nc_trans.h>
 #include <dns/rdata.h>
 
+#include <boost/bind.hpp>
+
 #include <sstream>
 
 namespace isc {
@@ -54,7 +57,8 @@ NameChangeTransaction(IOServicePtr& io_service,
      dns_update_status_(DNSClient::OTHER), dns_update_response_(),
      forward_change_completed_(false), reverse_change_completed_(false),
      current_server_list_(), current_server_(), next_server_pos_(0),
-     update_attempts_(0), cfg_mgr_(cfg_mgr), tsig_key_() {
+     update_attempts_(0), throttle_(), send_time_(0), wait_timer_(),
+     cfg_mgr_(cfg_mgr), d2_params_(), done_handler_(), tsig_key_() {
     /// @todo if io_service is NULL we are multi-threading and should
     /// instantiate our own
     if (!io_service_) {
@@ -80,9 +84,12 @@ NameChangeTransaction(IOServicePtr& io_service,
         isc_throw(NameChangeTransactionError,
                   "Configuration manager cannot be null");
     }
+
+    d2_params_ = cfg_mgr_->getD2Params();
 }
 
 NameChangeTransaction::~NameChangeTransaction(){
+    releaseThrottle();
 }
 
 void
@@ -93,6 +100,22 @@ NameChangeTransaction::startTransaction() {
 
     setNcrStatus(dhcp_ddns::ST_PENDING);
     startModel(READY_ST);
+    checkDone();
+}
+
+void
+NameChangeTransaction::setDoneHandler(const DoneHandler& handler) {
+    done_handler_ = handler;
+}
+
+void
+NameChangeTransaction::checkDone() {
+    if (isModelDone() && done_handler_) {
+        // Make sure it is invoked only once.
+        DoneHandler handler;
+        handler.swap(done_handler_);
+        handler();
+    }
 }
 
 void
@@ -101,6 +124,7 @@ NameChangeTransaction::operator()(DNSClient::Status status) {
     // set to indicate IO completed.
     // runModel is exception safe so we are good to call it here.
     // It won't exit until we hit the next IO wait or the state model ends.
+    reportToThrottle(status);
     setDnsUpdateStatus(status);
     LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
               DHCP_DDNS_UPDATE_RESPONSE_RECEIVED)
@@ -109,6 +133,7 @@ NameChangeTransaction::operator()(DNSClient::Status status) {
               .arg(responseString());
 
     runModel(IO_COMPLETED_EVT);
+    checkDone();
 }
 
 std::string
@@ -170,15 +195,51 @@ NameChangeTransaction::transactionOutcomeString() const {
 void
 NameChangeTransaction::sendUpdate(const std::string& comment) {
     try {
+        // A previous update whose outcome was never reported no longer
+        // counts against the server, nor does an earlier wait.
+        releaseThrottle();
+        if (wait_timer_) {
+            wait_timer_->cancel();
+        }
+
+        const DnsServerThrottlePtr& throttle = current_server_->getThrottle();
+        switch (throttle->acquire()) {
+        case DnsServerThrottle::THROTTLED:
+            LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL_DATA,
+                      DHCP_DDNS_UPDATE_REQUEST_THROTTLED)
+                      .arg(getTransactionKey().toStr())
+                      .arg(current_server_->toText())
+                      .arg(throttle->getInFlight());
+            waitToSend(throttle->getWaitInterval());
+            return;
+
+        case DnsServerThrottle::REFUSED:
+            // Give up on this server without sending anything.
+            LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
+                      DHCP_DDNS_UPDATE_REQUEST_REFUSED)
+                      .arg(getTransactionKey().toStr())
+                      .arg(current_server_->toText());
+            update_attempts_ = MAX_UPDATE_TRIES_PER_SERVER;
+            setDnsUpdateStatus(DNSClient::OTHER);
+            postNextEvent(IO_COMPLETED_EVT);
+            return;
+
+        default:
+            break;
+        }
+
+        throttle_ = throttle;
+        send_time_ = DnsServerThrottle::now();
         ++update_attempts_;
         // @todo add logic to add/replace TSIG key info in request if
         // use_tsig_ is true. We should be able to navigate to the TSIG key
         // for the current server.  If not we would need to add that.
 
-        D2ParamsPtr d2_params = cfg_mgr_->getD2Params();
         dns_client_->doUpdate(*io_service_, current_server_->getIpAddress(),
                               current_server_->getPort(), *dns_update_request_,
-                              d2_params->getDnsServerTimeout(), tsig_key_);
+                              throttle->getTimeout(d2_params_->
+                                                   getDnsServerTimeout()),
+                              tsig_key_);
         // Message is on its way, so the next event should be NOP_EVT.
         postNextEvent(NOP_EVT);
         LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
@@ -196,10 +257,74 @@ NameChangeTransaction::sendUpdate(const std::string& comment) {
         // is corrupt in some way and cannot be completed, therefore we will
         // log it and transition it to failure.
         LOG_ERROR(dctl_logger, DHCP_DDNS_TRANS_SEND_ERROR).arg(ex.what());
+        releaseThrottle();
         transition(PROCESS_TRANS_FAILED_ST, UPDATE_FAILED_EVT);
     }
 }
 
+void
+NameChangeTransaction::waitToSend(const long interval) {
+    if (!wait_timer_) {
+        wait_timer_.reset(new asiolink::IntervalTimer(*io_service_));
+    }
+
+    wait_timer_->setup(boost::bind(&NameChangeTransaction::retrySend, this),
+                       interval, asiolink::IntervalTimer::ONE_SHOT);
+    postNextEvent(NOP_EVT);
+}
+
+void
+NameChangeTransaction::retrySend() {
+    // The state handlers send the update again on SERVER_SELECTED_EVT, as
+    // they do for a retry.
+    runModel(SERVER_SELECTED_EVT);
+    checkDone();
+}
+
+void
+NameChangeTransaction::reportToThrottle(const DNSClient::Status status) {
+    if (!throttle_) {
+        return;
+    }
+
+    DnsServerThrottlePtr throttle;
+    throttle.swap(throttle_);
+    switch (status) {
+    case DNSClient::SUCCESS:
+    case DNSClient::INVALID_RESPONSE: {
+        // The server answered, whatever it said.
+        const uint64_t rtt = DnsServerThrottle::now() - send_time_;
+        if (throttle->onSuccess(rtt / DnsServerThrottle::NANOS_PER_MS)) {
+            LOG_INFO(dctl_logger, DHCP_DDNS_SERVER_CIRCUIT_CLOSED)
+                     .arg(current_server_->toText());
+        }
+        break;
+    }
+
+    case DNSClient::TIMEOUT:
+    case DNSClient::OTHER:
+        if (throttle->onFailure()) {
+            LOG_WARN(dctl_logger, DHCP_DDNS_SERVER_CIRCUIT_OPENED)
+                     .arg(current_server_->toText())
+                     .arg(throttle->getFailures())
+                     .arg(throttle->getCoolDown());
+        }
+        break;
+
+    default:
+        throttle->release();
+        break;
+    }
+}
+
+void
+NameChangeTransaction::releaseThrottle() {
+    if (throttle_) {
+        throttle_->release();
+        throttle_.reset();
+    }
+}
+
 void
 NameChangeTransaction::defineEvents() {
     // Call superclass impl first.
@@ -319,9 +444,9 @@ NameChangeTransaction::prepNewRequest(DdnsDomainPtr domain) {
     }
 
     try {
-        // Create a "blank" update request.
-        D2UpdateMessagePtr request(new D2UpdateMessage(D2UpdateMessage::
-                                                       OUTBOUND));
+        // Get a "blank" update request from the pool.
+        D2UpdateMessagePtr request = D2UpdateMessagePool::instance().
+            acquireMessage(D2UpdateMessage::OUTBOUND);
         // Construct the Zone Section.
         dns::Name zone_name(domain->getName());
         request->setZone(zone_name, dns::RRClass::IN());
@@ -438,6 +563,18 @@ NameChangeTransaction::initServerSelection(const DdnsDomainPtr& domain) {
 
 bool
 NameChangeTransaction::selectNextServer() {
+    // Skip the servers whose circuit is open.
+    while ((current_server_list_) &&
+           (next_server_pos_ < current_server_list_->size()) &&
+           !(*current_server_list_)[next_server_pos_]->getThrottle()->
+           isAvailable()) {
+        LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_SERVER_UNAVAILABLE)
+                  .arg(getTransactionKey().toStr())
+                  .arg((*current_server_list_)[next_server_pos_]->toText());
+        ++next_server_pos_;
+    }
+
     if ((current_server_list_) &&
         (next_server_pos_ < current_server_list_->size())) {
         current_server_  = (*current_server_list_)[next_server_pos_];
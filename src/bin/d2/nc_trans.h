@@ -22,9 +22,11 @@
 #include <d2/d2_cfg_mgr.h>
 #include <d2/dns_client.h>
 #include <d2/state_model.h>
+#include <asiolink/interval_timer.h>
 #include <dhcp_ddns/ncr_msg.h>
 #include <dns/tsig.h>
 
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <map>
 
@@ -183,6 +185,19 @@ public:
     /// @brief Destructor
     virtual ~NameChangeTransaction();
 
+    /// @brief Defines the function invoked when the transaction ends.
+    typedef boost::function<void()> DoneHandler;
+
+    /// @brief Sets the function invoked when the transaction ends.
+    ///
+    /// The handler is invoked once, from within startTransaction() or the
+    /// IO completion handler, on the thread running the transaction's
+    /// IOService, as soon as the state model is done.  It must not destroy
+    /// the transaction.
+    ///
+    /// @param handler is the function to invoke.
+    void setDoneHandler(const DoneHandler& handler);
+
     /// @brief Begins execution of the transaction.
     ///
     /// This method invokes StateModel::startModel() with a value of READY_ST.
@@ -210,6 +225,14 @@ protected:
     /// currently selected server.  Since the send is asynchronous, the method
     /// posts NOP_EVT as the next event and then returns.
     ///
+    /// The server's throttle is asked first.  If too many updates are in
+    /// flight to the server, the send is retried later by re-entering the
+    /// current state with SERVER_SELECTED_EVT.  If the server's circuit is
+    /// open, no update is sent: the attempts on the server are exhausted and
+    /// IO_COMPLETED_EVT is posted with a status of DNSClient::OTHER so the
+    /// state moves on to the next server.  The timeout of the update is
+    /// given by the throttle, within the configured DNS server timeout.
+    ///
     /// If tsig_key_ is not NULL, then the update will be conducted using
     /// the key to sign the request and verify the response, otherwise it
     /// will be conducted without TSIG.
@@ -522,6 +545,31 @@ public:
     const dns::RRType& getAddressRRType() const;
 
 private:
+    /// @brief Invokes the done handler if the state model is done.
+    void checkDone();
+
+    /// @brief Waits before trying to send the update again.
+    ///
+    /// @param interval the time to wait in milliseconds
+    void waitToSend(const long interval);
+
+    /// @brief Re-enters the current state to send the update again.
+    ///
+    /// This is the callback of the wait timer.
+    void retrySend();
+
+    /// @brief Reports the outcome of the update in flight to the throttle of
+    /// its server.
+    ///
+    /// It has no effect if there is no such update.
+    ///
+    /// @param status is the outcome of the DNS update packet exchange.
+    void reportToThrottle(const DNSClient::Status status);
+
+    /// @brief Releases the throttle slot of an update in flight whose
+    /// outcome will not be reported.
+    void releaseThrottle();
+
     /// @brief The IOService which should be used to for IO processing.
     IOServicePtr io_service_;
 
@@ -575,9 +623,28 @@ private:
     /// @brief Number of transmit attempts for the current request.
     size_t update_attempts_;
 
+    /// @brief Throttle which admitted the update in flight, if any.
+    DnsServerThrottlePtr throttle_;
+
+    /// @brief Time at which the update in flight was sent, as returned
+    /// by DnsServerThrottle::now().
+    uint64_t send_time_;
+
+    /// @brief Timer used to wait when the server's throttle is full.
+    asiolink::IntervalTimerPtr wait_timer_;
+
     /// @brief Pointer to the configuration manager.
     D2CfgMgrPtr cfg_mgr_;
 
+    /// @brief The D2 global parameters when the transaction was created.
+    ///
+    /// The transaction may run on another thread than the configuration
+    /// manager, so it does not fetch them again.
+    D2ParamsPtr d2_params_;
+
+    /// @brief Function invoked when the transaction ends.
+    DoneHandler done_handler_;
+
     /// @brief Pointer to the TSIG key which should be used (if any).
     dns::TSIGKeyPtr tsig_key_;
 };
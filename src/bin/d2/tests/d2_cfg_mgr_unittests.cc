@@ -545,6 +545,43 @@ TEST_F(D2CfgMgrTest, invalidEntry) {
     runConfig(config, SHOULD_FAIL);
 }
 
+/// @brief Tests the parsing of the number of IO threads.
+/// It verifies that:
+/// -# io_threads defaults to one
+/// -# io_threads can be set within its range
+/// -# io_threads cannot be 0 or more than the maximum
+TEST_F(D2CfgMgrTest, ioThreads) {
+    std::string config = makeParamsConfigString ("127.0.0.1", 777, 333,
+                                                 "UDP", "JSON");
+    runConfig(config);
+    EXPECT_EQ(D2Params::DFT_IO_THREADS, d2_params_->getIoThreads());
+
+    config = "{"
+            " \"io_threads\": 4 , "
+            "\"tsig_keys\": [], "
+            "\"forward_ddns\" : {}, "
+            "\"reverse_ddns\" : {} "
+            "}";
+    runConfig(config);
+    EXPECT_EQ(4, d2_params_->getIoThreads());
+
+    config = "{"
+            " \"io_threads\": 0 , "
+            "\"tsig_keys\": [], "
+            "\"forward_ddns\" : {}, "
+            "\"reverse_ddns\" : {} "
+            "}";
+    runConfig(config, SHOULD_FAIL);
+
+    config = "{"
+            " \"io_threads\": 65 , "
+            "\"tsig_keys\": [], "
+            "\"forward_ddns\" : {}, "
+            "\"reverse_ddns\" : {} "
+            "}";
+    runConfig(config, SHOULD_FAIL);
+}
+
 /// @brief Tests the enforcement of data validation when parsing TSIGKeyInfos.
 /// It verifies that:
 /// 1. Name cannot be blank.
@@ -1628,6 +1665,25 @@ TEST_F(D2CfgMgrTest, matchReverse) {
     ASSERT_THROW(cfg_mgr_->matchReverse("", match), D2CfgError);
 }
 
+/// @brief Tests the reverse lookup names and strings of IP addresses.
+TEST(D2CfgMgr, reverseIpName) {
+    const isc::asiolink::IOAddress v4("192.168.1.15");
+    EXPECT_EQ(dns::Name("15.1.168.192.in-addr.arpa."),
+              D2CfgMgr::reverseIpName(v4));
+    EXPECT_EQ("15.1.168.192.in-addr.arpa.",
+              D2CfgMgr::reverseIpAddress("192.168.1.15"));
+
+    const isc::asiolink::IOAddress v6("2001:db8:302:99::");
+    const std::string v6_name = "0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0."
+                                "9.9.0.0.2.0.3.0.8.b.d.0.1.0.0.2.ip6.arpa.";
+    EXPECT_EQ(dns::Name(v6_name), D2CfgMgr::reverseIpName(v6));
+    EXPECT_EQ(v6_name, D2CfgMgr::reverseIpAddress("2001:db8:302:99::"));
+
+    EXPECT_THROW(D2CfgMgr::reverseV4Address(v6), D2CfgError);
+    EXPECT_THROW(D2CfgMgr::reverseV6Address(v4), D2CfgError);
+    EXPECT_THROW(D2CfgMgr::reverseIpAddress("bogus"), D2CfgError);
+}
+
 /// @brief Tests D2 config parsing against a wide range of config permutations.
 /// It iterates over all of the test configurations described in given file.
 /// The file content is JSON specialized to this test. The format of the file
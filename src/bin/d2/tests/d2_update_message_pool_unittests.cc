@@ -0,0 +1,226 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <d2/d2_update_message_pool.h>
+#include <dns/messagerenderer.h>
+#include <dns/rrttl.h>
+#include <dns/tsig.h>
+#include <util/threads/thread.h>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace isc;
+using namespace isc::d2;
+using namespace isc::dns;
+using namespace isc::util;
+using isc::util::thread::Thread;
+
+namespace {
+
+/// @brief Builds a request with the Zone and one prerequisite.
+///
+/// @param message message to be populated.
+void buildRequest(D2UpdateMessage& message) {
+    message.setId(0x1234);
+    message.setZone(Name("example.com"), RRClass::IN());
+    RRsetPtr prereq(new RRset(Name("foo.example.com"), RRClass::NONE(),
+                              RRType::ANY(), RRTTL(0)));
+    message.addRRset(D2UpdateMessage::SECTION_PREREQUISITE, prereq);
+}
+
+// This test verifies that the released messages are handed out again,
+// cleared for the requested direction.
+TEST(D2UpdateMessagePoolTest, acquireMessage) {
+    D2UpdateMessagePool pool;
+    EXPECT_EQ(0, pool.getFreeMessageCount());
+
+    D2UpdateMessagePtr message =
+        pool.acquireMessage(D2UpdateMessage::OUTBOUND);
+    ASSERT_TRUE(message);
+    EXPECT_EQ(D2UpdateMessage::REQUEST, message->getQRFlag());
+    buildRequest(*message);
+
+    // Dropping the last reference returns the message to the pool.
+    D2UpdateMessage* raw = message.get();
+    message.reset();
+    EXPECT_EQ(1, pool.getFreeMessageCount());
+
+    // The same message is handed out again, blank.
+    message = pool.acquireMessage(D2UpdateMessage::OUTBOUND);
+    EXPECT_EQ(raw, message.get());
+    EXPECT_EQ(0, pool.getFreeMessageCount());
+    EXPECT_EQ(0, message->getId());
+    EXPECT_FALSE(message->getZone());
+    EXPECT_EQ(0, message->getRRCount(D2UpdateMessage::SECTION_PREREQUISITE));
+
+    // The message can be reused in the other direction. The request is
+    // parsed into it, which fails on the QR flag check only after the
+    // message has been parsed.
+    buildRequest(*message);
+    MessageRenderer renderer;
+    message->toWire(renderer);
+    message.reset();
+    message = pool.acquireMessage(D2UpdateMessage::INBOUND);
+    EXPECT_EQ(raw, message.get());
+    EXPECT_THROW(message->fromWire(renderer.getData(), renderer.getLength()),
+                 InvalidQRFlag);
+    EXPECT_EQ(0x1234, message->getId());
+}
+
+// This test verifies that the number of free objects is bounded.
+TEST(D2UpdateMessagePoolTest, maxFree) {
+    D2UpdateMessagePool pool(2);
+    std::vector<D2UpdateMessagePtr> messages;
+    std::vector<OutputBufferPtr> buffers;
+    for (int i = 0; i < 3; ++i) {
+        messages.push_back(pool.acquireMessage(D2UpdateMessage::OUTBOUND));
+        buffers.push_back(pool.acquireBuffer());
+    }
+    messages.clear();
+    buffers.clear();
+    EXPECT_EQ(2, pool.getFreeMessageCount());
+    EXPECT_EQ(2, pool.getFreeBufferCount());
+}
+
+// This test verifies that the objects may outlive the pool.
+TEST(D2UpdateMessagePoolTest, outlivePool) {
+    D2UpdateMessagePtr message;
+    OutputBufferPtr buffer;
+    {
+        D2UpdateMessagePool pool;
+        message = pool.acquireMessage(D2UpdateMessage::OUTBOUND);
+        buffer = pool.acquireBuffer();
+    }
+    buildRequest(*message);
+    buffer->writeUint8(1);
+    // The objects are deleted when released.
+    EXPECT_NO_THROW(message.reset());
+    EXPECT_NO_THROW(buffer.reset());
+}
+
+// This test verifies that the message rendered by the pool is the same
+// as the message rendered with a new renderer and that the buffers are
+// reused.
+TEST(D2UpdateMessagePoolTest, render) {
+    D2UpdateMessagePool pool;
+    D2UpdateMessage message;
+    buildRequest(message);
+
+    MessageRenderer renderer;
+    message.toWire(renderer);
+
+    for (int i = 0; i < 2; ++i) {
+        OutputBufferPtr buffer;
+        ASSERT_NO_THROW(buffer = pool.render(message));
+        ASSERT_TRUE(buffer);
+        ASSERT_EQ(renderer.getLength(), buffer->getLength());
+        EXPECT_EQ(0, memcmp(renderer.getData(), buffer->getData(),
+                            buffer->getLength()));
+        EXPECT_EQ(0, pool.getFreeBufferCount());
+        buffer.reset();
+        EXPECT_EQ(1, pool.getFreeBufferCount());
+    }
+
+    // The message rendered after an error is not affected by it.
+    D2UpdateMessage no_zone;
+    EXPECT_THROW(pool.render(no_zone), InvalidZoneSection);
+    EXPECT_EQ(1, pool.getFreeBufferCount());
+    OutputBufferPtr buffer = pool.render(message);
+    ASSERT_EQ(renderer.getLength(), buffer->getLength());
+    EXPECT_EQ(0, memcmp(renderer.getData(), buffer->getData(),
+                        buffer->getLength()));
+}
+
+// This test verifies that the message is signed when rendered with
+// the TSIG context.
+TEST(D2UpdateMessagePoolTest, renderTSIG) {
+    D2UpdateMessagePool pool;
+    D2UpdateMessage message;
+    buildRequest(message);
+
+    const std::string secret("random text for secret");
+    TSIGKey key(Name("test_key"), TSIGKey::HMACMD5_NAME(), secret.c_str(),
+                secret.size());
+    TSIGContext context(key);
+    OutputBufferPtr buffer = pool.render(message, &context);
+
+    // Verify the signature, acting as the server.
+    TSIGContext server_context(key);
+    D2UpdateMessage received(D2UpdateMessage::INBOUND);
+    // The message passes the TSIG verification and fails the QR flag
+    // check, as it is not really a response.
+    EXPECT_THROW(received.fromWire(buffer->getData(), buffer->getLength(),
+                                   &server_context), InvalidQRFlag);
+}
+
+/// @brief Renders and parses messages from the pool, as the threads
+/// running the DNS update transactions do.
+///
+/// @param pool pool to use.
+/// @param expected wire data of the message.
+/// @param failures incremented for each message not rendered as expected.
+void renderLoop(D2UpdateMessagePool* pool, const OutputBuffer* expected,
+                int* failures) {
+    for (int i = 0; i < 1000; ++i) {
+        D2UpdateMessagePtr message =
+            pool->acquireMessage(D2UpdateMessage::OUTBOUND);
+        buildRequest(*message);
+        OutputBufferPtr buffer = pool->render(*message);
+        if ((buffer->getLength() != expected->getLength()) ||
+            (memcmp(buffer->getData(), expected->getData(),
+                    buffer->getLength()) != 0)) {
+            ++(*failures);
+        }
+    }
+}
+
+// This test verifies that the pool can be used from several threads.
+TEST(D2UpdateMessagePoolTest, threads) {
+    D2UpdateMessagePool pool;
+    D2UpdateMessage message;
+    buildRequest(message);
+    MessageRenderer renderer;
+    message.toWire(renderer);
+    OutputBuffer expected(0);
+    expected.writeData(renderer.getData(), renderer.getLength());
+
+    const size_t thread_count = 4;
+    std::vector<int> failures(thread_count, 0);
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(
+            new Thread(boost::bind(&renderLoop, &pool, &expected,
+                                   &failures[i]))));
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads[i]->wait();
+        EXPECT_EQ(0, failures[i]);
+    }
+
+    // The objects have all been returned to the pool.
+    EXPECT_GE(thread_count, pool.getFreeMessageCount());
+    EXPECT_LT(0, pool.getFreeMessageCount());
+    EXPECT_GE(thread_count, pool.getFreeBufferCount());
+    EXPECT_GE(thread_count, pool.getFreeRendererCount());
+    EXPECT_LT(0, pool.getFreeRendererCount());
+}
+
+}
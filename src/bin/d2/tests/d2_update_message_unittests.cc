@@ -18,11 +18,14 @@
 #include <d2/d2_update_message.h>
 #include <d2/d2_zone.h>
 #include <dns/messagerenderer.h>
+#include <dns/opcode.h>
+#include <dns/question.h>
 #include <dns/rdataclass.h>
 #include <dns/rdata.h>
 #include <dns/rrttl.h>
 
 #include <boost/scoped_ptr.hpp>
+#include <cstring>
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -701,5 +704,70 @@ TEST_F(D2UpdateMessageTest, allValidTSIG) {
     }
 }
 
+// This test verifies that the cleared message can be reused to build
+// another request and to parse another response.
+TEST_F(D2UpdateMessageTest, clear) {
+    // Build and render a request.
+    D2UpdateMessage msg;
+    msg.setId(0x1234);
+    msg.setZone(Name("example.com"), RRClass::IN());
+    RRsetPtr prereq(new RRset(Name("foo.example.com"), RRClass::NONE(),
+                              RRType::ANY(), RRTTL(0)));
+    msg.addRRset(D2UpdateMessage::SECTION_PREREQUISITE, prereq);
+    MessageRenderer renderer;
+    ASSERT_NO_THROW(msg.toWire(renderer));
+
+    // Clear the request and check that it is blank.
+    msg.clear(D2UpdateMessage::OUTBOUND);
+    EXPECT_EQ(D2UpdateMessage::REQUEST, msg.getQRFlag());
+    EXPECT_EQ(Rcode::NOERROR_CODE, msg.getRcode().getCode());
+    EXPECT_EQ(0, msg.getId());
+    EXPECT_FALSE(msg.getZone());
+    EXPECT_EQ(0, msg.getRRCount(D2UpdateMessage::SECTION_ZONE));
+    EXPECT_EQ(0, msg.getRRCount(D2UpdateMessage::SECTION_PREREQUISITE));
+
+    // The cleared request must render to the same data as a new one.
+    msg.setZone(Name("example.org"), RRClass::IN());
+    renderer.clear();
+    ASSERT_NO_THROW(msg.toWire(renderer));
+    D2UpdateMessage fresh;
+    fresh.setZone(Name("example.org"), RRClass::IN());
+    MessageRenderer fresh_renderer;
+    ASSERT_NO_THROW(fresh.toWire(fresh_renderer));
+    ASSERT_EQ(fresh_renderer.getLength(), renderer.getLength());
+    EXPECT_EQ(0, memcmp(fresh_renderer.getData(), renderer.getData(),
+                        renderer.getLength()));
+
+    // Create the wire data of a response.
+    Message response(Message::RENDER);
+    response.setQid(0x4321);
+    response.setOpcode(Opcode(Opcode::UPDATE_CODE));
+    response.setHeaderFlag(Message::HEADERFLAG_QR, true);
+    response.setRcode(Rcode::NOTAUTH());
+    response.addQuestion(Question(Name("example.com"), RRClass::IN(),
+                                  RRType::SOA()));
+    MessageRenderer response_renderer;
+    response.toWire(response_renderer);
+
+    // Reuse the request to parse the response.
+    msg.clear(D2UpdateMessage::INBOUND);
+    ASSERT_NO_THROW(msg.fromWire(response_renderer.getData(),
+                                 response_renderer.getLength()));
+    EXPECT_EQ(D2UpdateMessage::RESPONSE, msg.getQRFlag());
+    EXPECT_EQ(0x4321, msg.getId());
+    EXPECT_EQ(Rcode::NOTAUTH_CODE, msg.getRcode().getCode());
+    D2ZonePtr zone = msg.getZone();
+    ASSERT_TRUE(zone);
+    EXPECT_EQ("example.com.", zone->getName().toText());
+
+    // Reuse the response as a request again.
+    msg.clear(D2UpdateMessage::OUTBOUND);
+    msg.setZone(Name("example.org"), RRClass::IN());
+    renderer.clear();
+    ASSERT_NO_THROW(msg.toWire(renderer));
+    ASSERT_EQ(fresh_renderer.getLength(), renderer.getLength());
+    EXPECT_EQ(0, memcmp(fresh_renderer.getData(), renderer.getData(),
+                        renderer.getLength()));
+}
 
 } // End of anonymous namespace
@@ -864,4 +864,48 @@ TEST_F(D2UpdateMgrTest, multiTransactionTimeout) {
     }
 }
 
+/// @brief Tests processing of multiple transactions by IO threads.
+/// This test verifies that update manager can run transactions on a pool
+/// of worker threads, that the transactions remove themselves from the list
+/// once done and that the pool can be stopped.  It uses a fake server that
+/// responds to all requests sent with NOERROR.
+TEST_F(D2UpdateMgrTest, multiTransactionThreads) {
+    EXPECT_THROW(update_mgr_->setIoThreads(0), D2UpdateMgrError);
+    ASSERT_NO_THROW(update_mgr_->setIoThreads(2));
+    EXPECT_EQ(1, update_mgr_->getIoThreads());
+
+    // Queue up all the requests.
+    int test_count = canned_count_;
+    for (int i = test_count; i > 0; i--) {
+        canned_ncrs_[i-1]->setReverseChange(true);
+        ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i-1]));
+    }
+
+    // The server runs on the test's IOService, the transactions on the
+    // threads'.
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::NOERROR());
+
+    // Completed transactions are removed by a handler posted to the test's
+    // IOService, so run it until everything is done.
+    size_t timeout = cfg_mgr_->getD2Params()->getDnsServerTimeout() + 100;
+    for (size_t passes = 0; update_mgr_->getQueueCount() ||
+         update_mgr_->getTransactionCount(); ++passes) {
+        ASSERT_LT(passes, 100);
+        update_mgr_->sweep();
+        runTimedIO(timeout);
+    }
+
+    EXPECT_EQ(2, update_mgr_->getIoThreads());
+    for (int i = 0; i < test_count; i++) {
+        EXPECT_EQ(dhcp_ddns::ST_COMPLETED, canned_ncrs_[i]->getStatus());
+    }
+
+    // Going back to a single thread stops the pool.
+    ASSERT_NO_THROW(update_mgr_->setIoThreads(1));
+    update_mgr_->sweep();
+    EXPECT_EQ(1, update_mgr_->getIoThreads());
+}
+
 }
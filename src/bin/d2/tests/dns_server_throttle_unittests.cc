@@ -0,0 +1,190 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <d2/dns_server_throttle.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc::d2;
+
+namespace {
+
+/// @brief Admits updates until the throttle stops admitting them.
+///
+/// @param throttle the throttle to fill
+/// @param now the current time
+///
+/// @return the number of updates admitted
+unsigned int
+fill(DnsServerThrottle& throttle, const uint64_t now) {
+    unsigned int count = 0;
+    while (throttle.acquire(now) == DnsServerThrottle::ADMITTED) {
+        ++count;
+        if (count > DnsServerThrottle::MAX_WINDOW) {
+            ADD_FAILURE() << "window is not enforced";
+            break;
+        }
+    }
+
+    return (count);
+}
+
+/// @brief Verifies the number of updates in flight is limited by a window
+/// which grows with successes and is halved on failures.
+TEST(DnsServerThrottleTest, window) {
+    DnsServerThrottle throttle;
+    const uint64_t now = DnsServerThrottle::now();
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle.getWindow());
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, fill(throttle, now));
+    EXPECT_EQ(DnsServerThrottle::THROTTLED, throttle.acquire(now));
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle.getInFlight());
+
+    // Slow start: each success opens the window by one.
+    for (unsigned int i = 0; i < DnsServerThrottle::INITIAL_WINDOW; ++i) {
+        EXPECT_FALSE(throttle.onSuccess(10));
+    }
+    EXPECT_EQ(0, throttle.getInFlight());
+    EXPECT_EQ(2 * DnsServerThrottle::INITIAL_WINDOW, throttle.getWindow());
+
+    // A failure halves it.
+    EXPECT_EQ(2 * DnsServerThrottle::INITIAL_WINDOW, fill(throttle, now));
+    EXPECT_FALSE(throttle.onFailure(now));
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle.getWindow());
+
+    // Releasing a slot does not change the window.
+    for (unsigned int i = 1; i < 2 * DnsServerThrottle::INITIAL_WINDOW; ++i) {
+        throttle.release();
+    }
+    EXPECT_EQ(0, throttle.getInFlight());
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle.getWindow());
+
+    // Above the slow start threshold it takes about a window's worth of
+    // successes to open it by one.
+    for (unsigned int i = 1; i < DnsServerThrottle::INITIAL_WINDOW; ++i) {
+        ASSERT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+        throttle.onSuccess(10);
+    }
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle.getWindow());
+    throttle.onSuccess(10);
+    throttle.onSuccess(10);
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW + 1, throttle.getWindow());
+
+    // It never goes over the maximum or under one.
+    for (unsigned int i = 0; i < 100 * DnsServerThrottle::MAX_WINDOW; ++i) {
+        throttle.onSuccess(10);
+    }
+    EXPECT_EQ(DnsServerThrottle::MAX_WINDOW, throttle.getWindow());
+    for (unsigned int i = 0; i < 10; ++i) {
+        throttle.onFailure(now);
+    }
+    EXPECT_EQ(1, throttle.getWindow());
+}
+
+/// @brief Verifies the timeout follows the round trip time and backs off
+/// on failures.
+TEST(DnsServerThrottleTest, timeout) {
+    DnsServerThrottle throttle;
+    const uint64_t now = DnsServerThrottle::now();
+
+    // The configured timeout is used until a round trip is measured.
+    EXPECT_EQ(0, throttle.getSrtt());
+    EXPECT_EQ(1000, throttle.getTimeout(1000));
+    EXPECT_EQ(10, throttle.getWaitInterval());
+
+    // The first sample gives srtt + 4 * srtt / 2.
+    throttle.onSuccess(200);
+    EXPECT_EQ(200, throttle.getSrtt());
+    EXPECT_EQ(600, throttle.getTimeout(1000));
+    EXPECT_EQ(500, throttle.getTimeout(500));
+    EXPECT_EQ(100, throttle.getWaitInterval());
+
+    // Steady round trips shrink it down to the minimum.
+    for (int i = 0; i < 100; ++i) {
+        throttle.onSuccess(1);
+    }
+    EXPECT_EQ(1, throttle.getSrtt());
+    EXPECT_EQ(DnsServerThrottle::MIN_TIMEOUT, throttle.getTimeout(1000));
+    EXPECT_EQ(1, throttle.getWaitInterval());
+
+    // Each failure doubles it, a success resets it.
+    throttle.onFailure(now);
+    EXPECT_EQ(2 * DnsServerThrottle::MIN_TIMEOUT, throttle.getTimeout(1000));
+    throttle.onFailure(now);
+    EXPECT_EQ(4 * DnsServerThrottle::MIN_TIMEOUT, throttle.getTimeout(1000));
+    throttle.onSuccess(1);
+    EXPECT_EQ(DnsServerThrottle::MIN_TIMEOUT, throttle.getTimeout(1000));
+}
+
+/// @brief Verifies the circuit opens after consecutive failures, lets a
+/// probe through after the cool down and closes on success.
+TEST(DnsServerThrottleTest, circuit) {
+    DnsServerThrottle throttle;
+    uint64_t now = DnsServerThrottle::now();
+
+    // A success in between resets the count of failures.
+    for (unsigned int i = 1; i < DnsServerThrottle::FAILURE_THRESHOLD; ++i) {
+        ASSERT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+        EXPECT_FALSE(throttle.onFailure(now));
+    }
+    throttle.onSuccess(10);
+    EXPECT_EQ(0, throttle.getFailures());
+
+    for (unsigned int i = 1; i < DnsServerThrottle::FAILURE_THRESHOLD; ++i) {
+        EXPECT_FALSE(throttle.onFailure(now));
+    }
+    EXPECT_EQ(DnsServerThrottle::CLOSED, throttle.getCircuitState());
+    EXPECT_TRUE(throttle.onFailure(now));
+    EXPECT_EQ(DnsServerThrottle::OPEN, throttle.getCircuitState());
+    EXPECT_FALSE(throttle.isAvailable(now));
+    EXPECT_EQ(DnsServerThrottle::REFUSED, throttle.acquire(now));
+
+    // After the cool down, a single probe goes through.
+    now += DnsServerThrottle::MIN_COOL_DOWN * DnsServerThrottle::NANOS_PER_MS;
+    EXPECT_TRUE(throttle.isAvailable(now));
+    EXPECT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+    EXPECT_EQ(DnsServerThrottle::HALF_OPEN, throttle.getCircuitState());
+    EXPECT_FALSE(throttle.isAvailable(now));
+    EXPECT_EQ(DnsServerThrottle::REFUSED, throttle.acquire(now));
+
+    // A failed probe opens the circuit for twice as long.
+    EXPECT_TRUE(throttle.onFailure(now));
+    EXPECT_EQ(DnsServerThrottle::OPEN, throttle.getCircuitState());
+    EXPECT_EQ(2 * DnsServerThrottle::MIN_COOL_DOWN, throttle.getCoolDown());
+    now += DnsServerThrottle::MIN_COOL_DOWN * DnsServerThrottle::NANOS_PER_MS;
+    EXPECT_EQ(DnsServerThrottle::REFUSED, throttle.acquire(now));
+    now += DnsServerThrottle::MIN_COOL_DOWN * DnsServerThrottle::NANOS_PER_MS;
+
+    // A successful probe closes it.
+    EXPECT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+    EXPECT_TRUE(throttle.onSuccess(10));
+    EXPECT_EQ(DnsServerThrottle::CLOSED, throttle.getCircuitState());
+    EXPECT_EQ(DnsServerThrottle::MIN_COOL_DOWN, throttle.getCoolDown());
+    EXPECT_TRUE(throttle.isAvailable(now));
+    EXPECT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+
+    // The cool down period does not grow forever.
+    for (unsigned int i = 0; i < DnsServerThrottle::FAILURE_THRESHOLD; ++i) {
+        throttle.onFailure(now);
+    }
+    for (int i = 0; i < 10; ++i) {
+        now += DnsServerThrottle::MAX_COOL_DOWN *
+            DnsServerThrottle::NANOS_PER_MS;
+        ASSERT_EQ(DnsServerThrottle::ADMITTED, throttle.acquire(now));
+        EXPECT_TRUE(throttle.onFailure(now));
+    }
+    EXPECT_EQ(DnsServerThrottle::MAX_COOL_DOWN, throttle.getCoolDown());
+}
+
+}
@@ -1038,6 +1038,79 @@ TEST_F(NameChangeTransactionTest, sendUpdate) {
     EXPECT_EQ("response.example.com.", zone->getName().toText());
 }
 
+/// @brief Tests that server selection skips the servers whose circuit is
+/// open and that sendUpdate gives up on such a server without sending.
+TEST_F(NameChangeTransactionTest, sendUpdateCircuitOpen) {
+    NameChangeStubPtr name_change;
+    ASSERT_NO_THROW(name_change = makeCannedTransaction());
+    ASSERT_NO_THROW(name_change->initDictionaries());
+
+    // Open the circuit of the first forward server.
+    DnsServerInfoStoragePtr servers = name_change->getForwardDomain()->
+                                      getServers();
+    ASSERT_EQ(2, servers->size());
+    const DnsServerThrottlePtr& throttle = (*servers)[0]->getThrottle();
+    for (unsigned int i = 0; i < DnsServerThrottle::FAILURE_THRESHOLD; ++i) {
+        throttle->onFailure();
+    }
+    ASSERT_FALSE(throttle->isAvailable());
+
+    // Selection goes straight to the second one.
+    ASSERT_TRUE(name_change->selectFwdServer());
+    EXPECT_EQ((*servers)[1], name_change->getCurrentServer());
+    EXPECT_FALSE(name_change->selectNextServer());
+
+    // Open the circuit of the second one as well: the update is not sent
+    // and the transaction is told to move on.
+    const DnsServerThrottlePtr& throttle2 = (*servers)[1]->getThrottle();
+    for (unsigned int i = 0; i < DnsServerThrottle::FAILURE_THRESHOLD; ++i) {
+        throttle2->onFailure();
+    }
+
+    D2UpdateMessagePtr req(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+    name_change->setDnsUpdateRequest(req);
+    ASSERT_NO_THROW(name_change->sendUpdate());
+    EXPECT_EQ(NameChangeTransaction::IO_COMPLETED_EVT,
+              name_change->getNextEvent());
+    EXPECT_EQ(DNSClient::OTHER, name_change->getDnsUpdateStatus());
+    EXPECT_EQ(NameChangeTransaction::MAX_UPDATE_TRIES_PER_SERVER,
+              name_change->getUpdateAttempts());
+    EXPECT_EQ(0, throttle2->getInFlight());
+}
+
+/// @brief Tests that sendUpdate holds the update back while its server has
+/// as many updates in flight as its throttle allows.
+TEST_F(NameChangeTransactionTest, sendUpdateThrottled) {
+    NameChangeStubPtr name_change;
+    ASSERT_NO_THROW(name_change = makeCannedTransaction());
+    ASSERT_NO_THROW(name_change->initDictionaries());
+    ASSERT_TRUE(name_change->selectFwdServer());
+
+    const DnsServerThrottlePtr& throttle = name_change->getCurrentServer()->
+                                           getThrottle();
+    for (unsigned int i = 0; i < DnsServerThrottle::INITIAL_WINDOW; ++i) {
+        ASSERT_EQ(DnsServerThrottle::ADMITTED, throttle->acquire());
+    }
+
+    D2UpdateMessagePtr req(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+    req->setZone(dns::Name("request.example.com"), dns::RRClass::ANY());
+    req->setRcode(dns::Rcode(dns::Rcode::NOERROR_CODE));
+    name_change->setDnsUpdateRequest(req);
+    ASSERT_NO_THROW(name_change->sendUpdate());
+    EXPECT_EQ(NameChangeTransaction::NOP_EVT, name_change->getNextEvent());
+    EXPECT_EQ(0, name_change->getUpdateAttempts());
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle->getInFlight());
+
+    // Once a slot is free the update goes out and holds it until its
+    // outcome is known.
+    throttle->release();
+    ASSERT_NO_THROW(name_change->sendUpdate());
+    EXPECT_EQ(1, name_change->getUpdateAttempts());
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW, throttle->getInFlight());
+    name_change.reset();
+    EXPECT_EQ(DnsServerThrottle::INITIAL_WINDOW - 1, throttle->getInFlight());
+}
+
 /// @brief Tests that an unsigned response to a signed request is an error
 TEST_F(NameChangeTransactionTest, tsigUnsignedResponse) {
     NameChangeStubPtr name_change;
@@ -17,6 +17,7 @@
 #include <dhcp4/ctrl_dhcp4_srv.h>
 #include <dhcp4/dhcp4_log.h>
 #include <hooks/hooks_manager.h>
+#include <stats/stats_mgr.h>
 #include <dhcp4/json_config_parser.h>
 #include <dhcpsrv/cfgmgr.h>
 
@@ -67,6 +68,20 @@ ControlledDhcpv4Srv::commandConfigReloadHandler(const string&,
     return (processConfig(args));
 }
 
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticGetAllHandler(const string&,
+                                                   ConstElementPtr) {
+    return (isc::config::createAnswer(0, isc::stats::StatsMgr::instance().
+                                      toElement()));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticResetAllHandler(const string&,
+                                                     ConstElementPtr) {
+    isc::stats::StatsMgr::instance().resetAll();
+    return (isc::config::createAnswer(0, "All statistics reset."));
+}
+
 ConstElementPtr
 ControlledDhcpv4Srv::processCommand(const string& command,
                                     ConstElementPtr args) {
@@ -92,6 +107,12 @@ ControlledDhcpv4Srv::processCommand(const string& command,
         } else if (command == "config-reload") {
             return (srv->commandConfigReloadHandler(command, args));
 
+        } else if (command == "statistic-get-all") {
+            return (srv->commandStatisticGetAllHandler(command, args));
+
+        } else if (command == "statistic-reset-all") {
+            return (srv->commandStatisticResetAllHandler(command, args));
+
         }
         ConstElementPtr answer = isc::config::createAnswer(1,
                                  "Unrecognized command:" + command);
@@ -80,6 +80,8 @@ public:
     /// - shutdown
     /// - libreload
     /// - config-reload
+    /// - statistic-get-all
+    /// - statistic-reset-all
     ///
     /// @note It never throws.
     ///
@@ -169,6 +171,32 @@ protected:
     isc::data::ConstElementPtr
     commandConfigReloadHandler(const std::string& command,
                                isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-get-all' command
+    ///
+    /// This handler returns the current values of all counters and latency
+    /// histograms maintained by the server.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command with the statistics as an argument
+    isc::data::ConstElementPtr
+    commandStatisticGetAllHandler(const std::string& command,
+                                  isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-reset-all' command
+    ///
+    /// This handler resets all counters and latency histograms maintained
+    /// by the server.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandStatisticResetAllHandler(const std::string& command,
+                                    isc::data::ConstElementPtr args);
 };
 
 }; // namespace isc::dhcp
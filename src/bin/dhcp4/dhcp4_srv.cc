@@ -31,11 +31,14 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/pkt_tracer.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/utils.h>
 #include <dhcpsrv/utils.h>
 #include <hooks/callout_handle.h>
 #include <hooks/hooks_manager.h>
+#include <log/log_address.h>
+#include <stats/stats_mgr.h>
 #include <util/strutil.h>
 
 #include <boost/bind.hpp>
@@ -49,6 +52,7 @@ using namespace isc::dhcp;
 using namespace isc::dhcp_ddns;
 using namespace isc::hooks;
 using namespace isc::log;
+using namespace isc::stats;
 using namespace std;
 
 /// Structure that holds registered hook indexes
@@ -77,6 +81,89 @@ struct Dhcp4Hooks {
 // module is called.
 Dhcp4Hooks Hooks;
 
+/// Structure that holds references to the statistics of the DHCPv4 engine
+struct Dhcp4Stats {
+    Counter& pkt4_received_;        ///< packets received
+    Counter& pkt4_receive_fail_;    ///< errors during packet reception
+    Counter& pkt4_parse_fail_;      ///< packets dropped due to parse errors
+    Counter& pkt4_receive_drop_;    ///< packets not accepted by the server
+    Counter& pkt4_discover_received_; ///< DHCPDISCOVER messages received
+    Counter& pkt4_request_received_;  ///< DHCPREQUEST messages received
+    Counter& pkt4_release_received_;  ///< DHCPRELEASE messages received
+    Counter& pkt4_decline_received_;  ///< DHCPDECLINE messages received
+    Counter& pkt4_inform_received_;   ///< DHCPINFORM messages received
+    Counter& pkt4_unknown_received_;  ///< messages of unsupported types
+    Counter& pkt4_process_fail_;    ///< packets dropped due to processing errors
+    Counter& pkt4_class_fail_;      ///< packets dropped by class processing
+    Counter& pkt4_offer_sent_;      ///< DHCPOFFER messages sent
+    Counter& pkt4_ack_sent_;        ///< DHCPACK messages sent
+    Counter& pkt4_nak_sent_;        ///< DHCPNAK messages sent
+    Counter& pkt4_sent_;            ///< all packets sent
+    Counter& pkt4_send_fail_;       ///< errors during packing or sending
+    Counter& v4_subnet_select_fail_; ///< subnet could not be selected
+    Counter& v4_allocation_fail_;   ///< allocation engine returned no lease
+    Counter& hooks_buffer4_receive_skip_; ///< buffer4_receive callouts skips
+    Counter& hooks_pkt4_receive_skip_;    ///< pkt4_receive callouts skips
+    Counter& hooks_pkt4_send_skip_;       ///< pkt4_send callouts skips
+    Counter& hooks_buffer4_send_skip_;    ///< buffer4_send callouts skips
+    Histogram& unpack_latency_;     ///< duration of the packet parsing
+    Histogram& classify_latency_;   ///< duration of the packet classification
+    Histogram& select_subnet_latency_; ///< duration of the subnet selection
+    Histogram& allocate_latency_;   ///< duration of the lease allocation
+    Histogram& process_latency_;    ///< duration of the packet processing
+    Histogram& pack_latency_;       ///< duration of the response packing
+    Histogram& send_latency_;       ///< duration of the response sending
+
+    /// Constructor that registers statistics of the DHCPv4 engine
+    Dhcp4Stats()
+        : pkt4_received_(getCounter("pkt4-received")),
+          pkt4_receive_fail_(getCounter("pkt4-receive-fail")),
+          pkt4_parse_fail_(getCounter("pkt4-parse-fail")),
+          pkt4_receive_drop_(getCounter("pkt4-receive-drop")),
+          pkt4_discover_received_(getCounter("pkt4-discover-received")),
+          pkt4_request_received_(getCounter("pkt4-request-received")),
+          pkt4_release_received_(getCounter("pkt4-release-received")),
+          pkt4_decline_received_(getCounter("pkt4-decline-received")),
+          pkt4_inform_received_(getCounter("pkt4-inform-received")),
+          pkt4_unknown_received_(getCounter("pkt4-unknown-received")),
+          pkt4_process_fail_(getCounter("pkt4-process-fail")),
+          pkt4_class_fail_(getCounter("pkt4-class-processing-fail")),
+          pkt4_offer_sent_(getCounter("pkt4-offer-sent")),
+          pkt4_ack_sent_(getCounter("pkt4-ack-sent")),
+          pkt4_nak_sent_(getCounter("pkt4-nak-sent")),
+          pkt4_sent_(getCounter("pkt4-sent")),
+          pkt4_send_fail_(getCounter("pkt4-send-fail")),
+          v4_subnet_select_fail_(getCounter("v4-subnet-select-fail")),
+          v4_allocation_fail_(getCounter("v4-allocation-fail")),
+          hooks_buffer4_receive_skip_(getCounter("hooks-buffer4-receive-skip")),
+          hooks_pkt4_receive_skip_(getCounter("hooks-pkt4-receive-skip")),
+          hooks_pkt4_send_skip_(getCounter("hooks-pkt4-send-skip")),
+          hooks_buffer4_send_skip_(getCounter("hooks-buffer4-send-skip")),
+          unpack_latency_(getHistogram("pkt4-unpack-latency")),
+          classify_latency_(getHistogram("pkt4-classify-latency")),
+          select_subnet_latency_(getHistogram("pkt4-select-subnet-latency")),
+          allocate_latency_(getHistogram("pkt4-allocate-latency")),
+          process_latency_(getHistogram("pkt4-process-latency")),
+          pack_latency_(getHistogram("pkt4-pack-latency")),
+          send_latency_(getHistogram("pkt4-send-latency")) {
+    }
+
+    /// Returns the counter of the specified name
+    static Counter& getCounter(const char* name) {
+        return (StatsMgr::instance().getCounter(name));
+    }
+
+    /// Returns the histogram of the specified name
+    static Histogram& getHistogram(const char* name) {
+        return (StatsMgr::instance().getHistogram(name));
+    }
+};
+
+// Declare a Stats object. Similarly to the Hooks object, it is instantiated
+// when the module is loaded, so the packet processing code uses references
+// to the statistics rather than looking them up by name for each packet.
+Dhcp4Stats Stats;
+
 namespace isc {
 namespace dhcp {
 
@@ -167,6 +254,7 @@ Dhcpv4Srv::run() {
         } catch (const std::exception& e) {
             // Log all other errors.
             LOG_ERROR(dhcp4_logger, DHCP4_PACKET_RECEIVE_FAIL).arg(e.what());
+            Stats.pkt4_receive_fail_.inc();
         }
 
         // Handle next signal received by the process. It must be called after
@@ -187,6 +275,15 @@ Dhcpv4Srv::run() {
             continue;
         }
 
+        Stats.pkt4_received_.inc();
+
+        // The processing stages of the sampled packets are timestamped to
+        // find out where the time is spent.
+        if (PktTracer::instance().sample()) {
+            query->setTraced(true);
+            query->markStage(Pkt::STAGE_RECEIVED);
+        }
+
         // In order to parse the DHCP options, the server needs to use some
         // configuration information such as: existing option spaces, option
         // definitions etc. This is the kind of information which is not
@@ -219,6 +316,7 @@ Dhcpv4Srv::run() {
             // should skip parsing.
             if (callout_handle->getSkip()) {
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_BUFFER_RCVD_SKIP);
+                Stats.hooks_buffer4_receive_skip_.inc();
                 skip_unpack = true;
             }
 
@@ -229,30 +327,38 @@ Dhcpv4Srv::run() {
         // indicated they did it
         if (!skip_unpack) {
             try {
+                ScopedLatency timer(Stats.unpack_latency_);
                 query->unpack();
             } catch (const std::exception& e) {
                 // Failed to parse the packet.
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
                           DHCP4_PACKET_PARSE_FAIL).arg(e.what());
+                Stats.pkt4_parse_fail_.inc();
                 continue;
             }
         }
+        query->markStage(Pkt::STAGE_PARSED);
 
         // Assign this packet to one or more classes if needed. We need to do
         // this before calling accept(), because getSubnet4() may need client
         // class information.
-        classifyPacket(query);
+        {
+            ScopedLatency timer(Stats.classify_latency_);
+            classifyPacket(query);
+        }
 
         // Check whether the message should be further processed or discarded.
         // There is no need to log anything here. This function logs by itself.
         if (!accept(query)) {
+            Stats.pkt4_receive_drop_.inc();
             continue;
         }
 
         // We have sanity checked (in accept() that the Message Type option
         // exists, so we can safely get it here.
         int type = query->getType();
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_RECEIVED)
+        LOG_DEBUG_DEFERRED(dhcp4_logger, DBG_DHCP4_DETAIL,
+                           DHCP4_PACKET_RECEIVED)
             .arg(serverReceivedPacketName(type))
             .arg(type)
             .arg(query->getIface());
@@ -279,6 +385,7 @@ Dhcpv4Srv::run() {
             // stage means drop.
             if (callout_handle->getSkip()) {
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_RCVD_SKIP);
+                Stats.hooks_pkt4_receive_skip_.inc();
                 continue;
             }
 
@@ -286,8 +393,10 @@ Dhcpv4Srv::run() {
         }
 
         try {
+            ScopedLatency timer(Stats.process_latency_);
             switch (query->getType()) {
             case DHCPDISCOVER:
+                Stats.pkt4_discover_received_.inc();
                 rsp = processDiscover(query);
                 break;
 
@@ -295,18 +404,22 @@ Dhcpv4Srv::run() {
                 // Note that REQUEST is used for many things in DHCPv4: for
                 // requesting new leases, renewing existing ones and even
                 // for rebinding.
+                Stats.pkt4_request_received_.inc();
                 rsp = processRequest(query);
                 break;
 
             case DHCPRELEASE:
+                Stats.pkt4_release_received_.inc();
                 processRelease(query);
                 break;
 
             case DHCPDECLINE:
+                Stats.pkt4_decline_received_.inc();
                 processDecline(query);
                 break;
 
             case DHCPINFORM:
+                Stats.pkt4_inform_received_.inc();
                 rsp = processInform(query);
                 break;
 
@@ -314,9 +427,10 @@ Dhcpv4Srv::run() {
                 // Only action is to output a message if debug is enabled,
                 // and that is covered by the debug statement before the
                 // "switch" statement.
-                ;
+                Stats.pkt4_unknown_received_.inc();
             }
         } catch (const isc::Exception& e) {
+            Stats.pkt4_process_fail_.inc();
 
             // Catch-all exception (at least for ones based on the isc Exception
             // class, which covers more or less all that are explicitly raised
@@ -348,6 +462,7 @@ Dhcpv4Srv::run() {
         if (!classSpecificProcessing(query, rsp)) {
             /// @todo add more verbosity here
             LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC, DHCP4_CLASS_PROCESSING_FAILED);
+            Stats.pkt4_class_fail_.inc();
 
             continue;
         }
@@ -377,16 +492,20 @@ Dhcpv4Srv::run() {
             // stage means "drop response".
             if (callout_handle->getSkip()) {
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_SEND_SKIP);
+                Stats.hooks_pkt4_send_skip_.inc();
                 skip_pack = true;
             }
         }
+        query->markStage(Pkt::STAGE_HOOKS_DONE);
 
         if (!skip_pack) {
             try {
+                ScopedLatency timer(Stats.pack_latency_);
                 rsp->pack();
             } catch (const std::exception& e) {
                 LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
                     .arg(e.what());
+                Stats.pkt4_send_fail_.inc();
             }
         }
 
@@ -414,6 +533,7 @@ Dhcpv4Srv::run() {
                 if (callout_handle->getSkip()) {
                     LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS,
                               DHCP4_HOOK_BUFFER_SEND_SKIP);
+                    Stats.hooks_buffer4_send_skip_.inc();
                     continue;
                 }
 
@@ -424,10 +544,31 @@ Dhcpv4Srv::run() {
                       DHCP4_RESPONSE_DATA)
                 .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
-            sendPacket(rsp);
+            {
+                ScopedLatency timer(Stats.send_latency_);
+                sendPacket(rsp);
+            }
+            query->markStage(Pkt::STAGE_SENT);
+            PktTracer::instance().record(AF_INET, *query);
+
+            Stats.pkt4_sent_.inc();
+            switch (rsp->getType()) {
+            case DHCPOFFER:
+                Stats.pkt4_offer_sent_.inc();
+                break;
+            case DHCPACK:
+                Stats.pkt4_ack_sent_.inc();
+                break;
+            case DHCPNAK:
+                Stats.pkt4_nak_sent_.inc();
+                break;
+            default:
+                ;
+            }
         } catch (const std::exception& e) {
             LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
                 .arg(e.what());
+            Stats.pkt4_send_fail_.inc();
         }
     }
 
@@ -926,6 +1067,7 @@ Dhcpv4Srv::assignLease(const Pkt4Ptr& question, Pkt4Ptr& answer) {
         LOG_ERROR(dhcp4_logger, DHCP4_SUBNET_SELECTION_FAILED)
             .arg(question->getRemoteAddr().toText())
             .arg(serverReceivedPacketName(question->getType()));
+        Stats.v4_subnet_select_fail_.inc();
         answer->setType(DHCPNAK);
         answer->setYiaddr(IOAddress("0.0.0.0"));
         return;
@@ -1032,19 +1174,22 @@ Dhcpv4Srv::assignLease(const Pkt4Ptr& question, Pkt4Ptr& answer) {
     // be inserted into the LeaseMgr as well.
     /// @todo pass the actual FQDN data.
     Lease4Ptr old_lease;
-    Lease4Ptr lease = alloc_engine_->allocateLease4(subnet, client_id, hwaddr,
-                                                    hint, fqdn_fwd, fqdn_rev,
-                                                    hostname,
-                                                    fake_allocation,
-                                                    callout_handle,
-                                                    old_lease);
+    Lease4Ptr lease;
+    {
+        ScopedLatency timer(Stats.allocate_latency_);
+        lease = alloc_engine_->allocateLease4(subnet, client_id, hwaddr,
+                                              hint, fqdn_fwd, fqdn_rev,
+                                              hostname, fake_allocation,
+                                              callout_handle, old_lease);
+    }
+    question->markStage(Pkt::STAGE_LEASE_ALLOCATED);
 
     if (lease) {
         // We have a lease! Let's set it in the packet and send it back to
         // the client.
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, fake_allocation?
-                  DHCP4_LEASE_ADVERT:DHCP4_LEASE_ALLOC)
-            .arg(lease->addr_.toText())
+        LOG_DEBUG_DEFERRED(dhcp4_logger, DBG_DHCP4_DETAIL, fake_allocation?
+                           DHCP4_LEASE_ADVERT:DHCP4_LEASE_ALLOC)
+            .arg(lease->addr_)
             .arg(client_id?client_id->toText():"(no client-id)")
             .arg(hwaddr?hwaddr->toText():"(no hwaddr info)");
 
@@ -1126,6 +1271,7 @@ Dhcpv4Srv::assignLease(const Pkt4Ptr& question, Pkt4Ptr& answer) {
             .arg(client_id?client_id->toText():"(no client-id)")
             .arg(hwaddr?hwaddr->toText():"(no hwaddr info)")
             .arg(hint.toText());
+        Stats.v4_allocation_fail_.inc();
 
         answer->setType(DHCPNAK);
         answer->setYiaddr(IOAddress("0.0.0.0"));
@@ -1524,6 +1670,7 @@ Dhcpv4Srv::serverReceivedPacketName(uint8_t type) {
 
 Subnet4Ptr
 Dhcpv4Srv::selectSubnet(const Pkt4Ptr& question) const {
+    ScopedLatency timer(Stats.select_subnet_latency_);
 
     Subnet4Ptr subnet;
     static const IOAddress notset("0.0.0.0");
@@ -1598,6 +1745,7 @@ Dhcpv4Srv::selectSubnet(const Pkt4Ptr& question) const {
         callout_handle->getArgument("subnet4", subnet);
     }
 
+    question->markStage(Pkt::STAGE_SUBNET_SELECTED);
     return (subnet);
 }
 
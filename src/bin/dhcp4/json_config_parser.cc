@@ -14,6 +14,7 @@
 
 #include <config/ccsession.h>
 #include <dhcp4/dhcp4_log.h>
+#include <dhcp/docsis3_option_defs.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp/option_definition.h>
 #include <dhcpsrv/cfgmgr.h>
@@ -21,6 +22,9 @@
 #include <dhcpsrv/dbaccess_parser.h>
 #include <dhcpsrv/dhcp_parsers.h>
 #include <dhcpsrv/option_space_container.h>
+#include <dhcpsrv/parallel_parser_builder.h>
+#include <dhcpsrv/pkt_tracer.h>
+#include <dhcpsrv/subnet_config_cache.h>
 #include <util/encode/hex.h>
 #include <util/strutil.h>
 
@@ -32,6 +36,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 
 using namespace std;
 using namespace isc;
@@ -179,8 +184,10 @@ public:
         :SubnetConfigParser("", globalContext(), IOAddress("0.0.0.0")) {
     }
 
-    /// @brief Parses a single IPv4 subnet configuration and adds to the
-    /// Configuration Manager.
+    /// @brief Parses a single IPv4 subnet configuration.
+    ///
+    /// The subnet created is added to the Configuration Manager by the
+    /// @c Subnets4ListConfigParser.
     ///
     /// @param subnet A new subnet being configured.
     void build(ConstElementPtr subnet) {
@@ -198,25 +205,20 @@ public:
             if (relay_info_) {
                 sub4ptr->setRelayInfo(*relay_info_);
             }
-
-            // Adding a subnet to the Configuration Manager may fail if the
-            // subnet id is invalid (duplicate). Thus, we catch exceptions
-            // here to append a position in the configuration string.
-            try {
-                isc::dhcp::CfgMgr::instance().addSubnet4(sub4ptr);
-            } catch (const std::exception& ex) {
-                isc_throw(DhcpConfigError, ex.what() << " ("
-                          << subnet->getPosition() << ")");
-            }
         }
     }
 
     /// @brief Commits subnet configuration.
     ///
-    /// This function is currently no-op because subnet should already
-    /// be added into the Config Manager in the build().
+    /// This function is currently no-op because the subnet is added into
+    /// the Config Manager by the @c Subnets4ListConfigParser.
     void commit() { }
 
+    /// @brief Returns the subnet created by the build().
+    Subnet4Ptr getSubnet() const {
+        return (boost::dynamic_pointer_cast<Subnet4>(subnet_));
+    }
+
 protected:
 
     /// @brief Creates parsers for entries in subnet definition.
@@ -380,20 +382,69 @@ public:
     /// @brief parses contents of the list
     ///
     /// Iterates over all entries on the list and creates Subnet4ConfigParser
-    /// for each entry.
+    /// for each entry. The subnets which haven't changed since the last
+    /// configuration are not parsed: the existing subnet objects are reused
+    /// (see @c SubnetConfigCache), so as they retain their run time state.
+    ///
+    /// The subnets are collected in the parser and replace the subnets held
+    /// by the Configuration Manager on commit, so the current subnets remain
+    /// intact if the configuration fails.
+    ///
+    /// The subnet parsers are built concurrently using the number of threads
+    /// specified with the "config-threads" global parameter (see
+    /// @c ParallelParserBuilder).
     ///
     /// @param subnets_list pointer to a list of IPv4 subnets
     void build(ConstElementPtr subnets_list) {
-        // @todo: Implement more subtle reconfiguration than toss
-        // the old one and replace with the new one.
-
-        // remove old subnets
-        CfgMgr::instance().deleteSubnets4();
-
+        // The option definitions and the staging configuration (which the
+        // option data parsers look the option definitions up in) are
+        // created on the first use. Make sure they are created before the
+        // parsers are run concurrently.
+        LibDHCP::getOptionDefs(Option::V4);
+        LibDHCP::getVendorOption4Defs(VENDOR_ID_CABLE_LABS);
+        CfgMgr::instance().getStagingCfg();
+
+        // Parse the subnets which can't be reused. The subnets for which
+        // the identifier is generated are parsed in the order of appearance,
+        // so as they get the same identifiers as when parsed one by one.
+        ParallelParserBuilder builder(globalContext()->uint32_values_->
+                                      getOptionalParam("config-threads", 0));
+        std::vector<Subnet4Ptr> reused;
+        std::vector<boost::shared_ptr<Subnet4ConfigParser> > parsers;
         BOOST_FOREACH(ConstElementPtr subnet, subnets_list->listValue()) {
-            ParserPtr parser(new Subnet4ConfigParser("subnet"));
-            parser->build(subnet);
-            subnets_.push_back(parser);
+            Subnet4Ptr subnet4 = boost::dynamic_pointer_cast<
+                Subnet4>(subnetConfigCache().get(subnet));
+            reused.push_back(subnet4);
+            parsers.push_back(boost::shared_ptr<Subnet4ConfigParser>());
+            if (subnet4) {
+                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
+                          DHCP4_CONFIG_SUBNET_REUSED).arg(subnet4->toText());
+            } else {
+                parsers.back().reset(new Subnet4ConfigParser("subnet"));
+                builder.add(parsers.back(), subnet, !hasExplicitId(subnet));
+            }
+        }
+        builder.build();
+
+        // Collect the subnets in the order of appearance.
+        for (size_t i = 0; i < reused.size(); ++i) {
+            ConstElementPtr subnet = subnets_list->get(i);
+            Subnet4Ptr subnet4 = reused[i];
+            if (!subnet4) {
+                subnets_.push_back(parsers[i]);
+                subnet4 = parsers[i]->getSubnet();
+                if (!subnet4) {
+                    continue;
+                }
+            }
+
+            if (!ids_.insert(subnet4->getID()).second) {
+                isc_throw(DhcpConfigError, "ID of the new IPv4 subnet '"
+                          << subnet4->getID() << "' is already in use ("
+                          << subnet->getPosition() << ")");
+            }
+            subnets4_.push_back(subnet4);
+            subnetConfigCache().add(subnet, subnet4);
         }
     }
 
@@ -401,11 +452,23 @@ public:
     ///
     /// Iterates over all Subnet4 parsers. Each parser contains definitions of
     /// a single subnet and its parameters and commits each subnet separately.
+    /// Then, replaces the subnets held by the Configuration Manager with the
+    /// parsed ones.
     void commit() {
         BOOST_FOREACH(ParserPtr subnet, subnets_) {
             subnet->commit();
         }
+        CfgMgr::instance().replaceSubnets4(subnets4_);
+    }
 
+    /// @brief Checks if the subnet configuration specifies the non-zero
+    /// subnet identifier.
+    ///
+    /// @param subnet Subnet configuration.
+    static bool hasExplicitId(const ConstElementPtr& subnet) {
+        ConstElementPtr id = subnet->get("id");
+        return (id && (id->getType() == Element::integer) &&
+                (id->intValue() > 0));
     }
 
     /// @brief Returns Subnet4ListConfigParser object
@@ -418,6 +481,12 @@ public:
     /// @brief collection of subnet parsers.
     ParserCollection subnets_;
 
+    /// @brief Parsed and reused subnets.
+    Subnet4Collection subnets4_;
+
+    /// @brief Identifiers of the subnets, used to detect duplicates.
+    std::set<SubnetID> ids_;
+
 };
 
 } // anonymous namespace
@@ -439,7 +508,10 @@ namespace dhcp {
     DhcpConfigParser* parser = NULL;
     if ((config_id.compare("valid-lifetime") == 0)  ||
         (config_id.compare("renew-timer") == 0)  ||
-        (config_id.compare("rebind-timer") == 0))  {
+        (config_id.compare("rebind-timer") == 0) ||
+        (config_id.compare("trace-sampling-rate") == 0) ||
+        (config_id.compare("trace-file-records") == 0) ||
+        (config_id.compare("config-threads") == 0))  {
         parser = new Uint32Parser(config_id,
                                  globalContext()->uint32_values_);
     } else if (config_id.compare("interfaces") == 0) {
@@ -454,7 +526,8 @@ namespace dhcp {
     } else if (config_id.compare("option-def") == 0) {
         parser  = new OptionDefListParser(config_id, globalContext());
     } else if ((config_id.compare("version") == 0) ||
-               (config_id.compare("next-server") == 0)) {
+               (config_id.compare("next-server") == 0) ||
+               (config_id.compare("trace-file") == 0)) {
         parser  = new StringParser(config_id,
                                     globalContext()->string_values_);
     } else if (config_id.compare("lease-database") == 0) {
@@ -486,6 +559,10 @@ void commitGlobalOptions() {
     } catch (...) {
         // Ignore errors. This flag is optional
     }
+
+    // Apply the packet processing latency tracing configuration staged
+    // when the configuration was parsed.
+    PktTracer::instance().commit();
 }
 
 isc::data::ConstElementPtr
@@ -503,6 +580,9 @@ configureDhcp4Server(Dhcpv4Srv&, isc::data::ConstElementPtr config_set) {
     // so newly recreated configuration starts with first subnet-id equal 1.
     Subnet::resetSubnetID();
 
+    // Find out which subnets can be reused from the current configuration.
+    subnetConfigCache().begin(config_set, "subnet4");
+
     // Some of the values specified in the configuration depend on
     // other values. Typically, the values in the subnet4 structure
     // depend on the global values. Also, option values configuration
@@ -591,6 +671,18 @@ configureDhcp4Server(Dhcpv4Srv&, isc::data::ConstElementPtr config_set) {
             subnet_parser->build(subnet_config->second);
         }
 
+        // Check the packet processing latency tracing configuration and
+        // create the trace file before anything is committed. The tracing
+        // is disabled unless the sampling rate is specified.
+        config_pair.first = "trace-file";
+        PktTracer::instance().stage(globalContext()->uint32_values_->
+                                    getOptionalParam("trace-sampling-rate", 0),
+                                    globalContext()->string_values_->
+                                    getOptionalParam("trace-file", ""),
+                                    globalContext()->uint32_values_->
+                                    getOptionalParam("trace-file-records",
+                                    PktTracer::DEFAULT_TRACE_FILE_RECORDS));
+
     } catch (const isc::Exception& ex) {
         LOG_ERROR(dhcp4_logger, DHCP4_PARSER_FAIL)
                   .arg(config_pair.first).arg(ex.what());
@@ -648,9 +740,13 @@ configureDhcp4Server(Dhcpv4Srv&, isc::data::ConstElementPtr config_set) {
     // Rollback changes as the configuration parsing failed.
     if (rollback) {
         globalContext().reset(new ParserContext(original_context));
+        PktTracer::instance().rollback();
         return (answer);
     }
 
+    // The subnets of this configuration may be reused by the next one.
+    subnetConfigCache().commit();
+
     LOG_INFO(dhcp4_logger, DHCP4_CONFIG_COMPLETE)
         .arg(CfgMgr::instance().getCurrentCfg()->
              getConfigSummary(SrvConfig::CFGSEL_ALL4));
@@ -660,6 +756,11 @@ configureDhcp4Server(Dhcpv4Srv&, isc::data::ConstElementPtr config_set) {
     return (answer);
 }
 
+SubnetConfigCache& subnetConfigCache() {
+    static SubnetConfigCache subnet_config_cache;
+    return (subnet_config_cache);
+}
+
 ParserContextPtr& globalContext() {
     static ParserContextPtr global_context_ptr(new ParserContext(Option::V4));
     return (global_context_ptr);
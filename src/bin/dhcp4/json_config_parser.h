@@ -15,6 +15,7 @@
 #include <cc/data.h>
 #include <exceptions/exceptions.h>
 #include <dhcpsrv/dhcp_parsers.h>
+#include <dhcpsrv/subnet_config_cache.h>
 
 #include <stdint.h>
 #include <string>
@@ -66,6 +67,12 @@ configureDhcp4Server(Dhcpv4Srv&,
 /// @return a reference to the global context
 ParserContextPtr& globalContext();
 
+/// @brief Returns the cache of the subnets created by the last successful
+/// configuration.
+///
+/// @return a reference to the subnet configuration cache
+SubnetConfigCache& subnetConfigCache();
+
 }; // end of isc::dhcp namespace
 }; // end of isc namespace
 
@@ -28,6 +28,7 @@
 #include <dhcp/tests/iface_mgr_test_config.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/pkt_tracer.h>
 #include <dhcpsrv/testutils/config_result_check.h>
 #include <hooks/hooks_manager.h>
 
@@ -753,6 +754,161 @@ TEST_F(Dhcp4ParserTest, multipleSubnetsOverlapingIDs) {
     EXPECT_TRUE(errorContainsPosition(x, "<string>"));
 }
 
+// This test checks that the subnets which configuration hasn't changed are
+// not recreated during reconfiguration and that the failed reconfiguration
+// leaves the current subnets intact.
+TEST_F(Dhcp4ParserTest, reconfigureReuseSubnets) {
+    ConstElementPtr x;
+    string config = "{ \"interfaces\": [ \"*\" ],"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\", "
+        "    \"id\": 10 "
+        " },"
+        " {"
+        "    \"pools\": [ { \"pool\": \"192.0.3.101 - 192.0.3.150\" } ],"
+        "    \"subnet\": \"192.0.3.0/24\", "
+        "    \"id\": 20 "
+        " },"
+        " {"
+        "    \"pools\": [ { \"pool\": \"192.0.4.101 - 192.0.4.150\" } ],"
+        "    \"subnet\": \"192.0.4.0/24\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    // The second subnet has been modified.
+    string config_modified = "{ \"interfaces\": [ \"*\" ],"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\", "
+        "    \"id\": 10 "
+        " },"
+        " {"
+        "    \"pools\": [ { \"pool\": \"192.0.3.101 - 192.0.3.200\" } ],"
+        "    \"subnet\": \"192.0.3.0/24\", "
+        "    \"id\": 20 "
+        " },"
+        " {"
+        "    \"pools\": [ { \"pool\": \"192.0.4.101 - 192.0.4.150\" } ],"
+        "    \"subnet\": \"192.0.4.0/24\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_, Element::fromJSON(config)));
+    checkResult(x, 0);
+    Subnet4Collection subnets = *CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(3, subnets.size());
+
+    // Identical configuration: the subnets with explicit ids are reused.
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_, Element::fromJSON(config)));
+    checkResult(x, 0);
+    const Subnet4Collection* reused = CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(3, reused->size());
+    EXPECT_TRUE(subnets[0] == reused->at(0));
+    EXPECT_TRUE(subnets[1] == reused->at(1));
+    EXPECT_FALSE(subnets[2] == reused->at(2));
+    EXPECT_EQ(1, reused->at(2)->getID());
+
+    // Only the modified subnet is recreated.
+    subnets = *reused;
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_,
+                                             Element::fromJSON(config_modified)));
+    checkResult(x, 0);
+    const Subnet4Collection* modified = CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(3, modified->size());
+    EXPECT_TRUE(subnets[0] == modified->at(0));
+    EXPECT_FALSE(subnets[1] == modified->at(1));
+    EXPECT_TRUE(modified->at(1)->inPool(Lease::TYPE_V4,
+                                        IOAddress("192.0.3.200")));
+
+    // Invalid configuration must not affect the current subnets.
+    subnets = *modified;
+    string config_invalid = "{ \"interfaces\": [ \"*\" ],"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\", "
+        "    \"id\": 10 "
+        " },"
+        " {"
+        "    \"pools\": [ { \"pool\": \"192.0.5.1 - 192.0.5.100\" } ],"
+        "    \"subnet\": \"192.0.5.0/24\", "
+        "    \"id\": 10 "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_,
+                                             Element::fromJSON(config_invalid)));
+    checkResult(x, 1);
+    const Subnet4Collection* current = CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(3, current->size());
+    for (int i = 0; i < subnets.size(); ++i) {
+        EXPECT_TRUE(subnets[i] == current->at(i));
+    }
+}
+
+// Checks that the large number of subnets is parsed using multiple threads
+// with the same result as when the subnets are parsed one by one.
+TEST_F(Dhcp4ParserTest, parallelSubnets) {
+    ConstElementPtr x;
+
+    // Every fourth subnet has no explicit identifier, so it gets the
+    // autogenerated one.
+    const int subnets_count = 400;
+    std::ostringstream config;
+    config << "{ \"interfaces\": [ \"*\" ],"
+        "\"config-threads\": 4,"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"valid-lifetime\": 4000, "
+        "\"subnet4\": [ ";
+    for (int i = 0; i < subnets_count; ++i) {
+        config << (i > 0 ? ", " : "") << "{ "
+            "\"pools\": [ { \"pool\": \"10.0." << i / 2 << "."
+               << (i % 2) * 128 + 10 << " - 10.0." << i / 2 << "."
+               << (i % 2) * 128 + 20 << "\" } ],"
+            "\"subnet\": \"10.0." << i / 2 << "." << (i % 2) * 128
+               << "/25\"";
+        if ((i % 4) != 0) {
+            config << ", \"id\": " << 1000 + i;
+        }
+        config << " }";
+    }
+    config << " ] }";
+
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_,
+                                             Element::fromJSON(config.str())));
+    checkResult(x, 0);
+
+    const Subnet4Collection* subnets = CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(subnets_count, subnets->size());
+    SubnetID auto_id = 1;
+    for (int i = 0; i < subnets_count; ++i) {
+        Subnet4Ptr subnet = subnets->at(i);
+        std::ostringstream prefix;
+        prefix << "10.0." << i / 2 << "." << (i % 2) * 128;
+        EXPECT_EQ(prefix.str() + "/25", subnet->toText());
+        EXPECT_EQ(((i % 4) != 0 ? 1000 + i : auto_id++), subnet->getID());
+        std::ostringstream address;
+        address << "10.0." << i / 2 << "." << (i % 2) * 128 + 15;
+        EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4,
+                                   IOAddress(address.str())));
+    }
+
+    // The duplicated identifier is detected.
+    std::string config_invalid = config.str();
+    config_invalid.replace(config_invalid.find("\"id\": 1397"), 10,
+                           "\"id\": 1001");
+    EXPECT_NO_THROW(x = configureDhcp4Server(*srv_,
+                                             Element::fromJSON(config_invalid)));
+    checkResult(x, 1);
+    EXPECT_EQ(subnets_count, CfgMgr::instance().getSubnets4()->size());
+}
+
 // Goal of this test is to verify that a previously configured subnet can be
 // deleted in subsequent reconfiguration.
 TEST_F(Dhcp4ParserTest, reconfigureRemoveSubnet) {
@@ -1069,6 +1225,53 @@ TEST_F(Dhcp4ParserTest, echoClientId) {
     CfgMgr::instance().echoClientId(true);
 }
 
+// Check that the packet processing latency tracing can be configured.
+TEST_F(Dhcp4ParserTest, traceSamplingRate) {
+
+    ConstElementPtr status;
+
+    string config = "{ \"interfaces\": [ \"*\" ],"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"trace-sampling-rate\": 100,"
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\" } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    string config_bad_file = "{ \"interfaces\": [ \"*\" ],"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"trace-sampling-rate\": 10,"
+        "\"trace-file\": \"/no/such/dir/trace.bin\","
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.3.1 - 192.0.3.100\" } ],"
+        "    \"subnet\": \"192.0.3.0/24\" } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    // The tracing is disabled by default.
+    EXPECT_EQ(0, PktTracer::instance().getSamplingRate());
+
+    EXPECT_NO_THROW(status = configureDhcp4Server(*srv_,
+                                                  Element::fromJSON(config)));
+    checkResult(status, 0);
+    EXPECT_EQ(100, PktTracer::instance().getSamplingRate());
+    EXPECT_FALSE(PktTracer::instance().isTraceFileOpen());
+
+    // The trace file which can't be created is a configuration error,
+    // detected before the new subnets replace the current ones.
+    EXPECT_NO_THROW(status = configureDhcp4Server(*srv_,
+                                    Element::fromJSON(config_bad_file)));
+    checkResult(status, 1);
+    const Subnet4Collection* subnets = CfgMgr::instance().getSubnets4();
+    ASSERT_EQ(1, subnets->size());
+    EXPECT_EQ("192.0.2.0/24", subnets->at(0)->toText());
+    EXPECT_EQ(100, PktTracer::instance().getSamplingRate());
+
+    // Revert back to the default.
+    PktTracer::instance().configure(0, "", 1);
+}
+
 // This test checks if it is possible to override global values
 // on a per subnet basis.
 TEST_F(Dhcp4ParserTest, subnetLocal) {
@@ -18,6 +18,7 @@
 #include <dhcp/dhcp4.h>
 #include <dhcp4/ctrl_dhcp4_srv.h>
 #include <hooks/hooks_manager.h>
+#include <stats/stats_mgr.h>
 
 #include "marker_file.h"
 #include "test_libraries.h"
@@ -156,4 +157,36 @@ TEST_F(CtrlDhcpv4SrvTest, libreload) {
     EXPECT_TRUE(checkMarkerFile(LOAD_MARKER_FILE, "1212"));
 }
 
+// Check that the "statistic-get-all" command returns the statistics
+// maintained by the server and the "statistic-reset-all" resets them.
+TEST_F(CtrlDhcpv4SrvTest, statistics) {
+
+    boost::scoped_ptr<ControlledDhcpv4Srv> srv;
+    ASSERT_NO_THROW(
+        srv.reset(new ControlledDhcpv4Srv(0))
+    );
+
+    isc::stats::StatsMgr::instance().getCounter("pkt4-received").add(3);
+
+    ElementPtr params(new isc::data::MapElement());
+    int rcode = -1;
+
+    ConstElementPtr result =
+        ControlledDhcpv4Srv::processCommand("statistic-get-all", params);
+    ConstElementPtr stats = parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(stats);
+    ASSERT_TRUE(stats->get("counters"));
+    ASSERT_TRUE(stats->get("histograms"));
+    ASSERT_TRUE(stats->get("counters")->get("pkt4-received"));
+    EXPECT_LE(3, stats->get("counters")->get("pkt4-received")->intValue());
+    EXPECT_TRUE(stats->get("histograms")->get("pkt4-pack-latency"));
+
+    result = ControlledDhcpv4Srv::processCommand("statistic-reset-all", params);
+    parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+    EXPECT_EQ(0, isc::stats::StatsMgr::instance().
+              getCounter("pkt4-received").get());
+}
+
 } // End of anonymous namespace
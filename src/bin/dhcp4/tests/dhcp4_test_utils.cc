@@ -49,6 +49,9 @@ Dhcpv4SrvTest::Dhcpv4SrvTest()
     CfgMgr::instance().deleteSubnets4();
     CfgMgr::instance().addSubnet4(subnet_);
 
+    // Make sure that the subnets modified by other tests are not reused.
+    subnetConfigCache().clear();
+
     // Add Router option.
     Option4AddrLstPtr opt_routers(new Option4AddrLst(DHO_ROUTERS));
     opt_routers->setAddress(IOAddress("192.0.2.2"));
@@ -0,0 +1,506 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <asiolink/io_address.h>
+#include <cc/data.h>
+#include <config/ccsession.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/duid.h>
+#include <dhcp/iface_mgr.h>
+#include <dhcp/option.h>
+#include <dhcp/option6_ia.h>
+#include <dhcp/pkt6.h>
+#include <dhcp/pkt_filter6.h>
+#include <dhcp6/dhcp6_srv.h>
+#include <dhcp6/json_config_parser.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <log/logger_support.h>
+#include <stats/stats_mgr.h>
+#include <util/monotonic_clock.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::stats;
+using namespace isc::util;
+
+namespace {
+
+// This benchmark measures the throughput of the DHCPv6 server without
+// sockets. The server is configured with the specified number of subnets
+// and fed with SOLICIT messages from the simulated relays, followed by
+// REQUEST messages built from the received ADVERTISEs. The messages are
+// processed by the regular Dhcpv6Srv::run() loop: packet reception is
+// replaced by the queue of the messages in the on-wire format and the
+// responses are passed through the IfaceMgr to the packet filter which
+// captures them instead of sending. The time spent in each stage of the
+// processing is reported from the server's latency statistics.
+
+/// @brief Name of the fake interface.
+const char* IFACE_NAME = "bench0";
+
+/// @brief Link-local address of the fake interface.
+const char* IFACE_ADDRESS = "fe80::1";
+
+/// @brief Number of addresses in the pool of each subnet.
+const unsigned int POOL_SIZE = 241;
+
+/// @brief Offset of the first pool address within the subnet.
+const unsigned int POOL_START = 10;
+
+/// @brief Names of the latency statistics of the server in the order
+/// of the processing stages.
+const char* STAGES[] = {
+    "pkt6-unpack-latency",
+    "pkt6-classify-latency",
+    "pkt6-select-subnet-latency",
+    "pkt6-allocate-latency",
+    "pkt6-process-latency",
+    "pkt6-pack-latency",
+    "pkt6-send-latency"
+};
+
+/// @brief Packet filter which captures the sent packets.
+///
+/// No packets are received through the filter, the socket descriptors it
+/// returns refer to the null device so as they can be closed as regular
+/// sockets.
+class PktFilterBench : public PktFilter6 {
+public:
+
+    /// @brief Returns the descriptor of the null device.
+    virtual SocketInfo openSocket(const Iface&, const IOAddress& addr,
+                                  const uint16_t port, const bool) {
+        return (SocketInfo(addr, port, open("/dev/null", O_RDONLY)));
+    }
+
+    /// @brief Does nothing.
+    virtual Pkt6Ptr receive(const SocketInfo&) {
+        return (Pkt6Ptr());
+    }
+
+    /// @brief Captures the packet.
+    virtual int send(const Iface&, uint16_t, const Pkt6Ptr& pkt) {
+        sent_.push_back(pkt);
+        return (0);
+    }
+
+    /// @brief Captured packets.
+    vector<Pkt6Ptr> sent_;
+};
+
+typedef boost::shared_ptr<PktFilterBench> PktFilterBenchPtr;
+
+/// @brief Message received from a client through the relay.
+struct Query {
+    /// @brief Message in the on-wire format.
+    vector<uint8_t> data_;
+
+    /// @brief Address of the relay.
+    IOAddress relay_;
+
+    Query(const Pkt6Ptr& pkt, const IOAddress& relay)
+        : data_(static_cast<const uint8_t*>(pkt->getBuffer().getData()),
+                static_cast<const uint8_t*>(pkt->getBuffer().getData()) +
+                pkt->getBuffer().getLength()),
+          relay_(relay) {
+    }
+};
+
+/// @brief DHCPv6 server receiving the queued messages.
+class BenchDhcpv6Srv : public Dhcpv6Srv {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// The port 0 makes the server usable without the detected interfaces.
+    BenchDhcpv6Srv()
+        : Dhcpv6Srv(0), queries_(), next_(0) {
+    }
+
+    /// @brief Processes the messages.
+    ///
+    /// @param queries Messages to be received by the server.
+    void process(const vector<Query>& queries) {
+        queries_ = &queries;
+        next_ = 0;
+        shutdown_ = false;
+        run();
+    }
+
+protected:
+
+    /// @brief Returns the next queued message or shuts the server down
+    /// when there are none left.
+    virtual Pkt6Ptr receivePacket(int) {
+        if (next_ >= queries_->size()) {
+            shutdown();
+            return (Pkt6Ptr());
+        }
+        const Query& query = (*queries_)[next_++];
+        Pkt6Ptr pkt(new Pkt6(&query.data_[0], query.data_.size()));
+        pkt->setIface(IFACE_NAME);
+        pkt->setIndex(1);
+        pkt->setLocalAddr(IOAddress(IFACE_ADDRESS));
+        pkt->setLocalPort(DHCP6_SERVER_PORT);
+        pkt->setRemoteAddr(query.relay_);
+        pkt->setRemotePort(DHCP6_SERVER_PORT);
+        return (pkt);
+    }
+
+private:
+
+    /// @brief Queued messages.
+    const vector<Query>* queries_;
+
+    /// @brief Index of the next message to be received.
+    size_t next_;
+};
+
+/// @brief Returns the address in the specified subnet.
+///
+/// @param subnet Index of the subnet.
+/// @param host Host part of the address.
+IOAddress
+getAddress(const unsigned int subnet, const unsigned int host) {
+    ostringstream s;
+    s << "2001:db8:" << hex << subnet << "::" << host;
+    return (IOAddress(s.str()));
+}
+
+/// @brief Returns the DUID of the client.
+///
+/// The DUID is of the DUID-LL type.
+///
+/// @param client Index of the client.
+/// @param prefix First byte of the link-layer address.
+vector<uint8_t>
+getDuid(const unsigned int client, const uint8_t prefix) {
+    vector<uint8_t> duid(10, 0);
+    duid[1] = DUID::DUID_LL;
+    duid[3] = HTYPE_ETHER;
+    duid[4] = prefix;
+    duid[6] = (client >> 24) & 0xff;
+    duid[7] = (client >> 16) & 0xff;
+    duid[8] = (client >> 8) & 0xff;
+    duid[9] = client & 0xff;
+    return (duid);
+}
+
+/// @brief Generates the server configuration.
+///
+/// @param subnets Number of subnets.
+/// @param dbaccess Lease database access string.
+/// @param libraries Hooks libraries to be loaded.
+/// @return Configuration text.
+string
+generateConfig(const unsigned int subnets, const string& dbaccess,
+               const vector<string>& libraries) {
+    ostringstream s;
+    s << "{ \"preferred-lifetime\": 3000,\n"
+      << "  \"valid-lifetime\": 4000,\n"
+      << "  \"renew-timer\": 1000,\n"
+      << "  \"rebind-timer\": 2000,\n"
+      << "  \"lease-database\": {";
+    istringstream params(dbaccess);
+    string param;
+    bool first = true;
+    while (params >> param) {
+        const size_t pos = param.find('=');
+        const string name = param.substr(0, pos);
+        const string value = (pos == string::npos ? "" :
+                              param.substr(pos + 1));
+        s << (first ? " " : ", ") << "\"" << name << "\": ";
+        if (name == "persist") {
+            s << value;
+        } else {
+            s << "\"" << value << "\"";
+        }
+        first = false;
+    }
+    s << " },\n"
+      << "  \"hooks-libraries\": [";
+    for (size_t i = 0; i < libraries.size(); ++i) {
+        s << (i == 0 ? " " : ", ") << "\"" << libraries[i] << "\"";
+    }
+    s << " ],\n"
+      << "  \"subnet6\": [\n";
+    for (unsigned int i = 0; i < subnets; ++i) {
+        s << "    { \"id\": " << (i + 1) << ", \"subnet\": \""
+          << getAddress(i, 0).toText() << "/64\", \"pools\": [ { \"pool\": \""
+          << getAddress(i, POOL_START).toText() << " - "
+          << getAddress(i, POOL_START + POOL_SIZE - 1).toText()
+          << "\" } ] }" << (i + 1 < subnets ? "," : "") << "\n";
+    }
+    s << "  ]\n"
+      << "}\n";
+    return (s.str());
+}
+
+/// @brief Allocates the leases to the clients not taking part in the test.
+///
+/// @param subnets Number of subnets.
+/// @param fill Percentage of the pool addresses to be allocated.
+/// @return Number of allocated leases.
+unsigned int
+fillPools(const unsigned int subnets, const unsigned int fill) {
+    const unsigned int leases_num = POOL_SIZE * fill / 100;
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    for (unsigned int i = 0; i < subnets; ++i) {
+        for (unsigned int j = 0; j < leases_num; ++j) {
+            DuidPtr duid(new DUID(getDuid(i * POOL_SIZE + j, 0x04)));
+            Lease6Ptr lease(new Lease6(Lease::TYPE_NA,
+                                       getAddress(i, POOL_START + j), duid, 1,
+                                       3000, 4000, 1000, 2000, i + 1));
+            lease_mgr.addLease(lease);
+        }
+    }
+    return (leases_num * subnets);
+}
+
+/// @brief Removes the leases from the pools.
+///
+/// @param subnets Number of subnets.
+void
+clearPools(const unsigned int subnets) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+    for (unsigned int i = 0; i < subnets; ++i) {
+        for (unsigned int j = 0; j < POOL_SIZE; ++j) {
+            lease_mgr.deleteLease(getAddress(i, POOL_START + j));
+        }
+    }
+}
+
+/// @brief Creates the message relayed from the client.
+///
+/// @param type Message type.
+/// @param client Index of the client, also used as the transaction id.
+/// @param subnets Number of subnets.
+/// @param ia IA_NA option.
+/// @param server_id Server identifier option or null.
+/// @return Relayed message.
+Query
+createQuery(const uint8_t type, const unsigned int client,
+            const unsigned int subnets, const OptionPtr& ia,
+            const OptionPtr& server_id) {
+    Pkt6Ptr pkt(new Pkt6(type, client + 1));
+    pkt->addOption(OptionPtr(new Option(Option::V6, D6O_CLIENTID,
+                                        getDuid(client, 0x02))));
+    pkt->addOption(ia);
+    if (server_id) {
+        pkt->addOption(server_id);
+    }
+    Pkt6::RelayInfo relay;
+    relay.msg_type_ = DHCPV6_RELAY_FORW;
+    relay.linkaddr_ = getAddress(client % subnets, 1);
+    relay.peeraddr_ = IOAddress("fe80::2");
+    pkt->addRelayInfo(relay);
+    pkt->pack();
+    return (Query(pkt, relay.linkaddr_));
+}
+
+/// @brief Returns the CPU time used by the process in nanoseconds.
+uint64_t
+getCpuNanos() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return ((static_cast<uint64_t>(usage.ru_utime.tv_sec) +
+             usage.ru_stime.tv_sec) * 1000000000 +
+            (static_cast<uint64_t>(usage.ru_utime.tv_usec) +
+             usage.ru_stime.tv_usec) * 1000);
+}
+
+/// @brief Processes the messages and reports the results.
+///
+/// @param name Name of the exchange.
+/// @param srv Server instance.
+/// @param filter Packet filter capturing the responses.
+/// @param queries Messages to be processed.
+void
+runBenchmark(const string& name, BenchDhcpv6Srv& srv,
+             PktFilterBench& filter, const vector<Query>& queries) {
+    StatsMgr::instance().resetAll();
+    filter.sent_.clear();
+    const uint64_t cpu_start = getCpuNanos();
+    const uint64_t start = getMonotonicNanos();
+    srv.process(queries);
+    const double seconds =
+        static_cast<double>(getMonotonicNanos() - start) / 1e9;
+    const double cpu_seconds =
+        static_cast<double>(getCpuNanos() - cpu_start) / 1e9;
+
+    cout << name << ":" << endl;
+    cout << "  Queries: " << queries.size() << ", responses: "
+         << filter.sent_.size() << endl;
+    cout << "  Time: " << fixed << setprecision(3) << seconds
+         << " s, CPU: " << cpu_seconds << " s" << endl;
+    cout << "  Rate: " << setprecision(0)
+         << (static_cast<double>(queries.size()) / seconds)
+         << " packets/s" << endl;
+    cout << "  " << left << setw(28) << "Stage" << right << setw(10)
+         << "count" << setw(12) << "avg (us)" << setw(12) << "p99 (us)"
+         << setw(10) << "time %" << endl;
+    for (size_t i = 0; i < sizeof(STAGES) / sizeof(STAGES[0]); ++i) {
+        const Histogram& stage = StatsMgr::instance().getHistogram(STAGES[i]);
+        if (stage.getCount() == 0) {
+            continue;
+        }
+        cout << "  " << left << setw(28) << STAGES[i] << right
+             << setw(10) << stage.getCount() << setw(12) << setprecision(2)
+             << (static_cast<double>(stage.getSum()) / stage.getCount() /
+                 1000)
+             << setw(12)
+             << (static_cast<double>(stage.getPercentile(99)) / 1000)
+             << setw(10) << setprecision(1)
+             << (static_cast<double>(stage.getSum()) / 1e7 / seconds)
+             << endl;
+    }
+}
+
+void
+usage() {
+    cerr << "Usage: dhcp6_srv_bench [-c clients] [-s subnets] [-f fill]"
+         << " [-d dbaccess] [-l library]" << endl;
+    cerr << "  -c clients   number of clients (10000)" << endl;
+    cerr << "  -s subnets   number of subnets (100)" << endl;
+    cerr << "  -f fill      percentage of the pool addresses allocated"
+         << " before the test (0)" << endl;
+    cerr << "  -d dbaccess  lease database access string"
+         << " (\"type=memfile persist=false\")" << endl;
+    cerr << "  -l library   hooks library to be loaded, may be repeated"
+         << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    unsigned int clients = 10000;
+    unsigned int subnets = 100;
+    unsigned int fill = 0;
+    string dbaccess = "type=memfile persist=false";
+    vector<string> libraries;
+    while ((ch = getopt(argc, argv, "c:s:f:d:l:")) != -1) {
+        switch (ch) {
+        case 'c':
+            clients = atoi(optarg);
+            break;
+        case 's':
+            subnets = atoi(optarg);
+            break;
+        case 'f':
+            fill = atoi(optarg);
+            break;
+        case 'd':
+            dbaccess = optarg;
+            break;
+        case 'l':
+            libraries.push_back(optarg);
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if ((argc != 0) || (clients == 0) || (subnets == 0) ||
+        (subnets > 65536) || (fill > 100)) {
+        usage();
+    }
+
+    isc::log::initLogger("dhcp6_srv_bench", isc::log::WARN);
+
+    PktFilterBenchPtr filter(new PktFilterBench());
+    IfaceMgr& iface_mgr = IfaceMgr::instance();
+    iface_mgr.setPacketFilter(filter);
+    iface_mgr.clearIfaces();
+    Iface iface(IFACE_NAME, 1);
+    iface.flag_up_ = true;
+    iface.flag_running_ = true;
+    iface.flag_multicast_ = true;
+    const uint8_t mac[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    iface.setMac(mac, sizeof(mac));
+    iface.setHWType(HTYPE_ETHER);
+    iface.addAddress(IOAddress(IFACE_ADDRESS));
+    iface_mgr.addInterface(iface);
+    iface_mgr.openSocket(IFACE_NAME, IOAddress(IFACE_ADDRESS),
+                         DHCP6_SERVER_PORT);
+
+    // The server identifier is generated from the fake interface.
+    BenchDhcpv6Srv srv;
+
+    int rcode = 0;
+    ConstElementPtr comment =
+        isc::config::parseAnswer(rcode, configureDhcp6Server(srv,
+            Element::fromJSON(generateConfig(subnets, dbaccess, libraries))));
+    if (rcode != 0) {
+        cerr << "configuration failed: " << comment->str() << endl;
+        return (1);
+    }
+
+    cout << "Parameters:" << endl;
+    cout << "  Clients: " << clients << endl;
+    cout << "  Subnets: " << subnets << endl;
+    cout << "  Lease database: " << dbaccess << endl;
+    for (size_t i = 0; i < libraries.size(); ++i) {
+        cout << "  Hooks library: " << libraries[i] << endl;
+    }
+    cout << "  Preallocated leases: " << fillPools(subnets, fill) << " ("
+         << fill << "% of each pool)" << endl;
+
+    // Clients are spread over the subnets and each subnet is reached
+    // through its own relay.
+    vector<Query> solicits;
+    solicits.reserve(clients);
+    for (unsigned int i = 0; i < clients; ++i) {
+        solicits.push_back(createQuery(DHCPV6_SOLICIT, i, subnets,
+                                       OptionPtr(new Option6IA(D6O_IA_NA, 1)),
+                                       OptionPtr()));
+    }
+    runBenchmark("SOLICIT", srv, *filter, solicits);
+
+    vector<Query> requests;
+    requests.reserve(filter->sent_.size());
+    for (size_t i = 0; i < filter->sent_.size(); ++i) {
+        const Pkt6Ptr& advertise = filter->sent_[i];
+        if ((advertise->getType() != DHCPV6_ADVERTISE) ||
+            !advertise->getOption(D6O_IA_NA)) {
+            continue;
+        }
+        // The transaction id identifies the client.
+        requests.push_back(createQuery(DHCPV6_REQUEST,
+                                       advertise->getTransid() - 1, subnets,
+                                       advertise->getOption(D6O_IA_NA),
+                                       advertise->getOption(D6O_SERVERID)));
+    }
+    runBenchmark("REQUEST", srv, *filter, requests);
+
+    clearPools(subnets);
+    return (0);
+}
@@ -18,6 +18,7 @@
 #include <dhcp6/ctrl_dhcp6_srv.h>
 #include <dhcp6/dhcp6_log.h>
 #include <hooks/hooks_manager.h>
+#include <stats/stats_mgr.h>
 #include <dhcp6/json_config_parser.h>
 
 using namespace isc::data;
@@ -65,6 +66,20 @@ ControlledDhcpv6Srv::commandConfigReloadHandler(const string&, ConstElementPtr a
     return (processConfig(args));
 }
 
+ConstElementPtr
+ControlledDhcpv6Srv::commandStatisticGetAllHandler(const string&,
+                                                   ConstElementPtr) {
+    return (isc::config::createAnswer(0, isc::stats::StatsMgr::instance().
+                                      toElement()));
+}
+
+ConstElementPtr
+ControlledDhcpv6Srv::commandStatisticResetAllHandler(const string&,
+                                                     ConstElementPtr) {
+    isc::stats::StatsMgr::instance().resetAll();
+    return (isc::config::createAnswer(0, "All statistics reset."));
+}
+
 isc::data::ConstElementPtr
 ControlledDhcpv6Srv::processCommand(const std::string& command,
                                     isc::data::ConstElementPtr args) {
@@ -89,6 +104,12 @@ ControlledDhcpv6Srv::processCommand(const std::string& command,
 
         } else if (command == "config-reload") {
             return (srv->commandConfigReloadHandler(command, args));
+
+        } else if (command == "statistic-get-all") {
+            return (srv->commandStatisticGetAllHandler(command, args));
+
+        } else if (command == "statistic-reset-all") {
+            return (srv->commandStatisticResetAllHandler(command, args));
         }
 
         return (isc::config::createAnswer(1, "Unrecognized command:"
@@ -54,6 +54,30 @@
         "item_default": 4000
       },
 
+      { "item_name": "trace-sampling-rate",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 0
+      },
+
+      { "item_name": "trace-file",
+        "item_type": "string",
+        "item_optional": true,
+        "item_default": ""
+      },
+
+      { "item_name": "trace-file-records",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 65536
+      },
+
+      { "item_name": "config-threads",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 0
+      },
+
       { "item_name": "option-def",
         "item_type": "list",
         "item_optional": false,
@@ -491,6 +515,18 @@
             "command_name": "libreload",
             "command_description": "Reloads the current hooks libraries.",
             "command_args": []
+        },
+
+        {
+            "command_name": "statistic-get-all",
+            "command_description": "Returns all server statistics.",
+            "command_args": []
+        },
+
+        {
+            "command_name": "statistic-reset-all",
+            "command_description": "Resets all server statistics.",
+            "command_args": []
         }
     ]
   }
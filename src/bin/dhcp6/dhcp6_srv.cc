@@ -37,11 +37,14 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/pkt_tracer.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/utils.h>
 #include <exceptions/exceptions.h>
 #include <hooks/callout_handle.h>
 #include <hooks/hooks_manager.h>
+#include <log/log_address.h>
+#include <stats/stats_mgr.h>
 #include <util/encode/hex.h>
 #include <util/io_utilities.h>
 #include <util/range_utilities.h>
@@ -62,6 +65,7 @@ using namespace isc::asiolink;
 using namespace isc::dhcp_ddns;
 using namespace isc::dhcp;
 using namespace isc::hooks;
+using namespace isc::stats;
 using namespace isc::util;
 using namespace std;
 
@@ -97,6 +101,91 @@ struct Dhcp6Hooks {
 // module is called.
 Dhcp6Hooks Hooks;
 
+/// Structure that holds references to the statistics of the DHCPv6 engine
+struct Dhcp6Stats {
+    Counter& pkt6_received_;        ///< packets received
+    Counter& pkt6_receive_fail_;    ///< errors during packet reception
+    Counter& pkt6_parse_fail_;      ///< packets dropped due to parse errors
+    Counter& pkt6_receive_drop_;    ///< packets not accepted by the server
+    Counter& pkt6_solicit_received_;  ///< SOLICIT messages received
+    Counter& pkt6_request_received_;  ///< REQUEST messages received
+    Counter& pkt6_renew_received_;    ///< RENEW messages received
+    Counter& pkt6_rebind_received_;   ///< REBIND messages received
+    Counter& pkt6_confirm_received_;  ///< CONFIRM messages received
+    Counter& pkt6_release_received_;  ///< RELEASE messages received
+    Counter& pkt6_decline_received_;  ///< DECLINE messages received
+    Counter& pkt6_infrequest_received_; ///< INFORMATION-REQUEST received
+    Counter& pkt6_unknown_received_;  ///< messages of unsupported types
+    Counter& pkt6_process_fail_;    ///< packets dropped due to processing errors
+    Counter& pkt6_advertise_sent_;  ///< ADVERTISE messages sent
+    Counter& pkt6_reply_sent_;      ///< REPLY messages sent
+    Counter& pkt6_sent_;            ///< all packets sent
+    Counter& pkt6_send_fail_;       ///< errors during packing or sending
+    Counter& v6_allocation_fail_;   ///< no address allocated for IA_NA
+    Counter& v6_pd_allocation_fail_; ///< no prefix allocated for IA_PD
+    Counter& hooks_buffer6_receive_skip_; ///< buffer6_receive callouts skips
+    Counter& hooks_pkt6_receive_skip_;    ///< pkt6_receive callouts skips
+    Counter& hooks_pkt6_send_skip_;       ///< pkt6_send callouts skips
+    Counter& hooks_buffer6_send_skip_;    ///< buffer6_send callouts skips
+    Histogram& unpack_latency_;     ///< duration of the packet parsing
+    Histogram& classify_latency_;   ///< duration of the packet classification
+    Histogram& select_subnet_latency_; ///< duration of the subnet selection
+    Histogram& allocate_latency_;   ///< duration of the lease allocation
+    Histogram& process_latency_;    ///< duration of the packet processing
+    Histogram& pack_latency_;       ///< duration of the response packing
+    Histogram& send_latency_;       ///< duration of the response sending
+
+    /// Constructor that registers statistics of the DHCPv6 engine
+    Dhcp6Stats()
+        : pkt6_received_(getCounter("pkt6-received")),
+          pkt6_receive_fail_(getCounter("pkt6-receive-fail")),
+          pkt6_parse_fail_(getCounter("pkt6-parse-fail")),
+          pkt6_receive_drop_(getCounter("pkt6-receive-drop")),
+          pkt6_solicit_received_(getCounter("pkt6-solicit-received")),
+          pkt6_request_received_(getCounter("pkt6-request-received")),
+          pkt6_renew_received_(getCounter("pkt6-renew-received")),
+          pkt6_rebind_received_(getCounter("pkt6-rebind-received")),
+          pkt6_confirm_received_(getCounter("pkt6-confirm-received")),
+          pkt6_release_received_(getCounter("pkt6-release-received")),
+          pkt6_decline_received_(getCounter("pkt6-decline-received")),
+          pkt6_infrequest_received_(getCounter("pkt6-infrequest-received")),
+          pkt6_unknown_received_(getCounter("pkt6-unknown-received")),
+          pkt6_process_fail_(getCounter("pkt6-process-fail")),
+          pkt6_advertise_sent_(getCounter("pkt6-advertise-sent")),
+          pkt6_reply_sent_(getCounter("pkt6-reply-sent")),
+          pkt6_sent_(getCounter("pkt6-sent")),
+          pkt6_send_fail_(getCounter("pkt6-send-fail")),
+          v6_allocation_fail_(getCounter("v6-allocation-fail")),
+          v6_pd_allocation_fail_(getCounter("v6-pd-allocation-fail")),
+          hooks_buffer6_receive_skip_(getCounter("hooks-buffer6-receive-skip")),
+          hooks_pkt6_receive_skip_(getCounter("hooks-pkt6-receive-skip")),
+          hooks_pkt6_send_skip_(getCounter("hooks-pkt6-send-skip")),
+          hooks_buffer6_send_skip_(getCounter("hooks-buffer6-send-skip")),
+          unpack_latency_(getHistogram("pkt6-unpack-latency")),
+          classify_latency_(getHistogram("pkt6-classify-latency")),
+          select_subnet_latency_(getHistogram("pkt6-select-subnet-latency")),
+          allocate_latency_(getHistogram("pkt6-allocate-latency")),
+          process_latency_(getHistogram("pkt6-process-latency")),
+          pack_latency_(getHistogram("pkt6-pack-latency")),
+          send_latency_(getHistogram("pkt6-send-latency")) {
+    }
+
+    /// Returns the counter of the specified name
+    static Counter& getCounter(const char* name) {
+        return (StatsMgr::instance().getCounter(name));
+    }
+
+    /// Returns the histogram of the specified name
+    static Histogram& getHistogram(const char* name) {
+        return (StatsMgr::instance().getHistogram(name));
+    }
+};
+
+// Declare a Stats object. Similarly to the Hooks object, it is instantiated
+// when the module is loaded, so the packet processing code uses references
+// to the statistics rather than looking them up by name for each packet.
+Dhcp6Stats Stats;
+
 }; // anonymous namespace
 
 namespace isc {
@@ -251,6 +340,7 @@ bool Dhcpv6Srv::run() {
             // behavior of the system, but there is nothing we should log here.
         } catch (const std::exception& e) {
             LOG_ERROR(dhcp6_logger, DHCP6_PACKET_RECEIVE_FAIL).arg(e.what());
+            Stats.pkt6_receive_fail_.inc();
         }
 
         // Handle next signal received by the process. It must be called after
@@ -271,6 +361,15 @@ bool Dhcpv6Srv::run() {
             continue;
         }
 
+        Stats.pkt6_received_.inc();
+
+        // The processing stages of the sampled packets are timestamped to
+        // find out where the time is spent.
+        if (PktTracer::instance().sample()) {
+            query->setTraced(true);
+            query->markStage(Pkt::STAGE_RECEIVED);
+        }
+
         // In order to parse the DHCP options, the server needs to use some
         // configuration information such as: existing option spaces, option
         // definitions etc. This is the kind of information which is not
@@ -302,6 +401,7 @@ bool Dhcpv6Srv::run() {
             // should skip parsing.
             if (callout_handle->getSkip()) {
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_RCVD_SKIP);
+                Stats.hooks_buffer6_receive_skip_.inc();
                 skip_unpack = true;
             }
 
@@ -312,16 +412,20 @@ bool Dhcpv6Srv::run() {
         // indicated they did it
         if (!skip_unpack) {
             try {
+                ScopedLatency timer(Stats.unpack_latency_);
                 query->unpack();
             } catch (const std::exception &e) {
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
                           DHCP6_PACKET_PARSE_FAIL).arg(e.what());
+                Stats.pkt6_parse_fail_.inc();
                 continue;
             }
         }
+        query->markStage(Pkt::STAGE_PARSED);
         // Check if received query carries server identifier matching
         // server identifier being used by the server.
         if (!testServerID(query)) {
+            Stats.pkt6_receive_drop_.inc();
             continue;
         }
 
@@ -329,10 +433,12 @@ bool Dhcpv6Srv::run() {
         // The Solicit, Confirm, Rebind and Information Request will be
         // discarded if sent to unicast address.
         if (!testUnicast(query)) {
+            Stats.pkt6_receive_drop_.inc();
             continue;
         }
 
-        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL, DHCP6_PACKET_RECEIVED)
+        LOG_DEBUG_DEFERRED(dhcp6_logger, DBG_DHCP6_DETAIL,
+                           DHCP6_PACKET_RECEIVED)
             .arg(query->getName());
         LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA, DHCP6_QUERY_DATA)
             .arg(static_cast<int>(query->getType()))
@@ -359,6 +465,7 @@ bool Dhcpv6Srv::run() {
             // stage means drop.
             if (callout_handle->getSkip()) {
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_RCVD_SKIP);
+                Stats.hooks_pkt6_receive_skip_.inc();
                 continue;
             }
 
@@ -366,44 +473,57 @@ bool Dhcpv6Srv::run() {
         }
 
         // Assign this packet to a class, if possible
-        classifyPacket(query);
+        {
+            ScopedLatency timer(Stats.classify_latency_);
+            classifyPacket(query);
+        }
 
         try {
+            ScopedLatency timer(Stats.process_latency_);
                 NameChangeRequestPtr ncr;
             switch (query->getType()) {
             case DHCPV6_SOLICIT:
+                Stats.pkt6_solicit_received_.inc();
                 rsp = processSolicit(query);
                     break;
 
             case DHCPV6_REQUEST:
+                Stats.pkt6_request_received_.inc();
                 rsp = processRequest(query);
                 break;
 
             case DHCPV6_RENEW:
+                Stats.pkt6_renew_received_.inc();
                 rsp = processRenew(query);
                 break;
 
             case DHCPV6_REBIND:
+                Stats.pkt6_rebind_received_.inc();
                 rsp = processRebind(query);
                 break;
 
             case DHCPV6_CONFIRM:
+                Stats.pkt6_confirm_received_.inc();
                 rsp = processConfirm(query);
                 break;
 
             case DHCPV6_RELEASE:
+                Stats.pkt6_release_received_.inc();
                 rsp = processRelease(query);
                 break;
 
             case DHCPV6_DECLINE:
+                Stats.pkt6_decline_received_.inc();
                 rsp = processDecline(query);
                 break;
 
             case DHCPV6_INFORMATION_REQUEST:
+                Stats.pkt6_infrequest_received_.inc();
                 rsp = processInfRequest(query);
                 break;
 
             default:
+                Stats.pkt6_unknown_received_.inc();
                 // We received a packet type that we do not recognize.
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_UNKNOWN_MSG_RECEIVED)
                     .arg(static_cast<int>(query->getType()))
@@ -419,6 +539,7 @@ bool Dhcpv6Srv::run() {
                 .arg(query->getName())
                 .arg(query->getRemoteAddr().toText())
                 .arg(e.what());
+            Stats.pkt6_process_fail_.inc();
 
         } catch (const isc::Exception& e) {
 
@@ -432,6 +553,7 @@ bool Dhcpv6Srv::run() {
                 .arg(query->getName())
                 .arg(query->getRemoteAddr().toText())
                 .arg(e.what());
+            Stats.pkt6_process_fail_.inc();
         }
 
         if (rsp) {
@@ -476,9 +598,11 @@ bool Dhcpv6Srv::run() {
                 // so the server does not have to do it again.
                 if (callout_handle->getSkip()) {
                     LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_SEND_SKIP);
+                    Stats.hooks_pkt6_send_skip_.inc();
                     skip_pack = true;
                 }
             }
+            query->markStage(Pkt::STAGE_HOOKS_DONE);
 
             LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
                       DHCP6_RESPONSE_DATA)
@@ -486,10 +610,12 @@ bool Dhcpv6Srv::run() {
 
             if (!skip_pack) {
                 try {
+                    ScopedLatency timer(Stats.pack_latency_);
                     rsp->pack();
                 } catch (const std::exception& e) {
                     LOG_ERROR(dhcp6_logger, DHCP6_PACK_FAIL)
                         .arg(e.what());
+                    Stats.pkt6_send_fail_.inc();
                     continue;
                 }
 
@@ -518,6 +644,7 @@ bool Dhcpv6Srv::run() {
                     // stage means drop.
                     if (callout_handle->getSkip()) {
                         LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_SEND_SKIP);
+                        Stats.hooks_buffer6_send_skip_.inc();
                         continue;
                     }
 
@@ -528,10 +655,23 @@ bool Dhcpv6Srv::run() {
                           DHCP6_RESPONSE_DATA)
                     .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
-                sendPacket(rsp);
+                {
+                    ScopedLatency timer(Stats.send_latency_);
+                    sendPacket(rsp);
+                }
+                query->markStage(Pkt::STAGE_SENT);
+                PktTracer::instance().record(AF_INET6, *query);
+
+                Stats.pkt6_sent_.inc();
+                if (rsp->getType() == DHCPV6_ADVERTISE) {
+                    Stats.pkt6_advertise_sent_.inc();
+                } else if (rsp->getType() == DHCPV6_REPLY) {
+                    Stats.pkt6_reply_sent_.inc();
+                }
             } catch (const std::exception& e) {
                 LOG_ERROR(dhcp6_logger, DHCP6_PACKET_SEND_FAIL)
                     .arg(e.what());
+                Stats.pkt6_send_fail_.inc();
             }
         }
     }
@@ -868,6 +1008,7 @@ Dhcpv6Srv::sanityCheck(const Pkt6Ptr& pkt, RequirementLevel clientid,
 
 Subnet6Ptr
 Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question) {
+    ScopedLatency timer(Stats.select_subnet_latency_);
 
     Subnet6Ptr subnet;
 
@@ -936,6 +1077,7 @@ Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question) {
         callout_handle->getArgument("subnet6", subnet);
     }
 
+    question->markStage(Pkt::STAGE_SUBNET_SELECTED);
     return (subnet);
 }
 
@@ -1273,14 +1415,16 @@ Dhcpv6Srv::assignIA_NA(const Subnet6Ptr& subnet, const DuidPtr& duid,
     // may be used instead. If fake_allocation is set to false, the lease will
     // be inserted into the LeaseMgr as well.
     Lease6Collection old_leases;
-    Lease6Collection leases = alloc_engine_->allocateLeases6(subnet, duid,
-                                                             ia->getIAID(),
-                                                             hint, Lease::TYPE_NA,
-                                                             do_fwd, do_rev,
-                                                             hostname,
-                                                             fake_allocation,
-                                                             callout_handle,
-                                                             old_leases);
+    Lease6Collection leases;
+    {
+        ScopedLatency timer(Stats.allocate_latency_);
+        leases = alloc_engine_->allocateLeases6(subnet, duid, ia->getIAID(),
+                                                hint, Lease::TYPE_NA,
+                                                do_fwd, do_rev, hostname,
+                                                fake_allocation,
+                                                callout_handle, old_leases);
+    }
+    query->markStage(Pkt::STAGE_LEASE_ALLOCATED);
     /// @todo: Handle more than one lease
     Lease6Ptr lease;
     if (!leases.empty()) {
@@ -1295,9 +1439,9 @@ Dhcpv6Srv::assignIA_NA(const Subnet6Ptr& subnet, const DuidPtr& duid,
     if (lease) {
         // We have a lease! Let's wrap its content into IA_NA option
         // with IAADDR suboption.
-        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL, fake_allocation?
-                  DHCP6_LEASE_ADVERT:DHCP6_LEASE_ALLOC)
-            .arg(lease->addr_.toText())
+        LOG_DEBUG_DEFERRED(dhcp6_logger, DBG_DHCP6_DETAIL, fake_allocation?
+                           DHCP6_LEASE_ADVERT:DHCP6_LEASE_ALLOC)
+            .arg(lease->addr_)
             .arg(duid?duid->toText():"(no-duid)")
             .arg(ia->getIAID());
 
@@ -1345,6 +1489,7 @@ Dhcpv6Srv::assignIA_NA(const Subnet6Ptr& subnet, const DuidPtr& duid,
                   DHCP6_LEASE_ADVERT_FAIL : DHCP6_LEASE_ALLOC_FAIL)
             .arg(duid?duid->toText():"(no-duid)")
             .arg(ia->getIAID());
+        Stats.v6_allocation_fail_.inc();
 
         ia_rsp->addOption(createStatusCode(STATUS_NoAddrsAvail,
                           "Sorry, no address could be allocated."));
@@ -1402,14 +1547,16 @@ Dhcpv6Srv::assignIA_PD(const Subnet6Ptr& subnet, const DuidPtr& duid,
     // may be used instead. If fake_allocation is set to false, the lease will
     // be inserted into the LeaseMgr as well.
     Lease6Collection old_leases;
-    Lease6Collection leases = alloc_engine_->allocateLeases6(subnet, duid,
-                                                             ia->getIAID(),
-                                                             hint, Lease::TYPE_PD,
-                                                             false, false,
-                                                             string(),
-                                                             fake_allocation,
-                                                             callout_handle,
-                                                             old_leases);
+    Lease6Collection leases;
+    {
+        ScopedLatency timer(Stats.allocate_latency_);
+        leases = alloc_engine_->allocateLeases6(subnet, duid, ia->getIAID(),
+                                                hint, Lease::TYPE_PD,
+                                                false, false, string(),
+                                                fake_allocation,
+                                                callout_handle, old_leases);
+    }
+    query->markStage(Pkt::STAGE_LEASE_ALLOCATED);
 
     if (!leases.empty()) {
 
@@ -1421,9 +1568,9 @@ Dhcpv6Srv::assignIA_PD(const Subnet6Ptr& subnet, const DuidPtr& duid,
 
             // We have a lease! Let's wrap its content into IA_PD option
             // with IAADDR suboption.
-            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL, fake_allocation ?
-                      DHCP6_PD_LEASE_ADVERT : DHCP6_PD_LEASE_ALLOC)
-                .arg((*l)->addr_.toText())
+            LOG_DEBUG_DEFERRED(dhcp6_logger, DBG_DHCP6_DETAIL, fake_allocation ?
+                               DHCP6_PD_LEASE_ADVERT : DHCP6_PD_LEASE_ALLOC)
+                .arg((*l)->addr_)
                 .arg(static_cast<int>((*l)->prefixlen_))
                 .arg(duid ? duid->toText() : "(no-duid)")
                 .arg(ia->getIAID());
@@ -1448,6 +1595,7 @@ Dhcpv6Srv::assignIA_PD(const Subnet6Ptr& subnet, const DuidPtr& duid,
                   DHCP6_PD_LEASE_ADVERT_FAIL : DHCP6_PD_LEASE_ALLOC_FAIL)
             .arg(duid ? duid->toText() : "(no-duid)")
             .arg(ia->getIAID());
+        Stats.v6_pd_allocation_fail_.inc();
 
         ia_rsp->addOption(createStatusCode(STATUS_NoPrefixAvail,
                           "Sorry, no prefixes could be allocated."));
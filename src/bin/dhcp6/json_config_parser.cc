@@ -15,6 +15,7 @@
 #include <asiolink/io_address.h>
 #include <cc/data.h>
 #include <config/ccsession.h>
+#include <dhcp/docsis3_option_defs.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp6/json_config_parser.h>
 #include <dhcp6/dhcp6_log.h>
@@ -23,8 +24,11 @@
 #include <dhcpsrv/dbaccess_parser.h>
 #include <dhcpsrv/dhcp_config_parser.h>
 #include <dhcpsrv/dhcp_parsers.h>
+#include <dhcpsrv/parallel_parser_builder.h>
+#include <dhcpsrv/pkt_tracer.h>
 #include <dhcpsrv/pool.h>
 #include <dhcpsrv/subnet.h>
+#include <dhcpsrv/subnet_config_cache.h>
 #include <dhcpsrv/triplet.h>
 #include <log/logger_support.h>
 #include <util/encode/hex.h>
@@ -38,6 +42,7 @@
 
 #include <iostream>
 #include <map>
+#include <set>
 #include <vector>
 
 #include <stdint.h>
@@ -386,8 +391,10 @@ public:
         :SubnetConfigParser("", globalContext(), IOAddress("::")) {
     }
 
-    /// @brief Parses a single IPv4 subnet configuration and adds to the
-    /// Configuration Manager.
+    /// @brief Parses a single IPv6 subnet configuration.
+    ///
+    /// The subnet created is added to the Configuration Manager by the
+    /// @c Subnets6ListConfigParser.
     ///
     /// @param subnet A new subnet being configured.
     void build(ConstElementPtr subnet) {
@@ -405,26 +412,20 @@ public:
             if (relay_info_) {
                 sub6ptr->setRelayInfo(*relay_info_);
             }
-
-            // Adding a subnet to the Configuration Manager may fail if the
-            // subnet id is invalid (duplicate). Thus, we catch exceptions
-            // here to append a position in the configuration string.
-            try {
-                isc::dhcp::CfgMgr::instance().addSubnet6(sub6ptr);
-            } catch (const std::exception& ex) {
-                isc_throw(DhcpConfigError, ex.what() << " ("
-                          << subnet->getPosition() << ")");
-            }
-
         }
     }
 
     /// @brief Commits subnet configuration.
     ///
-    /// This function is currently no-op because subnet should already
-    /// be added into the Config Manager in the build().
+    /// This function is currently no-op because the subnet is added into
+    /// the Config Manager by the @c Subnets6ListConfigParser.
     void commit() { }
 
+    /// @brief Returns the subnet created by the build().
+    Subnet6Ptr getSubnet() const {
+        return (boost::dynamic_pointer_cast<Subnet6>(subnet_));
+    }
+
 protected:
 
     /// @brief creates parsers for entries in subnet definition
@@ -598,33 +599,93 @@ public:
     /// @brief parses contents of the list
     ///
     /// Iterates over all entries on the list and creates a Subnet6ConfigParser
-    /// for each entry.
+    /// for each entry. The subnets which haven't changed since the last
+    /// configuration are not parsed: the existing subnet objects are reused
+    /// (see @c SubnetConfigCache), so as they retain their run time state.
+    ///
+    /// The subnets are collected in the parser and replace the subnets held
+    /// by the Configuration Manager on commit, so the current subnets remain
+    /// intact if the configuration fails.
+    ///
+    /// The subnet parsers are built concurrently using the number of threads
+    /// specified with the "config-threads" global parameter (see
+    /// @c ParallelParserBuilder).
     ///
     /// @param subnets_list pointer to a list of IPv6 subnets
     void build(ConstElementPtr subnets_list) {
-        // @todo: Implement more subtle reconfiguration than toss
-        // the old one and replace with the new one.
-
-        // remove old subnets
-        isc::dhcp::CfgMgr::instance().deleteSubnets6();
-
+        // The option definitions and the staging configuration (which the
+        // option data parsers look the option definitions up in) are
+        // created on the first use. Make sure they are created before the
+        // parsers are run concurrently.
+        LibDHCP::getOptionDefs(Option::V6);
+        LibDHCP::getVendorOption6Defs(VENDOR_ID_CABLE_LABS);
+        CfgMgr::instance().getStagingCfg();
+
+        // Parse the subnets which can't be reused. The subnets for which
+        // the identifier is generated are parsed in the order of appearance,
+        // so as they get the same identifiers as when parsed one by one.
+        ParallelParserBuilder builder(globalContext()->uint32_values_->
+                                      getOptionalParam("config-threads", 0));
+        std::vector<Subnet6Ptr> reused;
+        std::vector<boost::shared_ptr<Subnet6ConfigParser> > parsers;
         BOOST_FOREACH(ConstElementPtr subnet, subnets_list->listValue()) {
-            ParserPtr parser(new Subnet6ConfigParser("subnet"));
-            parser->build(subnet);
-            subnets_.push_back(parser);
+            Subnet6Ptr subnet6 = boost::dynamic_pointer_cast<
+                Subnet6>(subnetConfigCache().get(subnet));
+            reused.push_back(subnet6);
+            parsers.push_back(boost::shared_ptr<Subnet6ConfigParser>());
+            if (subnet6) {
+                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
+                          DHCP6_CONFIG_SUBNET_REUSED).arg(subnet6->toText());
+            } else {
+                parsers.back().reset(new Subnet6ConfigParser("subnet"));
+                builder.add(parsers.back(), subnet, !hasExplicitId(subnet));
+            }
         }
+        builder.build();
+
+        // Collect the subnets in the order of appearance.
+        for (size_t i = 0; i < reused.size(); ++i) {
+            ConstElementPtr subnet = subnets_list->get(i);
+            Subnet6Ptr subnet6 = reused[i];
+            if (!subnet6) {
+                subnets_.push_back(parsers[i]);
+                subnet6 = parsers[i]->getSubnet();
+                if (!subnet6) {
+                    continue;
+                }
+            }
 
+            if (!ids_.insert(subnet6->getID()).second) {
+                isc_throw(DhcpConfigError, "ID of the new IPv6 subnet '"
+                          << subnet6->getID() << "' is already in use ("
+                          << subnet->getPosition() << ")");
+            }
+            subnets6_.push_back(subnet6);
+            subnetConfigCache().add(subnet, subnet6);
+        }
     }
 
     /// @brief commits subnets definitions.
     ///
     /// Iterates over all Subnet6 parsers. Each parser contains definitions of
     /// a single subnet and its parameters and commits each subnet separately.
+    /// Then, replaces the subnets held by the Configuration Manager with the
+    /// parsed ones.
     void commit() {
         BOOST_FOREACH(ParserPtr subnet, subnets_) {
             subnet->commit();
         }
+        CfgMgr::instance().replaceSubnets6(subnets6_);
+    }
 
+    /// @brief Checks if the subnet configuration specifies the non-zero
+    /// subnet identifier.
+    ///
+    /// @param subnet Subnet configuration.
+    static bool hasExplicitId(const ConstElementPtr& subnet) {
+        ConstElementPtr id = subnet->get("id");
+        return (id && (id->getType() == Element::integer) &&
+                (id->intValue() > 0));
     }
 
     /// @brief Returns Subnet6ListConfigParser object
@@ -636,6 +697,12 @@ public:
 
     /// @brief collection of subnet parsers.
     ParserCollection subnets_;
+
+    /// @brief Parsed and reused subnets.
+    Subnet6Collection subnets6_;
+
+    /// @brief Identifiers of the subnets, used to detect duplicates.
+    std::set<SubnetID> ids_;
 };
 
 } // anonymous namespace
@@ -658,7 +725,10 @@ namespace dhcp {
     if ((config_id.compare("preferred-lifetime") == 0)  ||
         (config_id.compare("valid-lifetime") == 0)  ||
         (config_id.compare("renew-timer") == 0)  ||
-        (config_id.compare("rebind-timer") == 0))  {
+        (config_id.compare("rebind-timer") == 0) ||
+        (config_id.compare("trace-sampling-rate") == 0) ||
+        (config_id.compare("trace-file-records") == 0) ||
+        (config_id.compare("config-threads") == 0))  {
         parser = new Uint32Parser(config_id,
                                  globalContext()->uint32_values_);
     } else if (config_id.compare("interfaces") == 0) {
@@ -672,7 +742,8 @@ namespace dhcp {
                                           Dhcp6OptionDataParser::factory);
     } else if (config_id.compare("option-def") == 0) {
         parser  = new OptionDefListParser(config_id, globalContext());
-    } else if (config_id.compare("version") == 0) {
+    } else if ((config_id.compare("version") == 0) ||
+               (config_id.compare("trace-file") == 0)) {
         parser  = new StringParser(config_id,
                                    globalContext()->string_values_);
     } else if (config_id.compare("lease-database") == 0) {
@@ -705,6 +776,9 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
     // so newly recreated configuration starts with first subnet-id equal 1.
     Subnet::resetSubnetID();
 
+    // Find out which subnets can be reused from the current configuration.
+    subnetConfigCache().begin(config_set, "subnet6");
+
     // Some of the values specified in the configuration depend on
     // other values. Typically, the values in the subnet6 structure
     // depend on the global values. Also, option values configuration
@@ -795,6 +869,18 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
             subnet_parser->build(subnet_config->second);
         }
 
+        // Check the packet processing latency tracing configuration and
+        // create the trace file before anything is committed. The tracing
+        // is disabled unless the sampling rate is specified.
+        config_pair.first = "trace-file";
+        PktTracer::instance().stage(globalContext()->uint32_values_->
+                                    getOptionalParam("trace-sampling-rate", 0),
+                                    globalContext()->string_values_->
+                                    getOptionalParam("trace-file", ""),
+                                    globalContext()->uint32_values_->
+                                    getOptionalParam("trace-file-records",
+                                    PktTracer::DEFAULT_TRACE_FILE_RECORDS));
+
     } catch (const isc::Exception& ex) {
         LOG_ERROR(dhcp6_logger, DHCP6_PARSER_FAIL)
                   .arg(config_pair.first).arg(ex.what());
@@ -824,6 +910,10 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
             // No need to commit interface names as this is handled by the
             // CfgMgr::commit() function.
 
+            // Apply the packet processing latency tracing configuration
+            // staged when the configuration was parsed.
+            PktTracer::instance().commit();
+
             // This occurs last as if it succeeds, there is no easy way to
             // revert it.  As a result, the failure to commit a subsequent
             // change causes problems when trying to roll back.
@@ -849,9 +939,13 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
     // Rollback changes as the configuration parsing failed.
     if (rollback) {
         globalContext().reset(new ParserContext(original_context));
+        PktTracer::instance().rollback();
         return (answer);
     }
 
+    // The subnets of this configuration may be reused by the next one.
+    subnetConfigCache().commit();
+
     LOG_INFO(dhcp6_logger, DHCP6_CONFIG_COMPLETE)
         .arg(CfgMgr::instance().getCurrentCfg()->
              getConfigSummary(SrvConfig::CFGSEL_ALL6));
@@ -861,6 +955,11 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
     return (answer);
 }
 
+SubnetConfigCache& subnetConfigCache() {
+    static SubnetConfigCache subnet_config_cache;
+    return (subnet_config_cache);
+}
+
 ParserContextPtr& globalContext() {
     static ParserContextPtr global_context_ptr(new ParserContext(Option::V6));
     return (global_context_ptr);
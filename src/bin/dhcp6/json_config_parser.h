@@ -21,6 +21,7 @@
 #include <cc/data.h>
 #include <exceptions/exceptions.h>
 #include <dhcpsrv/dhcp_parsers.h>
+#include <dhcpsrv/subnet_config_cache.h>
 
 #include <string>
 
@@ -54,6 +55,12 @@ configureDhcp6Server(Dhcpv6Srv& server, isc::data::ConstElementPtr config_set);
 /// @returns a reference to the global context
 ParserContextPtr& globalContext();
 
+/// @brief Returns the cache of the subnets created by the last successful
+/// configuration.
+///
+/// @return a reference to the subnet configuration cache
+SubnetConfigCache& subnetConfigCache();
+
 }; // end of isc::dhcp namespace
 }; // end of isc namespace
 
@@ -18,6 +18,7 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcp6/ctrl_dhcp6_srv.h>
 #include <hooks/hooks_manager.h>
+#include <stats/stats_mgr.h>
 
 #include "marker_file.h"
 #include "test_libraries.h"
@@ -199,4 +200,36 @@ TEST_F(CtrlDhcpv6SrvTest, configReload) {
     CfgMgr::instance().deleteSubnets6();
 }
 
+// Check that the "statistic-get-all" command returns the statistics
+// maintained by the server and the "statistic-reset-all" resets them.
+TEST_F(CtrlDhcpv6SrvTest, statistics) {
+
+    boost::scoped_ptr<ControlledDhcpv6Srv> srv;
+    ASSERT_NO_THROW(
+        srv.reset(new ControlledDhcpv6Srv(0))
+    );
+
+    isc::stats::StatsMgr::instance().getCounter("pkt6-received").add(3);
+
+    ElementPtr params(new isc::data::MapElement());
+    int rcode = -1;
+
+    ConstElementPtr result =
+        ControlledDhcpv6Srv::processCommand("statistic-get-all", params);
+    ConstElementPtr stats = isc::config::parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(stats);
+    ASSERT_TRUE(stats->get("counters"));
+    ASSERT_TRUE(stats->get("histograms"));
+    ASSERT_TRUE(stats->get("counters")->get("pkt6-received"));
+    EXPECT_LE(3, stats->get("counters")->get("pkt6-received")->intValue());
+    EXPECT_TRUE(stats->get("histograms")->get("pkt6-pack-latency"));
+
+    result = ControlledDhcpv6Srv::processCommand("statistic-reset-all", params);
+    isc::config::parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+    EXPECT_EQ(0, isc::stats::StatsMgr::instance().
+              getCounter("pkt6-received").get());
+}
+
 } // End of anonymous namespace
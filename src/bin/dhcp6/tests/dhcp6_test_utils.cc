@@ -39,6 +39,9 @@ Dhcpv6SrvTest::Dhcpv6SrvTest()
     isc::dhcp::CfgMgr::instance().deleteSubnets6();
     isc::dhcp::CfgMgr::instance().addSubnet6(subnet_);
 
+    // Make sure that the subnets modified by other tests are not reused.
+    isc::dhcp::subnetConfigCache().clear();
+
     // configure PD pool
     pd_pool_ = isc::dhcp::Pool6Ptr
         (new isc::dhcp::Pool6(isc::dhcp::Lease::TYPE_PD,
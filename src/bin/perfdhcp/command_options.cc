@@ -116,6 +116,7 @@ CommandOptions::reset() {
     renew_rate_ = 0;
     release_rate_ = 0;
     report_delay_ = 0;
+    report_format_ = REPORT_TEXT;
     clients_num_ = 0;
     mac_template_.assign(mac, mac + 6);
     duid_template_.clear();
@@ -130,6 +131,8 @@ CommandOptions::reset() {
     is_interface_ = false;
     preload_ = 0;
     aggressivity_ = 1;
+    sender_threads_ = 0;
+    receiver_threads_ = 0;
     local_port_ = 0;
     seeded_ = false;
     seed_ = 0;
@@ -144,6 +147,7 @@ CommandOptions::reset() {
     rip_offset_ = -1;
     diags_.clear();
     wrapped_.clear();
+    scenario_file_.clear();
     server_name_.clear();
     generateDuidTemplate();
 }
@@ -212,7 +216,7 @@ CommandOptions::initialize(int argc, char** argv, bool print_cmd_line) {
     // In this section we collect argument values from command line
     // they will be tuned and validated elsewhere
     while((opt = getopt(argc, argv, "hv46r:t:R:b:n:p:d:D:l:P:a:L:"
-                        "s:iBc1T:X:O:E:S:I:x:w:e:f:F:")) != -1) {
+                        "s:iBc1T:X:O:E:S:I:x:w:e:f:F:g:G:Y:j:")) != -1) {
         stream << " -" << static_cast<char>(opt);
         if (optarg) {
             stream << " " << optarg;
@@ -314,6 +318,18 @@ CommandOptions::initialize(int argc, char** argv, bool print_cmd_line) {
                                             " positive integer");
             break;
 
+        case 'g':
+            sender_threads_ = positiveInteger("number of sender threads:"
+                                              " -g<value> must be a positive"
+                                              " integer");
+            break;
+
+        case 'G':
+            receiver_threads_ = positiveInteger("number of receiver threads:"
+                                                " -G<value> must be a positive"
+                                                " integer");
+            break;
+
         case 'h':
             usage();
             return (true);
@@ -429,6 +445,16 @@ CommandOptions::initialize(int argc, char** argv, bool print_cmd_line) {
                                       " -w<command> must be specified");
             break;
 
+        case 'j':
+            scenario_file_ = nonEmptyString("scenario file name:"
+                                            " -j<scenario-file> must be"
+                                            " specified");
+            break;
+
+        case 'Y':
+            initReportFormat();
+            break;
+
         case 'x':
             diags_ = nonEmptyString("value of diagnostics selectors:"
                                     " -x<value> must be specified");
@@ -732,13 +758,17 @@ CommandOptions::validate() const {
           "-F<release-rate> is not compatible with -i");
     check((getExchangeMode() != DO_SA) && (isRapidCommit() != 0),
           "-i must be set to use -c");
-    check((getRate() == 0) && (getReportDelay() != 0),
+    // The scenario specifies the rates of its phases.
+    check((getRate() == 0) && getScenarioFile().empty() &&
+          (getReportDelay() != 0),
           "-r<rate> must be set to use -t<report>");
-    check((getRate() == 0) && (getNumRequests().size() > 0),
+    check((getRate() == 0) && getScenarioFile().empty() &&
+          (getNumRequests().size() > 0),
           "-r<rate> must be set to use -n<num-request>");
-    check((getRate() == 0) && (getPeriod() != 0),
+    check((getRate() == 0) && getScenarioFile().empty() &&
+          (getPeriod() != 0),
           "-r<rate> must be set to use -p<test-period>");
-    check((getRate() == 0) &&
+    check((getRate() == 0) && getScenarioFile().empty() &&
           ((getMaxDrop().size() > 0) || getMaxDropPercentage().size() > 0),
           "-r<rate> must be set to use -D<max-drop>");
     check((getRate() != 0) && (getRenewRate() + getReleaseRate() > getRate()),
@@ -763,7 +793,17 @@ CommandOptions::validate() const {
     check((getTemplateFiles().size() < 2) && (getRequestedIpOffset() >= 0),
           "second/request -T<template-file> must be set to "
           "use -I<ip-offset>");
-
+    check(!getScenarioFile().empty() && (getRate() != 0),
+          "-r<rate> must not be used with -j<scenario-file>, the rates"
+          " are specified for each phase of the scenario");
+    check(!getScenarioFile().empty() && (getSenderThreads() != 0),
+          "-j<scenario-file> is not compatible with -g<sender-threads>");
+    check((getSenderThreads() == 0) && (getReceiverThreads() != 0),
+          "-g<sender-threads> must be set to use -G<receiver-threads>");
+    check((getRate() != 0) && (getSenderThreads() > getRate()),
+          "the number of sender threads specified as -g<sender-threads>"
+          " must not be greater than the exchange rate specified as"
+          " -r<rate>");
 }
 
 void
@@ -814,6 +854,21 @@ CommandOptions::initLeaseType() {
     lease_type_.fromCommandLine(lease_type_arg);
 }
 
+void
+CommandOptions::initReportFormat() {
+    std::string format = optarg;
+    if (format == "text") {
+        report_format_ = REPORT_TEXT;
+    } else if (format == "csv") {
+        report_format_ = REPORT_CSV;
+    } else if (format == "json") {
+        report_format_ = REPORT_JSON;
+    } else {
+        isc_throw(isc::InvalidParameter, "value of report format: -Y<value>"
+                  " must be one of: text, csv, json");
+    }
+}
+
 void
 CommandOptions::printCommandLine() const {
     std::cout << "IPv" << static_cast<int>(ipversion_) << std::endl;
@@ -837,6 +892,11 @@ CommandOptions::printCommandLine() const {
     if (report_delay_ != 0) {
         std::cout << "report[s]=" << report_delay_ << std::endl;
     }
+    if (report_format_ == REPORT_CSV) {
+        std::cout << "report-format=csv" << std::endl;
+    } else if (report_format_ == REPORT_JSON) {
+        std::cout << "report-format=json" << std::endl;
+    }
     if (clients_num_ != 0) {
         std::cout << "clients=" << clients_num_ << std::endl;
     }
@@ -862,6 +922,12 @@ CommandOptions::printCommandLine() const {
         std::cout << "preload=" << preload_ <<  std::endl;
     }
     std::cout << "aggressivity=" << aggressivity_ << std::endl;
+    if (sender_threads_ != 0) {
+        std::cout << "sender-threads=" << sender_threads_ << std::endl;
+        std::cout << "receiver-threads="
+                  << (receiver_threads_ != 0 ? receiver_threads_ : 1)
+                  << std::endl;
+    }
     if (getLocalPort() != 0) {
         std::cout << "local-port=" << local_port_ <<  std::endl;
     }
@@ -901,6 +967,9 @@ CommandOptions::printCommandLine() const {
     if (!wrapped_.empty()) {
         std::cout << "wrapped=" << wrapped_ << std::endl;
     }
+    if (!scenario_file_.empty()) {
+        std::cout << "scenario-file=" << scenario_file_ << std::endl;
+    }
     if (!localname_.empty()) {
         if (is_interface_) {
             std::cout << "interface=" << localname_ << std::endl;
@@ -924,7 +993,8 @@ CommandOptions::usage() const {
         "         [-c] [-1] [-T<template-file>] [-X<xid-offset>]\n"
         "         [-O<random-offset] [-E<time-offset>] [-S<srvid-offset>]\n"
         "         [-I<ip-offset>] [-x<diagnostic-selector>] [-w<wrapped>]\n"
-        "         [server]\n"
+        "         [-g<sender-threads>] [-G<receiver-threads>]\n"
+        "         [-Y<report-format>] [-j<scenario-file>] [server]\n"
         "\n"
         "The [server] argument is the name/address of the DHCP server to\n"
         "contact.  For DHCPv4 operation, exchanges are initiated by\n"
@@ -967,9 +1037,22 @@ CommandOptions::usage() const {
         "-E<time-offset>: Offset of the (DHCPv4) secs field / (DHCPv6)\n"
         "    elapsed-time option in the (second/request) template.\n"
         "    The value 0 disables it.\n"
+        "-g<sender-threads>: Run the test using the specified number of\n"
+        "    threads sending requests. Each sender thread uses its own socket,\n"
+        "    bound to the consecutive local port, and sends an equal share of\n"
+        "    the exchanges. Responses are received by the separate receiver\n"
+        "    threads. By default, a single thread sends and receives packets.\n"
+        "-G<receiver-threads>: Number of threads receiving responses when\n"
+        "    -g<sender-threads> is used. The default is 1.\n"
         "-h: Print this help.\n"
         "-i: Do only the initial part of an exchange: DO or SA, depending on\n"
         "    whether -6 is given.\n"
+        "-j<scenario-file>: Run the test in phases described in the JSON\n"
+        "    file. Each phase specifies its duration, the exchange rate or\n"
+        "    the rate curve, the number of clients, the relay addresses, the\n"
+        "    templates and, for DHCPv6, the Renew and Release rates. The\n"
+        "    statistics are reported at the end of each phase. The test\n"
+        "    finishes after the last phase. It is incompatible with -r and -g.\n"
         "-I<ip-offset>: Offset of the (DHCPv4) IP address in the requested-IP\n"
         "    option / (DHCPv6) IA_NA option in the (second/request) template.\n"
         "-l<local-addr|interface>: For DHCPv4 operation, specify the local\n"
@@ -1008,6 +1091,9 @@ CommandOptions::usage() const {
         "   * 't': when finished, print timers of all successful exchanges\n"
         "   * 'T': when finished, print templates\n"
         "-X<xid-offset>: Transaction ID (aka. xid) offset in the template.\n"
+        "-Y<report-format>: Format of the periodic and final statistics:\n"
+        "    'text' (the default), 'csv' (comma separated values with a header\n"
+        "    line) or 'json' (one object per exchange and report on each line).\n"
         "\n"
         "DHCPv4 only options:\n"
         "-B: Force broadcast handling.\n"
@@ -1040,7 +1126,9 @@ CommandOptions::usage() const {
         "    specified in the same manner as -d.  This can be used as an\n"
         "    alternative to -n, or both options can be given, in which case the\n"
         "    testing is completed when either limit is reached.\n"
-        "-t<report>: Delay in seconds between two periodic reports.\n"
+        "-t<report>: Delay in seconds between two periodic reports.  Each\n"
+        "    report includes the 50th, 95th, 99th and 99.9th percentiles of\n"
+        "    the packet delays since the previous report.\n"
         "\n"
         "Errors:\n"
         "- tooshort: received a too short message\n"
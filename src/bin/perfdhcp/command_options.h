@@ -110,6 +110,13 @@ public:
         DORA_SARR
     };
 
+    /// Format of the statistics reports (cmd line param -Y).
+    enum ReportFormat {
+        REPORT_TEXT,
+        REPORT_CSV,
+        REPORT_JSON
+    };
+
     /// CommandOptions is a singleton class. This method returns reference
     /// to its sole instance.
     ///
@@ -170,6 +177,11 @@ public:
     /// \return delay between two consecutive performance reports.
     int getReportDelay() const { return report_delay_; }
 
+    /// \brief Returns format of the statistics reports.
+    ///
+    /// \return format of the periodic and final statistics reports.
+    ReportFormat getReportFormat() const { return report_format_; }
+
     /// \brief Returns number of simulated clients.
     ///
     /// \return number of simulated clients.
@@ -247,6 +259,17 @@ public:
     /// \return aggressivity value.
     int getAggressivity() const { return aggressivity_; }
 
+    /// \brief Returns number of sender threads.
+    ///
+    /// \return number of sender threads, 0 if the test is run by
+    /// a single thread.
+    int getSenderThreads() const { return sender_threads_; }
+
+    /// \brief Returns number of receiver threads.
+    ///
+    /// \return number of receiver threads, 0 if not specified.
+    int getReceiverThreads() const { return receiver_threads_; }
+
     /// \brief Returns local port number.
     ///
     /// \return local port number.
@@ -317,6 +340,12 @@ public:
     /// \return wrapped command (start/stop).
     std::string getWrapped() const { return wrapped_; }
 
+    /// \brief Returns the name of the scenario file.
+    ///
+    /// \return name of the file describing the phases of the test or
+    /// empty string if the test is not run in phases.
+    std::string getScenarioFile() const { return scenario_file_; }
+
     /// \brief Returns server name.
     ///
     /// \return server name.
@@ -394,6 +423,12 @@ private:
     /// \throw InvalidParameter if lease type value specified is invalid.
     void initLeaseType();
 
+    /// \brief Decodes the format of the statistics reports from optarg.
+    ///
+    /// \throw InvalidParameter if the format is not "text", "csv" or
+    /// "json".
+    void initReportFormat();
+
     /// \brief Set number of clients.
     ///
     /// Interprets the getopt() "opt" global variable as the number of clients
@@ -478,6 +513,8 @@ private:
     /// Delay between generation of two consecutive
     /// performance reports
     int report_delay_;
+    /// Format of the statistics reports.
+    ReportFormat report_format_;
     /// Number of simulated clients (aka randomization range).
     uint32_t clients_num_;
     /// MAC address template used to generate unique MAC
@@ -520,6 +557,12 @@ private:
     int preload_;
     /// Number of exchanges sent before next pause.
     int aggressivity_;
+    /// Number of sender threads. Each sender thread uses its own socket
+    /// and statistics. The value of 0 means that the test is run by
+    /// a single thread.
+    int sender_threads_;
+    /// Number of threads receiving responses in the multi-threaded mode.
+    int receiver_threads_;
     /// Local port number (host endian)
     int local_port_;
     /// Randomization seed.
@@ -557,6 +600,9 @@ private:
     /// Command to be executed at the beginning/end of the test.
     /// This command is expected to expose start and stop argument.
     std::string wrapped_;
+    /// Name of the file describing the phases of the test, specified
+    /// with -j<scenario-file>.
+    std::string scenario_file_;
     /// Server name specified as last argument of command line.
     std::string server_name_;
 };
@@ -0,0 +1,133 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/// Number of buckets per power of two range above the exactly counted
+/// values.
+const unsigned int HALF_SUB_BUCKETS_NUM =
+    isc::perfdhcp::LatencyHistogram::SUB_BUCKETS_NUM / 2;
+
+}
+
+namespace isc {
+namespace perfdhcp {
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(), count_(0), min_(std::numeric_limits<uint64_t>::max()),
+      max_(0) {
+}
+
+void
+LatencyHistogram::record(const uint64_t value) {
+    const size_t index = getBucketIndex(value);
+    if (index >= counts_.size()) {
+        counts_.resize(index + 1, 0);
+    }
+    ++counts_[index];
+    ++count_;
+    if (value < min_) {
+        min_ = value;
+    }
+    if (value > max_) {
+        max_ = value;
+    }
+}
+
+void
+LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.counts_.size() > counts_.size()) {
+        counts_.resize(other.counts_.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    if (other.min_ < min_) {
+        min_ = other.min_;
+    }
+    if (other.max_ > max_) {
+        max_ = other.max_;
+    }
+}
+
+void
+LatencyHistogram::reset() {
+    counts_.clear();
+    count_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+uint64_t
+LatencyHistogram::getValueAtPercentile(const double percentile) const {
+    if (count_ == 0) {
+        isc_throw(InvalidOperation, "no values recorded");
+    }
+    if ((percentile < 0) || (percentile > 100)) {
+        isc_throw(BadValue, "invalid percentile " << percentile
+                  << ", expected value in the range of 0 to 100");
+    }
+    // Number of the lowest values which must be covered, at least one.
+    uint64_t target = static_cast<uint64_t>(std::ceil(percentile * count_ /
+                                                      100));
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t covered = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        covered += counts_[i];
+        if (covered >= target) {
+            const uint64_t value = getBucketValue(i);
+            return (value < max_ ? value : max_);
+        }
+    }
+    return (max_);
+}
+
+size_t
+LatencyHistogram::getBucketIndex(const uint64_t value) {
+    if (value < SUB_BUCKETS_NUM) {
+        return (value);
+    }
+    // Position of the most significant bit, at least SUB_BUCKET_BITS.
+    const unsigned int msb = 63 - __builtin_clzll(value);
+    // Number of the least significant bits which are not distinguished.
+    const unsigned int shift = msb - SUB_BUCKET_BITS + 1;
+    return (SUB_BUCKETS_NUM + (shift - 1) * HALF_SUB_BUCKETS_NUM +
+            ((value >> shift) - HALF_SUB_BUCKETS_NUM));
+}
+
+uint64_t
+LatencyHistogram::getBucketValue(const size_t index) {
+    if (index < SUB_BUCKETS_NUM) {
+        return (index);
+    }
+    const unsigned int shift = (index - SUB_BUCKETS_NUM) /
+        HALF_SUB_BUCKETS_NUM + 1;
+    const uint64_t sub_bucket = (index - SUB_BUCKETS_NUM) %
+        HALF_SUB_BUCKETS_NUM + HALF_SUB_BUCKETS_NUM;
+    // For the last bucket, the shift overflows to 0, which gives the
+    // highest 64-bit value.
+    return (((sub_bucket + 1) << shift) - 1);
+}
+
+} // namespace perfdhcp
+} // namespace isc
@@ -0,0 +1,139 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace perfdhcp {
+
+/// \brief Histogram of the packet delays.
+///
+/// The histogram uses log-linear buckets, similar to the HDR histogram:
+/// values lower than \ref SUB_BUCKETS_NUM are counted exactly, and each
+/// further power of two range is split into \ref SUB_BUCKETS_NUM / 2
+/// buckets of equal width. Thus, the value reported for any bucket
+/// differs from the recorded values by less than 1/64 of the value,
+/// regardless of its magnitude, while the whole range of 64-bit values
+/// takes less than 4000 buckets. Recording a value is a constant time
+/// operation which doesn't allocate memory once the bucket for the
+/// largest value has been allocated.
+///
+/// The values are unit agnostic. The Statistics Manager records the
+/// round trip times in nanoseconds.
+class LatencyHistogram {
+public:
+
+    /// \brief Number of bits of the value counted exactly.
+    static const unsigned int SUB_BUCKET_BITS = 7;
+
+    /// \brief Number of values counted exactly.
+    static const unsigned int SUB_BUCKETS_NUM = 1 << SUB_BUCKET_BITS;
+
+    /// \brief Constructor.
+    ///
+    /// Creates empty histogram.
+    LatencyHistogram();
+
+    /// \brief Records the value.
+    ///
+    /// \param value value to be recorded.
+    void record(const uint64_t value);
+
+    /// \brief Adds the values recorded in other histogram.
+    ///
+    /// \param other histogram to be accumulated.
+    void merge(const LatencyHistogram& other);
+
+    /// \brief Removes all recorded values.
+    void reset();
+
+    /// \brief Returns the number of recorded values.
+    uint64_t getCount() const {
+        return (count_);
+    }
+
+    /// \brief Returns the lowest recorded value.
+    ///
+    /// \return lowest value or 0 if the histogram is empty.
+    uint64_t getMin() const {
+        return (count_ > 0 ? min_ : 0);
+    }
+
+    /// \brief Returns the highest recorded value.
+    ///
+    /// \return highest value or 0 if the histogram is empty.
+    uint64_t getMax() const {
+        return (max_);
+    }
+
+    /// \brief Returns the value at the given percentile.
+    ///
+    /// The returned value is the highest value of the bucket holding the
+    /// value at the percentile, but not higher than \ref getMax.
+    ///
+    /// \param percentile percentile in the range of 0 to 100, e.g. 99.9.
+    /// \throw isc::InvalidOperation if the histogram is empty.
+    /// \throw isc::BadValue if the percentile is out of range.
+    /// \return value at the percentile.
+    uint64_t getValueAtPercentile(const double percentile) const;
+
+    /// \brief Returns the number of allocated buckets.
+    ///
+    /// The buckets beyond the bucket of the highest recorded value are not
+    /// allocated.
+    size_t getBucketsNum() const {
+        return (counts_.size());
+    }
+
+    /// \brief Returns the number of values in the bucket.
+    ///
+    /// \param index index of the bucket lower than \ref getBucketsNum.
+    uint64_t getBucketCount(const size_t index) const {
+        return (counts_[index]);
+    }
+
+    /// \brief Returns the index of the bucket counting the value.
+    ///
+    /// \param value value to be counted.
+    static size_t getBucketIndex(const uint64_t value);
+
+    /// \brief Returns the highest value counted by the bucket.
+    ///
+    /// \param index index of the bucket.
+    static uint64_t getBucketValue(const size_t index);
+
+private:
+
+    /// Number of values in each bucket.
+    std::vector<uint64_t> counts_;
+
+    /// Number of recorded values.
+    uint64_t count_;
+
+    /// Lowest recorded value.
+    uint64_t min_;
+
+    /// Highest recorded value.
+    uint64_t max_;
+};
+
+} // namespace perfdhcp
+} // namespace isc
+
+#endif // LATENCY_HISTOGRAM_H
@@ -118,6 +118,22 @@ public:
         return (packet);
     }
 
+    /// \brief Returns the oldest packet from the storage.
+    ///
+    /// This function returns the packet which has been appended to the
+    /// storage before all other packets. The packet is not removed from
+    /// the storage, so as the caller may check if it is to be used and
+    /// then remove it with \ref clear.
+    ///
+    /// \return oldest packet from the storage or null pointer if the
+    /// storage is empty.
+    PacketPtr peekFirst() const {
+        if (storage_.empty()) {
+            return (PacketPtr());
+        }
+        return (storage_.front());
+    }
+
     /// \brief Returns random packet from the storage.
     ///
     /// This function picks random packet from the storage and returns
@@ -0,0 +1,222 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef PREPARED_PACKET_H
+#define PREPARED_PACKET_H
+
+#include <dhcp/dhcp4.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace perfdhcp {
+
+/// \brief Packet serialized once and patched in place for each message.
+///
+/// The messages of the same type sent by perfdhcp differ only in a few
+/// fields, e.g. the DISCOVER messages differ in the transaction id, the
+/// MAC address and the relay address. Building each message from the
+/// options and packing it takes a large share of the CPU time at high
+/// rates. Instead, the packet is built and packed once, the offsets of
+/// the variable fields in its wire data are found and the fields are
+/// overwritten in the output buffer of the packet before it is sent.
+///
+/// The same packet object is sent over and over, so the fields of the
+/// packet object other than the transaction id are not updated by this
+/// class. Only its wire data are.
+///
+/// \tparam T dhcp::Pkt4 or dhcp::Pkt6 class.
+template<typename T>
+class PreparedPacket : public boost::noncopyable {
+public:
+    /// A type which represents the pointer to a packet.
+    typedef boost::shared_ptr<T> PacketPtr;
+
+    /// \brief Constructor.
+    ///
+    /// \param packet packed packet.
+    /// \throw isc::BadValue if the packet is null or it hasn't been packed.
+    explicit PreparedPacket(const PacketPtr& packet)
+        : packet_(packet) {
+        if (!packet_ || (packet_->getBuffer().getLength() == 0)) {
+            isc_throw(BadValue, "prepared packet must be packed");
+        }
+    }
+
+    /// \brief Returns the packet.
+    const PacketPtr& getPacket() const {
+        return (packet_);
+    }
+
+    /// \brief Sets the transaction id of the packet.
+    ///
+    /// \param transid new transaction id.
+    void setTransid(const uint32_t transid);
+
+    /// \brief Returns the offset of the option data in the wire data.
+    ///
+    /// Only the top level options are searched.
+    ///
+    /// \param code option code.
+    /// \param [out] length length of the option data.
+    /// \throw isc::BadValue if the option is not found.
+    /// \return offset of the first byte of the option data.
+    size_t getOptionDataOffset(const uint16_t code, size_t& length) const;
+
+    /// \brief Overwrites the wire data at the given offset.
+    ///
+    /// \param offset offset of the first byte to be overwritten.
+    /// \param data new data.
+    /// \throw isc::OutOfRange if the data don't fit in the packet.
+    void writeAt(const size_t offset, const std::vector<uint8_t>& data) {
+        checkRange(offset, data.size());
+        util::OutputBuffer& buffer = packet_->getBuffer();
+        for (size_t i = 0; i < data.size(); ++i) {
+            buffer.writeUint8At(data[i], offset + i);
+        }
+    }
+
+    /// \brief Overwrites the 16-bit value at the given offset.
+    ///
+    /// \param value new value, written in network byte order.
+    /// \param offset offset of the value.
+    /// \throw isc::OutOfRange if the value doesn't fit in the packet.
+    void writeUint16At(const uint16_t value, const size_t offset) {
+        checkRange(offset, sizeof(value));
+        packet_->getBuffer().writeUint16At(value, offset);
+    }
+
+    /// \brief Overwrites the 32-bit value at the given offset.
+    ///
+    /// \param value new value, written in network byte order.
+    /// \param offset offset of the value.
+    /// \throw isc::OutOfRange if the value doesn't fit in the packet.
+    void writeUint32At(const uint32_t value, const size_t offset) {
+        checkRange(offset, sizeof(value));
+        util::OutputBuffer& buffer = packet_->getBuffer();
+        buffer.writeUint16At(static_cast<uint16_t>(value >> 16), offset);
+        buffer.writeUint16At(static_cast<uint16_t>(value & 0xFFFF),
+                             offset + 2);
+    }
+
+private:
+
+    /// \brief Checks that the data fit in the packet.
+    ///
+    /// \param offset offset of the data.
+    /// \param length length of the data.
+    /// \throw isc::OutOfRange if the data don't fit in the packet.
+    void checkRange(const size_t offset, const size_t length) const {
+        if (offset + length > packet_->getBuffer().getLength()) {
+            isc_throw(OutOfRange, "offset " << offset << " of the "
+                      << length << " bytes is out of bounds of the "
+                      << packet_->getBuffer().getLength() << " bytes"
+                      " long packet");
+        }
+    }
+
+    /// \brief Returns the byte of the wire data.
+    uint8_t getByte(const size_t offset) const {
+        return (static_cast<const uint8_t*>(packet_->getBuffer().getData())
+                [offset]);
+    }
+
+    /// \brief Packet holding the wire data.
+    PacketPtr packet_;
+};
+
+/// \brief Sets the transaction id of the DHCPv4 packet.
+template<>
+inline void
+PreparedPacket<dhcp::Pkt4>::setTransid(const uint32_t transid) {
+    // The transaction id follows op, htype, hlen and hops.
+    writeUint32At(transid, 4);
+    packet_->setTransid(transid);
+}
+
+/// \brief Sets the transaction id of the DHCPv6 packet.
+template<>
+inline void
+PreparedPacket<dhcp::Pkt6>::setTransid(const uint32_t transid) {
+    // The 24-bit transaction id follows the message type.
+    util::OutputBuffer& buffer = packet_->getBuffer();
+    buffer.writeUint8At(static_cast<uint8_t>((transid >> 16) & 0xFF), 1);
+    buffer.writeUint16At(static_cast<uint16_t>(transid & 0xFFFF), 2);
+    packet_->setTransid(transid & 0xFFFFFF);
+}
+
+/// \brief Returns the offset of the DHCPv4 option data.
+template<>
+inline size_t
+PreparedPacket<dhcp::Pkt4>::getOptionDataOffset(const uint16_t code,
+                                                size_t& length) const {
+    const size_t size = packet_->getBuffer().getLength();
+    // The options follow the fixed header and the magic cookie.
+    size_t offset = dhcp::Pkt4::DHCPV4_PKT_HDR_LEN + 4;
+    while (offset + 2 <= size) {
+        const uint8_t option_code = getByte(offset);
+        if (option_code == dhcp::DHO_PAD) {
+            ++offset;
+            continue;
+        } else if (option_code == dhcp::DHO_END) {
+            break;
+        }
+        length = getByte(offset + 1);
+        if (option_code == code) {
+            checkRange(offset + 2, length);
+            return (offset + 2);
+        }
+        offset += 2 + length;
+    }
+    isc_throw(BadValue, "option " << code << " not found in the prepared"
+              " packet");
+}
+
+/// \brief Returns the offset of the DHCPv6 option data.
+template<>
+inline size_t
+PreparedPacket<dhcp::Pkt6>::getOptionDataOffset(const uint16_t code,
+                                                size_t& length) const {
+    const size_t size = packet_->getBuffer().getLength();
+    size_t offset = dhcp::Pkt6::DHCPV6_PKT_HDR_LEN;
+    while (offset + 4 <= size) {
+        const uint16_t option_code = (getByte(offset) << 8) +
+            getByte(offset + 1);
+        length = (getByte(offset + 2) << 8) + getByte(offset + 3);
+        if (option_code == code) {
+            checkRange(offset + 4, length);
+            return (offset + 4);
+        }
+        offset += 4 + length;
+    }
+    isc_throw(BadValue, "option " << code << " not found in the prepared"
+              " packet");
+}
+
+/// \brief Pointer to the prepared DHCPv4 packet.
+typedef boost::shared_ptr<PreparedPacket<dhcp::Pkt4> > PreparedPacket4Ptr;
+
+/// \brief Pointer to the prepared DHCPv6 packet.
+typedef boost::shared_ptr<PreparedPacket<dhcp::Pkt6> > PreparedPacket6Ptr;
+
+} // namespace perfdhcp
+} // namespace isc
+
+#endif // PREPARED_PACKET_H
@@ -0,0 +1,327 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <asiolink/io_error.h>
+#include "scenario.h"
+
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace isc::asiolink;
+using namespace isc::data;
+
+namespace {
+
+/// \brief Returns the value of the number.
+///
+/// \param element integer or real element.
+/// \param name name of the parameter used in the error message.
+/// \throw InvalidScenario if the element is not a number or it is
+/// negative.
+double
+getNumber(const ConstElementPtr& element, const std::string& name) {
+    double value = 0;
+    if (element->getType() == Element::integer) {
+        value = static_cast<double>(element->intValue());
+    } else if (element->getType() == Element::real) {
+        value = element->doubleValue();
+    } else {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " must be a number ("
+                  << element->getPosition().str() << ")");
+    }
+    if (value < 0) {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " must not be negative ("
+                  << element->getPosition().str() << ")");
+    }
+    return (value);
+}
+
+/// \brief Returns the value of the non-negative integer.
+///
+/// \param element integer element.
+/// \param name name of the parameter used in the error message.
+/// \throw InvalidScenario if the element is not an integer or it is
+/// out of range.
+int
+getInteger(const ConstElementPtr& element, const std::string& name) {
+    if (element->getType() != Element::integer) {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " must be an integer ("
+                  << element->getPosition().str() << ")");
+    }
+    const int64_t value = element->intValue();
+    if ((value < 0) || (value > std::numeric_limits<int>::max())) {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " is out of range ("
+                  << element->getPosition().str() << ")");
+    }
+    return (static_cast<int>(value));
+}
+
+/// \brief Returns the list of elements.
+///
+/// \param element list element.
+/// \param name name of the parameter used in the error message.
+/// \throw InvalidScenario if the element is not a list.
+const std::vector<ConstElementPtr>&
+getList(const ConstElementPtr& element, const std::string& name) {
+    if (element->getType() != Element::list) {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " must be a list ("
+                  << element->getPosition().str() << ")");
+    }
+    return (element->listValue());
+}
+
+/// \brief Returns the value of the string.
+///
+/// \param element string element.
+/// \param name name of the parameter used in the error message.
+/// \throw InvalidScenario if the element is not a string.
+std::string
+getString(const ConstElementPtr& element, const std::string& name) {
+    if (element->getType() != Element::string) {
+        isc_throw(isc::perfdhcp::InvalidScenario, "value of " << name
+                  << " must be a string ("
+                  << element->getPosition().str() << ")");
+    }
+    return (element->stringValue());
+}
+
+}
+
+namespace isc {
+namespace perfdhcp {
+
+ScenarioPhase::ScenarioPhase()
+    : name_(), duration_(0), rate_curve_(), clients_num_(0), relays_(),
+      template_files_(), renew_rate_(0), release_rate_(0), renew_after_(0) {
+}
+
+int
+ScenarioPhase::getRate(const double elapsed) const {
+    if (rate_curve_.empty()) {
+        return (0);
+    }
+    if (elapsed <= rate_curve_.front().first) {
+        return (rate_curve_.front().second);
+    }
+    for (size_t i = 1; i < rate_curve_.size(); ++i) {
+        const RatePoint& next = rate_curve_[i];
+        if (elapsed < next.first) {
+            const RatePoint& prev = rate_curve_[i - 1];
+            const double slope = (next.second - prev.second) /
+                (next.first - prev.first);
+            return (static_cast<int>(prev.second +
+                                     slope * (elapsed - prev.first) + 0.5));
+        }
+    }
+    return (rate_curve_.back().second);
+}
+
+Scenario::Scenario(const ConstElementPtr& config)
+    : phases_() {
+    if (!config || (config->getType() != Element::map)) {
+        isc_throw(InvalidScenario, "scenario must be a map");
+    }
+    for (std::map<std::string, ConstElementPtr>::const_iterator param =
+             config->mapValue().begin(); param != config->mapValue().end();
+         ++param) {
+        if (param->first != "phases") {
+            isc_throw(InvalidScenario, "unknown scenario parameter '"
+                      << param->first << "' ("
+                      << param->second->getPosition().str() << ")");
+        }
+    }
+    ConstElementPtr phases = config->get("phases");
+    if (!phases || getList(phases, "phases").empty()) {
+        isc_throw(InvalidScenario, "scenario must specify at least one"
+                  " phase");
+    }
+    for (size_t i = 0; i < phases->listValue().size(); ++i) {
+        phases_.push_back(parsePhase(phases->listValue()[i], i));
+    }
+}
+
+ScenarioPtr
+Scenario::fromFile(const std::string& file_name) {
+    // Comments are allowed, so as the phases can be described.
+    return (ScenarioPtr(new Scenario(Element::fromJSONFile(file_name,
+                                                           true))));
+}
+
+bool
+Scenario::hasRenews() const {
+    for (size_t i = 0; i < phases_.size(); ++i) {
+        if (phases_[i].renew_rate_ != 0) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+bool
+Scenario::hasReleases() const {
+    for (size_t i = 0; i < phases_.size(); ++i) {
+        if (phases_[i].release_rate_ != 0) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+bool
+Scenario::hasRelays() const {
+    for (size_t i = 0; i < phases_.size(); ++i) {
+        if (!phases_[i].relays_.empty()) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+ScenarioPhase
+Scenario::parsePhase(const ConstElementPtr& config, const size_t index) {
+    if (config->getType() != Element::map) {
+        isc_throw(InvalidScenario, "phase must be a map ("
+                  << config->getPosition().str() << ")");
+    }
+    ScenarioPhase phase;
+    std::ostringstream default_name;
+    default_name << "phase-" << index + 1;
+    phase.name_ = default_name.str();
+
+    bool duration_found = false;
+    bool rate_found = false;
+    const std::map<std::string, ConstElementPtr>& params = config->mapValue();
+    for (std::map<std::string, ConstElementPtr>::const_iterator param =
+             params.begin(); param != params.end(); ++param) {
+        const std::string& name = param->first;
+        const ConstElementPtr& value = param->second;
+        if (name == "name") {
+            phase.name_ = getString(value, name);
+
+        } else if (name == "duration") {
+            phase.duration_ = getNumber(value, name);
+            if (phase.duration_ == 0) {
+                isc_throw(InvalidScenario, "duration of the phase must be"
+                          " greater than 0 (" << value->getPosition().str()
+                          << ")");
+            }
+            duration_found = true;
+
+        } else if (name == "rate") {
+            if (value->getType() == Element::list) {
+                const std::vector<ConstElementPtr>& points =
+                    value->listValue();
+                for (size_t i = 0; i < points.size(); ++i) {
+                    if ((points[i]->getType() != Element::list) ||
+                        (points[i]->listValue().size() != 2)) {
+                        isc_throw(InvalidScenario, "point of the rate curve"
+                                  " must be a list of the time and the rate ("
+                                  << points[i]->getPosition().str() << ")");
+                    }
+                    ScenarioPhase::RatePoint point(
+                        getNumber(points[i]->get(0), "rate curve time"),
+                        getInteger(points[i]->get(1), "rate"));
+                    if (!phase.rate_curve_.empty() &&
+                        (point.first <= phase.rate_curve_.back().first)) {
+                        isc_throw(InvalidScenario, "points of the rate curve"
+                                  " must be ordered by time ("
+                                  << points[i]->getPosition().str() << ")");
+                    }
+                    phase.rate_curve_.push_back(point);
+                }
+                if (phase.rate_curve_.empty()) {
+                    isc_throw(InvalidScenario, "rate curve must have at"
+                              " least one point ("
+                              << value->getPosition().str() << ")");
+                }
+            } else {
+                phase.rate_curve_.push_back(ScenarioPhase::RatePoint(0,
+                    getInteger(value, name)));
+            }
+            rate_found = true;
+
+        } else if (name == "clients") {
+            phase.clients_num_ = getInteger(value, name);
+
+        } else if (name == "relays") {
+            const std::vector<ConstElementPtr>& relays = getList(value, name);
+            for (size_t i = 0; i < relays.size(); ++i) {
+                try {
+                    phase.relays_.push_back(IOAddress(getString(relays[i],
+                                                                "relay")));
+                } catch (const IOError&) {
+                    isc_throw(InvalidScenario, "relay address must be an"
+                              " IPv4 address ("
+                              << relays[i]->getPosition().str() << ")");
+                }
+                if (!phase.relays_.back().isV4()) {
+                    isc_throw(InvalidScenario, "relay address must be an"
+                              " IPv4 address ("
+                              << relays[i]->getPosition().str() << ")");
+                }
+            }
+
+        } else if (name == "templates") {
+            const std::vector<ConstElementPtr>& files = getList(value, name);
+            if (files.size() > 2) {
+                isc_throw(InvalidScenario, "at most two template files may"
+                          " be specified (" << value->getPosition().str()
+                          << ")");
+            }
+            for (size_t i = 0; i < files.size(); ++i) {
+                phase.template_files_.push_back(getString(files[i],
+                                                          "template file"));
+            }
+
+        } else if (name == "renew-rate") {
+            phase.renew_rate_ = getInteger(value, name);
+
+        } else if (name == "release-rate") {
+            phase.release_rate_ = getInteger(value, name);
+
+        } else if (name == "renew-after") {
+            phase.renew_after_ = getNumber(value, name);
+
+        } else {
+            isc_throw(InvalidScenario, "unknown phase parameter '" << name
+                      << "' (" << value->getPosition().str() << ")");
+        }
+    }
+
+    if (!duration_found) {
+        isc_throw(InvalidScenario, "duration of the phase " << phase.name_
+                  << " must be specified (" << config->getPosition().str()
+                  << ")");
+    }
+    if (!rate_found) {
+        isc_throw(InvalidScenario, "rate of the phase " << phase.name_
+                  << " must be specified (" << config->getPosition().str()
+                  << ")");
+    }
+    if ((phase.renew_after_ > 0) && (phase.renew_rate_ == 0)) {
+        isc_throw(InvalidScenario, "renew-rate of the phase " << phase.name_
+                  << " must be specified to use renew-after ("
+                  << config->getPosition().str() << ")");
+    }
+    return (phase);
+}
+
+} // namespace perfdhcp
+} // namespace isc
@@ -0,0 +1,170 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <asiolink/io_address.h>
+#include <cc/data.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace perfdhcp {
+
+/// \brief Exception thrown when the scenario is invalid.
+class InvalidScenario : public isc::Exception {
+public:
+    InvalidScenario(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// \brief Phase of the test scenario.
+///
+/// The phase describes the traffic generated by perfdhcp for the given
+/// time. The exchanges are initiated at the rate which may change within
+/// the phase, e.g. to simulate the growing load in the morning or the
+/// clients rebooting after a power outage. The rate curve is given as a
+/// list of points, each holding the time since the start of the phase
+/// and the rate at that time. The rate between the points is linearly
+/// interpolated and the rate before the first and after the last point
+/// is the rate of that point.
+struct ScenarioPhase {
+    /// \brief Point of the rate curve: the time since the start of the
+    /// phase in seconds and the rate of exchanges per second.
+    typedef std::pair<double, int> RatePoint;
+
+    /// \brief Constructor.
+    ///
+    /// Creates the phase without exchanges, lasting 0 seconds.
+    ScenarioPhase();
+
+    /// \brief Returns the rate of exchanges at the given time.
+    ///
+    /// \param elapsed time since the start of the phase in seconds.
+    /// \return number of exchanges to be initiated per second.
+    int getRate(const double elapsed) const;
+
+    /// Name of the phase used in the reports.
+    std::string name_;
+    /// Duration of the phase in seconds.
+    double duration_;
+    /// Points of the rate curve, ordered by time.
+    std::vector<RatePoint> rate_curve_;
+    /// Number of simulated clients. The value of 0 means that the number
+    /// specified with -R<range> is used.
+    uint32_t clients_num_;
+    /// Addresses of the relays (giaddr) which the DHCPv4 clients are
+    /// spread over. If empty, the address of the perfdhcp socket is used.
+    std::vector<asiolink::IOAddress> relays_;
+    /// Names of the template files. If empty, the templates specified
+    /// with -T<template-file> are used.
+    std::vector<std::string> template_files_;
+    /// Rate at which DHCPv6 Renew messages are sent.
+    int renew_rate_;
+    /// Rate at which DHCPv6 Release messages are sent.
+    int release_rate_;
+    /// Time in seconds after which the leases are renewed. The value of 0
+    /// means that random leases are renewed.
+    double renew_after_;
+};
+
+/// \brief Test scenario.
+///
+/// The scenario is a sequence of phases which are run one after another.
+/// It is read from the JSON file specified with -j<scenario-file>, e.g.:
+/// \code
+/// { "phases": [
+///     { "name": "morning", "duration": 600,
+///       "rate": [ [ 0, 100 ], [ 600, 1000 ] ],
+///       "clients": 50000,
+///       "relays": [ "192.0.2.1", "192.0.2.2" ] },
+///     { "name": "reboot-storm", "duration": 60, "rate": 5000,
+///       "clients": 50000 },
+///     { "name": "steady", "duration": 3600, "rate": 200,
+///       "templates": [ "discover.hex", "request.hex" ] }
+/// ] }
+/// \endcode
+///
+/// Each phase must specify its duration in seconds and the rate, which
+/// is either the constant rate or the list of the points of the rate
+/// curve. The rate of 0 means that no new exchanges are initiated in the
+/// phase. The remaining parameters are optional: "name", "clients",
+/// "relays", "templates" (at most two template files) and the DHCPv6
+/// specific "renew-rate", "release-rate" and "renew-after".
+class Scenario {
+public:
+
+    /// \brief Constructor.
+    ///
+    /// \param config scenario parsed from JSON.
+    /// \throw InvalidScenario if the scenario is invalid.
+    explicit Scenario(const isc::data::ConstElementPtr& config);
+
+    /// \brief Reads the scenario from the file.
+    ///
+    /// \param file_name name of the JSON file.
+    /// \throw InvalidScenario if the scenario is invalid.
+    /// \throw isc::data::JSONError if the file can't be parsed.
+    static boost::shared_ptr<Scenario>
+    fromFile(const std::string& file_name);
+
+    /// \brief Returns the number of phases.
+    size_t getPhasesNum() const {
+        return (phases_.size());
+    }
+
+    /// \brief Returns the phase.
+    ///
+    /// \param index index of the phase lower than \ref getPhasesNum.
+    const ScenarioPhase& getPhase(const size_t index) const {
+        return (phases_[index]);
+    }
+
+    /// \brief Checks if any phase sends DHCPv6 Renew messages.
+    bool hasRenews() const;
+
+    /// \brief Checks if any phase sends DHCPv6 Release messages.
+    bool hasReleases() const;
+
+    /// \brief Checks if any phase uses the relay addresses.
+    bool hasRelays() const;
+
+private:
+
+    /// \brief Parses the phase.
+    ///
+    /// \param config phase parsed from JSON.
+    /// \param index index of the phase used as its default name.
+    /// \return parsed phase.
+    static ScenarioPhase parsePhase(const isc::data::ConstElementPtr& config,
+                                    const size_t index);
+
+    /// Phases of the scenario.
+    std::vector<ScenarioPhase> phases_;
+};
+
+/// \brief Pointer to the \ref Scenario.
+typedef boost::shared_ptr<Scenario> ScenarioPtr;
+
+} // namespace perfdhcp
+} // namespace isc
+
+#endif // SCENARIO_H
@@ -15,39 +15,67 @@
 #ifndef STATS_MGR_H
 #define STATS_MGR_H
 
+#include <cc/data.h>
 #include <dhcp/pkt4.h>
 #include <dhcp/pkt6.h>
 #include <exceptions/exceptions.h>
+#include <util/monotonic_clock.h>
+#include "latency_histogram.h"
+#include "transaction_table.h"
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/global_fun.hpp>
-#include <boost/multi_index/mem_fun.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 
 namespace isc {
 namespace perfdhcp {
 
+/// \brief Percentiles of packet delays printed in the reports.
+const double REPORTED_PERCENTILES[] = { 50, 95, 99, 99.9 };
+
+/// \brief Number of percentiles printed in the reports.
+const size_t REPORTED_PERCENTILES_NUM =
+    sizeof(REPORTED_PERCENTILES) / sizeof(REPORTED_PERCENTILES[0]);
+
+/// \brief Returns textual representation of the percentile.
+///
+/// \param percentile percentile, e.g. 99.9.
+/// \return percentile without trailing zeros, e.g. "99.9".
+inline std::string
+percentileToString(const double percentile) {
+    std::ostringstream s;
+    s << percentile;
+    return (s.str());
+}
+
+/// \brief Scope of the statistics printed in CSV and JSON format.
+enum StatsScope {
+    SCOPE_INTERVAL, ///< Delays since the last intermediate report.
+    SCOPE_PHASE,    ///< Packets and delays of the current phase.
+    SCOPE_TOTAL     ///< Packets and delays since the start of the test.
+};
+
 /// \brief Statistics Manager
 ///
 /// This class template is a storage for various performance statistics
 /// collected during performance tests execution with perfdhcp tool.
 ///
-/// Statistics Manager holds lists of sent and received packets and
-/// groups them into exchanges. For example: DHCPDISCOVER message and
+/// Statistics Manager holds tables of sent packets and groups them
+/// into exchanges. For example: DHCPDISCOVER message and
 /// corresponding DHCPOFFER messages belong to one exchange, DHCPREQUEST
 /// and corresponding DHCPACK message belong to another exchange etc.
 /// In order to update statistics for a particular exchange type, client
 /// class passes sent and received packets. Internally, Statistics Manager
 /// tries to match transaction id of received packet with sent packet
-/// stored on the list of sent packets. When packets are matched the
+/// stored in the table of sent packets. When packets are matched the
 /// round trip time can be calculated.
 ///
 /// \param T class representing DHCPv4 or DHCPv6 packet.
@@ -86,7 +114,7 @@ public:
             return (this_counter);
         }
 
-        const CustomCounter& operator+=(int val) {
+        const CustomCounter& operator+=(uint64_t val) {
             counter_ += val;
             return (*this);
         }
@@ -138,125 +166,8 @@ public:
     class ExchangeStats {
     public:
 
-        /// \brief Hash transaction id of the packet.
-        ///
-        /// Function hashes transaction id of the packet. Hashing is
-        /// non-unique. Many packets may have the same hash value and thus
-        /// they belong to the same packet buckets. Packet buckets are
-        /// used for unordered packets search with multi index container.
-        ///
-        /// \param packet packet which transaction id is to be hashed.
-        /// \throw isc::BadValue if packet is null.
-        /// \return transaction id hash.
-        static uint32_t hashTransid(const boost::shared_ptr<T>& packet) {
-            if (!packet) {
-                isc_throw(BadValue, "Packet is null");
-            }
-            return(packet->getTransid() & 1023);
-        }
-
-        /// \brief List of packets (sent or received).
-        ///
-        /// List of packets based on multi index container allows efficient
-        /// search of packets based on their sequence (order in which they
-        /// were inserted) as well as based on their hashed transaction id.
-        /// The first index (sequenced) provides the way to use container
-        /// as a regular list (including iterators, removal of elements from
-        /// the middle of the collection etc.). This index is meant to be used
-        /// more frequently than the latter one and it is based on the
-        /// assumption that responses from the DHCP server are received in
-        /// order. In this case, when next packet is received it can be
-        /// matched with next packet on the list of sent packets. This
-        /// prevents intensive searches on the list of sent packets every
-        /// time new packet arrives. In many cases however packets can be
-        /// dropped by the server or may be sent out of order and we still
-        ///  want to have ability to search packets using transaction id.
-        /// The second index can be used for this purpose. This index is
-        /// hashing transaction ids using custom function \ref hashTransid.
-        /// Note that other possibility would be to simply specify index
-        /// that uses transaction id directly (instead of hashing with
-        /// \ref hashTransid). In this case however we have chosen to use
-        /// hashing function because it shortens the index size to just
-        /// 1023 values maximum. Search operation on this index generally
-        /// returns the range of packets that have the same transaction id
-        /// hash assigned but most often these ranges will be short so further
-        /// search within a range to find a packet with pacrticular transaction
-        /// id will not be intensive.
-        ///
-        /// Example 1: Add elements to the list
-        /// \code
-        /// PktList packets_collection();
-        /// boost::shared_ptr<Pkt4> pkt1(new Pkt4(...));
-        /// boost::shared_ptr<Pkt4> pkt2(new Pkt4(...));
-        /// // Add new packet to the container, it will be available through
-        /// // both indexes
-        /// packets_collection.push_back(pkt1);
-        /// // Here is another way to add packet to the container. The result
-        /// // is exactly the same as previously.
-        /// packets_collection.template get<0>().push_back(pkt2);
-        /// \endcode
-        ///
-        /// Example 2: Access elements through sequencial index
-        /// \code
-        /// PktList packets_collection();
-        /// ...  # Add elements to the container
-        /// for (PktListIterator it = packets_collection.begin();
-        ///      it != packets_collection.end();
-        ///      ++it) {
-        ///          boost::shared_ptr<Pkt4> pkt = *it;
-        ///          # Do something with packet;
-        ///      }
-        /// \endcode
-        ///
-        /// Example 3: Access elements through hashed index
-        /// \code
-        /// // Get the instance of the second search index.
-        /// PktListTransidHashIndex& idx = sent_packets_.template get<1>();
-        /// // Get the range (bucket) of packets sharing the same transaction
-        /// // id hash.
-        /// std::pair<PktListTransidHashIterator,PktListTransidHashIterator> p =
-        ///     idx.equal_range(hashTransid(rcvd_packet));
-        /// // Iterate through the returned bucket.
-        /// for (PktListTransidHashIterator it = p.first; it != p.second;
-        ///     ++it) {
-        ///    boost::shared_ptr pkt = *it;
-        ///    ... # Do something with the packet (e.g. check transaction id)
-        /// }
-        /// \endcode
-        typedef boost::multi_index_container<
-            // Container holds shared_ptr<Pkt4> or shared_ptr<Pkt6> objects.
-            boost::shared_ptr<T>,
-            // List container indexes.
-            boost::multi_index::indexed_by<
-                // Sequenced index provides the way to use this container
-                // in the same way as std::list.
-                boost::multi_index::sequenced<>,
-                // The other index keeps products of transaction id.
-                boost::multi_index::hashed_non_unique<
-                    // Specify hash function to get the product of
-                    // transaction id. This product is obtained by calling
-                    // hashTransid() function.
-                    boost::multi_index::global_fun<
-                        // Hashing function takes shared_ptr<Pkt4> or
-                        // shared_ptr<Pkt6> as argument.
-                        const boost::shared_ptr<T>&,
-                        // ... and returns uint32 value.
-                        uint32_t,
-                        // ... and here is a reference to it.
-                        &ExchangeStats::hashTransid
-                    >
-                >
-            >
-        > PktList;
-
-        /// Packet list iterator for sequencial access to elements.
-        typedef typename PktList::iterator PktListIterator;
-        /// Packet list index to search packets using transaction id hash.
-        typedef typename PktList::template nth_index<1>::type
-            PktListTransidHashIndex;
-        /// Packet list iterator to access packets using transaction id hash.
-        typedef typename PktListTransidHashIndex::const_iterator
-            PktListTransidHashIterator;
+        /// \brief Sent and received time of the archived exchange.
+        typedef std::pair<uint64_t, uint64_t> ArchivedExchange;
 
         /// \brief Constructor
         ///
@@ -264,22 +175,33 @@ public:
         /// \param drop_time maximum time elapsed before packet is
         /// assumed dropped. Negative value disables it.
         /// \param archive_enabled if true packets archive mode is enabled.
-        /// In this mode all packets are stored throughout the test execution.
-        /// \param boot_time Holds the timestamp when perfdhcp has been started.
+        /// In this mode the timestamps of all exchanges are stored
+        /// throughout the test execution.
+        /// \param boot_time Holds the monotonic time when perfdhcp has been
+        /// started.
+        /// \param max_outstanding maximum number of the packets waiting
+        /// for the response. If more packets are sent, the oldest ones are
+        /// assumed dropped.
         ExchangeStats(const ExchangeType xchg_type,
                       const double drop_time,
                       const bool archive_enabled,
-                      const boost::posix_time::ptime boot_time)
+                      const uint64_t boot_time,
+                      const size_t max_outstanding =
+                      TransactionTable::DEFAULT_MAX_CAPACITY)
             : xchg_type_(xchg_type),
-              sent_packets_(),
-              rcvd_packets_(),
-              archived_packets_(),
+              sent_packets_(max_outstanding),
+              archived_exchanges_(),
               archive_enabled_(archive_enabled),
               drop_time_(drop_time),
               min_delay_(std::numeric_limits<double>::max()),
               max_delay_(0.),
               sum_delay_(0.),
               sum_delay_squared_(0.),
+              delays_(),
+              interval_delays_(),
+              phase_delays_(),
+              phase_sent_packets_num_(0),
+              phase_rcvd_packets_num_(0),
               orphans_(0),
               collected_(0),
               unordered_lookup_size_sum_(0),
@@ -287,14 +209,15 @@ public:
               ordered_lookups_(0),
               sent_packets_num_(0),
               rcvd_packets_num_(0),
-              boot_time_(boot_time)
-        {
-            next_sent_ = sent_packets_.begin();
+              boot_time_(boot_time) {
         }
 
-        /// \brief Add new packet to list of sent packets.
+        /// \brief Add new packet to table of sent packets.
         ///
-        /// Method adds new packet to list of sent packets.
+        /// Method adds the compact record of the new packet to the table
+        /// of sent packets. The packets which have not been responded
+        /// within the drop time are removed from the table and counted
+        /// as collected.
         ///
         /// \param packet packet object to be added.
         /// \throw isc::BadValue if packet is null.
@@ -303,60 +226,47 @@ public:
                 isc_throw(BadValue, "Packet is null");
             }
             ++sent_packets_num_;
-            sent_packets_.template get<0>().push_back(packet);
-        }
-
-        /// \brief Add new packet to list of received packets.
-        ///
-        /// Method adds new packet to list of received packets.
-        ///
-        /// \param packet packet object to be added.
-        /// \throw isc::BadValue if packet is null.
-        void appendRcvd(const boost::shared_ptr<T>& packet) {
-            if (!packet) {
-                isc_throw(BadValue, "Packet is null");
-            }
-            rcvd_packets_.push_back(packet);
+            collectTimedOut();
+            collected_ += sent_packets_.insert(packet->getTransid(),
+                                               packet->getType(),
+                                               packet->getMonotonicTimestamp());
         }
 
         ///  \brief Update delay counters.
         ///
-        /// Method updates delay counters based on timestamps of
-        /// sent and received packets.
+        /// Method updates delay counters and histograms based on the
+        /// monotonic timestamps of sent and received packets.
         ///
-        /// \param sent_packet sent packet
+        /// \param sent_packet record of the sent packet
         /// \param rcvd_packet received packet
-        /// \throw isc::BadValue if sent or received packet is null.
+        /// \throw isc::BadValue if received packet is null.
         /// \throw isc::Unexpected if failed to calculate timestamps
-        void updateDelays(const boost::shared_ptr<T>& sent_packet,
+        void updateDelays(const Transaction& sent_packet,
                           const boost::shared_ptr<T>& rcvd_packet) {
-            if (!sent_packet) {
-                isc_throw(BadValue, "Sent packet is null");
-            }
             if (!rcvd_packet) {
                 isc_throw(BadValue, "Received packet is null");
             }
 
-            boost::posix_time::ptime sent_time = sent_packet->getTimestamp();
-            boost::posix_time::ptime rcvd_time = rcvd_packet->getTimestamp();
+            const uint64_t sent_time = sent_packet.timestamp_;
+            const uint64_t rcvd_time = rcvd_packet->getMonotonicTimestamp();
 
-            if (sent_time.is_not_a_date_time() ||
-                rcvd_time.is_not_a_date_time()) {
+            if ((sent_time == 0) || (rcvd_time == 0)) {
                 isc_throw(Unexpected,
                           "Timestamp must be set for sent and "
                           "received packet to measure RTT");
             }
-            boost::posix_time::time_period period(sent_time, rcvd_time);
-            // We don't bother calculating deltas in nanoseconds. It is much
-            // more convenient to use seconds instead because we are going to
-            // sum them up.
-            double delta =
-                static_cast<double>(period.length().total_nanoseconds()) / 1e9;
-
-            if (delta < 0) {
+            if (sent_time > rcvd_time) {
                 isc_throw(Unexpected, "Sent packet's timestamp must not be "
                           "greater than received packet's timestamp");
             }
+            // The histograms hold the delays in nanoseconds, but it is
+            // much more convenient to use seconds for the remaining
+            // counters because we are going to sum them up.
+            const uint64_t delta_ns = rcvd_time - sent_time;
+            delays_.record(delta_ns);
+            interval_delays_.record(delta_ns);
+            phase_delays_.record(delta_ns);
+            double delta = static_cast<double>(delta_ns) / 1e9;
 
             // Record the minimum delay between sent and received packets.
             if (delta < min_delay_) {
@@ -370,129 +280,79 @@ public:
             // mean delays.
             sum_delay_ += delta;
             sum_delay_squared_ += delta * delta;
+
+            if (archive_enabled_) {
+                archived_exchanges_.push_back(ArchivedExchange(sent_time,
+                                                               rcvd_time));
+            }
         }
 
         /// \brief Match received packet with the corresponding sent packet.
         ///
-        /// Method finds packet with specified transaction id on the list
+        /// Method finds packet with specified transaction id in the table
         /// of sent packets. It is used to match received packet with
         /// corresponding sent packet.
         /// Since packets from the server most often come in the same order
         /// as they were sent by client, this method will first check if
         /// next sent packet matches. If it doesn't, function will search
-        /// the packet using indexing by transaction id. This reduces
-        /// packet search time significantly.
+        /// the packet in the hash table indexed by the transaction id.
+        /// The matched packet is removed from the table.
         ///
         /// \param rcvd_packet received packet to be matched with sent packet.
+        /// \param [out] sent_packet record of the matched sent packet.
         /// \throw isc::BadValue if received packet is null.
-        /// \return packet having specified transaction or NULL if packet
-        /// not found
-        boost::shared_ptr<T>
-        matchPackets(const boost::shared_ptr<T>& rcvd_packet) {
-            using namespace boost::posix_time;
-
+        /// \return true if the packet has been found, false otherwise.
+        bool matchPackets(const boost::shared_ptr<T>& rcvd_packet,
+                          Transaction& sent_packet) {
             if (!rcvd_packet) {
                 isc_throw(BadValue, "Received packet is null");
             }
 
+            collectTimedOut();
             if (sent_packets_.size() == 0) {
-                // List of sent packets is empty so there is no sense
+                // Table of sent packets is empty so there is no sense
                 // to continue looking fo the packet. It also means
                 // that the received packet we got has no corresponding
                 // sent packet so orphans counter has to be updated.
                 ++orphans_;
-                return(boost::shared_ptr<T>());
-            } else if (next_sent_ == sent_packets_.end()) {
-                // Even if there are still many unmatched packets on the
-                // list we might hit the end of it because of unordered
-                // lookups. The next logical step is to reset iterator.
-                next_sent_ = sent_packets_.begin();
+                return (false);
             }
 
-            // With this variable we will be signalling success or failure
-            // to find the packet.
-            bool packet_found = false;
+            const uint32_t transid = rcvd_packet->getTransid();
             // Most likely responses are sent from the server in the same
-            // order as client's requests to the server. We are caching
-            // next sent packet and first try to match it with the next
-            // incoming packet. We are successful if there is no
+            // order as client's requests to the server, so the next sent
+            // packet is checked first. We are successful if there is no
             // packet drop or out of order packets sent. This is actually
             // the fastest way to look for packets.
-            if ((*next_sent_)->getTransid() == rcvd_packet->getTransid()) {
+            if (sent_packets_.removeNext(transid, sent_packet)) {
                 ++ordered_lookups_;
-                packet_found = true;
+
             } else {
                 // If we are here, it means that we were unable to match the
                 // next incoming packet with next sent packet so we need to
-                // take a little more expensive approach to look packets using
-                // alternative index (transaction id & 1023).
-                PktListTransidHashIndex& idx = sent_packets_.template get<1>();
-                // Packets are grouped using trasaction id masked with value
-                // of 1023. For instance, packets with transaction id equal to
-                // 1, 1024 ... will belong to the same group (a.k.a. bucket).
-                // When using alternative index we don't find the packet but
-                // bucket of packets and we need to iterate through the bucket
-                // to find the one that has desired transaction id.
-                std::pair<PktListTransidHashIterator,PktListTransidHashIterator> p =
-                    idx.equal_range(hashTransid(rcvd_packet));
-                // We want to keep statistics of unordered lookups to make
-                // sure that there is a right balance between number of
-                // unordered lookups and ordered lookups. If number of unordered
-                // lookups is high it may mean that many packets are lost or
-                // sent out of order.
+                // look it up in the hash table. We want to keep statistics
+                // of unordered lookups to make sure that there is a right
+                // balance between number of unordered lookups and ordered
+                // lookups. If number of unordered lookups is high it may
+                // mean that many packets are lost or sent out of order.
                 ++unordered_lookups_;
-                // We also want to keep the mean value of the bucket. The lower
-                // bucket size the better. If bucket sizes appear to big we
-                // might want to increase number of buckets.
-                unordered_lookup_size_sum_ += std::distance(p.first, p.second);
-                for (PktListTransidHashIterator it = p.first; it != p.second;
-                     ++it) {
-                    if ((*it)->getTransid() == rcvd_packet->getTransid()) {
-                        packet_found = true;
-                        next_sent_ =
-                            sent_packets_.template project<0>(it);
-                        break;
-                    }
-                    ptime now = microsec_clock::universal_time();
-                    ptime packet_time = (*it)->getTimestamp();
-                    time_period packet_period(packet_time, now);
-                    if (!packet_period.is_null()) {
-                        double period_fractional =
-                            packet_period.length().total_seconds() +
-                            (static_cast<double>(packet_period.length().fractional_seconds())
-                             / packet_period.length().ticks_per_second());
-                        if (drop_time_ > 0 && (period_fractional > drop_time_)) {
-                            // The packet pointed to by 'it' is timed out so we
-                            // have to remove it. Removal may invalidate the
-                            // next_sent_ pointer if it points to the packet
-                            // being removed. So, we set the next_sent_ to point
-                            // to the next packet after removed one. This
-                            // pointer will be further updated in the following
-                            // iterations, if the subsequent packets are also
-                            // timed out.
-                            next_sent_ = eraseSent(sent_packets_.template project<0>(it));
-                            ++collected_;
-                        }
-                    }
+                size_t probes = 0;
+                const bool found = sent_packets_.remove(transid, sent_packet,
+                                                        probes);
+                // We also want to keep the mean number of entries checked
+                // during the lookup. The lower the better.
+                unordered_lookup_size_sum_ += probes;
+                if (!found) {
+                    // Searched packet is not in the table.
+                    ++orphans_;
+                    return (false);
                 }
             }
 
-            if (!packet_found) {
-                // If we are here, it means that both ordered lookup and
-                // unordered lookup failed. Searched packet is not on the list.
-                ++orphans_;
-                return(boost::shared_ptr<T>());
-            }
-
             // Packet is matched so we count it. We don't count unmatched packets
             // as they are counted as orphans with a separate counter.
             ++rcvd_packets_num_;
-            boost::shared_ptr<T> sent_packet(*next_sent_);
-            // If packet was found, we assume it will be never searched
-            // again. We want to delete this packet from the list to
-            // improve performance of future searches.
-            next_sent_ = eraseSent(next_sent_);
-            return(sent_packet);
+            return (true);
         }
 
         /// \brief Return minumum delay between sent and received packet.
@@ -543,6 +403,81 @@ public:
                         getAvgDelay() * getAvgDelay()));
         }
 
+        /// \brief Return packet delay at the given percentile.
+        ///
+        /// \param percentile percentile in the range of 0 to 100.
+        /// \throw isc::InvalidOperation if no packets have been received
+        /// for this exchange.
+        /// \throw isc::BadValue if the percentile is out of range.
+        /// \return packet delay in seconds.
+        double getDelayPercentile(const double percentile) const {
+            return (static_cast<double>(delays_.getValueAtPercentile(percentile))
+                    / 1e9);
+        }
+
+        /// \brief Return histogram of packet delays.
+        ///
+        /// \return histogram of all delays in nanoseconds.
+        const LatencyHistogram& getDelays() const {
+            return (delays_);
+        }
+
+        /// \brief Return histogram of packet delays in current interval.
+        ///
+        /// The interval starts when \ref startInterval is called.
+        ///
+        /// \return histogram of delays in nanoseconds.
+        const LatencyHistogram& getIntervalDelays() const {
+            return (interval_delays_);
+        }
+
+        /// \brief Starts new interval of the delays histogram.
+        ///
+        /// Method removes the delays recorded in the current interval.
+        /// It is called after the intermediate report is printed.
+        void startInterval() {
+            interval_delays_.reset();
+        }
+
+        /// \brief Return histogram of packet delays in current phase.
+        ///
+        /// The phase starts when \ref startPhase is called.
+        ///
+        /// \return histogram of delays in nanoseconds.
+        const LatencyHistogram& getPhaseDelays() const {
+            return (phase_delays_);
+        }
+
+        /// \brief Starts new phase of the test.
+        ///
+        /// Method removes the delays recorded in the current phase and
+        /// remembers the packet counters, so as the packets of the next
+        /// phase can be counted separately.
+        void startPhase() {
+            phase_delays_.reset();
+            phase_sent_packets_num_ = sent_packets_num_;
+            phase_rcvd_packets_num_ = rcvd_packets_num_;
+        }
+
+        /// \brief Return number of packets sent in current phase.
+        uint64_t getPhaseSentPacketsNum() const {
+            return (sent_packets_num_ - phase_sent_packets_num_);
+        }
+
+        /// \brief Return number of packets received in current phase.
+        uint64_t getPhaseRcvdPacketsNum() const {
+            return (rcvd_packets_num_ - phase_rcvd_packets_num_);
+        }
+
+        /// \brief Return number of packets dropped in current phase.
+        uint64_t getPhaseDroppedPacketsNum() const {
+            uint64_t drops = 0;
+            if (getPhaseSentPacketsNum() > getPhaseRcvdPacketsNum()) {
+                drops = getPhaseSentPacketsNum() - getPhaseRcvdPacketsNum();
+            }
+            return (drops);
+        }
+
         /// \brief Return number of orphant packets.
         ///
         /// Method returns number of received packets that had no matching
@@ -628,6 +563,37 @@ public:
             return(drops);
         }
 
+        /// \brief Accumulates counters of other exchange statistics.
+        ///
+        /// Method adds the packet counters and the delay statistics of
+        /// the other object to the counters of this object. The tables of
+        /// sent packets and the archived exchanges are not merged. It is used
+        /// to sum up the statistics gathered by the sender threads.
+        ///
+        /// \param other exchange statistics to be accumulated.
+        void mergeCounters(const ExchangeStats& other) {
+            if (other.min_delay_ < min_delay_) {
+                min_delay_ = other.min_delay_;
+            }
+            if (other.max_delay_ > max_delay_) {
+                max_delay_ = other.max_delay_;
+            }
+            sum_delay_ += other.sum_delay_;
+            sum_delay_squared_ += other.sum_delay_squared_;
+            delays_.merge(other.delays_);
+            interval_delays_.merge(other.interval_delays_);
+            phase_delays_.merge(other.phase_delays_);
+            phase_sent_packets_num_ += other.phase_sent_packets_num_;
+            phase_rcvd_packets_num_ += other.phase_rcvd_packets_num_;
+            orphans_ += other.orphans_;
+            collected_ += other.collected_;
+            unordered_lookup_size_sum_ += other.unordered_lookup_size_sum_;
+            unordered_lookups_ += other.unordered_lookups_;
+            ordered_lookups_ += other.ordered_lookups_;
+            sent_packets_num_ += other.sent_packets_num_;
+            rcvd_packets_num_ += other.rcvd_packets_num_;
+        }
+
         /// \brief Print main statistics for packet exchange.
         ///
         /// Method prints main statistics for particular exchange.
@@ -654,7 +620,8 @@ public:
         /// includes minimum packet delay, maximum packet delay, average
         /// packet delay and standard deviation of delays. Packet delay
         /// is a duration between sending a packet to server and receiving
-        /// response from server.
+        /// response from server. The delays at the 50th, 95th, 99th and
+        /// 99.9th percentiles are printed too.
         void printRTTStats() const {
             using namespace std;
             try {
@@ -663,7 +630,14 @@ public:
                      << "avg delay: " << getAvgDelay() * 1e3 << " ms" << endl
                      << "max delay: " << getMaxDelay() * 1e3 << " ms" << endl
                      << "std deviation: " << getStdDevDelay() * 1e3 << " ms"
-                     << endl
+                     << endl;
+                for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+                    cout << "p" << percentileToString(REPORTED_PERCENTILES[i])
+                         << " delay: "
+                         << getDelayPercentile(REPORTED_PERCENTILES[i]) * 1e3
+                         << " ms" << endl;
+                }
+                cout
                      << "collected packets: " << getCollectedNum() << endl;
             } catch (const Exception& e) {
                 cout << "Delay summary unavailable! No packets received." << endl;
@@ -690,48 +664,24 @@ public:
             if (rcvd_packets_num_ == 0) {
                 std::cout << "Unavailable! No packets received." << std::endl;
             }
-            // We will be using boost::posix_time extensively here
             using namespace boost::posix_time;
 
-            // Iterate through all received packets.
-            for (PktListIterator it = rcvd_packets_.begin();
-                 it != rcvd_packets_.end();
-                 ++it) {
-                boost::shared_ptr<T> rcvd_packet = *it;
-                PktListTransidHashIndex& idx =
-                    archived_packets_.template get<1>();
-                std::pair<PktListTransidHashIterator,
-                          PktListTransidHashIterator> p =
-                    idx.equal_range(hashTransid(rcvd_packet));
-                for (PktListTransidHashIterator it_archived = p.first;
-                     it_archived != p.second;
-                     ++it_archived) {
-                    if ((*it_archived)->getTransid() ==
-                        rcvd_packet->getTransid()) {
-                        boost::shared_ptr<T> sent_packet = *it_archived;
-                        // Get sent and received packet times.
-                        ptime sent_time = sent_packet->getTimestamp();
-                        ptime rcvd_time = rcvd_packet->getTimestamp();
-                        // All sent and received packets should have timestamps
-                        // set but if there is a bug somewhere and packet does
-                        // not have timestamp we want to catch this here.
-                        if (sent_time.is_not_a_date_time() ||
-                            rcvd_time.is_not_a_date_time()) {
-                            isc_throw(InvalidOperation,
-                                      "packet time is not set");
-                        }
-                        // Calculate durations of packets from beginning of epoch.
-                        time_period sent_period(boot_time_, sent_time);
-                        time_period rcvd_period(boot_time_, rcvd_time);
-                        // Print timestamps for sent and received packet.
-                        std::cout << "sent / received: "
-                                  << to_iso_string(sent_period.length())
-                                  << " / "
-                                  << to_iso_string(rcvd_period.length())
-                                  << std::endl;
-                        break;
-                    }
+            for (typename std::vector<ArchivedExchange>::const_iterator it =
+                     archived_exchanges_.begin();
+                 it != archived_exchanges_.end(); ++it) {
+                // All sent and received packets should have timestamps
+                // set but if there is a bug somewhere and packet does
+                // not have timestamp we want to catch this here.
+                if ((it->first == 0) || (it->second == 0)) {
+                    isc_throw(InvalidOperation, "packet time is not set");
                 }
+                // Print timestamps for sent and received packet relative
+                // to the start of the test.
+                std::cout << "sent / received: "
+                          << to_iso_string(sinceBoot(it->first))
+                          << " / "
+                          << to_iso_string(sinceBoot(it->second))
+                          << std::endl;
             }
         }
 
@@ -743,54 +693,50 @@ public:
         /// class to specify exchange type explicitly.
         ExchangeStats();
 
-        /// \brief Erase packet from the list of sent packets.
+        /// \brief Removes the sent packets which have timed out.
         ///
-        /// Method erases packet from the list of sent packets.
+        /// The timed out packets are counted as collected.
+        void collectTimedOut() {
+            if (drop_time_ > 0) {
+                const uint64_t drop_time_ns =
+                    static_cast<uint64_t>(drop_time_ * 1e9);
+                const uint64_t now = util::getMonotonicNanos();
+                if (now > drop_time_ns) {
+                    collected_ += sent_packets_.expire(now - drop_time_ns);
+                }
+            }
+        }
+
+        /// \brief Returns the time elapsed since the start of the test.
         ///
-        /// \param it iterator pointing to packet to be erased.
-        /// \return iterator pointing to packet following erased
-        /// packet or sent_packets_.end() if packet not found.
-         PktListIterator eraseSent(const PktListIterator it) {
-             if (archive_enabled_) {
-                 // We don't want to keep list of all sent packets
-                 // because it will affect packet lookup performance.
-                 // If packet is matched with received packet we
-                 // move it to list of archived packets. List of
-                 // archived packets may be used for diagnostics
-                 // when test is completed.
-                 archived_packets_.push_back(*it);
-             }
-             // get<0>() template returns sequencial index to
-             // container.
-             return(sent_packets_.template get<0>().erase(it));
+        /// \param timestamp monotonic timestamp in nanoseconds.
+        /// \return time elapsed since the start of the test.
+        boost::posix_time::time_duration
+        sinceBoot(const uint64_t timestamp) const {
+            return (boost::posix_time::microseconds(timestamp > boot_time_ ?
+                                                    (timestamp - boot_time_)
+                                                    / 1000 : 0));
         }
 
         ExchangeType xchg_type_;             ///< Packet exchange type.
-        PktList sent_packets_;               ///< List of sent packets.
-
-        /// Iterator pointing to the packet on sent list which will most
-        /// likely match next received packet. This is based on the
-        /// assumption that server responds in order to incoming packets.
-        PktListIterator next_sent_;
 
-        PktList rcvd_packets_;         ///< List of received packets.
+        /// Table of sent packets waiting for the response.
+        TransactionTable sent_packets_;
 
-        /// List of archived packets. All sent packets that have
-        /// been matched with received packet are moved to this
-        /// list for diagnostics purposes.
-        PktList archived_packets_;
+        /// Sent and received times of all matched packets, stored only
+        /// when the archive mode is enabled.
+        std::vector<ArchivedExchange> archived_exchanges_;
 
-        /// Indicates all packets have to be preserved after matching.
-        /// By default this is disabled which means that when received
-        /// packet is matched with sent packet both are deleted. This
+        /// Indicates the timestamps of all exchanges have to be preserved
+        /// after matching. By default this is disabled which means that
+        /// when received packet is matched with sent packet both are
+        /// forgotten. This
         /// is important when test is executed for extended period of
         /// time and high memory usage might be the issue.
         /// When timestamps listing is specified from the command line
-        /// (using diagnostics selector), all packets have to be preserved
-        /// so as the printing method may read their timestamps and
-        /// print it to user. In such usage model it will be rare to
-        /// run test for extended period of time so it should be fine
-        /// to keep all packets archived throughout the test.
+        /// (using diagnostics selector), the timestamps of all exchanges
+        /// have to be preserved so as the printing method may print them
+        /// to user.
         bool archive_enabled_;
 
         /// Maxmimum time elapsed between sending and receiving packet
@@ -806,6 +752,17 @@ public:
         double sum_delay_squared_;     ///< Squared sum of delays between
                                        ///< sent and recived packets.
 
+        LatencyHistogram delays_;      ///< Histogram of all delays.
+        LatencyHistogram interval_delays_; ///< Histogram of delays since
+                                           ///< the last report.
+        LatencyHistogram phase_delays_; ///< Histogram of delays since the
+                                        ///< start of the phase.
+
+        /// Number of packets sent before the start of the phase.
+        uint64_t phase_sent_packets_num_;
+        /// Number of packets received before the start of the phase.
+        uint64_t phase_rcvd_packets_num_;
+
         uint64_t orphans_;   ///< Number of orphant received packets.
 
         uint64_t collected_; ///< Number of garbage collected packets.
@@ -824,7 +781,7 @@ public:
 
         uint64_t sent_packets_num_;    ///< Total number of sent packets.
         uint64_t rcvd_packets_num_;    ///< Total number of received packets.
-        boost::posix_time::ptime boot_time_; ///< Time when test is started.
+        uint64_t boot_time_; ///< Monotonic time when test is started.
     };
 
     /// Pointer to ExchangeStats.
@@ -841,20 +798,21 @@ public:
     /// \brief Constructor.
     ///
     /// This constructor by default disables packets archiving mode.
-    /// In this mode all packets from the list of sent packets are
-    /// moved to list of archived packets once they have been matched
-    /// with received packets. This is required if it has been selected
-    /// from the command line to print timestamps for all packets after
-    /// the test. If this is not selected archiving should be disabled
-    /// for performance reasons and to avoid waste of memory for storing
-    /// large list of archived packets.
+    /// In this mode the timestamps of the sent and received packets are
+    /// archived once the packets have been matched. This is required if
+    /// it has been selected from the command line to print timestamps
+    /// for all packets after the test. If this is not selected archiving
+    /// should be disabled to avoid waste of memory for storing large
+    /// list of archived timestamps.
     ///
     /// \param archive_enabled true indicates that packets
     /// archive mode is enabled.
     StatsMgr(const bool archive_enabled = false) :
         exchanges_(),
         archive_enabled_(archive_enabled),
-        boot_time_(boost::posix_time::microsec_clock::universal_time()) {
+        boot_time_(boost::posix_time::microsec_clock::universal_time()),
+        monotonic_boot_time_(util::getMonotonicNanos()),
+        phase_name_() {
     }
 
     /// \brief Specify new exchange type.
@@ -876,7 +834,7 @@ public:
             ExchangeStatsPtr(new ExchangeStats(xchg_type,
                                                drop_time,
                                                archive_enabled_,
-                                               boot_time_));
+                                               monotonic_boot_time_));
     }
 
     /// \brief Check if the exchange type has been specified.
@@ -954,11 +912,11 @@ public:
         return (*counter);
     }
 
-    /// \brief Adds new packet to the sent packets list.
+    /// \brief Adds new packet to the sent packets table.
     ///
-    /// Method adds new packet to the sent packets list.
-    /// Packets are added to the list sequentially and
-    /// most often read sequentially.
+    /// Method adds the record of the new packet to the sent packets
+    /// table. Packets are added to the table sequentially and most
+    /// often matched sequentially.
     ///
     /// \param xchg_type exchange type.
     /// \param packet packet to be added to the list
@@ -972,31 +930,30 @@ public:
 
     /// \brief Add new received packet and match with sent packet.
     ///
-    /// Method adds new packet to the list of received packets. It
-    /// also searches for corresponding packet on the list of sent
+    /// Method searches for corresponding packet in the table of sent
     /// packets. When packets are matched the statistics counters
     /// are updated accordingly for the particular exchange type.
     ///
     /// \param xchg_type exchange type.
     /// \param packet received packet
+    /// \param [out] sent_time if not null, the monotonic timestamp of
+    /// the matched sent packet is stored there.
     /// \throw isc::BadValue if invalid exchange type specified
     /// or packet is null.
-    /// \throw isc::Unexpected if corresponding packet was not
-    /// found on the list of sent packets.
-    boost::shared_ptr<T>
-    passRcvdPacket(const ExchangeType xchg_type,
-                   const boost::shared_ptr<T>& packet) {
+    /// \return true if the packet has been matched with sent packet.
+    bool passRcvdPacket(const ExchangeType xchg_type,
+                        const boost::shared_ptr<T>& packet,
+                        uint64_t* sent_time = NULL) {
         ExchangeStatsPtr xchg_stats = getExchangeStats(xchg_type);
-        boost::shared_ptr<T> sent_packet
-            = xchg_stats->matchPackets(packet);
-
-        if (sent_packet) {
-            xchg_stats->updateDelays(sent_packet, packet);
-            if (archive_enabled_) {
-                xchg_stats->appendRcvd(packet);
-            }
+        Transaction sent_packet;
+        if (!xchg_stats->matchPackets(packet, sent_packet)) {
+            return (false);
+        }
+        xchg_stats->updateDelays(sent_packet, packet);
+        if (sent_time != NULL) {
+            *sent_time = sent_packet.timestamp_;
         }
-        return(sent_packet);
+        return (true);
     }
 
     /// \brief Return minumum delay between sent and received packet.
@@ -1047,6 +1004,24 @@ public:
         return(xchg_stats->getStdDevDelay());
     }
 
+    /// \brief Return packet delay at the given percentile.
+    ///
+    /// Method returns the packet delay at the given percentile for
+    /// specified exchange type, e.g. 99 gives the delay not exceeded
+    /// by 99% of the received packets.
+    ///
+    /// \param xchg_type exchange type.
+    /// \param percentile percentile in the range of 0 to 100.
+    /// \throw isc::BadValue if invalid exchange type or percentile
+    /// specified.
+    /// \throw isc::InvalidOperation if no packets have been received.
+    /// \return packet delay in seconds.
+    double getDelayPercentile(const ExchangeType xchg_type,
+                              const double percentile) const {
+        ExchangeStatsPtr xchg_stats = getExchangeStats(xchg_type);
+        return(xchg_stats->getDelayPercentile(percentile));
+    }
+
     /// \brief Return number of orphant packets.
     ///
     /// Method returns number of orphant packets for specified
@@ -1144,6 +1119,34 @@ public:
         return(xchg_stats->getDroppedPacketsNum());
     }
 
+    /// \brief Return number of packets sent in current phase.
+    ///
+    /// \param xchg_type exchange type.
+    /// \throw isc::BadValue if invalid exchange type specified.
+    /// \return number of packets sent since \ref startPhase was called.
+    uint64_t getPhaseSentPacketsNum(const ExchangeType xchg_type) const {
+        return (getExchangeStats(xchg_type)->getPhaseSentPacketsNum());
+    }
+
+    /// \brief Return number of packets received in current phase.
+    ///
+    /// \param xchg_type exchange type.
+    /// \throw isc::BadValue if invalid exchange type specified.
+    /// \return number of packets received since \ref startPhase was
+    /// called.
+    uint64_t getPhaseRcvdPacketsNum(const ExchangeType xchg_type) const {
+        return (getExchangeStats(xchg_type)->getPhaseRcvdPacketsNum());
+    }
+
+    /// \brief Return number of packets dropped in current phase.
+    ///
+    /// \param xchg_type exchange type.
+    /// \throw isc::BadValue if invalid exchange type specified.
+    /// \return number of packets dropped since \ref startPhase was called.
+    uint64_t getPhaseDroppedPacketsNum(const ExchangeType xchg_type) const {
+        return (getExchangeStats(xchg_type)->getPhaseDroppedPacketsNum());
+    }
+
     /// \brief Return number of garbage collected packets.
     ///
     /// Method returns number of garbage collected timed out
@@ -1174,6 +1177,36 @@ public:
         return test_period;
     }
 
+    /// \brief Accumulates counters of other Statistics Manager.
+    ///
+    /// Method adds the counters of all exchanges and the custom counters
+    /// of the other Statistics Manager to the counters of this object.
+    /// Custom counters which don't exist in this object are added. The
+    /// start of the test is the earlier of the two. The packets held by
+    /// the other object are not merged, so the timestamps of packets can't
+    /// be printed from the merged statistics.
+    ///
+    /// \param other Statistics Manager to be accumulated.
+    /// \throw isc::BadValue if the exchange tracked by the other
+    /// Statistics Manager is not tracked by this object.
+    void merge(const StatsMgr& other) {
+        for (ExchangesMapIterator it = other.exchanges_.begin();
+             it != other.exchanges_.end(); ++it) {
+            getExchangeStats(it->first)->mergeCounters(*it->second);
+        }
+        for (CustomCountersMapIterator it = other.custom_counters_.begin();
+             it != other.custom_counters_.end(); ++it) {
+            if (custom_counters_.find(it->first) == custom_counters_.end()) {
+                addCustomCounter(it->first, it->second->getName());
+            }
+            incrementCounter(it->first, it->second->getValue());
+        }
+        if (other.boot_time_ < boot_time_) {
+            boot_time_ = other.boot_time_;
+            monotonic_boot_time_ = other.monotonic_boot_time_;
+        }
+    }
+
     /// \brief Return name of the exchange.
     ///
     /// Method returns name of the specified exchange type.
@@ -1235,11 +1268,15 @@ public:
     ///
     /// Method prints intermediate statistics for all exchanges.
     /// Statistics includes sent, received and dropped packets
-    /// counters.
+    /// counters and the percentiles of the packet delays in the
+    /// current interval (see \ref startInterval). The percentiles of
+    /// exchanges without packets received in the interval are printed
+    /// as "-".
     void printIntermediateStats() const {
         std::ostringstream stream_sent;
         std::ostringstream stream_rcvd;
         std::ostringstream stream_drops;
+        std::vector<std::string> delays(REPORTED_PERCENTILES_NUM);
         std::string sep("");
         for (ExchangesMapIterator it = exchanges_.begin();
              it != exchanges_.end(); ++it) {
@@ -1250,11 +1287,225 @@ public:
             stream_sent << sep << it->second->getSentPacketsNum();
             stream_rcvd << sep << it->second->getRcvdPacketsNum();
             stream_drops << sep << it->second->getDroppedPacketsNum();
+            const LatencyHistogram& interval_delays =
+                it->second->getIntervalDelays();
+            for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+                delays[i] += sep;
+                if (interval_delays.getCount() == 0) {
+                    delays[i] += "-";
+                } else {
+                    delays[i] += delayToString(interval_delays.
+                        getValueAtPercentile(REPORTED_PERCENTILES[i]));
+                }
+            }
         }
         std::cout << "sent: " << stream_sent.str()
                   << "; received: " << stream_rcvd.str()
-                  << "; drops: " << stream_drops.str()
+                  << "; drops: " << stream_drops.str();
+        for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+            std::cout << "; p" << percentileToString(REPORTED_PERCENTILES[i])
+                      << ": " << delays[i] << " ms";
+        }
+        std::cout << std::endl;
+    }
+
+    /// \brief Starts new interval of the delay statistics.
+    ///
+    /// Method removes the packet delays recorded for the intermediate
+    /// report in all exchanges. It is called after the intermediate
+    /// report is printed.
+    void startInterval() {
+        for (ExchangesMapIterator it = exchanges_.begin();
+             it != exchanges_.end(); ++it) {
+            it->second->startInterval();
+        }
+    }
+
+    /// \brief Starts new phase of the test.
+    ///
+    /// Method starts counting the packets and delays of the new phase
+    /// in all exchanges. The phase statistics are printed with
+    /// \ref printPhaseStats or with the \ref SCOPE_PHASE scope.
+    ///
+    /// \param name name of the phase.
+    void startPhase(const std::string& name) {
+        phase_name_ = name;
+        for (ExchangesMapIterator it = exchanges_.begin();
+             it != exchanges_.end(); ++it) {
+            it->second->startPhase();
+        }
+    }
+
+    /// \brief Return name of the current phase.
+    ///
+    /// \return name of the phase or empty string if the test is not
+    /// run in phases.
+    const std::string& getPhaseName() const {
+        return (phase_name_);
+    }
+
+    /// \brief Print statistics of the current phase.
+    ///
+    /// Method prints the sent, received and dropped packets counters
+    /// and the minimum, percentiles and maximum of the packet delays
+    /// in the current phase for all exchanges.
+    void printPhaseStats() const {
+        std::cout << "***Statistics for phase: " << phase_name_ << "***"
                   << std::endl;
+        for (ExchangesMapIterator it = exchanges_.begin();
+             it != exchanges_.end(); ++it) {
+            const LatencyHistogram& delays = it->second->getPhaseDelays();
+            std::cout << exchangeToString(it->first) << ": sent: "
+                      << it->second->getPhaseSentPacketsNum()
+                      << "; received: "
+                      << it->second->getPhaseRcvdPacketsNum()
+                      << "; drops: "
+                      << it->second->getPhaseDroppedPacketsNum();
+            if (delays.getCount() > 0) {
+                std::cout << "; min: " << delayToString(delays.getMin());
+                for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+                    std::cout << "; p"
+                              << percentileToString(REPORTED_PERCENTILES[i])
+                              << ": "
+                              << delayToString(delays.getValueAtPercentile(
+                                                   REPORTED_PERCENTILES[i]));
+                }
+                std::cout << "; max: " << delayToString(delays.getMax())
+                          << " ms";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    /// \brief Print the header of statistics in CSV format.
+    ///
+    /// The header names the columns of the rows printed by
+    /// \ref printCsvStats.
+    static void printCsvHeader() {
+        std::cout << "time,type,phase,exchange,sent,received,drops,min";
+        for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+            std::cout << ",p" << percentileToString(REPORTED_PERCENTILES[i]);
+        }
+        std::cout << ",max" << std::endl;
+    }
+
+    /// \brief Print statistics in CSV format.
+    ///
+    /// Method prints one row for each exchange, holding the time since
+    /// the start of the test in seconds, the scope of the row ("interval",
+    /// "phase" or "total"), the name of the current phase, quoted if it
+    /// holds a comma, a double quote or a line break, the name of the
+    /// exchange, the sent, received and dropped packets counters and
+    /// the minimum, percentiles and maximum of the packet delays in
+    /// milliseconds. The delays are left empty if no packets have been
+    /// received. The packet counters of the phase rows only count the
+    /// packets of the phase, the other rows count all packets.
+    ///
+    /// \param scope scope of the printed statistics.
+    void printCsvStats(const StatsScope scope) const {
+        const double time = getTestTime();
+        const std::string phase = csvField(phase_name_);
+        const std::ios_base::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        for (ExchangesMapIterator it = exchanges_.begin();
+             it != exchanges_.end(); ++it) {
+            const LatencyHistogram& delays = getScopeDelays(*it->second,
+                                                            scope);
+            std::cout << std::fixed << std::setprecision(3) << time << ","
+                      << scopeToString(scope) << "," << phase << ","
+                      << exchangeToString(it->first) << ","
+                      << getScopeSentPacketsNum(*it->second, scope) << ","
+                      << getScopeRcvdPacketsNum(*it->second, scope) << ","
+                      << getScopeDroppedPacketsNum(*it->second, scope)
+                      << ",";
+            if (delays.getCount() > 0) {
+                std::cout << delayToString(delays.getMin());
+            }
+            for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+                std::cout << ",";
+                if (delays.getCount() > 0) {
+                    std::cout << delayToString(delays.getValueAtPercentile(
+                                                   REPORTED_PERCENTILES[i]));
+                }
+            }
+            std::cout << ",";
+            if (delays.getCount() > 0) {
+                std::cout << delayToString(delays.getMax());
+            }
+            std::cout << std::endl;
+        }
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+
+    /// \brief Print statistics in JSON format.
+    ///
+    /// Method prints one JSON object per line for each exchange. The
+    /// objects hold the same values as the rows printed by
+    /// \ref printCsvStats, with the delays in the "delay" map, which is
+    /// null if no packets have been received. The statistics of the
+    /// phase and since the start of the test also hold the "histogram"
+    /// list of the upper bounds of the non-empty histogram buckets in
+    /// milliseconds and the numbers of delays counted by them.
+    ///
+    /// \param scope scope of the printed statistics.
+    void printJsonStats(const StatsScope scope) const {
+        const double time = getTestTime();
+        // The phase name comes from the scenario file and may hold any
+        // character.
+        const std::string phase = isc::data::Element::create(phase_name_)->
+            str();
+        const std::ios_base::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        for (ExchangesMapIterator it = exchanges_.begin();
+             it != exchanges_.end(); ++it) {
+            const LatencyHistogram& delays = getScopeDelays(*it->second,
+                                                            scope);
+            std::cout << std::fixed << std::setprecision(3)
+                      << "{ \"time\": " << time
+                      << ", \"type\": \"" << scopeToString(scope)
+                      << "\", \"phase\": " << phase
+                      << ", \"exchange\": \"" << exchangeToString(it->first)
+                      << "\", \"sent\": "
+                      << getScopeSentPacketsNum(*it->second, scope)
+                      << ", \"received\": "
+                      << getScopeRcvdPacketsNum(*it->second, scope)
+                      << ", \"drops\": "
+                      << getScopeDroppedPacketsNum(*it->second, scope)
+                      << ", \"delay\": ";
+            if (delays.getCount() == 0) {
+                std::cout << "null";
+            } else {
+                std::cout << "{ \"min\": " << delayToString(delays.getMin());
+                for (size_t i = 0; i < REPORTED_PERCENTILES_NUM; ++i) {
+                    std::cout << ", \"p"
+                              << percentileToString(REPORTED_PERCENTILES[i])
+                              << "\": "
+                              << delayToString(delays.getValueAtPercentile(
+                                                   REPORTED_PERCENTILES[i]));
+                }
+                std::cout << ", \"max\": " << delayToString(delays.getMax())
+                          << " }";
+            }
+            if (scope != SCOPE_INTERVAL) {
+                std::cout << ", \"histogram\": [ ";
+                std::string sep("");
+                for (size_t i = 0; i < delays.getBucketsNum(); ++i) {
+                    if (delays.getBucketCount(i) > 0) {
+                        std::cout << sep << "[ "
+                                  << delayToString(LatencyHistogram::
+                                                   getBucketValue(i))
+                                  << ", " << delays.getBucketCount(i) << " ]";
+                        sep = ", ";
+                    }
+                }
+                std::cout << " ]";
+            }
+            std::cout << " }" << std::endl;
+        }
+        std::cout.flags(flags);
+        std::cout.precision(precision);
     }
 
     /// \brief Print timestamps of all packets.
@@ -1306,6 +1557,95 @@ public:
 
 private:
 
+    /// \brief Converts delay to milliseconds.
+    ///
+    /// \param delay delay in nanoseconds.
+    /// \return delay in milliseconds with microsecond precision.
+    static std::string delayToString(const uint64_t delay) {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3)
+          << static_cast<double>(delay) / 1e6;
+        return (s.str());
+    }
+
+    /// \brief Quotes the value of a CSV field if needed.
+    ///
+    /// \param value value of the field.
+    /// \return the value, enclosed in double quotes with the double quotes
+    /// it holds doubled if it holds a comma, a double quote or a line
+    /// break.
+    static std::string csvField(const std::string& value) {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            return (value);
+        }
+        std::string field("\"");
+        for (std::string::const_iterator c = value.begin(); c != value.end();
+             ++c) {
+            if (*c == '"') {
+                field += '"';
+            }
+            field += *c;
+        }
+        field += '"';
+        return (field);
+    }
+
+    /// \brief Returns the name of the statistics scope.
+    static const char* scopeToString(const StatsScope scope) {
+        switch (scope) {
+        case SCOPE_INTERVAL:
+            return ("interval");
+        case SCOPE_PHASE:
+            return ("phase");
+        default:
+            return ("total");
+        }
+    }
+
+    /// \brief Returns the histogram of delays in the scope.
+    static const LatencyHistogram&
+    getScopeDelays(const ExchangeStats& xchg_stats, const StatsScope scope) {
+        switch (scope) {
+        case SCOPE_INTERVAL:
+            return (xchg_stats.getIntervalDelays());
+        case SCOPE_PHASE:
+            return (xchg_stats.getPhaseDelays());
+        default:
+            return (xchg_stats.getDelays());
+        }
+    }
+
+    /// \brief Returns the number of sent packets in the scope.
+    static uint64_t
+    getScopeSentPacketsNum(const ExchangeStats& xchg_stats,
+                           const StatsScope scope) {
+        return (scope == SCOPE_PHASE ? xchg_stats.getPhaseSentPacketsNum() :
+                xchg_stats.getSentPacketsNum());
+    }
+
+    /// \brief Returns the number of received packets in the scope.
+    static uint64_t
+    getScopeRcvdPacketsNum(const ExchangeStats& xchg_stats,
+                           const StatsScope scope) {
+        return (scope == SCOPE_PHASE ? xchg_stats.getPhaseRcvdPacketsNum() :
+                xchg_stats.getRcvdPacketsNum());
+    }
+
+    /// \brief Returns the number of dropped packets in the scope.
+    static uint64_t
+    getScopeDroppedPacketsNum(const ExchangeStats& xchg_stats,
+                              const StatsScope scope) {
+        return (scope == SCOPE_PHASE ?
+                xchg_stats.getPhaseDroppedPacketsNum() :
+                xchg_stats.getDroppedPacketsNum());
+    }
+
+    /// \brief Returns the time since the start of the test in seconds.
+    double getTestTime() const {
+        return (static_cast<double>(getTestPeriod().length().
+                                    total_microseconds()) / 1e6);
+    }
+
     /// \brief Return exchange stats object for given exchange type
     ///
     /// Method returns exchange stats object for given exchange type.
@@ -1325,9 +1665,8 @@ private:
     ExchangesMap exchanges_;            ///< Map of exchange types.
     CustomCountersMap custom_counters_; ///< Map with custom counters.
 
-    /// Indicates that packets from list of sent packets should be
-    /// archived (moved to list of archived packets) once they are
-    /// matched with received packets. This is required when it has
+    /// Indicates that timestamps of the sent and received packets
+    /// should be archived once they are matched. This is required when it has
     /// been selected from the command line to print packets'
     /// timestamps after test. This may affect performance and
     /// consume large amount of memory when the test is running
@@ -1336,6 +1675,8 @@ private:
     bool archive_enabled_;
 
     boost::posix_time::ptime boot_time_; ///< Time when test is started.
+    uint64_t monotonic_boot_time_; ///< Monotonic time when test is started.
+    std::string phase_name_;             ///< Name of the current phase.
 };
 
 } // namespace perfdhcp
@@ -20,7 +20,9 @@
 #include <dhcp/dhcp4.h>
 #include <dhcp/option6_ia.h>
 #include <util/unittests/check_valgrind.h>
+#include <util/threads/thread.h>
 #include "test_control.h"
+#include "test_shard.h"
 #include "command_options.h"
 #include "perf_pkt4.h"
 #include "perf_pkt6.h"
@@ -33,6 +35,7 @@
 #include <signal.h>
 #include <sys/wait.h>
 
+#include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 using namespace std;
@@ -40,6 +43,67 @@ using namespace boost::posix_time;
 using namespace isc;
 using namespace isc::dhcp;
 using namespace isc::asiolink;
+using namespace isc::util::thread;
+
+namespace {
+
+/// Interval between the checks of the exit conditions in microseconds
+/// when the test is run by multiple threads.
+const useconds_t STATS_MERGE_INTERVAL = 1000;
+
+/// Offset of the relay agent address (giaddr) in the DHCPv4 packet.
+const size_t DHCPV4_GIADDR_OFFSET = 24;
+
+/// Offset of the client hardware address (chaddr) in the DHCPv4 packet.
+const size_t DHCPV4_CHADDR_OFFSET = 28;
+
+/// Offset of the seconds elapsed (secs) in the DHCPv4 packet.
+const size_t DHCPV4_SECS_OFFSET = 8;
+
+/// \brief Accumulates statistics of all sender threads.
+///
+/// \param shards sender threads' parts of the test.
+/// \param stats_mgr Statistics Manager accumulating the counters.
+/// \param start_interval if true, the shards start new interval of the
+/// delay statistics after they are merged.
+template<typename StatsMgrType>
+void
+mergeShardStats(const isc::perfdhcp::TestShardCollection& shards,
+                StatsMgrType& stats_mgr, const bool start_interval = false) {
+    for (isc::perfdhcp::TestShardCollection::const_iterator shard =
+             shards.begin(); shard != shards.end(); ++shard) {
+        (*shard)->mergeStats(stats_mgr, start_interval);
+    }
+}
+
+/// \brief Prints statistics in the format specified with -Y<report-format>.
+///
+/// \param stats_mgr Statistics Manager holding the statistics.
+/// \param scope scope of the statistics: the intermediate report, the
+/// statistics of the finished phase or the final statistics.
+template<typename StatsMgrType>
+void
+printStatsReport(const StatsMgrType& stats_mgr,
+                 const isc::perfdhcp::StatsScope scope) {
+    switch (isc::perfdhcp::CommandOptions::instance().getReportFormat()) {
+    case isc::perfdhcp::CommandOptions::REPORT_CSV:
+        stats_mgr.printCsvStats(scope);
+        break;
+    case isc::perfdhcp::CommandOptions::REPORT_JSON:
+        stats_mgr.printJsonStats(scope);
+        break;
+    default:
+        if (scope == isc::perfdhcp::SCOPE_INTERVAL) {
+            stats_mgr.printIntermediateStats();
+        } else if (scope == isc::perfdhcp::SCOPE_PHASE) {
+            stats_mgr.printPhaseStats();
+        } else {
+            stats_mgr.printStats();
+        }
+    }
+}
+
+}
 
 namespace isc {
 namespace perfdhcp {
@@ -114,18 +178,16 @@ TestControl::checkLateMessages(RateControl& rate_control) {
 
 void
 TestControl::cleanCachedPackets() {
-    CommandOptions& options = CommandOptions::instance();
     // When Renews are not sent, Reply packets are not cached so there
-    // is nothing to do.
-    if (options.getRenewRate() == 0) {
+    // is nothing to do. When the leases are renewed after the specified
+    // time, all of them have to be kept.
+    const int renew_rate = renew_rate_control_.getRate();
+    if ((renew_rate == 0) || (renew_after_ > 0)) {
         return;
     }
 
-    static boost::posix_time::ptime last_clean =
-        microsec_clock::universal_time();
-
     // Check how much time has passed since last cleanup.
-    time_period time_since_clean(last_clean,
+    time_period time_since_clean(last_clean_,
                                  microsec_clock::universal_time());
     // Cleanup every 1 second.
     if (time_since_clean.length().total_seconds() >= 1) {
@@ -134,13 +196,12 @@ TestControl::cleanCachedPackets() {
         // since we want to randomize leases to be renewed so leave 5
         // times more packets to randomize from.
         // @todo The cache size might be controlled from the command line.
-        if (reply_storage_.size() > 5 * options.getRenewRate()) {
-            reply_storage_.clear(reply_storage_.size() -
-                                 5 * options.getRenewRate());
+        if (reply_storage_.size() > 5 * renew_rate) {
+            reply_storage_.clear(reply_storage_.size() - 5 * renew_rate);
         }
         // Remember when we performed a cleanup for the last time.
         // We want to do the next cleanup not earlier than in one second.
-        last_clean = microsec_clock::universal_time();
+        last_clean_ = microsec_clock::universal_time();
     }
 }
 
@@ -464,7 +525,7 @@ TestControl::factoryRequestList4(Option::Universe u,
 std::vector<uint8_t>
 TestControl::generateMacAddress(uint8_t& randomized) const {
     CommandOptions& options = CommandOptions::instance();
-    uint32_t clients_num = options.getClientsNum();
+    uint32_t clients_num = getClientsNum();
     if (clients_num < 2) {
         return (options.getMacTemplate());
     }
@@ -499,7 +560,7 @@ TestControl::generateMacAddress(uint8_t& randomized) const {
 std::vector<uint8_t>
 TestControl::generateDuid(uint8_t& randomized) const {
     CommandOptions& options = CommandOptions::instance();
-    uint32_t clients_num = options.getClientsNum();
+    uint32_t clients_num = getClientsNum();
     if ((clients_num == 0) || (clients_num == 1)) {
         return (options.getDuidTemplate());
     }
@@ -515,13 +576,13 @@ TestControl::generateDuid(uint8_t& randomized) const {
 
 uint32_t
 TestControl::getCurrentTimeout() const {
-    CommandOptions& options = CommandOptions::instance();
     ptime now(microsec_clock::universal_time());
     // Check that we haven't passed the moment to send the next set of
     // packets.
     if (now >= basic_rate_control_.getDue() ||
-        (options.getRenewRate() != 0 && now >= renew_rate_control_.getDue()) ||
-        (options.getReleaseRate() != 0 &&
+        (renew_rate_control_.getRate() != 0 &&
+         now >= renew_rate_control_.getDue()) ||
+        (release_rate_control_.getRate() != 0 &&
          now >= release_rate_control_.getDue())) {
         return (0);
     }
@@ -530,12 +591,13 @@ TestControl::getCurrentTimeout() const {
     ptime due = basic_rate_control_.getDue();
     // If we are sending Renews and due time for Renew occurs sooner,
     // set the due time to Renew due time.
-    if ((options.getRenewRate()) != 0 && (renew_rate_control_.getDue() < due)) {
+    if ((renew_rate_control_.getRate() != 0) &&
+        (renew_rate_control_.getDue() < due)) {
         due = renew_rate_control_.getDue();
     }
     // If we are sending Releases and the due time for Release occurs
     // sooner than the current due time, let's use the due for Releases.
-    if ((options.getReleaseRate() != 0) &&
+    if ((release_rate_control_.getRate() != 0) &&
         (release_rate_control_.getDue() < due)) {
         due = release_rate_control_.getDue();
     }
@@ -543,6 +605,28 @@ TestControl::getCurrentTimeout() const {
     return (time_period(now, due).length().total_microseconds());
 }
 
+uint32_t
+TestControl::getClientsNum() const {
+    if (phase_clients_num_ != 0) {
+        return (phase_clients_num_);
+    }
+    return (CommandOptions::instance().getClientsNum());
+}
+
+IOAddress
+TestControl::getRelayAddress(const TestControlSocket& socket,
+                             const std::vector<uint8_t>& mac_address) const {
+    if (relays_.empty()) {
+        return (IOAddress(socket.addr_));
+    }
+    uint32_t hash = 0;
+    for (std::vector<uint8_t>::const_iterator it = mac_address.begin();
+         it != mac_address.end(); ++it) {
+        hash = hash * 31 + *it;
+    }
+    return (relays_[hash % relays_.size()]);
+}
+
 int
 TestControl::getElapsedTimeOffset() const {
     int elp_offset = CommandOptions::instance().getIpVersion() == 4 ?
@@ -553,19 +637,12 @@ TestControl::getElapsedTimeOffset() const {
     return (elp_offset);
 }
 
-template<class T>
 uint32_t
-TestControl::getElapsedTime(const T& pkt1, const T& pkt2) {
-    using namespace boost::posix_time;
-    ptime pkt1_time = pkt1->getTimestamp();
-    ptime pkt2_time = pkt2->getTimestamp();
-    if (pkt1_time.is_not_a_date_time() ||
-        pkt2_time.is_not_a_date_time()) {
+TestControl::getElapsedTime(const uint64_t time1, const uint64_t time2) {
+    if ((time1 == 0) || (time2 == 0)) {
         isc_throw(InvalidOperation, "packet timestamp not set");;
     }
-    time_period elapsed_period(pkt1_time, pkt2_time);
-    return (elapsed_period.is_null() ? 0 :
-            elapsed_period.length().total_milliseconds());
+    return (time2 > time1 ? (time2 - time1) / 1000000 : 0);
 }
 
 int
@@ -651,11 +728,15 @@ TestControl::handleInterrupt(int) {
 
 void
 TestControl::initPacketTemplates() {
+    initPacketTemplates(CommandOptions::instance().getTemplateFiles());
+}
+
+void
+TestControl::initPacketTemplates(const std::vector<std::string>&
+                                 template_files) {
     template_packets_v4_.clear();
     template_packets_v6_.clear();
     template_buffers_.clear();
-    CommandOptions& options = CommandOptions::instance();
-    std::vector<std::string> template_files = options.getTemplateFiles();
     for (std::vector<std::string>::const_iterator it = template_files.begin();
          it != template_files.end(); ++it) {
         readPacketTemplate(*it);
@@ -688,10 +769,12 @@ TestControl::initializeStatsMgr() {
             stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RR,
                                           options.getDropTime()[1]);
         }
-        if (options.getRenewRate() != 0) {
+        if ((options.getRenewRate() != 0) ||
+            (scenario_ && scenario_->hasRenews())) {
             stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RN);
         }
-        if (options.getReleaseRate() != 0) {
+        if ((options.getReleaseRate() != 0) ||
+            (scenario_ && scenario_->hasReleases())) {
             stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RL);
         }
     }
@@ -710,8 +793,38 @@ TestControl::initializeStatsMgr() {
     }
 }
 
+void
+TestControl::loadScenario() {
+    CommandOptions& options = CommandOptions::instance();
+    scenario_ = Scenario::fromFile(options.getScenarioFile());
+    for (size_t i = 0; i < scenario_->getPhasesNum(); ++i) {
+        const ScenarioPhase& phase = scenario_->getPhase(i);
+        if ((options.getIpVersion() != 6) &&
+            ((phase.renew_rate_ != 0) || (phase.release_rate_ != 0))) {
+            isc_throw(InvalidScenario, "renew-rate and release-rate of the"
+                      " phase " << phase.name_ << " may be used with -6"
+                      " (IPv6) only");
+        }
+        if ((options.getExchangeMode() == CommandOptions::DO_SA) &&
+            ((phase.renew_rate_ != 0) || (phase.release_rate_ != 0))) {
+            isc_throw(InvalidScenario, "renew-rate and release-rate of the"
+                      " phase " << phase.name_ << " are not compatible"
+                      " with -i");
+        }
+        if ((options.getIpVersion() != 4) && !phase.relays_.empty()) {
+            isc_throw(InvalidScenario, "relays of the phase " << phase.name_
+                      << " may be used with -4 (IPv4) only");
+        }
+        if ((options.getExchangeMode() == CommandOptions::DO_SA) &&
+            (phase.template_files_.size() > 1)) {
+            isc_throw(InvalidScenario, "second template of the phase "
+                      << phase.name_ << " is not compatible with -i");
+        }
+    }
+}
+
 int
-TestControl::openSocket() const {
+TestControl::openSocket(const uint16_t port_offset) const {
     CommandOptions& options = CommandOptions::instance();
     std::string localname = options.getLocalName();
     std::string servername = options.getServerName();
@@ -736,6 +849,7 @@ TestControl::openSocket() const {
             port = 67; //  TODO: find out why port 68 is wrong here.
         }
     }
+    port += port_offset;
 
     // Local name is specified along with '-l' option.
     // It may point to interface name or local address.
@@ -964,32 +1078,58 @@ TestControl::printRate() const {
     }
 }
 
+bool
+TestControl::isReportDue() const {
+    int delay = CommandOptions::instance().getReportDelay();
+    time_period time_since_report(last_report_,
+                                  microsec_clock::universal_time());
+    return (time_since_report.length().total_seconds() >= delay);
+}
+
 void
 TestControl::printIntermediateStats() {
-    CommandOptions& options = CommandOptions::instance();
-    int delay = options.getReportDelay();
-    ptime now = microsec_clock::universal_time();
-    time_period time_since_report(last_report_, now);
-    if (time_since_report.length().total_seconds() >= delay) {
+    if (isReportDue()) {
+        CommandOptions& options = CommandOptions::instance();
         if (options.getIpVersion() == 4) {
-            stats_mgr4_->printIntermediateStats();
+            printStatsReport(*stats_mgr4_, SCOPE_INTERVAL);
+            stats_mgr4_->startInterval();
         } else if (options.getIpVersion() == 6) {
-            stats_mgr6_->printIntermediateStats();
+            printStatsReport(*stats_mgr6_, SCOPE_INTERVAL);
+            stats_mgr6_->startInterval();
         }
-        last_report_ = now;
+        last_report_ = microsec_clock::universal_time();
+    }
+}
+
+void
+TestControl::printPhaseStats() const {
+    if (CommandOptions::instance().getIpVersion() == 4) {
+        printStatsReport(*stats_mgr4_, SCOPE_PHASE);
+    } else {
+        printStatsReport(*stats_mgr6_, SCOPE_PHASE);
+    }
+}
+
+void
+TestControl::printReportHeader() const {
+    if (CommandOptions::instance().getReportFormat() ==
+        CommandOptions::REPORT_CSV) {
+        StatsMgr<>::printCsvHeader();
     }
 }
 
 void
 TestControl::printStats() const {
-    printRate();
     CommandOptions& options = CommandOptions::instance();
+    if (options.getReportFormat() == CommandOptions::REPORT_TEXT) {
+        printRate();
+    }
     if (options.getIpVersion() == 4) {
         if (!stats_mgr4_) {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv4 "
                       "hasn't been initialized");
         }
-        stats_mgr4_->printStats();
+        printStatsReport(*stats_mgr4_, SCOPE_TOTAL);
         if (testDiags('i')) {
             stats_mgr4_->printCustomCounters();
         }
@@ -998,7 +1138,7 @@ TestControl::printStats() const {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv6 "
                       "hasn't been initialized");
         }
-        stats_mgr6_->printStats();
+        printStatsReport(*stats_mgr6_, SCOPE_TOTAL);
         if (testDiags('i')) {
             stats_mgr6_->printCustomCounters();
         }
@@ -1073,17 +1213,19 @@ void
 TestControl::processReceivedPacket4(const TestControlSocket& socket,
                             const Pkt4Ptr& pkt4) {
     if (pkt4->getType() == DHCPOFFER) {
-        Pkt4Ptr discover_pkt4(stats_mgr4_->passRcvdPacket(StatsMgr4::XCHG_DO,
-                                                          pkt4));
+        uint64_t discover_time = 0;
+        const bool matched = stats_mgr4_->passRcvdPacket(StatsMgr4::XCHG_DO,
+                                                         pkt4, &discover_time);
         CommandOptions::ExchangeMode xchg_mode =
             CommandOptions::instance().getExchangeMode();
-        if ((xchg_mode == CommandOptions::DORA_SARR) && discover_pkt4) {
+        if ((xchg_mode == CommandOptions::DORA_SARR) && matched) {
             if (template_buffers_.size() < 2) {
-                sendRequest4(socket, discover_pkt4, pkt4);
+                sendRequest4(socket, discover_time, pkt4);
             } else {
                 // @todo add defines for packet type index that can be
                 // used to access template_buffers_.
-                sendRequest4(socket, template_buffers_[1], discover_pkt4, pkt4);
+                sendRequest4(socket, template_buffers_[1], discover_time,
+                             pkt4);
             }
         }
     } else if (pkt4->getType() == DHCPACK) {
@@ -1096,11 +1238,11 @@ TestControl::processReceivedPacket6(const TestControlSocket& socket,
                             const Pkt6Ptr& pkt6) {
     uint8_t packet_type = pkt6->getType();
     if (packet_type == DHCPV6_ADVERTISE) {
-        Pkt6Ptr solicit_pkt6(stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_SA,
-                                                         pkt6));
+        const bool matched = stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_SA,
+                                                         pkt6);
         CommandOptions::ExchangeMode xchg_mode =
             CommandOptions::instance().getExchangeMode();
-        if ((xchg_mode == CommandOptions::DORA_SARR) && solicit_pkt6) {
+        if ((xchg_mode == CommandOptions::DORA_SARR) && matched) {
             // \todo check whether received ADVERTISE packet is sane.
             // We might want to check if STATUS_CODE option is non-zero
             // and if there is IAADR option in IA_NA.
@@ -1134,12 +1276,18 @@ TestControl::processReceivedPacket6(const TestControlSocket& socket,
         // sent within the 4-way exchange. It may be a response to the Renew
         // or Release message. In the if clause we first check if StatsMgr
         // has exchange type for Renew specified, and if it has, if there is
-        // a corresponding Renew message for the received Reply. If not,
-        // we check that StatsMgr has exchange type for Release specified,
-        // as possibly the Reply has been sent in response to Release.
-        } else if (!(stats_mgr6_->hasExchangeStats(StatsMgr6::XCHG_RN) &&
-                     stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_RN, pkt6)) &&
-                   stats_mgr6_->hasExchangeStats(StatsMgr6::XCHG_RL)) {
+        // a corresponding Renew message for the received Reply.
+        } else if (stats_mgr6_->hasExchangeStats(StatsMgr6::XCHG_RN) &&
+                   stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_RN, pkt6)) {
+            // If the leases are renewed after the specified time, the
+            // renewed lease is stored so as it is renewed again later.
+            if (renew_after_ > 0) {
+                reply_storage_.append(pkt6);
+            }
+        // If not, we check that StatsMgr has exchange type for Release
+        // specified, as possibly the Reply has been sent in response to
+        // Release.
+        } else if (stats_mgr6_->hasExchangeStats(StatsMgr6::XCHG_RL)) {
             // At this point, it is only possible that the Reply has been sent
             // in response to a Release. Try to match the Reply with Release.
             stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_RL, pkt6);
@@ -1286,11 +1434,21 @@ TestControl::reset() {
 
     transid_gen_.reset();
     last_report_ = microsec_clock::universal_time();
+    last_clean_ = last_report_;
     // Actual generators will have to be set later on because we need to
     // get command line parameters first.
     setTransidGenerator(NumberGeneratorPtr());
     setMacAddrGenerator(NumberGeneratorPtr());
     first_packet_serverid_.clear();
+    prepared_discover4_.reset();
+    prepared_request4_.reset();
+    prepared_solicit6_.reset();
+    scenario_.reset();
+    phase_index_ = 0;
+    phase_start_ = 0;
+    phase_clients_num_ = 0;
+    relays_.clear();
+    renew_after_ = 0;
     interrupted_ = false;
 }
 
@@ -1321,12 +1479,6 @@ TestControl::run() {
     printDiagnostics();
     // Option factories have to be registered.
     registerOptionFactories();
-    TestControlSocket socket(openSocket());
-    if (!socket.valid_) {
-        isc_throw(Unexpected, "invalid socket descriptor");
-    }
-    // Initialize packet templates.
-    initPacketTemplates();
     // Initialize randomization seed.
     if (options.isSeeded()) {
         srandom(options.getSeed());
@@ -1340,6 +1492,23 @@ TestControl::run() {
     // If user interrupts the program we will exit gracefully.
     signal(SIGINT, TestControl::handleInterrupt);
 
+    // Read the scenario before anything is sent to catch its errors.
+    if (!options.getScenarioFile().empty()) {
+        loadScenario();
+    }
+
+    // The sender threads use their own sockets and generators.
+    if (options.getSenderThreads() > 0) {
+        return (runMultiThreaded());
+    }
+
+    TestControlSocket socket(openSocket());
+    if (!socket.valid_) {
+        isc_throw(Unexpected, "invalid socket descriptor");
+    }
+    // Initialize packet templates.
+    initPacketTemplates();
+
     // Preload server with the number of packets.
     sendPackets(socket, options.getPreload(), true);
 
@@ -1350,7 +1519,18 @@ TestControl::run() {
 
     // Initialize Statistics Manager. Release previous if any.
     initializeStatsMgr();
+    printReportHeader();
+    if (scenario_) {
+        phase_start_ = isc::util::getMonotonicNanos();
+        startPhase(socket, 0);
+    }
     for (;;) {
+        // Switch to the next phase of the scenario and follow its rate
+        // curve. The test is over after the last phase.
+        if (scenario_ && !updatePhase(socket)) {
+            break;
+        }
+
         // Calculate number of packets to be sent to stay
         // catch up with rate.
         uint64_t packets_due = basic_rate_control_.getOutboundMessageCount();
@@ -1374,12 +1554,16 @@ TestControl::run() {
             break;
         }
 
-        // Initiate new DHCP packet exchanges.
-        sendPackets(socket, packets_due);
+        // Initiate new DHCP packet exchanges. The phase of the scenario
+        // with the rate of 0 doesn't initiate any.
+        if (!scenario_ || (basic_rate_control_.getRate() != 0)) {
+            sendPackets(socket, packets_due);
+        }
 
         // If -f<renew-rate> option was specified we have to check how many
         // Renew packets should be sent to catch up with a desired rate.
-        if ((options.getIpVersion() == 6) && (options.getRenewRate() != 0)) {
+        if ((options.getIpVersion() == 6) &&
+            (renew_rate_control_.getRate() != 0)) {
             uint64_t renew_packets_due =
                 renew_rate_control_.getOutboundMessageCount();
             checkLateMessages(renew_rate_control_);
@@ -1389,7 +1573,8 @@ TestControl::run() {
 
         // If -F<release-rate> option was specified we have to check how many
         // Release messages should be sent to catch up with a desired rate.
-        if ((options.getIpVersion() == 6) && (options.getReleaseRate() != 0)) {
+        if ((options.getIpVersion() == 6) &&
+            (release_rate_control_.getRate() != 0)) {
             uint64_t release_packets_due =
                 release_rate_control_.getOutboundMessageCount();
             checkLateMessages(release_rate_control_);
@@ -1411,6 +1596,10 @@ TestControl::run() {
         // searches in the long list of Reply packets increases CPU utilization.
         cleanCachedPackets();
     }
+    // The last phase may have been cut short by the exit conditions.
+    if (scenario_) {
+        printPhaseStats();
+    }
     printStats();
 
     if (!options.getWrapped().empty()) {
@@ -1452,6 +1641,168 @@ TestControl::run() {
     return (ret_code);
 }
 
+int
+TestControl::runMultiThreaded() {
+    CommandOptions& options = CommandOptions::instance();
+    // The definitions of the standard options are created when they are
+    // used for the first time. Create them now, so as the receiver threads
+    // don't race to do it.
+    LibDHCP::getOptionDefs(options.getIpVersion() == 4 ? Option::V4 :
+                           Option::V6);
+
+    const unsigned int shards_num = options.getSenderThreads();
+    const unsigned int receivers_num = options.getReceiverThreads() == 0 ?
+        1 : options.getReceiverThreads();
+    TestShardCollection shards;
+    for (unsigned int i = 0; i < shards_num; ++i) {
+        shards.push_back(TestShardPtr(new TestShard(i, shards_num)));
+    }
+
+    // Preload server with the number of packets.
+    shards[0]->preload(options.getPreload());
+
+    // Fork and run command specified with -w<wrapped-command>
+    if (!options.getWrapped().empty()) {
+        runWrapped();
+    }
+
+    for (TestShardCollection::const_iterator shard = shards.begin();
+         shard != shards.end(); ++shard) {
+        (*shard)->initializeStats();
+    }
+
+    // The flag is set by this thread to stop other threads or by
+    // a thread which has failed.
+    volatile bool stopping = false;
+    std::vector<boost::shared_ptr<Thread> > threads;
+    try {
+        for (unsigned int i = 0; i < receivers_num; ++i) {
+            threads.push_back(boost::shared_ptr<Thread>
+                              (new Thread(boost::bind(&TestShard::runReceiver,
+                                                      boost::cref(shards),
+                                                      &stopping))));
+        }
+        for (TestShardCollection::const_iterator shard = shards.begin();
+             shard != shards.end(); ++shard) {
+            threads.push_back(boost::shared_ptr<Thread>
+                              (new Thread(boost::bind(&TestShard::runSender,
+                                                      *shard, &stopping))));
+        }
+    } catch (...) {
+        stopping = true;
+        for (size_t i = 0; i < threads.size(); ++i) {
+            try {
+                threads[i]->wait();
+            } catch (const Exception&) {
+                // The error of starting the thread is reported.
+            }
+        }
+        throw;
+    }
+
+    // Periodically gather statistics of the sender threads to check if
+    // the test is finished and to print intermediate reports.
+    printReportHeader();
+    while (!stopping) {
+        usleep(STATS_MERGE_INTERVAL);
+        // The shards start new interval of the delay statistics when they
+        // are merged for the intermediate report, so as no delays are
+        // missed between the reports.
+        const bool report_due = (options.getReportDelay() > 0) &&
+            isReportDue();
+        initializeStatsMgr();
+        if (options.getIpVersion() == 4) {
+            mergeShardStats(shards, *stats_mgr4_, report_due);
+        } else {
+            mergeShardStats(shards, *stats_mgr6_, report_due);
+        }
+        if (checkExitConditions()) {
+            break;
+        }
+        if (report_due) {
+            printIntermediateStats();
+        }
+    }
+
+    // Stop all threads and report the first error, if any.
+    stopping = true;
+    std::string error;
+    for (size_t i = 0; i < threads.size(); ++i) {
+        try {
+            threads[i]->wait();
+        } catch (const Exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(Unexpected, "test thread failed: " << error);
+    }
+
+    // The threads are stopped so the final statistics are gathered.
+    initializeStatsMgr();
+    if (options.getIpVersion() == 4) {
+        mergeShardStats(shards, *stats_mgr4_);
+    } else {
+        mergeShardStats(shards, *stats_mgr6_);
+    }
+    printStats();
+
+    uint64_t malformed = 0;
+    for (TestShardCollection::const_iterator shard = shards.begin();
+         shard != shards.end(); ++shard) {
+        malformed += (*shard)->getMalformedNum();
+    }
+    if (malformed > 0) {
+        std::cout << "Malformed packets: " << malformed << std::endl;
+    }
+
+    if (!options.getWrapped().empty()) {
+        // true means that we execute wrapped command with 'stop' argument.
+        runWrapped(true);
+    }
+
+    // Print packet timestamps gathered by each sender thread.
+    if (testDiags('t')) {
+        for (TestShardCollection::const_iterator shard = shards.begin();
+             shard != shards.end(); ++shard) {
+            std::cout << "***Sender thread " << (*shard)->getIndex()
+                      << "***" << std::endl;
+            if (options.getIpVersion() == 4) {
+                (*shard)->stats_mgr4_->printTimestamps();
+            } else if (options.getIpVersion() == 6) {
+                (*shard)->stats_mgr6_->printTimestamps();
+            }
+        }
+    }
+
+    // Print server id.
+    if (testDiags('s') && (shards[0]->first_packet_serverid_.size() > 0)) {
+        std::cout << "Server id: "
+                  << vector2Hex(shards[0]->first_packet_serverid_)
+                  << std::endl;
+    }
+
+    // Diagnostics flag 'e' means show exit reason.
+    if (testDiags('e')) {
+        std::cout << "Interrupted" << std::endl;
+    }
+    // Print packet templates sent by the first sender thread.
+    if (testDiags('T')) {
+        shards[0]->printTemplates();
+    }
+
+    int ret_code = 0;
+    // Check if any packet drops occured.
+    if (options.getIpVersion() == 4) {
+        ret_code = stats_mgr4_->droppedPackets() ? 3 : 0;
+    } else if (options.getIpVersion() == 6)  {
+        ret_code = stats_mgr6_->droppedPackets() ? 3 : 0;
+    }
+    return (ret_code);
+}
+
 void
 TestControl::runWrapped(bool do_stop /*= false */) const {
     CommandOptions& options = CommandOptions::instance();
@@ -1487,6 +1838,27 @@ TestControl::saveFirstPacket(const Pkt6Ptr& pkt) {
     }
 }
 
+template<typename T>
+bool
+TestControl::canUsePrepared(const boost::shared_ptr<PreparedPacket<T> >& prepared,
+                            const TestControlSocket& socket) const {
+    // The packets printed with the 'T' diagnostics flag must not be
+    // modified after they have been sent.
+    return (prepared && (prepared->getPacket()->getIndex() == socket.ifindex_)
+            && !testDiags('T'));
+}
+
+template<typename T>
+void
+TestControl::prepare(boost::shared_ptr<PreparedPacket<T> >& prepared,
+                     const boost::shared_ptr<T>& pkt) {
+    if (testDiags('T')) {
+        prepared.reset();
+    } else {
+        prepared.reset(new PreparedPacket<T>(pkt));
+    }
+}
+
 void
 TestControl::sendDiscover4(const TestControlSocket& socket,
                            const bool preload /*= false*/) {
@@ -1496,31 +1868,44 @@ TestControl::sendDiscover4(const TestControlSocket& socket,
     std::vector<uint8_t> mac_address = generateMacAddress(randomized);
     // Generate trasnaction id to be set for the new exchange.
     const uint32_t transid = generateTransid();
-    Pkt4Ptr pkt4(new Pkt4(DHCPDISCOVER, transid));
-    if (!pkt4) {
-        isc_throw(Unexpected, "failed to create DISCOVER packet");
-    }
+    Pkt4Ptr pkt4;
+    if (canUsePrepared(prepared_discover4_, socket) &&
+        (prepared_discover4_->getPacket()->getHlen() == mac_address.size())) {
+        // The DISCOVER messages differ only in the transaction id, the
+        // hardware address and the relay address.
+        prepared_discover4_->setTransid(transid);
+        prepared_discover4_->writeAt(DHCPV4_CHADDR_OFFSET, mac_address);
+        prepared_discover4_->writeUint32At(static_cast<uint32_t>(
+            getRelayAddress(socket, mac_address)), DHCPV4_GIADDR_OFFSET);
+        pkt4 = prepared_discover4_->getPacket();
+
+    } else {
+        pkt4.reset(new Pkt4(DHCPDISCOVER, transid));
 
-    // Delete the default Message Type option set by Pkt4
-    pkt4->delOption(DHO_DHCP_MESSAGE_TYPE);
+        // Delete the default Message Type option set by Pkt4
+        pkt4->delOption(DHO_DHCP_MESSAGE_TYPE);
 
-    // Set options: DHCP_MESSAGE_TYPE and DHCP_PARAMETER_REQUEST_LIST
-    OptionBuffer buf_msg_type;
-    buf_msg_type.push_back(DHCPDISCOVER);
-    pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_MESSAGE_TYPE,
-                                    buf_msg_type));
-    pkt4->addOption(Option::factory(Option::V4,
-                                    DHO_DHCP_PARAMETER_REQUEST_LIST));
+        // Set options: DHCP_MESSAGE_TYPE and DHCP_PARAMETER_REQUEST_LIST
+        OptionBuffer buf_msg_type;
+        buf_msg_type.push_back(DHCPDISCOVER);
+        pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_MESSAGE_TYPE,
+                                        buf_msg_type));
+        pkt4->addOption(Option::factory(Option::V4,
+                                        DHO_DHCP_PARAMETER_REQUEST_LIST));
 
-    // Set client's and server's ports as well as server's address,
-    // and local (relay) address.
-    setDefaults4(socket, pkt4);
+        // Set client's and server's ports as well as server's address,
+        // and local (relay) address.
+        setDefaults4(socket, pkt4);
 
-    // Set hardware address
-    pkt4->setHWAddr(HTYPE_ETHER, mac_address.size(), mac_address);
+        // Set hardware address
+        pkt4->setHWAddr(HTYPE_ETHER, mac_address.size(), mac_address);
+        // Set the relay address the client is behind.
+        pkt4->setGiaddr(getRelayAddress(socket, mac_address));
 
-    pkt4->pack();
-    IfaceMgr::instance().send(pkt4);
+        pkt4->pack();
+        prepare(prepared_discover4_, pkt4);
+    }
+    sendPacket(socket, pkt4);
     if (!preload) {
         if (!stats_mgr4_) {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv4 "
@@ -1565,12 +1950,17 @@ TestControl::sendDiscover4(const TestControlSocket& socket,
 
     // Replace MAC address in the template with actual MAC address.
     pkt4->writeAt(rand_offset, mac_address.begin(), mac_address.end());
+    // Replace the relay address in the template if the relays are used.
+    if (!relays_.empty()) {
+        pkt4->writeValueAt<uint32_t>(DHCPV4_GIADDR_OFFSET,
+            static_cast<uint32_t>(getRelayAddress(socket, mac_address)));
+    }
     // Create a packet from the temporary buffer.
     setDefaults4(socket, boost::static_pointer_cast<Pkt4>(pkt4));
     // Pack the input packet buffer to output buffer so as it can
     // be sent to server.
     pkt4->rawPack();
-    IfaceMgr::instance().send(boost::static_pointer_cast<Pkt4>(pkt4));
+    sendPacket(socket, boost::static_pointer_cast<Pkt4>(pkt4));
     if (!preload) {
         if (!stats_mgr4_) {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv4 "
@@ -1597,7 +1987,20 @@ TestControl::sendMessageFromReply(const uint16_t msg_type,
     } else {
         release_rate_control_.updateSendTime();
     }
-    Pkt6Ptr reply = reply_storage_.getRandom();
+    Pkt6Ptr reply;
+    if ((msg_type == DHCPV6_RENEW) && (renew_after_ > 0)) {
+        // The leases are renewed in the order they have been acquired,
+        // when they are old enough.
+        reply = reply_storage_.peekFirst();
+        if (!reply || (isc::util::getMonotonicNanos() -
+                       reply->getMonotonicTimestamp() <
+                       static_cast<uint64_t>(renew_after_ * 1e9))) {
+            return (false);
+        }
+        reply_storage_.clear(1);
+    } else {
+        reply = reply_storage_.getRandom();
+    }
     if (!reply) {
         return (false);
     }
@@ -1606,7 +2009,7 @@ TestControl::sendMessageFromReply(const uint16_t msg_type,
     setDefaults6(socket, msg);
     msg->pack();
     // And send it.
-    IfaceMgr::instance().send(msg);
+    sendPacket(socket, msg);
     if (!stats_mgr6_) {
         isc_throw(Unexpected, "Statistics Manager for DHCPv6 "
                   "hasn't been initialized");
@@ -1618,17 +2021,16 @@ TestControl::sendMessageFromReply(const uint16_t msg_type,
 
 void
 TestControl::sendRequest4(const TestControlSocket& socket,
-                          const dhcp::Pkt4Ptr& discover_pkt4,
+                          const uint64_t discover_time,
                           const dhcp::Pkt4Ptr& offer_pkt4) {
     const uint32_t transid = generateTransid();
-    Pkt4Ptr pkt4(new Pkt4(DHCPREQUEST, transid));
 
     // Use first flags indicates that we want to use the server
     // id captured in first packet.
+    OptionBuffer serverid;
     if (CommandOptions::instance().isUseFirst() &&
         (first_packet_serverid_.size() > 0)) {
-        pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_SERVER_IDENTIFIER,
-                                        first_packet_serverid_));
+        serverid = first_packet_serverid_;
     } else {
         OptionPtr opt_serverid =
             offer_pkt4->getOption(DHO_DHCP_SERVER_IDENTIFIER);
@@ -1636,10 +2038,10 @@ TestControl::sendRequest4(const TestControlSocket& socket,
             isc_throw(BadValue, "there is no SERVER_IDENTIFIER option "
                       << "in OFFER message");
         }
+        serverid = opt_serverid->getData();
         if (stats_mgr4_->getRcvdPacketsNum(StatsMgr4::XCHG_DO) == 1) {
-            first_packet_serverid_ = opt_serverid->getData();
+            first_packet_serverid_ = serverid;
         }
-        pkt4->addOption(opt_serverid);
     }
 
     /// Set client address.
@@ -1648,26 +2050,66 @@ TestControl::sendRequest4(const TestControlSocket& socket,
         isc_throw(BadValue, "the YIADDR returned in OFFER packet is not "
                   " IPv4 address");
     }
-    OptionPtr opt_requested_address =
-        OptionPtr(new Option(Option::V4, DHO_DHCP_REQUESTED_ADDRESS,
-                             OptionBuffer()));
-    opt_requested_address->setUint32(static_cast<uint32_t>(yiaddr));
-    pkt4->addOption(opt_requested_address);
-    OptionPtr opt_parameter_list =
-        Option::factory(Option::V4, DHO_DHCP_PARAMETER_REQUEST_LIST);
-    pkt4->addOption(opt_parameter_list);
-    // Set client's and server's ports as well as server's address,
-    // and local (relay) address.
-    setDefaults4(socket, pkt4);
-
-    // Set hardware address
-    pkt4->setHWAddr(offer_pkt4->getHWAddr());
+    const HWAddrPtr& hwaddr = offer_pkt4->getHWAddr();
+    // Use the same relay as for the DISCOVER.
+    const IOAddress giaddr = getRelayAddress(socket, hwaddr->hwaddr_);
     // Set elapsed time.
-    uint32_t elapsed_time = getElapsedTime<Pkt4Ptr>(discover_pkt4, offer_pkt4);
-    pkt4->setSecs(static_cast<uint16_t>(elapsed_time / 1000));
-    // Prepare on wire data to send.
-    pkt4->pack();
-    IfaceMgr::instance().send(pkt4);
+    uint32_t elapsed_time = getElapsedTime(discover_time,
+                                           offer_pkt4->getMonotonicTimestamp());
+    const uint16_t secs = static_cast<uint16_t>(elapsed_time / 1000);
+
+    Pkt4Ptr pkt4;
+    size_t serverid_len = 0;
+    size_t serverid_offset = 0;
+    if (canUsePrepared(prepared_request4_, socket)) {
+        serverid_offset = prepared_request4_->
+            getOptionDataOffset(DHO_DHCP_SERVER_IDENTIFIER, serverid_len);
+    }
+    if ((serverid_len == serverid.size()) && (serverid_len > 0) &&
+        (prepared_request4_->getPacket()->getHlen() ==
+         hwaddr->hwaddr_.size())) {
+        // The REQUEST messages differ only in the transaction id, the
+        // elapsed time, the relay address, the hardware address, the
+        // server identifier and the requested address.
+        size_t address_len = 0;
+        const size_t address_offset = prepared_request4_->
+            getOptionDataOffset(DHO_DHCP_REQUESTED_ADDRESS, address_len);
+        prepared_request4_->setTransid(transid);
+        prepared_request4_->writeUint16At(secs, DHCPV4_SECS_OFFSET);
+        prepared_request4_->writeUint32At(static_cast<uint32_t>(giaddr),
+                                          DHCPV4_GIADDR_OFFSET);
+        prepared_request4_->writeAt(DHCPV4_CHADDR_OFFSET, hwaddr->hwaddr_);
+        prepared_request4_->writeAt(serverid_offset, serverid);
+        prepared_request4_->writeUint32At(static_cast<uint32_t>(yiaddr),
+                                          address_offset);
+        pkt4 = prepared_request4_->getPacket();
+
+    } else {
+        pkt4.reset(new Pkt4(DHCPREQUEST, transid));
+        pkt4->addOption(Option::factory(Option::V4,
+                                        DHO_DHCP_SERVER_IDENTIFIER,
+                                        serverid));
+        OptionPtr opt_requested_address =
+            OptionPtr(new Option(Option::V4, DHO_DHCP_REQUESTED_ADDRESS,
+                                 OptionBuffer()));
+        opt_requested_address->setUint32(static_cast<uint32_t>(yiaddr));
+        pkt4->addOption(opt_requested_address);
+        OptionPtr opt_parameter_list =
+            Option::factory(Option::V4, DHO_DHCP_PARAMETER_REQUEST_LIST);
+        pkt4->addOption(opt_parameter_list);
+        // Set client's and server's ports as well as server's address,
+        // and local (relay) address.
+        setDefaults4(socket, pkt4);
+
+        // Set hardware address
+        pkt4->setHWAddr(hwaddr);
+        pkt4->setGiaddr(giaddr);
+        pkt4->setSecs(secs);
+        // Prepare on wire data to send.
+        pkt4->pack();
+        prepare(prepared_request4_, pkt4);
+    }
+    sendPacket(socket, pkt4);
     if (!stats_mgr4_) {
         isc_throw(InvalidOperation, "Statistics Manager for DHCPv4 "
                   "hasn't been initialized");
@@ -1679,7 +2121,7 @@ TestControl::sendRequest4(const TestControlSocket& socket,
 void
 TestControl::sendRequest4(const TestControlSocket& socket,
                           const std::vector<uint8_t>& template_buf,
-                          const dhcp::Pkt4Ptr& discover_pkt4,
+                          const uint64_t discover_time,
                           const dhcp::Pkt4Ptr& offer_pkt4) {
     // Get the second argument if multiple the same arguments specified
     // in the command line. Second one refers to REQUEST packets.
@@ -1711,10 +2153,16 @@ TestControl::sendRequest4(const TestControlSocket& socket,
     uint8_t hw_len = hwaddr->hwaddr_.size();
     memcpy(&mac_address[0], &hwaddr->hwaddr_[0], hw_len > 16 ? 16 : hw_len);
     pkt4->writeAt(rand_offset, mac_address.begin(), mac_address.end());
+    // Use the same relay as for the DISCOVER.
+    if (!relays_.empty()) {
+        pkt4->writeValueAt<uint32_t>(DHCPV4_GIADDR_OFFSET,
+            static_cast<uint32_t>(getRelayAddress(socket, hwaddr->hwaddr_)));
+    }
 
     // Set elapsed time.
     size_t elp_offset = getElapsedTimeOffset();
-    uint32_t elapsed_time = getElapsedTime<Pkt4Ptr>(discover_pkt4, offer_pkt4);
+    uint32_t elapsed_time = getElapsedTime(discover_time,
+                                           offer_pkt4->getMonotonicTimestamp());
     pkt4->writeValueAt<uint16_t>(elp_offset,
                                  static_cast<uint16_t>(elapsed_time / 1000));
 
@@ -1772,7 +2220,7 @@ TestControl::sendRequest4(const TestControlSocket& socket,
     setDefaults4(socket, boost::static_pointer_cast<Pkt4>(pkt4));
     // Prepare on-wire data.
     pkt4->rawPack();
-    IfaceMgr::instance().send(boost::static_pointer_cast<Pkt4>(pkt4));
+    sendPacket(socket, boost::static_pointer_cast<Pkt4>(pkt4));
     if (!stats_mgr4_) {
         isc_throw(InvalidOperation, "Statistics Manager for DHCPv4 "
                   "hasn't been initialized");
@@ -1827,7 +2275,7 @@ TestControl::sendRequest6(const TestControlSocket& socket,
     setDefaults6(socket, pkt6);
     // Prepare on-wire data.
     pkt6->pack();
-    IfaceMgr::instance().send(pkt6);
+    sendPacket(socket, pkt6);
     if (!stats_mgr6_) {
         isc_throw(InvalidOperation, "Statistics Manager for DHCPv6 "
                   "hasn't been initialized");
@@ -1932,7 +2380,7 @@ TestControl::sendRequest6(const TestControlSocket& socket,
     // Prepare on wire data.
     pkt6->rawPack();
     // Send packet.
-    IfaceMgr::instance().send(pkt6);
+    sendPacket(socket, pkt6);
     if (!stats_mgr6_) {
         isc_throw(InvalidOperation, "Statistics Manager for DHCPv6 "
                   "hasn't been initialized");
@@ -1960,34 +2408,48 @@ TestControl::sendSolicit6(const TestControlSocket& socket,
     std::vector<uint8_t> duid = generateDuid(randomized);
     // Generate trasnaction id to be set for the new exchange.
     const uint32_t transid = generateTransid();
-    Pkt6Ptr pkt6(new Pkt6(DHCPV6_SOLICIT, transid));
-    if (!pkt6) {
-        isc_throw(Unexpected, "failed to create SOLICIT packet");
-    }
-    pkt6->addOption(Option::factory(Option::V6, D6O_ELAPSED_TIME));
-    if (CommandOptions::instance().isRapidCommit()) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_RAPID_COMMIT));
-    }
-    pkt6->addOption(Option::factory(Option::V6, D6O_CLIENTID, duid));
-    pkt6->addOption(Option::factory(Option::V6, D6O_ORO));
+    Pkt6Ptr pkt6;
+    size_t duid_len = 0;
+    size_t duid_offset = 0;
+    if (canUsePrepared(prepared_solicit6_, socket)) {
+        duid_offset = prepared_solicit6_->getOptionDataOffset(D6O_CLIENTID,
+                                                              duid_len);
+    }
+    if ((duid_len == duid.size()) && (duid_len > 0)) {
+        // The SOLICIT messages differ only in the transaction id and
+        // the client identifier.
+        prepared_solicit6_->setTransid(transid);
+        prepared_solicit6_->writeAt(duid_offset, duid);
+        pkt6 = prepared_solicit6_->getPacket();
 
-    // Depending on the lease-type option specified, we should request
-    // IPv6 address (with IA_NA) or IPv6 prefix (IA_PD) or both.
+    } else {
+        pkt6.reset(new Pkt6(DHCPV6_SOLICIT, transid));
+        pkt6->addOption(Option::factory(Option::V6, D6O_ELAPSED_TIME));
+        if (CommandOptions::instance().isRapidCommit()) {
+            pkt6->addOption(Option::factory(Option::V6, D6O_RAPID_COMMIT));
+        }
+        pkt6->addOption(Option::factory(Option::V6, D6O_CLIENTID, duid));
+        pkt6->addOption(Option::factory(Option::V6, D6O_ORO));
 
-    // IA_NA
-    if (CommandOptions::instance().getLeaseType()
-        .includes(CommandOptions::LeaseType::ADDRESS)) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_IA_NA));
-    }
-    // IA_PD
-    if (CommandOptions::instance().getLeaseType()
-        .includes(CommandOptions::LeaseType::PREFIX)) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_IA_PD));
-    }
+        // Depending on the lease-type option specified, we should request
+        // IPv6 address (with IA_NA) or IPv6 prefix (IA_PD) or both.
 
-    setDefaults6(socket, pkt6);
-    pkt6->pack();
-    IfaceMgr::instance().send(pkt6);
+        // IA_NA
+        if (CommandOptions::instance().getLeaseType()
+            .includes(CommandOptions::LeaseType::ADDRESS)) {
+            pkt6->addOption(Option::factory(Option::V6, D6O_IA_NA));
+        }
+        // IA_PD
+        if (CommandOptions::instance().getLeaseType()
+            .includes(CommandOptions::LeaseType::PREFIX)) {
+            pkt6->addOption(Option::factory(Option::V6, D6O_IA_PD));
+        }
+
+        setDefaults6(socket, pkt6);
+        pkt6->pack();
+        prepare(prepared_solicit6_, pkt6);
+    }
+    sendPacket(socket, pkt6);
     if (!preload) {
         if (!stats_mgr6_) {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv6 "
@@ -2032,7 +2494,7 @@ TestControl::sendSolicit6(const TestControlSocket& socket,
     pkt6->rawPack();
     setDefaults6(socket, pkt6);
     // Send solicit packet.
-    IfaceMgr::instance().send(pkt6);
+    sendPacket(socket, pkt6);
     if (!preload) {
         if (!stats_mgr6_) {
             isc_throw(InvalidOperation, "Statistics Manager for DHCPv6 "
@@ -2093,6 +2555,68 @@ TestControl::setDefaults6(const TestControlSocket& socket,
     pkt->setRemoteAddr(IOAddress(options.getServerName()));
 }
 
+void
+TestControl::startPhase(const TestControlSocket& socket, const size_t index) {
+    CommandOptions& options = CommandOptions::instance();
+    const ScenarioPhase& phase = scenario_->getPhase(index);
+    phase_index_ = index;
+
+    // The responses to the relayed messages are sent by the server to
+    // the relay address, so perfdhcp has to listen on it too.
+    for (std::vector<IOAddress>::const_iterator relay = phase.relays_.begin();
+         relay != phase.relays_.end(); ++relay) {
+        if ((*relay == socket.addr_) ||
+            (relay_sockets_.count(relay->toText()) > 0)) {
+            continue;
+        }
+        uint16_t port = options.getLocalPort();
+        if (port == 0) {
+            port = DHCP4_SERVER_PORT;
+        }
+        try {
+            IfaceMgr::instance().openSocketFromAddress(*relay, port);
+        } catch (const isc::Exception& ex) {
+            isc_throw(BadValue, "unable to open socket for the relay address "
+                      << *relay << " of the phase " << phase.name_
+                      << ", the relay addresses must be assigned to the"
+                      " local interfaces: " << ex.what());
+        }
+        relay_sockets_.insert(relay->toText());
+    }
+    relays_ = phase.relays_;
+
+    phase_clients_num_ = phase.clients_num_;
+    const uint32_t clients_num = getClientsNum() == 0 ? 1 : getClientsNum();
+    setMacAddrGenerator(NumberGeneratorPtr(new SequentialGenerator(clients_num)));
+
+    if (!phase.template_files_.empty()) {
+        initPacketTemplates(phase.template_files_);
+    } else {
+        initPacketTemplates();
+    }
+
+    basic_rate_control_.setRate(phase.getRate(0));
+    renew_rate_control_.setRate(phase.renew_rate_);
+    release_rate_control_.setRate(phase.release_rate_);
+    renew_after_ = phase.renew_after_;
+
+    if (options.getIpVersion() == 4) {
+        stats_mgr4_->startPhase(phase.name_);
+    } else {
+        stats_mgr6_->startPhase(phase.name_);
+    }
+}
+
+void
+TestControl::sendPacket(const TestControlSocket&, const Pkt4Ptr& pkt) {
+    IfaceMgr::instance().send(pkt);
+}
+
+void
+TestControl::sendPacket(const TestControlSocket&, const Pkt6Ptr& pkt) {
+    IfaceMgr::instance().send(pkt);
+}
+
 bool
 TestControl::testDiags(const char diag) const {
     std::string diags(CommandOptions::instance().getDiags());
@@ -2102,5 +2626,28 @@ TestControl::testDiags(const char diag) const {
     return (false);
 }
 
+bool
+TestControl::updatePhase(const TestControlSocket& socket) {
+    double elapsed = static_cast<double>(isc::util::getMonotonicNanos() -
+                                         phase_start_) / 1e9;
+    while (elapsed >= scenario_->getPhase(phase_index_).duration_) {
+        if (phase_index_ + 1 >= scenario_->getPhasesNum()) {
+            return (false);
+        }
+        printPhaseStats();
+        // The next phase starts when the previous one was due to end,
+        // so as the scenario doesn't drift.
+        const double duration = scenario_->getPhase(phase_index_).duration_;
+        phase_start_ += static_cast<uint64_t>(duration * 1e9);
+        elapsed -= duration;
+        startPhase(socket, phase_index_ + 1);
+    }
+    const int rate = scenario_->getPhase(phase_index_).getRate(elapsed);
+    if (rate != basic_rate_control_.getRate()) {
+        basic_rate_control_.setRate(rate);
+    }
+    return (true);
+}
+
 } // namespace perfdhcp
 } // namespace isc
@@ -16,7 +16,9 @@
 #define TEST_CONTROL_H
 
 #include "packet_storage.h"
+#include "prepared_packet.h"
 #include "rate_control.h"
+#include "scenario.h"
 #include "stats_mgr.h"
 
 #include <dhcp/iface_mgr.h>
@@ -29,6 +31,7 @@
 #include <boost/function.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -235,6 +238,60 @@ public:
         uint32_t range_; ///< Number of unique numbers generated.
     };
 
+    /// \brief Strided numbers generator class.
+    ///
+    /// This generator produces the numbers from the range which give
+    /// the same remainder when divided by the stride, i.e. offset,
+    /// offset + stride, offset + 2 * stride etc. It is used by the
+    /// sender threads so as each thread generates its own subset of
+    /// transaction ids and client identifiers. The thread which has
+    /// received a packet is found by the transaction id.
+    class StridedGenerator : public NumberGenerator {
+    public:
+        /// \brief Constructor.
+        ///
+        /// \param offset first number generated. If it is out of
+        /// range, the remainder of its division by range is used.
+        /// \param stride difference between subsequent numbers.
+        /// \param range maximum number generated. If 0 is given then
+        /// range defaults to maximum uint32_t value.
+        /// \throw isc::BadValue if stride is 0.
+        StridedGenerator(uint32_t offset, uint32_t stride,
+                         uint32_t range = 0xFFFFFFFF) :
+            NumberGenerator(),
+            offset_(offset),
+            stride_(stride),
+            range_(range) {
+            if (stride_ == 0) {
+                isc_throw(isc::BadValue, "stride of the number generator"
+                          " must be greater than 0");
+            }
+            if (range_ == 0) {
+                range_ = 0xFFFFFFFF;
+            }
+            offset_ %= range_;
+            num_ = offset_;
+        }
+
+        /// \brief Generate number.
+        ///
+        /// \return generated number.
+        virtual uint32_t generate() {
+            uint32_t num = num_;
+            if (range_ - num_ > stride_) {
+                num_ += stride_;
+            } else {
+                num_ = offset_;
+            }
+            return (num);
+        }
+    private:
+        uint32_t offset_; ///< First number generated.
+        uint32_t stride_; ///< Difference between subsequent numbers.
+        uint32_t range_;  ///< Upper bound of generated numbers.
+        uint32_t num_;    ///< Current number.
+    };
+
     /// \brief Length of the Ethernet HW address (MAC) in bytes.
     ///
     /// \todo Make this variable length as there are cases when HW
@@ -247,11 +304,15 @@ public:
     /// \return the only existing instance of test control
     static TestControl& instance();
 
+    /// \brief Destructor.
+    virtual ~TestControl() { }
+
     /// brief\ Run performance test.
     ///
     /// Method runs whole performance test. Command line options must
     /// be parsed prior to running this function. Otherwise function will
-    /// throw exception.
+    /// throw exception. If the number of sender threads is specified
+    /// with -g<sender-threads> the test is run by \ref runMultiThreaded.
     ///
     /// \throw isc::InvalidOperation if command line options are not parsed.
     /// \throw isc::Unexpected if internal Test Controller error occured.
@@ -492,6 +553,26 @@ protected:
     /// \return A current timeout in microseconds.
     uint32_t getCurrentTimeout() const;
 
+    /// \brief Returns number of simulated clients.
+    ///
+    /// \return number of clients specified for the current phase of the
+    /// scenario or, if not specified, with -R<range>.
+    uint32_t getClientsNum() const;
+
+    /// \brief Returns the relay address used by the DHCPv4 client.
+    ///
+    /// The clients are spread over the relay addresses of the current
+    /// phase of the scenario by the hash of their MAC address, so as all
+    /// messages of the client are sent through the same relay.
+    ///
+    /// \param socket socket used to send the packet.
+    /// \param mac_address MAC address of the client.
+    /// \return relay address or the address of the socket if no relays
+    /// are used.
+    asiolink::IOAddress
+    getRelayAddress(const TestControlSocket& socket,
+                    const std::vector<uint8_t>& mac_address) const;
+
     /// \brief Return template buffer.
     ///
     /// Method returns template buffer at specified index.
@@ -513,6 +594,48 @@ protected:
     /// odd number of hexadecimal digits.
     void initPacketTemplates();
 
+    /// \brief Reads packet templates from the specified files.
+    ///
+    /// \param template_files names of the template files.
+    /// \throw isc::BadValue if any of the template files does not exist,
+    /// contains characters other than hexadecimal digits or spaces.
+    /// \throw OutOfRange if any of the template files is empty or has
+    /// odd number of hexadecimal digits.
+    void initPacketTemplates(const std::vector<std::string>& template_files);
+
+    /// \brief Reads the scenario specified with -j<scenario-file>.
+    ///
+    /// \throw InvalidScenario if the scenario is invalid or uses the
+    /// parameters which are not applicable to the IP version or the
+    /// exchange mode of the test.
+    void loadScenario();
+
+    /// \brief Starts the phase of the scenario.
+    ///
+    /// Method sets the rates, the number of clients, the relay addresses
+    /// and the templates of the phase and starts counting the phase
+    /// statistics. The sockets for the relay addresses are opened, so as
+    /// the responses sent by the server to the relays are received.
+    ///
+    /// \param socket socket used to send packets.
+    /// \param index index of the phase.
+    /// \throw isc::BadValue if the socket for the relay address can't
+    /// be opened.
+    void startPhase(const TestControlSocket& socket, const size_t index);
+
+    /// \brief Moves the scenario forward.
+    ///
+    /// Method updates the rate according to the rate curve of the
+    /// current phase. When the phase is over, its statistics are printed
+    /// and the next phase is started.
+    ///
+    /// \param socket socket used to send packets.
+    /// \return false if the last phase is over, true otherwise.
+    bool updatePhase(const TestControlSocket& socket);
+
+    /// \brief Prints statistics of the current phase.
+    void printPhaseStats() const;
+
     /// \brief Initializes Statistics Manager.
     ///
     /// This function initializes Statistics Manager. If there is
@@ -536,15 +659,32 @@ protected:
     /// set for the v4 socket or if multicast option can't be set
     /// for the v6 socket.
     /// \throw isc::Unexpected if interal unexpected error occured.
+    /// \param port_offset value added to the local port number. It is
+    /// used by the sender threads to open the sockets bound to the
+    /// consecutive ports.
     /// \return socket descriptor.
-    int openSocket() const;
+    int openSocket(const uint16_t port_offset = 0) const;
+
+    /// \brief Checks if the intermediate report is due.
+    ///
+    /// \return true if the report delay specified with -t<report> has
+    /// elapsed since the last report.
+    bool isReportDue() const;
 
     /// \brief Print intermediate statistics.
     ///
     /// Print brief statistics regarding number of sent packets,
-    /// received packets and dropped packets so far.
+    /// received packets and dropped packets so far, and the percentiles
+    /// of the packet delays since the last report, if the report is due.
+    /// The statistics are printed in the format specified with
+    /// -Y<report-format>.
     void printIntermediateStats();
 
+    /// \brief Print the header of the statistics reports.
+    ///
+    /// The header is only printed for the CSV format.
+    void printReportHeader() const;
+
     /// \brief Print rate statistics.
     ///
     /// Method print packet exchange rate statistics.
@@ -605,7 +745,22 @@ protected:
     /// \throw isc::BadValue if unknown message type received.
     /// \throw isc::Unexpected if unexpected error occured.
     /// \return number of received packets.
-    uint64_t receivePackets(const TestControlSocket& socket);
+    virtual uint64_t receivePackets(const TestControlSocket& socket);
+
+    /// \brief Run performance test using multiple threads.
+    ///
+    /// The exchanges are initiated by the number of sender threads
+    /// specified with -g<sender-threads>. Each sender thread is
+    /// represented by the \ref TestShard object which holds its own
+    /// socket, rate control, transaction id generator and Statistics
+    /// Manager. The responses are received by the receiver threads
+    /// (-G<receiver-threads>) which pass them to the sender thread they
+    /// belong to. This thread periodically merges the statistics of all
+    /// sender threads to check exit conditions and print reports.
+    ///
+    /// \return error_code, 3 if number of received packets is not equal
+    /// to number of sent packets, 0 if everything is ok.
+    int runMultiThreaded();
 
     /// \brief Register option factory functions for DHCPv4
     ///
@@ -668,6 +823,30 @@ protected:
     /// \param pkt packet to be stored.
     inline void saveFirstPacket(const dhcp::Pkt6Ptr& pkt);
 
+    /// \brief Checks if the prepared packet may be sent over the socket.
+    ///
+    /// The prepared packet is not used if it hasn't been created yet,
+    /// if it has been created for a different interface or if the
+    /// diagnostics flag 'T' is specified, because the packets printed
+    /// at the end of the test must not be modified after they are sent.
+    ///
+    /// \param prepared prepared packet.
+    /// \param socket socket to be used to send the packet.
+    /// \tparam T dhcp::Pkt4 or dhcp::Pkt6 class.
+    /// \return true if the prepared packet may be patched and sent.
+    template<typename T>
+    bool canUsePrepared(const boost::shared_ptr<PreparedPacket<T> >& prepared,
+                        const TestControlSocket& socket) const;
+
+    /// \brief Prepares the packed packet to be reused by next messages.
+    ///
+    /// \param [out] prepared prepared packet to be replaced.
+    /// \param pkt packed packet.
+    /// \tparam T dhcp::Pkt4 or dhcp::Pkt6 class.
+    template<typename T>
+    void prepare(boost::shared_ptr<PreparedPacket<T> >& prepared,
+                 const boost::shared_ptr<T>& pkt);
+
     /// \brief Send DHCPv4 DISCOVER message.
     ///
     /// Method creates and sends DHCPv4 DISCOVER message to the server
@@ -768,7 +947,8 @@ protected:
     /// update statistics.
     ///
     /// \param socket socket to be used to send message.
-    /// \param discover_pkt4 DISCOVER packet sent.
+    /// \param discover_time monotonic timestamp of the DISCOVER packet
+    /// sent.
     /// \param offer_pkt4 OFFER packet object.
     ///
     /// \throw isc::Unexpected if unexpected error occured.
@@ -776,7 +956,7 @@ protected:
     /// initialized.
     /// \throw isc::dhcp::SocketWriteError if failed to send the packet.
     void sendRequest4(const TestControlSocket& socket,
-                      const dhcp::Pkt4Ptr& discover_pkt4,
+                      const uint64_t discover_time,
                       const dhcp::Pkt4Ptr& offer_pkt4);
 
     /// \brief Send DHCPv4 REQUEST message from template.
@@ -787,13 +967,14 @@ protected:
     ///
     /// \param socket socket to be used to send message.
     /// \param template_buf buffer holding template packet.
-    /// \param discover_pkt4 DISCOVER packet sent.
+    /// \param discover_time monotonic timestamp of the DISCOVER packet
+    /// sent.
     /// \param offer_pkt4 OFFER packet received.
     ///
     /// \throw isc::dhcp::SocketWriteError if failed to send the packet.
     void sendRequest4(const TestControlSocket& socket,
                       const std::vector<uint8_t>& template_buf,
-                      const dhcp::Pkt4Ptr& discover_pkt4,
+                      const uint64_t discover_time,
                       const dhcp::Pkt4Ptr& offer_pkt4);
 
     /// \brief Send DHCPv6 REQUEST message.
@@ -896,6 +1077,26 @@ protected:
     void setDefaults6(const TestControlSocket& socket,
                       const dhcp::Pkt6Ptr& pkt);
 
+    /// \brief Send DHCPv4 packet.
+    ///
+    /// The packet is sent using \ref dhcp::IfaceMgr. It is overridden
+    /// by the sender threads to send the packet over their own sockets.
+    ///
+    /// \param socket socket to be used to send the packet.
+    /// \param pkt packet to be sent.
+    virtual void sendPacket(const TestControlSocket& socket,
+                            const dhcp::Pkt4Ptr& pkt);
+
+    /// \brief Send DHCPv6 packet.
+    ///
+    /// The packet is sent using \ref dhcp::IfaceMgr. It is overridden
+    /// by the sender threads to send the packet over their own sockets.
+    ///
+    /// \param socket socket to be used to send the packet.
+    /// \param pkt packet to be sent.
+    virtual void sendPacket(const TestControlSocket& socket,
+                            const dhcp::Pkt6Ptr& pkt);
+
     /// \brief Find if diagnostic flag has been set.
     ///
     /// \param diag diagnostic flag (a,e,i,s,r,t,T).
@@ -944,17 +1145,15 @@ protected:
     /// \brief Calculate elapsed time between two packets.
     ///
     /// This function calculates the time elapsed between two packets. If
-    /// the timestamp of the pkt2 is greater than timestamp of the pkt1,
-    /// the positive value is returned. If the pkt2 timestamp is equal or
-    /// less than pkt1 timestamp, 0 is returned.
+    /// the timestamp of the second packet is greater than timestamp of
+    /// the first packet, the positive value is returned. Otherwise, 0 is
+    /// returned.
     ///
-    /// \tparam T Pkt4Ptr or Pkt6Ptr class.
-    /// \param pkt1 first packet.
-    /// \param pkt2 second packet.
+    /// \param time1 monotonic timestamp of the first packet.
+    /// \param time2 monotonic timestamp of the second packet.
     /// \throw InvalidOperation if packet timestamps are invalid.
-    /// \return elapsed time in milliseconds between pkt1 and pkt2.
-    template<class T>
-    uint32_t getElapsedTime(const T& pkt1, const T& pkt2);
+    /// \return elapsed time in milliseconds between the packets.
+    uint32_t getElapsedTime(const uint64_t time1, const uint64_t time2);
 
     /// \brief Return elapsed time offset in a packet.
     ///
@@ -1069,6 +1268,7 @@ protected:
     RateControl release_rate_control_;
 
     boost::posix_time::ptime last_report_; ///< Last intermediate report time.
+    boost::posix_time::ptime last_clean_;  ///< Last cleanup of cached packets.
 
     StatsMgr4Ptr stats_mgr4_;  ///< Statistics Manager 4.
     StatsMgr6Ptr stats_mgr6_;  ///< Statistics Manager 6.
@@ -1089,6 +1289,30 @@ protected:
     std::map<uint8_t, dhcp::Pkt4Ptr> template_packets_v4_;
     std::map<uint8_t, dhcp::Pkt6Ptr> template_packets_v6_;
 
+    /// Packets sent last, patched in place to send next messages of
+    /// the same type.
+    PreparedPacket4Ptr prepared_discover4_; ///< Prepared DISCOVER.
+    PreparedPacket4Ptr prepared_request4_;  ///< Prepared REQUEST.
+    PreparedPacket6Ptr prepared_solicit6_;  ///< Prepared SOLICIT.
+
+    /// Scenario specified with -j<scenario-file>, null if the test is
+    /// not run in phases.
+    ScenarioPtr scenario_;
+    /// Index of the current phase of the scenario.
+    size_t phase_index_;
+    /// Monotonic time of the start of the current phase in nanoseconds.
+    uint64_t phase_start_;
+    /// Number of clients simulated in the current phase, 0 if specified
+    /// with -R<range>.
+    uint32_t phase_clients_num_;
+    /// Relay addresses used in the current phase.
+    std::vector<asiolink::IOAddress> relays_;
+    /// Relay addresses for which the sockets have been opened.
+    std::set<std::string> relay_sockets_;
+    /// Time in seconds after which the leases are renewed, 0 if random
+    /// leases are renewed.
+    double renew_after_;
+
     static bool interrupted_;  ///< Is program interrupted.
 };
 
@@ -0,0 +1,321 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include <asiolink/io_address.h>
+#include <dhcp/iface_mgr.h>
+#include <dhcp/dhcp6.h>
+#include "command_options.h"
+#include "test_shard.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace boost::posix_time;
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+
+namespace {
+
+/// \brief Returns the share of the rate sent by the shard.
+///
+/// The remainder of the division of the rate by the number of shards
+/// is sent by the first shards.
+///
+/// \param rate total rate.
+/// \param index index of the shard.
+/// \param shards_num number of shards.
+/// \return rate of the shard.
+int
+getRateShare(const int rate, const unsigned int index,
+             const unsigned int shards_num) {
+    const int remainder = rate % shards_num;
+    return (rate / shards_num +
+            (static_cast<int>(index) < remainder ? 1 : 0));
+}
+
+}
+
+namespace isc {
+namespace perfdhcp {
+
+TestShard::TestShard(const unsigned int index, const unsigned int shards_num)
+    : TestControl(), index_(index), socket_(), iface_(NULL),
+      packet_filter_(), packet_filter6_(), mutex_(), malformed_(0) {
+    if (index_ >= shards_num) {
+        isc_throw(BadValue, "index " << index_ << " of the test shard is"
+                  " out of range, the number of shards is " << shards_num);
+    }
+    CommandOptions& options = CommandOptions::instance();
+    // Each shard initiates its share of exchanges. Note that the rate of
+    // 0 means no limit, so the basic rate is not split if not specified.
+    // The Renew and Release messages are not sent if the share is 0.
+    basic_rate_control_.setRate(getRateShare(options.getRate(), index_,
+                                             shards_num));
+    renew_rate_control_.setRate(getRateShare(options.getRenewRate(), index_,
+                                             shards_num));
+    release_rate_control_.setRate(getRateShare(options.getReleaseRate(),
+                                               index_, shards_num));
+
+    // The transaction ids of the shard give the index of the shard as the
+    // remainder of the division by the number of shards, which is used to
+    // find the shard the received packet belongs to.
+    setTransidGenerator(NumberGeneratorPtr(new StridedGenerator(index_,
+        shards_num, options.getIpVersion() == 4 ? 0xFFFFFFFF : 0x00FFFFFF)));
+    uint32_t clients_num = options.getClientsNum() == 0 ?
+        1 : options.getClientsNum();
+    setMacAddrGenerator(NumberGeneratorPtr(new StridedGenerator(index_,
+        shards_num, clients_num)));
+
+    initPacketTemplates();
+
+    socket_.reset(new TestControlSocket(openSocket(index_)));
+    if (!socket_->valid_) {
+        isc_throw(Unexpected, "invalid socket descriptor");
+    }
+    iface_ = IfaceMgr::instance().getIface(socket_->ifindex_);
+    if (iface_ == NULL) {
+        isc_throw(Unexpected, "unable to find interface with index "
+                  << socket_->ifindex_);
+    }
+}
+
+void
+TestShard::preload(const uint64_t packets_num) {
+    Mutex::Locker lock(mutex_);
+    sendPackets(*socket_, packets_num, true);
+}
+
+void
+TestShard::initializeStats() {
+    Mutex::Locker lock(mutex_);
+    initializeStatsMgr();
+}
+
+void
+TestShard::runSender(volatile bool* stopping) {
+    try {
+        while (!*stopping) {
+            const long wait_time = sendDuePackets();
+            if (wait_time > 0) {
+                usleep(wait_time);
+            }
+        }
+    } catch (...) {
+        // Let the main thread know that the test can't be continued.
+        // The exception is reported when the thread is joined.
+        *stopping = true;
+        throw;
+    }
+}
+
+long
+TestShard::sendDuePackets() {
+    CommandOptions& options = CommandOptions::instance();
+    Mutex::Locker lock(mutex_);
+
+    uint64_t packets_due = basic_rate_control_.getOutboundMessageCount();
+    checkLateMessages(basic_rate_control_);
+    if ((packets_due == 0) && testDiags('i')) {
+        if (options.getIpVersion() == 4) {
+            stats_mgr4_->incrementCounter("shortwait");
+        } else if (options.getIpVersion() == 6) {
+            stats_mgr6_->incrementCounter("shortwait");
+        }
+    }
+    sendPackets(*socket_, packets_due);
+
+    if ((options.getIpVersion() == 6) &&
+        (renew_rate_control_.getRate() != 0)) {
+        uint64_t renew_packets_due =
+            renew_rate_control_.getOutboundMessageCount();
+        checkLateMessages(renew_rate_control_);
+        sendMultipleMessages6(*socket_, DHCPV6_RENEW, renew_packets_due);
+    }
+    if ((options.getIpVersion() == 6) &&
+        (release_rate_control_.getRate() != 0)) {
+        uint64_t release_packets_due =
+            release_rate_control_.getOutboundMessageCount();
+        checkLateMessages(release_rate_control_);
+        sendMultipleMessages6(*socket_, DHCPV6_RELEASE, release_packets_due);
+    }
+
+    cleanCachedPackets();
+
+    if (packets_due > 0) {
+        return (0);
+    }
+    // Wait until the next exchange is due, but not longer than 1ms so as
+    // the Renew and Release messages are sent on time too.
+    time_duration wait_time = basic_rate_control_.getDue() -
+        microsec_clock::universal_time();
+    return (std::min(static_cast<long>(wait_time.total_microseconds()),
+                     1000L));
+}
+
+void
+TestShard::runReceiver(const TestShardCollection& shards,
+                       volatile bool* stopping) {
+    try {
+        std::vector<struct pollfd> fds(shards.size());
+        for (size_t i = 0; i < shards.size(); ++i) {
+            fds[i].fd = shards[i]->getSocket().sockfd_;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        uint8_t buf[IfaceMgr::RCVBUFSIZE];
+        while (!*stopping) {
+            int result = poll(&fds[0], fds.size(), RECEIVE_TIMEOUT_MS);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                isc_throw(Unexpected, "failed to wait for packets: "
+                          << strerror(errno));
+            }
+            for (size_t i = 0; (i < fds.size()) && (result > 0); ++i) {
+                if ((fds[i].revents & POLLIN) == 0) {
+                    continue;
+                }
+                --result;
+                // Other receiver threads may have read the packet after
+                // poll returned, so the socket must not block.
+                for (unsigned int n = 0; n < MAX_RECEIVE_BURST; ++n) {
+                    struct sockaddr_storage from;
+                    socklen_t from_len = sizeof(from);
+                    ssize_t len = recvfrom(fds[i].fd, buf, sizeof(buf),
+                                           MSG_DONTWAIT,
+                                           reinterpret_cast<struct sockaddr*>
+                                           (&from), &from_len);
+                    if (len < 0) {
+                        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                            (errno == EINTR)) {
+                            break;
+                        }
+                        isc_throw(Unexpected, "failed to receive packet: "
+                                  << strerror(errno));
+                    }
+                    receivePacket(shards, i, buf, len, from);
+                }
+            }
+        }
+    } catch (...) {
+        *stopping = true;
+        throw;
+    }
+}
+
+void
+TestShard::receivePacket(const TestShardCollection& shards,
+                         const size_t index,
+                         const uint8_t* buf, const size_t len,
+                         const struct sockaddr_storage& from) {
+    const TestShard& owner = *shards[index];
+    if (CommandOptions::instance().getIpVersion() == 4) {
+        Pkt4Ptr pkt4;
+        try {
+            pkt4.reset(new Pkt4(buf, len));
+            pkt4->updateTimestamp();
+            pkt4->unpack();
+        } catch (const Exception&) {
+            __sync_fetch_and_add(&shards[index]->malformed_, 1);
+            return;
+        }
+        const struct sockaddr_in& from4 =
+            reinterpret_cast<const struct sockaddr_in&>(from);
+        pkt4->setRemoteAddr(IOAddress(ntohl(from4.sin_addr.s_addr)));
+        pkt4->setRemotePort(ntohs(from4.sin_port));
+        pkt4->setLocalAddr(owner.socket_->addr_);
+        pkt4->setIface(owner.iface_->getName());
+        pkt4->setIndex(owner.socket_->ifindex_);
+        shards[pkt4->getTransid() % shards.size()]->
+            processReceivedPacket(pkt4);
+
+    } else {
+        Pkt6Ptr pkt6;
+        try {
+            pkt6.reset(new Pkt6(buf, len));
+            pkt6->updateTimestamp();
+            pkt6->unpack();
+        } catch (const Exception&) {
+            __sync_fetch_and_add(&shards[index]->malformed_, 1);
+            return;
+        }
+        const struct sockaddr_in6& from6 =
+            reinterpret_cast<const struct sockaddr_in6&>(from);
+        pkt6->setRemoteAddr(IOAddress::fromBytes(AF_INET6,
+                                                 from6.sin6_addr.s6_addr));
+        pkt6->setRemotePort(ntohs(from6.sin6_port));
+        pkt6->setLocalAddr(owner.socket_->addr_);
+        pkt6->setIface(owner.iface_->getName());
+        pkt6->setIndex(owner.socket_->ifindex_);
+        shards[pkt6->getTransid() % shards.size()]->
+            processReceivedPacket(pkt6);
+    }
+}
+
+void
+TestShard::processReceivedPacket(const Pkt4Ptr& pkt4) {
+    Mutex::Locker lock(mutex_);
+    processReceivedPacket4(*socket_, pkt4);
+}
+
+void
+TestShard::processReceivedPacket(const Pkt6Ptr& pkt6) {
+    Mutex::Locker lock(mutex_);
+    processReceivedPacket6(*socket_, pkt6);
+}
+
+void
+TestShard::mergeStats(StatsMgr4& stats_mgr, const bool start_interval) {
+    Mutex::Locker lock(mutex_);
+    if (stats_mgr4_) {
+        stats_mgr.merge(*stats_mgr4_);
+        if (start_interval) {
+            stats_mgr4_->startInterval();
+        }
+    }
+}
+
+void
+TestShard::mergeStats(StatsMgr6& stats_mgr, const bool start_interval) {
+    Mutex::Locker lock(mutex_);
+    if (stats_mgr6_) {
+        stats_mgr.merge(*stats_mgr6_);
+        if (start_interval) {
+            stats_mgr6_->startInterval();
+        }
+    }
+}
+
+void
+TestShard::sendPacket(const TestControlSocket& socket, const Pkt4Ptr& pkt) {
+    packet_filter_.send(*iface_, socket.sockfd_, pkt);
+}
+
+void
+TestShard::sendPacket(const TestControlSocket& socket, const Pkt6Ptr& pkt) {
+    packet_filter6_.send(*iface_, socket.sockfd_, pkt);
+}
+
+} // namespace perfdhcp
+} // namespace isc
@@ -0,0 +1,240 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef TEST_SHARD_H
+#define TEST_SHARD_H
+
+#include "test_control.h"
+
+#include <dhcp/pkt_filter_inet.h>
+#include <dhcp/pkt_filter_inet6.h>
+#include <util/threads/sync.h>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <sys/socket.h>
+#include <vector>
+
+namespace isc {
+namespace perfdhcp {
+
+class TestShard;
+
+/// \brief Pointer to the \ref TestShard object.
+typedef boost::shared_ptr<TestShard> TestShardPtr;
+
+/// \brief Collection of \ref TestShard objects.
+typedef std::vector<TestShardPtr> TestShardCollection;
+
+/// \brief Part of the test run by a single sender thread.
+///
+/// When the test is run with multiple sender threads (-g<sender-threads>),
+/// the exchanges are split between the sender threads. Each sender thread
+/// uses its own \ref TestShard object which holds:
+/// - the socket bound to the local port incremented by the index of the
+/// shard, so as each thread can send over its own socket,
+/// - the rate controls with the share of the rates specified from the
+/// command line,
+/// - the transaction id generator producing the transaction ids which
+/// give the shard index as a remainder of the division by the number of
+/// shards; it is used to find the shard the received packet belongs to,
+/// - the MAC address generator producing the share of the client
+/// identifiers,
+/// - the Statistics Managers and the storage of Reply messages.
+///
+/// The shard is modified by its sender thread, by the receiver threads
+/// which pass the responses to it and by the main thread which merges
+/// its statistics, so all these operations are protected by the mutex
+/// of the shard. As the shards don't share any state, the sender threads
+/// don't contend with each other.
+///
+/// The receiver threads wait for the packets on the sockets of all
+/// shards because the server may send the response to the other socket
+/// than the one the request has been sent over, e.g. a DHCPv4 server
+/// sends responses to the relay port 67.
+class TestShard : public TestControl {
+public:
+
+    /// \brief Timeout of waiting for the packets by the receiver threads.
+    ///
+    /// The receiver threads check if they should stop at least that
+    /// often.
+    static const int RECEIVE_TIMEOUT_MS = 100;
+
+    /// \brief Maximum number of packets read from a single socket in a row.
+    ///
+    /// It prevents the socket receiving most of the traffic from
+    /// starving other sockets.
+    static const unsigned int MAX_RECEIVE_BURST = 64;
+
+    /// \brief Constructor.
+    ///
+    /// Opens the socket of the shard and initializes the generators,
+    /// the rate controls and the packet templates. The command line
+    /// options must be parsed and the option factories registered
+    /// prior to creating the shards.
+    ///
+    /// \param index index of the shard.
+    /// \param shards_num total number of shards.
+    /// \throw isc::BadValue if the index is out of range or the socket
+    /// can't be opened.
+    /// \throw isc::Unexpected if the opened socket is invalid.
+    TestShard(const unsigned int index, const unsigned int shards_num);
+
+    /// \brief Returns index of the shard.
+    unsigned int getIndex() const {
+        return (index_);
+    }
+
+    /// \brief Returns the socket of the shard.
+    const TestControlSocket& getSocket() const {
+        return (*socket_);
+    }
+
+    /// \brief Sends the preload packets.
+    ///
+    /// \param packets_num number of packets to be sent.
+    void preload(const uint64_t packets_num);
+
+    /// \brief Initializes Statistics Manager of the shard.
+    void initializeStats();
+
+    /// \brief Initiates exchanges at the shard's rate until stopped.
+    ///
+    /// This is the main function of the sender thread. It also sends
+    /// Renew and Release messages if their rates are specified.
+    ///
+    /// \param stopping flag set by the main thread when the test is
+    /// finished. It is also set by this function when the exception is
+    /// thrown so as the main thread finishes the test.
+    void runSender(volatile bool* stopping);
+
+    /// \brief Receives packets over the sockets of all shards until
+    /// stopped and passes them to the shards they belong to.
+    ///
+    /// This is the main function of the receiver thread. Packets which
+    /// are too short or can't be parsed are counted and dropped.
+    ///
+    /// \param shards collection of all shards.
+    /// \param stopping flag set by the main thread when the test is
+    /// finished. It is also set by this function when the exception is
+    /// thrown so as the main thread finishes the test.
+    static void runReceiver(const TestShardCollection& shards,
+                            volatile bool* stopping);
+
+    /// \brief Processes DHCPv4 packet received by the receiver thread.
+    ///
+    /// \param pkt4 received packet.
+    void processReceivedPacket(const dhcp::Pkt4Ptr& pkt4);
+
+    /// \brief Processes DHCPv6 packet received by the receiver thread.
+    ///
+    /// \param pkt6 received packet.
+    void processReceivedPacket(const dhcp::Pkt6Ptr& pkt6);
+
+    /// \brief Adds counters of the shard to the DHCPv4 statistics.
+    ///
+    /// \param stats_mgr Statistics Manager accumulating the counters.
+    /// \param start_interval if true, the shard starts new interval of
+    /// the delay statistics after they are merged.
+    void mergeStats(StatsMgr4& stats_mgr, const bool start_interval = false);
+
+    /// \brief Adds counters of the shard to the DHCPv6 statistics.
+    ///
+    /// \param stats_mgr Statistics Manager accumulating the counters.
+    /// \param start_interval if true, the shard starts new interval of
+    /// the delay statistics after they are merged.
+    void mergeStats(StatsMgr6& stats_mgr, const bool start_interval = false);
+
+    /// \brief Returns the number of received packets which have been
+    /// dropped because they couldn't be parsed.
+    uint64_t getMalformedNum() const {
+        return (malformed_);
+    }
+
+protected:
+
+    /// \brief Does not receive packets.
+    ///
+    /// Packets are received by the receiver threads.
+    ///
+    /// \return 0.
+    virtual uint64_t receivePackets(const TestControlSocket&) {
+        return (0);
+    }
+
+    /// \brief Sends DHCPv4 packet over the socket of the shard.
+    ///
+    /// \param socket socket to be used to send the packet.
+    /// \param pkt packet to be sent.
+    virtual void sendPacket(const TestControlSocket& socket,
+                            const dhcp::Pkt4Ptr& pkt);
+
+    /// \brief Sends DHCPv6 packet over the socket of the shard.
+    ///
+    /// \param socket socket to be used to send the packet.
+    /// \param pkt packet to be sent.
+    virtual void sendPacket(const TestControlSocket& socket,
+                            const dhcp::Pkt6Ptr& pkt);
+
+private:
+
+    /// \brief Initiates the due exchanges and sends Renew and Release
+    /// messages.
+    ///
+    /// \return number of microseconds to wait before sending the next
+    /// message, 0 if messages are due.
+    long sendDuePackets();
+
+    /// \brief Creates the packet from the received data and passes it
+    /// to the shard it belongs to.
+    ///
+    /// \param shards collection of all shards.
+    /// \param index index of the shard owning the socket the data has
+    /// been received over.
+    /// \param buf received data.
+    /// \param len length of the received data.
+    /// \param from address of the sender.
+    static void receivePacket(const TestShardCollection& shards,
+                              const size_t index,
+                              const uint8_t* buf, const size_t len,
+                              const struct sockaddr_storage& from);
+
+    /// \brief Index of the shard.
+    unsigned int index_;
+
+    /// \brief Socket of the shard.
+    boost::scoped_ptr<TestControlSocket> socket_;
+
+    /// \brief Interface of the socket.
+    const dhcp::Iface* iface_;
+
+    /// \brief Packet filter used to send DHCPv4 packets.
+    dhcp::PktFilterInet packet_filter_;
+
+    /// \brief Packet filter used to send DHCPv6 packets.
+    dhcp::PktFilterInet6 packet_filter6_;
+
+    /// \brief Mutex protecting the shard.
+    isc::util::thread::Mutex mutex_;
+
+    /// \brief Number of packets dropped because they couldn't be parsed.
+    volatile uint64_t malformed_;
+};
+
+} // namespace perfdhcp
+} // namespace isc
+
+#endif // TEST_SHARD_H
@@ -770,6 +770,72 @@ TEST_F(CommandOptionsTest, Period) {
                  isc::InvalidParameter);
 }
 
+TEST_F(CommandOptionsTest, ReportFormat) {
+    CommandOptions& opt = CommandOptions::instance();
+    EXPECT_NO_THROW(process("perfdhcp -l ethx all"));
+    EXPECT_EQ(CommandOptions::REPORT_TEXT, opt.getReportFormat());
+
+    EXPECT_NO_THROW(process("perfdhcp -r 10 -t 1 -Y csv -l ethx all"));
+    EXPECT_EQ(CommandOptions::REPORT_CSV, opt.getReportFormat());
+
+    EXPECT_NO_THROW(process("perfdhcp -Y json -l ethx all"));
+    EXPECT_EQ(CommandOptions::REPORT_JSON, opt.getReportFormat());
+
+    EXPECT_NO_THROW(process("perfdhcp -Y text -l ethx all"));
+    EXPECT_EQ(CommandOptions::REPORT_TEXT, opt.getReportFormat());
+
+    EXPECT_THROW(process("perfdhcp -Y xml -l ethx all"),
+                 isc::InvalidParameter);
+}
+
+TEST_F(CommandOptionsTest, ScenarioFile) {
+    CommandOptions& opt = CommandOptions::instance();
+    EXPECT_NO_THROW(process("perfdhcp -l ethx all"));
+    EXPECT_TRUE(opt.getScenarioFile().empty());
+    EXPECT_NO_THROW(process("perfdhcp -j scenario.json -l ethx all"));
+    EXPECT_EQ("scenario.json", opt.getScenarioFile());
+    // The exit conditions don't need the rate with the scenario.
+    EXPECT_NO_THROW(process("perfdhcp -j scenario.json -n 100 -t 1"
+                            " -l ethx all"));
+
+    // Negative test cases
+    // The rates are specified in the scenario.
+    EXPECT_THROW(process("perfdhcp -j scenario.json -r 10 -l ethx all"),
+                 isc::InvalidParameter);
+    // The scenario is not supported in the multi-threaded mode.
+    EXPECT_THROW(process("perfdhcp -j scenario.json -g 2 -l ethx all"),
+                 isc::InvalidParameter);
+    // The exit conditions still need the rate without the scenario.
+    EXPECT_THROW(process("perfdhcp -t 1 -l ethx all"),
+                 isc::InvalidParameter);
+}
+
+TEST_F(CommandOptionsTest, Threads) {
+    CommandOptions& opt = CommandOptions::instance();
+    EXPECT_NO_THROW(process("perfdhcp -l ethx all"));
+    EXPECT_EQ(0, opt.getSenderThreads());
+    EXPECT_EQ(0, opt.getReceiverThreads());
+    EXPECT_NO_THROW(process("perfdhcp -g 4 -l ethx all"));
+    EXPECT_EQ(4, opt.getSenderThreads());
+    EXPECT_EQ(0, opt.getReceiverThreads());
+    EXPECT_NO_THROW(process("perfdhcp -g 4 -G 2 -r 100 -l ethx all"));
+    EXPECT_EQ(4, opt.getSenderThreads());
+    EXPECT_EQ(2, opt.getReceiverThreads());
+
+    // Negative test cases
+    // Number of threads must be positive integer
+    EXPECT_THROW(process("perfdhcp -g 0 -l ethx all"),
+                 isc::InvalidParameter);
+    EXPECT_THROW(process("perfdhcp -g 2 -G 0 -l ethx all"),
+                 isc::InvalidParameter);
+    // Receiver threads require sender threads
+    EXPECT_THROW(process("perfdhcp -G 2 -l ethx all"),
+                 isc::InvalidParameter);
+    // Each sender thread must send at least one exchange per second
+    EXPECT_THROW(process("perfdhcp -g 8 -r 4 -l ethx all"),
+                 isc::InvalidParameter);
+}
+
 TEST_F(CommandOptionsTest, Interface) {
     // In order to make this test portable we need to know
     // at least one interface name on OS where test is run.
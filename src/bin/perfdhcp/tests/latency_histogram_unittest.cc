@@ -0,0 +1,121 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include "latency_histogram.h"
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace isc;
+using namespace isc::perfdhcp;
+
+namespace {
+
+// Test that the values are mapped to the buckets which report them with
+// the expected precision.
+TEST(LatencyHistogram, buckets) {
+    // Low values are counted exactly.
+    for (uint64_t value = 0; value < LatencyHistogram::SUB_BUCKETS_NUM;
+         ++value) {
+        EXPECT_EQ(value, LatencyHistogram::getBucketIndex(value));
+        EXPECT_EQ(value, LatencyHistogram::getBucketValue(value));
+    }
+    // Two consecutive values share the bucket above.
+    EXPECT_EQ(128, LatencyHistogram::getBucketIndex(128));
+    EXPECT_EQ(128, LatencyHistogram::getBucketIndex(129));
+    EXPECT_EQ(129, LatencyHistogram::getBucketValue(128));
+    EXPECT_EQ(129, LatencyHistogram::getBucketIndex(130));
+
+    // The value reported by the bucket is not lower than the value, and
+    // it is higher by less than 1/64 of the value.
+    uint64_t values[] = { 1000, 12345, 1000000, 987654321,
+                          std::numeric_limits<uint64_t>::max() / 3 };
+    for (int i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        uint64_t reported =
+            LatencyHistogram::getBucketValue(LatencyHistogram::
+                                             getBucketIndex(values[i]));
+        EXPECT_GE(reported, values[i]);
+        EXPECT_LT(reported - values[i], values[i] / 64);
+    }
+
+    // The highest value fits into the last bucket.
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+    EXPECT_EQ(max, LatencyHistogram::getBucketValue(LatencyHistogram::
+                                                    getBucketIndex(max)));
+    EXPECT_LT(LatencyHistogram::getBucketIndex(max), 4000);
+}
+
+// Test that percentiles are calculated from the recorded values.
+TEST(LatencyHistogram, percentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getMin());
+    EXPECT_EQ(0, histogram.getMax());
+    EXPECT_THROW(histogram.getValueAtPercentile(50), InvalidOperation);
+
+    // Record the values from 1 to 100 in the reversed order.
+    for (uint64_t value = 100; value > 0; --value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(100, histogram.getCount());
+    EXPECT_EQ(1, histogram.getMin());
+    EXPECT_EQ(100, histogram.getMax());
+    EXPECT_EQ(1, histogram.getValueAtPercentile(0));
+    EXPECT_EQ(50, histogram.getValueAtPercentile(50));
+    EXPECT_EQ(95, histogram.getValueAtPercentile(95));
+    EXPECT_EQ(99, histogram.getValueAtPercentile(99));
+    EXPECT_EQ(100, histogram.getValueAtPercentile(99.9));
+    EXPECT_EQ(100, histogram.getValueAtPercentile(100));
+
+    EXPECT_THROW(histogram.getValueAtPercentile(-1), BadValue);
+    EXPECT_THROW(histogram.getValueAtPercentile(100.1), BadValue);
+
+    // A single outlier is only visible at the highest percentiles. The
+    // reported value is not higher than the maximum.
+    histogram.record(5000000);
+    EXPECT_EQ(100, histogram.getValueAtPercentile(99));
+    EXPECT_EQ(5000000, histogram.getValueAtPercentile(99.9));
+    EXPECT_EQ(5000000, histogram.getMax());
+}
+
+// Test that histograms are merged and reset.
+TEST(LatencyHistogram, mergeAndReset) {
+    LatencyHistogram histogram1;
+    LatencyHistogram histogram2;
+    histogram1.record(10);
+    histogram1.record(20);
+    histogram2.record(5);
+    histogram2.record(1000000);
+
+    histogram1.merge(histogram2);
+    EXPECT_EQ(4, histogram1.getCount());
+    EXPECT_EQ(5, histogram1.getMin());
+    EXPECT_EQ(1000000, histogram1.getMax());
+    EXPECT_EQ(10, histogram1.getValueAtPercentile(50));
+    EXPECT_EQ(histogram2.getBucketsNum(), histogram1.getBucketsNum());
+
+    // Merging the empty histogram doesn't change anything.
+    histogram1.merge(LatencyHistogram());
+    EXPECT_EQ(4, histogram1.getCount());
+    EXPECT_EQ(5, histogram1.getMin());
+
+    histogram1.reset();
+    EXPECT_EQ(0, histogram1.getCount());
+    EXPECT_EQ(0, histogram1.getMin());
+    EXPECT_EQ(0, histogram1.getMax());
+    EXPECT_EQ(0, histogram1.getBucketsNum());
+}
+
+}
@@ -169,6 +169,29 @@ TEST_F(PacketStorageTest, getNextAndRandom) {
     EXPECT_FALSE(storage_.getNext());
 }
 
+// This test verifies that the oldest packet can be checked without
+// removing it and then removed with clear().
+TEST_F(PacketStorageTest, peekFirst) {
+    for (int i = 0; i < STORAGE_SIZE; ++i) {
+        Pkt6Ptr packet = storage_.peekFirst();
+        ASSERT_TRUE(packet);
+        EXPECT_EQ(i, packet->getTransid());
+        // The packet is still there.
+        EXPECT_EQ(STORAGE_SIZE - i, storage_.size());
+        EXPECT_EQ(i, storage_.peekFirst()->getTransid());
+        storage_.clear(1);
+    }
+    EXPECT_TRUE(storage_.empty());
+    EXPECT_FALSE(storage_.peekFirst());
+
+    // The packets appended to the empty storage are in order too.
+    storage_.append(createPacket6(DHCPV6_REPLY, 100));
+    storage_.append(createPacket6(DHCPV6_REPLY, 101));
+    EXPECT_EQ(100, storage_.peekFirst()->getTransid());
+    EXPECT_EQ(100, storage_.getNext()->getTransid());
+    EXPECT_EQ(101, storage_.peekFirst()->getTransid());
+}
+
 // This test verifies that all packets are removed from the storage when
 // clear() function is invoked.
 TEST_F(PacketStorageTest, clearAll) {
@@ -0,0 +1,124 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "../prepared_packet.h"
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/option.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::perfdhcp;
+
+namespace {
+
+/// \brief Creates the packed DHCPv4 DISCOVER message.
+Pkt4Ptr createDiscover(const uint32_t transid) {
+    Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, transid));
+    const uint8_t mac[] = { 0, 1, 2, 3, 4, 5 };
+    pkt->setHWAddr(HTYPE_ETHER, sizeof(mac),
+                   std::vector<uint8_t>(mac, mac + sizeof(mac)));
+    pkt->addOption(OptionPtr(new Option(Option::V4,
+                                        DHO_DHCP_REQUESTED_ADDRESS,
+                                        OptionBuffer(4, 10))));
+    pkt->pack();
+    return (pkt);
+}
+
+/// \brief Creates the packed DHCPv6 SOLICIT message.
+Pkt6Ptr createSolicit(const uint32_t transid) {
+    Pkt6Ptr pkt(new Pkt6(DHCPV6_SOLICIT, transid));
+    pkt->addOption(OptionPtr(new Option(Option::V6, D6O_ELAPSED_TIME,
+                                        OptionBuffer(2, 0))));
+    pkt->addOption(OptionPtr(new Option(Option::V6, D6O_CLIENTID,
+                                        OptionBuffer(14, 1))));
+    pkt->pack();
+    return (pkt);
+}
+
+// Test that the packet must be packed to be prepared.
+TEST(PreparedPacketTest, constructor) {
+    Pkt4Ptr pkt4;
+    EXPECT_THROW(PreparedPacket<Pkt4> prepared(pkt4), BadValue);
+    pkt4.reset(new Pkt4(DHCPDISCOVER, 1));
+    EXPECT_THROW(PreparedPacket<Pkt4> prepared(pkt4), BadValue);
+    pkt4->pack();
+    EXPECT_NO_THROW(PreparedPacket<Pkt4> prepared(pkt4));
+}
+
+// Test that the patched DHCPv4 packet parses to the same packet as the
+// one built with the new fields.
+TEST(PreparedPacketTest, patch4) {
+    PreparedPacket<Pkt4> prepared(createDiscover(1));
+    prepared.setTransid(0x01020304);
+    EXPECT_EQ(0x01020304, prepared.getPacket()->getTransid());
+
+    size_t length = 0;
+    const size_t offset =
+        prepared.getOptionDataOffset(DHO_DHCP_REQUESTED_ADDRESS, length);
+    ASSERT_EQ(4, length);
+    prepared.writeUint32At(0xC0000201, offset);
+    EXPECT_THROW(prepared.getOptionDataOffset(DHO_DHCP_SERVER_IDENTIFIER,
+                                              length), BadValue);
+
+    const util::OutputBuffer& buf = prepared.getPacket()->getBuffer();
+    Pkt4 parsed(static_cast<const uint8_t*>(buf.getData()), buf.getLength());
+    ASSERT_NO_THROW(parsed.unpack());
+    EXPECT_EQ(0x01020304, parsed.getTransid());
+    OptionPtr opt = parsed.getOption(DHO_DHCP_REQUESTED_ADDRESS);
+    ASSERT_TRUE(opt);
+    const uint8_t expected[] = { 192, 0, 2, 1 };
+    EXPECT_TRUE(opt->getData() ==
+                OptionBuffer(expected, expected + sizeof(expected)));
+}
+
+// Test that the patched DHCPv6 packet parses to the same packet as the
+// one built with the new fields.
+TEST(PreparedPacketTest, patch6) {
+    PreparedPacket<Pkt6> prepared(createSolicit(1));
+    // Only 24 bits of the transaction id are sent.
+    prepared.setTransid(0xFF123456);
+    EXPECT_EQ(0x123456, prepared.getPacket()->getTransid());
+
+    size_t length = 0;
+    const size_t offset = prepared.getOptionDataOffset(D6O_CLIENTID, length);
+    ASSERT_EQ(14, length);
+    const OptionBuffer duid(14, 7);
+    prepared.writeAt(offset, duid);
+
+    const util::OutputBuffer& buf = prepared.getPacket()->getBuffer();
+    Pkt6 parsed(static_cast<const uint8_t*>(buf.getData()), buf.getLength());
+    ASSERT_NO_THROW(parsed.unpack());
+    EXPECT_EQ(0x123456, parsed.getTransid());
+    OptionPtr opt = parsed.getOption(D6O_CLIENTID);
+    ASSERT_TRUE(opt);
+    EXPECT_TRUE(opt->getData() == duid);
+    EXPECT_TRUE(parsed.getOption(D6O_ELAPSED_TIME));
+}
+
+// Test that the data can't be written past the end of the packet.
+TEST(PreparedPacketTest, outOfRange) {
+    PreparedPacket<Pkt6> prepared(createSolicit(1));
+    const size_t size = prepared.getPacket()->getBuffer().getLength();
+    EXPECT_NO_THROW(prepared.writeUint16At(1, size - 2));
+    EXPECT_THROW(prepared.writeUint16At(1, size - 1), OutOfRange);
+    EXPECT_THROW(prepared.writeUint32At(1, size - 3), OutOfRange);
+    EXPECT_THROW(prepared.writeAt(size, OptionBuffer(1, 0)), OutOfRange);
+}
+
+}
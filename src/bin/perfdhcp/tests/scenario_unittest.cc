@@ -0,0 +1,165 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <cc/data.h>
+#include "scenario.h"
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::perfdhcp;
+
+namespace {
+
+/// \brief Creates the scenario from its JSON representation.
+///
+/// \param json scenario in JSON.
+/// \return created scenario.
+ScenarioPtr
+createScenario(const std::string& json) {
+    return (ScenarioPtr(new Scenario(Element::fromJSON(json))));
+}
+
+// Test that all parameters of the phases are parsed.
+TEST(ScenarioTest, parse) {
+    ScenarioPtr scenario;
+    ASSERT_NO_THROW(scenario = createScenario(
+        "{ \"phases\": ["
+        "    { \"name\": \"morning\", \"duration\": 600,"
+        "      \"rate\": [ [ 0, 100 ], [ 600, 1000 ] ],"
+        "      \"clients\": 50000,"
+        "      \"relays\": [ \"192.0.2.1\", \"192.0.2.2\" ],"
+        "      \"templates\": [ \"discover.hex\", \"request.hex\" ] },"
+        "    { \"duration\": 0.5, \"rate\": 0,"
+        "      \"renew-rate\": 10, \"release-rate\": 5,"
+        "      \"renew-after\": 30 }"
+        "] }"));
+    ASSERT_EQ(2, scenario->getPhasesNum());
+
+    const ScenarioPhase& morning = scenario->getPhase(0);
+    EXPECT_EQ("morning", morning.name_);
+    EXPECT_DOUBLE_EQ(600, morning.duration_);
+    ASSERT_EQ(2, morning.rate_curve_.size());
+    EXPECT_EQ(50000, morning.clients_num_);
+    ASSERT_EQ(2, morning.relays_.size());
+    EXPECT_EQ("192.0.2.1", morning.relays_[0].toText());
+    EXPECT_EQ("192.0.2.2", morning.relays_[1].toText());
+    ASSERT_EQ(2, morning.template_files_.size());
+    EXPECT_EQ("request.hex", morning.template_files_[1]);
+    EXPECT_EQ(0, morning.renew_rate_);
+    EXPECT_DOUBLE_EQ(0, morning.renew_after_);
+
+    // The phase without name is named after its position.
+    const ScenarioPhase& renewals = scenario->getPhase(1);
+    EXPECT_EQ("phase-2", renewals.name_);
+    EXPECT_DOUBLE_EQ(0.5, renewals.duration_);
+    EXPECT_EQ(0, renewals.getRate(0));
+    EXPECT_EQ(0, renewals.clients_num_);
+    EXPECT_TRUE(renewals.relays_.empty());
+    EXPECT_TRUE(renewals.template_files_.empty());
+    EXPECT_EQ(10, renewals.renew_rate_);
+    EXPECT_EQ(5, renewals.release_rate_);
+    EXPECT_DOUBLE_EQ(30, renewals.renew_after_);
+
+    EXPECT_TRUE(scenario->hasRenews());
+    EXPECT_TRUE(scenario->hasReleases());
+    EXPECT_TRUE(scenario->hasRelays());
+}
+
+// Test that the rate is interpolated between the points of the curve.
+TEST(ScenarioTest, rateCurve) {
+    ScenarioPtr scenario = createScenario(
+        "{ \"phases\": ["
+        "    { \"duration\": 100,"
+        "      \"rate\": [ [ 10, 100 ], [ 20, 200 ], [ 50, 50 ] ] },"
+        "    { \"duration\": 10, \"rate\": 300 }"
+        "] }");
+    const ScenarioPhase& curve = scenario->getPhase(0);
+    // The rate before the first point is the rate of the first point.
+    EXPECT_EQ(100, curve.getRate(0));
+    EXPECT_EQ(100, curve.getRate(10));
+    EXPECT_EQ(150, curve.getRate(15));
+    EXPECT_EQ(200, curve.getRate(20));
+    EXPECT_EQ(125, curve.getRate(35));
+    // The rate after the last point is the rate of the last point.
+    EXPECT_EQ(50, curve.getRate(50));
+    EXPECT_EQ(50, curve.getRate(99));
+
+    const ScenarioPhase& constant = scenario->getPhase(1);
+    EXPECT_EQ(300, constant.getRate(0));
+    EXPECT_EQ(300, constant.getRate(9.9));
+
+    EXPECT_FALSE(scenario->hasRenews());
+    EXPECT_FALSE(scenario->hasReleases());
+    EXPECT_FALSE(scenario->hasRelays());
+}
+
+// Test that invalid scenarios are rejected.
+TEST(ScenarioTest, invalid) {
+    // The scenario must have phases.
+    EXPECT_THROW(createScenario("[ ]"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ ] }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ ], \"foo\": 1 }"),
+                 InvalidScenario);
+    // The duration and the rate are mandatory.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"rate\": 1 } ] }"),
+                 InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1 } ] }"),
+                 InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 0,"
+                                " \"rate\": 1 } ] }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": -1,"
+                                " \"rate\": 1 } ] }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": \"1\","
+                                " \"rate\": 1 } ] }"), InvalidScenario);
+    // The rates are non-negative integers.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": -1 } ] }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1.5 } ] }"), InvalidScenario);
+    // The points of the rate curve are ordered by time.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": [ ] } ] }"), InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": [ [ 1 ] ] } ] }"),
+                 InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": [ [ 1, 10 ], [ 1, 20 ] ] } ] }"),
+                 InvalidScenario);
+    // The relays are IPv4 addresses.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1, \"relays\": [ \"foo\" ] } ] }"),
+                 InvalidScenario);
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1, \"relays\": [ \"2001:db8::1\""
+                                " ] } ] }"), InvalidScenario);
+    // At most two templates.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1, \"templates\": [ \"a\", \"b\","
+                                " \"c\" ] } ] }"), InvalidScenario);
+    // The renewals after the specified time need the renew rate.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1, \"renew-after\": 10 } ] }"),
+                 InvalidScenario);
+    // Unknown parameters are rejected to catch typos.
+    EXPECT_THROW(createScenario("{ \"phases\": [ { \"duration\": 1,"
+                                " \"rate\": 1, \"client\": 10 } ] }"),
+                 InvalidScenario);
+}
+
+}
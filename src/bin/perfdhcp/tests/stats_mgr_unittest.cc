@@ -364,6 +364,43 @@ TEST_F(StatsMgrTest, Orphans) {
     EXPECT_EQ(packets_num / 2, stats_mgr->getOrphans(StatsMgr4::XCHG_DO));
 }
 
+TEST_F(StatsMgrTest, Collected) {
+    boost::scoped_ptr<StatsMgr4> stats_mgr(new StatsMgr4());
+    // The packets are assumed dropped after 10ms.
+    stats_mgr->addExchangeStats(StatsMgr4::XCHG_DO, 0.01);
+
+    for (int i = 0; i < 5; ++i) {
+        boost::shared_ptr<Pkt4> sent_packet(createPacket4(DHCPDISCOVER, i));
+        ASSERT_NO_THROW(
+            stats_mgr->passSentPacket(StatsMgr4::XCHG_DO, sent_packet)
+        );
+    }
+    // The response to the first packet is received on time and the
+    // time of the sent packet is returned.
+    boost::shared_ptr<Pkt4> rcvd_packet(createPacket4(DHCPOFFER, 0));
+    uint64_t sent_time = 0;
+    EXPECT_TRUE(stats_mgr->passRcvdPacket(StatsMgr4::XCHG_DO, rcvd_packet,
+                                          &sent_time));
+    EXPECT_GT(sent_time, 0);
+    EXPECT_LE(sent_time, rcvd_packet->getMonotonicTimestamp());
+
+    // The remaining packets time out and they are collected when the
+    // next packet is sent.
+    usleep(20000);
+    boost::shared_ptr<Pkt4> sent_packet(createPacket4(DHCPDISCOVER, 5));
+    ASSERT_NO_THROW(stats_mgr->passSentPacket(StatsMgr4::XCHG_DO,
+                                              sent_packet));
+    EXPECT_EQ(4, stats_mgr->getCollectedNum(StatsMgr4::XCHG_DO));
+
+    // The late responses are orphans.
+    rcvd_packet.reset(createPacket4(DHCPOFFER, 1));
+    EXPECT_FALSE(stats_mgr->passRcvdPacket(StatsMgr4::XCHG_DO, rcvd_packet));
+    EXPECT_EQ(1, stats_mgr->getOrphans(StatsMgr4::XCHG_DO));
+    rcvd_packet.reset(createPacket4(DHCPOFFER, 5));
+    EXPECT_TRUE(stats_mgr->passRcvdPacket(StatsMgr4::XCHG_DO, rcvd_packet));
+    EXPECT_EQ(2, stats_mgr->getRcvdPacketsNum(StatsMgr4::XCHG_DO));
+}
+
 TEST_F(StatsMgrTest, Delays) {
 
     boost::shared_ptr<StatsMgr4> stats_mgr(new StatsMgr4());
@@ -434,6 +471,185 @@ TEST_F(StatsMgrTest, CustomCounters) {
 
 }
 
+TEST_F(StatsMgrTest, Merge) {
+    boost::scoped_ptr<StatsMgr4> stats_mgr(new StatsMgr4());
+    stats_mgr->addExchangeStats(StatsMgr4::XCHG_DO);
+    stats_mgr->addCustomCounter("latesend", "Late sent packets");
+    stats_mgr->incrementCounter("latesend", 2);
+
+    boost::scoped_ptr<StatsMgr4> other(new StatsMgr4());
+    other->addExchangeStats(StatsMgr4::XCHG_DO);
+    other->addCustomCounter("latesend", "Late sent packets");
+    other->addCustomCounter("shortwait", "Short waits for packets");
+    other->incrementCounter("latesend", 3);
+    other->incrementCounter("shortwait");
+
+    // Pass 10 packets to the first Statistics Manager and receive 6 of
+    // them. Pass 4 packets to the other one and receive all of them.
+    const unsigned int packets_num = 10;
+    for (unsigned int i = 0; i < packets_num; ++i) {
+        boost::shared_ptr<Pkt4> sent_packet(createPacket4(DHCPDISCOVER, i));
+        ASSERT_NO_THROW(stats_mgr->passSentPacket(StatsMgr4::XCHG_DO,
+                                                  sent_packet));
+    }
+    for (unsigned int i = 0; i < 6; ++i) {
+        boost::shared_ptr<Pkt4> rcvd_packet(createPacket4(DHCPOFFER, i));
+        ASSERT_NO_THROW(stats_mgr->passRcvdPacket(StatsMgr4::XCHG_DO,
+                                                  rcvd_packet));
+    }
+    for (unsigned int i = 0; i < 4; ++i) {
+        boost::shared_ptr<Pkt4> sent_packet(createPacket4(DHCPDISCOVER, 100 + i));
+        ASSERT_NO_THROW(other->passSentPacket(StatsMgr4::XCHG_DO,
+                                              sent_packet));
+        boost::shared_ptr<Pkt4> rcvd_packet(createPacket4(DHCPOFFER, 100 + i));
+        ASSERT_NO_THROW(other->passRcvdPacket(StatsMgr4::XCHG_DO,
+                                              rcvd_packet));
+    }
+    // Orphan packet.
+    boost::shared_ptr<Pkt4> orphan(createPacket4(DHCPOFFER, 1000));
+    ASSERT_NO_THROW(other->passRcvdPacket(StatsMgr4::XCHG_DO, orphan));
+
+    ASSERT_NO_THROW(stats_mgr->merge(*other));
+
+    EXPECT_EQ(14, stats_mgr->getSentPacketsNum(StatsMgr4::XCHG_DO));
+    // The delays of packets received by both Statistics Managers are
+    // accumulated.
+    EXPECT_NO_THROW(stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 50));
+    EXPECT_EQ(10, stats_mgr->getRcvdPacketsNum(StatsMgr4::XCHG_DO));
+    EXPECT_EQ(4, stats_mgr->getDroppedPacketsNum(StatsMgr4::XCHG_DO));
+    EXPECT_EQ(1, stats_mgr->getOrphans(StatsMgr4::XCHG_DO));
+    EXPECT_EQ(5, stats_mgr->getCounter("latesend")->getValue());
+    EXPECT_EQ(1, stats_mgr->getCounter("shortwait")->getValue());
+
+    // The merged Statistics Manager must not be modified.
+    EXPECT_EQ(4, other->getSentPacketsNum(StatsMgr4::XCHG_DO));
+    EXPECT_EQ(3, other->getCounter("latesend")->getValue());
+
+    // The exchange tracked by the other Statistics Manager must be
+    // tracked by the merging one.
+    other->addExchangeStats(StatsMgr4::XCHG_RA);
+    EXPECT_THROW(stats_mgr->merge(*other), isc::BadValue);
+}
+
+TEST_F(StatsMgrTest, DelayPercentiles) {
+    boost::scoped_ptr<StatsMgr4> stats_mgr(new StatsMgr4());
+    stats_mgr->addExchangeStats(StatsMgr4::XCHG_DO);
+
+    // There are no delays without received packets.
+    EXPECT_THROW(stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 50),
+                 isc::InvalidOperation);
+    EXPECT_THROW(stats_mgr->getDelayPercentile(StatsMgr4::XCHG_RA, 50),
+                 isc::BadValue);
+
+    const unsigned int packets_num = 10;
+    for (unsigned int i = 0; i < packets_num; ++i) {
+        boost::shared_ptr<Pkt4> sent_packet(createPacket4(DHCPDISCOVER, i));
+        ASSERT_NO_THROW(stats_mgr->passSentPacket(StatsMgr4::XCHG_DO,
+                                                  sent_packet));
+        boost::shared_ptr<Pkt4> rcvd_packet(createPacket4(DHCPOFFER, i));
+        ASSERT_NO_THROW(stats_mgr->passRcvdPacket(StatsMgr4::XCHG_DO,
+                                                  rcvd_packet));
+    }
+
+    // The percentiles are ordered and bounded by the minimum and maximum
+    // delay. The histogram reports the delays with microsecond precision
+    // at worst, so the comparisons allow for that.
+    double p50 = stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 50);
+    double p99 = stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 99);
+    double p999 = stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 99.9);
+    EXPECT_LE(p50, p99);
+    EXPECT_LE(p99, p999);
+    EXPECT_GE(p50, stats_mgr->getMinDelay(StatsMgr4::XCHG_DO) - 1e-6);
+    EXPECT_LE(p999, stats_mgr->getMaxDelay(StatsMgr4::XCHG_DO) + 1e-6);
+    EXPECT_THROW(stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO, 101),
+                 isc::BadValue);
+
+    // Starting new interval doesn't affect the statistics since the
+    // start of the test.
+    EXPECT_NO_THROW(stats_mgr->printIntermediateStats());
+    stats_mgr->startInterval();
+    EXPECT_DOUBLE_EQ(p50, stats_mgr->getDelayPercentile(StatsMgr4::XCHG_DO,
+                                                        50));
+    EXPECT_NO_THROW(stats_mgr->printIntermediateStats());
+}
+
+TEST_F(StatsMgrTest, Phases) {
+    boost::shared_ptr<StatsMgr6> stats_mgr(new StatsMgr6());
+    stats_mgr->addExchangeStats(StatsMgr6::XCHG_SA);
+    EXPECT_TRUE(stats_mgr->getPhaseName().empty());
+
+    // Exchange 5 packets before the phase is started.
+    passMultiplePackets6(stats_mgr, StatsMgr6::XCHG_SA, DHCPV6_SOLICIT, 5);
+    passMultiplePackets6(stats_mgr, StatsMgr6::XCHG_SA, DHCPV6_ADVERTISE, 5,
+                         true);
+
+    // Starting the phase doesn't affect the statistics since the start
+    // of the test.
+    stats_mgr->startPhase("storm");
+    EXPECT_EQ("storm", stats_mgr->getPhaseName());
+    EXPECT_EQ(5, stats_mgr->getSentPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(5, stats_mgr->getRcvdPacketsNum(StatsMgr6::XCHG_SA));
+
+    // Send 3 packets in the phase and receive responses to 2 of them.
+    for (uint32_t transid = 10; transid < 13; ++transid) {
+        boost::shared_ptr<Pkt6> sent_packet(createPacket6(DHCPV6_SOLICIT,
+                                                          transid));
+        ASSERT_NO_THROW(stats_mgr->passSentPacket(StatsMgr6::XCHG_SA,
+                                                  sent_packet));
+        if (transid < 12) {
+            boost::shared_ptr<Pkt6>
+                rcvd_packet(createPacket6(DHCPV6_ADVERTISE, transid));
+            ASSERT_NO_THROW(stats_mgr->passRcvdPacket(StatsMgr6::XCHG_SA,
+                                                      rcvd_packet));
+        }
+    }
+    EXPECT_EQ(8, stats_mgr->getSentPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(7, stats_mgr->getRcvdPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(3, stats_mgr->getPhaseSentPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(2, stats_mgr->getPhaseRcvdPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(1, stats_mgr->getPhaseDroppedPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_NO_THROW(stats_mgr->printPhaseStats());
+    EXPECT_NO_THROW(stats_mgr->printCsvStats(SCOPE_PHASE));
+    EXPECT_NO_THROW(stats_mgr->printJsonStats(SCOPE_PHASE));
+
+    // The next phase starts counting from zero.
+    stats_mgr->startPhase("idle");
+    EXPECT_EQ("idle", stats_mgr->getPhaseName());
+    EXPECT_EQ(0, stats_mgr->getPhaseSentPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(0, stats_mgr->getPhaseRcvdPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_NO_THROW(stats_mgr->printPhaseStats());
+}
+
+TEST_F(StatsMgrTest, PrintPhaseName) {
+    boost::shared_ptr<StatsMgr6> stats_mgr(new StatsMgr6());
+    stats_mgr->addExchangeStats(StatsMgr6::XCHG_SA);
+    const std::string name("say \"hi\", \\o/");
+    stats_mgr->startPhase(name);
+
+    // Capture the output, checking the format of std::cout is restored.
+    std::ostringstream out;
+    std::streambuf* buf = std::cout.rdbuf(out.rdbuf());
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    stats_mgr->printJsonStats(SCOPE_PHASE);
+    const std::string json = out.str();
+    out.str("");
+    stats_mgr->printCsvStats(SCOPE_PHASE);
+    const std::string csv = out.str();
+    const bool format_kept = (std::cout.flags() == flags) &&
+        (std::cout.precision() == precision);
+    std::cout.rdbuf(buf);
+    EXPECT_TRUE(format_kept);
+
+    // The phase name is escaped in JSON and quoted in CSV.
+    isc::data::ConstElementPtr stats;
+    ASSERT_NO_THROW(stats = isc::data::Element::fromJSON(json));
+    ASSERT_TRUE(stats->get("phase"));
+    EXPECT_EQ(name, stats->get("phase")->stringValue());
+    EXPECT_NE(std::string::npos,
+              csv.find(",phase,\"say \"\"hi\"\", \\o/\",SOLICIT-"));
+}
+
 TEST_F(StatsMgrTest, PrintStats) {
     std::cout << "This unit test is checking statistics printing "
               << "capabilities. It is expected that some counters "
@@ -455,6 +671,13 @@ TEST_F(StatsMgrTest, PrintStats) {
     // exchange needed to count the average delay and std deviation.
     EXPECT_NO_THROW(stats_mgr->printStats());
 
+    // The statistics can be also printed in the machine readable formats.
+    EXPECT_NO_THROW(StatsMgr6::printCsvHeader());
+    EXPECT_NO_THROW(stats_mgr->printCsvStats(SCOPE_INTERVAL));
+    EXPECT_NO_THROW(stats_mgr->printCsvStats(SCOPE_TOTAL));
+    EXPECT_NO_THROW(stats_mgr->printJsonStats(SCOPE_INTERVAL));
+    EXPECT_NO_THROW(stats_mgr->printJsonStats(SCOPE_TOTAL));
+
     // Printing timestamps is expected to fail because by default we
     // disable packets archiving mode. Without packets we can't get
     // timestamps.
@@ -14,12 +14,15 @@
 
 #include "command_options_helper.h"
 #include "../test_control.h"
+#include "../test_shard.h"
 
 #include <asiolink/io_address.h>
 #include <exceptions/exceptions.h>
 #include <dhcp/dhcp4.h>
 #include <dhcp/iface_mgr.h>
+#include <util/threads/thread.h>
 
+#include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <cstddef>
@@ -27,6 +30,9 @@
 #include <string>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace boost::posix_time;
@@ -141,6 +147,19 @@ public:
 
 };
 
+/// \brief Test Shard class with protected members made public.
+class NakedTestShard : public TestShard {
+public:
+    NakedTestShard(const unsigned int index, const unsigned int shards_num)
+        : TestShard(index, shards_num) {
+    }
+
+    using TestShard::basic_rate_control_;
+    using TestShard::generateMacAddress;
+    using TestShard::generateTransid;
+    using TestShard::sendDiscover4;
+};
+
 /// \brief Test Fixture Class
 ///
 /// This test fixture class is used to perform
@@ -1602,3 +1621,119 @@ TEST_F(TestControlTest, getCurrentTimeoutRenewRelease) {
     EXPECT_LE(tc.getCurrentTimeout(), 5000000);
 
 }
+
+// This test verifies that the strided generator produces the numbers
+// giving the same remainder and wraps within the range.
+TEST_F(TestControlTest, StridedGenerator) {
+    TestControl::StridedGenerator generator(1, 3, 10);
+    EXPECT_EQ(1, generator.generate());
+    EXPECT_EQ(4, generator.generate());
+    EXPECT_EQ(7, generator.generate());
+    EXPECT_EQ(1, generator.generate());
+
+    // The offset out of range is wrapped.
+    TestControl::StridedGenerator wrapped(5, 2, 4);
+    EXPECT_EQ(1, wrapped.generate());
+    EXPECT_EQ(3, wrapped.generate());
+    EXPECT_EQ(1, wrapped.generate());
+
+    // The numbers don't exceed the default range.
+    TestControl::StridedGenerator large(0xFFFFFFFC, 2);
+    EXPECT_EQ(0xFFFFFFFC, large.generate());
+    EXPECT_EQ(0, large.generate() % 2);
+    EXPECT_EQ(0xFFFFFFFC, large.generate());
+
+    EXPECT_THROW(TestControl::StridedGenerator(0, 0), isc::BadValue);
+}
+
+// This test verifies that the exchanges are split between the parts of
+// the test run by the sender threads and that the receiver thread passes
+// the response to the part of the test which has sent the request.
+TEST_F(TestControlTest, Shards4) {
+    std::string loopback_iface(getLocalLoopback());
+    if (loopback_iface.empty()) {
+        std::cout << "Unable to find the loopback interface. Skip test."
+                  << std::endl;
+        return;
+    }
+    ASSERT_NO_THROW(processCmdLine("perfdhcp -l " + loopback_iface +
+                                   " -r 5 -R 10 -i -g 2 -L 10547"
+                                   " 127.0.0.1"));
+    NakedTestControl tc;
+    tc.registerOptionFactories();
+
+    EXPECT_THROW(NakedTestShard(2, 2), isc::BadValue);
+    boost::shared_ptr<NakedTestShard> shard0;
+    boost::shared_ptr<NakedTestShard> shard1;
+    ASSERT_NO_THROW(shard0.reset(new NakedTestShard(0, 2)));
+    ASSERT_NO_THROW(shard1.reset(new NakedTestShard(1, 2)));
+    TestShardCollection shards;
+    shards.push_back(shard0);
+    shards.push_back(shard1);
+
+    // The first shard sends the remainder of the rate.
+    EXPECT_EQ(3, shard0->basic_rate_control_.getRate());
+    EXPECT_EQ(2, shard1->basic_rate_control_.getRate());
+
+    // Transaction ids and MAC addresses are not shared between shards.
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(0, shard0->generateTransid() % 2);
+        EXPECT_EQ(1, shard1->generateTransid() % 2);
+    }
+    uint8_t randomized = 0;
+    std::vector<uint8_t> mac0 = shard0->generateMacAddress(randomized);
+    std::vector<uint8_t> mac1 = shard1->generateMacAddress(randomized);
+    EXPECT_NE(mac0[5], mac1[5]);
+
+    // Each shard sends DISCOVER with its first transaction id.
+    shard0->setTransidGenerator(TestControl::NumberGeneratorPtr(
+        new TestControl::StridedGenerator(0, 2)));
+    shard1->setTransidGenerator(TestControl::NumberGeneratorPtr(
+        new TestControl::StridedGenerator(1, 2)));
+    shard0->initializeStats();
+    shard1->initializeStats();
+    ASSERT_NO_THROW(shard0->sendDiscover4(shard0->getSocket()));
+    ASSERT_NO_THROW(shard1->sendDiscover4(shard1->getSocket()));
+
+    volatile bool stopping = false;
+    isc::util::thread::Thread
+        receiver(boost::bind(&TestShard::runReceiver, boost::cref(shards),
+                             &stopping));
+
+    // Send OFFER to the socket of the first shard with the transaction
+    // id of DISCOVER sent by the second shard, as the server does when
+    // it responds to the relay.
+    boost::shared_ptr<Pkt4> offer(createOfferPkt4(1));
+    ASSERT_NO_THROW(offer->pack());
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sock, 0);
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons(10547);
+    to.sin_addr.s_addr = htonl(static_cast<uint32_t>(shard0->getSocket().addr_));
+    ssize_t sent = sendto(sock, offer->getBuffer().getData(),
+                          offer->getBuffer().getLength(), 0,
+                          reinterpret_cast<struct sockaddr*>(&to), sizeof(to));
+    close(sock);
+    ASSERT_EQ(offer->getBuffer().getLength(), sent);
+
+    // Wait for the receiver thread to process the packet.
+    uint64_t rcvd0 = 0;
+    uint64_t rcvd1 = 0;
+    for (int i = 0; (i < 200) && (rcvd1 == 0); ++i) {
+        usleep(10000);
+        StatsMgr<Pkt4> stats0;
+        stats0.addExchangeStats(StatsMgr<Pkt4>::XCHG_DO);
+        shard0->mergeStats(stats0);
+        rcvd0 = stats0.getRcvdPacketsNum(StatsMgr<Pkt4>::XCHG_DO);
+        StatsMgr<Pkt4> stats1;
+        stats1.addExchangeStats(StatsMgr<Pkt4>::XCHG_DO);
+        shard1->mergeStats(stats1);
+        rcvd1 = stats1.getRcvdPacketsNum(StatsMgr<Pkt4>::XCHG_DO);
+    }
+    stopping = true;
+    ASSERT_NO_THROW(receiver.wait());
+    EXPECT_EQ(0, rcvd0);
+    EXPECT_EQ(1, rcvd1);
+}
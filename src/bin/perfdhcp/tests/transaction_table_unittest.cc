@@ -0,0 +1,136 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include "transaction_table.h"
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::perfdhcp;
+
+namespace {
+
+// Test that the maximum capacity is rounded up to the power of two.
+TEST(TransactionTableTest, constructor) {
+    TransactionTable table(1000);
+    EXPECT_EQ(1024, table.getMaxCapacity());
+    EXPECT_EQ(1024, table.getCapacity());
+    EXPECT_EQ(0, table.size());
+
+    TransactionTable large;
+    EXPECT_EQ(TransactionTable::DEFAULT_MAX_CAPACITY, large.getMaxCapacity());
+    EXPECT_GT(large.getMaxCapacity(), large.getCapacity());
+
+    EXPECT_THROW(TransactionTable(0), BadValue);
+}
+
+// Test that the transactions matched in order are found without the hash
+// table lookup and the record of the sent packet is returned.
+TEST(TransactionTableTest, removeNext) {
+    TransactionTable table;
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(0, table.insert(i * 7, 1, 1000 + i));
+    }
+    EXPECT_EQ(10, table.size());
+
+    Transaction transaction;
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(table.removeNext(i * 7, transaction));
+        EXPECT_EQ(i * 7, transaction.xid_);
+        EXPECT_EQ(1, transaction.type_);
+        EXPECT_EQ(1000 + i, transaction.timestamp_);
+    }
+    EXPECT_EQ(0, table.size());
+    EXPECT_FALSE(table.removeNext(0, transaction));
+}
+
+// Test that the transactions are found by their ids in any order, including
+// the ids colliding in the hash table.
+TEST(TransactionTableTest, remove) {
+    TransactionTable table;
+    const uint32_t xids[] = { 1, 1024, 2, 1025, 3, 0xFFFFFFFF, 0, 65536 };
+    const size_t xids_num = sizeof(xids) / sizeof(xids[0]);
+    for (size_t i = 0; i < xids_num; ++i) {
+        ASSERT_EQ(0, table.insert(xids[i], 3, i));
+    }
+
+    Transaction transaction;
+    size_t probes = 0;
+    for (size_t i = xids_num; i > 0; --i) {
+        ASSERT_TRUE(table.remove(xids[i - 1], transaction, probes));
+        EXPECT_EQ(xids[i - 1], transaction.xid_);
+        EXPECT_EQ(i - 1, transaction.timestamp_);
+        EXPECT_GT(probes, 0);
+        // The removed transaction is not found again.
+        EXPECT_FALSE(table.remove(xids[i - 1], transaction, probes));
+    }
+    EXPECT_EQ(0, table.size());
+}
+
+// Test that the table grows up to its maximum capacity and then evicts
+// the oldest transactions.
+TEST(TransactionTableTest, capacity) {
+    TransactionTable table(4096);
+    for (uint32_t i = 0; i < 4096; ++i) {
+        ASSERT_EQ(0, table.insert(i, 1, i));
+    }
+    EXPECT_EQ(4096, table.getCapacity());
+    EXPECT_EQ(4096, table.size());
+
+    // Every transaction above the capacity evicts the oldest one.
+    for (uint32_t i = 4096; i < 5000; ++i) {
+        ASSERT_EQ(1, table.insert(i, 1, i));
+    }
+    EXPECT_EQ(4096, table.size());
+
+    Transaction transaction;
+    size_t probes = 0;
+    EXPECT_FALSE(table.remove(903, transaction, probes));
+    EXPECT_TRUE(table.remove(904, transaction, probes));
+    EXPECT_TRUE(table.remove(4999, transaction, probes));
+    // All entries remain reachable after the evictions and removals.
+    for (uint32_t i = 905; i < 4999; ++i) {
+        ASSERT_TRUE(table.remove(i, transaction, probes)) << i;
+    }
+    EXPECT_EQ(0, table.size());
+}
+
+// Test that the transactions older than the specified time expire, while
+// the matched transactions are not counted as expired.
+TEST(TransactionTableTest, expire) {
+    TransactionTable table;
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(0, table.insert(i, 1, i * 10));
+    }
+    Transaction transaction;
+    size_t probes = 0;
+    ASSERT_TRUE(table.remove(5, transaction, probes));
+    ASSERT_TRUE(table.remove(50, transaction, probes));
+
+    // The transactions sent before time 200, except the matched one.
+    EXPECT_EQ(19, table.expire(200));
+    EXPECT_EQ(79, table.size());
+    EXPECT_EQ(0, table.expire(200));
+    EXPECT_FALSE(table.remove(19, transaction, probes));
+
+    // The next transaction follows the last matched one.
+    EXPECT_FALSE(table.removeNext(20, transaction));
+    EXPECT_TRUE(table.removeNext(51, transaction));
+    EXPECT_TRUE(table.removeNext(52, transaction));
+
+    EXPECT_EQ(77, table.expire(1000));
+    EXPECT_EQ(0, table.size());
+}
+
+}
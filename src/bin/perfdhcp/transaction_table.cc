@@ -0,0 +1,216 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include "transaction_table.h"
+
+namespace {
+
+/// \brief Initial capacity of the ring.
+const size_t INITIAL_CAPACITY = 1024;
+
+/// \brief Largest supported capacity of the ring.
+///
+/// The hash table is twice as large as the ring and its positions are
+/// derived from the 32-bit hash value.
+const size_t MAX_SUPPORTED_CAPACITY = static_cast<size_t>(1) << 30;
+
+/// \brief Maximum number of the completed transactions skipped while
+/// looking for the next outstanding transaction.
+const size_t MAX_SKIPPED = 64;
+
+}
+
+namespace isc {
+namespace perfdhcp {
+
+const size_t TransactionTable::DEFAULT_MAX_CAPACITY;
+
+TransactionTable::TransactionTable(const size_t max_capacity)
+    : ring_(), index_(), index_shift_(0), head_(0), tail_(0), next_(0),
+      size_(0), max_capacity_(1) {
+    if ((max_capacity == 0) || (max_capacity > MAX_SUPPORTED_CAPACITY)) {
+        isc_throw(BadValue, "maximum number of outstanding transactions "
+                  << max_capacity << " is out of range");
+    }
+    while (max_capacity_ < max_capacity) {
+        max_capacity_ <<= 1;
+    }
+    resize(max_capacity_ < INITIAL_CAPACITY ? max_capacity_ :
+           INITIAL_CAPACITY);
+}
+
+size_t
+TransactionTable::insert(const uint32_t xid, const uint8_t type,
+                         const uint64_t timestamp) {
+    size_t evicted = 0;
+    if (tail_ - head_ == ring_.size()) {
+        if (ring_.size() < max_capacity_) {
+            resize(ring_.size() << 1);
+        } else {
+            // The head is always outstanding, as the completed
+            // transactions are popped from the head immediately.
+            indexErase(slot(head_));
+            complete(slot(head_));
+            advanceHead();
+            ++evicted;
+        }
+    }
+    const size_t ring_slot = slot(tail_);
+    Transaction& transaction = ring_[ring_slot];
+    transaction.timestamp_ = timestamp;
+    transaction.xid_ = xid;
+    transaction.type_ = type;
+    transaction.outstanding_ = true;
+    indexInsert(ring_slot);
+    ++tail_;
+    ++size_;
+    return (evicted);
+}
+
+bool
+TransactionTable::removeNext(const uint32_t xid, Transaction& transaction) {
+    if (next_ < head_) {
+        next_ = head_;
+    }
+    // Skip the transactions completed by the out of order responses.
+    for (size_t skipped = 0; (next_ < tail_) &&
+             !ring_[slot(next_)].outstanding_; ++skipped) {
+        if (skipped == MAX_SKIPPED) {
+            return (false);
+        }
+        ++next_;
+    }
+    // Start over from the oldest transaction when the end is reached.
+    if (next_ == tail_) {
+        next_ = head_;
+    }
+    if (next_ == tail_) {
+        return (false);
+    }
+    const size_t ring_slot = slot(next_);
+    if (ring_[ring_slot].xid_ != xid) {
+        return (false);
+    }
+    transaction = ring_[ring_slot];
+    indexErase(ring_slot);
+    complete(ring_slot);
+    ++next_;
+    advanceHead();
+    return (true);
+}
+
+bool
+TransactionTable::remove(const uint32_t xid, Transaction& transaction,
+                         size_t& probes) {
+    probes = 0;
+    const size_t mask = index_.size() - 1;
+    for (size_t pos = home(xid); index_[pos] != 0; pos = (pos + 1) & mask) {
+        ++probes;
+        const size_t ring_slot = index_[pos] - 1;
+        if (ring_[ring_slot].xid_ == xid) {
+            transaction = ring_[ring_slot];
+            indexErase(ring_slot);
+            complete(ring_slot);
+            // The sequence number of the slot is the one between the
+            // head and the tail.
+            next_ = head_ + ((ring_slot - slot(head_)) & (ring_.size() - 1))
+                + 1;
+            advanceHead();
+            return (true);
+        }
+    }
+    return (false);
+}
+
+size_t
+TransactionTable::expire(const uint64_t timestamp) {
+    size_t expired = 0;
+    while ((head_ < tail_) && (ring_[slot(head_)].timestamp_ < timestamp)) {
+        indexErase(slot(head_));
+        complete(slot(head_));
+        advanceHead();
+        ++expired;
+    }
+    return (expired);
+}
+
+void
+TransactionTable::resize(const size_t capacity) {
+    std::vector<Transaction> ring(capacity);
+    const uint64_t mask = capacity - 1;
+    for (uint64_t seq = head_; seq < tail_; ++seq) {
+        ring[seq & mask] = ring_[slot(seq)];
+    }
+    ring_.swap(ring);
+
+    // The hash table is at most half full.
+    index_.assign(capacity << 1, 0);
+    index_shift_ = 32;
+    for (size_t size = 1; size < index_.size(); size <<= 1) {
+        --index_shift_;
+    }
+    for (uint64_t seq = head_; seq < tail_; ++seq) {
+        if (ring_[slot(seq)].outstanding_) {
+            indexInsert(slot(seq));
+        }
+    }
+}
+
+void
+TransactionTable::indexInsert(const size_t ring_slot) {
+    const size_t mask = index_.size() - 1;
+    size_t pos = home(ring_[ring_slot].xid_);
+    while (index_[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    index_[pos] = static_cast<uint32_t>(ring_slot + 1);
+}
+
+void
+TransactionTable::indexErase(const size_t ring_slot) {
+    const size_t mask = index_.size() - 1;
+    size_t pos = home(ring_[ring_slot].xid_);
+    while (index_[pos] != ring_slot + 1) {
+        pos = (pos + 1) & mask;
+    }
+    // Move back the entries following the removed one, unless their
+    // home positions are between the removed entry and their current
+    // positions, so as the probe sequences are not broken.
+    for (size_t next = (pos + 1) & mask; index_[next] != 0;
+         next = (next + 1) & mask) {
+        const size_t next_home = home(ring_[index_[next] - 1].xid_);
+        if (((next - next_home) & mask) >= ((next - pos) & mask)) {
+            index_[pos] = index_[next];
+            pos = next;
+        }
+    }
+    index_[pos] = 0;
+}
+
+void
+TransactionTable::complete(const size_t ring_slot) {
+    ring_[ring_slot].outstanding_ = false;
+    --size_;
+}
+
+void
+TransactionTable::advanceHead() {
+    while ((head_ < tail_) && !ring_[slot(head_)].outstanding_) {
+        ++head_;
+    }
+}
+
+} // namespace perfdhcp
+} // namespace isc
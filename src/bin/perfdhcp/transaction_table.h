@@ -0,0 +1,197 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef TRANSACTION_TABLE_H
+#define TRANSACTION_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace perfdhcp {
+
+/// \brief Outstanding transaction.
+///
+/// The compact record of the sent packet which is kept until the
+/// response is received or the transaction times out. It holds only
+/// the data needed to match the response and to measure the delay,
+/// so as millions of transactions may be outstanding.
+struct Transaction {
+    /// \brief Monotonic timestamp of the sent packet in nanoseconds.
+    uint64_t timestamp_;
+    /// \brief Transaction id of the sent packet.
+    uint32_t xid_;
+    /// \brief Message type of the sent packet.
+    uint8_t type_;
+    /// \brief Indicates if the transaction is still outstanding.
+    bool outstanding_;
+};
+
+/// \brief Table of the outstanding transactions.
+///
+/// The transactions are stored in the ring buffer in the order in which
+/// the packets have been sent, so the oldest transaction is always at the
+/// head of the ring. Because all transactions of the exchange time out
+/// after the same period, the ring works as a timing wheel: the expired
+/// transactions are popped from its head without scanning the rest of
+/// the table. The transactions which are matched with the responses are
+/// marked as completed and their slots are reclaimed when the head of
+/// the ring passes them.
+///
+/// The transactions are indexed by the full transaction id in the hash
+/// table using open addressing with linear probing. The table is kept
+/// at most half full, so the lookups are constant time, and the removed
+/// entries are back-shifted, so as the probe sequences never contain
+/// deleted entries.
+///
+/// The capacity of the ring starts small and doubles when it is full,
+/// up to the maximum capacity. When the maximum capacity is reached,
+/// the oldest transaction is evicted to make space for the new one, so
+/// the memory used by the table is bounded regardless of the number of
+/// the lost packets.
+class TransactionTable {
+public:
+
+    /// \brief Default maximum number of the outstanding transactions.
+    static const size_t DEFAULT_MAX_CAPACITY = 1 << 22;
+
+    /// \brief Constructor.
+    ///
+    /// \param max_capacity maximum number of the outstanding
+    /// transactions, rounded up to the power of two.
+    /// \throw isc::BadValue if the maximum capacity is 0 or too large.
+    explicit TransactionTable(const size_t max_capacity =
+                              DEFAULT_MAX_CAPACITY);
+
+    /// \brief Adds the transaction of the sent packet.
+    ///
+    /// \param xid transaction id of the sent packet.
+    /// \param type message type of the sent packet.
+    /// \param timestamp monotonic timestamp of the sent packet.
+    /// \return number of the oldest transactions evicted to make space
+    /// for the new one.
+    size_t insert(const uint32_t xid, const uint8_t type,
+                  const uint64_t timestamp);
+
+    /// \brief Removes the transaction following the last removed one.
+    ///
+    /// The responses are most often received in the order in which the
+    /// packets have been sent, so the transaction following the last
+    /// matched one is checked first, before looking it up in the hash
+    /// table.
+    ///
+    /// \param xid transaction id of the received packet.
+    /// \param [out] transaction removed transaction.
+    /// \return true if the next transaction has the transaction id.
+    bool removeNext(const uint32_t xid, Transaction& transaction);
+
+    /// \brief Finds the transaction in the hash table and removes it.
+    ///
+    /// \param xid transaction id of the received packet.
+    /// \param [out] transaction removed transaction.
+    /// \param [out] probes number of the entries of the hash table
+    /// checked during the lookup.
+    /// \return true if the transaction has been found.
+    bool remove(const uint32_t xid, Transaction& transaction,
+                size_t& probes);
+
+    /// \brief Removes the transactions sent before the specified time.
+    ///
+    /// \param timestamp monotonic time before which the transactions
+    /// are assumed to be lost.
+    /// \return number of the removed transactions.
+    size_t expire(const uint64_t timestamp);
+
+    /// \brief Returns the number of the outstanding transactions.
+    size_t size() const {
+        return (size_);
+    }
+
+    /// \brief Returns the current capacity of the ring.
+    size_t getCapacity() const {
+        return (ring_.size());
+    }
+
+    /// \brief Returns the maximum capacity of the ring.
+    size_t getMaxCapacity() const {
+        return (max_capacity_);
+    }
+
+private:
+
+    /// \brief Returns the home position of the transaction id in the
+    /// hash table.
+    size_t home(const uint32_t xid) const {
+        // Fibonacci hashing spreads the sequential transaction ids
+        // over the whole table.
+        return (static_cast<uint32_t>(xid * 2654435769U) >> index_shift_);
+    }
+
+    /// \brief Returns the ring slot of the sequence number.
+    size_t slot(const uint64_t seq) const {
+        return (static_cast<size_t>(seq & (ring_.size() - 1)));
+    }
+
+    /// \brief Resizes the ring and the hash table.
+    ///
+    /// \param capacity new capacity of the ring, power of two greater
+    /// than the number of the slots in use.
+    void resize(const size_t capacity);
+
+    /// \brief Adds the ring slot to the hash table.
+    void indexInsert(const size_t ring_slot);
+
+    /// \brief Removes the ring slot from the hash table.
+    void indexErase(const size_t ring_slot);
+
+    /// \brief Marks the transaction in the ring slot as completed.
+    void complete(const size_t ring_slot);
+
+    /// \brief Advances the head of the ring past the completed
+    /// transactions.
+    void advanceHead();
+
+    /// \brief Ring of the transactions ordered by the sequence number.
+    std::vector<Transaction> ring_;
+
+    /// \brief Hash table holding the ring slots incremented by one,
+    /// 0 marks the empty entry.
+    std::vector<uint32_t> index_;
+
+    /// \brief Shift of the hash value giving the position in the hash
+    /// table.
+    unsigned int index_shift_;
+
+    /// \brief Sequence number of the oldest transaction.
+    uint64_t head_;
+
+    /// \brief Sequence number of the next inserted transaction.
+    uint64_t tail_;
+
+    /// \brief Sequence number of the transaction checked first by
+    /// \ref removeNext.
+    uint64_t next_;
+
+    /// \brief Number of the outstanding transactions.
+    size_t size_;
+
+    /// \brief Maximum capacity of the ring.
+    size_t max_capacity_;
+};
+
+} // namespace perfdhcp
+} // namespace isc
+
+#endif // TRANSACTION_TABLE_H
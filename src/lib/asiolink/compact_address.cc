@@ -0,0 +1,125 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/compact_address.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/static_assert.hpp>
+
+#include <ostream>
+
+using namespace std;
+
+namespace isc {
+namespace asiolink {
+
+// The family is part of the value, so the address is as small as the
+// integer it holds.
+BOOST_STATIC_ASSERT(sizeof(CompactAddress) == 16);
+
+const uint64_t CompactAddress::V4_MAPPED;
+const uint64_t CompactAddress::V4_MAPPED_MASK;
+
+namespace {
+
+/// \brief Reads 64 bits in network byte order
+uint64_t
+readUint64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return (value);
+}
+
+/// \brief Writes 64 bits in network byte order
+void
+writeUint64(uint64_t value, uint8_t* data) {
+    for (int i = 7; i >= 0; --i) {
+        data[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+}
+
+CompactAddress::CompactAddress(const IOAddress& address) {
+    const asio::ip::address& asio_address = address.asio_address_;
+    if (asio_address.is_v4()) {
+        hi_ = 0;
+        lo_ = V4_MAPPED | asio_address.to_v4().to_ulong();
+    } else {
+        const asio::ip::address_v6::bytes_type bytes =
+            asio_address.to_v6().to_bytes();
+        hi_ = readUint64(&bytes[0]);
+        lo_ = readUint64(&bytes[8]);
+    }
+}
+
+CompactAddress
+CompactAddress::fromBytes(short family, const uint8_t* data) {
+    if (data == NULL) {
+        isc_throw(BadValue, "NULL pointer received.");
+    }
+    if (family == AF_INET) {
+        return (fromV4((static_cast<uint32_t>(data[0]) << 24) |
+                       (static_cast<uint32_t>(data[1]) << 16) |
+                       (static_cast<uint32_t>(data[2]) << 8) | data[3]));
+    } else if (family == AF_INET6) {
+        return (CompactAddress(readUint64(data), readUint64(data + 8)));
+    }
+    isc_throw(BadValue, "Invalid family type. Only AF_INET and AF_INET6 "
+              "are supported");
+}
+
+IOAddress
+CompactAddress::toIOAddress() const {
+    if (isV4()) {
+        return (IOAddress(toUint32()));
+    }
+    asio::ip::address_v6::bytes_type bytes;
+    writeUint64(hi_, &bytes[0]);
+    writeUint64(lo_, &bytes[8]);
+    return (IOAddress(asio::ip::address(asio::ip::address_v6(bytes))));
+}
+
+void
+CompactAddress::toBytes(uint8_t* data) const {
+    if (isV4()) {
+        const uint32_t address = toUint32();
+        data[0] = static_cast<uint8_t>(address >> 24);
+        data[1] = static_cast<uint8_t>(address >> 16);
+        data[2] = static_cast<uint8_t>(address >> 8);
+        data[3] = static_cast<uint8_t>(address);
+    } else {
+        toV6Bytes(data);
+    }
+}
+
+void
+CompactAddress::toV6Bytes(uint8_t* data) const {
+    writeUint64(hi_, data);
+    writeUint64(lo_, data + 8);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const CompactAddress& address) {
+    os << address.toIOAddress().toText();
+    return (os);
+}
+
+} // namespace asiolink
+} // namespace isc
@@ -0,0 +1,259 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef COMPACT_ADDRESS_H
+#define COMPACT_ADDRESS_H 1
+
+#include <asiolink/io_address.h>
+
+#include <cstddef>
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+namespace isc {
+namespace asiolink {
+
+/// \brief Compact IPv4 or IPv6 address
+///
+/// The address is held as a 128 bit unsigned integer (two 64 bit halves in
+/// host byte order), so it fits in 16 bytes and can be copied, compared,
+/// incremented and masked with a few integer operations and without
+/// allocating memory.  It is meant for the code which handles many
+/// addresses, like the allocation engine and the pools, which convert
+/// to and from \c IOAddress only when they take or return an address.
+///
+/// An IPv4 address is held as the IPv4-mapped IPv6 address (in ::ffff:0:0/96)
+/// and the family is derived from the value.  As a result, an IPv4-mapped
+/// IPv6 address given as an \c IOAddress is handled as an IPv4 address.
+/// Like the \c IOAddress, IPv4 addresses are smaller than all IPv6
+/// addresses.  Unlike the \c IOAddress, the scope identifier of IPv6
+/// addresses is not kept.
+class CompactAddress {
+public:
+    /// \brief Constructor
+    ///
+    /// Creates the IPv6 unspecified address (::).
+    CompactAddress() : hi_(0), lo_(0) {
+    }
+
+    /// \brief Constructor from an \c IOAddress
+    ///
+    /// \param address The address to be converted.
+    explicit CompactAddress(const IOAddress& address);
+
+    /// \brief Creates an IPv4 address
+    ///
+    /// \param address The address as an integer in host byte order, as
+    ///        returned by the conversion of an \c IOAddress to uint32_t.
+    static CompactAddress fromV4(const uint32_t address) {
+        return (CompactAddress(0, V4_MAPPED | address));
+    }
+
+    /// \brief Creates an address from its bytes
+    ///
+    /// \param family AF_INET for IPv4 or AF_INET6 for IPv6.
+    /// \param data Address in network byte order (4 or 16 bytes).
+    ///
+    /// \throw BadValue if the family is not supported.
+    static CompactAddress fromBytes(short family, const uint8_t* data);
+
+    /// \brief Converts the address to an \c IOAddress
+    IOAddress toIOAddress() const;
+
+    /// \brief Copies the bytes of the address
+    ///
+    /// \param data Buffer of at least \c getLength() bytes the address is
+    ///        written to in network byte order.
+    void toBytes(uint8_t* data) const;
+
+    /// \brief Copies the 16 bytes of the address
+    ///
+    /// Same as \c toBytes() for an IPv6 address.  An IPv4 address is written
+    /// as an IPv4-mapped IPv6 address.
+    ///
+    /// \param data Buffer of at least 16 bytes the address is written to in
+    ///        network byte order.
+    void toV6Bytes(uint8_t* data) const;
+
+    /// \brief Returns the length of the address in bytes (4 or 16)
+    size_t getLength() const {
+        return (isV4() ? V4ADDRESS_LEN : V6ADDRESS_LEN);
+    }
+
+    /// \brief Returns the number of bits of the address (32 or 128)
+    unsigned getBits() const {
+        return (isV4() ? 32 : 128);
+    }
+
+    /// \brief Returns the address family (AF_INET or AF_INET6)
+    short getFamily() const {
+        return (isV4() ? AF_INET : AF_INET6);
+    }
+
+    /// \brief Checks if this is an IPv4 address
+    bool isV4() const {
+        return ((hi_ == 0) && ((lo_ & V4_MAPPED_MASK) == V4_MAPPED));
+    }
+
+    /// \brief Checks if this is an IPv6 address
+    bool isV6() const {
+        return (!isV4());
+    }
+
+    /// \brief Returns an IPv4 address as an integer in host byte order
+    uint32_t toUint32() const {
+        return (static_cast<uint32_t>(lo_));
+    }
+
+    /// \brief Returns the next address
+    ///
+    /// The address following the highest address of the family is the
+    /// lowest one (0.0.0.0 or ::).
+    CompactAddress next() const {
+        if (isV4()) {
+            return (fromV4(static_cast<uint32_t>(lo_ + 1)));
+        }
+        const uint64_t lo = lo_ + 1;
+        return (CompactAddress(lo == 0 ? hi_ + 1 : hi_, lo));
+    }
+
+    /// \brief Returns the first address of the next prefix
+    ///
+    /// Adds one to the last bit of the prefix; the bits which are not part
+    /// of the prefix are not changed.  Like \c next(), the result wraps to
+    /// the lowest prefix after the highest one.
+    ///
+    /// \param len Prefix length, from 1 to the number of bits of the address.
+    CompactAddress nextPrefix(const uint8_t len) const {
+        const unsigned shift = getBits() - len;
+        if (isV4()) {
+            return (fromV4(static_cast<uint32_t>(lo_ + (1ULL << shift))));
+        }
+        if (shift >= 64) {
+            return (CompactAddress(hi_ + (1ULL << (shift - 64)), lo_));
+        }
+        const uint64_t lo = lo_ + (1ULL << shift);
+        return (CompactAddress(lo < lo_ ? hi_ + 1 : hi_, lo));
+    }
+
+    /// \brief Returns the first address of a prefix this address is in
+    ///
+    /// \param len Prefix length, from 0 to the number of bits of the address.
+    CompactAddress firstInPrefix(const uint8_t len) const {
+        uint64_t hi;
+        uint64_t lo;
+        hostMask(len, hi, lo);
+        return (CompactAddress(hi_ & ~hi, lo_ & ~lo));
+    }
+
+    /// \brief Returns the last address of a prefix this address is in
+    ///
+    /// \param len Prefix length, from 0 to the number of bits of the address.
+    CompactAddress lastInPrefix(const uint8_t len) const {
+        uint64_t hi;
+        uint64_t lo;
+        hostMask(len, hi, lo);
+        return (CompactAddress(hi_ | hi, lo_ | lo));
+    }
+
+    /// \brief Returns a hash of the address
+    size_t hash() const {
+        // Multiplicative mixing of the two halves, as in boost::hash_combine.
+        uint64_t seed = lo_;
+        seed ^= hi_ + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+        return (static_cast<size_t>(seed ^ (seed >> 32)));
+    }
+
+    /// \brief Compare addresses for equality
+    bool operator==(const CompactAddress& other) const {
+        return ((lo_ == other.lo_) && (hi_ == other.hi_));
+    }
+
+    /// \brief Compare addresses for inequality
+    bool operator!=(const CompactAddress& other) const {
+        return (!operator==(other));
+    }
+
+    /// \brief Checks if this address is smaller than the other
+    ///
+    /// The IPv4 addresses are smaller than the IPv6 addresses.
+    bool operator<(const CompactAddress& other) const {
+        const bool v4 = isV4();
+        if (v4 != other.isV4()) {
+            return (v4);
+        }
+        return ((hi_ < other.hi_) || ((hi_ == other.hi_) && (lo_ < other.lo_)));
+    }
+
+    /// \brief Checks if this address is smaller than or equal to the other
+    bool operator<=(const CompactAddress& other) const {
+        return (!other.operator<(*this));
+    }
+
+private:
+    /// \brief The low 64 bits of the IPv4-mapped addresses, without the
+    /// IPv4 address
+    static const uint64_t V4_MAPPED = 0x0000ffff00000000ULL;
+
+    /// \brief Mask of the bits of \c V4_MAPPED
+    static const uint64_t V4_MAPPED_MASK = 0xffffffff00000000ULL;
+
+    /// \brief Constructor from the values of the members
+    CompactAddress(const uint64_t hi, const uint64_t lo) : hi_(hi), lo_(lo) {
+    }
+
+    /// \brief Computes the mask of the bits which are not in a prefix
+    ///
+    /// \param len Prefix length.
+    /// \param hi Set to the high 64 bits of the mask.
+    /// \param lo Set to the low 64 bits of the mask.
+    void hostMask(const uint8_t len, uint64_t& hi, uint64_t& lo) const {
+        const unsigned bits = getBits();
+        const unsigned host = (len < bits) ? bits - len : 0;
+        if (host >= 64) {
+            lo = ~0ULL;
+            hi = (host == 64) ? 0 : (~0ULL >> (128 - host));
+        } else {
+            hi = 0;
+            lo = (host == 0) ? 0 : (~0ULL >> (64 - host));
+        }
+    }
+
+    uint64_t hi_;  ///< High 64 bits of the address
+    uint64_t lo_;  ///< Low 64 bits of the address
+};
+
+/// \brief Returns a hash of the address
+///
+/// This allows the addresses to be used as keys of boost::hash based
+/// containers.
+inline size_t
+hash_value(const CompactAddress& address) {
+    return (address.hash());
+}
+
+/// \brief Insert the address as a string into stream
+///
+/// \param os A \c std::ostream object on which the insertion operation is
+/// performed.
+/// \param address The \c CompactAddress object output by the operation.
+/// \return A reference to the same \c std::ostream object referenced by
+/// parameter \c os after the insertion operation.
+std::ostream&
+operator<<(std::ostream& os, const CompactAddress& address);
+
+} // namespace asiolink
+} // namespace isc
+#endif // COMPACT_ADDRESS_H
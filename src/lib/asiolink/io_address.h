@@ -231,6 +231,8 @@ public:
     operator uint32_t () const;
 
 private:
+    friend class CompactAddress;
+
     asio::ip::address asio_address_;
 };
 
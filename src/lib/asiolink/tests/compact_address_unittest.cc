@@ -0,0 +1,170 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <asiolink/compact_address.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace isc::asiolink;
+using namespace std;
+
+namespace {
+
+/// \brief Converts the text of an address to a compact address
+CompactAddress
+compact(const string& text) {
+    return (CompactAddress(IOAddress(text)));
+}
+
+/// \brief Converts a compact address to text
+string
+text(const CompactAddress& address) {
+    return (address.toIOAddress().toText());
+}
+
+TEST(CompactAddressTest, conversions) {
+    EXPECT_EQ("::", text(CompactAddress()));
+
+    const CompactAddress v4 = compact("192.0.2.1");
+    EXPECT_TRUE(v4.isV4());
+    EXPECT_FALSE(v4.isV6());
+    EXPECT_EQ(AF_INET, v4.getFamily());
+    EXPECT_EQ(4, v4.getLength());
+    EXPECT_EQ(0xc0000201, v4.toUint32());
+    EXPECT_EQ("192.0.2.1", text(v4));
+    EXPECT_TRUE(v4 == CompactAddress::fromV4(0xc0000201));
+
+    const CompactAddress v6 = compact("2001:db8:1::dead:beef");
+    EXPECT_TRUE(v6.isV6());
+    EXPECT_EQ(AF_INET6, v6.getFamily());
+    EXPECT_EQ(16, v6.getLength());
+    EXPECT_EQ("2001:db8:1::dead:beef", text(v6));
+
+    ostringstream os;
+    os << v6;
+    EXPECT_EQ("2001:db8:1::dead:beef", os.str());
+}
+
+TEST(CompactAddressTest, bytes) {
+    const uint8_t v4_bytes[] = { 192, 0, 2, 1 };
+    const uint8_t v6_bytes[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                                 0, 0, 0, 0, 0, 0, 0, 0x10 };
+    const CompactAddress v4 = CompactAddress::fromBytes(AF_INET, v4_bytes);
+    EXPECT_EQ("192.0.2.1", text(v4));
+    const CompactAddress v6 = CompactAddress::fromBytes(AF_INET6, v6_bytes);
+    EXPECT_EQ("2001:db8::10", text(v6));
+
+    uint8_t data[V6ADDRESS_LEN];
+    v4.toBytes(data);
+    EXPECT_EQ(0, memcmp(data, v4_bytes, sizeof(v4_bytes)));
+    v6.toBytes(data);
+    EXPECT_EQ(0, memcmp(data, v6_bytes, sizeof(v6_bytes)));
+    v6.toV6Bytes(data);
+    EXPECT_EQ(0, memcmp(data, v6_bytes, sizeof(v6_bytes)));
+
+    // IPv4 addresses are held as IPv4-mapped IPv6 addresses.
+    const uint8_t mapped_bytes[] = { 0, 0, 0, 0, 0, 0, 0, 0,
+                                     0, 0, 0xff, 0xff, 192, 0, 2, 1 };
+    v4.toV6Bytes(data);
+    EXPECT_EQ(0, memcmp(data, mapped_bytes, sizeof(mapped_bytes)));
+    EXPECT_TRUE(CompactAddress::fromBytes(AF_INET6, mapped_bytes) == v4);
+    EXPECT_EQ(16, sizeof(CompactAddress));
+
+    EXPECT_THROW(CompactAddress::fromBytes(AF_INET, NULL), isc::BadValue);
+    EXPECT_THROW(CompactAddress::fromBytes(AF_UNIX, v4_bytes), isc::BadValue);
+}
+
+TEST(CompactAddressTest, compare) {
+    EXPECT_TRUE(compact("192.0.2.1") == compact("192.0.2.1"));
+    EXPECT_TRUE(compact("192.0.2.1") != compact("192.0.2.2"));
+    EXPECT_TRUE(compact("2001:db8::12") == compact("2001:0DB8:0:0::0012"));
+    EXPECT_TRUE(compact("0.0.0.1") != compact("::1"));
+
+    EXPECT_TRUE(compact("192.0.2.1") < compact("192.0.2.2"));
+    EXPECT_FALSE(compact("192.0.2.2") < compact("192.0.2.1"));
+    EXPECT_TRUE(compact("192.0.2.1") <= compact("192.0.2.1"));
+    EXPECT_TRUE(compact("2001:db8::ffff") < compact("2001:db8:0:1::"));
+    EXPECT_TRUE(compact("2001:db8::1") < compact("2001:db9::"));
+    EXPECT_FALSE(compact("2001:db8::1") <= compact("2001:db8::"));
+
+    // Same as for IOAddress: IPv4 addresses are smaller.
+    EXPECT_TRUE(compact("255.255.255.255") < compact("::"));
+    EXPECT_FALSE(compact("::") <= compact("0.0.0.0"));
+}
+
+TEST(CompactAddressTest, next) {
+    EXPECT_EQ("192.0.2.1", text(compact("192.0.2.0").next()));
+    EXPECT_EQ("192.0.3.0", text(compact("192.0.2.255").next()));
+    EXPECT_EQ("0.0.0.0", text(compact("255.255.255.255").next()));
+
+    EXPECT_EQ("2001:db8::1", text(compact("2001:db8::").next()));
+    EXPECT_EQ("2001:db8:0:1::",
+              text(compact("2001:db8::ffff:ffff:ffff:ffff").next()));
+    EXPECT_EQ("::", text(compact("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff")
+                         .next()));
+}
+
+TEST(CompactAddressTest, nextPrefix) {
+    EXPECT_EQ("2001:db8:0:1::", text(compact("2001:db8::").nextPrefix(64)));
+    EXPECT_EQ("2001:db8::100", text(compact("2001:db8::").nextPrefix(120)));
+    EXPECT_EQ("2001:db8::1", text(compact("2001:db8::").nextPrefix(128)));
+    EXPECT_EQ("2001:db9::", text(compact("2001:db8::").nextPrefix(32)));
+    EXPECT_EQ("2001:db8:1::",
+              text(compact("2001:db8:0:ff00::").nextPrefix(56)));
+    EXPECT_EQ("2001:db8:0:1::",
+              text(compact("2001:db8::ff00:0:0:0").nextPrefix(72)));
+    EXPECT_EQ("::", text(compact("8000::").nextPrefix(1)));
+
+    EXPECT_EQ("192.0.3.0", text(compact("192.0.2.0").nextPrefix(24)));
+}
+
+TEST(CompactAddressTest, prefix) {
+    const CompactAddress v6 = compact("2001:db8:1::dead:beef");
+    EXPECT_EQ("2001:db8:1::dead:be00", text(v6.firstInPrefix(120)));
+    EXPECT_EQ("2001:db8:1::dead:beff", text(v6.lastInPrefix(120)));
+    EXPECT_EQ("2001:db8:1::", text(v6.firstInPrefix(64)));
+    EXPECT_EQ("2001:db8:1:0:ffff:ffff:ffff:ffff", text(v6.lastInPrefix(64)));
+    EXPECT_EQ("2001:db8::", text(v6.firstInPrefix(35)));
+    EXPECT_EQ("2001:db8:1fff:ffff:ffff:ffff:ffff:ffff",
+              text(v6.lastInPrefix(35)));
+    EXPECT_EQ("::", text(v6.firstInPrefix(0)));
+    EXPECT_EQ("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff",
+              text(v6.lastInPrefix(0)));
+    EXPECT_TRUE(v6 == v6.firstInPrefix(128));
+    EXPECT_TRUE(v6 == v6.lastInPrefix(128));
+
+    const CompactAddress v4 = compact("192.0.2.77");
+    EXPECT_EQ("192.0.2.64", text(v4.firstInPrefix(26)));
+    EXPECT_EQ("192.0.2.127", text(v4.lastInPrefix(26)));
+    EXPECT_EQ("0.0.0.0", text(v4.firstInPrefix(0)));
+    EXPECT_EQ("255.255.255.255", text(v4.lastInPrefix(0)));
+    EXPECT_TRUE(v4 == v4.lastInPrefix(32));
+}
+
+TEST(CompactAddressTest, hash) {
+    boost::hash<CompactAddress> hasher;
+    EXPECT_EQ(hasher(compact("2001:db8::1")), hasher(compact("2001:db8::1")));
+    EXPECT_NE(hasher(compact("2001:db8::1")), hasher(compact("2001:db8::2")));
+    EXPECT_NE(hasher(compact("0.0.0.1")), hasher(compact("::1")));
+    EXPECT_NE(compact("::1:0:0:0:0").hash(), compact("::1").hash());
+}
+
+}
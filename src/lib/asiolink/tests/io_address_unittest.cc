@@ -17,6 +17,8 @@
 
 #include <asiolink/io_error.h>
 #include <asiolink/io_address.h>
+#include <log/log_address.h>
+#include <log/message_dictionary.h>
 
 #include <algorithm>
 #include <cstring>
@@ -217,3 +219,17 @@ TEST(IOAddressTest, accessClassificationMethods) {
     EXPECT_FALSE(addr5.isV6LinkLocal());
     EXPECT_TRUE (addr5.isV6Multicast());
 }
+
+// Test that the addresses are stored in the deferred log records and
+// output the same way as by toText().
+TEST(IOAddressTest, logRecord) {
+    isc::log::MessageDictionary::globalDictionary().
+        add("IO_ADDRESS_TEST", "%1 and %2");
+    isc::log::LogRecord record("IO_ADDRESS_TEST");
+    // Called as the deferred formatter does.
+    encodeLogArg(record, IOAddress("192.0.2.1"));
+    encodeLogArg(record, IOAddress("2001:db8::1:0:0:1"));
+    std::string text;
+    record.format(text);
+    EXPECT_EQ("IO_ADDRESS_TEST 192.0.2.1 and 2001:db8::1:0:0:1", text);
+}
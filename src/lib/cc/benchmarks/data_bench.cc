@@ -0,0 +1,243 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <cc/data.h>
+#include <util/monotonic_clock.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+using namespace isc::data;
+using namespace isc::util;
+
+namespace {
+
+// This benchmark compares the stream based JSON parser
+// (Element::fromJSON(std::istream&)) with the buffer based parser used by
+// Element::fromJSON(const std::string&) and Element::fromJSONFile() on the
+// DHCPv4 configuration holding the specified number of subnets, or on the
+// configuration read from the file.
+
+/// @brief Generates the DHCPv4 configuration with the number of subnets.
+///
+/// Each subnet has an explicit identifier, a pool, two options and a
+/// reservation, which resembles the configurations generated by the
+/// provisioning systems.
+///
+/// @param subnets Number of subnets.
+/// @return Configuration text.
+string
+generateConfig(const unsigned int subnets) {
+    ostringstream s;
+    s << "# Generated by data_bench\n"
+      << "{ \"Dhcp4\": {\n"
+      << "  \"interfaces\": [ \"*\" ],\n"
+      << "  \"valid-lifetime\": 4000,\n"
+      << "  \"renew-timer\": 1000,\n"
+      << "  \"rebind-timer\": 2000,\n"
+      << "  \"subnet4\": [\n";
+    for (unsigned int i = 0; i < subnets; ++i) {
+        const unsigned int a = 10 + (i >> 16);
+        const unsigned int b = (i >> 8) & 0xff;
+        const unsigned int c = i & 0xff;
+        s << "    {\n"
+          << "      \"id\": " << (i + 1) << ",\n"
+          << "      \"subnet\": \"" << a << "." << b << "." << c
+          << ".0/24\",\n"
+          << "      \"pools\": [ { \"pool\": \"" << a << "." << b << "." << c
+          << ".10 - " << a << "." << b << "." << c << ".250\" } ],\n"
+          << "      \"option-data\": [\n"
+          << "        { \"name\": \"routers\", \"code\": 3, \"space\": "
+          << "\"dhcp4\", \"csv-format\": true, \"data\": \""
+          << a << "." << b << "." << c << ".1\" },\n"
+          << "        { \"name\": \"domain-name\", \"code\": 15, \"space\": "
+          << "\"dhcp4\", \"csv-format\": true, \"data\": \"subnet-" << i
+          << ".example.org\" }\n"
+          << "      ],\n"
+          << "      \"reservations\": [ { \"hw-address\": "
+          << "\"01:02:03:04:" << hex << setfill('0') << setw(2) << b << ":"
+          << setw(2) << c << dec << setfill(' ') << "\", \"ip-address\": \""
+          << a << "." << b << "." << c << ".5\" } ]\n"
+          << "    }" << (i + 1 < subnets ? "," : "") << "\n";
+    }
+    s << "  ]\n"
+      << "} }\n";
+    return (s.str());
+}
+
+/// @brief Runs the parser for the number of iterations and reports the
+/// average time and throughput.
+///
+/// @param name Name of the parser.
+/// @param parser Functor parsing the configuration.
+/// @param size Size of the configuration in bytes.
+/// @param iterations Number of iterations.
+/// @return Average duration of the parsing in nanoseconds.
+template <typename Parser>
+uint64_t
+runBenchmark(const string& name, Parser parser, const size_t size,
+             const unsigned int iterations) {
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < iterations; ++i) {
+        const uint64_t start = getMonotonicNanos();
+        ConstElementPtr config = parser();
+        total += getMonotonicNanos() - start;
+        if (!config) {
+            cerr << name << " returned no configuration" << endl;
+            exit(1);
+        }
+    }
+    const uint64_t average = total / iterations;
+    const double seconds = static_cast<double>(average) / 1e9;
+    cout << "  " << left << setw(26) << name << right
+         << setw(10) << fixed << setprecision(3) << (seconds * 1000.0)
+         << " ms  " << setw(10) << setprecision(1)
+         << (static_cast<double>(size) / 1048576.0 / seconds) << " MB/s"
+         << endl;
+    return (average);
+}
+
+/// @brief Parses the configuration with the stream based parser.
+class StreamParser {
+public:
+    StreamParser(const string& config) : config_(config) {
+    }
+    ConstElementPtr operator()() const {
+        istringstream in(config_);
+        return (Element::fromJSON(in, "<istream>", true));
+    }
+private:
+    const string& config_;
+};
+
+/// @brief Parses the configuration with the buffer based parser.
+class StringParser {
+public:
+    StringParser(const string& config) : config_(config) {
+    }
+    ConstElementPtr operator()() const {
+        return (Element::fromJSON(config_, true));
+    }
+private:
+    const string& config_;
+};
+
+/// @brief Parses the configuration file with the buffer based parser.
+class FileParser {
+public:
+    FileParser(const string& file_name) : file_name_(file_name) {
+    }
+    ConstElementPtr operator()() const {
+        return (Element::fromJSONFile(file_name_, true));
+    }
+private:
+    const string& file_name_;
+};
+
+void
+usage() {
+    cerr << "Usage: data_bench [-n iterations] [-s subnets] [-f file]"
+         << endl;
+    cerr << "  -n iterations  number of times each parser is run (5)" << endl;
+    cerr << "  -s subnets     number of subnets in the generated"
+         << " configuration (10000)" << endl;
+    cerr << "  -f file        parse this file instead of the generated"
+         << " configuration" << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    unsigned int iterations = 5;
+    unsigned int subnets = 10000;
+    string file_name;
+    while ((ch = getopt(argc, argv, "n:s:f:")) != -1) {
+        switch (ch) {
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 's':
+            subnets = atoi(optarg);
+            break;
+        case 'f':
+            file_name = optarg;
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if ((argc != 0) || (iterations == 0)) {
+        usage();
+    }
+
+    string config;
+    bool temporary = false;
+    if (file_name.empty()) {
+        config = generateConfig(subnets);
+        file_name = "data_bench.json";
+        ofstream out(file_name.c_str());
+        out << config;
+        temporary = true;
+    } else {
+        ifstream in(file_name.c_str());
+        if (!in.is_open()) {
+            cerr << "unable to open " << file_name << endl;
+            return (1);
+        }
+        config.assign(istreambuf_iterator<char>(in),
+                      istreambuf_iterator<char>());
+    }
+
+    cout << "Parameters:" << endl;
+    cout << "  Iterations: " << iterations << endl;
+    if (!temporary) {
+        cout << "  File: " << file_name << endl;
+    } else {
+        cout << "  Subnets: " << subnets << endl;
+    }
+    cout << "  Size: " << config.size() << " bytes" << endl;
+
+    // Make sure that both parsers produce the same configuration.
+    if (!StreamParser(config)()->equals(*StringParser(config)())) {
+        cerr << "the parsers produced different configurations" << endl;
+        return (1);
+    }
+
+    cout << "Average parsing time:" << endl;
+    const uint64_t stream_time =
+        runBenchmark("stream (istream)", StreamParser(config), config.size(),
+                     iterations);
+    const uint64_t buffer_time =
+        runBenchmark("buffer (string)", StringParser(config), config.size(),
+                     iterations);
+    runBenchmark("buffer (mapped file)", FileParser(file_name), config.size(),
+                 iterations);
+    cout << "Speedup: " << setprecision(2)
+         << (static_cast<double>(stream_time) / buffer_time) << "x" << endl;
+
+    if (temporary) {
+        unlink(file_name.c_str());
+    }
+    return (0);
+}
@@ -27,6 +27,14 @@
 #include <fstream>
 #include <cerrno>
 #include <climits>
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <boost/algorithm/string.hpp> // for iequals
 #include <boost/lexical_cast.hpp>
@@ -559,6 +567,537 @@ fromStringstreamMap(std::istream& in, const std::string& file, int& line,
     }
     return (map);
 }
+
+inline bool
+isWhitespace(const int c) {
+    switch (c) {
+    case ' ':
+    case '\b':
+    case '\f':
+    case '\n':
+    case '\r':
+    case '\t':
+        return (true);
+    default:
+        return (false);
+    }
+}
+
+inline bool
+isNumberChar(const int c) {
+    return (isdigit(c) || (c == '+') || (c == '-') || (c == '.') ||
+            (c == 'e') || (c == 'E'));
+}
+
+/// @brief Single pass JSON parser working on the text held in memory.
+///
+/// The stream based parser (@c Element::fromJSON(std::istream&, ...))
+/// reads the input one character at a time through the std::istream and
+/// collects each token in a temporary std::stringstream, which makes it
+/// slow for configurations holding tens of thousands of subnets. This
+/// parser walks the buffer with a pointer and creates strings only when
+/// the elements (or map keys) are created.
+///
+/// The elements, their positions and the errors (including the error
+/// positions) are identical to those produced by the stream based parser.
+class BufferParser {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param data Pointer to the beginning of the JSON text.
+    /// @param length Length of the text.
+    /// @param file Name of the file (used in positions and errors).
+    BufferParser(const char* data, const size_t length,
+                 const std::string& file)
+        : cur_(data), end_(data + length), file_(file), line_(1), pos_(1),
+          string_value_() {
+    }
+
+    /// @brief Parses the element at the current location.
+    ///
+    /// This is the buffer counterpart of the stream based
+    /// @c Element::fromJSON(std::istream&, file, line, pos).
+    ElementPtr parseElement() {
+        skipWhitespace();
+        const int c = peek();
+        switch (c) {
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '0':
+        case '-':
+        case '+':
+        case '.':
+            return (parseNumber());
+        case 't':
+        case 'T':
+        case 'f':
+        case 'F':
+            return (parseBool());
+        case 'n':
+        case 'N':
+            return (parseNull());
+        case '"':
+            return (parseString());
+        case '[':
+            get();
+            return (parseList());
+        case '{':
+            get();
+            return (parseMap());
+        case EOF:
+            isc_throw(JSONError, "nothing read");
+        default:
+            get();
+            throwJSONError(std::string("error: unexpected character ") +
+                           std::string(1, c), file_, line_, pos_);
+        }
+        return (ElementPtr());
+    }
+
+    /// @brief Checks that only whitespace follows the parsed element.
+    ///
+    /// @throw JSONError if there is any other data.
+    void checkEnd() {
+        skipWhitespace();
+        if (cur_ != end_) {
+            throwJSONError("Extra data", file_, line_, pos_);
+        }
+    }
+
+private:
+
+    /// @brief Returns the current character without consuming it.
+    int peek() const {
+        return (cur_ != end_ ? static_cast<unsigned char>(*cur_) : EOF);
+    }
+
+    /// @brief Consumes the current character.
+    ///
+    /// As with the stream, reading past the end returns EOF and advances
+    /// the position.
+    int get() {
+        ++pos_;
+        return (cur_ != end_ ? static_cast<unsigned char>(*cur_++) : EOF);
+    }
+
+    /// @brief Skips whitespace, counterpart of @c skipChars.
+    void skipWhitespace() {
+        for (; cur_ != end_ && isWhitespace(*cur_); ++cur_) {
+            if (*cur_ == '\n') {
+                ++line_;
+                pos_ = 1;
+            } else {
+                ++pos_;
+            }
+        }
+    }
+
+    /// @brief Skips whitespace up to and including one of the characters
+    /// and the whitespace which follows, counterpart of @c skipTo.
+    ///
+    /// @param chars Expected characters.
+    /// @return Character found.
+    int skipTo(const char* chars) {
+        int c = get();
+        while (c != EOF) {
+            if (c == '\n') {
+                pos_ = 1;
+                ++line_;
+            }
+            if (isWhitespace(c)) {
+                c = get();
+            } else if (charIn(c, chars)) {
+                skipWhitespace();
+                return (c);
+            } else {
+                throwJSONError(std::string("'") + std::string(1, c) +
+                               "' read, one of \"" + chars + "\" expected",
+                               file_, line_, pos_);
+            }
+        }
+        throwJSONError(std::string("EOF read, one of \"") + chars +
+                       "\" expected", file_, line_, pos_);
+        return (c);
+    }
+
+    /// @brief Reads the quoted string, counterpart of
+    /// @c strFromStringstream.
+    ///
+    /// @param [out] value Unescaped string.
+    void readString(std::string& value) {
+        if (get() != '"') {
+            throwJSONError("String expected", file_, line_, pos_);
+        }
+        value.clear();
+        const char* start = cur_;
+        const char* chunk = cur_;
+        while (cur_ != end_) {
+            const char c = *cur_;
+            if (c == '"') {
+                value.append(chunk, cur_);
+                ++cur_;
+                pos_ += cur_ - start;
+                return;
+
+            } else if (c == '\\') {
+                value.append(chunk, cur_);
+                ++cur_;
+                const int escaped = peek();
+                switch (escaped) {
+                case '"':
+                case '/':
+                case '\\':
+                    value.push_back(static_cast<char>(escaped));
+                    break;
+                case 'b':
+                    value.push_back('\b');
+                    break;
+                case 'f':
+                    value.push_back('\f');
+                    break;
+                case 'n':
+                    value.push_back('\n');
+                    break;
+                case 'r':
+                    value.push_back('\r');
+                    break;
+                case 't':
+                    value.push_back('\t');
+                    break;
+                default:
+                    pos_ += cur_ - start;
+                    throwJSONError("Bad escape", file_, line_, pos_);
+                }
+                ++cur_;
+                chunk = cur_;
+
+            } else {
+                ++cur_;
+            }
+        }
+        // Account for the EOF read.
+        pos_ += cur_ - start + 1;
+        throwJSONError("Unterminated string", file_, line_, pos_);
+    }
+
+    /// @brief Reads the word made of letters, counterpart of
+    /// @c wordFromStringstream.
+    std::string readWord() {
+        const char* start = cur_;
+        while ((cur_ != end_) && isalpha(static_cast<unsigned char>(*cur_))) {
+            ++cur_;
+        }
+        pos_ += cur_ - start;
+        return (std::string(start, cur_));
+    }
+
+    /// @brief Parses the number, counterpart of @c fromStringstreamNumber.
+    ElementPtr parseNumber() {
+        const uint32_t start_pos = pos_;
+        const char* start = cur_;
+        bool integer = true;
+        for (; (cur_ != end_) && isNumberChar(static_cast<unsigned char>(*cur_));
+             ++cur_) {
+            if ((*cur_ == '.') || (*cur_ == 'e') || (*cur_ == 'E')) {
+                integer = false;
+            }
+        }
+        pos_ += cur_ - start;
+
+        // Fast path for the integers which can't overflow. Anything else
+        // is converted with the lexical_cast, as in the stream parser.
+        if (integer) {
+            const char* digit = (*start == '-') ? start + 1 : start;
+            const ptrdiff_t digits = cur_ - digit;
+            if ((digits > 0) && (digits <= 18) &&
+                std::find_if(digit, cur_, isNotDigit) == cur_) {
+                int64_t value = 0;
+                for (; digit != cur_; ++digit) {
+                    value = value * 10 + (*digit - '0');
+                }
+                return (Element::create(*start == '-' ? -value : value,
+                                        Element::Position(file_, line_,
+                                                          start_pos)));
+            }
+        }
+
+        const std::string number(start, cur_);
+        try {
+            if (integer) {
+                return (Element::create(boost::lexical_cast<int64_t>(number),
+                                        Element::Position(file_, line_,
+                                                          start_pos)));
+            }
+            return (Element::create(boost::lexical_cast<double>(number),
+                                    Element::Position(file_, line_,
+                                                      start_pos)));
+        } catch (const boost::bad_lexical_cast&) {
+            throwJSONError(std::string("Number overflow: ") + number,
+                           file_, line_, start_pos);
+        }
+        return (ElementPtr());
+    }
+
+    /// @brief Parses the boolean, counterpart of @c fromStringstreamBool.
+    ElementPtr parseBool() {
+        const uint32_t start_pos = pos_;
+        const std::string word = readWord();
+        if (boost::iequals(word, "True")) {
+            return (Element::create(true, Element::Position(file_, line_,
+                                                            start_pos)));
+        } else if (boost::iequals(word, "False")) {
+            return (Element::create(false, Element::Position(file_, line_,
+                                                             start_pos)));
+        }
+        throwJSONError(std::string("Bad boolean value: ") + word, file_,
+                       line_, start_pos);
+        return (ElementPtr());
+    }
+
+    /// @brief Parses the null, counterpart of @c fromStringstreamNull.
+    ElementPtr parseNull() {
+        const uint32_t start_pos = pos_;
+        const std::string word = readWord();
+        if (!boost::iequals(word, "null")) {
+            throwJSONError(std::string("Bad null value: ") + word, file_,
+                           line_, start_pos);
+        }
+        return (Element::create(Element::Position(file_, line_, start_pos)));
+    }
+
+    /// @brief Parses the string, counterpart of @c fromStringstreamString.
+    ElementPtr parseString() {
+        const uint32_t start_pos = pos_;
+        readString(string_value_);
+        return (Element::create(string_value_,
+                                Element::Position(file_, line_, start_pos)));
+    }
+
+    /// @brief Parses the list, counterpart of @c fromStringstreamList.
+    ElementPtr parseList() {
+        ElementPtr list = Element::createList(Element::Position(file_, line_,
+                                                                pos_));
+        skipWhitespace();
+        int c = 0;
+        while (c != EOF && c != ']') {
+            if (peek() != ']') {
+                list->add(parseElement());
+                c = skipTo(",]");
+            } else {
+                c = get();
+            }
+        }
+        return (list);
+    }
+
+    /// @brief Parses the map, counterpart of @c fromStringstreamMap.
+    ElementPtr parseMap() {
+        ElementPtr map = Element::createMap(Element::Position(file_, line_,
+                                                              pos_));
+        skipWhitespace();
+        int c = peek();
+        if (c == EOF) {
+            throwJSONError(std::string("Unterminated map, <string> or }"
+                                       " expected"), file_, line_, pos_);
+        } else if (c == '}') {
+            // empty map, skip closing curly (the stream parser doesn't
+            // advance the position here)
+            ++cur_;
+        } else {
+            // The key buffer is reused for all keys of this map.
+            std::string key;
+            while (c != EOF && c != '}') {
+                readString(key);
+                skipTo(":");
+                ConstElementPtr value = parseElement();
+                map->set(key, value);
+                c = skipTo(",}");
+            }
+        }
+        return (map);
+    }
+
+    /// @brief Predicate used to find non-digit characters.
+    static bool isNotDigit(const char c) {
+        return (!isdigit(static_cast<unsigned char>(c)));
+    }
+
+    /// @brief Current location in the buffer.
+    const char* cur_;
+
+    /// @brief End of the buffer.
+    const char* const end_;
+
+    /// @brief File name used in positions and errors.
+    const std::string& file_;
+
+    /// @brief Current line.
+    int line_;
+
+    /// @brief Current position within the line.
+    int pos_;
+
+    /// @brief Buffer reused for the string values.
+    std::string string_value_;
+};
+
+/// @brief Performs the same preprocessing as @c Element::preprocess on the
+/// text held in memory.
+///
+/// @param data Pointer to the beginning of the text.
+/// @param length Length of the text.
+/// @param [out] out Preprocessed text.
+/// @return false if the text is not changed by the preprocessing, in which
+/// case the @c out is left empty and the text may be parsed in place.
+bool
+preprocessBuffer(const char* data, const size_t length, std::string& out) {
+    const char* const end = data + length;
+    // The preprocessor terminates the last line with the new line
+    // character, which affects the position of errors at the end of text.
+    bool changed = (length > 0) && (end[-1] != '\n');
+    for (const char* line = data; !changed && (line != end); ) {
+        if (*line == '#') {
+            changed = true;
+        } else {
+            line = static_cast<const char*>(memchr(line, '\n', end - line));
+            line = (line ? line + 1 : end);
+        }
+    }
+    if (!changed) {
+        return (false);
+    }
+
+    out.clear();
+    out.reserve(length + 1);
+    for (const char* line = data; line != end; ) {
+        const char* eol = static_cast<const char*>(memchr(line, '\n',
+                                                          end - line));
+        if (!eol) {
+            eol = end;
+        }
+        // Comment lines are replaced with empty lines, so as the line
+        // numbers still match.
+        if (*line != '#') {
+            out.append(line, eol);
+        }
+        out.push_back('\n');
+        line = (eol != end ? eol + 1 : end);
+    }
+    return (true);
+}
+
+/// @brief Parses the JSON text held in memory.
+///
+/// @param data Pointer to the beginning of the text.
+/// @param length Length of the text.
+/// @param file File name used in positions and errors.
+/// @param preproc Specifies whether preprocessing should be performed.
+/// @param check_end Specifies whether the data following the parsed
+/// element should be rejected.
+ElementPtr
+fromJSONBuffer(const char* data, const size_t length, const std::string& file,
+               const bool preproc, const bool check_end) {
+    std::string filtered;
+    if (preproc && preprocessBuffer(data, length, filtered)) {
+        return (fromJSONBuffer(filtered.data(), filtered.size(), file,
+                               false, check_end));
+    }
+    BufferParser parser(data, length, file);
+    ElementPtr result = parser.parseElement();
+    if (check_end) {
+        parser.checkEnd();
+    }
+    return (result);
+}
+
+/// @brief Read-only memory mapping of the file, unmapped on destruction.
+class MappedFile {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Maps the whole file or, if the file can't be mapped (e.g. it is a
+    /// pipe), reads its contents into the memory.
+    ///
+    /// @param file_name Name of the file.
+    /// @throw InvalidOperation if the file can't be opened or read.
+    MappedFile(const std::string& file_name)
+        : data_(NULL), length_(0), mapped_(false), contents_() {
+        const int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            const char* error = strerror(errno);
+            isc_throw(InvalidOperation, "failed to read file '" << file_name
+                      << "': " << error);
+        }
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+            void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const char*>(addr);
+                length_ = st.st_size;
+                mapped_ = true;
+                close(fd);
+                return;
+            }
+        }
+
+        char buf[65536];
+        ssize_t len;
+        while ((len = read(fd, buf, sizeof(buf))) > 0) {
+            contents_.append(buf, len);
+        }
+        const int error = errno;
+        close(fd);
+        if (len < 0) {
+            isc_throw(InvalidOperation, "failed to read file '" << file_name
+                      << "': " << strerror(error));
+        }
+        data_ = contents_.data();
+        length_ = contents_.size();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the file.
+    ~MappedFile() {
+        if (mapped_) {
+            munmap(const_cast<char*>(data_), length_);
+        }
+    }
+
+    /// @brief Returns pointer to the file contents.
+    const char* getData() const {
+        return (data_);
+    }
+
+    /// @brief Returns length of the file contents.
+    size_t getLength() const {
+        return (length_);
+    }
+
+private:
+
+    /// @brief Pointer to the file contents.
+    const char* data_;
+
+    /// @brief Length of the file contents.
+    size_t length_;
+
+    /// @brief Indicates if the file has been mapped.
+    bool mapped_;
+
+    /// @brief File contents when the file couldn't be mapped.
+    std::string contents_;
+};
+
 } // unnamed namespace
 
 std::string
@@ -712,35 +1251,20 @@ Element::fromJSON(std::istream& in, const std::string& file, int& line,
 
 ElementPtr
 Element::fromJSON(const std::string& in, bool preproc) {
-    std::stringstream ss;
-    ss << in;
-
-    int line = 1, pos = 1;
-    stringstream filtered;
-    if (preproc) {
-        preprocess(ss, filtered);
-    }
-    ElementPtr result(fromJSON(preproc ? filtered : ss, "<string>", line, pos));
-    skipChars(ss, WHITESPACE, line, pos);
-    // ss must now be at end
-    if (ss.peek() != EOF) {
-        throwJSONError("Extra data", "<string>", line, pos);
-    }
-    return result;
+    // The whole input must be consumed unless it is preprocessed. The
+    // preprocessed text has never been checked for the trailing data, e.g.
+    // the comments following the closing bracket, so it is still accepted.
+    return (fromJSONBuffer(in.data(), in.size(), "<string>", preproc,
+                           !preproc));
 }
 
 ElementPtr
 Element::fromJSONFile(const std::string& file_name,
                       bool preproc) {
-    std::ifstream infile(file_name.c_str(), std::ios::in | std::ios::binary);
-    if (!infile.is_open())
-    {
-        const char* error = strerror(errno);
-        isc_throw(InvalidOperation, "failed to read file '" << file_name
-                  << "': " << error);
-    }
-
-    return (fromJSON(infile, file_name, preproc));
+    MappedFile file(file_name);
+    // As with the streams, the data following the element are ignored.
+    return (fromJSONBuffer(file.getData(), file.getLength(), file_name,
+                           preproc, false));
 }
 
 // to JSON format
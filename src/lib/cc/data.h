@@ -401,6 +401,10 @@ public:
 
     //@{
     /// Creates an Element from the given JSON string
+    ///
+    /// The string is parsed in place, without the overhead of the input
+    /// stream, so this is the preferred way to parse large texts.
+    ///
     /// \param in The string to parse the element from
     /// \param preproc specified whether preprocessing (e.g. comment removal)
     ///                should be performed
@@ -450,6 +454,9 @@ public:
 
     /// Reads contents of specified file and interprets it as JSON.
     ///
+    /// The file is memory mapped (if possible) and parsed in place, which
+    /// is considerably faster than parsing it through the input stream.
+    ///
     /// @param file_name name of the file to read
     /// @param preproc specified whether preprocessing (e.g. comment removal)
     ///                should be performed
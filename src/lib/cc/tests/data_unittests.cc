@@ -1141,4 +1141,112 @@ TEST(Element, getPositionCommented) {
     EXPECT_EQ(14, level2_el->getPosition().pos_);
     EXPECT_EQ("kea.conf", level2_el->getPosition().file_);
 }
+
+/// @brief Checks that both elements and all their sub elements have the
+/// same positions.
+///
+/// @param expected Element parsed by the stream based parser.
+/// @param actual Element parsed by the buffer based parser.
+void
+checkSamePositions(const ConstElementPtr& expected,
+                   const ConstElementPtr& actual) {
+    ASSERT_TRUE(actual);
+    EXPECT_EQ(expected->getPosition().str(), actual->getPosition().str());
+    if (expected->getType() == Element::list) {
+        ASSERT_EQ(expected->size(), actual->size());
+        for (int i = 0; i < expected->size(); ++i) {
+            checkSamePositions(expected->get(i), actual->get(i));
+        }
+    } else if (expected->getType() == Element::map) {
+        typedef std::map<std::string, ConstElementPtr> ElementMap;
+        BOOST_FOREACH(const ElementMap::value_type& value,
+                      expected->mapValue()) {
+            checkSamePositions(value.second, actual->get(value.first));
+        }
+    }
+}
+
+// Checks that the string (buffer based) parser produces the same elements,
+// positions and errors as the stream based parser.
+TEST(Element, bufferParserMatchesStreamParser) {
+    std::vector<std::string> sv;
+    // Valid inputs.
+    sv.push_back("{\n  \"a\": [ 1, -2, +3, 4.5e1, \"x\\ty\" ],\n"
+                 "\t\"b\" : { \"c\": True, \"d\": null,\r\n \"e\": { } },\n"
+                 "  \"f\": [ ], \"g\": \"esc \\\" \\\\ \\/ \\b \\f \\n \\r\","
+                 "  \"h\": [ [ 1 ], [ ], [ 2, 3, ] ] }\n");
+    sv.push_back("-9223372036854775808");
+    sv.push_back("  [ 123456789012345678, -123456789012345678 ]");
+    sv.push_back("\"multi\nline\" ");
+    // Invalid inputs.
+    sv.push_back("{1}");
+    sv.push_back("\n\nTru");
+    sv.push_back("{ \n \"aaa\nbbb\"err:");
+    sv.push_back("{ \t\n \"aaa\nbbb\"\t\n\n:\n True, \"\\\"");
+    sv.push_back("{ \"a\": None}");
+    sv.push_back("");
+    sv.push_back("   \n  ");
+    sv.push_back("nul");
+    sv.push_back("hello\"foobar\"");
+    sv.push_back("\"hello");
+    sv.push_back("\"bad \\x escape\"");
+    sv.push_back("[ 1, 2 3 ]");
+    sv.push_back("{ \"a\" 1 }");
+    sv.push_back("{ \"a\": 1, }");
+    sv.push_back("{");
+    sv.push_back("[ 1,\n 2");
+    sv.push_back("[ 12345678901234567890 ]");
+    sv.push_back("[ 1.2.3 ]");
+    sv.push_back("[ - ]");
+    sv.push_back("{ \"a\": @ }");
+
+    BOOST_FOREACH(const std::string& s, sv) {
+        for (int preproc = 0; preproc < 2; ++preproc) {
+            SCOPED_TRACE(s);
+            ConstElementPtr expected;
+            std::string expected_error;
+            try {
+                std::istringstream iss(s);
+                expected = Element::fromJSON(iss, "<string>", preproc != 0);
+            } catch (const JSONError& ex) {
+                expected_error = ex.what();
+            }
+
+            ConstElementPtr actual;
+            std::string actual_error;
+            try {
+                actual = Element::fromJSON(s, preproc != 0);
+            } catch (const JSONError& ex) {
+                actual_error = ex.what();
+            }
+
+            EXPECT_EQ(expected_error, actual_error);
+            if (expected) {
+                ASSERT_TRUE(actual);
+                EXPECT_TRUE(expected->equals(*actual));
+                checkSamePositions(expected, actual);
+            }
+        }
+    }
+}
+
+// Checks that the comments are removed and the positions are preserved
+// by the string parser with preprocessing.
+TEST(Element, bufferParserPreprocess) {
+    const std::string config = "# leading comment\n"
+        "{\n"
+        "# comment\n"
+        "    \"a\": 1,\n"
+        "    \"b\": 2 }";
+    ConstElementPtr top = Element::fromJSON(config, true);
+    ASSERT_TRUE(top);
+    ConstElementPtr b = top->get("b");
+    ASSERT_TRUE(b);
+    EXPECT_EQ(5, b->getPosition().line_);
+    EXPECT_EQ(10, b->getPosition().pos_);
+    EXPECT_EQ("<string>", b->getPosition().file_);
+
+    // Comments are not allowed without preprocessing.
+    EXPECT_THROW(Element::fromJSON(config, false), JSONError);
+}
 }
@@ -76,6 +76,7 @@ public:
                     hash->process(static_cast<const Botan::byte*>(secret),
                                   secret_len);
                 hmac_->set_key(hashed_key.begin(), hashed_key.size());
+                key_ = hashed_key;
             } else {
                 // Botan 1.8 considers len 0 a bad key. 1.9 does not,
                 // but we won't accept it anyway, and fail early
@@ -84,6 +85,8 @@ public:
                 }
                 hmac_->set_key(static_cast<const Botan::byte*>(secret),
                                secret_len);
+                key_ = Botan::SecureVector<Botan::byte>(
+                    static_cast<const Botan::byte*>(secret), secret_len);
             }
         } catch (const Botan::Invalid_Key_Length& ikl) {
             isc_throw(BadKey, ikl.what());
@@ -92,6 +95,23 @@ public:
         }
     }
 
+    /// @brief Constructor from an existing implementation
+    ///
+    /// See @ref isc::cryptolink::HMAC::clone() for details.
+    ///
+    /// Botan provides no way to copy a keyed HMAC object, so the new
+    /// object is keyed with the (possibly hashed) secret of the source.
+    ///
+    /// @param source The implementation to be cloned
+    HMACImpl(const HMACImpl& source) : key_(source.key_) {
+        try {
+            hmac_.reset(static_cast<Botan::HMAC*>(source.hmac_->clone()));
+            hmac_->set_key(key_.begin(), key_.size());
+        } catch (const Botan::Exception& exc) {
+            isc_throw(isc::cryptolink::LibraryError, exc.what());
+        }
+    }
+
     /// @brief Destructor
     ~HMACImpl() {
     }
@@ -203,6 +223,9 @@ public:
 private:
     /// \brief The protected pointer to the Botan HMAC object
     boost::scoped_ptr<Botan::HMAC> hmac_;
+
+    /// \brief The key the Botan HMAC object was set up with
+    Botan::SecureVector<Botan::byte> key_;
 };
 
 HMAC::HMAC(const void* secret, size_t secret_length,
@@ -211,6 +234,9 @@ HMAC::HMAC(const void* secret, size_t secret_length,
     impl_ = new HMACImpl(secret, secret_length, hash_algorithm);
 }
 
+HMAC::HMAC(HMACImpl* impl) : impl_(impl) {
+}
+
 HMAC::~HMAC() {
     delete impl_;
 }
@@ -245,5 +271,10 @@ HMAC::verify(const void* sig, const size_t len) {
     return (impl_->verify(sig, len));
 }
 
+HMAC*
+HMAC::clone() const {
+    return (new HMAC(new HMACImpl(*impl_)));
+}
+
 } // namespace cryptolink
 } // namespace isc
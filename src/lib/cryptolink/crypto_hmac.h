@@ -53,6 +53,11 @@ private:
     HMAC(const void* secret, size_t secret_len,
          const HashAlgorithm hash_algorithm);
 
+    /// \brief Constructor from an implementation, used by clone()
+    ///
+    /// \param impl The implementation, owned by the new object
+    explicit HMAC(HMACImpl* impl);
+
     friend HMAC* CryptoLink::createHMAC(const void*, size_t,
                                         const HashAlgorithm);
 
@@ -127,6 +132,26 @@ public:
     /// \return true if the signature is correct, false otherwise
     bool verify(const void* sig, size_t len);
 
+    /// \brief Create a new HMAC object with the same secret and algorithm
+    ///
+    /// The new object has not digested any data, whatever the state of
+    /// this object. Depending on the underlying library, cloning is
+    /// much cheaper than creating an object from the secret with
+    /// CryptoLink::createHMAC(): with OpenSSL the padded keys of this
+    /// object are copied, so the secret is neither hashed nor padded
+    /// again. A keyed object which is never updated can therefore be
+    /// kept as a prototype for the objects signing many messages with
+    /// the same secret.
+    ///
+    /// The caller is responsible for deleting the returned object, e.g.
+    /// with deleteHMAC().
+    ///
+    /// \exception LibraryError if there was any unexpected exception
+    ///                         in the underlying library
+    ///
+    /// \return A pointer to the new HMAC object
+    HMAC* clone() const;
+
 private:
     HMACImpl* impl_;
 };
@@ -132,6 +132,26 @@ public:
                      algo, NULL);
     }
 
+    /// @brief Constructor from an existing implementation
+    ///
+    /// See @ref isc::cryptolink::HMAC::clone() for details.
+    ///
+    /// The inner and outer padded keys are copied from the source
+    /// context and the digest is restarted from them, so the secret
+    /// is not processed again.
+    ///
+    /// @param source The implementation to be cloned
+    HMACImpl(const HMACImpl& source) {
+        md_.reset(new HMAC_CTX);
+        HMAC_CTX_init(md_.get());
+
+        if (!HMAC_CTX_copy(md_.get(), source.md_.get()) ||
+            !HMAC_Init_ex(md_.get(), NULL, 0, NULL, NULL)) {
+            HMAC_CTX_cleanup(md_.get());
+            isc_throw(LibraryError, "HMAC_CTX_copy");
+        }
+    }
+
     /// @brief Destructor
     ~HMACImpl() {
         if (md_) {
@@ -224,6 +244,9 @@ HMAC::HMAC(const void* secret, size_t secret_length,
     impl_ = new HMACImpl(secret, secret_length, hash_algorithm);
 }
 
+HMAC::HMAC(HMACImpl* impl) : impl_(impl) {
+}
+
 HMAC::~HMAC() {
     delete impl_;
 }
@@ -258,5 +281,10 @@ HMAC::verify(const void* sig, const size_t len) {
     return (impl_->verify(sig, len));
 }
 
+HMAC*
+HMAC::clone() const {
+    return (new HMAC(new HMACImpl(*impl_)));
+}
+
 } // namespace cryptolink
 } // namespace isc
@@ -200,6 +200,41 @@ namespace {
         delete[] sig;
     }
 
+    /// @brief Sign and verify with clones of a prototype HMAC object
+    /// See @ref doHMACTest for parameters
+    void doHMACTestClone(const std::string& data,
+                         const void* secret,
+                         size_t secret_len,
+                         const HashAlgorithm hash_algorithm,
+                         const uint8_t* expected_hmac,
+                         size_t hmac_len) {
+        CryptoLink& crypto = CryptoLink::getCryptoLink();
+        boost::shared_ptr<HMAC> prototype(crypto.createHMAC(secret,
+                                                            secret_len,
+                                                            hash_algorithm),
+                                          deleteHMAC);
+
+        // The data digested by the prototype must not be inherited
+        // by the clones
+        prototype->update("garbage", 7);
+
+        boost::shared_ptr<HMAC> hmac_sign(prototype->clone(), deleteHMAC);
+        hmac_sign->update(data.c_str(), data.size());
+        std::vector<uint8_t> sig = hmac_sign->sign(hmac_len);
+        ASSERT_EQ(hmac_len, sig.size());
+        checkData(&sig[0], expected_hmac, hmac_len);
+
+        // Clone the clone
+        boost::shared_ptr<HMAC> hmac_verify(hmac_sign->clone(), deleteHMAC);
+        hmac_verify->update(data.c_str(), data.size());
+        EXPECT_TRUE(hmac_verify->verify(&sig[0], sig.size()));
+
+        sig[0] = ~sig[0];
+        boost::shared_ptr<HMAC> hmac_verify2(prototype->clone(), deleteHMAC);
+        hmac_verify2->update(data.c_str(), data.size());
+        EXPECT_FALSE(hmac_verify2->verify(&sig[0], sig.size()));
+    }
+
     /// @brief Sign and verify using all variants
     /// @param data Input value
     /// @param secret Secret value
@@ -221,6 +256,8 @@ namespace {
                          expected_hmac, hmac_len);
         doHMACTestArray(data, secret, secret_len, hash_algorithm,
                         expected_hmac, hmac_len);
+        doHMACTestClone(data, secret, secret_len, hash_algorithm,
+                        expected_hmac, hmac_len);
     }
 }
 
@@ -14,6 +14,8 @@
 
 #include <utility>
 #include <dhcp/pkt.h>
+#include <exceptions/exceptions.h>
+#include <cstring>
 
 namespace isc {
 namespace dhcp {
@@ -28,8 +30,11 @@ Pkt::Pkt(uint32_t transid, const isc::asiolink::IOAddress& local_addr,
      remote_addr_(remote_addr),
      local_port_(local_port),
      remote_port_(remote_port),
-     buffer_out_(0)
+     buffer_out_(0),
+     monotonic_timestamp_(0),
+     traced_(false)
 {
+    memset(stage_times_, 0, sizeof(stage_times_));
 }
 
 Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local_addr,
@@ -42,8 +47,11 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
      remote_addr_(remote_addr),
      local_port_(local_port),
      remote_port_(remote_port),
-     buffer_out_(0)
+     buffer_out_(0),
+     monotonic_timestamp_(0),
+     traced_(false)
 {
+    memset(stage_times_, 0, sizeof(stage_times_));
     data_.resize(len);
     if (len) {
         memcpy(&data_[0], buf, len);
@@ -91,6 +99,24 @@ Pkt::addClass(const std::string& client_class) {
 void
 Pkt::updateTimestamp() {
     timestamp_ = boost::posix_time::microsec_clock::universal_time();
+    monotonic_timestamp_ = isc::util::getMonotonicNanos();
+}
+
+void
+Pkt::setTraced(const bool traced) {
+    traced_ = traced;
+    if (!traced_) {
+        memset(stage_times_, 0, sizeof(stage_times_));
+    }
+}
+
+uint64_t
+Pkt::getStageTime(const Stage stage) const {
+    if (stage >= STAGE_NUM) {
+        isc_throw(isc::OutOfRange, "invalid packet processing stage "
+                  << static_cast<int>(stage));
+    }
+    return (stage_times_[stage]);
 }
 
 void Pkt::repack() {
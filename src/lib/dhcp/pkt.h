@@ -17,9 +17,11 @@
 
 #include <asiolink/io_address.h>
 #include <util/buffer.h>
+#include <util/buffer_pool.h>
 #include <dhcp/option.h>
 #include <dhcp/hwaddr.h>
 #include <dhcp/classify.h>
+#include <util/monotonic_clock.h>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
@@ -39,6 +41,21 @@ namespace dhcp {
 class Pkt {
 public:
 
+    /// @brief Packet processing stages which may be timestamped.
+    ///
+    /// The stages are listed in the order in which they occur when the
+    /// server processes a query. The timestamps are only taken for the
+    /// packets marked for tracing with @ref Pkt::setTraced.
+    enum Stage {
+        STAGE_RECEIVED,         ///< Packet received from the socket.
+        STAGE_PARSED,           ///< Packet parsed.
+        STAGE_SUBNET_SELECTED,  ///< Subnet selected for the client.
+        STAGE_LEASE_ALLOCATED,  ///< Lease allocated (or renewed).
+        STAGE_HOOKS_DONE,       ///< Send callouts returned.
+        STAGE_SENT,             ///< Response sent.
+        STAGE_NUM               ///< Number of stages (not a stage).
+    };
+
     /// @defgroup hw_sources Specifies where a given MAC/hardware address was
     ///                      obtained.
     ///
@@ -304,6 +321,57 @@ public:
         return timestamp_;
     }
 
+    /// @brief Returns monotonic packet timestamp.
+    ///
+    /// The value is taken together with the @ref getTimestamp value when
+    /// the packet is sent or received. It is meant for measuring the
+    /// time between two packets cheaply and regardless of the system time
+    /// adjustments.
+    ///
+    /// @return Monotonic clock value in nanoseconds or 0 if the timestamp
+    /// has not been updated.
+    uint64_t getMonotonicTimestamp() const {
+        return (monotonic_timestamp_);
+    }
+
+    /// @brief Enables or disables stage tracing for this packet.
+    ///
+    /// Disabling the tracing clears all stage timestamps taken so far.
+    ///
+    /// @param traced true if the stage timestamps should be taken.
+    void setTraced(const bool traced);
+
+    /// @brief Checks if the stage timestamps are taken for this packet.
+    bool isTraced() const {
+        return (traced_);
+    }
+
+    /// @brief Takes the timestamp of the specified processing stage.
+    ///
+    /// This is a no-op for the packets which are not traced, so it may be
+    /// called unconditionally on the packet processing path. Only the first
+    /// timestamp of each stage is held, e.g. if the subnet is selected more
+    /// than once, the time of the first selection is reported.
+    ///
+    /// The timestamps are taken with the monotonic clock and are expressed
+    /// in nanoseconds. They are not related to the @ref getTimestamp value.
+    ///
+    /// @param stage Processing stage.
+    void markStage(const Stage stage) {
+        if (traced_ && (stage < STAGE_NUM) && (stage_times_[stage] == 0)) {
+            stage_times_[stage] = isc::util::getMonotonicNanos();
+        }
+    }
+
+    /// @brief Returns the timestamp of the specified processing stage.
+    ///
+    /// @param stage Processing stage.
+    ///
+    /// @throw isc::OutOfRange if the stage is invalid.
+    /// @return Monotonic clock value in nanoseconds or 0 if the stage has
+    /// not been marked.
+    uint64_t getStageTime(const Stage stage) const;
+
     /// @brief Copies content of input buffer to output buffer.
     ///
     /// This is mostly a diagnostic function. It is being used for sending
@@ -477,10 +545,12 @@ public:
 
     /// @brief Virtual desctructor.
     ///
-    /// There is nothing to clean up here, but since there are virtual methods,
-    /// we define virtual destructor to ensure that derived classes will have
-    /// a virtual one, too.
+    /// Returns the storage of the output buffer to the pool, so that the
+    /// packets packed later in this thread can reuse it. Since there are
+    /// virtual methods, the destructor is virtual to ensure that derived
+    /// classes will have a virtual one, too.
     virtual ~Pkt() {
+        isc::util::OutputBufferPool::release(buffer_out_);
     }
 
     /// @brief Classes this packet belongs to.
@@ -547,6 +617,15 @@ protected:
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
 
+    /// Monotonic packet timestamp in nanoseconds (0 if not set).
+    uint64_t monotonic_timestamp_;
+
+    /// Indicates if the processing stages are timestamped.
+    bool traced_;
+
+    /// Monotonic timestamps of the processing stages (0 if not marked).
+    uint64_t stage_times_[STAGE_NUM];
+
     // remote HW address (src if receiving packet, dst if sending packet)
     HWAddrPtr remote_hwaddr_;
 
@@ -18,6 +18,7 @@
 #include <dhcp/option_int.h>
 #include <dhcp/pkt4.h>
 #include <exceptions/exceptions.h>
+#include <util/buffer_pool.h>
 
 #include <algorithm>
 #include <iostream>
@@ -26,6 +27,7 @@
 using namespace std;
 using namespace isc::dhcp;
 using namespace isc::asiolink;
+using isc::util::OutputBufferPool;
 
 namespace {
 
@@ -103,8 +105,12 @@ Pkt4::pack() {
     }
 
     // Clear the output buffer to make sure that consecutive calls to pack()
-    // will not result in concatenation of multiple packet copies.
-    buffer_out_.clear();
+    // will not result in concatenation of multiple packet copies. The
+    // buffer is given enough room for the whole packet (including the magic
+    // cookie and the END option) up front, reusing the storage released by
+    // the packets destroyed earlier, so it is not reallocated while the
+    // options are packed.
+    OutputBufferPool::acquire(buffer_out_, len() + sizeof(uint32_t) + 1);
 
     try {
         size_t hw_len = hwaddr_->hwaddr_.size();
@@ -135,8 +141,8 @@ Pkt4::pack() {
         }
 
         // write (len) bytes of padding
-        vector<uint8_t> zeros(hw_len, 0);
-        buffer_out_.writeData(&zeros[0], hw_len);
+        static const uint8_t zeros[MAX_CHADDR_LEN] = { 0 };
+        buffer_out_.writeData(zeros, hw_len);
 
         buffer_out_.writeData(sname_, MAX_SNAME_LEN);
         buffer_out_.writeData(file_, MAX_FILE_LEN);
@@ -12,17 +12,20 @@
 // OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 // PERFORMANCE OF THIS SOFTWARE.
 
+#include <asiolink/compact_address.h>
 #include <dhcp/dhcp6.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp/option.h>
 #include <dhcp/pkt6.h>
 #include <exceptions/exceptions.h>
+#include <util/buffer_pool.h>
 
 #include <iostream>
 #include <sstream>
 
 using namespace std;
 using namespace isc::asiolink;
+using isc::util::OutputBufferPool;
 
 /// @brief Default address used in Pkt6 constructor
 const IOAddress DEFAULT_ADDRESS6("::");
@@ -182,19 +185,23 @@ Pkt6::pack() {
 void
 Pkt6::packUDP() {
     try {
+        // calculate size needed for each relay (if there is only one relay,
+        // then it will be equal to "regular" length + relay-forw header +
+        // size of relay-msg option header + possibly size of interface-id
+        // option (if present). If there is more than one relay, the whole
+        // process is called iteratively for each relay.
+        const size_t length = relay_info_.empty() ? directLen() :
+            calculateRelaySizes();
+
         // Make sure that the buffer is empty before we start writting to it.
-        buffer_out_.clear();
+        // It is given enough room for the whole packet up front, reusing
+        // the storage released by the packets destroyed earlier, so it is
+        // not reallocated while the options are packed.
+        OutputBufferPool::acquire(buffer_out_, length);
 
         // is this a relayed packet?
         if (!relay_info_.empty()) {
 
-            // calculate size needed for each relay (if there is only one relay,
-            // then it will be equal to "regular" length + relay-forw header +
-            // size of relay-msg option header + possibly size of interface-id
-            // option (if present). If there is more than one relay, the whole
-            // process is called iteratively for each relay.
-            calculateRelaySizes();
-
             // Now for each relay, we need to...
             for (vector<RelayInfo>::iterator relay = relay_info_.begin();
                  relay != relay_info_.end(); ++relay) {
@@ -202,10 +209,11 @@ Pkt6::packUDP() {
                 // build relay-forw/relay-repl header (see RFC3315, section 7)
                 buffer_out_.writeUint8(relay->msg_type_);
                 buffer_out_.writeUint8(relay->hop_count_);
-                buffer_out_.writeData(&(relay->linkaddr_.toBytes()[0]),
-                                     isc::asiolink::V6ADDRESS_LEN);
-                buffer_out_.writeData(&relay->peeraddr_.toBytes()[0],
-                                     isc::asiolink::V6ADDRESS_LEN);
+                uint8_t address[isc::asiolink::V6ADDRESS_LEN];
+                CompactAddress(relay->linkaddr_).toV6Bytes(address);
+                buffer_out_.writeData(address, sizeof(address));
+                CompactAddress(relay->peeraddr_).toV6Bytes(address);
+                buffer_out_.writeData(address, sizeof(address));
 
                 // store every option in this relay scope. Usually that will be
                 // only interface-id, but occasionally other options may be
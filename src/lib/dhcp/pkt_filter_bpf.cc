@@ -19,9 +19,11 @@
 #include <dhcp/pkt_filter_bpf.h>
 #include <dhcp/protocol_util.h>
 #include <exceptions/exceptions.h>
+#include <util/buffer_pool.h>
 #include <algorithm>
 #include <net/bpf.h>
 #include <netinet/if_ether.h>
+#include <sys/uio.h>
 
 namespace {
 
@@ -34,6 +36,9 @@ const unsigned int MAX_BPF_OPEN_ATTEMPTS = 100;
 /// received on local loopback interface.
 const unsigned int BPF_LOCAL_LOOPBACK_HEADER_LEN = 4;
 
+/// @brief Maximum length of the link, IP and UDP headers of the sent packets.
+const size_t MAX_HEADERS_LEN = 14 + 20 + 8;
+
 /// The following structure defines a Berkely Packet Filter program to perform
 /// packet filtering. The program operates on Ethernet packets.  To help with
 /// interpretation of the program, for the types of Ethernet packets we are
@@ -471,7 +476,11 @@ PktFilterBPF::receive(const Iface& iface, const SocketInfo& socket_info) {
 int
 PktFilterBPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
-    OutputBuffer buf(14);
+    // The link, IP and UDP headers are written into a buffer taken from
+    // the pool and are sent along with the DHCPv4 message in a single
+    // gather write, so the message is not copied.
+    OutputBuffer buf(0);
+    OutputBufferPool::acquire(buf, MAX_HEADERS_LEN);
 
     // Some interfaces may have no HW address - e.g. loopback interface.
     // For these interfaces the HW address length is 0. If this is the case,
@@ -500,15 +509,21 @@ PktFilterBPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
     // IP and UDP header
     writeIpUdpHeader(pkt, buf);
 
-    // DHCPv4 message
-    buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
+    // Headers followed by the DHCPv4 message
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<void*>(buf.getData());
+    iov[0].iov_len = buf.getLength();
+    iov[1].iov_base = const_cast<void*>(pkt->getBuffer().getData());
+    iov[1].iov_len = pkt->getBuffer().getLength();
 
-    int result = write(sockfd, buf.getData(), buf.getLength());
+    int result = writev(sockfd, iov, 2);
     if (result < 0) {
         isc_throw(SocketWriteError, "failed to send DHCPv4 packet: "
                   << strerror(errno));
     }
 
+    OutputBufferPool::release(buf);
+
     return (0);
 }
 
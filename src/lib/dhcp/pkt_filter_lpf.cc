@@ -19,15 +19,20 @@
 #include <dhcp/pkt_filter_lpf.h>
 #include <dhcp/protocol_util.h>
 #include <exceptions/exceptions.h>
+#include <util/buffer_pool.h>
 #include <linux/filter.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
 #include <net/ethernet.h>
+#include <sys/uio.h>
 
 namespace {
 
 using namespace isc::dhcp;
 
+/// @brief Length of the Ethernet, IP and UDP headers of the sent packets.
+const size_t MAX_HEADERS_LEN = 14 + 20 + 8;
+
 /// The following structure defines a Berkely Packet Filter program to perform
 /// packet filtering. The program operates on Ethernet packets.  To help with
 /// interpretation of the program, for the types of Ethernet packets we are
@@ -239,7 +244,11 @@ PktFilterLPF::receive(const Iface& iface, const SocketInfo& socket_info) {
 int
 PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
-    OutputBuffer buf(14);
+    // The link, IP and UDP headers are written into a buffer taken from
+    // the pool and are sent along with the DHCPv4 message in a single
+    // gather write, so the message is not copied.
+    OutputBuffer buf(0);
+    OutputBufferPool::acquire(buf, MAX_HEADERS_LEN);
 
     // Some interfaces may have no HW address - e.g. loopback interface.
     // For these interfaces the HW address length is 0. If this is the case,
@@ -261,23 +270,35 @@ PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
     // IP and UDP header
     writeIpUdpHeader(pkt, buf);
 
-    // DHCPv4 message
-    buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
+    // Headers followed by the DHCPv4 message
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<void*>(buf.getData());
+    iov[0].iov_len = buf.getLength();
+    iov[1].iov_base = const_cast<void*>(pkt->getBuffer().getData());
+    iov[1].iov_len = pkt->getBuffer().getLength();
 
     sockaddr_ll sa;
+    memset(&sa, 0, sizeof(sa));
     sa.sll_family = AF_PACKET;
     sa.sll_ifindex = iface.getIndex();
     sa.sll_protocol = htons(ETH_P_IP);
     sa.sll_halen = 6;
 
-    int result = sendto(sockfd, buf.getData(), buf.getLength(), 0,
-                        reinterpret_cast<const struct sockaddr*>(&sa),
-                        sizeof(sockaddr_ll));
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+    m.msg_name = &sa;
+    m.msg_namelen = sizeof(sockaddr_ll);
+    m.msg_iov = iov;
+    m.msg_iovlen = 2;
+
+    int result = sendmsg(sockfd, &m, 0);
     if (result < 0) {
         isc_throw(SocketWriteError, "failed to send DHCPv4 packet, errno="
                   << errno << " (check errno.h)");
     }
 
+    OutputBufferPool::release(buf);
+
     return (0);
 
 }
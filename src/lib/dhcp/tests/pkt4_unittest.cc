@@ -353,6 +353,23 @@ TEST_F(Pkt4Test, fixedFieldsPack) {
     EXPECT_EQ(0, memcmp(exp, got, Pkt4::DHCPV4_PKT_HDR_LEN));
 }
 
+// This test verifies that the storage of the output buffer of a destroyed
+// packet is reused by the packet packed next.
+TEST_F(Pkt4Test, packReusesBuffer) {
+    Pkt4Ptr pkt = generateTestPacket1();
+    ASSERT_NO_THROW(pkt->pack());
+    const size_t length = pkt->getBuffer().getLength();
+    EXPECT_GE(pkt->getBuffer().getCapacity(), length);
+    const void* data = pkt->getBuffer().getData();
+    pkt.reset();
+
+    pkt = generateTestPacket1();
+    EXPECT_EQ(0, pkt->getBuffer().getCapacity());
+    ASSERT_NO_THROW(pkt->pack());
+    EXPECT_EQ(data, pkt->getBuffer().getData());
+    EXPECT_EQ(length, pkt->getBuffer().getLength());
+}
+
 /// TODO Uncomment when ticket #1226 is implemented
 TEST_F(Pkt4Test, fixedFieldsUnpack) {
     vector<uint8_t> expectedFormat = generateTestPacket2();
@@ -714,6 +731,7 @@ TEST_F(Pkt4Test, Timestamp) {
 
     // Just after construction timestamp is invalid
     ASSERT_TRUE(pkt->getTimestamp().is_not_a_date_time());
+    EXPECT_EQ(0, pkt->getMonotonicTimestamp());
 
     // Update packet time.
     pkt->updateTimestamp();
@@ -724,6 +742,11 @@ TEST_F(Pkt4Test, Timestamp) {
     // After timestamp is updated it should be date-time.
     ASSERT_FALSE(ts_packet.is_not_a_date_time());
 
+    // The monotonic timestamp is updated too.
+    uint64_t monotonic_ts = pkt->getMonotonicTimestamp();
+    EXPECT_NE(0, monotonic_ts);
+    EXPECT_LE(monotonic_ts, isc::util::getMonotonicNanos());
+
     // Check current time.
     boost::posix_time::ptime ts_now =
         boost::posix_time::microsec_clock::universal_time();
@@ -735,6 +758,37 @@ TEST_F(Pkt4Test, Timestamp) {
     EXPECT_TRUE(ts_period.length().total_microseconds() >= 0);
 }
 
+// Checks that the processing stages are only timestamped for the traced
+// packets and that the first timestamp of each stage is held.
+TEST_F(Pkt4Test, stageTimes) {
+    scoped_ptr<Pkt4> pkt(new Pkt4(DHCPDISCOVER, 1234));
+
+    // The packet is not traced by default, so marking is a no-op.
+    EXPECT_FALSE(pkt->isTraced());
+    pkt->markStage(Pkt::STAGE_RECEIVED);
+    EXPECT_EQ(0, pkt->getStageTime(Pkt::STAGE_RECEIVED));
+
+    pkt->setTraced(true);
+    EXPECT_TRUE(pkt->isTraced());
+    pkt->markStage(Pkt::STAGE_RECEIVED);
+    pkt->markStage(Pkt::STAGE_PARSED);
+    const uint64_t received = pkt->getStageTime(Pkt::STAGE_RECEIVED);
+    const uint64_t parsed = pkt->getStageTime(Pkt::STAGE_PARSED);
+    EXPECT_NE(0, received);
+    EXPECT_LE(received, parsed);
+    EXPECT_EQ(0, pkt->getStageTime(Pkt::STAGE_SENT));
+
+    // Subsequent marks don't override the first one.
+    pkt->markStage(Pkt::STAGE_RECEIVED);
+    EXPECT_EQ(received, pkt->getStageTime(Pkt::STAGE_RECEIVED));
+
+    // Disabling the tracing clears the timestamps.
+    pkt->setTraced(false);
+    EXPECT_EQ(0, pkt->getStageTime(Pkt::STAGE_PARSED));
+
+    EXPECT_THROW(pkt->getStageTime(Pkt::STAGE_NUM), isc::OutOfRange);
+}
+
 TEST_F(Pkt4Test, hwaddr) {
     scoped_ptr<Pkt4> pkt(new Pkt4(DHCPOFFER, 1234));
     const uint8_t hw[] = { 2, 4, 6, 8, 10, 12 }; // MAC
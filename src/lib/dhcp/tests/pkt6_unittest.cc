@@ -482,6 +482,7 @@ TEST_F(Pkt6Test, Timestamp) {
 
     // Just after construction timestamp is invalid
     ASSERT_TRUE(pkt->getTimestamp().is_not_a_date_time());
+    EXPECT_EQ(0, pkt->getMonotonicTimestamp());
 
     // Update packet time.
     pkt->updateTimestamp();
@@ -492,6 +493,11 @@ TEST_F(Pkt6Test, Timestamp) {
     // After timestamp is updated it should be date-time.
     ASSERT_FALSE(ts_packet.is_not_a_date_time());
 
+    // The monotonic timestamp is updated too.
+    uint64_t monotonic_ts = pkt->getMonotonicTimestamp();
+    EXPECT_NE(0, monotonic_ts);
+    EXPECT_LE(monotonic_ts, isc::util::getMonotonicNanos());
+
     // Check current time.
     boost::posix_time::ptime ts_now =
         boost::posix_time::microsec_clock::universal_time();
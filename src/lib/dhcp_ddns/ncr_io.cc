@@ -30,6 +30,10 @@ NameChangeProtocol stringToNcrProtocol(const std::string& protocol_str) {
         return (NCR_TCP);
     }
 
+    if (boost::iequals(protocol_str, "SHM")) {
+        return (NCR_SHM);
+    }
+
     isc_throw(BadValue, "Invalid NameChangeRequest protocol:" << protocol_str);
 }
 
@@ -39,6 +43,8 @@ std::string ncrProtocolToString(NameChangeProtocol protocol) {
         return ("UDP");
     case NCR_TCP:
         return ("TCP");
+    case NCR_SHM:
+        return ("SHM");
     default:
         break;
     }
@@ -155,6 +161,17 @@ NameChangeListener::invokeRecvHandler(const Result result,
     }
 }
 
+void
+NameChangeListener::deliverRequest(NameChangeRequestPtr& ncr) {
+    try {
+        io_pending_ = false;
+        recv_handler_(SUCCESS, ncr);
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_UNCAUGHT_NCR_RECV_HANDLER_ERROR)
+                  .arg(ex.what());
+    }
+}
+
 //************************* NameChangeSender ******************************
 
 NameChangeSender::NameChangeSender(RequestSendHandler& send_handler,
@@ -271,7 +288,8 @@ NameChangeSender::sendNext() {
 }
 
 void
-NameChangeSender::invokeSendHandler(const NameChangeSender::Result result) {
+NameChangeSender::invokeSendHandler(const NameChangeSender::Result result,
+                                    const size_t count) {
     // @todo reset defense timer
     if (result == SUCCESS) {
         // It shipped so pull it off the queue.
@@ -290,6 +308,22 @@ NameChangeSender::invokeSendHandler(const NameChangeSender::Result result) {
                   .arg(ex.what());
     }
 
+    // The requests which followed it in the queue shipped with it, pull
+    // them off the queue as well.
+    if (result == SUCCESS) {
+        for (size_t i = 1; (i < count) && !send_queue_.empty(); ++i) {
+            NameChangeRequestPtr ncr = send_queue_.front();
+            send_queue_.pop_front();
+            try {
+                send_handler_(result, ncr);
+            } catch (const std::exception& ex) {
+                LOG_ERROR(dhcp_ddns_logger,
+                          DHCP_DDNS_UNCAUGHT_NCR_SEND_HANDLER_ERROR)
+                          .arg(ex.what());
+            }
+        }
+    }
+
     // Clear the pending ncr pointer.
     ncr_to_send_.reset();
 
@@ -67,13 +67,15 @@ namespace isc {
 namespace dhcp_ddns {
 
 /// @brief Defines the list of socket protocols supported.
-/// Currently only UDP is implemented.
+/// Currently UDP and SHM (shared memory between processes on the same
+/// host, see ncr_shm.h) are implemented.
 /// @todo TCP is intended to be implemented prior 1.0 release.
 /// @todo Give some thought to an ANY protocol which might try
 /// first as UDP then as TCP, etc.
 enum NameChangeProtocol {
   NCR_UDP,
-  NCR_TCP
+  NCR_TCP,
+  NCR_SHM
 };
 
 /// @brief Function which converts labels to  NameChangeProtocol enum values.
@@ -273,6 +275,19 @@ protected:
     /// wise.
     void invokeRecvHandler(const Result result, NameChangeRequestPtr& ncr);
 
+    /// @brief Passes a received request to the NCR receive handler.
+    ///
+    /// This method is used by the derivations which may receive several
+    /// requests in a single IO operation.  It invokes the handler with the
+    /// SUCCESS result but, unlike @c invokeRecvHandler, it does not start
+    /// the next receive.  All but the last of the requests received are
+    /// passed with this method, the last one with @c invokeRecvHandler.
+    /// Exceptions thrown by the handler are logged as by
+    /// @c invokeRecvHandler.
+    ///
+    /// @param ncr is a pointer to the received NameChangeRequest.
+    void deliverRequest(NameChangeRequestPtr& ncr);
+
     /// @brief Abstract method which opens the IO source for reception.
     ///
     /// The derivation uses this method to perform the steps needed to
@@ -600,6 +615,12 @@ protected:
     /// If not we leave it there so we can retry it.  After we invoke the
     /// handler we clear the pending ncr value and queue up the next send.
     ///
+    /// A derivation may send the requests following the pending one in
+    /// the queue along with it.  On success, these requests are removed
+    /// from the queue too and the handler is invoked for each of them,
+    /// in the queue order.  On failure the handler is invoked for the
+    /// pending request only, and all of them are left on the queue.
+    ///
     /// NOTE:
     /// The handler invoked by this method MUST NOT THROW. The handler is
     /// application level logic and should trap and handle any errors at
@@ -616,7 +637,10 @@ protected:
     /// the interface contract.
     ///
     /// @param result contains that send outcome status.
-    void invokeSendHandler(const NameChangeSender::Result result);
+    /// @param count is the number of requests sent, starting with the
+    /// pending one.
+    void invokeSendHandler(const NameChangeSender::Result result,
+                           const size_t count = 1);
 
     /// @brief Abstract method which opens the IO sink for transmission.
     ///
@@ -14,6 +14,7 @@
 
 #include <dhcp_ddns/ncr_msg.h>
 #include <dns/name.h>
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <asiolink/io_error.h>
 #include <cryptolink/cryptolink.h>
@@ -34,6 +35,10 @@ NameChangeFormat stringToNcrFormat(const std::string& fmt_str) {
         return FMT_JSON;
     }
 
+    if (boost::iequals(fmt_str, "BINARY")) {
+        return FMT_BINARY;
+    }
+
     isc_throw(BadValue, "Invalid NameChangeRequest format:" << fmt_str);
 }
 
@@ -41,6 +46,8 @@ NameChangeFormat stringToNcrFormat(const std::string& fmt_str) {
 std::string ncrFormatToString(NameChangeFormat format) {
     if (format == FMT_JSON) {
         return ("JSON");
+    } else if (format == FMT_BINARY) {
+        return ("BINARY");
     }
 
     std::ostringstream stream;
@@ -259,6 +266,9 @@ NameChangeRequest::fromFormat(const NameChangeFormat format,
 
         break;
         }
+    case FMT_BINARY:
+        ncr = NameChangeRequest::fromBinary(buffer);
+        break;
     default:
         // Programmatic error, shouldn't happen.
         isc_throw(NcrMessageError, "fromFormat - invalid format");
@@ -285,6 +295,9 @@ NameChangeRequest::toFormat(const NameChangeFormat format,
         buffer.writeData(json.c_str(), length);
         break;
         }
+    case FMT_BINARY:
+        toBinary(buffer);
+        break;
     default:
         // Programmatic error, shouldn't happen.
         isc_throw(NcrMessageError, "toFormat - invalid format");
@@ -374,6 +387,125 @@ NameChangeRequest::toJSON() const  {
     return (stream.str());
 }
 
+namespace {
+
+///
+/// @name Flags of the binary format
+//@{
+/// Forward change
+const uint8_t BINARY_FLAG_FORWARD = 0x01;
+/// Reverse change
+const uint8_t BINARY_FLAG_REVERSE = 0x02;
+//@}
+
+}
+
+NameChangeRequestPtr
+NameChangeRequest::fromBinary(isc::util::InputBuffer& buffer) {
+    // Use default constructor to create a "blank" NameChangeRequest and
+    // set the members directly, the values read need no conversion.
+    NameChangeRequestPtr ncr(new NameChangeRequest());
+    try {
+        const size_t len = buffer.readUint16();
+        const size_t start = buffer.getPosition();
+
+        const uint8_t change_type = buffer.readUint8();
+        if ((change_type != CHG_ADD) && (change_type != CHG_REMOVE)) {
+            isc_throw(NcrMessageError,
+                      "Invalid data value for change_type: "
+                      << static_cast<int>(change_type));
+        }
+        ncr->setChangeType(static_cast<NameChangeType>(change_type));
+
+        const uint8_t flags = buffer.readUint8();
+        ncr->setForwardChange(flags & BINARY_FLAG_FORWARD);
+        ncr->setReverseChange(flags & BINARY_FLAG_REVERSE);
+
+        uint8_t address[asiolink::V6ADDRESS_LEN];
+        const uint8_t address_len = buffer.readUint8();
+        if ((address_len != asiolink::V4ADDRESS_LEN) &&
+            (address_len != asiolink::V6ADDRESS_LEN)) {
+            isc_throw(NcrMessageError, "Invalid ip address length: "
+                      << static_cast<int>(address_len));
+        }
+        buffer.readData(address, address_len);
+        ncr->ip_io_address_ = asiolink::IOAddress::
+            fromBytes(address_len == asiolink::V4ADDRESS_LEN ?
+                      AF_INET : AF_INET6, address);
+
+        const uint64_t expires_hi = buffer.readUint32();
+        ncr->lease_expires_on_ = (expires_hi << 32) | buffer.readUint32();
+        ncr->setLeaseLength(buffer.readUint32());
+
+        std::vector<uint8_t> dhcid;
+        buffer.readVector(dhcid, buffer.readUint16());
+        ncr->dhcid_.fromBytes(dhcid);
+
+        const size_t fqdn_len = buffer.readUint16();
+        std::string fqdn(fqdn_len, '\0');
+        if (fqdn_len > 0) {
+            buffer.readData(&fqdn[0], fqdn_len);
+        }
+        ncr->setFqdn(fqdn);
+
+        if (buffer.getPosition() - start != len) {
+            isc_throw(NcrMessageError, "Invalid NameChangeRequest length: "
+                      << len << ", content length: "
+                      << buffer.getPosition() - start);
+        }
+    } catch (const isc::util::InvalidBufferPosition& ex) {
+        // Read error accessing data in InputBuffer.
+        isc_throw(NcrMessageError, "fromBinary: buffer read error: "
+                  << ex.what());
+    }
+
+    // Validate the overall content semantically.  This will throw an
+    // NcrMessageError if anything is amiss.
+    ncr->validateContent();
+
+    return (ncr);
+}
+
+void
+NameChangeRequest::toBinary(isc::util::OutputBuffer& buffer) const {
+    // Leave room for the length, it is known when the rest is written.
+    const size_t start = buffer.getLength();
+    buffer.writeUint16(0);
+
+    buffer.writeUint8(change_type_);
+    buffer.writeUint8((forward_change_ ? BINARY_FLAG_FORWARD : 0) |
+                      (reverse_change_ ? BINARY_FLAG_REVERSE : 0));
+
+    // The family is taken from the IOAddress, as the compact address
+    // handles the IPv4-mapped IPv6 addresses as IPv4 addresses.
+    const asiolink::CompactAddress address(ip_io_address_);
+    uint8_t address_data[asiolink::V6ADDRESS_LEN];
+    size_t address_len = asiolink::V6ADDRESS_LEN;
+    if (ip_io_address_.isV4()) {
+        address.toBytes(address_data);
+        address_len = asiolink::V4ADDRESS_LEN;
+    } else {
+        address.toV6Bytes(address_data);
+    }
+    buffer.writeUint8(address_len);
+    buffer.writeData(address_data, address_len);
+
+    buffer.writeUint32(static_cast<uint32_t>(lease_expires_on_ >> 32));
+    buffer.writeUint32(static_cast<uint32_t>(lease_expires_on_));
+    buffer.writeUint32(lease_length_);
+
+    const std::vector<uint8_t>& dhcid = dhcid_.getBytes();
+    buffer.writeUint16(dhcid.size());
+    if (!dhcid.empty()) {
+        buffer.writeData(&dhcid[0], dhcid.size());
+    }
+
+    buffer.writeUint16(fqdn_.size());
+    buffer.writeData(fqdn_.c_str(), fqdn_.size());
+
+    buffer.writeUint16At(buffer.getLength() - start - sizeof(uint16_t),
+                         start);
+}
 
 void
 NameChangeRequest::validateContent() {
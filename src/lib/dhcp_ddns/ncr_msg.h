@@ -67,13 +67,14 @@ enum NameChangeStatus  {
 
 /// @brief Defines the list of data wire formats supported.
 enum NameChangeFormat {
-  FMT_JSON
+  FMT_JSON,
+  FMT_BINARY
 };
 
 /// @brief Function which converts labels to  NameChangeFormat enum values.
 ///
 /// @param fmt_str text to convert to an enum.
-/// Valid string values: "JSON"
+/// Valid string values: "JSON", "BINARY"
 ///
 /// @return NameChangeFormat value which maps to the given string.
 ///
@@ -172,6 +173,13 @@ public:
     void fromHWAddr(const isc::dhcp::HWAddrPtr& hwaddr,
                     const std::vector<uint8_t>& wire_fqdn);
 
+    /// @brief Sets the DHCID value to the given bytes.
+    ///
+    /// @param bytes is a vector holding the DHCID in unsigned bytes.
+    void fromBytes(const std::vector<uint8_t>& bytes) {
+        bytes_ = bytes;
+    }
+
     /// @brief Returns a reference to the DHCID byte vector.
     ///
     /// @return a reference to the vector.
@@ -229,10 +237,10 @@ typedef std::map<std::string, isc::data::ConstElementPtr> ElementMap;
 /// This class is used by DHCP-DDNS clients (e.g. DHCP4, DHCP6) to
 /// request DNS updates.  Each message contains a single DNS change (either an
 /// add/update or a remove) for a single FQDN.  It provides marshalling services
-/// for moving instances to and from the wire.  Currently, the only format
-/// supported is JSON detailed here isc::dhcp_ddns::NameChangeRequest::fromJSON
-/// The class provides an interface such that other formats can be readily
-/// supported.
+/// for moving instances to and from the wire.  Two formats are supported:
+/// JSON, detailed here isc::dhcp_ddns::NameChangeRequest::fromJSON, and a
+/// compact binary format, detailed here
+/// isc::dhcp_ddns::NameChangeRequest::fromBinary.
 class NameChangeRequest {
 public:
     /// @brief Default Constructor.
@@ -281,7 +289,8 @@ public:
     /// is than treated as JSON which is then parsed into the data needed
     /// to create a request instance.
     ///
-    /// (NOTE currently only JSON is supported.)
+    /// BINARY: The buffer is expected to contain a request in the format
+    /// described under isc::dhcp_ddns::NameChangeRequest::fromBinary.
     ///
     /// @param format indicates the data format to use
     /// @param buffer is the input buffer containing the marshalled request
@@ -306,7 +315,12 @@ public:
     /// is identical that described under
     /// isc::dhcp_ddns::NameChangeRequest::fromJSON
     ///
-    /// (NOTE currently only JSON is supported.)
+    /// BINARY: Upon completion, the buffer will contain the request in the
+    /// format described under isc::dhcp_ddns::NameChangeRequest::fromBinary.
+    ///
+    /// In both formats the request is appended to the data already in the
+    /// buffer and starts with its length, so several requests may be
+    /// marshalled one after another into the same buffer.
     ///
     /// @param format indicates the data format to use
     /// @param buffer is the output buffer to which the request should be
@@ -412,6 +426,55 @@ public:
     /// @return a string containing the JSON rendition of the request
     std::string toJSON() const;
 
+    /// @brief Static method for creating a NameChangeRequest from a
+    /// buffer containing a binary rendition of a request.
+    ///
+    /// The binary format carries the same data as the JSON format without
+    /// the names of the members and without converting the values to text,
+    /// so it is shorter and is marshalled and unmarshalled at a fraction of
+    /// the cost. All integers are in network byte order:
+    ///
+    /// @code
+    ///   +--------------------------+
+    ///   | length (2)               |  length of the rest of the request
+    ///   +--------------------------+
+    ///   | change_type (1)          |  0 for add/update, 1 for remove
+    ///   +--------------------------+
+    ///   | flags (1)                |  0x01 forward change, 0x02 reverse
+    ///   +--------------------------+
+    ///   | address length (1)       |  4 for IPv4, 16 for IPv6
+    ///   | ip_address (4 or 16)     |
+    ///   +--------------------------+
+    ///   | lease_expires_on (8)     |  seconds since the epoch
+    ///   | lease_length (4)         |  seconds
+    ///   +--------------------------+
+    ///   | dhcid length (2)         |
+    ///   | dhcid (variable)         |
+    ///   +--------------------------+
+    ///   | fqdn length (2)          |
+    ///   | fqdn (variable)          |  text, as in the JSON format
+    ///   +--------------------------+
+    /// @endcode
+    ///
+    /// The content is validated the same way as for the JSON format.
+    ///
+    /// @param buffer is the input buffer positioned at the start of the
+    /// request. Upon return it is positioned after the request.
+    ///
+    /// @return a pointer to the new NameChangeRequest
+    ///
+    /// @throw NcrMessageError if an error occurs creating new request.
+    static NameChangeRequestPtr fromBinary(isc::util::InputBuffer& buffer);
+
+    /// @brief Instance method for marshalling the contents of the request
+    /// into a buffer in the binary format.
+    ///
+    /// The format is described under
+    /// isc::dhcp_ddns::NameChangeRequest::fromBinary.
+    ///
+    /// @param buffer is the output buffer to which the request is appended.
+    void toBinary(isc::util::OutputBuffer& buffer) const;
+
     /// @brief Validates the content of a populated request.  This method is
     /// used by both the full constructor and from-wire marshalling to ensure
     /// that the request is content valid.  Currently it enforces the
@@ -0,0 +1,910 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcp_ddns/dhcp_ddns_log.h>
+#include <dhcp_ddns/ncr_shm.h>
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(OS_LINUX)
+#include <sys/eventfd.h>
+#endif
+
+namespace isc {
+namespace dhcp_ddns {
+
+namespace {
+
+/// @brief Value identifying an initialized ring.
+const uint32_t RING_MAGIC = 0x4e435231;
+
+/// @brief Header of a ring, followed by the slots.
+///
+/// The members written by the sender and those written by the listener
+/// are kept on separate cache lines.
+struct RingHeader {
+    /// @brief Set to RING_MAGIC by the listener.
+    uint32_t magic_;
+    /// @brief Number of slots.
+    uint32_t slots_;
+    /// @brief Size of a slot.
+    uint32_t slot_size_;
+    uint32_t reserved1_[13];
+
+    /// @brief Number of requests written, only updated by the sender.
+    volatile uint32_t head_;
+    /// @brief Set by the sender when it finds the ring full.
+    volatile uint32_t sender_waiting_;
+    uint32_t reserved2_[14];
+
+    /// @brief Number of requests read, only updated by the listener.
+    volatile uint32_t tail_;
+    /// @brief Set by the listener when it waits for requests.
+    volatile uint32_t listener_idle_;
+    uint32_t reserved3_[14];
+};
+
+/// @brief Returns the size of the shared memory holding a ring.
+size_t
+ringSize() {
+    return (sizeof(RingHeader) + (NameChangeShmListener::RING_SLOTS *
+                                  NameChangeShmListener::SLOT_SIZE));
+}
+
+/// @brief Returns the slot of a ring holding the request of a given number.
+///
+/// The geometry of the ring is not read from its header, which the other
+/// side may overwrite.
+uint8_t*
+ringSlot(RingHeader* ring, const uint32_t number) {
+    return (reinterpret_cast<uint8_t*>(ring + 1) +
+            ((number % NameChangeShmListener::RING_SLOTS) *
+             NameChangeShmListener::SLOT_SIZE));
+}
+
+/// @brief Counter making the names of the shared memory segments unique.
+unsigned int ring_count = 0;
+
+/// @brief Creates the shared memory segment of a ring and maps it.
+///
+/// The segment is unlinked at once, it is only reachable through the
+/// returned descriptor, which is passed to the sender.
+///
+/// @param shm_fd set to the descriptor of the segment.
+///
+/// @return the mapped ring.
+/// @throw NcrShmError if the segment cannot be created.
+RingHeader*
+createRing(int& shm_fd) {
+    std::ostringstream name;
+    name << "/kea-ncr-" << getpid() << "-" << ++ring_count;
+    const int fd = shm_open(name.str().c_str(), O_RDWR | O_CREAT | O_EXCL,
+                            S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        isc_throw(NcrShmError, "shm_open failed: " << strerror(errno));
+    }
+    shm_unlink(name.str().c_str());
+
+    void* addr = MAP_FAILED;
+    if (ftruncate(fd, ringSize()) == 0) {
+        addr = mmap(NULL, ringSize(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+    }
+    if (addr == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        isc_throw(NcrShmError, "mapping the ring failed: "
+                  << strerror(error));
+    }
+
+    // The new segment is zeroed: the ring is empty.
+    RingHeader* ring = static_cast<RingHeader*>(addr);
+    ring->magic_ = RING_MAGIC;
+    ring->slots_ = NameChangeShmListener::RING_SLOTS;
+    ring->slot_size_ = NameChangeShmListener::SLOT_SIZE;
+    ring->listener_idle_ = 1;
+    shm_fd = fd;
+    return (ring);
+}
+
+/// @brief Maps the ring received from the listener.
+///
+/// The ring must have the geometry this sender was built with.
+///
+/// @param shm_fd descriptor of the shared memory segment.
+/// @param size set to the size of the mapping.
+///
+/// @return the mapped ring or NULL if the segment is not a valid ring.
+RingHeader*
+mapRing(const int shm_fd, size_t& size) {
+    struct stat st;
+    if ((fstat(shm_fd, &st) != 0) ||
+        (static_cast<size_t>(st.st_size) != ringSize())) {
+        return (NULL);
+    }
+    size = st.st_size;
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      shm_fd, 0);
+    if (addr == MAP_FAILED) {
+        return (NULL);
+    }
+    RingHeader* ring = static_cast<RingHeader*>(addr);
+    if ((ring->magic_ != RING_MAGIC) ||
+        (ring->slots_ != NameChangeShmListener::RING_SLOTS) ||
+        (ring->slot_size_ != NameChangeShmListener::SLOT_SIZE)) {
+        munmap(addr, size);
+        return (NULL);
+    }
+    return (ring);
+}
+
+/// @brief Creates a non-blocking eventfd.
+///
+/// @throw NcrShmError if it cannot be created.
+int
+createEventFd() {
+#if defined(OS_LINUX)
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        isc_throw(NcrShmError, "eventfd failed: " << strerror(errno));
+    }
+    return (fd);
+#else
+    isc_throw(NcrShmError, "the shared memory transport is not supported"
+              " on this system");
+#endif
+}
+
+/// @brief Signals an eventfd.
+void
+writeEventFd(const int fd) {
+    const uint64_t value = 1;
+    // This only fails if the counter is about to overflow, in which case
+    // the eventfd is signalled already.
+    if (write(fd, &value, sizeof(value)) < 0) {
+        return;
+    }
+}
+
+/// @brief Clears an eventfd.
+void
+readEventFd(const int fd) {
+    uint64_t value;
+    // This fails with EAGAIN if the eventfd is not signalled.
+    if (read(fd, &value, sizeof(value)) < 0) {
+        return;
+    }
+}
+
+/// @brief Checks whether the peer of a Unix socket has closed it.
+///
+/// Nothing is read from the socket.
+///
+/// @return true if the socket is at end of file or in error.
+bool
+peerClosed(const int sock) {
+    char byte;
+    const ssize_t ret = recv(sock, &byte, sizeof(byte),
+                             MSG_PEEK | MSG_DONTWAIT);
+    return ((ret == 0) ||
+            ((ret < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+             (errno != EINTR)));
+}
+
+/// @brief Maximum number of descriptors passed in a message.
+const size_t MAX_FDS = 2;
+
+/// @brief Sends one byte with descriptors attached over a Unix socket.
+///
+/// @return true on success.
+bool
+sendFds(const int sock, const int* fds, const size_t count) {
+    char byte = 0;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+
+    return (sendmsg(sock, &msg, MSG_NOSIGNAL | MSG_DONTWAIT) == 1);
+}
+
+/// @brief Receives one byte and the descriptors attached to it from a
+/// Unix socket, without blocking.
+///
+/// @param fds set to the descriptors received, or to -1 if they were not.
+///
+/// @return the value returned by recvmsg.
+ssize_t
+receiveFds(const int sock, int* fds, const size_t count) {
+    char byte;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    for (size_t i = 0; i < count; ++i) {
+        fds[i] = -1;
+    }
+    int flags = MSG_DONTWAIT;
+#if defined(MSG_CMSG_CLOEXEC)
+    flags |= MSG_CMSG_CLOEXEC;
+#endif
+    const ssize_t ret = recvmsg(sock, &msg, flags);
+    if (ret <= 0) {
+        return (ret);
+    }
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if ((cmsg->cmsg_level != SOL_SOCKET) ||
+            (cmsg->cmsg_type != SCM_RIGHTS)) {
+            continue;
+        }
+        const size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < received; ++i) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + (i * sizeof(int)), sizeof(int));
+            if (i < count) {
+                fds[i] = fd;
+            } else {
+                ::close(fd);
+            }
+        }
+    }
+    return (ret);
+}
+
+}
+
+std::string
+ncrShmChannelName(const isc::asiolink::IOAddress& ip_address,
+                  const uint32_t port) {
+    std::ostringstream name;
+    name << '\0' << "kea-ncr-" << ip_address.toText() << "-" << port;
+    return (name.str());
+}
+
+/// @brief State of a sender connected to a listener.
+class NcrShmConnection {
+public:
+    /// @brief Constructor
+    ///
+    /// @param socket the socket of the accepted connection.
+    NcrShmConnection(const boost::shared_ptr<asio::local::stream_protocol::
+                     socket>& socket)
+        : socket_(socket), event_fd_(-1), ring_(NULL), tail_(0),
+          closed_(false), invalid_(false) {
+    }
+
+    /// @brief Destructor
+    ///
+    /// Unmaps the ring and closes the sender's eventfd.  The socket is
+    /// closed when the last reference to it goes.
+    ~NcrShmConnection() {
+        if (ring_) {
+            munmap(ring_, ringSize());
+        }
+        if (event_fd_ >= 0) {
+            ::close(event_fd_);
+        }
+    }
+
+    /// @brief Wakes the sender.
+    void wake() {
+        if (event_fd_ >= 0) {
+            writeEventFd(event_fd_);
+        }
+    }
+
+    /// @brief Socket connected to the sender.
+    boost::shared_ptr<asio::local::stream_protocol::socket> socket_;
+
+    /// @brief Eventfd of the sender, -1 until the handshake completes.
+    int event_fd_;
+
+    /// @brief The ring of the sender.
+    RingHeader* ring_;
+
+    /// @brief Number of requests read.
+    ///
+    /// It is copied to the ring for the sender but never read back, as
+    /// the sender may overwrite it.
+    uint32_t tail_;
+
+    /// @brief Returns the number of requests waiting in the ring.
+    uint32_t pending() const {
+        return (ring_->head_ - tail_);
+    }
+
+    /// @brief The sender has closed the connection.
+    bool closed_;
+
+    /// @brief The ring holds an invalid head and is no longer read.
+    bool invalid_;
+};
+
+//*************************** NameChangeShmListener ***********************
+
+NameChangeShmListener::
+NameChangeShmListener(const isc::asiolink::IOAddress& ip_address,
+                      const uint32_t port, const NameChangeFormat format,
+                      RequestReceiveHandler& ncr_recv_handler)
+    : NameChangeListener(ncr_recv_handler), ip_address_(ip_address),
+      port_(port), format_(format), event_value_(0) {
+}
+
+NameChangeShmListener::~NameChangeShmListener() {
+    // Clean up.
+    stopListening();
+}
+
+void
+NameChangeShmListener::open(isc::asiolink::IOService& io_service) {
+    const int fd = createEventFd();
+    try {
+        event_.reset(new asio::posix::
+                     stream_descriptor(io_service.get_io_service(), fd));
+    } catch (const asio::system_error& ex) {
+        ::close(fd);
+        isc_throw(NcrShmError, ex.code().message());
+    }
+
+    try {
+        asio::local::stream_protocol::
+            endpoint endpoint(ncrShmChannelName(ip_address_, port_));
+        acceptor_.reset(new asio::local::stream_protocol::
+                        acceptor(io_service.get_io_service(), endpoint));
+    } catch (const asio::system_error& ex) {
+        isc_throw(NcrShmError, "cannot listen on " << ip_address_
+                  << " port " << port_ << ": " << ex.code().message());
+    }
+
+    open_.reset(new bool(true));
+    doAccept();
+}
+
+void
+NameChangeShmListener::close() {
+    // The pending accept and connection handlers will do nothing.
+    if (open_) {
+        *open_ = false;
+        open_.reset();
+    }
+
+    // Wake the senders so they see their connection closed.
+    for (size_t i = 0; i < connections_.size(); ++i) {
+        connections_[i]->wake();
+        asio::error_code ignored;
+        connections_[i]->socket_->close(ignored);
+    }
+    connections_.clear();
+
+    if (acceptor_) {
+        asio::error_code ignored;
+        acceptor_->close(ignored);
+        acceptor_.reset();
+    }
+
+    // NOTE that if there is a pending receive, it will be canceled, which
+    // WILL generate an invocation of the callback with error code of
+    // "operation aborted".
+    if (event_) {
+        if (event_->is_open()) {
+            try {
+                event_->close();
+            } catch (const asio::system_error& ex) {
+                isc_throw(NcrShmError, ex.code().message());
+            }
+        }
+        event_.reset();
+    }
+}
+
+void
+NameChangeShmListener::doAccept() {
+    boost::shared_ptr<asio::local::stream_protocol::socket>
+        socket(new asio::local::stream_protocol::
+               socket(acceptor_->get_io_service()));
+    acceptor_->async_accept(*socket,
+                            boost::bind(&NameChangeShmListener::
+                                        acceptCompletionHandler, this, open_,
+                                        socket, asio::placeholders::error));
+}
+
+void
+NameChangeShmListener::acceptCompletionHandler(boost::shared_ptr<bool> open,
+                                               boost::shared_ptr<asio::local::
+                                               stream_protocol::socket> socket,
+                                               const asio::error_code&
+                                               error_code) {
+    if (!*open) {
+        // Closed since, nothing is left to use.
+        return;
+    }
+
+    if (error_code) {
+        LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_ACCEPT_ERROR)
+                  .arg(error_code.message());
+    } else {
+        // Wait for the sender's part of the handshake.
+        waitConnection(NcrShmConnectionPtr(new NcrShmConnection(socket)));
+    }
+
+    doAccept();
+}
+
+void
+NameChangeShmListener::waitConnection(const NcrShmConnectionPtr& connection) {
+    connection->socket_->async_read_some(asio::null_buffers(),
+                                         boost::bind(&NameChangeShmListener::
+                                                     connectionHandler, this,
+                                                     open_, connection,
+                                                     asio::placeholders::
+                                                     error));
+}
+
+void
+NameChangeShmListener::connectionHandler(boost::shared_ptr<bool> open,
+                                         NcrShmConnectionPtr connection,
+                                         const asio::error_code& error_code) {
+    if (!*open) {
+        return;
+    }
+
+    const int fd = connection->socket_->native();
+    if (connection->event_fd_ < 0) {
+        // The sender has sent its eventfd: reply with the ring and the
+        // listener's eventfd.
+        int event_fd = -1;
+        const ssize_t ret = (error_code ? -1 : receiveFds(fd, &event_fd, 1));
+        if ((ret < 0) && !error_code &&
+            ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            waitConnection(connection);
+            return;
+        }
+
+        try {
+            if ((ret <= 0) || (event_fd < 0)) {
+                isc_throw(NcrShmError, "no eventfd received from the sender");
+            }
+            connection->event_fd_ = event_fd;
+            int shm_fd;
+            connection->ring_ = createRing(shm_fd);
+            const int fds[MAX_FDS] = { shm_fd, event_->native() };
+            const bool sent = sendFds(fd, fds, MAX_FDS);
+            const int error = errno;
+            ::close(shm_fd);
+            if (!sent) {
+                isc_throw(NcrShmError, "sending the ring failed: "
+                          << strerror(error));
+            }
+        } catch (const std::exception& ex) {
+            LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_HANDSHAKE_ERROR)
+                      .arg(ex.what());
+            asio::error_code ignored;
+            connection->socket_->close(ignored);
+            return;
+        }
+
+        LOG_DEBUG(dhcp_ddns_logger, DBGLVL_TRACE_BASIC,
+                  DHCP_DDNS_NCR_SHM_SENDER_CONNECTED);
+        connections_.push_back(connection);
+        connection->wake();
+        waitConnection(connection);
+        return;
+    }
+
+    // The sender never writes to the socket after the handshake, it is
+    // readable when the sender closes it.
+    if (!error_code) {
+        char byte;
+        const ssize_t ret = recv(fd, &byte, sizeof(byte), MSG_DONTWAIT);
+        if ((ret > 0) ||
+            ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))) {
+            waitConnection(connection);
+            return;
+        }
+    }
+
+    // The requests left in the ring are read before the connection is
+    // dropped.
+    LOG_DEBUG(dhcp_ddns_logger, DBGLVL_TRACE_BASIC,
+              DHCP_DDNS_NCR_SHM_SENDER_DISCONNECTED);
+    connection->closed_ = true;
+    wake();
+}
+
+void
+NameChangeShmListener::wake() {
+    writeEventFd(event_->native());
+}
+
+void
+NameChangeShmListener::doReceive() {
+    // Ask the senders to wake us, then check for requests written before
+    // they could see it.
+    for (size_t i = 0; i < connections_.size(); ++i) {
+        connections_[i]->ring_->listener_idle_ = 1;
+    }
+    __sync_synchronize();
+    for (size_t i = 0; i < connections_.size(); ++i) {
+        if ((connections_[i]->pending() != 0) || connections_[i]->closed_) {
+            wake();
+            break;
+        }
+    }
+
+    event_->async_read_some(asio::buffer(&event_value_, sizeof(event_value_)),
+                            boost::bind(&NameChangeShmListener::
+                                        receiveCompletionHandler, this,
+                                        asio::placeholders::error));
+}
+
+void
+NameChangeShmListener::receiveCompletionHandler(const asio::error_code&
+                                                error_code) {
+    if (!error_code) {
+        // The application may stop listening, which drops the connections:
+        // hold them until we are done.
+        const std::vector<NcrShmConnectionPtr> connections(connections_);
+        for (size_t i = 0; i < connections.size(); ++i) {
+            NcrShmConnection& connection = *connections[i];
+            RingHeader* ring = connection.ring_;
+            while (amListening() && !connection.invalid_) {
+                const uint32_t pending = connection.pending();
+                if (pending == 0) {
+                    break;
+                }
+                if (pending > RING_SLOTS) {
+                    // The sender wrote a head it cannot have reached: give
+                    // up on the ring rather than read garbage from it.
+                    LOG_ERROR(dhcp_ddns_logger,
+                              DHCP_DDNS_NCR_SHM_RING_INVALID);
+                    connection.invalid_ = true;
+                    connection.closed_ = true;
+                    asio::error_code ignored;
+                    connection.socket_->close(ignored);
+                    break;
+                }
+
+                __sync_synchronize();
+                NameChangeRequestPtr ncr;
+                try {
+                    isc::util::InputBuffer buffer(ringSlot(ring,
+                                                           connection.tail_),
+                                                  SLOT_SIZE);
+                    ncr = NameChangeRequest::fromFormat(format_, buffer);
+                } catch (const NcrMessageError& ex) {
+                    // log it and go on with the next one
+                    LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_INVALID_NCR)
+                              .arg(ex.what());
+                }
+
+                // Free the slot, then wake the sender if it waits for room.
+                __sync_synchronize();
+                ring->tail_ = ++connection.tail_;
+                __sync_synchronize();
+                if (__sync_bool_compare_and_swap(&ring->sender_waiting_,
+                                                 1, 0)) {
+                    connection.wake();
+                }
+
+                if (ncr) {
+                    deliverRequest(ncr);
+                }
+            }
+        }
+
+        if (!amListening()) {
+            return;
+        }
+
+        // Drop the senders which have gone away.
+        for (size_t i = 0; i < connections_.size(); ) {
+            if (connections_[i]->closed_ &&
+                (connections_[i]->invalid_ ||
+                 (connections_[i]->pending() == 0))) {
+                connections_.erase(connections_.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+
+        // Queue up the next receive.
+        // NOTE: We must call the base class, NEVER doReceive
+        receiveNext();
+        return;
+    }
+
+    Result result;
+    if (error_code.value() == asio::error::operation_aborted) {
+        // A shutdown cancels all outstanding reads.  For this reason,
+        // it can be an expected event, so log it as a debug message.
+        LOG_DEBUG(dhcp_ddns_logger, DBGLVL_TRACE_BASIC,
+                  DHCP_DDNS_NCR_SHM_RECV_CANCELED);
+        result = STOPPED;
+    } else {
+        LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_RECV_ERROR)
+                  .arg(error_code.message());
+        result = ERROR;
+    }
+
+    // Call the application's registered request receive handler.
+    NameChangeRequestPtr empty;
+    invokeRecvHandler(result, empty);
+}
+
+//*************************** NameChangeShmSender ***********************
+
+NameChangeShmSender::
+NameChangeShmSender(const isc::asiolink::IOAddress& server_address,
+                    const uint32_t server_port, const NameChangeFormat format,
+                    RequestSendHandler& ncr_send_handler,
+                    const size_t send_que_max)
+    : NameChangeSender(ncr_send_handler, send_que_max),
+      server_address_(server_address), server_port_(server_port),
+      format_(format), event_fd_(-1), socket_fd_(-1), listener_event_fd_(-1),
+      ring_(NULL), ring_size_(0),
+      send_buffer_(NameChangeShmListener::SLOT_SIZE) {
+}
+
+NameChangeShmSender::~NameChangeShmSender() {
+    // Clean up.
+    stopSending();
+}
+
+void
+NameChangeShmSender::open(isc::asiolink::IOService&) {
+    event_fd_ = createEventFd();
+}
+
+void
+NameChangeShmSender::close() {
+    disconnect();
+    if (event_fd_ >= 0) {
+        ::close(event_fd_);
+        event_fd_ = -1;
+    }
+}
+
+void
+NameChangeShmSender::connect() {
+    const std::string name = ncrShmChannelName(server_address_, server_port_);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, name.data(),
+           std::min(name.size(), sizeof(addr.sun_path)));
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        isc_throw(NcrShmError, "socket failed: " << strerror(errno));
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // The connection is established at once, before the listener accepts
+    // it, so the eventfd can be sent right away.
+    if ((::connect(fd, reinterpret_cast<const struct sockaddr*>(&addr),
+                   offsetof(struct sockaddr_un, sun_path) + name.size()) != 0) ||
+        !sendFds(fd, &event_fd_, 1)) {
+        const int error = errno;
+        ::close(fd);
+        isc_throw(NcrShmError, "cannot connect to the listener on "
+                  << server_address_ << " port " << server_port_ << ": "
+                  << strerror(error));
+    }
+    socket_fd_ = fd;
+}
+
+void
+NameChangeShmSender::disconnect() {
+    if (ring_) {
+        munmap(ring_, ring_size_);
+        ring_ = NULL;
+        ring_size_ = 0;
+    }
+    if (listener_event_fd_ >= 0) {
+        ::close(listener_event_fd_);
+        listener_event_fd_ = -1;
+    }
+    if (socket_fd_ >= 0) {
+        ::close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+void
+NameChangeShmSender::doSend(NameChangeRequestPtr&) {
+    // Until the handshake completes the send stays in progress.
+    try {
+        // A listener which crashed could not wake us: check the connection
+        // before writing to a ring nobody reads any more.
+        if ((socket_fd_ >= 0) && peerClosed(socket_fd_)) {
+            LOG_WARN(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_LISTENER_DISCONNECTED)
+                     .arg(server_address_.toText()).arg(server_port_);
+            disconnect();
+        }
+        if (socket_fd_ < 0) {
+            connect();
+        }
+        if (ring_) {
+            sendQueued();
+        }
+    } catch (const isc::Exception&) {
+        // Wake ourselves: runReadyIO() tries again and reports the failure
+        // to the application, as the send completion would.
+        writeEventFd(event_fd_);
+    }
+}
+
+void
+NameChangeShmSender::sendQueued() {
+    RingHeader* ring = static_cast<RingHeader*>(ring_);
+    const size_t queued = getQueueSize();
+    size_t count = 0;
+    while (count < queued) {
+        if (ring->head_ - ring->tail_ >= NameChangeShmListener::RING_SLOTS) {
+            // Ask the listener to wake us when it makes room, then check
+            // again in case it did before it could see it.
+            ring->sender_waiting_ = 1;
+            __sync_synchronize();
+            if (ring->head_ - ring->tail_ >=
+                NameChangeShmListener::RING_SLOTS) {
+                break;
+            }
+        }
+
+        send_buffer_.clear();
+        peekAt(count)->toFormat(format_, send_buffer_);
+        if (send_buffer_.getLength() > NameChangeShmListener::SLOT_SIZE) {
+            if (count > 0) {
+                // Send those before it, this one will fail next time.
+                break;
+            }
+            isc_throw(NcrShmError, "request is too large: "
+                      << send_buffer_.getLength() << " bytes");
+        }
+
+        // Write the slot, then make it visible to the listener.
+        __sync_synchronize();
+        memcpy(ringSlot(ring, ring->head_), send_buffer_.getData(),
+               send_buffer_.getLength());
+        __sync_synchronize();
+        ++ring->head_;
+        ++count;
+    }
+
+    if (count == 0) {
+        // The ring is full, the listener wakes us when it makes room.
+        return;
+    }
+
+    // Wake the listener if it waits for requests.
+    __sync_synchronize();
+    if (__sync_bool_compare_and_swap(&ring->listener_idle_, 1, 0)) {
+        writeEventFd(listener_event_fd_);
+    }
+
+    // Call the application's registered request send handler.
+    invokeSendHandler(SUCCESS, count);
+}
+
+void
+NameChangeShmSender::runReadyIO() {
+    if (event_fd_ < 0) {
+        isc_throw(NcrSenderError, "NameChangeShmSender::runReadyIO"
+                  " sender is not open");
+    }
+    readEventFd(event_fd_);
+
+    if (socket_fd_ >= 0) {
+        ssize_t ret;
+        if (!ring_) {
+            // The listener's part of the handshake.
+            int fds[MAX_FDS];
+            ret = receiveFds(socket_fd_, fds, MAX_FDS);
+            if ((ret > 0) && (fds[0] >= 0) && (fds[1] >= 0)) {
+                ring_ = mapRing(fds[0], ring_size_);
+                listener_event_fd_ = fds[1];
+                ret = (ring_ ? ret : 0);
+            } else if (fds[1] >= 0) {
+                ::close(fds[1]);
+            }
+            if (fds[0] >= 0) {
+                ::close(fds[0]);
+            }
+        } else {
+            // The listener only writes to the socket during the handshake,
+            // it is readable when the listener closes it.
+            char byte;
+            ret = recv(socket_fd_, &byte, sizeof(byte), MSG_DONTWAIT);
+        }
+
+        if ((ret == 0) ||
+            ((ret < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+            LOG_WARN(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_LISTENER_DISCONNECTED)
+                     .arg(server_address_.toText()).arg(server_port_);
+            disconnect();
+        }
+    }
+
+    if (!isSendInProgress()) {
+        return;
+    }
+
+    // Continue the send in progress, reconnecting if the listener went
+    // away.
+    try {
+        if (socket_fd_ < 0) {
+            connect();
+        }
+        if (ring_) {
+            sendQueued();
+        }
+    } catch (const isc::Exception& ex) {
+        LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_NCR_SHM_SEND_ERROR)
+                  .arg(ex.what());
+        invokeSendHandler(ERROR);
+    }
+}
+
+int
+NameChangeShmSender::getSelectFd() {
+    if (!amSending()) {
+        isc_throw(NotImplemented, "NameChangeShmSender::getSelectFd"
+                                  " not in send mode");
+    }
+
+    return (event_fd_);
+}
+
+bool
+NameChangeShmSender::ioReady() {
+    return (false);
+}
+
+}; // end of isc::dhcp_ddns namespace
+}; // end of isc namespace
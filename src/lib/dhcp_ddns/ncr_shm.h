@@ -0,0 +1,388 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef NCR_SHM_H
+#define NCR_SHM_H
+
+/// @file ncr_shm.h
+/// @brief This file provides a shared memory based implementation for sending
+/// and receiving NameChangeRequests between processes on the same host.
+///
+/// These classes are derived from the abstract classes, NameChangeListener
+/// and NameChangeSender (see ncr_io.h).
+///
+/// Each sender connected to a listener gets a ring of fixed size slots in
+/// a shared memory segment.  The sender (e.g. a DHCP server) is the only
+/// producer and the listener (DHCP-DDNS) the only consumer of the ring, so
+/// no locking is needed: the sender writes requests in the configured wire
+/// format into the slots and advances the head, the listener reads them and
+/// advances the tail.
+///
+/// Wakeups use eventfds.  The listener waits on an eventfd shared by all of
+/// its senders, which a sender writes only when the listener has flagged
+/// that it is idle, so a burst of requests wakes it once.  Each sender has
+/// an eventfd of its own, which is its select-fd, and which the listener
+/// writes when the handshake completes or when it has made room in a ring
+/// the sender found full.  A send completes as soon as the requests are in
+/// the ring, without any further IO, so the application's event loop is not
+/// woken for each send as it is with UDP.
+///
+/// The sender finds the listener through a Unix domain socket in the
+/// abstract namespace, named from the listener's address and port (see
+/// @c ncrShmChannelName).  After connecting, the sender passes its eventfd
+/// to the listener, which replies with the shared memory segment and the
+/// listener's eventfd.  The socket remains open so that each side notices
+/// when the other goes away.
+///
+/// The transport relies on Linux specific features (eventfd and the
+/// abstract socket namespace).  On other systems opening the listener or
+/// the sender fails.
+#include <asiolink/io_address.h>
+#include <asiolink/io_service.h>
+#include <dhcp_ddns/ncr_io.h>
+#include <util/buffer.h>
+
+#include <asio.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp_ddns {
+
+/// @brief Thrown when a shared memory transport level exception occurs.
+class NcrShmError : public isc::Exception {
+public:
+    NcrShmError(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// @brief Returns the name of the Unix domain socket of a listener.
+///
+/// The name is in the abstract namespace, i.e. it starts with a null
+/// character and is not a file.
+///
+/// @param ip_address is the address the listener is configured with
+/// @param port is the port the listener is configured with
+///
+/// @return the socket name.
+std::string ncrShmChannelName(const isc::asiolink::IOAddress& ip_address,
+                              const uint32_t port);
+
+class NcrShmConnection;
+/// @brief Defines a pointer to the state of a connected sender.
+typedef boost::shared_ptr<NcrShmConnection> NcrShmConnectionPtr;
+
+/// @brief Provides the ability to receive NameChangeRequests via shared
+/// memory.
+///
+/// This class is a derivation of the NameChangeListener which receives
+/// NameChangeRequests from the senders on the same host through shared
+/// memory rings.  The caller need only supply the address and port
+/// identifying the listener and a RequestReceiveHandler instance to receive
+/// NameChangeRequests asynchronously.
+class NameChangeShmListener : public NameChangeListener {
+public:
+    /// @brief Number of slots in the ring of each sender.
+    static const size_t RING_SLOTS = 256;
+
+    /// @brief Size of a ring slot, the maximum size of a request in the
+    /// wire format.
+    static const size_t SLOT_SIZE = 1024;
+
+    /// @brief Constructor
+    ///
+    /// @param ip_address is the network address identifying the listener
+    /// @param port is the port identifying the listener
+    /// @param format is the wire format of the inbound requests.
+    /// @param ncr_recv_handler the receive handler object to notify when
+    /// a receive completes.
+    ///
+    /// @throw base class throws NcrListenerError if handler is invalid.
+    NameChangeShmListener(const isc::asiolink::IOAddress& ip_address,
+                          const uint32_t port,
+                          const NameChangeFormat format,
+                          RequestReceiveHandler& ncr_recv_handler);
+
+    /// @brief Destructor.
+    virtual ~NameChangeShmListener();
+
+    /// @brief Opens the listener using the given IOService.
+    ///
+    /// Creates the eventfd the senders wake the listener with and the
+    /// Unix domain socket the senders connect to, and starts accepting
+    /// connections.
+    ///
+    /// @param io_service the IOService which will monitor the listener.
+    ///
+    /// @throw NcrShmError if the open fails.
+    virtual void open(isc::asiolink::IOService& io_service);
+
+    /// @brief Closes the listener.
+    ///
+    /// Closes the Unix domain socket and the connections of the senders,
+    /// which are woken so they notice it, and unmaps their rings.  Closing
+    /// the eventfd cancels the pending receive, which WILL generate an
+    /// invocation of the completion handler with "operation aborted".
+    ///
+    /// @throw NcrShmError if the close fails.
+    virtual void close();
+
+    /// @brief Initiates an asynchronous wait for requests.
+    ///
+    /// Flags the listener as idle in each ring, so the senders wake it,
+    /// and starts an asynchronous read of the eventfd.  If requests were
+    /// written to a ring before the flag was seen, the eventfd is written
+    /// so the read completes at once.
+    ///
+    /// @throw NcrShmError if the read cannot be started.
+    void doReceive();
+
+    /// @brief Implements the NameChangeRequest level receive completion
+    /// handler.
+    ///
+    /// Invoked when the eventfd read completes.  On success all of the
+    /// requests in the rings are passed to the application, in order for
+    /// each sender, and the next receive is started.  A request which cannot
+    /// be read is logged and skipped.  If the application stops listening,
+    /// the requests left in the rings are not read.
+    ///
+    /// On failure the method will log the failure and notify the
+    /// application layer by calling invokeRecvHandler() with an error status
+    /// and an empty pointer.
+    ///
+    /// @param error_code is the result of the eventfd read.
+    void receiveCompletionHandler(const asio::error_code& error_code);
+
+private:
+    /// @brief Starts accepting the next sender connection.
+    void doAccept();
+
+    /// @brief Handles the completion of a connection accept.
+    ///
+    /// @param open is the indicator of the listener opening the accept was
+    /// started in; the handler does nothing if it has since been closed.
+    /// @param socket is the socket of the accepted connection.
+    /// @param error_code is the result of the accept.
+    void acceptCompletionHandler(boost::shared_ptr<bool> open,
+                                 boost::shared_ptr<asio::local::
+                                 stream_protocol::socket> socket,
+                                 const asio::error_code& error_code);
+
+    /// @brief Waits for the socket of a sender to become readable.
+    ///
+    /// @param connection is the state of the sender.
+    void waitConnection(const NcrShmConnectionPtr& connection);
+
+    /// @brief Handles the socket of a sender becoming readable.
+    ///
+    /// The first time, completes the handshake.  Afterwards, the socket
+    /// only becomes readable when the sender closes it.
+    ///
+    /// @param open is the indicator of the listener opening the wait was
+    /// started in.
+    /// @param connection is the state of the sender.
+    /// @param error_code is the result of the wait.
+    void connectionHandler(boost::shared_ptr<bool> open,
+                           NcrShmConnectionPtr connection,
+                           const asio::error_code& error_code);
+
+    /// @brief Writes the listener's eventfd.
+    void wake();
+
+    /// @brief Network address identifying the listener.
+    isc::asiolink::IOAddress ip_address_;
+
+    /// @brief Port identifying the listener.
+    uint32_t port_;
+
+    /// @brief Wire format of the inbound requests.
+    NameChangeFormat format_;
+
+    /// @brief Socket the senders connect to.
+    boost::shared_ptr<asio::local::stream_protocol::acceptor> acceptor_;
+
+    /// @brief Eventfd the senders wake the listener with.
+    boost::shared_ptr<asio::posix::stream_descriptor> event_;
+
+    /// @brief Value read from the eventfd.
+    uint64_t event_value_;
+
+    /// @brief Connected senders.
+    std::vector<NcrShmConnectionPtr> connections_;
+
+    /// @brief Indicator shared with the pending handlers, reset on close.
+    boost::shared_ptr<bool> open_;
+
+    /// @name Copy and constructor assignment operator
+    ///
+    /// The copy constructor and assignment operator are private to avoid
+    /// potential issues with multiple listeners attempting to share the
+    /// rings.
+private:
+    NameChangeShmListener(const NameChangeShmListener& source);
+    NameChangeShmListener& operator=(const NameChangeShmListener& source);
+    //@}
+};
+
+
+/// @brief Provides the ability to send NameChangeRequests via shared memory.
+///
+/// This class is a derivation of the NameChangeSender which sends
+/// NameChangeRequests to a listener on the same host through a shared
+/// memory ring.  The caller need only supply the address and port
+/// identifying the listener and a RequestSendHandler instance.
+///
+/// The sender connects to the listener when it has the first request to
+/// send, and again if the listener has gone away since.  The requests
+/// queued while the handshake completes or while the ring is full are sent
+/// when the sender's select-fd becomes ready and runReadyIO() is invoked.
+class NameChangeShmSender : public NameChangeSender {
+public:
+    /// @brief Constructor
+    ///
+    /// @param server_address the IP address identifying the listener
+    /// @param server_port the port identifying the listener
+    /// @param format is the wire format of the outbound requests.
+    /// @param ncr_send_handler the send handler object to notify when
+    /// when a send completes.
+    /// @param send_que_max sets the maximum number of entries allowed in
+    /// the send queue.
+    /// It defaults to NameChangeSender::MAX_QUEUE_DEFAULT
+    NameChangeShmSender(const isc::asiolink::IOAddress& server_address,
+                        const uint32_t server_port,
+                        const NameChangeFormat format,
+                        RequestSendHandler& ncr_send_handler,
+                        const size_t send_que_max =
+                        NameChangeSender::MAX_QUEUE_DEFAULT);
+
+    /// @brief Destructor
+    virtual ~NameChangeShmSender();
+
+    /// @brief Opens the sender.
+    ///
+    /// Creates the eventfd which is the sender's select-fd.  The listener
+    /// is connected to when the first request is sent.
+    ///
+    /// @param io_service the IOService of the application; it is not used
+    /// as the sends complete synchronously.
+    ///
+    /// @throw NcrShmError if the open fails.
+    virtual void open(isc::asiolink::IOService& io_service);
+
+    /// @brief Closes the sender.
+    ///
+    /// Unmaps the ring and closes the connection to the listener and the
+    /// eventfd.
+    ///
+    /// @throw NcrShmError if the close fails.
+    virtual void close();
+
+    /// @brief Writes the given request, and those following it in the queue,
+    /// to the ring.
+    ///
+    /// The request is at the front of the send queue.  If the listener has
+    /// closed the connection, e.g. because it crashed, the sender connects
+    /// again first.  The requests which fit in the ring are written to it, the listener is woken if it is
+    /// idle and invokeSendHandler() is called at once for all of them.  If
+    /// the handshake with the listener is not complete, or if the ring is
+    /// full, the send remains in progress until runReadyIO() can complete
+    /// it.  If the listener cannot be reached or the request is larger
+    /// than a ring slot, the sender's select-fd is made ready, and
+    /// runReadyIO() tries again and calls invokeSendHandler() with an
+    /// error status if it fails.
+    ///
+    /// @param ncr NameChangeRequest to send.
+    virtual void doSend(NameChangeRequestPtr& ncr);
+
+    /// @brief Processes the events signalled on the select-fd.
+    ///
+    /// Completes the handshake with the listener, notices that the
+    /// listener has gone away and continues the send in progress.
+    virtual void runReadyIO();
+
+    /// @brief Returns a file descriptor suitable for use with select
+    ///
+    /// The value returned is an open file descriptor which can be used with
+    /// select() system call to monitor the sender for IO events.
+    ///
+    /// @warning Attempting other use of this value may lead to unpredictable
+    /// behavior in the sender.
+    ///
+    /// @return Returns an "open" file descriptor
+    ///
+    /// @throw NcrSenderError if the sender is not in send mode,
+    virtual int getSelectFd();
+
+    /// @brief Returns whether or not the sender has IO ready to process.
+    ///
+    /// The sends complete synchronously, so there is never IO left to
+    /// process when the sender stops.
+    ///
+    /// @return false.
+    virtual bool ioReady();
+
+    /// @brief Returns true if the sender has completed the handshake with
+    /// the listener.
+    bool isConnected() const {
+        return (ring_ != NULL);
+    }
+
+private:
+    /// @brief Connects to the listener and starts the handshake.
+    ///
+    /// @throw NcrShmError if the listener cannot be reached.
+    void connect();
+
+    /// @brief Drops the connection to the listener.
+    void disconnect();
+
+    /// @brief Writes the queued requests to the ring.
+    ///
+    /// Calls invokeSendHandler() if at least one was written.
+    void sendQueued();
+
+    /// @brief Network address identifying the listener.
+    isc::asiolink::IOAddress server_address_;
+
+    /// @brief Port identifying the listener.
+    uint32_t server_port_;
+
+    /// @brief Wire format of the outbound requests.
+    NameChangeFormat format_;
+
+    /// @brief Eventfd the listener wakes the sender with (the select-fd).
+    int event_fd_;
+
+    /// @brief Socket connected to the listener.
+    int socket_fd_;
+
+    /// @brief Eventfd the sender wakes the listener with.
+    int listener_event_fd_;
+
+    /// @brief Start of the mapped ring, NULL until the handshake completes.
+    void* ring_;
+
+    /// @brief Size of the mapped ring.
+    size_t ring_size_;
+
+    /// @brief Buffer the requests are converted to wire format in.
+    isc::util::OutputBuffer send_buffer_;
+};
+
+} // namespace isc::dhcp_ddns
+} // namespace isc
+
+#endif
@@ -168,14 +168,30 @@ NameChangeUDPListener::receiveCompletionHandler(const bool successful,
 
         try {
             ncr = NameChangeRequest::fromFormat(format_, input_buffer);
+
+            // In the binary format the datagram may carry more requests.
+            // Each one is passed to the application once the next one has
+            // been read, so the last one goes along with starting the next
+            // receive below.  A JSON datagram always holds one request and
+            // anything following it is ignored, as it always has been.
+            while ((format_ == FMT_BINARY) &&
+                   (input_buffer.getPosition() < input_buffer.getLength()) &&
+                   amListening()) {
+                NameChangeRequestPtr next_ncr =
+                    NameChangeRequest::fromFormat(format_, input_buffer);
+                deliverRequest(ncr);
+                ncr = next_ncr;
+            }
         } catch (const NcrMessageError& ex) {
             // log it and go back to listening
             LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_INVALID_NCR).arg(ex.what());
 
-            // Queue up the next receive.
-            // NOTE: We must call the base class, NEVER doReceive
-            receiveNext();
-            return;
+            if (!ncr) {
+                // Queue up the next receive.
+                // NOTE: We must call the base class, NEVER doReceive
+                receiveNext();
+                return;
+            }
         }
     } else {
         asio::error_code error_code = callback->getErrorCode();
@@ -209,7 +225,8 @@ NameChangeUDPSender(const isc::asiolink::IOAddress& ip_address,
     : NameChangeSender(ncr_send_handler, send_que_max),
       ip_address_(ip_address), port_(port), server_address_(server_address),
       server_port_(server_port), format_(format),
-      reuse_address_(reuse_address) {
+      reuse_address_(reuse_address), send_buffer_(SEND_BUF_MAX),
+      send_count_(0) {
     // Instantiate the send callback.  This gets passed into each send.
     // Note that the callback constructor is passed the an instance method
     // pointer to our completion handler, sendCompletionHandler.
@@ -291,14 +308,29 @@ NameChangeUDPSender::close() {
 
 void
 NameChangeUDPSender::doSend(NameChangeRequestPtr& ncr) {
-    // Now use the NCR to write JSON to an output buffer.
-    isc::util::OutputBuffer ncr_buffer(SEND_BUF_MAX);
-    ncr->toFormat(format_, ncr_buffer);
+    // Now use the NCR to write its wire format to the output buffer.
+    send_buffer_.clear();
+    ncr->toFormat(format_, send_buffer_);
+    send_count_ = 1;
+
+    // In the binary format, append the requests waiting behind this one
+    // (at the front of the queue) while they fit in the datagram.
+    if (format_ == FMT_BINARY) {
+        for (size_t i = 1; i < getQueueSize(); ++i) {
+            const size_t length = send_buffer_.getLength();
+            peekAt(i)->toFormat(format_, send_buffer_);
+            if (send_buffer_.getLength() > SEND_BUF_MAX) {
+                send_buffer_.trim(send_buffer_.getLength() - length);
+                break;
+            }
+            ++send_count_;
+        }
+    }
 
-    // Copy the wire-ized request to callback.  This way we know after
+    // Copy the wire-ized requests to callback.  This way we know after
     // send completes what we sent (or attempted to send).
-    send_callback_->putData(static_cast<const uint8_t*>(ncr_buffer.getData()),
-                            ncr_buffer.getLength());
+    send_callback_->putData(static_cast<const uint8_t*>(send_buffer_.getData()),
+                            send_buffer_.getLength());
 
     // Call the socket's asychronous send, passing our callback
     socket_->asyncSend(send_callback_->getData(), send_callback_->getPutLen(),
@@ -348,7 +380,7 @@ NameChangeUDPSender::sendCompletionHandler(const bool successful,
     }
 
     // Call the application's registered request send handler.
-    invokeSendHandler(result);
+    invokeSendHandler(result, send_count_);
 }
 
 int
@@ -390,9 +390,14 @@ public:
     /// application layer by calling invokeRecvHandler() with a success
     /// status and a pointer to the new NCR.
     ///
+    /// The datagram may carry several requests one after another, as sent
+    /// in the binary format. All of them are passed to the application,
+    /// in order, before the next receive is started.
+    ///
     /// If the buffer contains invalid data such that construction fails,
     /// the method will log the failure and then call doReceive() to start a
-    /// initiate the next receive.
+    /// initiate the next receive. The requests preceding the invalid data
+    /// in the datagram are passed to the application.
     ///
     /// If the indicator denotes failure the method will log the failure and
     /// notify the application layer by calling invokeRecvHandler() with
@@ -504,6 +509,12 @@ public:
     /// asyncSend() method is called, passing in send_callback_ member's
     /// transfer buffer as the send buffer and the send_callback_ itself
     /// as the callback object.
+    ///
+    /// In the binary format, the requests following the given one in the
+    /// send queue are converted into the same datagram as long as it does
+    /// not exceed SEND_BUF_MAX, so a burst of requests is sent in a few
+    /// datagrams.  In the JSON format each request is sent in a datagram
+    /// of its own, as the older listeners expect.
     /// @param ncr NameChangeRequest to send.
     virtual void doSend(NameChangeRequestPtr& ncr);
 
@@ -580,6 +591,12 @@ private:
 
     /// @brief Pointer to WatchSocket instance supplying the "select-fd".
     WatchSocketPtr watch_socket_;
+
+    /// @brief Buffer the requests are converted to wire format in.
+    isc::util::OutputBuffer send_buffer_;
+
+    /// @brief Number of requests in the datagram being sent.
+    size_t send_count_;
 };
 
 } // namespace isc::dhcp_ddns
@@ -0,0 +1,427 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcp_ddns/ncr_io.h>
+#include <dhcp_ddns/ncr_shm.h>
+#include <test_utils.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+#include <cstddef>
+#include <cstring>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace isc;
+using namespace isc::dhcp_ddns;
+
+namespace {
+
+const char* TEST_ADDRESS = "127.0.0.1";
+const uint32_t LISTENER_PORT = 5301;
+
+/// @brief Maximum number of iterations of the event loop, one per
+/// millisecond.
+const int MAX_LOOPS = 5 * 1000;
+
+/// @brief Creates a request which can be told apart by its lease length.
+///
+/// @param number is the lease length.
+NameChangeRequestPtr
+makeRequest(const uint32_t number) {
+    std::ostringstream json;
+    json << "{"
+         " \"change_type\" : 0 , "
+         " \"forward_change\" : true , "
+         " \"reverse_change\" : true , "
+         " \"fqdn\" : \"walah.walah.com\" , "
+         " \"ip_address\" : \"192.168.2.1\" , "
+         " \"dhcid\" : \"010203040A7F8E3D\" , "
+         " \"lease_expires_on\" : \"20130121132405\" , "
+         " \"lease_length\" : " << number << " "
+         "}";
+    return (NameChangeRequest::fromJSON(json.str()));
+}
+
+/// @brief Verifies the name of the channel of a listener.
+TEST(NameChangeShmBasicTest, channelName) {
+    const std::string name = ncrShmChannelName(isc::asiolink::
+                                               IOAddress(TEST_ADDRESS),
+                                               LISTENER_PORT);
+    EXPECT_EQ(std::string("\0kea-ncr-127.0.0.1-5301", 23), name);
+}
+
+/// @brief Test fixture for exercising the shared memory transport.
+///
+/// The listener and the sender use the same IOService, the test runs the
+/// event loop of the listener (the IOService) and of the sender (its
+/// select-fd) in turn.
+class NameChangeShmTest : public ::testing::Test,
+                          public NameChangeListener::RequestReceiveHandler,
+                          public NameChangeSender::RequestSendHandler {
+public:
+    isc::asiolink::IOService io_service_;
+    NameChangeListenerPtr listener_;
+    boost::shared_ptr<NameChangeShmSender> sender_;
+    std::vector<NameChangeRequestPtr> received_ncrs_;
+    size_t sent_count_;
+    size_t send_errors_;
+
+    NameChangeShmTest() : sent_count_(0), send_errors_(0) {
+    }
+
+    virtual ~NameChangeShmTest() {
+        sender_.reset();
+        listener_.reset();
+    }
+
+    /// @brief Creates the listener and the sender using a given format.
+    void create(const NameChangeFormat format,
+                const size_t send_que_max =
+                NameChangeSender::MAX_QUEUE_DEFAULT) {
+        isc::asiolink::IOAddress ip_address(TEST_ADDRESS);
+        listener_.reset(new NameChangeShmListener(ip_address, LISTENER_PORT,
+                                                  format, *this));
+        sender_.reset(new NameChangeShmSender(ip_address, LISTENER_PORT,
+                                              format, *this, send_que_max));
+    }
+
+    /// @brief Runs the event loops until a number of requests have been
+    /// received or the sender has nothing left to send.
+    void run(const size_t count) {
+        for (int i = 0; i < MAX_LOOPS; ++i) {
+            io_service_.get_io_service().poll();
+            if (sender_->amSending() &&
+                (selectCheck(sender_->getSelectFd()) > 0)) {
+                sender_->runReadyIO();
+                io_service_.get_io_service().poll();
+            }
+            if ((received_ncrs_.size() >= count) &&
+                !sender_->isSendInProgress()) {
+                return;
+            }
+            usleep(1000);
+        }
+        ADD_FAILURE() << "timed out with " << received_ncrs_.size()
+                      << " requests received";
+    }
+
+    /// @brief Sends a number of requests, numbered from a first value.
+    void send(const uint32_t first, const size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            NameChangeRequestPtr ncr = makeRequest(first + i);
+            ASSERT_NO_THROW(sender_->sendRequest(ncr));
+        }
+    }
+
+    /// @brief Checks the requests received are numbered from a first value.
+    void checkReceived(const uint32_t first, const size_t count) {
+        ASSERT_EQ(count, received_ncrs_.size());
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(first + i, received_ncrs_[i]->getLeaseLength());
+        }
+    }
+
+    /// @brief Implements the receive completion handler.
+    virtual void operator ()(const NameChangeListener::Result result,
+                             NameChangeRequestPtr& ncr) {
+        if (result == NameChangeListener::SUCCESS) {
+            received_ncrs_.push_back(ncr);
+        }
+    }
+
+    /// @brief Implements the send completion handler.
+    virtual void operator ()(const NameChangeSender::Result result,
+                             NameChangeRequestPtr&) {
+        if (result == NameChangeSender::SUCCESS) {
+            ++sent_count_;
+        } else {
+            ++send_errors_;
+        }
+    }
+};
+
+/// @brief Verifies requests go from the sender to the listener in either
+/// format, in order, and that the listener is woken once per batch.
+TEST_F(NameChangeShmTest, roundTripTest) {
+    const NameChangeFormat formats[] = { FMT_JSON, FMT_BINARY };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+        SCOPED_TRACE(ncrFormatToString(formats[f]));
+        received_ncrs_.clear();
+        sent_count_ = 0;
+        create(formats[f]);
+        ASSERT_NO_THROW(listener_->startListening(io_service_));
+        ASSERT_NO_THROW(sender_->startSending(io_service_));
+
+        // The first request waits for the handshake.
+        send(1, 1);
+        EXPECT_TRUE(sender_->isSendInProgress());
+        EXPECT_FALSE(sender_->isConnected());
+        run(1);
+        EXPECT_TRUE(sender_->isConnected());
+        EXPECT_EQ(1, sent_count_);
+
+        // The following ones are sent at once.
+        send(2, 20);
+        EXPECT_EQ(21, sent_count_);
+        EXPECT_EQ(0, sender_->getQueueSize());
+
+        // A single handler run receives all of them.
+        ASSERT_EQ(1, io_service_.get_io_service().poll_one());
+        checkReceived(1, 21);
+
+        sender_->stopSending();
+        listener_->stopListening();
+        io_service_.get_io_service().poll();
+    }
+}
+
+/// @brief Verifies the sender waits when the ring is full and resumes
+/// when the listener makes room.
+TEST_F(NameChangeShmTest, ringFullTest) {
+    const size_t slots = NameChangeShmListener::RING_SLOTS;
+    create(FMT_BINARY, slots * 2);
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+    send(0, 1);
+    run(1);
+    ASSERT_TRUE(sender_->isConnected());
+
+    // Fill the ring without running the listener.
+    send(1, slots + 10);
+    EXPECT_EQ(slots + 1, sent_count_);
+    EXPECT_EQ(10, sender_->getQueueSize());
+    EXPECT_TRUE(sender_->isSendInProgress());
+
+    // The listener makes room and wakes the sender.
+    run(slots + 11);
+    checkReceived(0, slots + 11);
+    EXPECT_EQ(slots + 11, sent_count_);
+    EXPECT_EQ(0, sender_->getQueueSize());
+    EXPECT_EQ(0, send_errors_);
+}
+
+/// @brief Verifies a send fails when there is no listener.
+TEST_F(NameChangeShmTest, noListenerTest) {
+    create(FMT_JSON);
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+
+    // The failure is reported from runReadyIO.
+    send(1, 1);
+    EXPECT_EQ(0, send_errors_);
+    ASSERT_TRUE(selectCheck(sender_->getSelectFd()) > 0);
+    ASSERT_NO_THROW(sender_->runReadyIO());
+    EXPECT_EQ(1, send_errors_);
+    EXPECT_EQ(0, sent_count_);
+    EXPECT_EQ(1, sender_->getQueueSize());
+}
+
+/// @brief Verifies the sender notices the listener going away and
+/// connects again when the listener is back.
+TEST_F(NameChangeShmTest, listenerRestartTest) {
+    create(FMT_JSON);
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+    send(1, 1);
+    run(1);
+    ASSERT_TRUE(sender_->isConnected());
+
+    // The sender is woken when the listener stops.
+    listener_->stopListening();
+    io_service_.get_io_service().poll();
+    ASSERT_TRUE(selectCheck(sender_->getSelectFd()) > 0);
+    sender_->runReadyIO();
+    EXPECT_FALSE(sender_->isConnected());
+
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    send(2, 2);
+    run(3);
+    EXPECT_TRUE(sender_->isConnected());
+    checkReceived(1, 3);
+    EXPECT_EQ(0, send_errors_);
+}
+
+/// @brief Verifies the sender notices a listener which crashed, and so
+/// did not wake it, before writing to its ring.
+TEST_F(NameChangeShmTest, listenerCrashTest) {
+    create(FMT_JSON);
+
+    // Run the listener in a child process, which tells us when it listens.
+    int ready[2];
+    ASSERT_EQ(0, pipe(ready));
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        ::close(ready[0]);
+        try {
+            isc::asiolink::IOService io_service;
+            listener_->startListening(io_service);
+            const char byte = 0;
+            if (write(ready[1], &byte, sizeof(byte)) == sizeof(byte)) {
+                for (int i = 0; i < MAX_LOOPS; ++i) {
+                    io_service.get_io_service().poll();
+                    usleep(1000);
+                }
+            }
+        } catch (...) {
+        }
+        _exit(0);
+    }
+    ::close(ready[1]);
+    char byte;
+    const ssize_t ret = read(ready[0], &byte, sizeof(byte));
+    ::close(ready[0]);
+    if (ret != sizeof(byte)) {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        FAIL() << "the listener did not start";
+    }
+
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+    send(1, 1);
+    run(0);
+    const bool connected = sender_->isConnected();
+
+    // Kill the listener: its connection is closed by the system, and the
+    // sender is not woken.
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    ASSERT_TRUE(connected);
+    EXPECT_EQ(1, sent_count_);
+    EXPECT_EQ(0, selectCheck(sender_->getSelectFd()));
+
+    // The requests go to the new listener and are not lost in the ring of
+    // the old one.
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    send(2, 2);
+    run(2);
+    EXPECT_TRUE(sender_->isConnected());
+    checkReceived(2, 2);
+    EXPECT_EQ(3, sent_count_);
+    EXPECT_EQ(0, send_errors_);
+}
+
+/// @brief Verifies the listener does not trust the geometry and the
+/// positions a sender may write to the header of its ring.
+TEST_F(NameChangeShmTest, invalidRingTest) {
+    create(FMT_JSON);
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+
+    // Connect as a sender would, passing a pipe in place of an eventfd.
+    const std::string name = ncrShmChannelName(isc::asiolink::
+                                               IOAddress(TEST_ADDRESS),
+                                               LISTENER_PORT);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, name.data(), name.size());
+    const int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(sock, 0);
+    ASSERT_EQ(0, connect(sock, reinterpret_cast<struct sockaddr*>(&addr),
+                         offsetof(struct sockaddr_un, sun_path) +
+                         name.size()));
+    int wake[2];
+    ASSERT_EQ(0, pipe(wake));
+
+    char byte = 0;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+    char control[CMSG_SPACE(sizeof(int) * 2)];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int));
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &wake[1], sizeof(int));
+    ASSERT_EQ(1, sendmsg(sock, &msg, 0));
+
+    // Receive the ring and the listener's eventfd.
+    for (int i = 0; (i < MAX_LOOPS) && (selectCheck(wake[0]) <= 0); ++i) {
+        io_service_.get_io_service().poll();
+        usleep(1000);
+    }
+    msg.msg_controllen = sizeof(control);
+    ASSERT_EQ(1, recvmsg(sock, &msg, 0));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    ASSERT_TRUE(cmsg);
+    ASSERT_EQ(CMSG_LEN(sizeof(int) * 2), cmsg->cmsg_len);
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    struct stat st;
+    ASSERT_EQ(0, fstat(fds[0], &st));
+    void* ring = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fds[0], 0);
+    ASSERT_NE(MAP_FAILED, ring);
+
+    // The header holds the magic, the number and size of the slots, then
+    // the head on the next cache line.  The slots follow the three cache
+    // lines of the header.
+    uint32_t* header = static_cast<uint32_t*>(ring);
+    uint8_t* slots = static_cast<uint8_t*>(ring) + 192;
+    const uint64_t value = 1;
+
+    // Overwrite the geometry: the listener still reads the request from
+    // the first slot.
+    isc::util::OutputBuffer buffer(NameChangeShmListener::SLOT_SIZE);
+    makeRequest(1)->toFormat(FMT_JSON, buffer);
+    memcpy(slots, buffer.getData(), buffer.getLength());
+    header[1] = 0;
+    header[2] = 0xffffffff;
+    __sync_synchronize();
+    header[16] = 1;
+    EXPECT_EQ(sizeof(value), write(fds[1], &value, sizeof(value)));
+    io_service_.get_io_service().poll();
+    checkReceived(1, 1);
+
+    // Move the head further than the ring holds: the listener gives up on
+    // the ring and closes the connection.
+    header[16] = NameChangeShmListener::RING_SLOTS + 2;
+    EXPECT_EQ(sizeof(value), write(fds[1], &value, sizeof(value)));
+    io_service_.get_io_service().poll();
+    EXPECT_EQ(1, received_ncrs_.size());
+    EXPECT_EQ(0, recv(sock, &byte, sizeof(byte), MSG_DONTWAIT));
+
+    munmap(ring, st.st_size);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    ::close(wake[0]);
+    ::close(wake[1]);
+    ::close(sock);
+
+    // The other senders are not affected.
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+    send(2, 2);
+    run(3);
+    checkReceived(1, 3);
+    EXPECT_EQ(0, send_errors_);
+}
+
+} // end of anonymous namespace
@@ -160,6 +160,7 @@ public:
     NameChangeListener::Result result_;
     NameChangeRequestPtr sent_ncr_;
     NameChangeRequestPtr received_ncr_;
+    std::vector<NameChangeRequestPtr> received_ncrs_;
     NameChangeListenerPtr listener_;
     isc::asiolink::IntervalTimer test_timer_;
 
@@ -183,6 +184,13 @@ public:
     virtual ~NameChangeUDPListenerTest(){
     }
 
+    /// @brief Replaces the listener with one using the given format.
+    void setFormat(const NameChangeFormat format) {
+        isc::asiolink::IOAddress addr(TEST_ADDRESS);
+        listener_.reset(new NameChangeUDPListener(addr, LISTENER_PORT,
+                                                  format, *this, true));
+    }
+
 
     /// @brief Converts JSON string into an NCR and sends it to the listener.
     ///
@@ -222,6 +230,7 @@ public:
         // save the result and the NCR we received
         result_ = result;
         received_ncr_ = ncr;
+        received_ncrs_.push_back(ncr);
     }
     // @brief Handler invoked when test timeout is hit.
     //
@@ -269,6 +278,82 @@ TEST_F(NameChangeUDPListenerTest, basicReceivetest) {
     EXPECT_FALSE(listener_->isIoPending());
 }
 
+/// @brief Tests NameChangeUDPListener ability to receive several NCRs
+/// from one datagram in the binary format.
+TEST_F(NameChangeUDPListenerTest, binaryReceiveTest) {
+    setFormat(FMT_BINARY);
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+
+    // Write all of the requests to one buffer.
+    int num_msgs = sizeof(valid_msgs)/sizeof(char*);
+    std::vector<NameChangeRequestPtr> sent_ncrs;
+    isc::util::OutputBuffer ncr_buffer(1024);
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[i]));
+        ASSERT_NO_THROW(ncr->toFormat(FMT_BINARY, ncr_buffer));
+        sent_ncrs.push_back(ncr);
+    }
+
+    // Send them in one datagram.
+    asio::ip::udp::socket
+        udp_socket(io_service_.get_io_service(), asio::ip::udp::v4());
+    asio::ip::udp::endpoint
+        listener_endpoint(asio::ip::address::from_string(TEST_ADDRESS),
+                          LISTENER_PORT);
+    udp_socket.send_to(asio::buffer(ncr_buffer.getData(),
+                                    ncr_buffer.getLength()),
+                       listener_endpoint);
+
+    // One receive completion delivers all of them, in order.
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_EQ(NameChangeListener::SUCCESS, result_);
+    ASSERT_EQ(num_msgs, received_ncrs_.size());
+    for (int i = 0; i < num_msgs; i++) {
+        EXPECT_TRUE(checkSendVsReceived(sent_ncrs[i], received_ncrs_[i]));
+    }
+    EXPECT_TRUE(listener_->isIoPending());
+
+    EXPECT_NO_THROW(listener_->stopListening());
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_FALSE(listener_->isIoPending());
+}
+
+/// @brief Tests that NameChangeUDPListener delivers only the first request
+/// of a datagram in the JSON format and ignores any trailing bytes.
+TEST_F(NameChangeUDPListenerTest, jsonTrailingDataTest) {
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+
+    // Write a request followed by another one and some garbage.
+    isc::util::OutputBuffer ncr_buffer(1024);
+    ASSERT_NO_THROW(sent_ncr_ = NameChangeRequest::fromJSON(valid_msgs[0]));
+    ASSERT_NO_THROW(sent_ncr_->toFormat(FMT_JSON, ncr_buffer));
+    NameChangeRequestPtr ncr;
+    ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[1]));
+    ASSERT_NO_THROW(ncr->toFormat(FMT_JSON, ncr_buffer));
+    ncr_buffer.writeUint32(0xdeadbeef);
+
+    asio::ip::udp::socket
+        udp_socket(io_service_.get_io_service(), asio::ip::udp::v4());
+    asio::ip::udp::endpoint
+        listener_endpoint(asio::ip::address::from_string(TEST_ADDRESS),
+                          LISTENER_PORT);
+    udp_socket.send_to(asio::buffer(ncr_buffer.getData(),
+                                    ncr_buffer.getLength()),
+                       listener_endpoint);
+
+    // Only the first request is delivered.
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_EQ(NameChangeListener::SUCCESS, result_);
+    ASSERT_EQ(1, received_ncrs_.size());
+    EXPECT_TRUE(checkSendVsReceived(sent_ncr_, received_ncrs_[0]));
+    EXPECT_TRUE(listener_->isIoPending());
+
+    EXPECT_NO_THROW(listener_->stopListening());
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_FALSE(listener_->isIoPending());
+}
+
 /// @brief A NOP derivation for constructor test purposes.
 class SimpleSendHandler : public NameChangeSender::RequestSendHandler {
 public:
@@ -641,6 +726,17 @@ public:
                           TEST_TIMEOUT);
     }
 
+    /// @brief Replaces the listener and the sender with ones using the
+    /// given format.
+    void setFormat(const NameChangeFormat format) {
+        isc::asiolink::IOAddress addr(TEST_ADDRESS);
+        listener_.reset(new NameChangeUDPListener(addr, LISTENER_PORT, format,
+                                                  *this, true));
+        sender_.reset(new NameChangeUDPSender(addr, SENDER_PORT, addr,
+                                              LISTENER_PORT, format, *this,
+                                              100, true));
+    }
+
     void reset_results() {
         sent_ncrs_.clear();
         received_ncrs_.clear();
@@ -724,6 +820,47 @@ TEST_F (NameChangeUDPTest, roundTripTest) {
     EXPECT_FALSE(sender_->amSending());
 }
 
+/// @brief Uses a sender and listener to test UDP-based NCR delivery in the
+/// binary format.  The requests queued while a datagram is being sent are
+/// sent together in the next one, so there are far fewer sends and
+/// receives than requests.  The test verifies that what was sent matches
+/// what was received both in quantity and in order.
+TEST_F (NameChangeUDPTest, binaryRoundTripTest) {
+    setFormat(FMT_BINARY);
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+
+    // Queue each of the test messages several times.
+    int num_valid = sizeof(valid_msgs)/sizeof(char*);
+    int num_msgs = num_valid * 10;
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::
+                        fromJSON(valid_msgs[i % num_valid]));
+        sender_->sendRequest(ncr);
+    }
+
+    // Execute callbacks until we have sent and received all of messages.
+    int events = 0;
+    while (sender_->getQueueSize() > 0 || (received_ncrs_.size() < num_msgs)) {
+        EXPECT_NO_THROW(io_service_.run_one());
+        ++events;
+    }
+
+    // The first request was sent on its own, the others together.
+    EXPECT_GT(num_msgs, events);
+
+    ASSERT_EQ(num_msgs, sent_ncrs_.size());
+    ASSERT_EQ(num_msgs, received_ncrs_.size());
+    for (int i = 0; i < num_msgs; i++) {
+        EXPECT_TRUE(checkSendVsReceived(sent_ncrs_[i], received_ncrs_[i]));
+    }
+
+    EXPECT_NO_THROW(listener_->stopListening());
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_NO_THROW(sender_->stopSending());
+}
+
 // Tests error handling of a failure to mark the watch socket ready, when
 // sendRequestt() is called.
 TEST(NameChangeUDPSenderBasicTest, watchClosedBeforeSendRequest) {
@@ -586,6 +586,81 @@ TEST(NameChangeRequestTest, toFromBufferTest) {
     ASSERT_EQ(final_str, msg_str);
 }
 
+/// @brief Tests converting to and from the binary format.
+/// This test verifies that each of the valid requests survives a round trip
+/// through the binary format and that several requests written to the
+/// same buffer are read back in order.
+TEST(NameChangeRequestTest, toFromBinaryTest) {
+    int num_msgs = sizeof(valid_msgs)/sizeof(char*);
+    isc::util::OutputBuffer output_buffer(1024);
+    std::vector<NameChangeRequestPtr> ncrs;
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[i]));
+        ASSERT_NO_THROW(ncr->toFormat(FMT_BINARY, output_buffer));
+        ncrs.push_back(ncr);
+    }
+
+    // Read them back from the one buffer.
+    isc::util::InputBuffer input_buffer(output_buffer.getData(),
+                                        output_buffer.getLength());
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromFormat(FMT_BINARY,
+                                                            input_buffer));
+        EXPECT_TRUE(*ncr == *(ncrs[i]));
+        EXPECT_EQ(ncrs[i]->toJSON(), ncr->toJSON());
+    }
+    EXPECT_EQ(output_buffer.getLength(), input_buffer.getPosition());
+
+    // Nothing left to read.
+    EXPECT_THROW(NameChangeRequest::fromFormat(FMT_BINARY, input_buffer),
+                 NcrMessageError);
+}
+
+/// @brief Tests that invalid binary renditions are rejected.
+TEST(NameChangeRequestTest, invalidBinary) {
+    NameChangeRequestPtr ncr;
+    ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[0]));
+    isc::util::OutputBuffer output_buffer(1024);
+    ASSERT_NO_THROW(ncr->toBinary(output_buffer));
+    const std::vector<uint8_t> valid(static_cast<const uint8_t*>
+                                     (output_buffer.getData()),
+                                     static_cast<const uint8_t*>
+                                     (output_buffer.getData()) +
+                                     output_buffer.getLength());
+
+    // Truncated request.
+    std::vector<uint8_t> data(valid.begin(), valid.end() - 1);
+    isc::util::InputBuffer truncated(&data[0], data.size());
+    EXPECT_THROW(NameChangeRequest::fromBinary(truncated), NcrMessageError);
+
+    // Invalid change type.
+    data = valid;
+    data[2] = 7;
+    isc::util::InputBuffer bad_type(&data[0], data.size());
+    EXPECT_THROW(NameChangeRequest::fromBinary(bad_type), NcrMessageError);
+
+    // Invalid address length.
+    data = valid;
+    data[4] = 5;
+    isc::util::InputBuffer bad_address(&data[0], data.size());
+    EXPECT_THROW(NameChangeRequest::fromBinary(bad_address), NcrMessageError);
+
+    // Length prefix not matching the content.
+    data = valid;
+    data.push_back(0);
+    ++data[1];
+    isc::util::InputBuffer bad_length(&data[0], data.size());
+    EXPECT_THROW(NameChangeRequest::fromBinary(bad_length), NcrMessageError);
+
+    // Neither forward nor reverse change.
+    data = valid;
+    data[3] = 0;
+    isc::util::InputBuffer no_change(&data[0], data.size());
+    EXPECT_THROW(NameChangeRequest::fromBinary(no_change), NcrMessageError);
+}
+
 /// @brief Tests ip address modification and validation
 TEST(NameChangeRequestTest, ipAddresses) {
     NameChangeRequest ncr;
@@ -612,9 +687,12 @@ TEST(NameChangeRequestTest, ipAddresses) {
 TEST(NameChangeFormatTest, formatEnumConversion){
     ASSERT_EQ(stringToNcrFormat("JSON"), dhcp_ddns::FMT_JSON);
     ASSERT_EQ(stringToNcrFormat("jSoN"), dhcp_ddns::FMT_JSON);
+    ASSERT_EQ(stringToNcrFormat("BINARY"), dhcp_ddns::FMT_BINARY);
+    ASSERT_EQ(stringToNcrFormat("binary"), dhcp_ddns::FMT_BINARY);
     ASSERT_THROW(stringToNcrFormat("bogus"), isc::BadValue);
 
     ASSERT_EQ(ncrFormatToString(dhcp_ddns::FMT_JSON), "JSON");
+    ASSERT_EQ(ncrFormatToString(dhcp_ddns::FMT_BINARY), "BINARY");
 }
 
 /// @brief Tests conversion of NameChangeProtocol between enum and strings.
@@ -623,10 +701,13 @@ TEST(NameChangeProtocolTest, protocolEnumConversion){
     ASSERT_EQ(stringToNcrProtocol("udP"), dhcp_ddns::NCR_UDP);
     ASSERT_EQ(stringToNcrProtocol("TCP"), dhcp_ddns::NCR_TCP);
     ASSERT_EQ(stringToNcrProtocol("Tcp"), dhcp_ddns::NCR_TCP);
+    ASSERT_EQ(stringToNcrProtocol("SHM"), dhcp_ddns::NCR_SHM);
+    ASSERT_EQ(stringToNcrProtocol("shm"), dhcp_ddns::NCR_SHM);
     ASSERT_THROW(stringToNcrProtocol("bogus"), isc::BadValue);
 
     ASSERT_EQ(ncrProtocolToString(dhcp_ddns::NCR_UDP), "UDP");
     ASSERT_EQ(ncrProtocolToString(dhcp_ddns::NCR_TCP), "TCP");
+    ASSERT_EQ(ncrProtocolToString(dhcp_ddns::NCR_SHM), "SHM");
 }
 
 } // end of anonymous namespace
@@ -59,86 +59,31 @@ AllocEngine::IterativeAllocator::IterativeAllocator(Lease::Type lease_type)
 
 isc::asiolink::IOAddress
 AllocEngine::IterativeAllocator::increaseAddress(const isc::asiolink::IOAddress& addr) {
-    // Get a buffer holding an address.
-    const std::vector<uint8_t>& vec = addr.toBytes();
-    // Get the address length.
-    const int len = vec.size();
-
-    // Since the same array will be used to hold the IPv4 and IPv6
-    // address we have to make sure that the size of the array
-    // we allocate will work for both types of address.
-    BOOST_STATIC_ASSERT(V4ADDRESS_LEN <= V6ADDRESS_LEN);
-    uint8_t packed[V6ADDRESS_LEN];
-
-    // Copy the address. It can be either V4 or V6.
-    std::memcpy(packed, &vec[0], len);
-
-    // Start increasing the least significant byte
-    for (int i = len - 1; i >= 0; --i) {
-        ++packed[i];
-        // if we haven't overflowed (0xff -> 0x0), than we are done
-        if (packed[i] != 0) {
-            break;
-        }
-    }
-
-    return (IOAddress::fromBytes(addr.getFamily(), packed));
+    return (CompactAddress(addr).next().toIOAddress());
 }
 
 isc::asiolink::IOAddress
 AllocEngine::IterativeAllocator::increasePrefix(const isc::asiolink::IOAddress& prefix,
                                                 const uint8_t prefix_len) {
+    return (increasePrefix(CompactAddress(prefix), prefix_len).toIOAddress());
+}
+
+isc::asiolink::CompactAddress
+AllocEngine::IterativeAllocator::increasePrefix(const isc::asiolink::CompactAddress& prefix,
+                                                const uint8_t prefix_len) {
     if (!prefix.isV6()) {
         isc_throw(BadValue, "Prefix operations are for IPv6 only (attempted to "
                   "increase prefix " << prefix << ")");
     }
 
-    // Get a buffer holding an address.
-    const std::vector<uint8_t>& vec = prefix.toBytes();
-
     if (prefix_len < 1 || prefix_len > 128) {
         isc_throw(BadValue, "Cannot increase prefix: invalid prefix length: "
                   << prefix_len);
     }
 
-    // Brief explanation what happens here:
-    // http://www.youtube.com/watch?v=NFQCYpIHLNQ
-
-    uint8_t n_bytes = (prefix_len - 1)/8;
-    uint8_t n_bits = 8 - (prefix_len - n_bytes*8);
-    uint8_t mask = 1 << n_bits;
-
-    // Longer explanation: n_bytes specifies number of full bytes that are
-    // in-prefix. They can also be used as an offset for the first byte that
-    // is not in prefix. n_bits specifies number of bits on the last byte that
-    // is (often partially) in prefix. For example for a /125 prefix, the values
-    // are 15 and 3, respectively. Mask is a bitmask that has the least
-    // significant bit from the prefix set.
-
-    uint8_t packed[V6ADDRESS_LEN];
-
-    // Copy the address. It must be V6, but we already checked that.
-    std::memcpy(packed, &vec[0], V6ADDRESS_LEN);
-
-    // Can we safely increase only the last byte in prefix without overflow?
-    if (packed[n_bytes] + uint16_t(mask) < 256u) {
-        packed[n_bytes] += mask;
-        return (IOAddress::fromBytes(AF_INET6, packed));
-    }
-
-    // Overflow (done on uint8_t, but the sum is greater than 255)
-    packed[n_bytes] += mask;
-
-    // Deal with the overflow. Start increasing the least significant byte
-    for (int i = n_bytes - 1; i >= 0; --i) {
-        ++packed[i];
-        // If we haven't overflowed (0xff->0x0) the next byte, then we are done
-        if (packed[i] != 0) {
-            break;
-        }
-    }
-
-    return (IOAddress::fromBytes(AF_INET6, packed));
+    // Add one to the last bit of the prefix.  Like for the addresses,
+    // the highest prefix is followed by the lowest one.
+    return (prefix.nextPrefix(prefix_len));
 }
 
 
@@ -152,8 +97,9 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
 
     // Let's get the last allocated address. It is usually set correctly,
     // but there are times when it won't be (like after removing a pool or
-    // perhaps restarting the server).
-    IOAddress last = subnet->getLastAllocated(pool_type_);
+    // perhaps restarting the server).  The address is converted once: the
+    // pool checks and the increase below work on the compact form.
+    const CompactAddress last(subnet->getLastAllocated(pool_type_));
 
     const PoolCollection& pools = subnet->getPools(pool_type_);
 
@@ -182,9 +128,9 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
 
     // Ok, we have a pool that the last address belonged to, let's use it.
 
-    IOAddress next("::");
+    CompactAddress next;
     if (!prefix) {
-        next = increaseAddress(last); // basically addr++
+        next = last.next(); // basically addr++
     } else {
         Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(*it);
         if (!pool6) {
@@ -197,8 +143,9 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
     }
     if ((*it)->inRange(next)) {
         // the next one is in the pool as well, so we haven't hit pool boundary yet
-        subnet->setLastAllocated(pool_type_, next);
-        return (next);
+        const IOAddress next_addr = next.toIOAddress();
+        subnet->setLastAllocated(pool_type_, next_addr);
+        return (next_addr);
     }
 
     // We hit pool boundary, let's try to jump to the next pool and try again
@@ -206,15 +153,15 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
     if (it == pools.end()) {
         // Really out of luck today. That was the last pool. Let's rewind
         // to the beginning.
-        next = pools[0]->getFirstAddress();
-        subnet->setLastAllocated(pool_type_, next);
-        return (next);
+        IOAddress first = pools[0]->getFirstAddress();
+        subnet->setLastAllocated(pool_type_, first);
+        return (first);
     }
 
     // there is a next pool, let's try first address from it
-    next = (*it)->getFirstAddress();
-    subnet->setLastAllocated(pool_type_, next);
-    return (next);
+    IOAddress first = (*it)->getFirstAddress();
+    subnet->setLastAllocated(pool_type_, first);
+    return (first);
 }
 
 AllocEngine::HashedAllocator::HashedAllocator(Lease::Type lease_type)
@@ -15,6 +15,7 @@
 #ifndef ALLOC_ENGINE_H
 #define ALLOC_ENGINE_H
 
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <dhcp/duid.h>
 #include <dhcp/hwaddr.h>
@@ -157,6 +158,18 @@ protected:
         static isc::asiolink::IOAddress
         increasePrefix(const isc::asiolink::IOAddress& prefix,
                        const uint8_t prefix_len);
+
+        /// @brief Returns the next prefix
+        ///
+        /// This is the variant of the method above used by
+        /// @c pickAddress(), which works on compact addresses.
+        ///
+        /// @param prefix prefix to be increased
+        /// @param prefix_len length of the prefix to be increased
+        /// @return result prefix
+        static isc::asiolink::CompactAddress
+        increasePrefix(const isc::asiolink::CompactAddress& prefix,
+                       const uint8_t prefix_len);
     };
 
     /// @brief Address/prefix allocator that gets an address based on a hash
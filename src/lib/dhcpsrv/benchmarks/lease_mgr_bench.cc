@@ -0,0 +1,566 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <log/logger_support.h>
+#include <stats/histogram.h>
+#include <util/monotonic_clock.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::stats;
+using namespace isc::util;
+
+namespace {
+
+// This benchmark measures the performance of the lease database backends.
+// For each backend and dataset size, the leases are added to the empty
+// database and then looked up, updated and deleted. Each operation is
+// run the specified number of times or until the time limit expires,
+// whichever comes first, as some lookups scan all leases. The latency
+// of each operation is recorded in the histogram and the growth of the
+// memory used by the process after adding the leases is reported as the
+// footprint of the in-memory backends.
+
+/// @brief Returns the memory used by the process in kilobytes.
+///
+/// With the GNU C library, the size of the allocated heap memory is
+/// returned, which is not affected by the memory freed and reused within
+/// the process. Otherwise, the resident memory size is returned.
+///
+/// @return Memory size or 0 if it can't be determined.
+size_t
+getMemoryKB() {
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return ((info.uordblks + info.hblkhd) / 1024);
+#else
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return (strtoul(line.c_str() + 6, NULL, 10));
+        }
+    }
+    return (0);
+#endif
+}
+
+/// @brief Returns the index of the randomly selected lease.
+///
+/// @param leases Number of leases.
+size_t
+getRandomIndex(const size_t leases) {
+    // RAND_MAX may be as low as 32767, so two values are combined.
+    const uint64_t value = (static_cast<uint64_t>(rand()) << 31) ^ rand();
+    return (value % leases);
+}
+
+/// @brief Returns the identifier of the lease owner.
+///
+/// @param index Index of the lease.
+/// @param length Length of the identifier.
+/// @param prefix First byte of the identifier.
+vector<uint8_t>
+getIdentifier(const size_t index, const size_t length, const uint8_t prefix) {
+    vector<uint8_t> id(length, 0);
+    id[0] = prefix;
+    for (size_t i = 0; i < 4; ++i) {
+        id[length - 1 - i] = (index >> (8 * i)) & 0xff;
+    }
+    return (id);
+}
+
+/// @brief Returns the hardware address of the DHCPv4 lease owner.
+vector<uint8_t>
+getHWAddr(const size_t index) {
+    return (getIdentifier(index, 6, 0x02));
+}
+
+/// @brief Returns the client identifier of the DHCPv4 lease owner.
+vector<uint8_t>
+getClientId(const size_t index) {
+    return (getIdentifier(index, 7, 0x01));
+}
+
+/// @brief Returns the DUID of the DHCPv6 lease owner.
+vector<uint8_t>
+getDuid(const size_t index) {
+    return (getIdentifier(index, 14, 0x00));
+}
+
+/// @brief Returns the leased IPv4 address.
+IOAddress
+getAddress4(const size_t index) {
+    // The leases are allocated from the 10.0.0.0/8 network.
+    return (IOAddress(0x0a000000 + static_cast<uint32_t>(index)));
+}
+
+/// @brief Returns the leased IPv6 address.
+IOAddress
+getAddress6(const size_t index) {
+    // The leases are allocated from the 2001:db8::/96 network.
+    uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+    for (size_t i = 0; i < 4; ++i) {
+        bytes[15 - i] = (index >> (8 * i)) & 0xff;
+    }
+    return (IOAddress::fromBytes(AF_INET6, bytes));
+}
+
+/// @brief Creates the DHCPv4 lease.
+Lease4Ptr
+createLease4(const size_t index) {
+    const vector<uint8_t> hwaddr = getHWAddr(index);
+    const vector<uint8_t> client_id = getClientId(index);
+    return (Lease4Ptr(new Lease4(getAddress4(index), &hwaddr[0],
+                                 hwaddr.size(), &client_id[0],
+                                 client_id.size(), 4000, 1000, 2000,
+                                 time(NULL), 1)));
+}
+
+/// @brief Creates the DHCPv6 lease.
+Lease6Ptr
+createLease6(const size_t index) {
+    DuidPtr duid(new DUID(getDuid(index)));
+    return (Lease6Ptr(new Lease6(Lease::TYPE_NA, getAddress6(index), duid,
+                                 index, 3000, 4000, 1000, 2000, 1)));
+}
+
+/// @brief Adds the DHCPv4 leases in the order of addresses.
+class AddLease4 {
+public:
+    void prepare(const size_t index) {
+        lease_ = createLease4(index);
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().addLease(lease_);
+    }
+private:
+    Lease4Ptr lease_;
+};
+
+/// @brief Adds the DHCPv6 leases in the order of addresses.
+class AddLease6 {
+public:
+    void prepare(const size_t index) {
+        lease_ = createLease6(index);
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().addLease(lease_);
+    }
+private:
+    Lease6Ptr lease_;
+};
+
+/// @brief Deletes the leases in the order of addresses.
+class DeleteLease {
+public:
+    DeleteLease(const bool v4) : v4_(v4), address_("::") {
+    }
+    void prepare(const size_t index) {
+        address_ = v4_ ? getAddress4(index) : getAddress6(index);
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().deleteLease(address_);
+    }
+private:
+    bool v4_;
+    IOAddress address_;
+};
+
+/// @brief Looks up the random DHCPv4 lease by the address.
+class GetLease4ByAddress {
+public:
+    GetLease4ByAddress(const size_t leases) : leases_(leases), address_(0) {
+    }
+    void prepare(const size_t) {
+        address_ = getAddress4(getRandomIndex(leases_));
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().getLease4(address_);
+    }
+private:
+    size_t leases_;
+    IOAddress address_;
+};
+
+/// @brief Looks up the random DHCPv4 lease by the hardware address.
+class GetLease4ByHWAddr {
+public:
+    GetLease4ByHWAddr(const size_t leases) : leases_(leases) {
+    }
+    void prepare(const size_t) {
+        hwaddr_.reset(new HWAddr(getHWAddr(getRandomIndex(leases_)),
+                                 HTYPE_ETHER));
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().getLease4(*hwaddr_);
+    }
+private:
+    size_t leases_;
+    HWAddrPtr hwaddr_;
+};
+
+/// @brief Looks up the random DHCPv4 lease by the client identifier.
+class GetLease4ByClientId {
+public:
+    GetLease4ByClientId(const size_t leases) : leases_(leases) {
+    }
+    void prepare(const size_t) {
+        client_id_.reset(new ClientId(getClientId(getRandomIndex(leases_))));
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().getLease4(*client_id_);
+    }
+private:
+    size_t leases_;
+    ClientIdPtr client_id_;
+};
+
+/// @brief Looks up the random DHCPv6 lease by the address.
+class GetLease6ByAddress {
+public:
+    GetLease6ByAddress(const size_t leases) : leases_(leases), address_("::") {
+    }
+    void prepare(const size_t) {
+        address_ = getAddress6(getRandomIndex(leases_));
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA, address_);
+    }
+private:
+    size_t leases_;
+    IOAddress address_;
+};
+
+/// @brief Looks up the random DHCPv6 lease by the DUID and IAID.
+class GetLeases6ByDuidIaid {
+public:
+    GetLeases6ByDuidIaid(const size_t leases) : leases_(leases), iaid_(0) {
+    }
+    void prepare(const size_t) {
+        iaid_ = getRandomIndex(leases_);
+        duid_.reset(new DUID(getDuid(iaid_)));
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().getLeases6(Lease::TYPE_NA, *duid_, iaid_);
+    }
+private:
+    size_t leases_;
+    uint32_t iaid_;
+    DuidPtr duid_;
+};
+
+/// @brief Renews the random DHCPv4 lease.
+class UpdateLease4 {
+public:
+    UpdateLease4(const size_t leases) : leases_(leases) {
+    }
+    void prepare(const size_t) {
+        lease_ = LeaseMgrFactory::instance().
+            getLease4(getAddress4(getRandomIndex(leases_)));
+        lease_->cltt_ = time(NULL);
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().updateLease4(lease_);
+    }
+private:
+    size_t leases_;
+    Lease4Ptr lease_;
+};
+
+/// @brief Renews the random DHCPv6 lease.
+class UpdateLease6 {
+public:
+    UpdateLease6(const size_t leases) : leases_(leases) {
+    }
+    void prepare(const size_t) {
+        lease_ = LeaseMgrFactory::instance().
+            getLease6(Lease::TYPE_NA, getAddress6(getRandomIndex(leases_)));
+        lease_->cltt_ = time(NULL);
+    }
+    void operator()() {
+        LeaseMgrFactory::instance().updateLease6(lease_);
+    }
+private:
+    size_t leases_;
+    Lease6Ptr lease_;
+};
+
+/// @brief Runs the operation and reports its throughput and latency.
+///
+/// @param name Name of the operation.
+/// @param op Operation to be run.
+/// @param count Maximum number of operations.
+/// @param time_limit Maximum duration in seconds.
+template <typename Operation>
+void
+runOperation(const string& name, Operation op, const size_t count,
+             const unsigned int time_limit) {
+    Histogram latency(name);
+    const uint64_t limit = static_cast<uint64_t>(time_limit) * 1000000000;
+    const uint64_t start = getMonotonicNanos();
+    for (size_t i = 0; i < count; ++i) {
+        op.prepare(i);
+        {
+            ScopedLatency timer(latency);
+            op();
+        }
+        if (((i & 0xff) == 0xff) && (getMonotonicNanos() - start > limit)) {
+            break;
+        }
+    }
+    const double seconds = static_cast<double>(latency.getSum()) / 1e9;
+    cout << "  " << left << setw(24) << name << right
+         << setw(10) << latency.getCount()
+         << setw(12) << fixed << setprecision(0)
+         << (seconds > 0 ? latency.getCount() / seconds : 0)
+         << setw(10) << setprecision(1)
+         << (static_cast<double>(latency.getPercentile(50)) / 1000)
+         << setw(10) << (static_cast<double>(latency.getPercentile(99)) / 1000)
+         << setw(10)
+         << (static_cast<double>(latency.getPercentile(99.9)) / 1000)
+         << setw(12) << (static_cast<double>(latency.getMax()) / 1000)
+         << endl;
+}
+
+/// @brief Runs all operations on the backend with the number of leases.
+///
+/// @param dbaccess Lease database access string without the universe.
+/// @param v4 Benchmark DHCPv4 (true) or DHCPv6 (false) leases.
+/// @param leases Number of leases.
+/// @param count Maximum number of the lookups and updates.
+/// @param time_limit Maximum duration of each operation in seconds.
+void
+runBenchmark(const string& dbaccess, const bool v4, const size_t leases,
+             const size_t count, const unsigned int time_limit) {
+    const string access = dbaccess + (v4 ? " universe=4" : " universe=6");
+    cout << (v4 ? "DHCPv4" : "DHCPv6") << " leases: " << leases
+         << ", backend: " << dbaccess << endl;
+    cout << "  " << left << setw(24) << "Operation" << right
+         << setw(10) << "count" << setw(12) << "ops/s" << setw(10)
+         << "p50 (us)" << setw(10) << "p99 (us)" << setw(10) << "p99.9"
+         << setw(12) << "max (us)" << endl;
+
+    const size_t memory_start = getMemoryKB();
+    LeaseMgrFactory::create(access);
+    if (v4) {
+        runOperation("addLease", AddLease4(), leases, ~0U);
+    } else {
+        runOperation("addLease", AddLease6(), leases, ~0U);
+    }
+    const size_t memory_end = getMemoryKB();
+    const size_t memory_used = (memory_end > memory_start ?
+                                memory_end - memory_start : 0);
+
+    if (v4) {
+        runOperation("getLease4(address)", GetLease4ByAddress(leases),
+                     count, time_limit);
+        runOperation("getLease4(hwaddr)", GetLease4ByHWAddr(leases),
+                     count, time_limit);
+        runOperation("getLease4(client-id)", GetLease4ByClientId(leases),
+                     count, time_limit);
+        runOperation("updateLease4", UpdateLease4(leases), count,
+                     time_limit);
+    } else {
+        runOperation("getLease6(address)", GetLease6ByAddress(leases),
+                     count, time_limit);
+        runOperation("getLeases6(duid, iaid)", GetLeases6ByDuidIaid(leases),
+                     count, time_limit);
+        runOperation("updateLease6", UpdateLease6(leases), count,
+                     time_limit);
+    }
+
+    // Reopening the database reloads the lease file of the memfile
+    // backend.
+    LeaseMgrFactory::destroy();
+    const uint64_t reopen_start = getMonotonicNanos();
+    LeaseMgrFactory::create(access);
+    const double reopen_seconds =
+        static_cast<double>(getMonotonicNanos() - reopen_start) / 1e9;
+
+    // A backend which doesn't persist the leases is empty after it has
+    // been reopened: add the leases again, untimed, so that deleteLease
+    // measures the deletion of existing leases.
+    const bool persistent = (v4 ?
+        static_cast<bool>(LeaseMgrFactory::instance().
+                          getLease4(getAddress4(0))) :
+        static_cast<bool>(LeaseMgrFactory::instance().
+                          getLease6(Lease::TYPE_NA, getAddress6(0))));
+    if (!persistent) {
+        AddLease4 add4;
+        AddLease6 add6;
+        for (size_t i = 0; i < leases; ++i) {
+            if (v4) {
+                add4.prepare(i);
+                add4();
+            } else {
+                add6.prepare(i);
+                add6();
+            }
+        }
+    }
+
+    runOperation("deleteLease", DeleteLease(v4), leases, ~0U);
+    LeaseMgrFactory::destroy();
+
+    if (persistent) {
+        cout << "  Reopen: " << setprecision(3) << reopen_seconds << " s"
+             << endl;
+    } else {
+        cout << "  Reopen: n/a (the backend doesn't persist the leases)"
+             << endl;
+    }
+    cout << "  Memory: " << memory_used << " kB";
+    if (memory_used > 0) {
+        cout << " (" << setprecision(0)
+             << (static_cast<double>(memory_used) * 1024 / leases)
+             << " bytes per lease)";
+    }
+    cout << endl;
+}
+
+/// @brief Parses the comma separated list of the dataset sizes.
+///
+/// @param list List of sizes.
+/// @return Parsed sizes, empty if any of them is invalid.
+vector<size_t>
+parseSizes(const string& list) {
+    vector<size_t> sizes;
+    istringstream s(list);
+    string item;
+    while (getline(s, item, ',')) {
+        const size_t size = strtoul(item.c_str(), NULL, 10);
+        // The addresses are allocated from the /8 IPv4 network.
+        if ((size == 0) || (size > 0xffffff)) {
+            return (vector<size_t>());
+        }
+        sizes.push_back(size);
+    }
+    return (sizes);
+}
+
+void
+usage() {
+    cerr << "Usage: lease_mgr_bench [-4|-6] [-n leases] [-c count]"
+         << " [-t seconds] [-d dbaccess]..." << endl;
+    cerr << "  -4, -6       benchmark only DHCPv4 or DHCPv6 leases" << endl;
+    cerr << "  -n leases    comma separated list of the numbers of leases"
+         << " (10000,100000)" << endl;
+    cerr << "  -c count     maximum number of lookups and updates of each"
+         << " type (100000)" << endl;
+    cerr << "  -t seconds   maximum duration of each lookup and update"
+         << " type (10)" << endl;
+    cerr << "  -d dbaccess  lease database access string without the"
+         << " universe, may be" << endl
+         << "               repeated (memfile with persistence disabled"
+         << " and enabled)" << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    bool v4 = true;
+    bool v6 = true;
+    vector<size_t> sizes = parseSizes("10000,100000");
+    size_t count = 100000;
+    unsigned int time_limit = 10;
+    vector<string> backends;
+    while ((ch = getopt(argc, argv, "46n:c:t:d:")) != -1) {
+        switch (ch) {
+        case '4':
+            v6 = false;
+            break;
+        case '6':
+            v4 = false;
+            break;
+        case 'n':
+            sizes = parseSizes(optarg);
+            break;
+        case 'c':
+            count = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            time_limit = atoi(optarg);
+            break;
+        case 'd':
+            backends.push_back(optarg);
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if ((argc != 0) || (!v4 && !v6) || sizes.empty() || (count == 0) ||
+        (time_limit == 0)) {
+        usage();
+    }
+
+    // The lease files created by the benchmark are removed at the end.
+    const string file4 = "lease_mgr_bench4.csv";
+    const string file6 = "lease_mgr_bench6.csv";
+    const bool temporary = backends.empty();
+    if (temporary) {
+        backends.push_back("type=memfile persist=false");
+        backends.push_back("type=memfile persist=true name=");
+    }
+
+    isc::log::initLogger("lease_mgr_bench", isc::log::ERROR);
+    srand(time(NULL));
+
+    for (size_t i = 0; i < backends.size(); ++i) {
+        for (size_t j = 0; j < sizes.size(); ++j) {
+            const bool persistent = temporary &&
+                (backends[i].find("persist=true") != string::npos);
+            if (v4) {
+                if (persistent) {
+                    unlink(file4.c_str());
+                }
+                runBenchmark(backends[i] + (persistent ? file4 : ""), true,
+                             sizes[j], count, time_limit);
+            }
+            if (v6) {
+                if (persistent) {
+                    unlink(file6.c_str());
+                }
+                runBenchmark(backends[i] + (persistent ? file6 : ""), false,
+                             sizes[j], count, time_limit);
+            }
+        }
+    }
+    if (temporary) {
+        unlink(file4.c_str());
+        unlink(file6.c_str());
+    }
+    return (0);
+}
@@ -12,6 +12,7 @@
 // OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 // PERFORMANCE OF THIS SOFTWARE.
 
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <dhcp/iface_mgr.h>
 #include <dhcp/libdhcp++.h>
@@ -93,6 +94,9 @@ CfgMgr::getSubnet6(const isc::asiolink::IOAddress& hint,
                    const isc::dhcp::ClientClasses& classes,
                    const bool relay) {
 
+    // The hint is checked against each subnet: convert it once.
+    const CompactAddress compact_hint(hint);
+
     // If there is more than one, we need to choose the proper one
     for (Subnet6Collection::iterator subnet = subnets6_.begin();
          subnet != subnets6_.end(); ++subnet) {
@@ -111,7 +115,7 @@ CfgMgr::getSubnet6(const isc::asiolink::IOAddress& hint,
             return (*subnet);
         }
 
-        if ((*subnet)->inRange(hint)) {
+        if ((*subnet)->inRange(compact_hint)) {
             LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_SUBNET6)
                       .arg((*subnet)->toText()).arg(hint.toText());
             return (*subnet);
@@ -169,7 +173,8 @@ CfgMgr::getSubnet4(const isc::asiolink::IOAddress& hint,
                    const isc::dhcp::ClientClasses& classes,
                    bool relay) const {
     // Iterate over existing subnets to find a suitable one for the
-    // given address.
+    // given address.  The address is converted once for the checks.
+    const CompactAddress compact_hint(hint);
     for (Subnet4Collection::const_iterator subnet = subnets4_.begin();
          subnet != subnets4_.end(); ++subnet) {
 
@@ -188,7 +193,7 @@ CfgMgr::getSubnet4(const isc::asiolink::IOAddress& hint,
         }
 
         // Let's check if the client belongs to the given subnet
-        if ((*subnet)->inRange(hint)) {
+        if ((*subnet)->inRange(compact_hint)) {
             LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
                       DHCPSRV_CFGMGR_SUBNET4)
                       .arg((*subnet)->toText()).arg(hint.toText());
@@ -241,6 +246,18 @@ void CfgMgr::deleteSubnets6() {
     subnets6_.clear();
 }
 
+void CfgMgr::replaceSubnets4(Subnet4Collection& subnets) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_REPLACE_SUBNETS4)
+        .arg(subnets.size());
+    subnets4_.swap(subnets);
+}
+
+void CfgMgr::replaceSubnets6(Subnet6Collection& subnets) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_REPLACE_SUBNETS6)
+        .arg(subnets.size());
+    subnets6_.swap(subnets);
+}
+
 
 std::string CfgMgr::getDataDir() {
     return (datadir_);
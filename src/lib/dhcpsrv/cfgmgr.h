@@ -215,6 +215,21 @@ public:
     /// completely new?
     void deleteSubnets6();
 
+    /// @brief replaces all IPv6 subnets
+    ///
+    /// This method is used during reconfiguration to install the subnets
+    /// parsed (or reused) by the subnet list parser in a single step. The
+    /// contents of the specified collection and the collection held by the
+    /// Configuration Manager are swapped, so it is a constant time operation
+    /// and the caller receives the previous subnets.
+    ///
+    /// The caller is responsible for making sure that the subnet
+    /// identifiers are unique.
+    ///
+    /// @param subnets new collection of subnets, replaced with the previous
+    /// subnets upon return.
+    void replaceSubnets6(Subnet6Collection& subnets);
+
     /// @brief Returns pointer to the collection of all IPv4 subnets.
     ///
     /// This is used in a hook (subnet4_select), where the hook is able
@@ -291,6 +306,21 @@ public:
     /// completely new?
     void deleteSubnets4();
 
+    /// @brief replaces all IPv4 subnets
+    ///
+    /// This method is used during reconfiguration to install the subnets
+    /// parsed (or reused) by the subnet list parser in a single step. The
+    /// contents of the specified collection and the collection held by the
+    /// Configuration Manager are swapped, so it is a constant time operation
+    /// and the caller receives the previous subnets.
+    ///
+    /// The caller is responsible for making sure that the subnet
+    /// identifiers are unique.
+    ///
+    /// @param subnets new collection of subnets, replaced with the previous
+    /// subnets upon return.
+    void replaceSubnets4(Subnet4Collection& subnets);
+
 
     /// @brief returns path do the data directory
     ///
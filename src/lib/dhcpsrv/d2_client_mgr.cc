@@ -13,6 +13,7 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <dhcp/iface_mgr.h>
+#include <dhcp_ddns/ncr_shm.h>
 #include <dhcp_ddns/ncr_udp.h>
 #include <dhcpsrv/d2_client_mgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
@@ -79,6 +80,16 @@ D2ClientMgr::setD2ClientConfig(D2ClientConfigPtr& new_config) {
                                                 new_config->getMaxQueueSize()));
                 break;
                 }
+            case dhcp_ddns::NCR_SHM: {
+                // The sender is identified by the server address and port.
+                new_sender.reset(new dhcp_ddns::NameChangeShmSender(
+                                                new_config->getServerIp(),
+                                                new_config->getServerPort(),
+                                                new_config->getNcrFormat(),
+                                                *this,
+                                                new_config->getMaxQueueSize()));
+                break;
+                }
             default:
                 // In theory you can't get here.
                 isc_throw(D2ClientError, "Invalid sender Protocol: "
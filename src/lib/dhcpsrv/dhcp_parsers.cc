@@ -19,6 +19,7 @@
 #include <hooks/hooks_manager.h>
 #include <util/encode/hex.h>
 #include <util/strutil.h>
+#include <util/threads/sync.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/foreach.hpp>
@@ -33,6 +34,17 @@ using namespace isc::asiolink;
 using namespace isc::data;
 using namespace isc::hooks;
 
+namespace {
+
+/// @brief Mutex serializing the modifications of the global options.
+///
+/// The subnet parsers may be built concurrently (see
+/// @c ParallelParserBuilder) and they all append sub-options to the same
+/// global option instances.
+isc::util::thread::Mutex global_options_mutex;
+
+}
+
 namespace isc {
 namespace dhcp {
 
@@ -1206,7 +1218,11 @@ SubnetConfigParser::createSubnet() {
                                                 desc.option->getType());
             if (!existing_desc.option) {
                 // Add sub-options (if any).
-                appendSubOptions(option_space, desc.option);
+                {
+                    isc::util::thread::Mutex::Locker
+                        lock(global_options_mutex);
+                    appendSubOptions(option_space, desc.option);
+                }
 
                 uint32_t vendor_id = optionSpaceToVendorId(option_space);
                 if (vendor_id) {
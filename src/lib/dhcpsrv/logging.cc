@@ -102,6 +102,33 @@ void LogConfigParser::parseConfigEntry(isc::data::ConstElementPtr entry) {
         }
     }
 
+    // Asynchronous output is disabled by default.
+    isc::data::ConstElementPtr async_ptr = entry->get("async");
+    if (async_ptr) {
+        try {
+            info.async_ = async_ptr->boolValue();
+        } catch (...) {
+            isc_throw(BadValue, "Unsupported async value '"
+                      << async_ptr->str() << "', expected boolean ("
+                      << async_ptr->getPosition() << ")");
+        }
+    }
+
+    // By default, the logging threads wait for the asynchronous output.
+    isc::data::ConstElementPtr overflow_ptr = entry->get("overflow");
+    if (overflow_ptr) {
+        const std::string overflow = overflow_ptr->stringValue();
+        if (overflow == "block") {
+            info.overflow_ = isc::log::OVERFLOW_BLOCK;
+        } else if (overflow == "drop") {
+            info.overflow_ = isc::log::OVERFLOW_DROP;
+        } else {
+            isc_throw(BadValue, "Unsupported overflow value '" << overflow
+                      << "', expected 'block' or 'drop' ("
+                      << overflow_ptr->getPosition() << ")");
+        }
+    }
+
     // We want to follow the normal path, so it could catch parsing errors even
     // when verbose mode is enabled. If it is, just override whatever was parsed
     // in the config file.
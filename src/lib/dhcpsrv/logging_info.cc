@@ -30,7 +30,8 @@ LoggingDestination::equals(const LoggingDestination& other) const {
 }
 
 LoggingInfo::LoggingInfo()
-    : name_("kea"), severity_(isc::log::INFO), debuglevel_(0) {
+    : name_("kea"), severity_(isc::log::INFO), debuglevel_(0),
+      async_(false), overflow_(isc::log::OVERFLOW_BLOCK) {
     // If configuration Manager is in the verbose mode, we need to modify the
     // default settings.
     if (CfgMgr::instance().isVerbose()) {
@@ -84,7 +85,9 @@ LoggingInfo::equals(const LoggingInfo& other) const {
     // equality.
     return (name_ == other.name_ &&
             severity_ == other.severity_ &&
-            debuglevel_ == other.debuglevel_);
+            debuglevel_ == other.debuglevel_ &&
+            async_ == other.async_ &&
+            overflow_ == other.overflow_);
 }
 
 LoggerSpecification
@@ -95,6 +98,8 @@ LoggingInfo::toSpec() const {
     static const std::string SYSLOG_COLON = "syslog:";
 
     LoggerSpecification spec(name_, severity_, debuglevel_);
+    spec.setAsync(async_);
+    spec.setOverflow(overflow_);
 
     // Go over logger destinations and create output options accordinly.
     for (std::vector<LoggingDestination>::const_iterator dest =
@@ -67,7 +67,9 @@ struct LoggingDestination {
 ///                }
 ///            ],
 ///            "severity": "WARN",
-///            "debuglevel": 99
+///            "debuglevel": 99,
+///            "async": true,
+///            "overflow": "drop"
 ///        },
 struct LoggingInfo {
 
@@ -82,6 +84,13 @@ struct LoggingInfo {
     /// We use range 0(least verbose)..99(most verbose)
     int debuglevel_;
 
+    /// @brief output the messages from a dedicated thread
+    bool async_;
+
+    /// @brief what to do with the messages when the asynchronous output
+    /// can't keep up (used when async_ is true)
+    isc::log::OverflowPolicy overflow_;
+
     /// @brief specific logging destinations
     std::vector<LoggingDestination> destinations_;
 
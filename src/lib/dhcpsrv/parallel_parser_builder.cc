@@ -0,0 +1,177 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/parallel_parser_builder.h>
+#include <util/threads/thread.h>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace isc::data;
+using namespace isc::util::thread;
+
+namespace isc {
+namespace dhcp {
+
+const size_t ParallelParserBuilder::MIN_PARSERS_PER_THREAD;
+
+ParallelParserBuilder::ParallelParserBuilder(const uint32_t max_threads)
+    : max_threads_(max_threads > 0 ? max_threads : getProcessorsCount()),
+      items_(), sequential_(), concurrent_(), next_concurrent_(0),
+      failed_index_(std::numeric_limits<size_t>::max()), threads_count_(0) {
+}
+
+void
+ParallelParserBuilder::add(const ParserPtr& parser, const ConstElementPtr& config,
+                           const bool sequential) {
+    items_.push_back(Item(parser, config));
+    if (sequential) {
+        sequential_.push_back(items_.size() - 1);
+    } else {
+        concurrent_.push_back(items_.size() - 1);
+    }
+}
+
+void
+ParallelParserBuilder::build() {
+    next_concurrent_ = 0;
+    failed_index_ = std::numeric_limits<size_t>::max();
+
+    threads_count_ = std::min(static_cast<size_t>(max_threads_),
+                              concurrent_.size() / MIN_PARSERS_PER_THREAD);
+
+    if (threads_count_ <= 1) {
+        // Not worth starting the threads: build the parsers in the order
+        // of adding, stopping at the first failure.
+        threads_count_ = 1;
+        for (size_t index = 0; index < items_.size(); ++index) {
+            buildItem(index);
+            if (items_[index].failed_) {
+                break;
+            }
+        }
+
+    } else {
+        LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                  DHCPSRV_PARALLEL_BUILD)
+            .arg(items_.size()).arg(threads_count_);
+
+        // The calling thread is one of the threads so start one less.
+        std::vector<boost::shared_ptr<Thread> > threads;
+        try {
+            while (threads.size() + 1 < threads_count_) {
+                threads.push_back(boost::shared_ptr<Thread>(new Thread(
+                    boost::bind(&ParallelParserBuilder::buildConcurrent,
+                                this))));
+            }
+        } catch (const std::exception&) {
+            // Failed to start the thread. Carry on with the threads started
+            // so far, the calling thread builds whatever remains.
+            threads_count_ = threads.size() + 1;
+        }
+
+        buildSequential();
+
+        // The parsing errors are recorded in the items, so the threads
+        // never throw.
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i]->wait();
+        }
+    }
+
+    if (failed_index_ < items_.size()) {
+        const Item& item = items_[failed_index_];
+        if (item.isc_error_) {
+            isc_throw(DhcpConfigError, item.error_);
+        }
+        throw std::runtime_error(item.error_);
+    }
+}
+
+uint32_t
+ParallelParserBuilder::getProcessorsCount() {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0 ? static_cast<uint32_t>(count) : 1);
+}
+
+void
+ParallelParserBuilder::buildItem(const size_t index) {
+    Item& item = items_[index];
+    try {
+        item.parser_->build(item.config_);
+
+    } catch (const isc::Exception& ex) {
+        item.failed_ = true;
+        item.isc_error_ = true;
+        item.error_ = ex.what();
+
+    } catch (const std::exception& ex) {
+        item.failed_ = true;
+        item.error_ = ex.what();
+
+    } catch (...) {
+        item.failed_ = true;
+        item.error_ = "undefined configuration parsing error";
+    }
+
+    if (item.failed_) {
+        // Record the lowest index of the failed parser. Other threads may
+        // be doing the same thing concurrently.
+        size_t current = failed_index_;
+        while (index < current) {
+            const size_t previous =
+                __sync_val_compare_and_swap(&failed_index_, current, index);
+            if (previous == current) {
+                break;
+            }
+            current = previous;
+        }
+    }
+}
+
+void
+ParallelParserBuilder::buildConcurrent() {
+    for (;;) {
+        const size_t position = __sync_fetch_and_add(&next_concurrent_, 1);
+        if (position >= concurrent_.size()) {
+            return;
+        }
+        // The positions are taken in the increasing order of indexes so
+        // all remaining parsers would be skipped too.
+        const size_t index = concurrent_[position];
+        if (skip(index)) {
+            return;
+        }
+        buildItem(index);
+    }
+}
+
+void
+ParallelParserBuilder::buildSequential() {
+    for (std::vector<size_t>::const_iterator index = sequential_.begin();
+         index != sequential_.end(); ++index) {
+        if (skip(*index)) {
+            break;
+        }
+        buildItem(*index);
+    }
+    buildConcurrent();
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
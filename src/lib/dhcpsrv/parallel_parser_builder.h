@@ -0,0 +1,163 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef PARALLEL_PARSER_BUILDER_H
+#define PARALLEL_PARSER_BUILDER_H
+
+#include <cc/data.h>
+#include <dhcpsrv/dhcp_config_parser.h>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Builds independent parsers using multiple threads.
+///
+/// The list parsers (e.g. the parsers of the subnets list) create one
+/// parser per list entry and build them one after another. When the
+/// parsers don't depend on each other, i.e. they only read the global
+/// configuration context and write into their own storages, they may be
+/// built concurrently. This class distributes the parsers added with
+/// @ref ParallelParserBuilder::add across the thread pool. The threads
+/// take the parsers in the order in which they have been added, the
+/// calling thread takes part in building.
+///
+/// Some parsers must not be built concurrently, e.g. the subnet parsers
+/// which assign automatically generated subnet identifiers, because the
+/// result depends on the order in which they are built. These parsers
+/// are added as sequential: they are built by the calling thread in the
+/// order in which they have been added, concurrently with the other
+/// parsers.
+///
+/// If any of the parsers fails, the error of the first failed parser (in
+/// the order in which the parsers have been added) is reported, which is
+/// the same error as reported when building the parsers one by one.
+///
+/// Parsers are built sequentially by the calling thread if the number of
+/// parsers is too low to benefit from the threads.
+class ParallelParserBuilder : public boost::noncopyable {
+public:
+
+    /// @brief Minimal number of parsers built by each thread.
+    ///
+    /// Starting the thread for a handful of parsers costs more than it
+    /// saves.
+    static const size_t MIN_PARSERS_PER_THREAD = 64;
+
+    /// @brief Constructor.
+    ///
+    /// @param max_threads Maximum number of threads used for building,
+    /// including the calling thread. The value of 0 selects the number of
+    /// processors.
+    explicit ParallelParserBuilder(const uint32_t max_threads);
+
+    /// @brief Adds the parser to be built.
+    ///
+    /// @param parser Parser to be built.
+    /// @param config Configuration to be passed to the parser.
+    /// @param sequential Indicates if the parser must be built by the
+    /// calling thread in the order of adding.
+    void add(const ParserPtr& parser, const isc::data::ConstElementPtr& config,
+             const bool sequential = false);
+
+    /// @brief Builds all added parsers.
+    ///
+    /// @throw DhcpConfigError with the message of the first failed parser
+    /// (in the order of adding) if this parser has thrown the
+    /// @c isc::Exception, std::runtime_error if it has thrown other
+    /// exception.
+    void build();
+
+    /// @brief Returns the number of threads used by the last build,
+    /// including the calling thread.
+    size_t getThreadsCount() const {
+        return (threads_count_);
+    }
+
+    /// @brief Returns the number of processors available.
+    static uint32_t getProcessorsCount();
+
+private:
+
+    /// @brief Parser to be built.
+    struct Item {
+        /// @brief Constructor.
+        Item(const ParserPtr& parser, const isc::data::ConstElementPtr& config)
+            : parser_(parser), config_(config), failed_(false),
+              isc_error_(false), error_() {
+        }
+        /// @brief Parser.
+        ParserPtr parser_;
+        /// @brief Configuration to be passed to the parser.
+        isc::data::ConstElementPtr config_;
+        /// @brief Indicates if the build has failed.
+        bool failed_;
+        /// @brief Indicates if the parser has thrown isc::Exception.
+        bool isc_error_;
+        /// @brief Error message.
+        std::string error_;
+    };
+
+    /// @brief Builds the parser at the index and records its failure.
+    ///
+    /// @param index Index of the parser.
+    void buildItem(const size_t index);
+
+    /// @brief Builds the concurrent parsers until they are exhausted.
+    ///
+    /// This is run by the threads of the pool.
+    void buildConcurrent();
+
+    /// @brief Builds the sequential parsers and then the concurrent ones.
+    ///
+    /// This is run by the calling thread.
+    void buildSequential();
+
+    /// @brief Checks if the parser at the index should be skipped because
+    /// a parser added before it has failed.
+    ///
+    /// @param index Index of the parser.
+    bool skip(const size_t index) const {
+        return (index > failed_index_);
+    }
+
+    /// @brief Maximum number of threads.
+    uint32_t max_threads_;
+
+    /// @brief Parsers in the order of adding.
+    std::vector<Item> items_;
+
+    /// @brief Indexes of the sequential parsers.
+    std::vector<size_t> sequential_;
+
+    /// @brief Indexes of the concurrent parsers.
+    std::vector<size_t> concurrent_;
+
+    /// @brief Position of the next concurrent parser to be built.
+    volatile size_t next_concurrent_;
+
+    /// @brief Lowest index of the failed parser.
+    volatile size_t failed_index_;
+
+    /// @brief Number of threads used by the last build.
+    size_t threads_count_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // PARALLEL_PARSER_BUILDER_H
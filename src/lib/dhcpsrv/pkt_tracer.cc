@@ -0,0 +1,300 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/pkt_tracer.h>
+#include <stats/stats_mgr.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Magic value at the beginning of the trace file.
+const char TRACE_FILE_MAGIC[] = "KEATRACE";
+
+/// @brief Names of the stages used in the histogram names.
+const char* STAGE_NAMES[isc::dhcp::Pkt::STAGE_NUM] = {
+    "total", "parse", "select-subnet", "allocate", "hooks", "send"
+};
+
+/// @brief Writes the header of the trace file and reserves the space for
+/// the records.
+///
+/// @param fd Descriptor of the trace file.
+/// @param capacity Number of record slots in the file.
+///
+/// @return true on success, false otherwise with errno set.
+bool
+initTraceFile(const int fd, const uint32_t capacity) {
+    isc::dhcp::PktTraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic_, TRACE_FILE_MAGIC, sizeof(header.magic_));
+    header.version_ = isc::dhcp::PktTracer::TRACE_FILE_VERSION;
+    header.record_size_ = sizeof(isc::dhcp::PktTraceRecord);
+    header.capacity_ = capacity;
+
+    // Reserve the space for all records up front, so as the file doesn't
+    // grow on the packet processing path.
+    const off_t size = sizeof(header) + static_cast<off_t>(capacity) *
+        sizeof(isc::dhcp::PktTraceRecord);
+    return ((pwrite(fd, &header, sizeof(header), 0) ==
+             static_cast<ssize_t>(sizeof(header))) &&
+            (ftruncate(fd, size) == 0));
+}
+
+}
+
+namespace isc {
+namespace dhcp {
+
+const uint32_t PktTracer::TRACE_FILE_VERSION;
+const uint32_t PktTracer::DEFAULT_TRACE_FILE_RECORDS;
+
+PktTracer::PktTracer()
+    : sampling_rate_(0), sampled_(0), fd_(-1), trace_file_(), capacity_(0),
+      written_(0), staged_(false), staging_rate_(0), staging_file_(),
+      staging_capacity_(0), staging_fd_(-1), staging_temp_() {
+    for (int stage = 0; stage < Pkt::STAGE_NUM; ++stage) {
+        const Pkt::Stage s = static_cast<Pkt::Stage>(stage);
+        histograms_[0][stage] = &StatsMgr::instance().
+            getHistogram(getHistogramName(AF_INET, s));
+        histograms_[1][stage] = &StatsMgr::instance().
+            getHistogram(getHistogramName(AF_INET6, s));
+    }
+}
+
+PktTracer::~PktTracer() {
+    rollback();
+    closeTraceFile();
+}
+
+PktTracer&
+PktTracer::instance() {
+    static PktTracer tracer;
+    return (tracer);
+}
+
+std::string
+PktTracer::getHistogramName(const uint16_t family, const Pkt::Stage stage) {
+    if (stage >= Pkt::STAGE_NUM) {
+        isc_throw(isc::OutOfRange, "invalid packet processing stage "
+                  << static_cast<int>(stage));
+    }
+    return (std::string(family == AF_INET ? "pkt4" : "pkt6") + "-trace-" +
+            STAGE_NAMES[stage] + "-latency");
+}
+
+void
+PktTracer::setSamplingRate(const uint32_t rate) {
+    sampling_rate_ = rate;
+}
+
+void
+PktTracer::configure(const uint32_t rate, const std::string& path,
+                     const uint32_t capacity) {
+    stage(rate, path, capacity);
+    commit();
+}
+
+void
+PktTracer::stage(const uint32_t rate, const std::string& path,
+                 const uint32_t capacity) {
+    rollback();
+
+    if (!path.empty() && ((path != trace_file_) || (capacity != capacity_))) {
+        if (capacity == 0) {
+            isc_throw(PktTracerError, "number of records in the packet trace"
+                      " file must be greater than 0");
+        }
+
+        const std::string suffix(".XXXXXX");
+        std::vector<char> temp(path.begin(), path.end());
+        temp.insert(temp.end(), suffix.begin(), suffix.end());
+        temp.push_back('\0');
+        const int fd = mkstemp(&temp[0]);
+        if (fd < 0) {
+            isc_throw(PktTracerError, "unable to open packet trace file '"
+                      << path << "': " << strerror(errno));
+        }
+        if ((fchmod(fd, 0644) != 0) || !initTraceFile(fd, capacity)) {
+            const int error = errno;
+            close(fd);
+            static_cast<void>(unlink(&temp[0]));
+            isc_throw(PktTracerError, "unable to initialize packet trace"
+                      " file '" << path << "': " << strerror(error));
+        }
+        staging_fd_ = fd;
+        staging_temp_ = &temp[0];
+    }
+
+    staging_rate_ = rate;
+    staging_file_ = path;
+    staging_capacity_ = capacity;
+    staged_ = true;
+}
+
+void
+PktTracer::commit() {
+    if (!staged_) {
+        return;
+    }
+    staged_ = false;
+
+    if (staging_file_.empty()) {
+        closeTraceFile();
+
+    } else if (staging_fd_ >= 0) {
+        const int fd = staging_fd_;
+        staging_fd_ = -1;
+        closeTraceFile();
+        if (rename(staging_temp_.c_str(), staging_file_.c_str()) != 0) {
+            LOG_ERROR(dhcpsrv_logger, DHCPSRV_TRACE_FILE_RENAME_FAIL)
+                .arg(staging_temp_).arg(staging_file_).arg(strerror(errno));
+            close(fd);
+            static_cast<void>(unlink(staging_temp_.c_str()));
+        } else {
+            fd_ = fd;
+            trace_file_ = staging_file_;
+            capacity_ = staging_capacity_;
+            written_ = 0;
+            LOG_INFO(dhcpsrv_logger, DHCPSRV_TRACE_FILE_OPENED)
+                .arg(trace_file_).arg(capacity_);
+        }
+        staging_temp_.clear();
+    }
+
+    setSamplingRate(staging_rate_);
+}
+
+void
+PktTracer::rollback() {
+    if (staging_fd_ >= 0) {
+        close(staging_fd_);
+        staging_fd_ = -1;
+        static_cast<void>(unlink(staging_temp_.c_str()));
+        staging_temp_.clear();
+    }
+    staged_ = false;
+}
+
+void
+PktTracer::openTraceFile(const std::string& path, const uint32_t capacity) {
+    if (capacity == 0) {
+        isc_throw(PktTracerError, "number of records in the packet trace"
+                  " file must be greater than 0");
+    }
+    closeTraceFile();
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        isc_throw(PktTracerError, "unable to open packet trace file '"
+                  << path << "': " << strerror(errno));
+    }
+
+    if (!initTraceFile(fd, capacity)) {
+        const int error = errno;
+        close(fd);
+        isc_throw(PktTracerError, "unable to initialize packet trace file '"
+                  << path << "': " << strerror(error));
+    }
+
+    fd_ = fd;
+    trace_file_ = path;
+    capacity_ = capacity;
+    written_ = 0;
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_TRACE_FILE_OPENED)
+        .arg(trace_file_).arg(capacity_);
+}
+
+void
+PktTracer::closeTraceFile() {
+    if (fd_ < 0) {
+        return;
+    }
+    close(fd_);
+    fd_ = -1;
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_TRACE_FILE_CLOSED)
+        .arg(trace_file_);
+    trace_file_.clear();
+    capacity_ = 0;
+}
+
+void
+PktTracer::record(const uint16_t family, const Pkt& pkt) {
+    if (!pkt.isTraced()) {
+        return;
+    }
+
+    Histogram** histograms = histograms_[family == AF_INET ? 0 : 1];
+    PktTraceRecord record;
+    memset(&record, 0, sizeof(record));
+
+    // Record the time elapsed since the previous marked stage. Some stages
+    // are legitimately skipped, e.g. no lease is allocated for DHCPINFORM.
+    uint64_t first = 0;
+    uint64_t previous = 0;
+    for (int stage = 0; stage < Pkt::STAGE_NUM; ++stage) {
+        const uint64_t time = pkt.getStageTime(static_cast<Pkt::Stage>(stage));
+        record.stage_times_[stage] = time;
+        if (time == 0) {
+            continue;
+        }
+        if (first == 0) {
+            first = time;
+        } else {
+            histograms[stage]->record(time - previous);
+        }
+        previous = time;
+    }
+    if (first != 0) {
+        histograms[Pkt::STAGE_RECEIVED]->record(previous - first);
+    }
+
+    if (fd_ >= 0) {
+        record.family_ = static_cast<uint8_t>(family);
+        record.type_ = pkt.getType();
+        record.transid_ = pkt.getTransid();
+        writeRecord(record);
+    }
+}
+
+void
+PktTracer::writeRecord(const PktTraceRecord& record) {
+    const uint64_t slot = __sync_fetch_and_add(&written_, 1);
+    const off_t offset = sizeof(PktTraceFileHeader) +
+        static_cast<off_t>(slot % capacity_) * sizeof(PktTraceRecord);
+    const uint64_t written = slot + 1;
+    if ((pwrite(fd_, &record, sizeof(record), offset) !=
+         static_cast<ssize_t>(sizeof(record))) ||
+        (pwrite(fd_, &written, sizeof(written),
+                offsetof(PktTraceFileHeader, written_)) !=
+         static_cast<ssize_t>(sizeof(written)))) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_TRACE_FILE_WRITE_FAIL)
+            .arg(trace_file_).arg(strerror(errno));
+        closeTraceFile();
+    }
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
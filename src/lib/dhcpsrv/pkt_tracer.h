@@ -0,0 +1,275 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef PKT_TRACER_H
+#define PKT_TRACER_H
+
+#include <dhcp/pkt.h>
+#include <exceptions/exceptions.h>
+#include <stats/histogram.h>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+#include <string>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Exception thrown when the packet trace file can't be used.
+class PktTracerError : public Exception {
+public:
+    PktTracerError(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// @brief Header of the binary packet trace file.
+///
+/// The trace file is a ring buffer: the header is followed by the
+/// @c capacity_ fixed size records (@ref PktTraceRecord). The record
+/// number N (counting from 0 since the file was created) is stored in the
+/// slot N % @c capacity_. The @c written_ field holds the total number of
+/// records written, so the reader can tell which slots hold the most recent
+/// records. All values are stored in the host byte order.
+struct PktTraceFileHeader {
+    /// @brief Magic value "KEATRACE".
+    char magic_[8];
+    /// @brief Version of the file format.
+    uint32_t version_;
+    /// @brief Size of each record in bytes.
+    uint32_t record_size_;
+    /// @brief Number of record slots in the file.
+    uint32_t capacity_;
+    /// @brief Reserved, set to 0.
+    uint32_t reserved_;
+    /// @brief Total number of records written to the file.
+    uint64_t written_;
+};
+
+/// @brief Single record of the binary packet trace file.
+struct PktTraceRecord {
+    /// @brief Protocol family: AF_INET or AF_INET6.
+    uint8_t family_;
+    /// @brief Message type of the query.
+    uint8_t type_;
+    /// @brief Reserved, set to 0.
+    uint16_t reserved_;
+    /// @brief Transaction id of the query.
+    uint32_t transid_;
+    /// @brief Monotonic timestamps of the processing stages in nanoseconds.
+    ///
+    /// The stages which have not been reached are set to 0.
+    uint64_t stage_times_[Pkt::STAGE_NUM];
+};
+
+/// @brief Samples the processed packets and collects their stage latencies.
+///
+/// The server uses this singleton to select the packets for which the
+/// processing stages are timestamped (see @ref Pkt::markStage). One in
+/// every N received packets is traced, where N is the sampling rate set
+/// with @ref PktTracer::setSamplingRate. The rate of 0 (the default)
+/// disables tracing, so the cost on the packet processing path is a single
+/// comparison.
+///
+/// When the traced packet has been processed, the server calls
+/// @ref PktTracer::record which feeds the time elapsed between consecutive
+/// stages into the latency histograms held by the @ref isc::stats::StatsMgr
+/// (e.g. "pkt4-trace-allocate-latency") and, if configured, appends the raw
+/// stage timestamps to the binary trace file (see @ref PktTraceFileHeader).
+///
+/// Sampling and recording may be called from multiple threads. Opening and
+/// closing the trace file must not be called concurrently with recording.
+class PktTracer : public boost::noncopyable {
+public:
+
+    /// @brief Version of the trace file format.
+    static const uint32_t TRACE_FILE_VERSION = 1;
+
+    /// @brief Default number of records in the trace file.
+    static const uint32_t DEFAULT_TRACE_FILE_RECORDS = 65536;
+
+    /// @brief Returns the sole instance of the tracer.
+    static PktTracer& instance();
+
+    /// @brief Destructor.
+    ///
+    /// Closes the trace file.
+    ~PktTracer();
+
+    /// @brief Sets the sampling rate.
+    ///
+    /// @param rate One in every @c rate packets is traced. The value of 0
+    /// disables tracing.
+    void setSamplingRate(const uint32_t rate);
+
+    /// @brief Returns the sampling rate.
+    uint32_t getSamplingRate() const {
+        return (sampling_rate_);
+    }
+
+    /// @brief Checks if the next packet should be traced.
+    ///
+    /// @return true if the packet should be traced.
+    bool sample() {
+        const uint32_t rate = sampling_rate_;
+        if (rate == 0) {
+            return (false);
+        }
+        return ((__sync_fetch_and_add(&sampled_, 1) % rate) == 0);
+    }
+
+    /// @brief Applies the tracing configuration.
+    ///
+    /// This is equivalent to @ref stage followed by @ref commit.
+    ///
+    /// @param rate Sampling rate (see @ref setSamplingRate).
+    /// @param path Path to the trace file or empty string if the traces
+    /// should only be aggregated in the histograms.
+    /// @param capacity Maximum number of records held in the file.
+    ///
+    /// @throw PktTracerError if the file can't be opened.
+    void configure(const uint32_t rate, const std::string& path,
+                   const uint32_t capacity);
+
+    /// @brief Prepares the tracing configuration to be committed.
+    ///
+    /// If the path or capacity of the trace file has changed, the new file
+    /// is created and sized under a temporary name in the same directory,
+    /// so as the file in use is left intact. Nothing changes in the
+    /// tracing until @ref commit is called. A previously staged
+    /// configuration is discarded.
+    ///
+    /// @param rate Sampling rate (see @ref setSamplingRate).
+    /// @param path Path to the trace file or empty string if the traces
+    /// should only be aggregated in the histograms.
+    /// @param capacity Maximum number of records held in the file.
+    ///
+    /// @throw PktTracerError if the file can't be created or the capacity
+    /// is 0.
+    void stage(const uint32_t rate, const std::string& path,
+               const uint32_t capacity);
+
+    /// @brief Applies the staged tracing configuration.
+    ///
+    /// The new trace file is renamed to its configured path and replaces
+    /// the file in use. This doesn't throw: if the file can't be renamed,
+    /// the error is logged and the traces are only aggregated in the
+    /// histograms. This is a no-op if no configuration is staged.
+    void commit();
+
+    /// @brief Discards the staged tracing configuration.
+    ///
+    /// The new trace file, if any, is removed.
+    void rollback();
+
+    /// @brief Opens (truncates) the trace file.
+    ///
+    /// The previously opened trace file is closed.
+    ///
+    /// @param path Path to the trace file.
+    /// @param capacity Maximum number of records held in the file.
+    ///
+    /// @throw PktTracerError if the file can't be created or the capacity
+    /// is 0.
+    void openTraceFile(const std::string& path, const uint32_t capacity);
+
+    /// @brief Closes the trace file.
+    ///
+    /// This is a no-op if the file is not open.
+    void closeTraceFile();
+
+    /// @brief Checks if the trace file is open.
+    bool isTraceFileOpen() const {
+        return (fd_ >= 0);
+    }
+
+    /// @brief Returns the path to the open trace file or empty string.
+    const std::string& getTraceFile() const {
+        return (trace_file_);
+    }
+
+    /// @brief Records the stage timestamps of the processed packet.
+    ///
+    /// This is a no-op for the packets which are not traced.
+    ///
+    /// @param family Protocol family: AF_INET or AF_INET6.
+    /// @param pkt Processed query.
+    void record(const uint16_t family, const Pkt& pkt);
+
+    /// @brief Returns the name of the histogram for the stage.
+    ///
+    /// The histogram of the @c Pkt::STAGE_RECEIVED holds the time elapsed
+    /// between the first and the last marked stage. The histograms of other
+    /// stages hold the time elapsed since the previous marked stage.
+    ///
+    /// @param family Protocol family: AF_INET or AF_INET6.
+    /// @param stage Processing stage.
+    static std::string getHistogramName(const uint16_t family,
+                                        const Pkt::Stage stage);
+
+private:
+
+    /// @brief Private constructor.
+    ///
+    /// The instance is created with the @c PktTracer::instance.
+    PktTracer();
+
+    /// @brief Writes the record to the trace file.
+    ///
+    /// @param record Record to be written.
+    void writeRecord(const PktTraceRecord& record);
+
+    /// @brief Sampling rate.
+    volatile uint32_t sampling_rate_;
+
+    /// @brief Number of packets offered for sampling.
+    volatile uint32_t sampled_;
+
+    /// @brief Stage histograms: [0] for DHCPv4 and [1] for DHCPv6.
+    isc::stats::Histogram* histograms_[2][Pkt::STAGE_NUM];
+
+    /// @brief Descriptor of the trace file or -1.
+    int fd_;
+
+    /// @brief Path to the trace file.
+    std::string trace_file_;
+
+    /// @brief Number of record slots in the trace file.
+    uint32_t capacity_;
+
+    /// @brief Number of records written to the trace file.
+    volatile uint64_t written_;
+
+    /// @brief Indicates if a configuration is staged.
+    bool staged_;
+
+    /// @brief Staged sampling rate.
+    uint32_t staging_rate_;
+
+    /// @brief Staged path to the trace file.
+    std::string staging_file_;
+
+    /// @brief Staged number of record slots in the trace file.
+    uint32_t staging_capacity_;
+
+    /// @brief Descriptor of the staged trace file or -1 if the file in use
+    /// is kept.
+    int staging_fd_;
+
+    /// @brief Temporary path of the staged trace file.
+    std::string staging_temp_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // PKT_TRACER_H
@@ -15,6 +15,7 @@
 #ifndef POOL_H
 #define POOL_H
 
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <boost/shared_ptr.hpp>
 #include <dhcpsrv/lease.h>
@@ -60,6 +61,16 @@ public:
     /// @return true, if the address is in pool
     bool inRange(const isc::asiolink::IOAddress& addr) const;
 
+    /// @brief Checks if a given address is in the range.
+    ///
+    /// This variant is used by the callers which check the same address
+    /// against several pools: they convert the address once.
+    ///
+    /// @return true, if the address is in pool
+    bool inRange(const isc::asiolink::CompactAddress& addr) const {
+        return ((compact_first_ <= addr) && (addr <= compact_last_));
+    }
+
     /// @brief Returns pool type (v4, v6 non-temporary, v6 temp, v6 prefix)
     /// @return returns pool type
     Lease::Type getType() const {
@@ -96,10 +107,13 @@ protected:
 
     /// @brief returns the next unique Pool-ID
     ///
+    /// The pools may be created by multiple threads concurrently during
+    /// the configuration, so the counter is incremented atomically.
+    ///
     /// @return the next unique Pool-ID
     static uint32_t getNextID() {
         static uint32_t id = 0;
-        return (id++);
+        return (__sync_fetch_and_add(&id, 1));
     }
 
     /// @brief pool-id
@@ -113,6 +127,14 @@ protected:
     /// @brief The last address in a pool
     isc::asiolink::IOAddress last_;
 
+    /// @brief The first address in a pool, used for range checks
+    isc::asiolink::CompactAddress compact_first_;
+
+    /// @brief The last address in a pool, used for range checks
+    ///
+    /// It must be updated with @c last_.
+    isc::asiolink::CompactAddress compact_last_;
+
     /// @brief Comments field
     ///
     /// @todo: This field is currently not used.
@@ -34,6 +34,8 @@ Subnet::Subnet(const isc::asiolink::IOAddress& prefix, uint8_t len,
                const isc::dhcp::Subnet::RelayInfo& relay,
                const SubnetID id)
     :id_(id == 0 ? generateNextID() : id), prefix_(prefix), prefix_len_(len),
+     compact_first_(CompactAddress(prefix).firstInPrefix(len)),
+     compact_last_(CompactAddress(prefix).lastInPrefix(len)),
      t1_(t1), t2_(t2), valid_(valid_lifetime),
      last_allocated_ia_(lastAddrInPrefix(prefix, len)),
      last_allocated_ta_(lastAddrInPrefix(prefix, len)),
@@ -52,10 +54,7 @@ Subnet::RelayInfo::RelayInfo(const isc::asiolink::IOAddress& addr)
 
 bool
 Subnet::inRange(const isc::asiolink::IOAddress& addr) const {
-    IOAddress first = firstAddrInPrefix(prefix_, prefix_len_);
-    IOAddress last = lastAddrInPrefix(prefix_, prefix_len_);
-
-    return ((first <= addr) && (addr <= last));
+    return (inRange(CompactAddress(addr)));
 }
 
 void
@@ -276,6 +275,7 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
     checkType(type);
 
     const PoolCollection& pools = getPools(type);
+    const CompactAddress compact_hint(hint);
 
     PoolPtr candidate;
     for (PoolCollection::const_iterator pool = pools.begin();
@@ -288,7 +288,7 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
 
         // if the client provided a pool and there's a pool that hint is valid
         // in, then let's use that pool
-        if ((*pool)->inRange(hint)) {
+        if ((*pool)->inRange(compact_hint)) {
             return (*pool);
         }
     }
@@ -345,7 +345,8 @@ bool
 Subnet::inPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
 
     // Let's start with checking if it even belongs to that subnet.
-    if (!inRange(addr)) {
+    const CompactAddress compact_addr(addr);
+    if (!inRange(compact_addr)) {
         return (false);
     }
 
@@ -353,7 +354,7 @@ Subnet::inPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
 
     for (PoolCollection::const_iterator pool = pools.begin();
          pool != pools.end(); ++pool) {
-        if ((*pool)->inRange(addr)) {
+        if ((*pool)->inRange(compact_addr)) {
             return (true);
         }
     }
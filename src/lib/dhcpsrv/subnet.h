@@ -22,6 +22,7 @@
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/member.hpp>
 
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <dhcp/option.h>
 #include <dhcp/classify.h>
@@ -190,6 +191,14 @@ public:
     /// @brief checks if specified address is in range
     bool inRange(const isc::asiolink::IOAddress& addr) const;
 
+    /// @brief checks if specified address is in range
+    ///
+    /// This variant is used by the callers which check the same address
+    /// against several subnets: they convert the address once.
+    bool inRange(const isc::asiolink::CompactAddress& addr) const {
+        return ((compact_first_ <= addr) && (addr <= compact_last_));
+    }
+
     /// @brief Add new option instance to the collection.
     ///
     /// @param option option instance.
@@ -552,6 +561,12 @@ protected:
     /// @brief a prefix length of the subnet
     uint8_t prefix_len_;
 
+    /// @brief the first address of the subnet, used for range checks
+    isc::asiolink::CompactAddress compact_first_;
+
+    /// @brief the last address of the subnet, used for range checks
+    isc::asiolink::CompactAddress compact_last_;
+
     /// @brief a tripet (min/default/max) holding allowed renew timer values
     Triplet<uint32_t> t1_;
 
@@ -0,0 +1,106 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/subnet_config_cache.h>
+#include <sstream>
+
+using namespace isc::data;
+
+namespace isc {
+namespace dhcp {
+
+SubnetConfigCache::SubnetConfigCache()
+    : globals_(), staging_globals_(), subnets_(), staging_subnets_() {
+}
+
+void
+SubnetConfigCache::begin(const ConstElementPtr& config,
+                         const std::string& subnets_name) {
+    staging_subnets_.clear();
+    staging_globals_.clear();
+    if (!config || (config->getType() != Element::map)) {
+        return;
+    }
+
+    // The map elements are sorted by name, so the fingerprint doesn't
+    // depend on the order of the parameters in the configuration.
+    std::ostringstream s;
+    const std::map<std::string, ConstElementPtr>& values = config->mapValue();
+    for (std::map<std::string, ConstElementPtr>::const_iterator value =
+             values.begin(); value != values.end(); ++value) {
+        if (value->first != subnets_name) {
+            s << value->first << ":" << value->second->str() << ",";
+        }
+    }
+    staging_globals_ = s.str();
+}
+
+SubnetPtr
+SubnetConfigCache::get(const ConstElementPtr& subnet_config) const {
+    if (staging_globals_ != globals_) {
+        return (SubnetPtr());
+    }
+    const SubnetID id = getConfiguredID(subnet_config);
+    if (id == 0) {
+        return (SubnetPtr());
+    }
+    EntryMap::const_iterator entry = subnets_.find(id);
+    if ((entry == subnets_.end()) ||
+        (entry->second.config_ != subnet_config->str())) {
+        return (SubnetPtr());
+    }
+    return (entry->second.subnet_);
+}
+
+void
+SubnetConfigCache::add(const ConstElementPtr& subnet_config,
+                       const SubnetPtr& subnet) {
+    const SubnetID id = getConfiguredID(subnet_config);
+    if ((id == 0) || !subnet) {
+        return;
+    }
+    Entry& entry = staging_subnets_[id];
+    entry.config_ = subnet_config->str();
+    entry.subnet_ = subnet;
+}
+
+void
+SubnetConfigCache::commit() {
+    subnets_.swap(staging_subnets_);
+    staging_subnets_.clear();
+    globals_ = staging_globals_;
+}
+
+void
+SubnetConfigCache::clear() {
+    subnets_.clear();
+    staging_subnets_.clear();
+    globals_.clear();
+    staging_globals_.clear();
+}
+
+SubnetID
+SubnetConfigCache::getConfiguredID(const ConstElementPtr& subnet_config) {
+    if (!subnet_config || (subnet_config->getType() != Element::map)) {
+        return (0);
+    }
+    ConstElementPtr id = subnet_config->get("id");
+    if (!id || (id->getType() != Element::integer) || (id->intValue() <= 0)) {
+        return (0);
+    }
+    return (static_cast<SubnetID>(id->intValue()));
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,133 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef SUBNET_CONFIG_CACHE_H
+#define SUBNET_CONFIG_CACHE_H
+
+#include <cc/data.h>
+#include <dhcpsrv/subnet.h>
+#include <map>
+#include <string>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Holds subnets created by the previous configuration along with
+/// their configuration.
+///
+/// Rebuilding every subnet on reconfiguration is expensive when there are
+/// tens of thousands of subnets and it discards the run time state of the
+/// subnets, e.g. the last allocated addresses. This class allows the
+/// subnet list parsers to reuse the subnet objects whose configuration
+/// hasn't changed since the last successful reconfiguration.
+///
+/// The subnet is reused only if:
+/// - it has an explicitly specified subnet identifier (the automatically
+///   assigned identifiers depend on the position of the subnet in the list),
+/// - its configuration is identical to the configuration from which the
+///   subnet has been created,
+/// - the global parameters (everything but the list of subnets), which
+///   the subnets inherit, are identical too.
+///
+/// The subnets used in the new configuration are recorded in the staging
+/// area. They replace the subnets from the previous configuration when the
+/// new configuration is committed. If the configuration fails, the staging
+/// area is discarded when the next configuration begins.
+class SubnetConfigCache {
+public:
+
+    /// @brief Constructor.
+    SubnetConfigCache();
+
+    /// @brief Starts a new configuration.
+    ///
+    /// Clears the staging area and records the fingerprint of the global
+    /// parameters of the new configuration.
+    ///
+    /// @param config New configuration (a map).
+    /// @param subnets_name Name of the list of subnets within the
+    /// configuration, i.e. "subnet4" or "subnet6".
+    void begin(const isc::data::ConstElementPtr& config,
+               const std::string& subnets_name);
+
+    /// @brief Returns the subnet which can be reused for the configuration.
+    ///
+    /// @param subnet_config Configuration of a single subnet.
+    /// @return Pointer to the subnet created for the identical configuration
+    /// or NULL pointer if the subnet must be created.
+    SubnetPtr get(const isc::data::ConstElementPtr& subnet_config) const;
+
+    /// @brief Records the subnet used by the new configuration.
+    ///
+    /// The subnets without explicitly specified identifier are ignored.
+    ///
+    /// @param subnet_config Configuration of a single subnet.
+    /// @param subnet Subnet created (or reused) for this configuration.
+    void add(const isc::data::ConstElementPtr& subnet_config,
+             const SubnetPtr& subnet);
+
+    /// @brief Replaces the cached subnets with those recorded in the
+    /// staging area.
+    ///
+    /// This should be called when the new configuration has been
+    /// successfully committed.
+    void commit();
+
+    /// @brief Removes all cached subnets.
+    void clear();
+
+    /// @brief Returns the number of cached subnets.
+    size_t size() const {
+        return (subnets_.size());
+    }
+
+private:
+
+    /// @brief Returns the explicitly specified subnet identifier.
+    ///
+    /// @param subnet_config Configuration of a single subnet.
+    /// @return Subnet identifier or 0 if not specified.
+    static SubnetID getConfiguredID(const isc::data::ConstElementPtr&
+                                    subnet_config);
+
+    /// @brief Cached subnet along with its configuration.
+    struct Entry {
+        /// @brief Textual form of the subnet configuration.
+        std::string config_;
+        /// @brief Subnet created from this configuration.
+        SubnetPtr subnet_;
+    };
+
+    /// @brief Type of the container holding cached subnets by identifiers.
+    typedef std::map<SubnetID, Entry> EntryMap;
+
+    /// @brief Fingerprint of the global parameters of the last committed
+    /// configuration.
+    std::string globals_;
+
+    /// @brief Fingerprint of the global parameters of the new
+    /// configuration.
+    std::string staging_globals_;
+
+    /// @brief Subnets of the last committed configuration.
+    EntryMap subnets_;
+
+    /// @brief Subnets of the new configuration.
+    EntryMap staging_subnets_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // SUBNET_CONFIG_CACHE_H
@@ -73,6 +73,8 @@ TEST_F(LoggingInfoTest, defaults) {
     EXPECT_EQ("kea", info_non_verbose.name_);
     EXPECT_EQ(isc::log::INFO, info_non_verbose.severity_);
     EXPECT_EQ(0, info_non_verbose.debuglevel_);
+    EXPECT_FALSE(info_non_verbose.async_);
+    EXPECT_EQ(isc::log::OVERFLOW_BLOCK, info_non_verbose.overflow_);
 
     ASSERT_EQ(1, info_non_verbose.destinations_.size());
     EXPECT_EQ("stdout", info_non_verbose.destinations_[0].output_);
@@ -128,6 +130,25 @@ TEST_F(LoggingInfoTest, equalityOperators) {
     EXPECT_TRUE(info1 == info2);
     EXPECT_FALSE(info1 != info2);
 
+    // Differ by asynchronous output.
+    info1.async_ = true;
+    EXPECT_FALSE(info1 == info2);
+    EXPECT_TRUE(info1 != info2);
+
+    // Asynchronous output equal.
+    info2.async_ = true;
+    EXPECT_TRUE(info1 == info2);
+
+    // Differ by overflow policy.
+    info1.overflow_ = isc::log::OVERFLOW_DROP;
+    EXPECT_FALSE(info1 == info2);
+    EXPECT_TRUE(info1 != info2);
+
+    // Overflow policy equal.
+    info2.overflow_ = isc::log::OVERFLOW_DROP;
+    EXPECT_TRUE(info1 == info2);
+    EXPECT_FALSE(info1 != info2);
+
     // Create two different desinations.
     LoggingDestination dest1;
     LoggingDestination dest2;
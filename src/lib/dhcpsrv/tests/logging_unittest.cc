@@ -236,6 +236,62 @@ TEST_F(LoggingTest, multipleLoggingDestinations) {
     EXPECT_EQ("stdout" , storage->getLoggingInfo()[0].destinations_[1].output_);
 }
 
+// Checks if the LogConfigParser class is able to parse the asynchronous
+// output parameters and rejects invalid values.
+TEST_F(LoggingTest, parsingAsync) {
+
+    const char* config_txt =
+    "{ \"loggers\": ["
+    "    {"
+    "        \"name\": \"kea\","
+    "        \"output_options\": ["
+    "            {"
+    "                \"output\": \"stdout\""
+    "            }"
+    "        ],"
+    "        \"severity\": \"INFO\","
+    "        \"async\": true,"
+    "        \"overflow\": \"drop\""
+    "    },"
+    "    {"
+    "        \"name\": \"wombat\","
+    "        \"severity\": \"INFO\""
+    "    }"
+    "]}";
+
+    SrvConfigPtr storage(new SrvConfig());
+
+    LogConfigParser parser(storage);
+
+    ConstElementPtr config = Element::fromJSON(config_txt);
+    config = config->get("loggers");
+
+    EXPECT_NO_THROW(parser.parseConfiguration(config));
+
+    ASSERT_EQ(2, storage->getLoggingInfo().size());
+
+    EXPECT_TRUE(storage->getLoggingInfo()[0].async_);
+    EXPECT_EQ(isc::log::OVERFLOW_DROP, storage->getLoggingInfo()[0].overflow_);
+    isc::log::LoggerSpecification spec = storage->getLoggingInfo()[0].toSpec();
+    EXPECT_TRUE(spec.getAsync());
+    EXPECT_EQ(isc::log::OVERFLOW_DROP, spec.getOverflow());
+
+    // Synchronous output by default.
+    EXPECT_FALSE(storage->getLoggingInfo()[1].async_);
+    EXPECT_EQ(isc::log::OVERFLOW_BLOCK,
+              storage->getLoggingInfo()[1].overflow_);
+
+    // Invalid values.
+    config = Element::fromJSON("[ { \"name\": \"kea\","
+                               " \"severity\": \"INFO\","
+                               " \"async\": \"yes\" } ]");
+    EXPECT_THROW(parser.parseConfiguration(config), BadValue);
+    config = Element::fromJSON("[ { \"name\": \"kea\","
+                               " \"severity\": \"INFO\","
+                               " \"overflow\": \"wait\" } ]");
+    EXPECT_THROW(parser.parseConfiguration(config), BadValue);
+}
+
 /// @todo There is no easy way to test applyConfiguration() and defaultLogging().
 /// To test them, it would require instrumenting log4cplus to actually fake
 /// the logging set up. Alternatively, we could develop set of test suites
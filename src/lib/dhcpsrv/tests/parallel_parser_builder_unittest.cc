@@ -0,0 +1,213 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <dhcpsrv/parallel_parser_builder.h>
+#include <util/threads/sync.h>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Records the order in which the parsers are built.
+class BuildLog {
+public:
+    /// @brief Records that the parser has been built.
+    void add(const int value) {
+        Mutex::Locker lock(mutex_);
+        values_.push_back(value);
+    }
+
+    /// @brief Returns the values of the built parsers.
+    std::vector<int> getValues() {
+        Mutex::Locker lock(mutex_);
+        return (values_);
+    }
+
+private:
+    Mutex mutex_;
+    std::vector<int> values_;
+};
+
+/// @brief Test parser recording the integer value it has been built with.
+///
+/// The parser throws if the value is negative: @c DhcpConfigError for
+/// values lower than -1000, std::runtime_error otherwise.
+class TestParser : public DhcpConfigParser {
+public:
+    TestParser(BuildLog& log) : log_(log), value_(0), built_(false) {
+    }
+
+    virtual void build(ConstElementPtr config) {
+        value_ = config->intValue();
+        built_ = true;
+        log_.add(value_);
+        if (value_ < -1000) {
+            isc_throw(DhcpConfigError, "invalid value " << value_);
+        } else if (value_ < 0) {
+            throw std::runtime_error("negative value");
+        }
+    }
+
+    virtual void commit() {
+    }
+
+    BuildLog& log_;
+    int value_;
+    bool built_;
+};
+
+typedef boost::shared_ptr<TestParser> TestParserPtr;
+
+/// @brief Test fixture class for @c ParallelParserBuilder.
+class ParallelParserBuilderTest : public ::testing::Test {
+public:
+
+    /// @brief Adds the parser to the builder.
+    ///
+    /// @param builder Builder.
+    /// @param value Value the parser is built with.
+    /// @param sequential Indicates if the parser is sequential.
+    TestParserPtr add(ParallelParserBuilder& builder, const int value,
+                      const bool sequential = false) {
+        TestParserPtr parser(new TestParser(log_));
+        builder.add(parser, Element::create(value), sequential);
+        parsers_.push_back(parser);
+        return (parser);
+    }
+
+    /// @brief Adds the number of parsers sufficient to use all threads.
+    ///
+    /// Every tenth parser is sequential.
+    ///
+    /// @param builder Builder.
+    /// @param threads Number of threads.
+    void addMany(ParallelParserBuilder& builder, const size_t threads) {
+        const size_t count = threads *
+            (ParallelParserBuilder::MIN_PARSERS_PER_THREAD + 16);
+        for (size_t i = 0; i < count; ++i) {
+            add(builder, i, (i % 10) == 0);
+        }
+    }
+
+    BuildLog log_;
+    std::vector<TestParserPtr> parsers_;
+};
+
+// Checks that all parsers are built in the order of adding if there are
+// too few parsers to use the threads.
+TEST_F(ParallelParserBuilderTest, fewParsers) {
+    ParallelParserBuilder builder(4);
+    for (int i = 0; i < 10; ++i) {
+        add(builder, i, (i % 3) == 0);
+    }
+    ASSERT_NO_THROW(builder.build());
+    EXPECT_EQ(1, builder.getThreadsCount());
+
+    std::vector<int> values = log_.getValues();
+    ASSERT_EQ(10, values.size());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(i, values[i]);
+    }
+}
+
+// Checks that all parsers are built using multiple threads and that the
+// sequential parsers are built in the order of adding.
+TEST_F(ParallelParserBuilderTest, manyParsers) {
+    ParallelParserBuilder builder(4);
+    addMany(builder, 4);
+    ASSERT_NO_THROW(builder.build());
+    EXPECT_EQ(4, builder.getThreadsCount());
+
+    for (size_t i = 0; i < parsers_.size(); ++i) {
+        ASSERT_TRUE(parsers_[i]->built_) << "parser " << i;
+        EXPECT_EQ(i, parsers_[i]->value_);
+    }
+
+    // Each parser is built exactly once and the sequential parsers are
+    // built in order.
+    std::vector<int> values = log_.getValues();
+    ASSERT_EQ(parsers_.size(), values.size());
+    int last_sequential = -1;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if ((values[i] % 10) == 0) {
+            EXPECT_GT(values[i], last_sequential);
+            last_sequential = values[i];
+        }
+    }
+}
+
+// Checks that the number of threads is limited by the configured maximum.
+TEST_F(ParallelParserBuilderTest, maxThreads) {
+    ParallelParserBuilder builder(2);
+    addMany(builder, 4);
+    ASSERT_NO_THROW(builder.build());
+    EXPECT_EQ(2, builder.getThreadsCount());
+
+    // The value of 0 selects the number of processors.
+    EXPECT_GE(ParallelParserBuilder::getProcessorsCount(), 1);
+}
+
+// Checks that the error of the first failed parser is reported.
+TEST_F(ParallelParserBuilderTest, firstError) {
+    // Make a concurrent and a later sequential parser fail, the error of
+    // the concurrent one is expected to be reported.
+    ParallelParserBuilder builder(4);
+    for (size_t i = 0; i < 400; ++i) {
+        int value = i;
+        if (i == 155) {
+            value = -2000;
+        } else if (i == 300) {
+            value = -1;
+        }
+        add(builder, value, (i % 10) == 0);
+    }
+    try {
+        builder.build();
+        ADD_FAILURE() << "build() should have thrown";
+    } catch (const DhcpConfigError& ex) {
+        EXPECT_EQ("invalid value -2000", std::string(ex.what()));
+    }
+
+    // The parsers preceding the failed one have all been built.
+    for (size_t i = 0; i < 155; ++i) {
+        EXPECT_TRUE(parsers_[i]->built_) << "parser " << i;
+    }
+}
+
+// Checks that the non-isc exception is reported as std::runtime_error.
+TEST_F(ParallelParserBuilderTest, otherError) {
+    ParallelParserBuilder builder(4);
+    for (size_t i = 0; i < 400; ++i) {
+        add(builder, (i == 10 ? -1 : static_cast<int>(i)), false);
+    }
+    add(builder, -2000, true);
+    try {
+        builder.build();
+        ADD_FAILURE() << "build() should have thrown";
+    } catch (const DhcpConfigError&) {
+        ADD_FAILURE() << "unexpected DhcpConfigError";
+    } catch (const std::runtime_error& ex) {
+        EXPECT_EQ("negative value", std::string(ex.what()));
+    }
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,228 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/pkt4.h>
+#include <dhcpsrv/pkt_tracer.h>
+#include <stats/stats_mgr.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Test fixture class for @c PktTracer.
+class PktTracerTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Resets the tracer and the statistics.
+    PktTracerTest()
+        : filename_(absolutePath("pkt_trace.bin")) {
+        reset();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Resets the tracer and removes the trace file.
+    virtual ~PktTracerTest() {
+        reset();
+        static_cast<void>(unlink(filename_.c_str()));
+    }
+
+    /// @brief Disables tracing and clears the statistics.
+    void reset() {
+        PktTracer::instance().setSamplingRate(0);
+        PktTracer::instance().closeTraceFile();
+        StatsMgr::instance().resetAll();
+    }
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename) {
+        std::ostringstream s;
+        s << DHCP_DATA_DIR << "/" << filename;
+        return (s.str());
+    }
+
+    /// @brief Creates the traced packet with all stages marked.
+    ///
+    /// @param transid Transaction id of the packet.
+    Pkt4Ptr createTracedPacket(const uint32_t transid) const {
+        Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, transid));
+        pkt->setTraced(true);
+        for (int stage = 0; stage < Pkt::STAGE_NUM; ++stage) {
+            pkt->markStage(static_cast<Pkt::Stage>(stage));
+        }
+        return (pkt);
+    }
+
+    /// @brief Name of the trace file.
+    std::string filename_;
+};
+
+// Checks that one in every N packets is sampled and that the rate of 0
+// disables sampling.
+TEST_F(PktTracerTest, sample) {
+    PktTracer& tracer = PktTracer::instance();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(tracer.sample());
+    }
+
+    tracer.setSamplingRate(4);
+    EXPECT_EQ(4, tracer.getSamplingRate());
+    int sampled = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (tracer.sample()) {
+            ++sampled;
+        }
+    }
+    EXPECT_EQ(25, sampled);
+}
+
+// Checks that the stage latencies are recorded in the histograms.
+TEST_F(PktTracerTest, histograms) {
+    // The packets which are not traced are ignored.
+    Pkt4Ptr pkt(new Pkt4(DHCPDISCOVER, 1234));
+    PktTracer::instance().record(AF_INET, *pkt);
+
+    StatsMgr& stats = StatsMgr::instance();
+    const std::string total =
+        PktTracer::getHistogramName(AF_INET, Pkt::STAGE_RECEIVED);
+    const std::string allocate =
+        PktTracer::getHistogramName(AF_INET, Pkt::STAGE_LEASE_ALLOCATED);
+    EXPECT_EQ("pkt4-trace-total-latency", total);
+    EXPECT_EQ("pkt4-trace-allocate-latency", allocate);
+    EXPECT_EQ("pkt6-trace-send-latency",
+              PktTracer::getHistogramName(AF_INET6, Pkt::STAGE_SENT));
+    EXPECT_EQ(0, stats.getHistogram(total).getCount());
+
+    PktTracer::instance().record(AF_INET, *createTracedPacket(1234));
+    EXPECT_EQ(1, stats.getHistogram(total).getCount());
+    EXPECT_EQ(1, stats.getHistogram(allocate).getCount());
+    EXPECT_EQ(0, stats.getHistogram(PktTracer::getHistogramName(AF_INET6,
+        Pkt::STAGE_RECEIVED)).getCount());
+
+    // The skipped stage is not recorded.
+    pkt->setTraced(true);
+    pkt->markStage(Pkt::STAGE_RECEIVED);
+    pkt->markStage(Pkt::STAGE_SENT);
+    PktTracer::instance().record(AF_INET, *pkt);
+    EXPECT_EQ(2, stats.getHistogram(total).getCount());
+    EXPECT_EQ(1, stats.getHistogram(allocate).getCount());
+}
+
+// Checks that the traces are written to the ring buffer file.
+TEST_F(PktTracerTest, traceFile) {
+    PktTracer& tracer = PktTracer::instance();
+    EXPECT_THROW(tracer.openTraceFile(filename_, 0), PktTracerError);
+    EXPECT_THROW(tracer.openTraceFile("/no/such/dir/trace.bin", 10),
+                 PktTracerError);
+
+    ASSERT_NO_THROW(tracer.openTraceFile(filename_, 3));
+    EXPECT_TRUE(tracer.isTraceFileOpen());
+    EXPECT_EQ(filename_, tracer.getTraceFile());
+
+    // Write more records than the file can hold, so as it wraps.
+    for (uint32_t transid = 1; transid <= 5; ++transid) {
+        tracer.record(AF_INET, *createTracedPacket(transid));
+    }
+    tracer.closeTraceFile();
+    EXPECT_FALSE(tracer.isTraceFileOpen());
+
+    std::ifstream file(filename_.c_str(), std::ios::binary);
+    ASSERT_TRUE(file.good());
+    PktTraceFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ASSERT_TRUE(file.good());
+    EXPECT_EQ(0, memcmp(header.magic_, "KEATRACE", sizeof(header.magic_)));
+    EXPECT_EQ(PktTracer::TRACE_FILE_VERSION, header.version_);
+    EXPECT_EQ(sizeof(PktTraceRecord), header.record_size_);
+    EXPECT_EQ(3, header.capacity_);
+    EXPECT_EQ(5, header.written_);
+
+    // Records 4 and 5 overwrote the slots 0 and 1.
+    const uint32_t expected[] = { 4, 5, 3 };
+    for (int i = 0; i < 3; ++i) {
+        PktTraceRecord record;
+        file.read(reinterpret_cast<char*>(&record), sizeof(record));
+        ASSERT_TRUE(file.good());
+        EXPECT_EQ(AF_INET, record.family_);
+        EXPECT_EQ(DHCPDISCOVER, record.type_);
+        EXPECT_EQ(expected[i], record.transid_);
+        EXPECT_NE(0, record.stage_times_[Pkt::STAGE_RECEIVED]);
+        EXPECT_LE(record.stage_times_[Pkt::STAGE_RECEIVED],
+                  record.stage_times_[Pkt::STAGE_SENT]);
+    }
+}
+
+// Checks that the staged configuration only replaces the trace file in use
+// when committed.
+TEST_F(PktTracerTest, stageCommit) {
+    PktTracer& tracer = PktTracer::instance();
+    ASSERT_NO_THROW(tracer.configure(10, filename_, 3));
+    EXPECT_EQ(10, tracer.getSamplingRate());
+    tracer.record(AF_INET, *createTracedPacket(1));
+
+    // The errors are reported when staging and leave the tracing intact.
+    EXPECT_THROW(tracer.stage(20, filename_, 0), PktTracerError);
+    EXPECT_THROW(tracer.stage(20, "/no/such/dir/trace.bin", 10),
+                 PktTracerError);
+    tracer.commit();
+    EXPECT_EQ(10, tracer.getSamplingRate());
+    EXPECT_EQ(filename_, tracer.getTraceFile());
+
+    // The file of the staged configuration is discarded on rollback.
+    const std::string other = absolutePath("pkt_trace_other.bin");
+    ASSERT_NO_THROW(tracer.stage(20, other, 5));
+    tracer.rollback();
+    tracer.commit();
+    EXPECT_EQ(10, tracer.getSamplingRate());
+    EXPECT_EQ(filename_, tracer.getTraceFile());
+    EXPECT_NE(0, access(other.c_str(), F_OK));
+
+    // The new file is created when staging and replaces the file in use,
+    // which is left intact until then, on commit.
+    ASSERT_NO_THROW(tracer.stage(20, filename_, 5));
+    std::ifstream file(filename_.c_str(), std::ios::binary);
+    PktTraceFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ASSERT_TRUE(file.good());
+    EXPECT_EQ(3, header.capacity_);
+    EXPECT_EQ(1, header.written_);
+    file.close();
+
+    tracer.commit();
+    EXPECT_EQ(20, tracer.getSamplingRate());
+    EXPECT_EQ(filename_, tracer.getTraceFile());
+    file.open(filename_.c_str(), std::ios::binary);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ASSERT_TRUE(file.good());
+    EXPECT_EQ(5, header.capacity_);
+    EXPECT_EQ(0, header.written_);
+}
+
+} // end of anonymous namespace
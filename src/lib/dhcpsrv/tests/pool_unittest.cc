@@ -14,6 +14,7 @@
 
 #include <config.h>
 
+#include <asiolink/compact_address.h>
 #include <asiolink/io_address.h>
 #include <dhcpsrv/pool.h>
 
@@ -57,6 +58,8 @@ TEST(Pool4Test, constructor_prefix_len) {
 
     EXPECT_EQ("192.0.2.0", pool1.getFirstAddress().toText());
     EXPECT_EQ("192.0.2.127", pool1.getLastAddress().toText());
+    EXPECT_TRUE(pool1.inRange(CompactAddress(IOAddress("192.0.2.127"))));
+    EXPECT_FALSE(pool1.inRange(CompactAddress(IOAddress("192.0.2.128"))));
 
     // No such thing as /33 prefix
     EXPECT_THROW(Pool4(IOAddress("192.0.2.1"), 33), BadValue);
@@ -141,6 +144,8 @@ TEST(Pool6Test, constructor_prefix_len) {
     EXPECT_EQ(Lease::TYPE_NA, pool1.getType());
     EXPECT_EQ("2001:db8:1::", pool1.getFirstAddress().toText());
     EXPECT_EQ("2001:db8:1::ffff:ffff", pool1.getLastAddress().toText());
+    EXPECT_TRUE(pool1.inRange(CompactAddress(IOAddress("2001:db8:1::ffff"))));
+    EXPECT_FALSE(pool1.inRange(CompactAddress(IOAddress("2001:db8:1::1:0:0"))));
 
     // No such thing as /130 prefix
     EXPECT_THROW(Pool6(Lease::TYPE_NA, IOAddress("2001:db8::"), 130),
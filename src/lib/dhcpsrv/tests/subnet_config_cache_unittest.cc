@@ -0,0 +1,134 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/subnet_config_cache.h>
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::data;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Test fixture class for @c SubnetConfigCache.
+class SubnetConfigCacheTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates the configuration with three subnets.
+    SubnetConfigCacheTest() {
+        config_ = Element::fromJSON("{ \"valid-lifetime\": 4000,"
+            " \"subnet4\": [ { \"id\": 1, \"subnet\": \"192.0.2.0/24\" },"
+            "                { \"id\": 2, \"subnet\": \"192.0.3.0/24\" },"
+            "                { \"subnet\": \"192.0.4.0/24\" } ] }");
+        subnet1_.reset(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3, 1));
+        subnet2_.reset(new Subnet4(IOAddress("192.0.3.0"), 24, 1, 2, 3, 2));
+        subnet3_.reset(new Subnet4(IOAddress("192.0.4.0"), 24, 1, 2, 3, 3));
+    }
+
+    /// @brief Returns the configuration of the subnet at the index.
+    ///
+    /// @param config Configuration holding the "subnet4" list.
+    /// @param index Index of the subnet.
+    ConstElementPtr getSubnetConfig(const ConstElementPtr& config,
+                                    const int index) const {
+        return (config->get("subnet4")->get(index));
+    }
+
+    /// @brief Runs the configuration through the cache.
+    ///
+    /// @param cache Cache to be used.
+    /// @param config Configuration.
+    void configure(SubnetConfigCache& cache,
+                   const ConstElementPtr& config) {
+        cache.begin(config, "subnet4");
+        cache.add(getSubnetConfig(config, 0), subnet1_);
+        cache.add(getSubnetConfig(config, 1), subnet2_);
+        cache.add(getSubnetConfig(config, 2), subnet3_);
+        cache.commit();
+    }
+
+    /// @brief Configuration with three subnets.
+    ConstElementPtr config_;
+
+    /// @brief Subnets created for the configuration.
+    Subnet4Ptr subnet1_;
+    Subnet4Ptr subnet2_;
+    Subnet4Ptr subnet3_;
+};
+
+// Checks that unchanged subnets with explicit identifiers are reused.
+TEST_F(SubnetConfigCacheTest, reuse) {
+    SubnetConfigCache cache;
+
+    // Nothing can be reused before the first configuration is committed.
+    cache.begin(config_, "subnet4");
+    EXPECT_FALSE(cache.get(getSubnetConfig(config_, 0)));
+
+    configure(cache, config_);
+    // The subnet without the explicit identifier is not cached.
+    EXPECT_EQ(2, cache.size());
+
+    cache.begin(Element::fromJSON(config_->str()), "subnet4");
+    EXPECT_TRUE(cache.get(getSubnetConfig(config_, 0)) == subnet1_);
+    EXPECT_TRUE(cache.get(getSubnetConfig(config_, 1)) == subnet2_);
+    EXPECT_FALSE(cache.get(getSubnetConfig(config_, 2)));
+
+    // Modified subnet is not reused.
+    ConstElementPtr modified = Element::fromJSON("{ \"valid-lifetime\": 4000,"
+        " \"subnet4\": [ { \"id\": 1, \"subnet\": \"192.0.2.0/24\" },"
+        "                { \"id\": 2, \"subnet\": \"192.0.5.0/24\" } ] }");
+    cache.begin(modified, "subnet4");
+    EXPECT_TRUE(cache.get(getSubnetConfig(modified, 0)) == subnet1_);
+    EXPECT_FALSE(cache.get(getSubnetConfig(modified, 1)));
+}
+
+// Checks that no subnet is reused when the global parameters change.
+TEST_F(SubnetConfigCacheTest, globalsChanged) {
+    SubnetConfigCache cache;
+    configure(cache, config_);
+
+    ConstElementPtr modified = Element::fromJSON("{ \"valid-lifetime\": 5000,"
+        " \"subnet4\": [ { \"id\": 1, \"subnet\": \"192.0.2.0/24\" } ] }");
+    cache.begin(modified, "subnet4");
+    EXPECT_FALSE(cache.get(getSubnetConfig(modified, 0)));
+}
+
+// Checks that the cache is not updated until the configuration is committed.
+TEST_F(SubnetConfigCacheTest, noCommit) {
+    SubnetConfigCache cache;
+    configure(cache, config_);
+
+    // Start the configuration which fails, i.e. is never committed.
+    ConstElementPtr modified = Element::fromJSON("{ \"valid-lifetime\": 5000,"
+        " \"subnet4\": [ { \"id\": 1, \"subnet\": \"192.0.2.0/24\" } ] }");
+    cache.begin(modified, "subnet4");
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3, 1));
+    cache.add(getSubnetConfig(modified, 0), subnet);
+
+    // The subnets of the last committed configuration are still reused.
+    cache.begin(config_, "subnet4");
+    EXPECT_TRUE(cache.get(getSubnetConfig(config_, 0)) == subnet1_);
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+    cache.begin(config_, "subnet4");
+    EXPECT_FALSE(cache.get(getSubnetConfig(config_, 0)));
+}
+
+} // end of anonymous namespace
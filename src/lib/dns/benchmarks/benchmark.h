@@ -0,0 +1,84 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DNS_BENCHMARK_H
+#define DNS_BENCHMARK_H 1
+
+#include <util/monotonic_clock.h>
+
+#include <iomanip>
+#include <iostream>
+
+namespace isc {
+namespace bench {
+
+/// \brief Runs a benchmark target and prints the measured performance.
+///
+/// This is a minimal replacement of the benchmark framework the DNS
+/// benchmarks were originally written for.  The target class must have
+/// a \c run() method which performs one iteration of the benchmark and
+/// returns the number of sub-iterations (e.g. rendered names) it has
+/// performed.  The object can be used as a temporary: the benchmark is run
+/// and the result is printed by the constructor.
+///
+/// \tparam T The type of the benchmark target.
+template <typename T>
+class BenchMark {
+public:
+    /// \brief Constructor, runs the benchmark and prints the result.
+    ///
+    /// \param iterations The number of times \c run() of the target is
+    /// called.
+    /// \param target The benchmark target.
+    BenchMark(const int iterations, T target) :
+        target_(target), sub_iterations_(0), duration_(0)
+    {
+        const uint64_t start = isc::util::getMonotonicNanos();
+        for (int i = 0; i < iterations; ++i) {
+            sub_iterations_ += target_.run();
+        }
+        duration_ = isc::util::getMonotonicNanos() - start;
+        printResult(iterations);
+    }
+
+    /// \brief Returns the duration of the benchmark in nanoseconds.
+    uint64_t getDuration() const {
+        return (duration_);
+    }
+
+private:
+    void printResult(const int iterations) const {
+        const double seconds = static_cast<double>(duration_) / 1e9;
+        std::cout << "Performed " << iterations << " iterations ("
+                  << sub_iterations_ << " sub-iterations) in "
+                  << std::fixed << std::setprecision(6) << seconds << "s";
+        if (duration_ > 0) {
+            std::cout << " (" << std::setprecision(2)
+                      << (sub_iterations_ / seconds) << " sub-iterations/s, "
+                      << (static_cast<double>(duration_) /
+                          (sub_iterations_ > 0 ? sub_iterations_ : 1))
+                      << "ns each)";
+        }
+        std::cout << std::endl;
+    }
+
+    T target_;
+    uint64_t sub_iterations_;
+    uint64_t duration_;
+};
+
+} // end of namespace isc::bench
+} // end of namespace isc
+
+#endif // DNS_BENCHMARK_H
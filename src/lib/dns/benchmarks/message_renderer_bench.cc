@@ -12,12 +12,11 @@
 // OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 // PERFORMANCE OF THIS SOFTWARE.
 
-#include <bench/benchmark.h>
-
 #include <dns/name.h>
 #include <dns/labelsequence.h>
 #include <dns/messagerenderer.h>
 #include <oldmessagerenderer.h>
+#include "benchmark.h"
 
 #include <cassert>
 #include <vector>
@@ -100,6 +99,41 @@ const char* const example_servfail_names[] = {
     "www.example.com", NULL
 };
 
+// Names contained in a DNS UPDATE adding the forward mapping of a DHCP
+// client (RFC 4703), as sent by the DHCP-DDNS server: the zone, the
+// prerequisite for the non-existing FQDN, the A and DHCID records added
+// for the FQDN, and the owner and algorithm names of the TSIG record.
+const char* const update_add_fwd_names[] = {
+    "example.com",
+    "myhost.example.com",
+    "myhost.example.com", "myhost.example.com",
+    "d2.key.example.com", "hmac-sha256",
+    NULL
+};
+
+// Names contained in a DNS UPDATE removing the forward mapping: the zone,
+// the prerequisite DHCID, the deleted A, AAAA and DHCID records, and the
+// TSIG record.
+const char* const update_remove_fwd_names[] = {
+    "example.com",
+    "myhost.example.com",
+    "myhost.example.com", "myhost.example.com", "myhost.example.com",
+    "d2.key.example.com", "hmac-sha256",
+    NULL
+};
+
+// Names contained in a DNS UPDATE replacing the reverse mapping: the zone,
+// the deleted PTR RRset, and the PTR, its RDATA and DHCID records added.
+// The FQDN in the PTR RDATA doesn't share any suffix with the zone.
+const char* const update_replace_rev_names[] = {
+    "2.0.192.in-addr.arpa",
+    "1.2.0.192.in-addr.arpa",
+    "1.2.0.192.in-addr.arpa", "myhost.example.com",
+    "1.2.0.192.in-addr.arpa",
+    "d2.key.example.com", "hmac-sha256",
+    NULL
+};
+
 // An experimental "dumb" renderer for comparison.  It doesn't do any name
 // compression.  It simply ignores all setter method, returns a dummy value
 // for getter methods, and write names to the internal buffer as plain binary
@@ -159,6 +193,12 @@ main(int argc, char* argv[]) {
                                  "(NXDOMAIN response)"));
     spec_list.push_back(DataSpec(example_servfail_names,
                                  "(SERVFAIL response)"));
+    spec_list.push_back(DataSpec(update_add_fwd_names,
+                                 "(UPDATE adding forward mapping)"));
+    spec_list.push_back(DataSpec(update_remove_fwd_names,
+                                 "(UPDATE removing forward mapping)"));
+    spec_list.push_back(DataSpec(update_replace_rev_names,
+                                 "(UPDATE replacing reverse mapping)"));
     for (vector<DataSpec>::const_iterator it = spec_list.begin();
          it != spec_list.end();
          ++it) {
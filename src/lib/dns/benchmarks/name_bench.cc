@@ -0,0 +1,256 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <util/buffer.h>
+
+#include <dns/name.h>
+#include "benchmark.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace isc::util;
+using namespace isc::bench;
+using namespace isc::dns;
+
+namespace {
+// This benchmark constructs names from their textual form.
+class NameFromTextBenchMark {
+public:
+    NameFromTextBenchMark(const vector<string>& names) :
+        names_(names), length_(0)
+    {}
+    unsigned int run() {
+        for (vector<string>::const_iterator it = names_.begin();
+             it != names_.end(); ++it) {
+            const Name name(*it);
+            length_ += name.getLength();
+        }
+        return (names_.size());
+    }
+private:
+    const vector<string>& names_;
+    size_t length_;
+};
+
+// This benchmark constructs names from wire-format data.
+class NameFromWireBenchMark {
+public:
+    NameFromWireBenchMark(const OutputBuffer& data, const size_t count) :
+        data_(data), count_(count), length_(0)
+    {}
+    unsigned int run() {
+        InputBuffer buffer(data_.getData(), data_.getLength());
+        for (size_t i = 0; i < count_; ++i) {
+            const Name name(buffer);
+            length_ += name.getLength();
+        }
+        assert(buffer.getPosition() == buffer.getLength());
+        return (count_);
+    }
+private:
+    const OutputBuffer& data_;
+    const size_t count_;
+    size_t length_;
+};
+
+// This benchmark copies names.
+class NameCopyBenchMark {
+public:
+    NameCopyBenchMark(const vector<Name>& names) :
+        names_(names), length_(0)
+    {}
+    unsigned int run() {
+        for (vector<Name>::const_iterator it = names_.begin();
+             it != names_.end(); ++it) {
+            const Name name(*it);
+            length_ += name.getLength();
+        }
+        return (names_.size());
+    }
+private:
+    const vector<Name>& names_;
+    size_t length_;
+};
+
+// This benchmark constructs reverse lookup names the way the DHCP-DDNS
+// server used to: the textual form of the name is built from the address
+// and then parsed.
+class ReverseFromTextBenchMark {
+public:
+    ReverseFromTextBenchMark(const vector<vector<uint8_t> >& addresses) :
+        addresses_(addresses), length_(0)
+    {}
+    unsigned int run() {
+        for (vector<vector<uint8_t> >::const_iterator it = addresses_.begin();
+             it != addresses_.end(); ++it) {
+            ostringstream stream;
+            if (it->size() == 4) {
+                for (vector<uint8_t>::const_reverse_iterator rit =
+                         it->rbegin(); rit != it->rend(); ++rit) {
+                    stream << static_cast<unsigned int>(*rit) << ".";
+                }
+                stream << "in-addr.arpa.";
+            } else {
+                for (vector<uint8_t>::const_reverse_iterator rit =
+                         it->rbegin(); rit != it->rend(); ++rit) {
+                    stream << hex << (*rit & 0x0f) << "." << (*rit >> 4)
+                           << ".";
+                }
+                stream << "ip6.arpa.";
+            }
+            const Name name(stream.str());
+            length_ += name.getLength();
+        }
+        return (addresses_.size());
+    }
+private:
+    const vector<vector<uint8_t> >& addresses_;
+    size_t length_;
+};
+
+// This benchmark constructs reverse lookup names directly from the
+// addresses.
+class ReverseLookupNameBenchMark {
+public:
+    ReverseLookupNameBenchMark(const vector<vector<uint8_t> >& addresses) :
+        addresses_(addresses), length_(0)
+    {}
+    unsigned int run() {
+        for (vector<vector<uint8_t> >::const_iterator it = addresses_.begin();
+             it != addresses_.end(); ++it) {
+            const Name name = Name::reverseLookupName(&(*it)[0], it->size());
+            length_ += name.getLength();
+        }
+        return (addresses_.size());
+    }
+private:
+    const vector<vector<uint8_t> >& addresses_;
+    size_t length_;
+};
+
+//
+// Builtin benchmark data.
+//
+// Names handled by the DHCP-DDNS server: client FQDNs, the forward and
+// reverse zones and the TSIG key and algorithm names.
+const char* const d2_names[] = {
+    "myhost.example.com.", "client-0a1b2c.dhcp.example.com.",
+    "example.com.", "2.0.192.in-addr.arpa.",
+    "8.b.d.0.1.0.0.2.ip6.arpa.", "d2.key.example.com.", "hmac-sha256.",
+    NULL
+};
+
+// A name longer than the inline storage of names.
+const char* const long_names[] = {
+    "a-rather-long-host-name-for-a-client.in-a-deeply-nested.subdomain."
+    "of-an-organization.example.com.",
+    NULL
+};
+
+const uint8_t v4_address[] = { 192, 0, 2, 10 };
+const uint8_t v6_address[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                               0, 0, 0, 0, 0x56, 0x78, 0x9a, 0xbc };
+
+void
+usage() {
+    cerr << "Usage: name_bench [-n iterations]" << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    int iteration = 100000;
+    while ((ch = getopt(argc, argv, "n:")) != -1) {
+        switch (ch) {
+        case 'n':
+            iteration = atoi(optarg);
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if (argc != 0) {
+        usage();
+    }
+
+    cout << "Parameters:" << endl;
+    cout << "  Iterations: " << iteration << endl;
+
+    typedef pair<const char* const*, string> DataSpec;
+    vector<DataSpec> spec_list;
+    spec_list.push_back(DataSpec(d2_names, "(DHCP-DDNS names)"));
+    spec_list.push_back(DataSpec(long_names, "(long name)"));
+    for (vector<DataSpec>::const_iterator it = spec_list.begin();
+         it != spec_list.end();
+         ++it) {
+        vector<string> texts;
+        vector<Name> names;
+        OutputBuffer wire(0);
+        for (size_t i = 0; it->first[i] != NULL; ++i) {
+            texts.push_back(it->first[i]);
+            names.push_back(Name(it->first[i]));
+            names.back().toWire(wire);
+        }
+
+        cout << "Benchmark for names from text " << it->second << endl;
+        BenchMark<NameFromTextBenchMark>(iteration,
+                                         NameFromTextBenchMark(texts));
+
+        cout << "Benchmark for names from wire " << it->second << endl;
+        BenchMark<NameFromWireBenchMark>(iteration,
+                                         NameFromWireBenchMark(wire,
+                                                               names.size()));
+
+        cout << "Benchmark for name copies " << it->second << endl;
+        BenchMark<NameCopyBenchMark>(iteration, NameCopyBenchMark(names));
+    }
+
+    typedef pair<const uint8_t*, size_t> AddressSpec;
+    const AddressSpec address_list[] = {
+        AddressSpec(v4_address, sizeof(v4_address)),
+        AddressSpec(v6_address, sizeof(v6_address))
+    };
+    for (size_t i = 0; i < sizeof(address_list) / sizeof(address_list[0]);
+         ++i) {
+        const vector<vector<uint8_t> >
+            addresses(1, vector<uint8_t>(address_list[i].first,
+                                         address_list[i].first +
+                                         address_list[i].second));
+        const string name = address_list[i].second == 4 ? "(IPv4)" : "(IPv6)";
+
+        cout << "Benchmark for reverse names from text " << name << endl;
+        BenchMark<ReverseFromTextBenchMark>(iteration,
+                                            ReverseFromTextBenchMark(
+                                                addresses));
+
+        cout << "Benchmark for reverse names from addresses " << name << endl;
+        BenchMark<ReverseLookupNameBenchMark>(iteration,
+                                              ReverseLookupNameBenchMark(
+                                                  addresses));
+    }
+
+    return (0);
+}
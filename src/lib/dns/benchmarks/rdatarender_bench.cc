@@ -19,7 +19,7 @@
 
 #include <boost/shared_ptr.hpp>
 
-#include <bench/benchmark.h>
+#include "benchmark.h"
 
 #include <util/buffer.h>
 #include <dns/messagerenderer.h>
@@ -0,0 +1,245 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <cryptolink/cryptolink.h>
+#include <cryptolink/crypto_hmac.h>
+
+#include <dns/message.h>
+#include <dns/messagerenderer.h>
+#include <dns/name.h>
+#include <dns/opcode.h>
+#include <dns/question.h>
+#include <dns/rcode.h>
+#include <dns/rrclass.h>
+#include <dns/rrset.h>
+#include <dns/rrttl.h>
+#include <dns/rrtype.h>
+#include <dns/rdataclass.h>
+#include <dns/tsig.h>
+#include <dns/tsigkey.h>
+#include "benchmark.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace isc::bench;
+using namespace isc::cryptolink;
+using namespace isc::dns;
+using namespace isc::dns::rdata;
+
+namespace {
+typedef boost::shared_ptr<HMAC> HMACPtr;
+
+// This benchmark signs the given data with an HMAC object keyed from the
+// secret of the key for each message, as the TSIG contexts used to do.
+class HMACCreateBenchMark {
+public:
+    HMACCreateBenchMark(const TSIGKey& key, const vector<uint8_t>& data) :
+        key_(key), data_(data)
+    {}
+    unsigned int run() {
+        HMACPtr hmac(CryptoLink::getCryptoLink().createHMAC(
+                         key_.getSecret(), key_.getSecretLength(),
+                         key_.getAlgorithm()),
+                     deleteHMAC);
+        hmac->update(&data_[0], data_.size());
+        hmac->sign(digest_, sizeof(digest_));
+        return (1);
+    }
+private:
+    const TSIGKey& key_;
+    const vector<uint8_t>& data_;
+    uint8_t digest_[64];
+};
+
+// This benchmark signs the given data with an HMAC object cloned from the
+// pre-keyed prototype of the key.
+class HMACCloneBenchMark {
+public:
+    HMACCloneBenchMark(const TSIGKey& key, const vector<uint8_t>& data) :
+        key_(key), data_(data)
+    {}
+    unsigned int run() {
+        HMACPtr hmac(key_.createHMAC(), deleteHMAC);
+        hmac->update(&data_[0], data_.size());
+        hmac->sign(digest_, sizeof(digest_));
+        return (1);
+    }
+private:
+    const TSIGKey& key_;
+    const vector<uint8_t>& data_;
+    uint8_t digest_[64];
+};
+
+// This benchmark signs the given (unsigned) message with a new TSIG
+// context for each message, as a DNS client sending a request does.
+class TSIGSignBenchMark {
+public:
+    TSIGSignBenchMark(const TSIGKey& key, const vector<uint8_t>& data) :
+        key_(key), data_(data)
+    {}
+    unsigned int run() {
+        TSIGContext context(key_);
+        ConstTSIGRecordPtr record = context.sign(0x1234, &data_[0],
+                                                 data_.size());
+        assert(record);
+        return (1);
+    }
+private:
+    const TSIGKey& key_;
+    const vector<uint8_t>& data_;
+};
+
+// This benchmark verifies the given signed message with a new TSIG context
+// for each message, as a DNS server receiving a request does.
+class TSIGVerifyBenchMark {
+public:
+    TSIGVerifyBenchMark(const TSIGKey& key, const TSIGRecord& record,
+                        const vector<uint8_t>& data) :
+        key_(key), record_(record), data_(data)
+    {}
+    unsigned int run() {
+        TSIGContext context(key_);
+        const TSIGError error = context.verify(&record_, &data_[0],
+                                               data_.size());
+        assert(error == TSIGError::NOERROR());
+        return (1);
+    }
+private:
+    const TSIGKey& key_;
+    const TSIGRecord& record_;
+    const vector<uint8_t>& data_;
+};
+
+// Renders a DNS UPDATE adding the forward mapping of a DHCP client (RFC
+// 4703), as sent by the DHCP-DDNS server, optionally signing it.
+vector<uint8_t>
+renderUpdate(TSIGContext* context) {
+    Message message(Message::RENDER);
+    message.setQid(0x1234);
+    message.setOpcode(Opcode::UPDATE());
+    message.setRcode(Rcode::NOERROR());
+    message.addQuestion(Question(Name("example.com"), RRClass::IN(),
+                                 RRType::SOA()));
+    RRsetPtr prereq(new RRset(Name("myhost.example.com"), RRClass::NONE(),
+                              RRType::ANY(), RRTTL(0)));
+    message.addRRset(Message::SECTION_ANSWER, prereq);
+    RRsetPtr fwd(new RRset(Name("myhost.example.com"), RRClass::IN(),
+                           RRType::A(), RRTTL(3600)));
+    fwd->addRdata(in::A("192.0.2.1"));
+    message.addRRset(Message::SECTION_AUTHORITY, fwd);
+    RRsetPtr dhcid(new RRset(Name("myhost.example.com"), RRClass::IN(),
+                             RRType::DHCID(), RRTTL(3600)));
+    dhcid->addRdata(in::DHCID("AAIBY2/AuCccgoJbsaxcQc9TUapptP69"
+                              "lOjxfNuVAA2kjEA="));
+    message.addRRset(Message::SECTION_AUTHORITY, dhcid);
+
+    MessageRenderer renderer;
+    message.toWire(renderer, context);
+    const uint8_t* const data =
+        static_cast<const uint8_t*>(renderer.getData());
+    return (vector<uint8_t>(data, data + renderer.getLength()));
+}
+
+// The algorithms supported by TSIGKey.
+const struct {
+    const char* name;
+    const Name& (*algorithm)();
+} algorithms[] = {
+    { "HMAC-MD5", TSIGKey::HMACMD5_NAME },
+    { "HMAC-SHA1", TSIGKey::HMACSHA1_NAME },
+    { "HMAC-SHA224", TSIGKey::HMACSHA224_NAME },
+    { "HMAC-SHA256", TSIGKey::HMACSHA256_NAME },
+    { "HMAC-SHA384", TSIGKey::HMACSHA384_NAME },
+    { "HMAC-SHA512", TSIGKey::HMACSHA512_NAME },
+};
+
+void
+usage() {
+    cerr << "Usage: tsig_bench [-n iterations]" << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    int iteration = 100000;
+    while ((ch = getopt(argc, argv, "n:")) != -1) {
+        switch (ch) {
+        case 'n':
+            iteration = atoi(optarg);
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if (argc != 0) {
+        usage();
+    }
+
+    cout << "Parameters:" << endl;
+    cout << "  Iterations: " << iteration << endl;
+
+    // A 256-bit secret, as typically generated for TSIG keys.
+    const string secret("0123456789abcdef0123456789abcdef");
+    const vector<uint8_t> request = renderUpdate(NULL);
+
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); ++i) {
+        const TSIGKey key(Name("d2.key.example.com"),
+                          algorithms[i].algorithm(),
+                          secret.c_str(), secret.size());
+        const string name = string("(") + algorithms[i].name + ")";
+
+        cout << "Benchmark for HMAC keyed from the secret " << name << endl;
+        BenchMark<HMACCreateBenchMark>(iteration,
+                                       HMACCreateBenchMark(key, request));
+
+        cout << "Benchmark for HMAC cloned from the key " << name << endl;
+        BenchMark<HMACCloneBenchMark>(iteration,
+                                      HMACCloneBenchMark(key, request));
+
+        cout << "Benchmark for TSIG signing " << name << endl;
+        BenchMark<TSIGSignBenchMark>(iteration,
+                                     TSIGSignBenchMark(key, request));
+
+        // Sign the request once and parse it back to get the TSIG record
+        // to be verified.
+        TSIGContext context(key);
+        const vector<uint8_t> signed_request = renderUpdate(&context);
+        Message message(Message::PARSE);
+        isc::util::InputBuffer buffer(&signed_request[0],
+                                      signed_request.size());
+        message.fromWire(buffer);
+        assert(message.getTSIGRecord() != NULL);
+
+        cout << "Benchmark for TSIG verification " << name << endl;
+        BenchMark<TSIGVerifyBenchMark>(iteration,
+                                       TSIGVerifyBenchMark(key,
+                                           *message.getTSIGRecord(),
+                                           signed_request));
+    }
+
+    return (0);
+}
@@ -43,13 +43,10 @@ namespace {     // hide internal-only names from the public namespaces
 /// longest match (ancestor) name against each new name to be rendered into
 /// the buffer.
 struct OffsetItem {
-    OffsetItem(size_t hash, size_t pos, size_t len) :
-        hash_(hash), pos_(pos), len_(len)
-    {}
-
-    /// The hash value for the stored name calculated by LabelSequence.getHash.
-    /// This will help make name comparison in \c NameCompare more efficient.
-    size_t hash_;
+    /// The hash value for the stored name calculated by
+    /// \c MessageRendererImpl::hashLabels.  This will help make name
+    /// comparison in \c NameCompare more efficient.
+    uint32_t hash_;
 
     /// The position (offset from the beginning) in the buffer where the
     /// name starts.
@@ -57,6 +54,10 @@ struct OffsetItem {
 
     /// The length of the corresponding sequence (which is a domain name).
     uint16_t len_;
+
+    /// The generation of the table in which the item has been added.  The
+    /// item is only valid if it matches the current generation.
+    uint32_t generation_;
 };
 
 /// \brief The \c NameCompare class is a functor that checks equality
@@ -76,7 +77,7 @@ struct NameCompare {
     /// name to be newly rendered (and only that data).
     /// \param hash The hash value for the name.
     NameCompare(const OutputBuffer& buffer, InputBuffer& name_buf,
-                size_t hash) :
+                uint32_t hash) :
         buffer_(&buffer), name_buf_(&name_buf), hash_(hash)
     {}
 
@@ -144,7 +145,7 @@ private:
 
     const OutputBuffer* buffer_;
     InputBuffer* name_buf_;
-    const size_t hash_;
+    const uint32_t hash_;
 };
 }
 
@@ -158,57 +159,143 @@ private:
 /// It internally holds a hash table for OffsetItem objects corresponding
 /// to portions of names rendered in this renderer.  The offset information
 /// is used to compress subsequent names to be rendered.
+///
+/// The hash table uses open addressing with linear probing in a single
+/// array, so adding an offset never allocates memory unless the table has
+/// to grow.  The table is kept at most half full.  Clearing the table only
+/// increments its generation: the items of the previous generations are
+/// treated as empty slots, so the table isn't scanned between messages.
 struct MessageRenderer::MessageRendererImpl {
-    // The size of hash buckets and number of hash entries per bucket for
-    // which space is preallocated and kept reserved for subsequent rendering
-    // to provide better performance.  These values are derived from the
-    // BIND 9 implementation that uses a similar hash table.
-    static const size_t BUCKETS = 64;
-    static const size_t RESERVED_ITEMS = 16;
+    // The number of hash table slots which are preallocated and kept
+    // reserved for subsequent rendering to provide better performance.
+    // This is enough for 512 offsets, i.e. a few dozens of names, which
+    // covers typical responses and DNS UPDATE messages without growing.
+    static const size_t RESERVED_ITEMS = 1024;
     static const uint16_t NO_OFFSET = 65535; // used as a marker of 'not found'
 
     /// \brief Constructor
     MessageRendererImpl() :
+        table_(RESERVED_ITEMS), items_(0), generation_(1),
         msglength_limit_(512), truncated_(false),
         compress_mode_(MessageRenderer::CASE_INSENSITIVE)
     {
-        // Reserve some spaces for hash table items.
-        for (size_t i = 0; i < BUCKETS; ++i) {
-            table_[i].reserve(RESERVED_ITEMS);
+        clearTable();
+    }
+
+    /// \brief Calculates the hash values of all suffixes of a name.
+    ///
+    /// The hash of each suffix is derived from the hash of the following
+    /// (shorter) suffix and the label preceding it, so the hashes of all
+    /// suffixes are calculated in a single pass over the name data.  The
+    /// hash values are always case-insensitive; the names are compared
+    /// in the compression mode when the hash values match.
+    ///
+    /// \param data The wire-format data of the labels.
+    /// \param nlabels The number of labels in the data.
+    /// \return The number of the labels excluding the trailing root label.
+    size_t hashLabels(const uint8_t* data, const size_t nlabels) {
+        size_t pos = 0;
+        size_t count = 0;
+        for (; count < nlabels; ++count) {
+            if (data[pos] == 0) {
+                break;
+            }
+            seq_offsets_.at(count) = pos;
+            pos += data[pos] + 1;
         }
+        // FNV-1a hash of the labels from the rightmost one.
+        uint32_t hash = 2166136261U;
+        for (size_t i = count; i > 0; --i) {
+            const size_t label_pos = seq_offsets_[i - 1];
+            const size_t label_end = label_pos + data[label_pos] + 1;
+            for (size_t j = label_pos; j < label_end; ++j) {
+                hash = (hash ^ maptolower[data[j]]) * 16777619U;
+            }
+            seq_hashes_[i - 1] = hash;
+        }
+        return (count);
     }
 
     uint16_t findOffset(const OutputBuffer& buffer, InputBuffer& name_buf,
-                        size_t hash, bool case_sensitive) const
+                        uint32_t hash, bool case_sensitive) const
     {
-        // Find a matching entry, if any.  We use some heuristics here: often
-        // the same name appears consecutively (like repeating the same owner
-        // name for a single RRset), so in case there's a collision in the
-        // bucket it will be more likely to find it in the tail side of the
-        // bucket.
-        const size_t bucket_id = hash % BUCKETS;
-        vector<OffsetItem>::const_reverse_iterator found;
         if (case_sensitive) {
-            found = find_if(table_[bucket_id].rbegin(),
-                            table_[bucket_id].rend(),
-                            NameCompare<true>(buffer, name_buf, hash));
-        } else {
-            found = find_if(table_[bucket_id].rbegin(),
-                            table_[bucket_id].rend(),
-                            NameCompare<false>(buffer, name_buf, hash));
+            return (findOffset(NameCompare<true>(buffer, name_buf, hash),
+                               hash));
         }
-        if (found != table_[bucket_id].rend()) {
-            return (found->pos_);
+        return (findOffset(NameCompare<false>(buffer, name_buf, hash), hash));
+    }
+
+    template <typename Compare>
+    uint16_t findOffset(const Compare& compare, uint32_t hash) const {
+        // There are no duplicate entries in the table: a name (or its
+        // suffix) is only added if it hasn't been found, so the first
+        // matching entry is the only one.
+        const size_t mask = table_.size() - 1;
+        for (size_t i = hash & mask; table_[i].generation_ == generation_;
+             i = (i + 1) & mask) {
+            if (compare(table_[i])) {
+                return (table_[i].pos_);
+            }
         }
         return (NO_OFFSET);
     }
 
-    void addOffset(size_t hash, size_t offset, size_t len) {
-        table_[hash % BUCKETS].push_back(OffsetItem(hash, offset, len));
+    void addOffset(uint32_t hash, size_t offset, size_t len) {
+        if ((items_ + 1) * 2 > table_.size()) {
+            resizeTable(table_.size() * 2);
+        }
+        insertItem(hash, offset, len);
+        ++items_;
+    }
+
+    void insertItem(uint32_t hash, size_t offset, size_t len) {
+        const size_t mask = table_.size() - 1;
+        size_t i = hash & mask;
+        while (table_[i].generation_ == generation_) {
+            i = (i + 1) & mask;
+        }
+        table_[i].hash_ = hash;
+        table_[i].pos_ = offset;
+        table_[i].len_ = len;
+        table_[i].generation_ = generation_;
+    }
+
+    void resizeTable(size_t size) {
+        vector<OffsetItem> old_table(size);
+        old_table.swap(table_);
+        const uint32_t old_generation = generation_;
+        clearTable();
+        for (size_t i = 0; i < old_table.size(); ++i) {
+            if (old_table[i].generation_ == old_generation) {
+                insertItem(old_table[i].hash_, old_table[i].pos_,
+                           old_table[i].len_);
+            }
+        }
+    }
+
+    /// \brief Removes all items from the table in constant time.
+    void nextGeneration() {
+        items_ = 0;
+        if (++generation_ == 0) {
+            clearTable();
+        }
+    }
+
+    /// \brief Marks all slots of the table as empty.
+    void clearTable() {
+        generation_ = 1;
+        for (size_t i = 0; i < table_.size(); ++i) {
+            table_[i].generation_ = 0;
+        }
     }
 
     // The hash table for the (offset + position in the buffer) entries
-    vector<OffsetItem> table_[BUCKETS];
+    vector<OffsetItem> table_;
+    /// The number of items in the table.
+    size_t items_;
+    /// The current generation of the table.
+    uint32_t generation_;
     /// The maximum length of rendered data that can fit without
     /// truncation.
     uint16_t msglength_limit_;
@@ -221,7 +308,9 @@ struct MessageRenderer::MessageRendererImpl {
     // Placeholder for hash values as they are calculated in writeName().
     // Note: we may want to make it a local variable of writeName() if it
     // works more efficiently.
-    boost::array<size_t, Name::MAX_LABELS> seq_hashes_;
+    boost::array<uint32_t, Name::MAX_LABELS> seq_hashes_;
+    // Placeholder for the offsets of the labels in the name data.
+    boost::array<size_t, Name::MAX_LABELS> seq_offsets_;
 };
 
 MessageRenderer::MessageRenderer() :
@@ -242,15 +331,15 @@ MessageRenderer::clear() {
 
     // Clear the hash table.  We reserve the minimum space for possible
     // subsequent use of the renderer.
-    for (size_t i = 0; i < MessageRendererImpl::BUCKETS; ++i) {
-        if (impl_->table_[i].size() > MessageRendererImpl::RESERVED_ITEMS) {
-            // Trim excessive capacity: swap ensures the new capacity is only
-            // reasonably large for the reserved space.
-            vector<OffsetItem> new_table;
-            new_table.reserve(MessageRendererImpl::RESERVED_ITEMS);
-            new_table.swap(impl_->table_[i]);
-        }
-        impl_->table_[i].clear();
+    if (impl_->table_.size() > MessageRendererImpl::RESERVED_ITEMS) {
+        // Trim excessive capacity: swap ensures the new capacity is only
+        // reasonably large for the reserved space.
+        vector<OffsetItem> new_table(MessageRendererImpl::RESERVED_ITEMS);
+        new_table.swap(impl_->table_);
+        impl_->items_ = 0;
+        impl_->clearTable();
+    } else {
+        impl_->nextGeneration();
     }
 }
 
@@ -290,10 +379,10 @@ MessageRenderer::setCompressMode(const CompressMode mode) {
 
 void
 MessageRenderer::writeName(const LabelSequence& ls, const bool compress) {
-    LabelSequence sequence(ls);
-    const size_t nlabels = sequence.getLabelCount();
+    const size_t nlabels = ls.getLabelCount();
     size_t data_len;
-    const uint8_t* data;
+    const uint8_t* const data = ls.getData(&data_len);
+    const size_t nlabels_nonroot = impl_->hashLabels(data, nlabels);
 
     // Find the offset in the offset table whose name gives the longest
     // match against the name to be rendered.
@@ -302,19 +391,12 @@ MessageRenderer::writeName(const LabelSequence& ls, const bool compress) {
     const bool case_sensitive = (impl_->compress_mode_ ==
                                  MessageRenderer::CASE_SENSITIVE);
     for (nlabels_uncomp = 0; nlabels_uncomp < nlabels; ++nlabels_uncomp) {
-        if (nlabels_uncomp > 0) {
-            sequence.stripLeft(1);
-        }
-
-        data = sequence.getData(&data_len);
-        if (data_len == 1) { // trailing dot.
+        if (nlabels_uncomp == nlabels_nonroot) { // trailing dot.
             ++nlabels_uncomp;
             break;
         }
-        // write with range check for safety
-        impl_->seq_hashes_.at(nlabels_uncomp) =
-            sequence.getHash(impl_->compress_mode_);
-        InputBuffer name_buf(data, data_len);
+        const size_t pos = impl_->seq_offsets_[nlabels_uncomp];
+        InputBuffer name_buf(data + pos, data_len - pos);
         ptr_offset = impl_->findOffset(getBuffer(), name_buf,
                                        impl_->seq_hashes_[nlabels_uncomp],
                                        case_sensitive);
@@ -327,13 +409,12 @@ MessageRenderer::writeName(const LabelSequence& ls, const bool compress) {
     size_t offset = getLength();
     // Write uncompress part:
     if (nlabels_uncomp > 0 || !compress) {
-        LabelSequence uncomp_sequence(ls);
         if (compress && nlabels > nlabels_uncomp) {
             // If there's compressed part, strip off that part.
-            uncomp_sequence.stripRight(nlabels - nlabels_uncomp);
+            writeData(data, impl_->seq_offsets_[nlabels_uncomp]);
+        } else {
+            writeData(data, data_len);
         }
-        data = uncomp_sequence.getData(&data_len);
-        writeData(data, data_len);
     }
     // And write compression pointer if available:
     if (compress && ptr_offset != MessageRendererImpl::NO_OFFSET) {
@@ -345,7 +426,7 @@ MessageRenderer::writeName(const LabelSequence& ls, const bool compress) {
     // in the hash table.  The renderer's buffer has just stored the
     // corresponding data, so we use the rendered data to get the length
     // of each label of the names.
-    size_t seqlen = ls.getDataLength();
+    size_t seqlen = data_len;
     for (size_t i = 0; i < nlabels_uncomp; ++i) {
         const uint8_t label_len = getBuffer()[offset];
         if (label_len == 0) { // offset for root doesn't need to be stored.
@@ -150,10 +150,9 @@ stringParse(Iterator s, Iterator send, bool downcase, Offsets& offsets,
     const bool empty = s == send;
     ft_state state = ft_init;
 
-    // Prepare the output buffers.
-    offsets.reserve(Name::MAX_LABELS);
+    // Prepare the output buffers.  Typical names fit in their inline
+    // storage, so they are not reserved for the longest possible name.
     offsets.push_back(0);
-    ndata.reserve(Name::MAX_WIRE);
 
     // should we refactor this code using, e.g, the state pattern?  Probably
     // not at this point, as this is based on proved code (derived from BIND9)
@@ -301,19 +300,13 @@ Name::Name(const std::string &namestring, bool downcase) {
     const std::string::const_iterator s = namestring.begin();
     const std::string::const_iterator send = namestring.end();
 
-    // Prepare outputs
-    NameOffsets offsets;
-    NameString ndata;
+    // To the parsing, directly into the name data and offsets
+    stringParse(s, send, downcase, offsets_, ndata_);
 
-    // To the parsing
-    stringParse(s, send, downcase, offsets, ndata);
-
-    // And get the output
-    labelcount_ = offsets.size();
+    // And get the sizes
+    labelcount_ = offsets_.size();
     assert(labelcount_ > 0 && labelcount_ <= Name::MAX_LABELS);
-    ndata_.assign(ndata.data(), ndata.size());
     length_ = ndata_.size();
-    offsets_.assign(offsets.begin(), offsets.end());
 }
 
 Name::Name(const char* namedata, size_t data_len, const Name* origin,
@@ -335,19 +328,13 @@ Name::Name(const char* namedata, size_t data_len, const Name* origin,
     // Prepare inputs for the parser
     const char* end = namedata + data_len;
 
-    // Prepare outputs
-    NameOffsets offsets;
-    NameString ndata;
-
-    // Do the actual parsing
-    stringParse(namedata, end, downcase, offsets, ndata);
+    // Do the actual parsing, directly into the name data and offsets
+    stringParse(namedata, end, downcase, offsets_, ndata_);
 
-    // Get the output
-    labelcount_ = offsets.size();
+    // Get the sizes
+    labelcount_ = offsets_.size();
     assert(labelcount_ > 0 && labelcount_ <= Name::MAX_LABELS);
-    ndata_.assign(ndata.data(), ndata.size());
     length_ = ndata_.size();
-    offsets_.assign(offsets.begin(), offsets.end());
 
     if (!absolute) {
         // Now, extend the data with the ones from origin. But eat the
@@ -393,9 +380,6 @@ typedef enum {
 }
 
 Name::Name(InputBuffer& buffer, bool downcase) {
-    NameOffsets offsets;
-    offsets.reserve(Name::MAX_LABELS);
-
     /*
      * Initialize things to make the compiler happy; they're not required.
      */
@@ -433,7 +417,7 @@ Name::Name(InputBuffer& buffer, bool downcase) {
         switch (state) {
         case fw_start:
             if (c <= MAX_LABELLEN) {
-                offsets.push_back(nused);
+                offsets_.push_back(nused);
                 if (nused + c + 1 > Name::MAX_WIRE) {
                     isc_throw(DNSMessageFORMERR, "wire name is too long: "
                               << nused + c + 1 << " bytes");
@@ -493,12 +477,92 @@ Name::Name(InputBuffer& buffer, bool downcase) {
         isc_throw(DNSMessageFORMERR, "incomplete wire-format name");
     }
 
-    labelcount_ = offsets.size();
+    labelcount_ = offsets_.size();
     length_ = nused;
-    offsets_.assign(offsets.begin(), offsets.end());
     buffer.setPosition(pos_begin + cused);
 }
 
+namespace {
+/// Wire-format suffixes of the reverse lookup names.
+const uint8_t IPV4_REVERSE_SUFFIX[] = {
+    7, 'i', 'n', '-', 'a', 'd', 'd', 'r', 4, 'a', 'r', 'p', 'a', 0
+};
+const uint8_t IPV6_REVERSE_SUFFIX[] = {
+    3, 'i', 'p', '6', 4, 'a', 'r', 'p', 'a', 0
+};
+
+const char hexdigits[] = "0123456789abcdef";
+
+// Appends a label to a name under construction.  Like stringParse, this is
+// a template because the name data and offsets types are private.
+template<class Offsets, class Data>
+void
+appendLabel(const char* label, size_t label_len, Offsets& offsets,
+            Data& ndata)
+{
+    offsets.push_back(ndata.size());
+    ndata.push_back(label_len);
+    ndata.append(reinterpret_cast<const uint8_t*>(label),
+                 reinterpret_cast<const uint8_t*>(label) + label_len);
+}
+
+// Appends the labels of a wire-format absolute name (which is known to be
+// valid) to a name under construction.
+template<class Offsets, class Data>
+void
+appendWire(const uint8_t* wire, Offsets& offsets, Data& ndata) {
+    const size_t base = ndata.size();
+    size_t pos = 0;
+    while (true) {
+        offsets.push_back(base + pos);
+        if (wire[pos] == 0) {
+            break;
+        }
+        pos += wire[pos] + 1;
+    }
+    ndata.append(wire, wire + pos + 1);
+}
+}
+
+Name
+Name::reverseLookupName(const uint8_t* address, const size_t address_len) {
+    Name retname;
+    if (address_len == 4) {
+        // One label per octet in decimal, from the last octet to the first.
+        for (size_t i = address_len; i > 0; --i) {
+            unsigned int octet = address[i - 1];
+            char label[3];
+            size_t pos = sizeof(label);
+            do {
+                label[--pos] = '0' + octet % 10;
+                octet /= 10;
+            } while (octet > 0);
+            appendLabel(label + pos, sizeof(label) - pos, retname.offsets_,
+                        retname.ndata_);
+        }
+        appendWire(IPV4_REVERSE_SUFFIX, retname.offsets_, retname.ndata_);
+    } else if (address_len == 16) {
+        // One label per nibble in hexadecimal, from the last nibble to the
+        // first.
+        for (size_t i = address_len; i > 0; --i) {
+            const uint8_t octet = address[i - 1];
+            appendLabel(&hexdigits[octet & 0x0f], 1, retname.offsets_,
+                        retname.ndata_);
+            appendLabel(&hexdigits[octet >> 4], 1, retname.offsets_,
+                        retname.ndata_);
+        }
+        appendWire(IPV6_REVERSE_SUFFIX, retname.offsets_, retname.ndata_);
+    } else {
+        isc_throw(isc::BadValue, "invalid address length for a reverse "
+                  "lookup name: " << address_len);
+    }
+
+    retname.length_ = retname.ndata_.size();
+    retname.labelcount_ = retname.offsets_.size();
+
+    return (retname);
+}
+
 void
 Name::toWire(OutputBuffer& buffer) const {
     buffer.writeData(ndata_.data(), ndata_.size());
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include <dns/exceptions.h>
+#include <dns/name_storage.h>
 
 namespace isc {
 namespace util {
@@ -193,16 +194,16 @@ private:
 /// access to various properties of a name, etc.
 ///
 /// Notes to developers: Internally, a name object maintains the name %data
-/// in wire format as an instance of \c std::string.  Since many string
-/// implementations adopt copy-on-write %data sharing, we expect this approach
-/// will make copying a name less expensive in typical cases.  If this is
-/// found to be a significant performance bottleneck later, we may reconsider
-/// the internal representation or perhaps the API.
+/// in wire format as an instance of \c NameStorage, which keeps names of up
+/// to \c INLINE_WIRE bytes within the object itself.  This covers typical
+/// host names as well as the reverse lookup names of IPv4 and IPv6
+/// addresses, so that constructing or copying such names doesn't allocate
+/// memory.  Longer names are moved to the heap.
 ///
-/// A name object also maintains a vector of offsets (\c offsets_ member),
+/// A name object also maintains an array of offsets (\c offsets_ member),
 /// each of which is the offset to a label of the name: The n-th element of
 /// the vector specifies the offset to the n-th label.  For example, if the
-/// object represents "www.example.com", the elements of the offsets vector
+/// object represents "www.example.com", the elements of the offsets array
 /// are 0, 4, 12, and 16.  Note that the offset to the trailing dot (16) is
 /// included.  In the BIND9 DNS library from which this implementation is
 /// derived, the offsets are optional, probably due to performance
@@ -239,10 +240,19 @@ class Name {
     ///
     //@{
 private:
+    /// \brief Number of bytes of name data stored inline.
+    ///
+    /// The reverse lookup name of an IPv6 address is 74 bytes long.
+    static const size_t INLINE_WIRE = 84;
+    /// \brief Number of label offsets stored inline.
+    ///
+    /// The reverse lookup name of an IPv6 address has 35 labels.
+    static const size_t INLINE_LABELS = 36;
+
     /// \brief Name data string
-    typedef std::basic_string<uint8_t> NameString;
+    typedef NameStorage<INLINE_WIRE> NameString;
     /// \brief Name offsets type
-    typedef std::vector<uint8_t> NameOffsets;
+    typedef NameStorage<INLINE_LABELS> NameOffsets;
 
     /// The default constructor
     ///
@@ -311,6 +321,22 @@ public:
     /// \param buffer A buffer storing the wire format %data.
     /// \param downcase Whether to convert upper case alphabets to lower case.
     explicit Name(isc::util::InputBuffer& buffer, bool downcase = false);
+
+    /// \brief Builds the reverse lookup name of an address.
+    ///
+    /// This function constructs the name under "in-addr.arpa." (RFC 1035)
+    /// of a 4-byte IPv4 address, or under "ip6.arpa." (RFC 3596) of a
+    /// 16-byte IPv6 address.  For example, the name for 192.0.2.1 is
+    /// "1.2.0.192.in-addr.arpa.".  The labels are written in wire format
+    /// directly from the address, which is much cheaper than building the
+    /// textual form of the name and parsing it.
+    ///
+    /// \throw isc::BadValue \c address_len is neither 4 nor 16.
+    ///
+    /// \param address The address in network byte order.
+    /// \param address_len The length of the address in bytes.
+    /// \return The reverse lookup name of the address.
+    static Name reverseLookupName(const uint8_t* address, size_t address_len);
     ///
     /// We use the default copy constructor intentionally.
     //@}
@@ -0,0 +1,246 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef NAME_STORAGE_H
+#define NAME_STORAGE_H 1
+
+#include <exceptions/exceptions.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include <stdint.h>
+
+namespace isc {
+namespace dns {
+
+/// \brief A byte array with inline storage for the internal data of a
+/// \c Name.
+///
+/// The name data and the label offsets of a \c Name are kept in objects
+/// of this class.  Up to \c N bytes are stored within the object itself;
+/// the storage moves to the heap only when more are needed.  With \c N
+/// chosen for typical names, constructing or copying a name doesn't
+/// allocate memory.
+///
+/// The class provides the subset of the \c std::vector interface that
+/// the \c Name implementation uses.  It is not intended to be used by
+/// applications directly.
+///
+/// The content, and thus \c N, must not exceed 65535 bytes.
+template <size_t N>
+class NameStorage {
+public:
+    typedef uint8_t value_type;
+    typedef uint8_t& reference;
+    typedef const uint8_t& const_reference;
+    typedef uint8_t* iterator;
+    typedef const uint8_t* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef size_t size_type;
+
+    /// \brief Constructs an empty storage.
+    NameStorage() : data_(inline_), size_(0), capacity_(N) {}
+
+    /// \brief Copy constructor.
+    ///
+    /// The copy only allocates memory if \c other doesn't fit inline.
+    NameStorage(const NameStorage& other) :
+        data_(inline_), size_(0), capacity_(N)
+    {
+        assign(other.data_, other.size_);
+    }
+
+    ~NameStorage() {
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+    }
+
+    /// \brief Assignment operator.
+    NameStorage& operator=(const NameStorage& other) {
+        if (this != &other) {
+            assign(other.data_, other.size_);
+        }
+        return (*this);
+    }
+
+    /// \name Size and element access
+    ///
+    //@{
+    size_t size() const { return (size_); }
+    bool empty() const { return (size_ == 0); }
+    size_t capacity() const { return (capacity_); }
+
+    /// \brief Returns whether the data is stored within the object.
+    bool isInline() const { return (data_ == inline_); }
+
+    uint8_t* data() { return (data_); }
+    const uint8_t* data() const { return (data_); }
+
+    iterator begin() { return (data_); }
+    const_iterator begin() const { return (data_); }
+    iterator end() { return (data_ + size_); }
+    const_iterator end() const { return (data_ + size_); }
+    reverse_iterator rbegin() { return (reverse_iterator(end())); }
+    const_reverse_iterator rbegin() const {
+        return (const_reverse_iterator(end()));
+    }
+    reverse_iterator rend() { return (reverse_iterator(begin())); }
+    const_reverse_iterator rend() const {
+        return (const_reverse_iterator(begin()));
+    }
+
+    uint8_t& operator[](const size_t pos) { return (data_[pos]); }
+    const uint8_t& operator[](const size_t pos) const {
+        return (data_[pos]);
+    }
+
+    /// \brief Returns the element at a position, checking the position.
+    ///
+    /// \throw isc::OutOfRange \c pos is not smaller than the size.
+    uint8_t& at(const size_t pos) {
+        checkPosition(pos);
+        return (data_[pos]);
+    }
+
+    /// \brief Returns the element at a position, checking the position.
+    ///
+    /// \throw isc::OutOfRange \c pos is not smaller than the size.
+    const uint8_t& at(const size_t pos) const {
+        checkPosition(pos);
+        return (data_[pos]);
+    }
+
+    uint8_t& back() { return (data_[size_ - 1]); }
+    const uint8_t& back() const { return (data_[size_ - 1]); }
+    //@}
+
+    /// \name Modifiers
+    ///
+    //@{
+    /// \brief Makes room for at least \c len bytes.
+    void reserve(const size_t len) {
+        if (len > capacity_) {
+            grow(len);
+        }
+    }
+
+    void clear() { size_ = 0; }
+
+    void push_back(const uint8_t c) {
+        if (size_ == capacity_) {
+            grow(size_ + 1);
+        }
+        data_[size_++] = c;
+    }
+
+    void pop_back() { --size_; }
+
+    /// \brief Replaces the content with \c len bytes from \c data.
+    void assign(const uint8_t* data, const size_t len) {
+        reserve(len);
+        std::memmove(data_, data, len);
+        size_ = len;
+    }
+
+    /// \brief Replaces the content with \c len bytes of \c other from
+    /// position \c pos.
+    void assign(const NameStorage& other, const size_t pos,
+                const size_t len)
+    {
+        assign(other.data_ + pos, len);
+    }
+
+    /// \brief Replaces the content with the range [\c first, \c last).
+    template <typename InputIterator>
+    void assign(InputIterator first, InputIterator last) {
+        clear();
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    /// \brief Appends the range [\c first, \c last).
+    ///
+    /// The range must not be part of this object.
+    void append(const uint8_t* first, const uint8_t* last) {
+        const size_t len = last - first;
+        reserve(size_ + len);
+        std::memcpy(data_ + size_, first, len);
+        size_ += len;
+    }
+
+    /// \brief Appends the content of another object.
+    void append(const NameStorage& other) {
+        append(other.begin(), other.end());
+    }
+
+    /// \brief Inserts the range [\c first, \c last) before \c pos.
+    ///
+    /// The range must not be part of this object.
+    void insert(iterator pos, const uint8_t* first, const uint8_t* last) {
+        const size_t offset = pos - data_;
+        const size_t len = last - first;
+        reserve(size_ + len);
+        std::memmove(data_ + offset + len, data_ + offset, size_ - offset);
+        std::memcpy(data_ + offset, first, len);
+        size_ += len;
+    }
+
+    /// \brief Removes the element at \c pos.
+    iterator erase(iterator pos) {
+        std::memmove(pos, pos + 1, end() - pos - 1);
+        --size_;
+        return (pos);
+    }
+    //@}
+
+private:
+    void checkPosition(const size_t pos) const {
+        if (pos >= size_) {
+            isc_throw(isc::OutOfRange, "name storage position " << pos
+                      << " out of range (size " << size_ << ")");
+        }
+    }
+
+    /// \brief Moves the content to a heap buffer of at least \c len bytes.
+    void grow(const size_t len) {
+        const size_t capacity = std::max(len,
+                                         2 * static_cast<size_t>(capacity_));
+        uint8_t* data = new uint8_t[capacity];
+        std::memcpy(data, data_, size_);
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    uint8_t* data_;
+    uint16_t size_;
+    uint16_t capacity_;
+    uint8_t inline_[N];
+};
+
+} // namespace dns
+} // namespace isc
+
+#endif // NAME_STORAGE_H
+
+// Local Variables:
+// mode: c++
+// End:
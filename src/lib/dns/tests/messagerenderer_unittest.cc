@@ -295,4 +295,20 @@ TEST_F(MessageRendererTest, manyRRs) {
     // any disruption.
     EXPECT_NO_THROW(renderer.clear());
 }
+
+TEST_F(MessageRendererTest, writeNameAfterClear) {
+    // The names rendered before clear() must not be used for compression
+    // of the names rendered after it, even though the offsets are the
+    // same.
+    renderer.writeName(Name("example.org."));
+    renderer.writeName(Name("b.example.com."));
+    renderer.clear();
+
+    UnitTestUtil::readWireData("name_toWire1", data);
+    renderer.writeName(Name("a.example.com."));
+    renderer.writeName(Name("b.example.com."));
+    renderer.writeName(Name("a.example.org."));
+    matchWireData(&data[0], data.size(),
+                  renderer.getData(), renderer.getLength());
+}
 }
@@ -460,6 +460,26 @@ TEST_F(NameTest, assignment) {
     EXPECT_EQ(example_name, copy);
 }
 
+// Names longer than the inline storage of a name are kept on the heap.
+// Copies between short and long names must be deep in either direction.
+TEST_F(NameTest, copyLongName) {
+    const Name long_name(max_labels_str);
+    Name copy(long_name);
+    EXPECT_EQ(long_name, copy);
+    EXPECT_EQ(Name::MAX_LABELS, copy.getLabelCount());
+
+    Name* copy2 = new Name(max_len_str);
+    Name copy3(example_name);
+    copy3 = *copy2;
+    delete copy2;
+    EXPECT_EQ(Name(max_len_str), copy3);
+    EXPECT_EQ(Name::MAX_WIRE, copy3.getLength());
+
+    copy3 = example_name;
+    EXPECT_EQ(example_name, copy3);
+    EXPECT_EQ(example_name, Name(copy3.toText()));
+}
+
 TEST_F(NameTest, toText) {
     // tests derived from BIND9
     EXPECT_EQ("a.b.c.d", Name("a.b.c.d").toText(true));
@@ -634,6 +654,29 @@ TEST_F(NameTest, reverse) {
                         Name("s.r.q.p.o.n.m.l.k.j.i.h.g.f.e.d.c.b.a"));
 }
 
+TEST_F(NameTest, reverseLookupName) {
+    const uint8_t v4[] = { 192, 0, 2, 10 };
+    EXPECT_PRED_FORMAT2(UnitTestUtil::matchName,
+                        Name::reverseLookupName(v4, sizeof(v4)),
+                        Name("10.2.0.192.in-addr.arpa."));
+    const uint8_t v4_edges[] = { 0, 9, 99, 255 };
+    EXPECT_PRED_FORMAT2(UnitTestUtil::matchName,
+                        Name::reverseLookupName(v4_edges, sizeof(v4_edges)),
+                        Name("255.99.9.0.in-addr.arpa."));
+
+    const uint8_t v6[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                           0, 0, 0, 0, 0x56, 0x78, 0x9a, 0xbc };
+    const Name v6_name = Name::reverseLookupName(v6, sizeof(v6));
+    EXPECT_PRED_FORMAT2(UnitTestUtil::matchName, v6_name,
+                        Name("c.b.a.9.8.7.6.5.0.0.0.0.0.0.0.0."
+                             "0.0.0.0.0.0.0.0.8.b.d.0.1.0.0.2.ip6.arpa."));
+    EXPECT_EQ(35, v6_name.getLabelCount());
+    EXPECT_EQ(Name("ip6.arpa"), v6_name.split(32));
+
+    EXPECT_THROW(Name::reverseLookupName(v6, 0), isc::BadValue);
+    EXPECT_THROW(Name::reverseLookupName(v6, 6), isc::BadValue);
+}
+
 TEST_F(NameTest, split) {
     // normal cases with or without explicitly specifying the trailing dot.
     EXPECT_PRED_FORMAT2(UnitTestUtil::matchName, example_name.split(1, 2),
@@ -13,20 +13,27 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <exceptions/exceptions.h>
 
 #include <cryptolink/cryptolink.h>
+#include <cryptolink/crypto_hmac.h>
 
 #include <dns/tsigkey.h>
 
 #include <dns/tests/unittest_util.h>
+#include <util/buffer.h>
 #include <util/unittests/wiredata.h>
 
+#include <boost/shared_ptr.hpp>
+
 using namespace std;
 using namespace isc::dns;
+using namespace isc::cryptolink;
+using isc::util::OutputBuffer;
 using isc::UnitTestUtil;
 using isc::util::unittests::matchWireData;
 
@@ -151,6 +158,49 @@ TEST_F(TSIGKeyTest, assignment) {
     compareTSIGKeys(original, copy);
 }
 
+// Sign the data with an HMAC object created by the key and return the
+// signature.
+vector<uint8_t>
+signWithKey(const TSIGKey& key, const string& data) {
+    boost::shared_ptr<HMAC> hmac(key.createHMAC(), deleteHMAC);
+    hmac->update(data.c_str(), data.size());
+    return (hmac->sign());
+}
+
+TEST_F(TSIGKeyTest, createHMAC) {
+    const string data("data to be signed");
+    TSIGKey* original = new TSIGKey(key_name, TSIGKey::HMACSHA256_NAME(),
+                                    secret.c_str(), secret.size());
+    OutputBuffer expected(0);
+    signHMAC(data.c_str(), data.size(), secret.c_str(), secret.size(),
+             SHA256, expected);
+
+    // Each object is keyed independently of the previous ones.
+    for (int i = 0; i < 2; ++i) {
+        const vector<uint8_t> sig = signWithKey(*original, data);
+        matchWireData(expected.getData(), expected.getLength(),
+                      &sig[0], sig.size());
+    }
+
+    // The copies of the key still work after the original is deleted.
+    const TSIGKey copy(*original);
+    TSIGKey copy2(key_name, TSIGKey::HMACMD5_NAME(), NULL, 0);
+    copy2 = *original;
+    delete original;
+    vector<uint8_t> sig = signWithKey(copy, data);
+    matchWireData(expected.getData(), expected.getLength(),
+                  &sig[0], sig.size());
+    sig = signWithKey(copy2, data);
+    matchWireData(expected.getData(), expected.getLength(),
+                  &sig[0], sig.size());
+
+    // Keys which cannot be used for signing.
+    EXPECT_THROW(TSIGKey(key_name, TSIGKey::HMACMD5_NAME(),
+                         NULL, 0).createHMAC(), BadKey);
+    EXPECT_THROW(TSIGKey(key_name, Name("unknown-alg"),
+                         NULL, 0).createHMAC(), UnsupportedAlgorithm);
+}
+
 class TSIGKeyRingTest : public ::testing::Test {
 protected:
     TSIGKeyRingTest() :
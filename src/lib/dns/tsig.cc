@@ -75,10 +75,7 @@ struct TSIGContext::TSIGContextImpl {
             // it at this moment; a subsequent sign/verify operation will try
             // to create the HMAC, which would also fail.
             try {
-                hmac_.reset(CryptoLink::getCryptoLink().createHMAC(
-                                key_.getSecret(), key_.getSecretLength(),
-                                key_.getAlgorithm()),
-                            deleteHMAC);
+                hmac_.reset(key_.createHMAC(), deleteHMAC);
             } catch (const isc::Exception&) {
                 return;
             }
@@ -119,10 +116,7 @@ struct TSIGContext::TSIGContextImpl {
             ret.swap(hmac_);
             return (ret);
         }
-        return (HMACPtr(CryptoLink::getCryptoLink().createHMAC(
-                            key_.getSecret(), key_.getSecretLength(),
-                            key_.getAlgorithm()),
-                        deleteHMAC));
+        return (HMACPtr(key_.createHMAC(), deleteHMAC));
     }
 
     // The following three are helper methods to compute the digest for
@@ -20,6 +20,9 @@
 #include <exceptions/exceptions.h>
 
 #include <cryptolink/cryptolink.h>
+#include <cryptolink/crypto_hmac.h>
+
+#include <boost/shared_ptr.hpp>
 
 #include <dns/name.h>
 #include <util/encode/base64.h>
@@ -75,11 +78,28 @@ TSIGKey::TSIGKeyImpl {
             algorithm_name_ = TSIGKey::HMACMD5_NAME();
         }
         algorithm_name_.downcase();
+
+        // Key the HMAC prototype now, so that the signing and verifying
+        // contexts of this key (and of its copies, which share the
+        // prototype) only need to clone it.  If the key cannot be used
+        // with the crypto library, createHMAC() will try (and fail)
+        // again and report the error to the caller.
+        if (algorithm_ != isc::cryptolink::UNKNOWN_HASH && !secret_.empty()) {
+            try {
+                hmac_.reset(CryptoLink::getCryptoLink().createHMAC(
+                                &secret_[0], secret_.size(), algorithm_),
+                            deleteHMAC);
+            } catch (const isc::Exception&) {
+                // Leave the prototype empty.
+            }
+        }
     }
     Name key_name_;
     Name algorithm_name_;
     const isc::cryptolink::HashAlgorithm algorithm_;
     const vector<uint8_t> secret_;
+    // Keyed HMAC object which is never updated, only cloned.
+    boost::shared_ptr<HMAC> hmac_;
 };
 
 TSIGKey::TSIGKey(const Name& key_name, const Name& algorithm_name,
@@ -194,6 +214,16 @@ TSIGKey::getSecretLength() const {
     return (impl_->secret_.size());
 }
 
+HMAC*
+TSIGKey::createHMAC() const {
+    if (impl_->hmac_) {
+        return (impl_->hmac_->clone());
+    }
+    return (CryptoLink::getCryptoLink().createHMAC(getSecret(),
+                                                   getSecretLength(),
+                                                   getAlgorithm()));
+}
+
 std::string
 TSIGKey::toText() const {
     const vector<uint8_t> secret_v(static_cast<const uint8_t*>(getSecret()),
@@ -184,6 +184,23 @@ public:
     const void* getSecret() const;
     //@}
 
+    /// \brief Creates an HMAC object keyed with this key
+    ///
+    /// The returned object can be used to sign or verify a message with
+    /// this key.  A keyed prototype object is created along with the key
+    /// (and shared by its copies), and this method returns a clone of it,
+    /// which is cheaper than keying a new object for every message.
+    ///
+    /// The caller is responsible for deleting the returned object with
+    /// \c isc::cryptolink::deleteHMAC().
+    ///
+    /// \exception isc::cryptolink::CryptoLinkError (or a derived class)
+    /// if the key cannot be used with the crypto library, e.g. because its
+    /// algorithm is unknown.
+    ///
+    /// \return A pointer to the new HMAC object.
+    isc::cryptolink::HMAC* createHMAC() const;
+
     /// \brief Converts the TSIGKey to a string value
     ///
     /// The resulting string will be of the form
@@ -0,0 +1,418 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <log/async_appender_impl.h>
+#include <log/log_formatter.h>
+#include <log/log_messages.h>
+#include <log/logger_impl.h>
+#include <log/message_dictionary.h>
+#include <log/interprocess/interprocess_sync_file.h>
+#include <log/interprocess/interprocess_sync_null.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <log4cplus/loglevel.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+using isc::util::thread::CondVar;
+using isc::util::thread::Mutex;
+using isc::util::thread::Thread;
+
+namespace isc {
+namespace log {
+namespace internal {
+
+namespace {
+
+/// \brief Time a logging thread waits for room in the full queue (in
+/// microseconds)
+const useconds_t BLOCK_WAIT = 100;
+
+/// \brief Time a flushing thread waits between the checks whether the
+/// events have been output (in microseconds)
+const useconds_t FLUSH_WAIT = 1000;
+
+/// \brief Event waiting in the queue for output
+struct QueuedEvent {
+    AsyncAppender* appender_;
+    log4cplus::spi::InternalLoggingEvent* event_;
+};
+
+/// \brief Queue of the events of all asynchronous appenders
+///
+/// This is a bounded multiple producer, single consumer queue.  The
+/// logging threads claim the slots of a ring by a compare-and-swap of the
+/// enqueue position.  Each slot has a sequence number which tells whether
+/// the slot has been published to the output thread (the consumer) or
+/// released back to the logging threads, so neither side takes a lock.
+///
+/// The output thread sleeps on a condition variable when the queue is
+/// empty.  The logging threads only take the mutex to wake it up.
+class AsyncQueue : public boost::noncopyable {
+public:
+    /// \brief Constructor
+    ///
+    /// Starts the output thread.
+    ///
+    /// \param capacity Number of the slots, must be a power of two.
+    explicit AsyncQueue(const size_t capacity) :
+        slots_(new Slot[capacity]), mask_(capacity - 1),
+        enqueue_pos_(0), dequeue_pos_(0), processed_(0),
+        sleeping_(false), stopping_(false), stopped_(false)
+    {
+        for (size_t i = 0; i < capacity; ++i) {
+            slots_[i].sequence_ = i;
+        }
+        if (lockfileEnabled()) {
+            sync_.reset(new interprocess::InterprocessSyncFile("logger"));
+        } else {
+            sync_.reset(new interprocess::InterprocessSyncNull("logger"));
+        }
+        thread_.reset(new Thread(boost::bind(&AsyncQueue::run, this)));
+    }
+
+    /// \brief Push an event into the queue
+    ///
+    /// \param appender The appender the event is output by.
+    /// \param event The event, owned by the queue on success.
+    /// \param block true if the call should wait for room in the full
+    ///        queue.
+    ///
+    /// \return true if the event has been queued.
+    bool push(AsyncAppender* appender,
+              log4cplus::spi::InternalLoggingEvent* event,
+              const bool block) {
+        const QueuedEvent queued = { appender, event };
+        while (!tryPush(queued)) {
+            if (!block || stopped_) {
+                return (false);
+            }
+            wakeUp();
+            usleep(BLOCK_WAIT);
+        }
+        __sync_synchronize();
+        if (stopped_) {
+            // The queue was stopped while the event was pushed, it may have
+            // missed the final drain.
+            Mutex::Locker locker(stop_mutex_);
+            drain();
+            return (true);
+        }
+        wakeUp();
+        return (true);
+    }
+
+    /// \brief Output an event right away, once the queue has been stopped
+    ///
+    /// The events left in the queue are output first, and the events
+    /// output by concurrent calls are serialized.
+    ///
+    /// \param appender The appender the event is output by.
+    /// \param event The event.
+    void dispatchStopped(AsyncAppender* appender,
+                         const log4cplus::spi::InternalLoggingEvent& event) {
+        Mutex::Locker locker(stop_mutex_);
+        drain();
+        appender->dispatch(event);
+    }
+
+    /// \brief Wait for the events queued so far to be output
+    void flush() {
+        const uint64_t target = enqueue_pos_;
+        while (!stopped_ && (processed_ < target)) {
+            wakeUp();
+            usleep(FLUSH_WAIT);
+        }
+    }
+
+    /// \brief Output the queued events and stop the output thread
+    void stop() {
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        wakeUp();
+        try {
+            thread_->wait();
+        } catch (...) {
+            // The thread catches the exceptions of the appenders.
+        }
+        // From now on the events are output by the logging threads, under
+        // the same lock as the events pushed after the thread stopped
+        // checking, so that they are neither output concurrently nor out
+        // of order.
+        Mutex::Locker locker(stop_mutex_);
+        stopped_ = true;
+        __sync_synchronize();
+        drain();
+    }
+
+    /// \brief Checks if the output thread has been stopped
+    bool isStopped() const {
+        return (stopped_);
+    }
+
+private:
+    /// \brief Slot of the ring
+    struct Slot {
+        volatile uint64_t sequence_;
+        QueuedEvent event_;
+    };
+
+    /// \brief Push an event if there is room in the queue
+    bool tryPush(const QueuedEvent& queued) {
+        uint64_t pos = enqueue_pos_;
+        while (true) {
+            Slot& slot = slots_[pos & mask_];
+            const uint64_t sequence = slot.sequence_;
+            __sync_synchronize();
+            const int64_t diff = static_cast<int64_t>(sequence - pos);
+            if (diff == 0) {
+                // The slot is free: claim it.
+                const uint64_t current =
+                    __sync_val_compare_and_swap(&enqueue_pos_, pos, pos + 1);
+                if (current == pos) {
+                    slot.event_ = queued;
+                    __sync_synchronize();
+                    slot.sequence_ = pos + 1;
+                    return (true);
+                }
+                pos = current;
+            } else if (diff < 0) {
+                // The slot has not been released by the output thread
+                // since the previous round: the queue is full.
+                return (false);
+            } else {
+                // Another thread has claimed the slot.
+                pos = enqueue_pos_;
+            }
+        }
+    }
+
+    /// \brief Pop an event, called by the output thread only
+    bool pop(QueuedEvent& queued) {
+        Slot& slot = slots_[dequeue_pos_ & mask_];
+        if (slot.sequence_ != dequeue_pos_ + 1) {
+            return (false);
+        }
+        __sync_synchronize();
+        queued = slot.event_;
+        __sync_synchronize();
+        slot.sequence_ = dequeue_pos_ + mask_ + 1;
+        ++dequeue_pos_;
+        return (true);
+    }
+
+    /// \brief Checks if there is an event to pop
+    bool isEmpty() const {
+        return (slots_[dequeue_pos_ & mask_].sequence_ != dequeue_pos_ + 1);
+    }
+
+    /// \brief Wake the output thread up if it is sleeping
+    void wakeUp() {
+        __sync_synchronize();
+        if (sleeping_) {
+            Mutex::Locker locker(mutex_);
+            cond_.signal();
+        }
+    }
+
+    /// \brief Output a batch of events under the interprocess lock
+    void outputBatch() {
+        interprocess::InterprocessSyncLocker locker(*sync_);
+        locker.lock();
+        QueuedEvent queued;
+        for (size_t i = 0; (i < AsyncAppender::MAX_BATCH) && pop(queued);
+             ++i) {
+            try {
+                queued.appender_->dispatch(*queued.event_);
+            } catch (...) {
+                // Nowhere to report it; carry on with the next event.
+            }
+            delete queued.event_;
+            processed_ = dequeue_pos_;
+        }
+        locker.unlock();
+    }
+
+    /// \brief Output all the queued events, once the output thread has
+    /// stopped
+    ///
+    /// Must be called with the stop mutex held.
+    void drain() {
+        while (!isEmpty()) {
+            outputBatch();
+        }
+    }
+
+    /// \brief Main function of the output thread
+    void run() {
+        while (true) {
+            if (!isEmpty()) {
+                outputBatch();
+                continue;
+            }
+            Mutex::Locker locker(mutex_);
+            sleeping_ = true;
+            __sync_synchronize();
+            if (isEmpty() && !stopping_) {
+                cond_.wait(mutex_);
+            }
+            sleeping_ = false;
+            if (stopping_ && isEmpty()) {
+                break;
+            }
+        }
+    }
+
+    boost::scoped_array<Slot> slots_;
+    const uint64_t mask_;
+    volatile uint64_t enqueue_pos_;
+    uint64_t dequeue_pos_;
+    volatile uint64_t processed_;
+    volatile bool sleeping_;
+    volatile bool stopping_;
+    volatile bool stopped_;
+    Mutex mutex_;
+    Mutex stop_mutex_;
+    CondVar cond_;
+    boost::scoped_ptr<interprocess::InterprocessSync> sync_;
+    boost::scoped_ptr<Thread> thread_;
+};
+
+/// \brief The queue, created with the first asynchronous appender
+///
+/// The queue is never destroyed, as the appenders may be destroyed after
+/// the static objects of this file at exit.
+AsyncQueue* queue_instance = NULL;
+
+AsyncQueue&
+getQueue() {
+    static AsyncQueue* queue =
+        (queue_instance = new AsyncQueue(AsyncAppender::QUEUE_CAPACITY));
+    return (*queue);
+}
+
+/// \brief Stops the output thread at exit
+struct QueueStopper {
+    ~QueueStopper() {
+        AsyncAppender::stopQueue();
+    }
+} queue_stopper;
+
+}
+
+const size_t AsyncAppender::QUEUE_CAPACITY;
+const size_t AsyncAppender::MAX_BATCH;
+
+AsyncAppender::AsyncAppender(OverflowPolicy overflow) :
+    overflow_(overflow), dropped_(0), reported_(0)
+{
+    // Make sure the output thread is running.
+    (void) getQueue();
+}
+
+AsyncAppender::~AsyncAppender() {
+    try {
+        close();
+        destructorImpl();
+    } catch (...) {
+        // Nothing more we can do.
+    }
+}
+
+void
+AsyncAppender::addAppender(const log4cplus::SharedAppenderPtr& appender) {
+    appenders_.push_back(appender);
+}
+
+void
+AsyncAppender::close() {
+    flushQueue();
+    std::vector<log4cplus::SharedAppenderPtr> appenders;
+    appenders.swap(appenders_);
+    for (size_t i = 0; i < appenders.size(); ++i) {
+        appenders[i]->close();
+    }
+}
+
+void
+AsyncAppender::flushQueue() {
+    if (queue_instance != NULL) {
+        queue_instance->flush();
+    }
+}
+
+void
+AsyncAppender::stopQueue() {
+    if (queue_instance != NULL) {
+        queue_instance->stop();
+    }
+}
+
+void
+AsyncAppender::dispatch(const log4cplus::spi::InternalLoggingEvent& event) {
+    const uint64_t dropped = dropped_;
+    if (dropped != reported_) {
+        std::string text = MessageDictionary::globalDictionary().
+            getText(LOG_ASYNC_MESSAGES_DROPPED);
+        replacePlaceholder(&text,
+                           boost::lexical_cast<std::string>(dropped -
+                                                            reported_), 1);
+        const log4cplus::spi::InternalLoggingEvent
+            warning(event.getLoggerName(), log4cplus::WARN_LOG_LEVEL,
+                    std::string(LOG_ASYNC_MESSAGES_DROPPED) + " " + text,
+                    __FILE__, __LINE__);
+        reported_ = dropped;
+        for (size_t i = 0; i < appenders_.size(); ++i) {
+            appenders_[i]->doAppend(warning);
+        }
+    }
+    for (size_t i = 0; i < appenders_.size(); ++i) {
+        appenders_[i]->doAppend(event);
+    }
+}
+
+void
+AsyncAppender::append(const log4cplus::spi::InternalLoggingEvent& event) {
+    AsyncQueue& queue = getQueue();
+    if (!queue.isStopped()) {
+        std::auto_ptr<log4cplus::spi::InternalLoggingEvent> copy =
+            event.clone();
+        if (queue.push(this, copy.get(), overflow_ == OVERFLOW_BLOCK)) {
+            copy.release();
+            return;
+        }
+        if (!queue.isStopped()) {
+            __sync_fetch_and_add(&dropped_, 1);
+            return;
+        }
+    }
+    // The output thread has been stopped, output the event right away.
+    queue.dispatchStopped(this, event);
+}
+
+} // end namespace internal
+} // end namespace log
+} // end namespace isc
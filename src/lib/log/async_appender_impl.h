@@ -0,0 +1,138 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LOG_ASYNC_APPENDER_H
+#define LOG_ASYNC_APPENDER_H
+
+#include <log/logger_specification.h>
+
+#include <log4cplus/logger.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace log {
+namespace internal {
+
+/// \brief Asynchronous Logger Appender
+///
+/// This class is set as the only appender of an asynchronous logger (see
+/// \c LoggerSpecification::setAsync()) and holds the appenders created
+/// for the output options of that logger.  A copy of each event passed
+/// to \c append() is pushed into a bounded lock-free queue shared by all
+/// asynchronous appenders of the process, and the events are passed to
+/// the held appenders by a dedicated output thread.  So the thread logging
+/// a message neither waits for the output nor takes the interprocess lock
+/// guarding the log files: the output thread takes that lock once for a
+/// batch of messages.
+///
+/// When the queue is full, the logging thread either waits for room in the
+/// queue or drops the message, depending on the overflow policy of the
+/// appender.  The dropped messages are counted and the count is reported
+/// in a warning output before the next message of the appender.
+///
+/// The time stamps of the messages are those of the original events, i.e.
+/// the time the messages were logged rather than the time they were
+/// output.  The messages logged by one thread to one appender are output
+/// in the order they were logged.
+///
+/// The appender waits for its queued events to be output when it is
+/// closed, so the messages are not lost on reconfiguration.  When the
+/// output thread has been stopped at exit of the process, the events are
+/// passed to the held appenders right away.
+class AsyncAppender : public log4cplus::Appender {
+public:
+    /// \brief Number of events the queue can hold
+    static const size_t QUEUE_CAPACITY = 16384;
+
+    /// \brief Maximum number of events output under one interprocess lock
+    static const size_t MAX_BATCH = 256;
+
+    /// \brief Constructor
+    ///
+    /// \param overflow What to do with an event when the queue is full.
+    explicit AsyncAppender(OverflowPolicy overflow = OVERFLOW_BLOCK);
+
+    /// \brief Destructor
+    ///
+    /// Closes the appender.
+    virtual ~AsyncAppender();
+
+    /// \brief Add an appender the events are passed to
+    ///
+    /// Must be called before the appender is attached to a logger.
+    ///
+    /// \param appender The appender to be added.
+    void addAppender(const log4cplus::SharedAppenderPtr& appender);
+
+    /// \brief Close the appender
+    ///
+    /// Waits for the queued events of this appender to be output and
+    /// closes the held appenders.
+    virtual void close();
+
+    /// \brief Returns the overflow policy
+    OverflowPolicy getOverflow() const {
+        return (overflow_);
+    }
+
+    /// \brief Returns the number of events dropped since the appender
+    /// was created
+    uint64_t getDroppedCount() const {
+        return (dropped_);
+    }
+
+    /// \brief Wait for the events queued so far to be output
+    ///
+    /// Returns immediately if the output thread has been stopped.
+    static void flushQueue();
+
+    /// \brief Stop the output thread
+    ///
+    /// Outputs the queued events and stops the output thread.  The events
+    /// appended afterwards are output by the thread logging them.  This
+    /// is called when the process exits.
+    static void stopQueue();
+
+    /// \brief Output the event to the held appenders
+    ///
+    /// This is called by the output thread.
+    ///
+    /// \param event The event to be output.
+    void dispatch(const log4cplus::spi::InternalLoggingEvent& event);
+
+protected:
+    virtual void append(const log4cplus::spi::InternalLoggingEvent& event);
+
+private:
+    /// \brief Appenders the events are passed to
+    std::vector<log4cplus::SharedAppenderPtr> appenders_;
+
+    /// \brief Overflow policy
+    const OverflowPolicy overflow_;
+
+    /// \brief Number of events dropped, updated by the logging threads
+    volatile uint64_t dropped_;
+
+    /// \brief Number of dropped events reported by the output thread
+    uint64_t reported_;
+};
+
+} // end namespace internal
+} // end namespace log
+} // end namespace isc
+
+#endif // LOG_ASYNC_APPENDER_H
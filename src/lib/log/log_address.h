@@ -0,0 +1,56 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LOG_ADDRESS_H
+#define LOG_ADDRESS_H
+
+#include <asiolink/compact_address.h>
+#include <asiolink/io_address.h>
+#include <log/log_record.h>
+
+#include <stdint.h>
+
+namespace isc {
+namespace log {
+
+/// \brief Add an IP address to a log record
+///
+/// This stores the bytes of the address in a record of the deferred log
+/// formatter (see \c isc::log::DeferredFormatter), which converts the
+/// address to text when the message is output.
+///
+/// The overload is kept out of the log library, which does not depend on
+/// the asiolink library: only the code including this header (and already
+/// linked with asiolink) uses it.  Without it, the addresses logged by
+/// the deferred formatter are converted to text when they are added.
+///
+/// \param record The record the address is added to.
+/// \param address The \c IOAddress object to be added.
+inline void
+encodeLogArg(LogRecord& record, const isc::asiolink::IOAddress& address) {
+    const isc::asiolink::CompactAddress compact(address);
+    uint8_t bytes[isc::asiolink::V6ADDRESS_LEN];
+    if (address.isV4()) {
+        compact.toBytes(bytes);
+        record.addAddress(bytes, isc::asiolink::V4ADDRESS_LEN);
+    } else {
+        compact.toV6Bytes(bytes);
+        record.addAddress(bytes, isc::asiolink::V6ADDRESS_LEN);
+    }
+}
+
+} // namespace log
+} // namespace isc
+
+#endif // LOG_ADDRESS_H
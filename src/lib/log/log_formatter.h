@@ -22,6 +22,7 @@
 #include <exceptions/exceptions.h>
 #include <boost/lexical_cast.hpp>
 #include <log/logger_level.h>
+#include <log/log_record.h>
 
 namespace isc {
 namespace log {
@@ -266,6 +267,109 @@ public:
     }
 };
 
+///
+/// \brief The deferred log message formatter
+///
+/// This is the counterpart of the \c Formatter for the messages logged on
+/// busy paths (see the LOG_DEBUG_DEFERRED and LOG_INFO_DEFERRED macros).
+/// Rather than replacing the placeholders of the message text as the
+/// arguments are passed, it stores the raw values of the arguments in a
+/// \c LogRecord held by value.  The text is produced when the message is
+/// output: by the output thread if the output of the logger is asynchronous,
+/// otherwise right away, but still without the conversion and replacement
+/// done by \c Formatter::arg() for each argument.
+///
+/// The arguments are added by \c encodeLogArg(), so the integers, the text
+/// and the types with their own \c encodeLogArg() overload (such as the IP
+/// addresses) are stored without being converted to text.
+///
+/// As the placeholders are only checked when the text is produced, the
+/// mismatched placeholders are always reported in the text of the message
+/// rather than by exceptions.  Also, the placeholders in the text arguments
+/// are never replaced, whatever the order of the arguments.
+template<class Logger> class DeferredFormatter {
+private:
+    /// \brief The logger we will use to output the record.
+    ///
+    /// If NULL, we are not active and should not produce anything.
+    mutable Logger* logger_;
+
+    /// \brief Message severity
+    Severity severity_;
+
+    /// \brief The message and its arguments
+    LogRecord record_;
+
+public:
+    /// \brief Constructor
+    ///
+    /// \param severity The severity of the message.
+    /// \param id Identification of the message.
+    /// \param logger The logger where the final output will go, or NULL
+    ///     if no output is wanted.
+    DeferredFormatter(const Severity& severity = NONE,
+                      const MessageID& id = NULL, Logger* logger = NULL) :
+        logger_(logger), severity_(severity), record_(id)
+    {
+    }
+
+    /// \brief Copy constructor
+    ///
+    /// As for the \c Formatter, the created object takes the responsibility
+    /// for outputting the message.
+    DeferredFormatter(const DeferredFormatter& other) :
+        logger_(other.logger_), severity_(other.severity_),
+        record_(other.record_)
+    {
+        other.logger_ = NULL;
+    }
+
+    /// \brief Destructor
+    ///
+    /// This is the place where output happens if the formatter is active.
+    ~DeferredFormatter() {
+        if (logger_) {
+            try {
+                logger_->output(severity_, record_);
+            } catch (...) {
+                // Catch and ignore all exceptions here.
+            }
+        }
+    }
+
+    /// \brief Assignment operator
+    DeferredFormatter& operator =(const DeferredFormatter& other) {
+        if (&other != this) {
+            logger_ = other.logger_;
+            severity_ = other.severity_;
+            record_ = other.record_;
+            other.logger_ = NULL;
+        }
+        return (*this);
+    }
+
+    /// \brief Adds another argument
+    ///
+    /// \param value The argument to place into the next placeholder.
+    template<class Arg> DeferredFormatter& arg(const Arg& value) {
+        if (logger_) {
+            try {
+                encodeLogArg(record_, value);
+            } catch (const boost::bad_lexical_cast& ex) {
+                deactivate();
+                isc_throw(FormatFailure, "bad_lexical_cast in call to "
+                          "DeferredFormatter::arg(): " << ex.what());
+            }
+        }
+        return (*this);
+    }
+
+    /// \brief Turn off the output of this logger.
+    void deactivate() {
+        logger_ = NULL;
+    }
+};
+
 }
 }
 
@@ -0,0 +1,144 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <log/log_record.h>
+#include <log/message_dictionary.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace std;
+
+namespace isc {
+namespace log {
+
+const size_t LogRecord::MAX_ARGS;
+const size_t LogRecord::TEXT_SIZE;
+
+namespace {
+
+/// \brief Append an unsigned integer in decimal
+void
+appendUint(uint64_t value, string& text) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+        text.push_back(digits[--count]);
+    }
+}
+
+}
+
+void
+LogRecord::formatArgument(const Argument& arg, string& text) const {
+    switch (arg.type_) {
+    case INT:
+        if (arg.value_.int_ < 0) {
+            text.push_back('-');
+            // Negate in unsigned arithmetic, so the minimum works too.
+            appendUint(-static_cast<uint64_t>(arg.value_.int_), text);
+        } else {
+            appendUint(arg.value_.int_, text);
+        }
+        break;
+
+    case UINT:
+        appendUint(arg.value_.uint_, text);
+        break;
+
+    case TEXT:
+        text.append(text_ + arg.value_.text_.offset_,
+                    arg.value_.text_.length_);
+        if (arg.truncated_) {
+            text.append("...");
+        }
+        break;
+
+    case ADDRESS4:
+    case ADDRESS6: {
+        char buf[INET6_ADDRSTRLEN];
+        if (inet_ntop(arg.type_ == ADDRESS4 ? AF_INET : AF_INET6,
+                      arg.value_.address_, buf, sizeof(buf)) != NULL) {
+            text.append(buf);
+        }
+        break;
+    }
+    }
+}
+
+void
+LogRecord::format(string& text) const {
+    const string& message =
+        MessageDictionary::globalDictionary().getText(id_ ? id_ : "");
+    text.reserve(text.size() + message.size() + text_used_ + 64);
+    if (id_) {
+        text.append(id_);
+    }
+    text.push_back(' ');
+
+    // Replace each placeholder, remembering those which were found.
+    unsigned used = 0;
+    bool excess = false;
+    size_t pos = 0;
+    while (pos < message.size()) {
+        const size_t mark = message.find('%', pos);
+        if (mark == string::npos) {
+            text.append(message, pos, string::npos);
+            break;
+        }
+        text.append(message, pos, mark - pos);
+        size_t end = mark + 1;
+        unsigned placeholder = 0;
+        while ((end < message.size()) && (message[end] >= '0') &&
+               (message[end] <= '9') && (placeholder < 100)) {
+            placeholder = placeholder * 10 + (message[end] - '0');
+            ++end;
+        }
+        if ((placeholder > 0) && (placeholder <= count_)) {
+            formatArgument(args_[placeholder - 1], text);
+            used |= 1 << (placeholder - 1);
+        } else {
+            // Not a placeholder or one without an argument: keep it.
+            text.append(message, mark, end - mark);
+            excess = excess || (placeholder > 0);
+        }
+        pos = end;
+    }
+
+    for (unsigned i = 0; i < count_; ++i) {
+        if ((used & (1 << i)) == 0) {
+            text.append(" @@Missing placeholder %");
+            appendUint(i + 1, text);
+            text.append(" for '");
+            formatArgument(args_[i], text);
+            text.append("'@@");
+        }
+    }
+    if (excess_ > 0) {
+        text.append(" @@Too many arguments, ");
+        appendUint(excess_, text);
+        text.append(" dropped@@");
+    }
+    if (excess) {
+        text.append(" @@Excess logger placeholders still exist@@");
+    }
+}
+
+} // namespace log
+} // namespace isc
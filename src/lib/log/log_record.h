@@ -0,0 +1,271 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <log/message_types.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <cstring>
+#include <string>
+
+#include <stdint.h>
+
+namespace isc {
+namespace log {
+
+/// \brief Log message with unformatted arguments
+///
+/// The record holds the identification of a message and the raw values of
+/// its arguments in a fixed-size object, so it can be filled in without
+/// allocating memory.  The text of the message is only produced by
+/// \c format(), which looks up the message in the global dictionary and
+/// replaces the placeholders in a single pass.  This is used by the
+/// \c DeferredFormatter, so the text of the messages output asynchronously
+/// is produced by the output thread.
+///
+/// The integers and addresses are stored as binary values.  The text
+/// arguments are copied into a buffer shared by all the arguments of the
+/// record and truncated (marked with "...") when it is full.  The
+/// arguments beyond \c MAX_ARGS are dropped and reported in the text.
+class LogRecord {
+public:
+    /// \brief Maximum number of arguments
+    static const size_t MAX_ARGS = 8;
+
+    /// \brief Size of the buffer holding the text arguments
+    static const size_t TEXT_SIZE = 256;
+
+    /// \brief Constructor
+    ///
+    /// \param id Identification of the message.
+    explicit LogRecord(const MessageID& id = NULL) :
+        id_(id), count_(0), excess_(0), text_used_(0)
+    {}
+
+    /// \brief Returns the identification of the message
+    const MessageID& getId() const {
+        return (id_);
+    }
+
+    /// \brief Returns the number of arguments held
+    size_t getArgCount() const {
+        return (count_);
+    }
+
+    /// \brief Add a signed integer argument
+    void addInt(const int64_t value) {
+        Argument* arg = nextArgument(INT);
+        if (arg) {
+            arg->value_.int_ = value;
+        }
+    }
+
+    /// \brief Add an unsigned integer argument
+    void addUint(const uint64_t value) {
+        Argument* arg = nextArgument(UINT);
+        if (arg) {
+            arg->value_.uint_ = value;
+        }
+    }
+
+    /// \brief Add a text argument
+    ///
+    /// \param text Text of the argument.
+    /// \param length Length of the text.
+    void addText(const char* text, size_t length) {
+        Argument* arg = nextArgument(TEXT);
+        if (arg) {
+            const size_t room = TEXT_SIZE - text_used_;
+            arg->truncated_ = (length > room);
+            if (arg->truncated_) {
+                length = room;
+            }
+            std::memcpy(text_ + text_used_, text, length);
+            arg->value_.text_.offset_ = text_used_;
+            arg->value_.text_.length_ = length;
+            text_used_ += length;
+        }
+    }
+
+    /// \brief Add a text argument
+    void addText(const std::string& text) {
+        addText(text.data(), text.size());
+    }
+
+    /// \brief Add an IP address argument
+    ///
+    /// \param data Address in network byte order.
+    /// \param length Length of the address: 4 for IPv4, 16 for IPv6.
+    void addAddress(const uint8_t* data, const size_t length) {
+        Argument* arg = nextArgument(length == 4 ? ADDRESS4 : ADDRESS6);
+        if (arg) {
+            std::memcpy(arg->value_.address_, data,
+                        length == 4 ? 4 : sizeof(arg->value_.address_));
+        }
+    }
+
+    /// \brief Produce the text of the message
+    ///
+    /// The text is made of the identification of the message followed by
+    /// the text from the global dictionary, with the placeholders replaced
+    /// by the arguments.  Like the \c Formatter does, the missing and the
+    /// excess placeholders are reported at the end of the text.
+    ///
+    /// \param text String the text is appended to.
+    void format(std::string& text) const;
+
+private:
+    /// \brief Types of the arguments
+    enum ArgType {
+        INT,
+        UINT,
+        TEXT,
+        ADDRESS4,
+        ADDRESS6
+    };
+
+    /// \brief Argument of the message
+    struct Argument {
+        uint8_t type_;
+        bool truncated_;
+        union {
+            int64_t int_;
+            uint64_t uint_;
+            struct {
+                uint16_t offset_;
+                uint16_t length_;
+            } text_;
+            uint8_t address_[16];
+        } value_;
+    };
+
+    /// \brief Returns the next free argument or NULL if there is none
+    Argument* nextArgument(const ArgType type) {
+        if (count_ >= MAX_ARGS) {
+            if (excess_ < 0xff) {
+                ++excess_;
+            }
+            return (NULL);
+        }
+        Argument* arg = &args_[count_++];
+        arg->type_ = type;
+        arg->truncated_ = false;
+        return (arg);
+    }
+
+    /// \brief Append the text of an argument
+    void formatArgument(const Argument& arg, std::string& text) const;
+
+    MessageID id_;
+    uint8_t count_;
+    uint8_t excess_;
+    uint16_t text_used_;
+    Argument args_[MAX_ARGS];
+    char text_[TEXT_SIZE];
+};
+
+/// \brief Add an argument to a log record
+///
+/// The overloads store the values of the common types in their binary
+/// form.  Other types are converted to text, the same way the \c Formatter
+/// does; a library can add an overload in the namespace of its type to
+/// store the type in a better way (it is found by argument-dependent
+/// lookup).
+///
+/// \param record The record the argument is added to.
+/// \param value Value of the argument.
+template<class Arg>
+void
+encodeLogArg(LogRecord& record, const Arg& value) {
+    record.addText(boost::lexical_cast<std::string>(value));
+}
+
+inline void
+encodeLogArg(LogRecord& record, const std::string& value) {
+    record.addText(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const char* value) {
+    record.addText(value, std::strlen(value));
+}
+
+// The characters are output as such, not as numbers.
+inline void
+encodeLogArg(LogRecord& record, const char value) {
+    record.addText(&value, 1);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const signed char value) {
+    record.addText(reinterpret_cast<const char*>(&value), 1);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const unsigned char value) {
+    record.addText(reinterpret_cast<const char*>(&value), 1);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const bool value) {
+    record.addUint(value ? 1 : 0);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const short value) {
+    record.addInt(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const unsigned short value) {
+    record.addUint(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const int value) {
+    record.addInt(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const unsigned int value) {
+    record.addUint(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const long value) {
+    record.addInt(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const unsigned long value) {
+    record.addUint(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const long long value) {
+    record.addInt(value);
+}
+
+inline void
+encodeLogArg(LogRecord& record, const unsigned long long value) {
+    record.addUint(value);
+}
+
+} // namespace log
+} // namespace isc
+
+#endif // LOG_RECORD_H
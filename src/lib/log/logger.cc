@@ -29,6 +29,8 @@ using namespace std;
 namespace isc {
 namespace log {
 
+volatile uint32_t Logger::config_generation_ = 1;
+
 // Initialize underlying logger, but only if logging has been initialized.
 void Logger::initLoggerImpl() {
     if (isLoggingInitialized()) {
@@ -93,31 +95,18 @@ Logger::getEffectiveDebugLevel() {
     return (getLoggerPtr()->getEffectiveDebugLevel());
 }
 
-// Check on the current severity settings
-
-bool
-Logger::isDebugEnabled(int dbglevel) {
-    return (getLoggerPtr()->isDebugEnabled(dbglevel));
-}
-
-bool
-Logger::isInfoEnabled() {
-    return (getLoggerPtr()->isInfoEnabled());
-}
+// Read the generation first: if the loggers are reconfigured while the level
+// is read, the next check finds a newer generation and reads it again.
 
-bool
-Logger::isWarnEnabled() {
-    return (getLoggerPtr()->isWarnEnabled());
-}
-
-bool
-Logger::isErrorEnabled() {
-    return (getLoggerPtr()->isErrorEnabled());
-}
-
-bool
-Logger::isFatalEnabled() {
-    return (getLoggerPtr()->isFatalEnabled());
+void
+Logger::refreshLevel() {
+    const uint32_t generation = config_generation_;
+    __sync_synchronize();
+    const Level level = getLoggerPtr()->getEffectiveLevel();
+    severity_ = level.severity;
+    dbglevel_ = level.dbglevel;
+    __sync_synchronize();
+    level_generation_ = generation;
 }
 
 // Format a message: looks up the message text in the dictionary and formats
@@ -134,6 +123,11 @@ Logger::output(const Severity& severity, const std::string& message) {
     getLoggerPtr()->outputRaw(severity, message);
 }
 
+void
+Logger::output(const Severity& severity, const LogRecord& record) {
+    getLoggerPtr()->outputRecord(severity, record);
+}
+
 Logger::Formatter
 Logger::debug(int dbglevel, const isc::log::MessageID& ident) {
     if (isDebugEnabled(dbglevel)) {
@@ -184,6 +178,26 @@ Logger::fatal(const isc::log::MessageID& ident) {
     }
 }
 
+// Output with deferred formatting
+
+Logger::DeferredFormatter
+Logger::debugDeferred(int dbglevel, const isc::log::MessageID& ident) {
+    if (isDebugEnabled(dbglevel)) {
+        return (DeferredFormatter(DEBUG, ident, this));
+    } else {
+        return (DeferredFormatter());
+    }
+}
+
+Logger::DeferredFormatter
+Logger::infoDeferred(const isc::log::MessageID& ident) {
+    if (isInfoEnabled()) {
+        return (DeferredFormatter(INFO, ident, this));
+    } else {
+        return (DeferredFormatter());
+    }
+}
+
 // Replace the interprocess synchronization object
 
 void
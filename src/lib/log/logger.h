@@ -15,10 +15,12 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <string>
 #include <cstring>
+#include <stdint.h>
 
 #include <boost/static_assert.hpp>
 
@@ -170,7 +172,8 @@ public:
     /// \note Note also that there is no constructor taking a std::string. This
     /// minimises the possibility of initializing a static logger with a
     /// string, so leading to problems mentioned above.
-    Logger(const char* name) : loggerptr_(NULL) {
+    Logger(const char* name) : loggerptr_(NULL), level_generation_(0),
+        severity_(DEFAULT), dbglevel_(MIN_DEBUG_LEVEL) {
 
         // Validate the name of the logger.
         if (name == NULL) {
@@ -203,6 +206,9 @@ public:
     /// \brief The formatter used to replace placeholders
     typedef isc::log::Formatter<Logger> Formatter;
 
+    /// \brief The formatter storing the arguments for deferred formatting
+    typedef isc::log::DeferredFormatter<Logger> DeferredFormatter;
+
     /// \brief Get Name of Logger
     ///
     /// \return The full name of the logger (including the root name)
@@ -247,22 +253,42 @@ public:
 
     /// \brief Returns if Debug Message Should Be Output
     ///
+    /// The check compares with the effective level cached by the logger, so
+    /// the implementation is only called after the loggers have been
+    /// reconfigured.
+    ///
     /// \param dbglevel Level for which debugging is checked.  Debugging is
     /// enabled only if the logger has DEBUG enabled and if the dbglevel
     /// checked is less than or equal to the debug level set for the logger.
-    virtual bool isDebugEnabled(int dbglevel = MIN_DEBUG_LEVEL);
+    bool isDebugEnabled(int dbglevel = MIN_DEBUG_LEVEL) {
+        checkLevel();
+        return ((severity_ == DEBUG) &&
+                (std::min(dbglevel, MAX_DEBUG_LEVEL) <= dbglevel_));
+    }
 
     /// \brief Is INFO Enabled?
-    virtual bool isInfoEnabled();
+    bool isInfoEnabled() {
+        checkLevel();
+        return (severity_ <= INFO);
+    }
 
     /// \brief Is WARNING Enabled?
-    virtual bool isWarnEnabled();
+    bool isWarnEnabled() {
+        checkLevel();
+        return (severity_ <= WARN);
+    }
 
     /// \brief Is ERROR Enabled?
-    virtual bool isErrorEnabled();
+    bool isErrorEnabled() {
+        checkLevel();
+        return (severity_ <= ERROR);
+    }
 
     /// \brief Is FATAL Enabled?
-    virtual bool isFatalEnabled();
+    bool isFatalEnabled() {
+        checkLevel();
+        return (severity_ <= FATAL);
+    }
 
     /// \brief Output Debug Message
     ///
@@ -291,6 +317,22 @@ public:
     /// \param ident Message identification.
     Formatter fatal(const MessageID& ident);
 
+    /// \brief Output Debug Message with Deferred Formatting
+    ///
+    /// Same as \c debug(), but the arguments are stored as they are and the
+    /// text of the message is produced when it is output (see
+    /// \c DeferredFormatter).  This is meant for the messages logged for
+    /// each packet.
+    ///
+    /// \param dbglevel Debug level, ranging between 0 and 99.
+    /// \param ident Message identification.
+    DeferredFormatter debugDeferred(int dbglevel, const MessageID& ident);
+
+    /// \brief Output Informational Message with Deferred Formatting
+    ///
+    /// \param ident Message identification.
+    DeferredFormatter infoDeferred(const MessageID& ident);
+
     /// \brief Replace the interprocess synchronization object
     ///
     /// If this method is called with NULL as the argument, it throws a
@@ -316,6 +358,8 @@ public:
 
 private:
     friend class isc::log::Formatter<Logger>;
+    friend class isc::log::DeferredFormatter<Logger>;
+    friend class LoggerManagerImpl;
 
     /// \brief Raw output function
     ///
@@ -325,6 +369,14 @@ private:
     /// \param message Text of the message to be output.
     void output(const Severity& severity, const std::string& message);
 
+    /// \brief Record output function
+    ///
+    /// This is used by the deferred formatter to output the message.
+    ///
+    /// \param severity Severity of the message being output.
+    /// \param record The message and its arguments.
+    void output(const Severity& severity, const LogRecord& record);
+
     /// \brief Copy Constructor
     ///
     /// Disabled (marked private) as it makes no sense to copy the logger -
@@ -359,8 +411,31 @@ private:
     /// \brief Initialize Underlying Implementation and Set loggerptr_
     void initLoggerImpl();
 
+    /// \brief Check that the cached effective level is current
+    ///
+    /// Reads the effective level from the implementation if the loggers
+    /// have been reconfigured since it was cached.
+    void checkLevel() {
+        if (level_generation_ != config_generation_) {
+            refreshLevel();
+        }
+    }
+
+    /// \brief Update the cached effective level
+    void refreshLevel();
+
+    /// \brief Generation of the configuration of the loggers
+    ///
+    /// Incremented by the \c LoggerManagerImpl each time the severity or
+    /// the output of the loggers is changed.  It starts at 1 so that the
+    /// level of a new logger is read on the first check.
+    static volatile uint32_t config_generation_;
+
     LoggerImpl* loggerptr_;                  ///< Pointer to underlying logger
     char        name_[MAX_LOGGER_NAME_SIZE + 1]; ///< Copy of the logger name
+    uint32_t    level_generation_;           ///< Generation of cached level
+    Severity    severity_;                   ///< Cached effective severity
+    int         dbglevel_;                   ///< Cached effective debug level
 };
 
 } // namespace log
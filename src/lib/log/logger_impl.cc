@@ -15,6 +15,7 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -25,6 +26,7 @@
 
 #include <log4cplus/configurator.h>
 #include <log4cplus/loggingmacros.h>
+#include <log4cplus/spi/loggingevent.h>
 
 #include <log/logger.h>
 #include <log/logger_impl.h>
@@ -32,6 +34,7 @@
 #include <log/logger_level_impl.h>
 #include <log/logger_name.h>
 #include <log/logger_manager.h>
+#include <log/logger_manager_impl.h>
 #include <log/message_dictionary.h>
 #include <log/message_types.h>
 #include <log/interprocess/interprocess_sync_file.h>
@@ -48,11 +51,46 @@ using namespace std;
 namespace isc {
 namespace log {
 
-/// @brief detects whether file locking is enabled or disabled
+namespace {
+
+/// \brief Logging event holding a log record
 ///
-/// The lockfile is enabled by default. The only way to disable it is to
-/// set KEA_LOCKFILE_DIR variable to 'none'.
-/// @return true if lockfile is enabled, false otherwise
+/// The text of the message is only produced when the layout of an
+/// appender asks for it, i.e. by the output thread for the asynchronous
+/// appenders.  The copies made by the asynchronous appenders copy the
+/// record, not the text.
+class DeferredLoggingEvent : public log4cplus::spi::InternalLoggingEvent {
+public:
+    DeferredLoggingEvent(const string& logger, log4cplus::LogLevel level,
+                         const LogRecord& record) :
+        log4cplus::spi::InternalLoggingEvent(logger, level, string(),
+                                             __FILE__, __LINE__),
+        record_(record), formatted_(false)
+    {}
+
+    virtual const log4cplus::tstring& getMessage() const {
+        if (!formatted_) {
+            record_.format(text_);
+            formatted_ = true;
+        }
+        return (text_);
+    }
+
+    virtual std::auto_ptr<log4cplus::spi::InternalLoggingEvent>
+    clone() const {
+        return (std::auto_ptr<log4cplus::spi::InternalLoggingEvent>(
+                    new DeferredLoggingEvent(*this)));
+    }
+
+private:
+    const LogRecord record_;
+    mutable string text_;
+    mutable bool formatted_;
+};
+
+}
+
+// Detects whether file locking is enabled or disabled.
 bool lockfileEnabled() {
     const char* const env = getenv("KEA_LOCKFILE_DIR");
     if (env && boost::iequals(string(env), string("none"))) {
@@ -69,8 +107,11 @@ bool lockfileEnabled() {
 // default constructor.
 LoggerImpl::LoggerImpl(const string& name) :
     name_(expandLoggerName(name)),
-    logger_(log4cplus::Logger::getInstance(name_))
+    logger_(log4cplus::Logger::getInstance(name_)),
+    config_generation_(0), effective_level_(log4cplus::NOT_SET_LOG_LEVEL),
+    async_output_(false)
 {
+    refreshConfig();
     if (lockfileEnabled()) {
         sync_ = new interprocess::InterprocessSyncFile("logger");
     } else {
@@ -89,6 +130,9 @@ void
 LoggerImpl::setSeverity(isc::log::Severity severity, int dbglevel) {
     Level level(severity, dbglevel);
     logger_.setLogLevel(LoggerLevelImpl::convertFromBindLevel(level));
+
+    // This changes the effective severity of the children too.
+    LoggerManagerImpl::configChanged();
 }
 
 // Return severity level
@@ -121,6 +165,19 @@ LoggerImpl::getEffectiveDebugLevel() {
     return level.dbglevel;
 }
 
+// Levels below DEBUG_LOG_LEVEL are converted here, as convertToBindLevel()
+// reports those beyond MAX_DEBUG_LEVEL as DEFAULT.
+Level
+LoggerImpl::getEffectiveLevel() {
+    if (config_generation_ != LoggerManagerImpl::getConfigGeneration()) {
+        refreshConfig();
+    }
+    if (effective_level_ <= log4cplus::DEBUG_LOG_LEVEL) {
+        return (Level(DEBUG, log4cplus::DEBUG_LOG_LEVEL - effective_level_));
+    }
+    return (LoggerLevelImpl::convertToBindLevel(effective_level_));
+}
+
 
 // Output a general message
 string*
@@ -143,8 +200,28 @@ LoggerImpl::setInterprocessSync(isc::log::interprocess::InterprocessSync* sync)
     sync_ = sync;
 }
 
+// Read the generation first: if the configuration changes while the values
+// are read, the next check finds a newer generation and reads them again.
+void
+LoggerImpl::refreshConfig() {
+    const uint32_t generation = LoggerManagerImpl::getConfigGeneration();
+    __sync_synchronize();
+    effective_level_ = logger_.getChainedLogLevel();
+    async_output_ = LoggerManagerImpl::isAsyncOutput(name_);
+    __sync_synchronize();
+    config_generation_ = generation;
+}
+
 void
 LoggerImpl::outputRaw(const Severity& severity, const string& message) {
+    // The asynchronous appenders queue the message without waiting, and
+    // the output thread takes the interprocess lock for a batch of
+    // messages.
+    if (isAsyncOutput()) {
+        forwardMessage(severity, message);
+        return;
+    }
+
     // Use a mutex locker for mutual exclusion from other threads in
     // this process.
     isc::util::thread::Mutex::Locker mutex_locker(LoggerManager::getMutex());
@@ -157,6 +234,55 @@ LoggerImpl::outputRaw(const Severity& severity, const string& message) {
         LOG4CPLUS_ERROR(logger_, "Unable to lock logger lockfile");
     }
 
+    forwardMessage(severity, message);
+
+    if (!locker.unlock()) {
+        LOG4CPLUS_ERROR(logger_, "Unable to unlock logger lockfile");
+    }
+}
+
+void
+LoggerImpl::outputRecord(const Severity& severity, const LogRecord& record) {
+    if (!isAsyncOutput()) {
+        // The text is needed right away.
+        string message;
+        record.format(message);
+        outputRaw(severity, message);
+        return;
+    }
+
+    log4cplus::LogLevel level;
+    switch (severity) {
+        case DEBUG:
+            level = log4cplus::DEBUG_LOG_LEVEL;
+            break;
+
+        case INFO:
+            level = log4cplus::INFO_LOG_LEVEL;
+            break;
+
+        case WARN:
+            level = log4cplus::WARN_LOG_LEVEL;
+            break;
+
+        case ERROR:
+            level = log4cplus::ERROR_LOG_LEVEL;
+            break;
+
+        case FATAL:
+            level = log4cplus::FATAL_LOG_LEVEL;
+            break;
+
+        default:
+            return;
+    }
+    if (isEnabledFor(level)) {
+        logger_.callAppenders(DeferredLoggingEvent(name_, level, record));
+    }
+}
+
+void
+LoggerImpl::forwardMessage(const Severity& severity, const string& message) {
     switch (severity) {
         case DEBUG:
             LOG4CPLUS_DEBUG(logger_, message);
@@ -186,10 +312,6 @@ LoggerImpl::outputRaw(const Severity& severity, const string& message) {
                             "Unsupported severity in LoggerImpl::outputRaw(): "
                             << severity);
     }
-
-    if (!locker.unlock()) {
-        LOG4CPLUS_ERROR(logger_, "Unable to unlock logger lockfile");
-    }
 }
 
 } // namespace log
@@ -31,12 +31,24 @@
 
 // Kea logger files
 #include <log/logger_level_impl.h>
+#include <log/logger_manager_impl.h>
+#include <log/log_record.h>
 #include <log/message_types.h>
 #include <log/interprocess/interprocess_sync.h>
 
+#include <stdint.h>
+
 namespace isc {
 namespace log {
 
+/// \brief Detects whether file locking is enabled or disabled
+///
+/// The lockfile is enabled by default. The only way to disable it is to
+/// set KEA_LOCKFILE_DIR variable to 'none'.
+///
+/// \return true if lockfile is enabled, false otherwise
+bool lockfileEnabled();
+
 /// \brief Console Logger Implementation
 ///
 /// The logger uses a "pimpl" idiom for implementation, where the base logger
@@ -123,6 +135,17 @@ public:
     ///         the current effective severity level is not DEBUG.
     virtual int getEffectiveDebugLevel();
 
+    /// \brief Return the cached effective level
+    ///
+    /// Used by the \c Logger to cache the level in turn.  Unlike
+    /// \c getEffectiveSeverity(), this never returns DEFAULT, and the debug
+    /// level is not limited to MAX_DEBUG_LEVEL, so that comparing the debug
+    /// level of a message with it gives the same result as \c isDebugEnabled().
+    ///
+    /// \return Effective severity and debug level of the logger.  The debug
+    ///         level is only relevant if the severity is DEBUG.
+    Level getEffectiveLevel();
+
 
     /// \brief Returns if Debug Message Should Be Output
     ///
@@ -131,27 +154,27 @@ public:
     /// checked is less than or equal to the debug level set for the logger.
     virtual bool isDebugEnabled(int dbglevel = MIN_DEBUG_LEVEL) {
         Level level(DEBUG, dbglevel);
-        return logger_.isEnabledFor(LoggerLevelImpl::convertFromBindLevel(level));
+        return (isEnabledFor(LoggerLevelImpl::convertFromBindLevel(level)));
     }
 
     /// \brief Is INFO Enabled?
     virtual bool isInfoEnabled() {
-        return (logger_.isEnabledFor(log4cplus::INFO_LOG_LEVEL));
+        return (isEnabledFor(log4cplus::INFO_LOG_LEVEL));
     }
 
     /// \brief Is WARNING Enabled?
     virtual bool isWarnEnabled() {
-        return (logger_.isEnabledFor(log4cplus::WARN_LOG_LEVEL));
+        return (isEnabledFor(log4cplus::WARN_LOG_LEVEL));
     }
 
     /// \brief Is ERROR Enabled?
     virtual bool isErrorEnabled() {
-        return (logger_.isEnabledFor(log4cplus::ERROR_LOG_LEVEL));
+        return (isEnabledFor(log4cplus::ERROR_LOG_LEVEL));
     }
 
     /// \brief Is FATAL Enabled?
     virtual bool isFatalEnabled() {
-        return (logger_.isEnabledFor(log4cplus::FATAL_LOG_LEVEL));
+        return (isEnabledFor(log4cplus::FATAL_LOG_LEVEL));
     }
 
     /// \brief Raw output
@@ -164,6 +187,16 @@ public:
     /// \param message Text of the message.
     void outputRaw(const Severity& severity, const std::string& message);
 
+    /// \brief Record output
+    ///
+    /// Writes the message held by the record.  If the output of the
+    /// logger is asynchronous, the text of the message is produced by
+    /// the output thread, otherwise it is produced right away.
+    ///
+    /// \param severity Severity of the message.
+    /// \param record The message and its arguments.
+    void outputRecord(const Severity& severity, const LogRecord& record);
+
     /// \brief Look up message text in dictionary
     ///
     /// This gets you the unformatted text of message for given ID.
@@ -191,9 +224,48 @@ public:
     }
 
 private:
+    /// \brief Check if messages of a log4cplus level are output
+    ///
+    /// Equivalent to log4cplus::Logger::isEnabledFor(), but compares with
+    /// the cached effective level of the logger instead of walking up the
+    /// hierarchy of loggers.
+    ///
+    /// \param level log4cplus level of the message.
+    bool isEnabledFor(log4cplus::LogLevel level) {
+        if (config_generation_ != LoggerManagerImpl::getConfigGeneration()) {
+            refreshConfig();
+        }
+        return (level >= effective_level_);
+    }
+
+    /// \brief Check if the output of this logger is asynchronous
+    ///
+    /// The result is cached until the loggers are reconfigured.
+    bool isAsyncOutput() {
+        if (config_generation_ != LoggerManagerImpl::getConfigGeneration()) {
+            refreshConfig();
+        }
+        return (async_output_);
+    }
+
+    /// \brief Update the cached configuration of the logger
+    ///
+    /// Reads the effective level and the output mode of the logger, and
+    /// records the configuration generation they belong to.
+    void refreshConfig();
+
+    /// \brief Pass the message to log4cplus
+    ///
+    /// \param severity Severity of the message.
+    /// \param message Text of the message.
+    void forwardMessage(const Severity& severity, const std::string& message);
+
     std::string                  name_;   ///< Full name of this logger
     log4cplus::Logger            logger_; ///< Underlying log4cplus logger
     isc::log::interprocess::InterprocessSync* sync_;
+    uint32_t config_generation_;          ///< Generation of cached values
+    log4cplus::LogLevel effective_level_; ///< Cached effective level
+    bool async_output_;                   ///< Output is asynchronous
 };
 
 } // namespace log
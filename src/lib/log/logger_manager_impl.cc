@@ -34,15 +34,45 @@
 #include <log/logger_name.h>
 #include <log/logger_specification.h>
 #include <log/buffer_appender_impl.h>
+#include <log/async_appender_impl.h>
+#include <util/threads/sync.h>
 
 #include <boost/lexical_cast.hpp>
 
+#include <map>
+
 using namespace std;
 using boost::lexical_cast;
 
 namespace isc {
 namespace log {
 
+namespace {
+
+/// \brief Output mode of a logger with output options
+struct OutputMode {
+    bool async_;        ///< Output by an asynchronous appender
+    bool additive_;     ///< Messages passed to the parent
+};
+
+typedef std::map<std::string, OutputMode> OutputModeMap;
+
+/// \brief Output modes of the loggers, by expanded name
+OutputModeMap&
+getOutputModes() {
+    static OutputModeMap modes;
+    return (modes);
+}
+
+/// \brief Mutex guarding the output modes
+isc::util::thread::Mutex&
+getOutputModeMutex() {
+    static isc::util::thread::Mutex mutex;
+    return (mutex);
+}
+
+}
+
 // Reset hierarchy of loggers back to default settings.  This removes all
 // appenders from loggers, sets their severity to NOT_SET (so that events are
 // passed back to the parent) and resets the root logger to logging
@@ -76,8 +106,13 @@ LoggerManagerImpl::processSpecification(const LoggerSpecification& spec) {
     // Set the additive flag.
     logger.setAdditivity(spec.getAdditive());
 
+    // The loggers must reread their effective severity.
+    configChanged();
+
     // Output options given?
     if (spec.optionCount() > 0) {
+        setOutputMode(logger.getName(), spec.getAsync(), spec.getAdditive());
+
         // Replace all appenders for this logger.
         logger.removeAllAppenders();
 
@@ -107,6 +142,10 @@ LoggerManagerImpl::processSpecification(const LoggerSpecification& spec) {
                           i->destination);
             }
         }
+
+        if (spec.getAsync()) {
+            createAsyncAppender(logger, spec.getOverflow());
+        }
     }
 }
 
@@ -168,6 +207,24 @@ LoggerManagerImpl::createBufferAppender(log4cplus::Logger& logger) {
     logger.setLogLevel(log4cplus::TRACE_LOG_LEVEL);
 }
 
+// Asynchronous appender.  The appenders just created for the logger are
+// moved to the asynchronous appender, which passes the events to them
+// from the output thread.
+void
+LoggerManagerImpl::createAsyncAppender(log4cplus::Logger& logger,
+                                       OverflowPolicy overflow)
+{
+    internal::AsyncAppender* async = new internal::AsyncAppender(overflow);
+    log4cplus::SharedAppenderPtr asyncapp(async);
+    log4cplus::SharedAppenderPtrList appenders = logger.getAllAppenders();
+    for (log4cplus::SharedAppenderPtrList::const_iterator i =
+             appenders.begin(); i != appenders.end(); ++i) {
+        async->addAppender(*i);
+    }
+    logger.removeAllAppenders();
+    logger.addAppender(asyncapp);
+}
+
 // Syslog appender.
 void
 LoggerManagerImpl::createSyslogAppender(log4cplus::Logger& logger,
@@ -213,6 +270,7 @@ void LoggerManagerImpl::initRootLogger(isc::log::Severity severity,
                                        int dbglevel, bool buffer)
 {
     log4cplus::Logger::getDefaultHierarchy().resetConfiguration();
+    clearOutputModes();
 
     // Disable log4cplus' own logging, unless --enable-debug was
     // specified to configure. Note that this does not change
@@ -238,6 +296,54 @@ void LoggerManagerImpl::initRootLogger(isc::log::Severity severity,
         OutputOption opt;
         createConsoleAppender(kea_root, opt);
     }
+
+    // The severity of all the loggers may have changed.
+    configChanged();
+}
+
+// Output modes.  A logger whose messages are only output by asynchronous
+// appenders can log without taking the locks guarding synchronous output.
+void
+LoggerManagerImpl::setOutputMode(const std::string& name, bool async,
+                                 bool additive)
+{
+    isc::util::thread::Mutex::Locker locker(getOutputModeMutex());
+    const OutputMode mode = { async, additive };
+    getOutputModes()[name] = mode;
+    configChanged();
+}
+
+void
+LoggerManagerImpl::clearOutputModes() {
+    isc::util::thread::Mutex::Locker locker(getOutputModeMutex());
+    getOutputModes().clear();
+    configChanged();
+}
+
+bool
+LoggerManagerImpl::isAsyncOutput(const std::string& name) {
+    isc::util::thread::Mutex::Locker locker(getOutputModeMutex());
+    const OutputModeMap& modes = getOutputModes();
+    std::string current = name;
+    while (true) {
+        // The Kea root logger has no dot in its name.  Its parent, the
+        // log4cplus root logger, does not output anything.
+        const size_t dot = current.rfind('.');
+        const OutputModeMap::const_iterator mode = modes.find(current);
+        if (mode != modes.end()) {
+            if (!mode->second.async_) {
+                return (false);
+            } else if (!mode->second.additive_ || (dot == std::string::npos)) {
+                return (true);
+            }
+        }
+        if (dot == std::string::npos) {
+            // The root logger has synchronous output unless configured
+            // otherwise.
+            return (false);
+        }
+        current.erase(dot);
+    }
 }
 
 void LoggerManagerImpl::setConsoleAppenderLayout(
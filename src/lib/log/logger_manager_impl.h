@@ -17,8 +17,12 @@
 
 #include <string>
 
+#include <stdint.h>
+
 #include <log4cplus/appender.h>
+#include <log/logger.h>
 #include <log/logger_level.h>
+#include <log/logger_specification.h>
 
 // Forward declaration to avoid need to include log4cplus header file here.
 namespace log4cplus {
@@ -29,10 +33,6 @@ class Appender;
 namespace isc {
 namespace log {
 
-// Forward declarations
-class LoggerSpecification;
-struct OutputOption;
-
 /// \brief Logger Manager Implementation
 ///
 /// This is the implementation of the logger manager for the log4cplus
@@ -101,6 +101,35 @@ public:
     static void reset(isc::log::Severity severity = isc::log::INFO,
                       int dbglevel = 0);
 
+    /// \brief Check if the output of a logger is asynchronous
+    ///
+    /// Walks from the logger up its parents and returns true if the
+    /// messages logged to it are only output by asynchronous appenders
+    /// (see \c LoggerSpecification::setAsync()), i.e. the message can be
+    /// logged without the locks guarding the synchronous output.
+    ///
+    /// \param name Expanded name of the logger.
+    static bool isAsyncOutput(const std::string& name);
+
+    /// \brief Get the configuration generation
+    ///
+    /// The generation is incremented each time the severity or the output
+    /// of the loggers is changed, so the loggers can cache their effective
+    /// severity and the result of \c isAsyncOutput() until the generation
+    /// changes.  Checking it is a single load, so it can be done each time
+    /// a message is logged.
+    static uint32_t getConfigGeneration() {
+        return (Logger::config_generation_);
+    }
+
+    /// \brief Increment the configuration generation
+    ///
+    /// Must be called after the severity or the output of a logger has been
+    /// changed.
+    static void configChanged() {
+        __sync_fetch_and_add(&Logger::config_generation_, 1);
+    }
+
 private:
     /// \brief Create console appender
     ///
@@ -142,6 +171,28 @@ private:
     /// \param logger Log4cplus logger to which the appender must be attached.
     static void createBufferAppender(log4cplus::Logger& logger);
 
+    /// \brief Make the output of a logger asynchronous
+    ///
+    /// Moves the appenders of the logger to an asynchronous appender and
+    /// attaches that one to the logger instead.
+    ///
+    /// \param logger Log4cplus logger whose appenders are to be moved.
+    /// \param overflow What to do with the messages when the queue of
+    ///        the asynchronous appender is full.
+    static void createAsyncAppender(log4cplus::Logger& logger,
+                                    OverflowPolicy overflow);
+
+    /// \brief Record the output mode of a logger
+    ///
+    /// \param name Expanded name of the logger.
+    /// \param async true if the logger outputs asynchronously.
+    /// \param additive true if the messages are passed to the parent.
+    static void setOutputMode(const std::string& name, bool async,
+                              bool additive);
+
+    /// \brief Forget the output modes of all loggers
+    static void clearOutputModes();
+
     /// \brief Set default layout and severity for root logger
     ///
     /// Initializes the root logger to Kea defaults - console or buffered
@@ -34,6 +34,15 @@
 namespace isc {
 namespace log {
 
+/// \brief Overflow behavior of an asynchronous logger
+///
+/// Determines what happens to a message logged by an asynchronous logger
+/// when the queue of messages waiting to be output is full.
+typedef enum {
+    OVERFLOW_BLOCK = 0,     ///< Wait until there is room in the queue
+    OVERFLOW_DROP = 1       ///< Drop the message and count it
+} OverflowPolicy;
+
 class LoggerSpecification {
 public:
     typedef std::vector<OutputOption>::iterator         iterator;
@@ -50,7 +59,7 @@ public:
                         isc::log::Severity severity = isc::log::INFO,
                         int dbglevel = 0, bool additive = false) :
         name_(name), severity_(severity), dbglevel_(dbglevel),
-        additive_(additive)
+        additive_(additive), async_(false), overflow_(OVERFLOW_BLOCK)
     {}
 
     /// \brief Set the name of the logger.
@@ -101,6 +110,36 @@ public:
         return additive_;
     }
 
+    /// \brief Set the asynchronous output flag.
+    ///
+    /// The messages logged by an asynchronous logger are queued and output
+    /// by a separate thread, so the thread logging them doesn't wait for
+    /// the output (see \c internal::AsyncAppender).  The flag only
+    /// applies to the output options of this logger.
+    ///
+    /// \param async New value of the asynchronous output flag.
+    void setAsync(bool async) {
+        async_ = async;
+    }
+
+    /// \return Return asynchronous output flag.
+    bool getAsync() const {
+        return async_;
+    }
+
+    /// \brief Set the overflow policy.
+    ///
+    /// \param overflow What to do with a message when the queue of an
+    ///        asynchronous logger is full.
+    void setOverflow(OverflowPolicy overflow) {
+        overflow_ = overflow;
+    }
+
+    /// \return Return overflow policy.
+    OverflowPolicy getOverflow() const {
+        return overflow_;
+    }
+
     /// \brief Add output option.
     ///
     /// \param option Option to add to the list.
@@ -139,6 +178,8 @@ public:
         severity_ = isc::log::INFO;
         dbglevel_ = 0;
         additive_ = false;
+        async_ = false;
+        overflow_ = OVERFLOW_BLOCK;
         options_.clear();
     }
 
@@ -147,6 +188,8 @@ private:
     isc::log::Severity          severity_;      ///< Severity for this logger
     int                         dbglevel_;      ///< Debug level
     bool                        additive_;      ///< Chaining output
+    bool                        async_;         ///< Asynchronous output
+    OverflowPolicy              overflow_;      ///< Asynchronous overflow
     std::vector<OutputOption>   options_;       ///< Logger options
 };
 
@@ -48,4 +48,21 @@
     } else \
         (LOGGER).fatal((MESSAGE))
 
+/// \brief Macro to conveniently test debug output and log it with deferred
+/// formatting
+///
+/// The arguments are stored as they are and the text of the message is
+/// produced when it is output (see \c isc::log::DeferredFormatter).
+#define LOG_DEBUG_DEFERRED(LOGGER, LEVEL, MESSAGE) \
+    if (!(LOGGER).isDebugEnabled((LEVEL))) { \
+    } else \
+        (LOGGER).debugDeferred((LEVEL), (MESSAGE))
+
+/// \brief Macro to conveniently test info output and log it with deferred
+/// formatting
+#define LOG_INFO_DEFERRED(LOGGER, MESSAGE) \
+    if (!(LOGGER).isInfoEnabled()) { \
+    } else \
+        (LOGGER).infoDeferred((MESSAGE))
+
 #endif
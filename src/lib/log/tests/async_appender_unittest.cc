@@ -0,0 +1,313 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "config.h"
+#include <gtest/gtest.h>
+
+#include <log/async_appender_impl.h>
+#include <log/log_messages.h>
+#include <log/logger.h>
+#include <log/logger_manager.h>
+#include <log/logger_manager_impl.h>
+#include <log/logger_name.h>
+#include <log/logger_specification.h>
+#include <log/macros.h>
+#include <log/output_option.h>
+#include <util/threads/thread.h>
+
+#include <log4cplus/loggingmacros.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace isc::log;
+using namespace isc::log::internal;
+using isc::util::thread::Thread;
+
+namespace {
+
+/// \brief Appender recording the messages passed to it
+///
+/// The appender can be closed to hold the output thread in append(),
+/// which lets the tests fill the queue.
+class RecordingAppender : public log4cplus::Appender {
+public:
+    RecordingAppender() : open_(true), entered_(false) {}
+
+    virtual ~RecordingAppender() {
+        destructorImpl();
+    }
+
+    virtual void close() {}
+
+    /// \brief Wait until the output thread is held in append()
+    void waitEntered() {
+        while (!entered_) {
+            usleep(1000);
+        }
+    }
+
+    /// \brief Let the output thread carry on after a delay
+    void openLater() {
+        usleep(100000);
+        open_ = true;
+    }
+
+    std::vector<std::string> messages_;
+    volatile bool open_;
+    volatile bool entered_;
+
+protected:
+    virtual void append(const log4cplus::spi::InternalLoggingEvent& event) {
+        entered_ = true;
+        while (!open_) {
+            usleep(1000);
+        }
+        messages_.push_back(event.getMessage());
+    }
+};
+
+/// \brief Log the numbers from 0 to count - 1
+void
+logNumbers(log4cplus::Logger logger, const int count) {
+    for (int i = 0; i < count; ++i) {
+        LOG4CPLUS_INFO(logger, boost::lexical_cast<std::string>(i));
+    }
+}
+
+class AsyncAppenderTest : public ::testing::Test {
+protected:
+    AsyncAppenderTest() :
+        logger_(log4cplus::Logger::getInstance("async")),
+        recorder_(new RecordingAppender()), recorder_ptr_(recorder_)
+    {
+        logger_.setLogLevel(log4cplus::TRACE_LOG_LEVEL);
+        logger_.setAdditivity(false);
+    }
+
+    ~AsyncAppenderTest() {
+        logger_.removeAllAppenders();
+    }
+
+    /// \brief Attach an asynchronous appender holding the recorder
+    AsyncAppender* attach(OverflowPolicy overflow) {
+        AsyncAppender* async = new AsyncAppender(overflow);
+        async->addAppender(recorder_ptr_);
+        logger_.addAppender(log4cplus::SharedAppenderPtr(async));
+        return (async);
+    }
+
+    log4cplus::Logger logger_;
+    RecordingAppender* recorder_;
+    log4cplus::SharedAppenderPtr recorder_ptr_;
+};
+
+// Check that the messages are output in the order they were logged.
+TEST_F(AsyncAppenderTest, order) {
+    attach(OVERFLOW_BLOCK);
+    for (int i = 0; i < 1000; ++i) {
+        LOG4CPLUS_INFO(logger_, boost::lexical_cast<std::string>(i));
+    }
+    AsyncAppender::flushQueue();
+
+    ASSERT_EQ(1000, recorder_->messages_.size());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(boost::lexical_cast<std::string>(i),
+                  recorder_->messages_[i]);
+    }
+}
+
+// Check that the messages are dropped when the queue is full and that
+// the number of dropped messages is reported.
+TEST_F(AsyncAppenderTest, drop) {
+    AsyncAppender* async = attach(OVERFLOW_DROP);
+    EXPECT_EQ(OVERFLOW_DROP, async->getOverflow());
+
+    // Hold the output thread on the first message, then fill the queue
+    // and log a few more.
+    recorder_->open_ = false;
+    LOG4CPLUS_INFO(logger_, "first");
+    recorder_->waitEntered();
+    for (size_t i = 0; i < AsyncAppender::QUEUE_CAPACITY + 10; ++i) {
+        LOG4CPLUS_INFO(logger_, "queued");
+    }
+    EXPECT_EQ(10, async->getDroppedCount());
+
+    // The warning precedes the next message output.
+    recorder_->open_ = true;
+    AsyncAppender::flushQueue();
+    ASSERT_EQ(AsyncAppender::QUEUE_CAPACITY + 2,
+              recorder_->messages_.size());
+    EXPECT_EQ("first", recorder_->messages_[0]);
+    EXPECT_EQ("LOG_ASYNC_MESSAGES_DROPPED dropped 10 log messages, the "
+              "asynchronous output queue was full",
+              recorder_->messages_[1]);
+    EXPECT_EQ("queued", recorder_->messages_[2]);
+
+    // The drops are reported only once.
+    LOG4CPLUS_INFO(logger_, "last");
+    AsyncAppender::flushQueue();
+    ASSERT_EQ(AsyncAppender::QUEUE_CAPACITY + 3,
+              recorder_->messages_.size());
+    EXPECT_EQ("last", recorder_->messages_[AsyncAppender::QUEUE_CAPACITY + 2]);
+}
+
+// Check that the logging thread waits for room in the full queue.
+TEST_F(AsyncAppenderTest, block) {
+    AsyncAppender* async = attach(OVERFLOW_BLOCK);
+
+    recorder_->open_ = false;
+    LOG4CPLUS_INFO(logger_, "first");
+    recorder_->waitEntered();
+    for (size_t i = 0; i < AsyncAppender::QUEUE_CAPACITY; ++i) {
+        LOG4CPLUS_INFO(logger_, "queued");
+    }
+
+    // The queue is full: this one waits until the output thread is let go.
+    Thread thread(boost::bind(&RecordingAppender::openLater, recorder_));
+    LOG4CPLUS_INFO(logger_, "last");
+    thread.wait();
+
+    AsyncAppender::flushQueue();
+    EXPECT_EQ(0, async->getDroppedCount());
+    ASSERT_EQ(AsyncAppender::QUEUE_CAPACITY + 2,
+              recorder_->messages_.size());
+    EXPECT_EQ("last", recorder_->messages_[AsyncAppender::QUEUE_CAPACITY + 1]);
+}
+
+// Check that closing the appender outputs the queued messages.
+TEST_F(AsyncAppenderTest, close) {
+    AsyncAppender* async = attach(OVERFLOW_BLOCK);
+    for (int i = 0; i < 100; ++i) {
+        LOG4CPLUS_INFO(logger_, "message");
+    }
+    async->close();
+    EXPECT_EQ(100, recorder_->messages_.size());
+}
+
+// Check that the asynchronous specification wraps the appenders of the
+// logger and that the loggers know when their output is asynchronous.
+TEST(AsyncSpecificationTest, processSpecification) {
+    const std::string name = expandLoggerName("asyncspec");
+    const std::string child = name + ".child";
+    EXPECT_FALSE(LoggerManagerImpl::isAsyncOutput(name));
+
+    LoggerSpecification spec("asyncspec");
+    spec.setAsync(true);
+    spec.setOverflow(OVERFLOW_DROP);
+    OutputOption option;
+    option.destination = OutputOption::DEST_CONSOLE;
+    spec.addOutputOption(option);
+    spec.addOutputOption(option);
+
+    const uint32_t generation = LoggerManagerImpl::getConfigGeneration();
+    LoggerManagerImpl::processSpecification(spec);
+    EXPECT_NE(generation, LoggerManagerImpl::getConfigGeneration());
+
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(name);
+    log4cplus::SharedAppenderPtrList appenders = logger.getAllAppenders();
+    ASSERT_EQ(1, appenders.size());
+    AsyncAppender* async = dynamic_cast<AsyncAppender*>(appenders[0].get());
+    ASSERT_TRUE(async != NULL);
+    EXPECT_EQ(OVERFLOW_DROP, async->getOverflow());
+
+    // Not additive: the messages of the logger and its children are only
+    // output asynchronously.
+    EXPECT_TRUE(LoggerManagerImpl::isAsyncOutput(name));
+    EXPECT_TRUE(LoggerManagerImpl::isAsyncOutput(child));
+
+    // A child with synchronous output of its own.
+    LoggerSpecification child_spec("asyncspec.child");
+    child_spec.addOutputOption(option);
+    LoggerManagerImpl::processSpecification(child_spec);
+    EXPECT_FALSE(LoggerManagerImpl::isAsyncOutput(child));
+
+    // Additive: the messages are also output by the synchronous root.
+    spec.setAdditive(true);
+    LoggerManagerImpl::processSpecification(spec);
+    EXPECT_FALSE(LoggerManagerImpl::isAsyncOutput(name));
+
+    LoggerManager::reset();
+    EXPECT_FALSE(LoggerManagerImpl::isAsyncOutput(name));
+}
+
+// Check that the text of the messages logged with deferred formatting
+// is produced when they are output.
+TEST_F(AsyncAppenderTest, deferred) {
+    LoggerSpecification spec("asyncdeferred");
+    spec.setAsync(true);
+    OutputOption option;
+    spec.addOutputOption(option);
+    LoggerManagerImpl::processSpecification(spec);
+
+    // Send the output to the recorder instead of the console.
+    log4cplus::Logger async_logger =
+        log4cplus::Logger::getInstance(expandLoggerName("asyncdeferred"));
+    async_logger.removeAllAppenders();
+    AsyncAppender* async = new AsyncAppender();
+    async->addAppender(recorder_ptr_);
+    async_logger.addAppender(log4cplus::SharedAppenderPtr(async));
+
+    Logger logger("asyncdeferred");
+    LOG_INFO_DEFERRED(logger, LOG_ASYNC_MESSAGES_DROPPED).arg(42);
+    LOG_INFO(logger, LOG_ASYNC_MESSAGES_DROPPED).arg(43);
+    AsyncAppender::flushQueue();
+    ASSERT_EQ(2, recorder_->messages_.size());
+    EXPECT_EQ("LOG_ASYNC_MESSAGES_DROPPED dropped 42 log messages, the "
+              "asynchronous output queue was full", recorder_->messages_[0]);
+    EXPECT_EQ("LOG_ASYNC_MESSAGES_DROPPED dropped 43 log messages, the "
+              "asynchronous output queue was full", recorder_->messages_[1]);
+
+    LoggerManager::reset();
+}
+
+
+// Check that the messages logged while the queue is stopped are output
+// after the queued ones, in order.  This stops the queue for good, so it
+// must be the last test using it.
+TEST_F(AsyncAppenderTest, stop) {
+    attach(OVERFLOW_BLOCK);
+
+    // Hold the output thread on the first message and queue a few more.
+    recorder_->open_ = false;
+    LOG4CPLUS_INFO(logger_, "first");
+    recorder_->waitEntered();
+    for (int i = 0; i < 100; ++i) {
+        LOG4CPLUS_INFO(logger_, "queued");
+    }
+
+    // Keep logging from another thread while the queue is stopped.
+    Thread opener(boost::bind(&RecordingAppender::openLater, recorder_));
+    Thread logging(boost::bind(&logNumbers, logger_, 10000));
+    AsyncAppender::stopQueue();
+    opener.wait();
+    logging.wait();
+
+    ASSERT_EQ(10101, recorder_->messages_.size());
+    EXPECT_EQ("first", recorder_->messages_[0]);
+    EXPECT_EQ("queued", recorder_->messages_[100]);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(boost::lexical_cast<std::string>(i),
+                  recorder_->messages_[101 + i]);
+    }
+}
+
+}
@@ -0,0 +1,175 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "config.h"
+#include <gtest/gtest.h>
+
+#include <log/log_formatter.h>
+#include <log/log_record.h>
+#include <log/logger_level.h>
+#include <log/message_dictionary.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace isc::log;
+using namespace std;
+
+namespace {
+
+// Messages used by the tests.
+const MessageID LOG_RECORD_TEST_ONE = "LOG_RECORD_TEST_ONE";
+const MessageID LOG_RECORD_TEST_THREE = "LOG_RECORD_TEST_THREE";
+const MessageID LOG_RECORD_TEST_REPEAT = "LOG_RECORD_TEST_REPEAT";
+
+class LogRecordTest : public ::testing::Test {
+protected:
+    typedef isc::log::DeferredFormatter<LogRecordTest> Formatter;
+
+    LogRecordTest() {
+        MessageDictionary& dictionary = MessageDictionary::globalDictionary();
+        dictionary.add(LOG_RECORD_TEST_ONE, "one %1 here");
+        dictionary.add(LOG_RECORD_TEST_THREE, "%1, %2 and %3");
+        dictionary.add(LOG_RECORD_TEST_REPEAT, "%1 and %1 again, 100%");
+    }
+
+    /// \brief Returns the text of the record
+    static string format(const LogRecord& record) {
+        string text;
+        record.format(text);
+        return (text);
+    }
+
+public:
+    /// \brief Output function called by the formatter
+    void output(const Severity& severity, const LogRecord& record) {
+        severities_.push_back(severity);
+        outputs_.push_back(format(record));
+    }
+
+    vector<Severity> severities_;
+    vector<string> outputs_;
+};
+
+// Check the output of the integers.
+TEST_F(LogRecordTest, integers) {
+    LogRecord record(LOG_RECORD_TEST_THREE);
+    encodeLogArg(record, -5);
+    encodeLogArg(record, static_cast<uint8_t>('x'));
+    encodeLogArg(record, numeric_limits<int64_t>::min());
+    EXPECT_EQ(3, record.getArgCount());
+    EXPECT_EQ("LOG_RECORD_TEST_THREE -5, x and -9223372036854775808",
+              format(record));
+
+    LogRecord record2(LOG_RECORD_TEST_THREE);
+    encodeLogArg(record2, 0);
+    encodeLogArg(record2, numeric_limits<uint64_t>::max());
+    encodeLogArg(record2, true);
+    EXPECT_EQ("LOG_RECORD_TEST_THREE 0, 18446744073709551615 and 1",
+              format(record2));
+}
+
+// Check the output of the text and the other types.
+TEST_F(LogRecordTest, text) {
+    LogRecord record(LOG_RECORD_TEST_THREE);
+    encodeLogArg(record, "literal");
+    encodeLogArg(record, string("string"));
+    encodeLogArg(record, 2.5);
+    EXPECT_EQ("LOG_RECORD_TEST_THREE literal, string and 2.5",
+              format(record));
+}
+
+// Check the output of the addresses.
+TEST_F(LogRecordTest, addresses) {
+    const uint8_t v4[] = { 192, 0, 2, 1 };
+    const uint8_t v6[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                           0, 0, 0, 0, 0, 0, 0, 1 };
+    LogRecord record(LOG_RECORD_TEST_THREE);
+    record.addAddress(v4, sizeof(v4));
+    record.addAddress(v6, sizeof(v6));
+    record.addInt(1);
+    EXPECT_EQ("LOG_RECORD_TEST_THREE 192.0.2.1, 2001:db8::1 and 1",
+              format(record));
+}
+
+// Check that the text is truncated when the buffer is full.
+TEST_F(LogRecordTest, truncated) {
+    const string long_text(LogRecord::TEXT_SIZE - 10, 'a');
+    LogRecord record(LOG_RECORD_TEST_THREE);
+    encodeLogArg(record, long_text);
+    encodeLogArg(record, "0123456789abcdef");
+    encodeLogArg(record, "more");
+    EXPECT_EQ("LOG_RECORD_TEST_THREE " + long_text + ", 0123456789... and ...",
+              format(record));
+}
+
+// Check that the mismatched placeholders and arguments are reported.
+TEST_F(LogRecordTest, mismatched) {
+    LogRecord missing(LOG_RECORD_TEST_ONE);
+    missing.addInt(1);
+    missing.addInt(2);
+    EXPECT_EQ("LOG_RECORD_TEST_ONE one 1 here @@Missing placeholder %2 "
+              "for '2'@@", format(missing));
+
+    LogRecord excess(LOG_RECORD_TEST_THREE);
+    excess.addInt(1);
+    EXPECT_EQ("LOG_RECORD_TEST_THREE 1, %2 and %3 @@Excess logger "
+              "placeholders still exist@@", format(excess));
+
+    LogRecord too_many(LOG_RECORD_TEST_ONE);
+    for (size_t i = 0; i < LogRecord::MAX_ARGS + 2; ++i) {
+        too_many.addInt(1);
+    }
+    EXPECT_EQ(LogRecord::MAX_ARGS, too_many.getArgCount());
+    const string text = format(too_many);
+    EXPECT_NE(string::npos, text.find("@@Too many arguments, 2 dropped@@"));
+}
+
+// Check that all the occurrences of a placeholder are replaced and that
+// the placeholders in the arguments are not.
+TEST_F(LogRecordTest, placeholders) {
+    LogRecord record(LOG_RECORD_TEST_REPEAT);
+    encodeLogArg(record, "%1");
+    EXPECT_EQ("LOG_RECORD_TEST_REPEAT %1 and %1 again, 100%", format(record));
+}
+
+// Check that the formatter outputs the record when it is destroyed and
+// only if it is active.
+TEST_F(LogRecordTest, formatter) {
+    Formatter();
+    Formatter(INFO, LOG_RECORD_TEST_ONE).arg(1);
+    EXPECT_TRUE(outputs_.empty());
+
+    Formatter(DEBUG, LOG_RECORD_TEST_THREE, this).arg(1).arg("two").arg(3u);
+    ASSERT_EQ(1, outputs_.size());
+    EXPECT_EQ(DEBUG, severities_[0]);
+    EXPECT_EQ("LOG_RECORD_TEST_THREE 1, two and 3", outputs_[0]);
+
+    Formatter(INFO, LOG_RECORD_TEST_ONE, this).arg(1).deactivate();
+    EXPECT_EQ(1, outputs_.size());
+
+    // The copy takes over the output.
+    {
+        Formatter formatter(INFO, LOG_RECORD_TEST_ONE, this);
+        Formatter copy(formatter);
+        copy.arg("copy");
+    }
+    ASSERT_EQ(2, outputs_.size());
+    EXPECT_EQ("LOG_RECORD_TEST_ONE one copy here", outputs_[1]);
+}
+
+}
@@ -30,6 +30,8 @@ TEST(LoggerSpecificationTest, DefaultInitialization) {
     EXPECT_EQ(isc::log::INFO, spec.getSeverity());
     EXPECT_EQ(0, spec.getDbglevel());
     EXPECT_FALSE(spec.getAdditive());
+    EXPECT_FALSE(spec.getAsync());
+    EXPECT_EQ(OVERFLOW_BLOCK, spec.getOverflow());
     EXPECT_EQ(0, spec.optionCount());
 }
 
@@ -60,6 +62,12 @@ TEST(LoggerSpecificationTest, SetGet) {
     spec.setAdditive(true);
     EXPECT_TRUE(spec.getAdditive());
 
+    spec.setAsync(true);
+    EXPECT_TRUE(spec.getAsync());
+
+    spec.setOverflow(OVERFLOW_DROP);
+    EXPECT_EQ(OVERFLOW_DROP, spec.getOverflow());
+
     // Should not affect option count
     EXPECT_EQ(0, spec.optionCount());
 }
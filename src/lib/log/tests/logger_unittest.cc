@@ -20,6 +20,7 @@
 #include <log/logger.h>
 #include <log/logger_manager.h>
 #include <log/logger_name.h>
+#include <log/logger_specification.h>
 #include <log/log_messages.h>
 #include <log/interprocess/interprocess_sync_file.h>
 #include "log/tests/log_test_messages.h"
@@ -354,6 +355,33 @@ TEST_F(LoggerTest, IsDebugEnabledLevel) {
     EXPECT_TRUE(logger.isDebugEnabled(MAX_DEBUG_LEVEL));
 }
 
+// The loggers cache their effective severity.  Check that the cached value
+// follows the changes made by the logger manager.
+
+TEST_F(LoggerTest, IsEnabledAfterProcess) {
+
+    Logger logger("test9");
+    Logger child("test9.child");
+    LoggerManager manager;
+    manager.process(LoggerSpecification("test9", isc::log::INFO));
+    EXPECT_FALSE(child.isDebugEnabled());
+    EXPECT_TRUE(child.isInfoEnabled());
+
+    manager.process(LoggerSpecification("test9", isc::log::DEBUG, 20));
+    EXPECT_TRUE(child.isDebugEnabled(20));
+    EXPECT_FALSE(child.isDebugEnabled(21));
+    EXPECT_TRUE(logger.isDebugEnabled(20));
+
+    manager.process(LoggerSpecification("test9.child", isc::log::ERROR));
+    EXPECT_FALSE(child.isWarnEnabled());
+    EXPECT_TRUE(child.isErrorEnabled());
+    EXPECT_FALSE(logger.isDebugEnabled(MAX_DEBUG_LEVEL));
+
+    LoggerManager::reset();
+    EXPECT_EQ(child.getEffectiveSeverity() <= isc::log::WARN,
+              child.isWarnEnabled());
+}
+
 // Check that loggers with invalid names give an error.
 
 TEST_F(LoggerTest, LoggerNameLength) {
@@ -0,0 +1,66 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <stats/counter.h>
+#include <cstring>
+
+namespace {
+
+/// @brief Index of the shard assigned to the thread, increased by one.
+///
+/// The value of 0 indicates that the shard hasn't been assigned yet.
+__thread size_t thread_shard = 0;
+
+/// @brief Number of shard indexes assigned so far.
+size_t assigned_shards = 0;
+
+}
+
+namespace isc {
+namespace stats {
+
+size_t
+getThreadShard() {
+    if (thread_shard == 0) {
+        thread_shard = (__sync_fetch_and_add(&assigned_shards, 1) %
+                        Counter::SHARDS_NUM) + 1;
+    }
+    return (thread_shard - 1);
+}
+
+const size_t Counter::SHARDS_NUM;
+
+Counter::Counter(const std::string& name)
+    : name_(name) {
+    memset(shards_, 0, sizeof(shards_));
+}
+
+uint64_t
+Counter::get() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < SHARDS_NUM; ++i) {
+        total += shards_[i].value_;
+    }
+    return (total);
+}
+
+void
+Counter::reset() {
+    for (size_t i = 0; i < SHARDS_NUM; ++i) {
+        __sync_lock_test_and_set(&shards_[i].value_, 0);
+    }
+}
+
+} // end of namespace isc::stats
+} // end of namespace isc
@@ -0,0 +1,114 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef STATS_COUNTER_H
+#define STATS_COUNTER_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <string>
+
+namespace isc {
+namespace stats {
+
+/// @brief Size of the cache line assumed by the statistics containers.
+///
+/// The shards of the counters are padded to this size to make sure that
+/// the increments made by different threads do not invalidate each other's
+/// cache lines (false sharing).
+const size_t STATS_CACHE_LINE_SIZE = 64;
+
+/// @brief Returns the index of the shard to be used by the calling thread.
+///
+/// Each thread is assigned the shard index upon the first call to this
+/// function. Indexes are assigned in a round robin fashion so that up
+/// to @c Counter::SHARDS_NUM threads use distinct shards.
+///
+/// @return Shard index in the range of 0 .. @c Counter::SHARDS_NUM - 1.
+size_t getThreadShard();
+
+/// @brief Lock-free, sharded monotonic counter.
+///
+/// The counter is split into a number of shards, each occupying its own
+/// cache line. A thread incrementing the counter always updates the shard
+/// assigned to it (see @c getThreadShard), so concurrent increments from
+/// different threads do not contend on the same memory location. As a
+/// result, the cost of an increment is a single atomic add on a cache line
+/// which is typically owned by the calling thread, i.e. a few nanoseconds.
+///
+/// The value of the counter is calculated by summing up all shards. The
+/// read is not atomic with respect to the concurrent increments, which is
+/// acceptable for the statistics purposes: the returned value is the value
+/// of the counter at some point between the beginning and the end of the
+/// @c Counter::get call.
+class Counter : public boost::noncopyable {
+public:
+
+    /// @brief Number of shards per counter.
+    static const size_t SHARDS_NUM = 16;
+
+    /// @brief Constructor.
+    ///
+    /// @param name Name of the counter, e.g. "pkt4-received".
+    Counter(const std::string& name);
+
+    /// @brief Returns the name of the counter.
+    const std::string& getName() const {
+        return (name_);
+    }
+
+    /// @brief Increments the counter by one.
+    void inc() {
+        add(1);
+    }
+
+    /// @brief Increments the counter by the specified value.
+    ///
+    /// @param value Value to be added to the counter.
+    void add(const uint64_t value) {
+        __sync_fetch_and_add(&shards_[getThreadShard()].value_, value);
+    }
+
+    /// @brief Returns the current value of the counter.
+    uint64_t get() const;
+
+    /// @brief Sets the counter to zero.
+    void reset();
+
+private:
+
+    /// @brief Single shard of the counter padded to the cache line size.
+    struct Shard {
+        /// @brief Value held by the shard.
+        volatile uint64_t value_;
+        /// @brief Padding.
+        char pad_[STATS_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    };
+
+    /// @brief Name of the counter.
+    std::string name_;
+
+    /// @brief Shards of the counter.
+    Shard shards_[SHARDS_NUM];
+
+};
+
+/// @brief Pointer to the @c Counter.
+typedef boost::shared_ptr<Counter> CounterPtr;
+
+} // end of namespace isc::stats
+} // end of namespace isc
+
+#endif // STATS_COUNTER_H
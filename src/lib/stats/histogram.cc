@@ -0,0 +1,155 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include <stats/histogram.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/// @brief Value of the minimum when there are no samples.
+const uint64_t NO_MIN = std::numeric_limits<uint64_t>::max();
+
+}
+
+namespace isc {
+namespace stats {
+
+const size_t Histogram::BUCKETS_NUM;
+
+Histogram::Histogram(const std::string& name)
+    : name_(name), count_(0), sum_(0), min_(NO_MIN), max_(0) {
+    memset(const_cast<uint64_t*>(buckets_), 0, sizeof(buckets_));
+}
+
+size_t
+Histogram::getBucketIndex(const uint64_t value) {
+    if (value == 0) {
+        return (0);
+    }
+    // Number of significant bits is the index of the bucket.
+    const size_t index = 64 - __builtin_clzll(value);
+    return (index < BUCKETS_NUM ? index : BUCKETS_NUM - 1);
+}
+
+uint64_t
+Histogram::getBucketUpperBound(const size_t index) {
+    if (index >= BUCKETS_NUM) {
+        isc_throw(OutOfRange, "histogram bucket index " << index
+                  << " is out of range");
+    } else if (index == BUCKETS_NUM - 1) {
+        return (std::numeric_limits<uint64_t>::max());
+    }
+    return (static_cast<uint64_t>(1) << index);
+}
+
+void
+Histogram::record(const uint64_t value) {
+    __sync_fetch_and_add(&buckets_[getBucketIndex(value)], 1);
+    __sync_fetch_and_add(&count_, 1);
+    __sync_fetch_and_add(&sum_, value);
+
+    // The extremes are rarely updated once the histogram has warmed up,
+    // so the compare-and-swap loops are almost never entered.
+    uint64_t current = min_;
+    while (value < current) {
+        const uint64_t prev = __sync_val_compare_and_swap(&min_, current,
+                                                          value);
+        if (prev == current) {
+            break;
+        }
+        current = prev;
+    }
+    current = max_;
+    while (value > current) {
+        const uint64_t prev = __sync_val_compare_and_swap(&max_, current,
+                                                          value);
+        if (prev == current) {
+            break;
+        }
+        current = prev;
+    }
+}
+
+uint64_t
+Histogram::getBucketCount(const size_t index) const {
+    if (index >= BUCKETS_NUM) {
+        isc_throw(OutOfRange, "histogram bucket index " << index
+                  << " is out of range");
+    }
+    return (buckets_[index]);
+}
+
+uint64_t
+Histogram::getMin() const {
+    const uint64_t min = min_;
+    return (min == NO_MIN ? 0 : min);
+}
+
+uint64_t
+Histogram::getPercentile(const double percentile) const {
+    if ((percentile <= 0) || (percentile > 100)) {
+        isc_throw(OutOfRange, "percentile " << percentile
+                  << " is out of range (0, 100]");
+    }
+
+    // Take a snapshot of the buckets to have the consistent total.
+    uint64_t snapshot[BUCKETS_NUM];
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS_NUM; ++i) {
+        snapshot[i] = buckets_[i];
+        total += snapshot[i];
+    }
+    if (total == 0) {
+        return (0);
+    }
+
+    // Number of samples which must be lower or equal to the percentile,
+    // rounded up so that e.g. the 99th percentile of 10 samples is the
+    // largest one.
+    uint64_t rank =
+        static_cast<uint64_t>(std::ceil(percentile * total / 100));
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS_NUM; ++i) {
+        seen += snapshot[i];
+        if (seen >= rank) {
+            const uint64_t bound = (i == 0 ? 0 : getBucketUpperBound(i) - 1);
+            const uint64_t max = max_;
+            return (bound < max ? bound : max);
+        }
+    }
+    return (max_);
+}
+
+void
+Histogram::reset() {
+    for (size_t i = 0; i < BUCKETS_NUM; ++i) {
+        __sync_lock_test_and_set(&buckets_[i], 0);
+    }
+    __sync_lock_test_and_set(&count_, 0);
+    __sync_lock_test_and_set(&sum_, 0);
+    __sync_lock_test_and_set(&min_, NO_MIN);
+    __sync_lock_test_and_set(&max_, 0);
+}
+
+} // end of namespace isc::stats
+} // end of namespace isc
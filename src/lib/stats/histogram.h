@@ -0,0 +1,175 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef STATS_HISTOGRAM_H
+#define STATS_HISTOGRAM_H
+
+#include <util/monotonic_clock.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <string>
+
+namespace isc {
+namespace stats {
+
+/// @brief Lock-free latency histogram with fixed, power of two buckets.
+///
+/// The histogram holds the number of recorded samples (durations expressed
+/// in nanoseconds) in the fixed set of buckets. The bucket 0 holds samples
+/// equal to 0. The bucket N (N > 0) holds samples in the range of
+/// [2^(N-1), 2^N). The last bucket also holds all samples which exceed its
+/// lower bound. Recording a sample doesn't allocate memory and doesn't
+/// take any locks: it is a couple of atomic operations on the bucket and
+/// the aggregates (count, sum, min, max).
+///
+/// The power of two buckets guarantee that the relative error of the
+/// percentiles reported by the @c Histogram::getPercentile is at most 2x,
+/// which is sufficient to tell whether a processing stage takes
+/// nanoseconds, microseconds or milliseconds.
+class Histogram : public boost::noncopyable {
+public:
+
+    /// @brief Number of buckets.
+    ///
+    /// The last bucket starts at 2^46ns which is roughly 19 hours.
+    static const size_t BUCKETS_NUM = 48;
+
+    /// @brief Constructor.
+    ///
+    /// @param name Name of the histogram, e.g. "pkt4-pack-latency".
+    Histogram(const std::string& name);
+
+    /// @brief Returns the name of the histogram.
+    const std::string& getName() const {
+        return (name_);
+    }
+
+    /// @brief Records a sample.
+    ///
+    /// @param value Sample value (duration in nanoseconds).
+    void record(const uint64_t value);
+
+    /// @brief Returns the index of the bucket for the specified value.
+    ///
+    /// @param value Sample value.
+    static size_t getBucketIndex(const uint64_t value);
+
+    /// @brief Returns the upper bound (exclusive) of the specified bucket.
+    ///
+    /// @param index Bucket index.
+    ///
+    /// @throw isc::OutOfRange if the index is out of range.
+    static uint64_t getBucketUpperBound(const size_t index);
+
+    /// @brief Returns the number of samples in the specified bucket.
+    ///
+    /// @param index Bucket index.
+    ///
+    /// @throw isc::OutOfRange if the index is out of range.
+    uint64_t getBucketCount(const size_t index) const;
+
+    /// @brief Returns the total number of recorded samples.
+    uint64_t getCount() const {
+        return (count_);
+    }
+
+    /// @brief Returns the sum of all recorded samples.
+    uint64_t getSum() const {
+        return (sum_);
+    }
+
+    /// @brief Returns the lowest recorded sample or 0 if there are none.
+    uint64_t getMin() const;
+
+    /// @brief Returns the highest recorded sample.
+    uint64_t getMax() const {
+        return (max_);
+    }
+
+    /// @brief Returns the approximate value of the specified percentile.
+    ///
+    /// The returned value is the upper bound of the bucket in which the
+    /// percentile falls, but not greater than the highest recorded sample.
+    ///
+    /// @param percentile Percentile in the range of (0, 100].
+    ///
+    /// @throw isc::OutOfRange if the percentile is out of range.
+    /// @return Percentile value or 0 if there are no samples.
+    uint64_t getPercentile(const double percentile) const;
+
+    /// @brief Removes all samples from the histogram.
+    void reset();
+
+private:
+
+    /// @brief Name of the histogram.
+    std::string name_;
+
+    /// @brief Number of samples in each bucket.
+    volatile uint64_t buckets_[BUCKETS_NUM];
+
+    /// @brief Number of samples.
+    volatile uint64_t count_;
+
+    /// @brief Sum of samples.
+    volatile uint64_t sum_;
+
+    /// @brief Lowest sample or the maximum uint64_t value if none.
+    volatile uint64_t min_;
+
+    /// @brief Highest sample.
+    volatile uint64_t max_;
+
+};
+
+/// @brief Pointer to the @c Histogram.
+typedef boost::shared_ptr<Histogram> HistogramPtr;
+
+/// @brief Measures the duration of a scope and records it in the histogram.
+///
+/// The object of this class takes the monotonic clock value when it is
+/// constructed and records the time elapsed since then in the histogram
+/// when it is destroyed. This guarantees that the duration is recorded
+/// regardless of the way the scope is left (return, exception).
+class ScopedLatency : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param histogram Histogram in which the duration is recorded.
+    ScopedLatency(Histogram& histogram)
+        : histogram_(histogram), start_(isc::util::getMonotonicNanos()) {
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Records the duration of the scope.
+    ~ScopedLatency() {
+        histogram_.record(isc::util::getMonotonicNanos() - start_);
+    }
+
+private:
+
+    /// @brief Histogram in which the duration is recorded.
+    Histogram& histogram_;
+
+    /// @brief Monotonic clock value when the object was created.
+    uint64_t start_;
+};
+
+} // end of namespace isc::stats
+} // end of namespace isc
+
+#endif // STATS_HISTOGRAM_H
@@ -0,0 +1,146 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <stats/stats_mgr.h>
+#include <limits>
+
+using namespace isc::data;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Converts the unsigned statistics value to the data element.
+///
+/// The values exceeding the range of the signed integer held by the
+/// element are saturated.
+///
+/// @param value Value to be converted.
+ElementPtr
+createValue(const uint64_t value) {
+    const uint64_t max =
+        static_cast<uint64_t>(std::numeric_limits<long long int>::max());
+    return (Element::create(static_cast<long long int>(value < max ?
+                                                       value : max)));
+}
+
+}
+
+namespace isc {
+namespace stats {
+
+StatsMgr::StatsMgr()
+    : counters_(), histograms_(), mutex_() {
+}
+
+StatsMgr&
+StatsMgr::instance() {
+    static StatsMgr stats_mgr;
+    return (stats_mgr);
+}
+
+Counter&
+StatsMgr::getCounter(const std::string& name) {
+    Mutex::Locker lock(mutex_);
+    CounterMap::const_iterator it = counters_.find(name);
+    if (it != counters_.end()) {
+        return (*it->second);
+    }
+    CounterPtr counter(new Counter(name));
+    counters_[name] = counter;
+    return (*counter);
+}
+
+Histogram&
+StatsMgr::getHistogram(const std::string& name) {
+    Mutex::Locker lock(mutex_);
+    HistogramMap::const_iterator it = histograms_.find(name);
+    if (it != histograms_.end()) {
+        return (*it->second);
+    }
+    HistogramPtr histogram(new Histogram(name));
+    histograms_[name] = histogram;
+    return (*histogram);
+}
+
+bool
+StatsMgr::hasCounter(const std::string& name) const {
+    Mutex::Locker lock(mutex_);
+    return (counters_.count(name) > 0);
+}
+
+bool
+StatsMgr::hasHistogram(const std::string& name) const {
+    Mutex::Locker lock(mutex_);
+    return (histograms_.count(name) > 0);
+}
+
+ElementPtr
+StatsMgr::toElement() const {
+    Mutex::Locker lock(mutex_);
+
+    ElementPtr counters = Element::createMap();
+    for (CounterMap::const_iterator it = counters_.begin();
+         it != counters_.end(); ++it) {
+        counters->set(it->first, createValue(it->second->get()));
+    }
+
+    ElementPtr histograms = Element::createMap();
+    for (HistogramMap::const_iterator it = histograms_.begin();
+         it != histograms_.end(); ++it) {
+        const Histogram& histogram = *it->second;
+        ElementPtr entry = Element::createMap();
+        entry->set("count", createValue(histogram.getCount()));
+        entry->set("sum-ns", createValue(histogram.getSum()));
+        entry->set("min-ns", createValue(histogram.getMin()));
+        entry->set("max-ns", createValue(histogram.getMax()));
+        entry->set("p50-ns", createValue(histogram.getPercentile(50)));
+        entry->set("p95-ns", createValue(histogram.getPercentile(95)));
+        entry->set("p99-ns", createValue(histogram.getPercentile(99)));
+        entry->set("p99.9-ns", createValue(histogram.getPercentile(99.9)));
+
+        ElementPtr buckets = Element::createList();
+        for (size_t i = 0; i < Histogram::BUCKETS_NUM; ++i) {
+            const uint64_t count = histogram.getBucketCount(i);
+            if (count > 0) {
+                ElementPtr bucket = Element::createList();
+                bucket->add(createValue(Histogram::getBucketUpperBound(i)));
+                bucket->add(createValue(count));
+                buckets->add(bucket);
+            }
+        }
+        entry->set("buckets", buckets);
+        histograms->set(it->first, entry);
+    }
+
+    ElementPtr stats = Element::createMap();
+    stats->set("counters", counters);
+    stats->set("histograms", histograms);
+    return (stats);
+}
+
+void
+StatsMgr::resetAll() {
+    Mutex::Locker lock(mutex_);
+    for (CounterMap::const_iterator it = counters_.begin();
+         it != counters_.end(); ++it) {
+        it->second->reset();
+    }
+    for (HistogramMap::const_iterator it = histograms_.begin();
+         it != histograms_.end(); ++it) {
+        it->second->reset();
+    }
+}
+
+} // end of namespace isc::stats
+} // end of namespace isc
@@ -0,0 +1,121 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef STATS_MGR_H
+#define STATS_MGR_H
+
+#include <cc/data.h>
+#include <stats/counter.h>
+#include <stats/histogram.h>
+#include <util/threads/sync.h>
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <string>
+
+namespace isc {
+namespace stats {
+
+/// @brief Registry of the server side statistics.
+///
+/// The statistics manager is a singleton holding all counters and latency
+/// histograms maintained by the server. The statistics are identified by
+/// names. The names of the counters and the histograms must be unique within
+/// their own kinds, i.e. a counter and a histogram may have the same name
+/// but it is not recommended.
+///
+/// The server code is expected to obtain references to the counters and
+/// histograms it uses once (typically at startup) and use these references
+/// on the packet processing path, so as the costly lookup by name is not
+/// performed for each packet. The statistics objects are never removed
+/// from the manager, thus the references remain valid until the process
+/// terminates.
+///
+/// The registration of the statistics and dumping them are protected by
+/// the mutex, so they may be used from multiple threads. Updates of the
+/// counters and histograms don't require any locking.
+class StatsMgr : public boost::noncopyable {
+public:
+
+    /// @brief Returns the sole instance of the statistics manager.
+    static StatsMgr& instance();
+
+    /// @brief Returns the counter of the specified name.
+    ///
+    /// The counter is created if it doesn't exist.
+    ///
+    /// @param name Name of the counter.
+    /// @return Reference to the counter, valid until the process terminates.
+    Counter& getCounter(const std::string& name);
+
+    /// @brief Returns the histogram of the specified name.
+    ///
+    /// The histogram is created if it doesn't exist.
+    ///
+    /// @param name Name of the histogram.
+    /// @return Reference to the histogram, valid until the process terminates.
+    Histogram& getHistogram(const std::string& name);
+
+    /// @brief Checks if the counter of the specified name exists.
+    ///
+    /// @param name Name of the counter.
+    bool hasCounter(const std::string& name) const;
+
+    /// @brief Checks if the histogram of the specified name exists.
+    ///
+    /// @param name Name of the histogram.
+    bool hasHistogram(const std::string& name) const;
+
+    /// @brief Returns all statistics in the form of the data element.
+    ///
+    /// The returned element is a map with two entries: "counters" and
+    /// "histograms". The former is a map of counter names and their values.
+    /// The latter is a map of histogram names and maps holding the number of
+    /// samples ("count"), their sum, minimum and maximum ("sum-ns", "min-ns",
+    /// "max-ns"), selected percentiles ("p50-ns", "p95-ns", "p99-ns",
+    /// "p99.9-ns") and the list of non-empty buckets ("buckets"). Each bucket
+    /// is represented by a list holding the exclusive upper bound of the
+    /// bucket in nanoseconds and the number of samples in this bucket.
+    isc::data::ElementPtr toElement() const;
+
+    /// @brief Resets all counters and histograms.
+    void resetAll();
+
+private:
+
+    /// @brief Private constructor.
+    ///
+    /// The instance is created with the @c StatsMgr::instance.
+    StatsMgr();
+
+    /// @brief Type of the container holding counters.
+    typedef std::map<std::string, CounterPtr> CounterMap;
+
+    /// @brief Type of the container holding histograms.
+    typedef std::map<std::string, HistogramPtr> HistogramMap;
+
+    /// @brief Counters.
+    CounterMap counters_;
+
+    /// @brief Histograms.
+    HistogramMap histograms_;
+
+    /// @brief Mutex protecting the containers.
+    mutable isc::util::thread::Mutex mutex_;
+
+};
+
+} // end of namespace isc::stats
+} // end of namespace isc
+
+#endif // STATS_MGR_H
@@ -0,0 +1,88 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <stats/counter.h>
+#include <util/threads/thread.h>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace isc;
+using namespace isc::stats;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Increments the counter specified number of times.
+///
+/// @param counter Counter to be incremented.
+/// @param count Number of increments.
+void
+incrementCounter(Counter* counter, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        counter->inc();
+    }
+}
+
+// This test verifies that the counter is initialized to zero and can
+// be incremented and reset.
+TEST(CounterTest, incrementAndReset) {
+    Counter counter("pkt4-received");
+    EXPECT_EQ("pkt4-received", counter.getName());
+    EXPECT_EQ(0, counter.get());
+
+    counter.inc();
+    EXPECT_EQ(1, counter.get());
+
+    counter.add(10);
+    EXPECT_EQ(11, counter.get());
+
+    counter.reset();
+    EXPECT_EQ(0, counter.get());
+
+    counter.inc();
+    EXPECT_EQ(1, counter.get());
+}
+
+// This test verifies that the shard index assigned to the thread is
+// in range and doesn't change.
+TEST(CounterTest, threadShard) {
+    const size_t shard = getThreadShard();
+    EXPECT_LT(shard, Counter::SHARDS_NUM);
+    EXPECT_EQ(shard, getThreadShard());
+}
+
+// This test verifies that the increments made concurrently by multiple
+// threads are not lost.
+TEST(CounterTest, concurrentIncrements) {
+    Counter counter("concurrent");
+    const size_t threads_num = Counter::SHARDS_NUM + 4;
+    const size_t increments = 10000;
+
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (size_t i = 0; i < threads_num; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>
+                          (new Thread(boost::bind(&incrementCounter, &counter,
+                                                  increments))));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->wait();
+    }
+
+    EXPECT_EQ(threads_num * increments, counter.get());
+}
+
+} // end of anonymous namespace
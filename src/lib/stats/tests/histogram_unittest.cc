@@ -0,0 +1,132 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <exceptions/exceptions.h>
+#include <stats/histogram.h>
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace isc;
+using namespace isc::stats;
+
+namespace {
+
+// This test verifies that the samples are assigned to the correct buckets.
+TEST(HistogramTest, bucketIndex) {
+    EXPECT_EQ(0, Histogram::getBucketIndex(0));
+    EXPECT_EQ(1, Histogram::getBucketIndex(1));
+    EXPECT_EQ(2, Histogram::getBucketIndex(2));
+    EXPECT_EQ(2, Histogram::getBucketIndex(3));
+    EXPECT_EQ(3, Histogram::getBucketIndex(4));
+    EXPECT_EQ(10, Histogram::getBucketIndex(1000));
+    EXPECT_EQ(Histogram::BUCKETS_NUM - 1,
+              Histogram::getBucketIndex(std::numeric_limits<uint64_t>::max()));
+}
+
+// This test verifies that the upper bounds of the buckets are correct.
+TEST(HistogramTest, bucketUpperBound) {
+    EXPECT_EQ(1, Histogram::getBucketUpperBound(0));
+    EXPECT_EQ(2, Histogram::getBucketUpperBound(1));
+    EXPECT_EQ(1024, Histogram::getBucketUpperBound(10));
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+              Histogram::getBucketUpperBound(Histogram::BUCKETS_NUM - 1));
+    EXPECT_THROW(Histogram::getBucketUpperBound(Histogram::BUCKETS_NUM),
+                 isc::OutOfRange);
+}
+
+// This test verifies that the recorded samples are reflected in the
+// aggregates and the buckets.
+TEST(HistogramTest, record) {
+    Histogram histogram("pkt4-pack-latency");
+    EXPECT_EQ("pkt4-pack-latency", histogram.getName());
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getMin());
+    EXPECT_EQ(0, histogram.getMax());
+    EXPECT_EQ(0, histogram.getPercentile(50));
+
+    histogram.record(1000);
+    histogram.record(3);
+    histogram.record(2000);
+
+    EXPECT_EQ(3, histogram.getCount());
+    EXPECT_EQ(3003, histogram.getSum());
+    EXPECT_EQ(3, histogram.getMin());
+    EXPECT_EQ(2000, histogram.getMax());
+    EXPECT_EQ(1, histogram.getBucketCount(2));
+    EXPECT_EQ(1, histogram.getBucketCount(10));
+    EXPECT_EQ(1, histogram.getBucketCount(11));
+    EXPECT_THROW(histogram.getBucketCount(Histogram::BUCKETS_NUM),
+                 isc::OutOfRange);
+
+    histogram.reset();
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getSum());
+    EXPECT_EQ(0, histogram.getMin());
+    EXPECT_EQ(0, histogram.getMax());
+    EXPECT_EQ(0, histogram.getBucketCount(10));
+}
+
+// This test verifies that the percentiles are reported with the
+// precision of the bucket.
+TEST(HistogramTest, percentile) {
+    Histogram histogram("latency");
+    // 90 samples of 100ns and 10 samples of 10000ns.
+    for (int i = 0; i < 90; ++i) {
+        histogram.record(100);
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.record(10000);
+    }
+
+    // 100 falls in the bucket [64, 128).
+    EXPECT_EQ(127, histogram.getPercentile(50));
+    EXPECT_EQ(127, histogram.getPercentile(90));
+    // The upper bound of the [8192, 16384) bucket is capped by the maximum.
+    EXPECT_EQ(10000, histogram.getPercentile(95));
+    EXPECT_EQ(10000, histogram.getPercentile(100));
+
+    EXPECT_THROW(histogram.getPercentile(0), isc::OutOfRange);
+    EXPECT_THROW(histogram.getPercentile(100.1), isc::OutOfRange);
+}
+
+// This test verifies that the rank of a percentile is rounded up, so that
+// high percentiles of small samples are not reported a bucket too low.
+TEST(HistogramTest, percentileRank) {
+    Histogram histogram("latency");
+    // 9 samples of 100ns and 1 sample of 10000ns.
+    for (int i = 0; i < 9; ++i) {
+        histogram.record(100);
+    }
+    histogram.record(10000);
+
+    // The 90th percentile is the 9th sample, the 99th one the 10th.
+    EXPECT_EQ(127, histogram.getPercentile(90));
+    EXPECT_EQ(10000, histogram.getPercentile(99));
+    // Any percentile is at least the smallest sample.
+    EXPECT_EQ(127, histogram.getPercentile(0.1));
+}
+
+// This test verifies that the ScopedLatency records the duration in the
+// histogram when it goes out of scope.
+TEST(HistogramTest, scopedLatency) {
+    Histogram histogram("scope");
+    {
+        ScopedLatency timer(histogram);
+        EXPECT_EQ(0, histogram.getCount());
+    }
+    EXPECT_EQ(1, histogram.getCount());
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,96 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <stats/stats_mgr.h>
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Test fixture class for testing the @c StatsMgr.
+class StatsMgrTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Resets all statistics.
+    StatsMgrTest() {
+        StatsMgr::instance().resetAll();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Resets all statistics.
+    virtual ~StatsMgrTest() {
+        StatsMgr::instance().resetAll();
+    }
+};
+
+// This test verifies that the counters and histograms are created on the
+// first use and subsequent calls return the same objects.
+TEST_F(StatsMgrTest, getStatistics) {
+    StatsMgr& mgr = StatsMgr::instance();
+    EXPECT_FALSE(mgr.hasCounter("test-counter"));
+    Counter& counter = mgr.getCounter("test-counter");
+    EXPECT_TRUE(mgr.hasCounter("test-counter"));
+    EXPECT_EQ(&counter, &mgr.getCounter("test-counter"));
+    EXPECT_NE(&counter, &mgr.getCounter("test-counter-2"));
+
+    EXPECT_FALSE(mgr.hasHistogram("test-histogram"));
+    Histogram& histogram = mgr.getHistogram("test-histogram");
+    EXPECT_TRUE(mgr.hasHistogram("test-histogram"));
+    EXPECT_EQ(&histogram, &mgr.getHistogram("test-histogram"));
+}
+
+// This test verifies that the statistics are correctly converted to
+// the data element and can be reset.
+TEST_F(StatsMgrTest, toElementAndReset) {
+    StatsMgr& mgr = StatsMgr::instance();
+    mgr.getCounter("dump-counter").add(5);
+    mgr.getHistogram("dump-histogram").record(100);
+    mgr.getHistogram("dump-histogram").record(100);
+
+    ConstElementPtr stats = mgr.toElement();
+    ASSERT_TRUE(stats);
+    ConstElementPtr counters = stats->get("counters");
+    ASSERT_TRUE(counters);
+    ASSERT_TRUE(counters->get("dump-counter"));
+    EXPECT_EQ(5, counters->get("dump-counter")->intValue());
+
+    ConstElementPtr histograms = stats->get("histograms");
+    ASSERT_TRUE(histograms);
+    ConstElementPtr histogram = histograms->get("dump-histogram");
+    ASSERT_TRUE(histogram);
+    EXPECT_EQ(2, histogram->get("count")->intValue());
+    EXPECT_EQ(200, histogram->get("sum-ns")->intValue());
+    EXPECT_EQ(100, histogram->get("min-ns")->intValue());
+    EXPECT_EQ(100, histogram->get("max-ns")->intValue());
+    EXPECT_EQ(100, histogram->get("p99-ns")->intValue());
+    ConstElementPtr buckets = histogram->get("buckets");
+    ASSERT_TRUE(buckets);
+    ASSERT_EQ(1, buckets->size());
+    EXPECT_EQ("[ 128, 2 ]", buckets->get(0)->str());
+
+    mgr.resetAll();
+    stats = mgr.toElement();
+    EXPECT_EQ(0, stats->get("counters")->get("dump-counter")->intValue());
+    EXPECT_EQ(0, stats->get("histograms")->get("dump-histogram")->
+              get("count")->intValue());
+}
+
+} // end of anonymous namespace
@@ -16,6 +16,7 @@
 #define BUFFER_H 1
 
 #include <stdlib.h>
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -307,6 +308,8 @@ public:
     //@{
     /// \brief Constructor from the initial size of the buffer.
     ///
+    /// Nothing is allocated if the length is 0.
+    ///
     /// \param len The initial length of the buffer in bytes.
     OutputBuffer(size_t len) :
         buffer_(NULL),
@@ -315,9 +318,11 @@ public:
     {
         // We use malloc and free instead of C++ new[] and delete[].
         // This way we can use realloc, which may in fact do it without a copy.
-        buffer_ = static_cast<uint8_t*>(malloc(allocated_));
-        if (buffer_ == NULL && len != 0) {
-            throw std::bad_alloc();
+        if (allocated_ != 0) {
+            buffer_ = static_cast<uint8_t*>(malloc(allocated_));
+            if (buffer_ == NULL) {
+                throw std::bad_alloc();
+            }
         }
     }
 
@@ -327,11 +332,13 @@ public:
         size_(other.size_),
         allocated_(other.allocated_)
     {
-        buffer_ = static_cast<uint8_t*>(malloc(allocated_));
-        if (buffer_ == NULL && allocated_ != 0) {
-            throw std::bad_alloc();
+        if (allocated_ != 0) {
+            buffer_ = static_cast<uint8_t*>(malloc(allocated_));
+            if (buffer_ == NULL) {
+                throw std::bad_alloc();
+            }
+            std::memcpy(buffer_, other.buffer_, size_);
         }
-        std::memcpy(buffer_, other.buffer_, size_);
     }
 
     /// \brief Destructor
@@ -419,6 +426,35 @@ public:
     /// This method can be used to re-initialize and reuse the buffer without
     /// constructing a new one. Note it must keep current content.
     void clear() { size_ = 0; }
+    /// \brief Make sure the buffer can hold the specified length of data.
+    ///
+    /// If the capacity of the buffer is smaller than \c len, the buffer
+    /// is extended to exactly \c len bytes, so the data of this length can
+    /// then be written without reallocation.  The data in the buffer is
+    /// kept.  This method never shrinks the buffer.
+    ///
+    /// \param len The minimal capacity of the buffer in bytes.
+    void reserve(size_t len) {
+        if (allocated_ < len) {
+            uint8_t* new_buffer(static_cast<uint8_t*>(realloc(buffer_, len)));
+            if (new_buffer == NULL) {
+                throw std::bad_alloc();
+            }
+            buffer_ = new_buffer;
+            allocated_ = len;
+        }
+    }
+    /// \brief Exchange the content of two buffers.
+    ///
+    /// The storage of the buffers is exchanged along with the data, so
+    /// this method neither allocates nor copies data.  It never throws.
+    ///
+    /// \param other The buffer to exchange the content with.
+    void swap(OutputBuffer& other) {
+        std::swap(buffer_, other.buffer_);
+        std::swap(size_, other.size_);
+        std::swap(allocated_, other.allocated_);
+    }
     /// \brief Wipe buffer content.
     ///
     /// This method is the destructive alternative to clear().
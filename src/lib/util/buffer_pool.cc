@@ -0,0 +1,124 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <util/buffer_pool.h>
+
+#include <vector>
+
+#include <pthread.h>
+
+namespace {
+
+using isc::util::OutputBuffer;
+using isc::util::OutputBufferPool;
+
+/// \brief Free list of a thread
+///
+/// The first \c count_ buffers hold the released storage, the remaining
+/// ones are empty.  The buffers are created up front and are never added
+/// or removed, so the storage is only moved by swapping.
+struct FreeList {
+    FreeList() : buffers_(OutputBufferPool::MAX_FREE, OutputBuffer(0)),
+                 count_(0) {
+    }
+
+    std::vector<OutputBuffer> buffers_;
+    size_t count_;
+};
+
+/// \brief Free list of the thread, created on first use.
+__thread FreeList* thread_free_list = NULL;
+
+/// \brief Key whose destructor deletes the free list of an exiting thread.
+pthread_key_t free_list_key;
+
+/// \brief Controls the creation of the key.
+pthread_once_t free_list_key_once = PTHREAD_ONCE_INIT;
+
+/// \brief Deletes the free list of an exiting thread.
+void
+deleteFreeList(void* free_list) {
+    thread_free_list = NULL;
+    delete static_cast<FreeList*>(free_list);
+}
+
+/// \brief Creates the key.
+void
+createFreeListKey() {
+    pthread_key_create(&free_list_key, deleteFreeList);
+}
+
+/// \brief Returns the free list of the thread, creating it if needed.
+FreeList&
+getFreeList() {
+    if (thread_free_list == NULL) {
+        pthread_once(&free_list_key_once, createFreeListKey);
+        thread_free_list = new FreeList();
+        pthread_setspecific(free_list_key, thread_free_list);
+    }
+    return (*thread_free_list);
+}
+
+}
+
+namespace isc {
+namespace util {
+
+const size_t OutputBufferPool::MAX_FREE;
+
+void
+OutputBufferPool::acquire(OutputBuffer& buffer, size_t len) {
+    buffer.clear();
+    if (buffer.getCapacity() >= len) {
+        return;
+    }
+    FreeList& free_list = getFreeList();
+    if (free_list.count_ > 0) {
+        OutputBuffer& spare = free_list.buffers_[--free_list.count_];
+        buffer.swap(spare);
+        buffer.clear();
+        // The smaller storage the buffer had stays on the free list.
+        if (spare.getCapacity() > 0) {
+            ++free_list.count_;
+        }
+    }
+    buffer.reserve(len);
+}
+
+void
+OutputBufferPool::release(OutputBuffer& buffer) {
+    if (buffer.getCapacity() == 0) {
+        return;
+    }
+    FreeList* free_list = thread_free_list;
+    if (free_list == NULL) {
+        try {
+            free_list = &getFreeList();
+        } catch (...) {
+            return;
+        }
+    }
+    if (free_list->count_ < MAX_FREE) {
+        free_list->buffers_[free_list->count_++].swap(buffer);
+    }
+}
+
+size_t
+OutputBufferPool::getFreeCount() {
+    return (getFreeList().count_);
+}
+
+} // namespace util
+} // namespace isc
@@ -0,0 +1,80 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H 1
+
+#include <util/buffer.h>
+
+#include <cstddef>
+
+namespace isc {
+namespace util {
+
+/// \brief Per-thread pool of output buffer storage
+///
+/// The objects which serialize their data into an \c OutputBuffer, like
+/// the DHCP packets, are typically created for a single exchange and then
+/// destroyed, so their buffers are allocated, grown by reallocation while
+/// the data is written and freed over and over again.  This class keeps
+/// the storage of the released buffers on a free list and hands it out to
+/// the buffers acquiring it, so in the steady state the data is written
+/// into a region of adequate size without any allocation.
+///
+/// The storage is moved between the buffers and the pool with
+/// \c OutputBuffer::swap, so neither the data nor the buffer objects are
+/// copied.  Each thread has its own free list, so no locking is needed;
+/// the storage released by a thread is handed out to the buffers acquiring
+/// it in the same thread.  The free list of a thread is deleted when the
+/// thread exits.  The number of entries on each free list is bounded by
+/// \c MAX_FREE; the storage released while the list is full is freed
+/// along with the buffer.
+class OutputBufferPool {
+public:
+    /// \brief Maximum number of entries on the free list of a thread.
+    static const size_t MAX_FREE = 16;
+
+    /// \brief Prepares an empty buffer of at least the specified capacity.
+    ///
+    /// The buffer is cleared.  If its capacity is smaller than \c len,
+    /// it takes the most recently released storage from the free list of
+    /// the thread and, if needed, extends it to \c len bytes.  The data
+    /// of this length can then be written into the buffer without
+    /// reallocation.
+    ///
+    /// \param buffer The buffer to be prepared.
+    /// \param len The expected length of the data to be written.
+    ///
+    /// \throw std::bad_alloc if the buffer cannot be extended.
+    static void acquire(OutputBuffer& buffer, size_t len);
+
+    /// \brief Returns the storage of a buffer to the pool.
+    ///
+    /// The storage is put on the free list of the thread and the buffer
+    /// is left empty with no capacity.  Nothing is done if the buffer has
+    /// no storage or the free list is full.  It never throws, so it may be
+    /// called from destructors.
+    ///
+    /// \param buffer The buffer whose storage is released.
+    static void release(OutputBuffer& buffer);
+
+    /// \brief Returns the number of entries on the free list of the thread.
+    static size_t getFreeCount();
+};
+
+} // namespace util
+} // namespace isc
+
+#endif // BUFFER_POOL_H
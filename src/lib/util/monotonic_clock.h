@@ -0,0 +1,50 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef MONOTONIC_CLOCK_H
+#define MONOTONIC_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+namespace isc {
+namespace util {
+
+/// @brief Returns the value of the monotonic clock in nanoseconds.
+///
+/// The returned value has no relation to the wall clock time. It is only
+/// meaningful when compared with another value returned by this function,
+/// e.g. to measure the duration of an operation. Contrary to the
+/// boost::posix_time clocks, the monotonic clock is not affected by the
+/// adjustments of the system time and it doesn't require any conversions
+/// between the broken down time representations, which makes it suitable
+/// for measurements done on the packet processing path.
+///
+/// @return Number of nanoseconds elapsed since an unspecified point in time.
+inline uint64_t
+getMonotonicNanos() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+            static_cast<uint64_t>(ts.tv_nsec));
+}
+
+} // end of namespace isc::util
+} // end of namespace isc
+
+#endif // MONOTONIC_CLOCK_H
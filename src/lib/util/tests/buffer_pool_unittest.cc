@@ -0,0 +1,103 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <util/buffer_pool.h>
+
+using namespace isc::util;
+
+namespace {
+
+/// \brief Empties the free list of the thread
+void
+drainPool() {
+    while (OutputBufferPool::getFreeCount() > 0) {
+        OutputBuffer buffer(0);
+        OutputBufferPool::acquire(buffer, 1);
+    }
+}
+
+// Check that the released storage is handed out again.
+TEST(OutputBufferPoolTest, reuse) {
+    drainPool();
+
+    OutputBuffer first(0);
+    OutputBufferPool::acquire(first, 500);
+    EXPECT_EQ(500, first.getCapacity());
+    first.writeUint8(1);
+    const void* data = first.getData();
+
+    OutputBufferPool::release(first);
+    EXPECT_EQ(0, first.getCapacity());
+    EXPECT_EQ(0, first.getLength());
+    EXPECT_EQ(1, OutputBufferPool::getFreeCount());
+
+    // The buffer gets the released storage, cleared.
+    OutputBuffer second(0);
+    OutputBufferPool::acquire(second, 300);
+    EXPECT_EQ(data, second.getData());
+    EXPECT_EQ(500, second.getCapacity());
+    EXPECT_EQ(0, second.getLength());
+    EXPECT_EQ(0, OutputBufferPool::getFreeCount());
+
+    // A buffer large enough keeps its own storage.
+    second.writeUint8(1);
+    OutputBufferPool::acquire(second, 400);
+    EXPECT_EQ(data, second.getData());
+    EXPECT_EQ(0, second.getLength());
+
+    OutputBufferPool::release(second);
+    EXPECT_EQ(1, OutputBufferPool::getFreeCount());
+    drainPool();
+}
+
+// Check that the released storage is extended when it is too small and
+// that the smaller storage of the acquiring buffer stays in the pool.
+TEST(OutputBufferPoolTest, extend) {
+    drainPool();
+
+    OutputBuffer released(100);
+    OutputBufferPool::release(released);
+
+    OutputBuffer buffer(10);
+    OutputBufferPool::acquire(buffer, 1000);
+    EXPECT_EQ(1000, buffer.getCapacity());
+    EXPECT_EQ(1, OutputBufferPool::getFreeCount());
+
+    OutputBuffer other(0);
+    OutputBufferPool::acquire(other, 5);
+    EXPECT_EQ(10, other.getCapacity());
+    EXPECT_EQ(0, OutputBufferPool::getFreeCount());
+}
+
+// Check that the number of entries on the free list is bounded and that
+// the buffers without storage are not put on it.
+TEST(OutputBufferPoolTest, bounded) {
+    drainPool();
+
+    OutputBuffer empty(0);
+    OutputBufferPool::release(empty);
+    EXPECT_EQ(0, OutputBufferPool::getFreeCount());
+
+    for (size_t i = 0; i < OutputBufferPool::MAX_FREE + 5; ++i) {
+        OutputBuffer buffer(64);
+        OutputBufferPool::release(buffer);
+    }
+    EXPECT_EQ(OutputBufferPool::MAX_FREE, OutputBufferPool::getFreeCount());
+    drainPool();
+}
+
+}
@@ -309,4 +309,50 @@ TEST_F(BufferTest, inputBufferReadVectorChunks) {
     EXPECT_EQ(0, memcmp(&vec[0], testdata+3, 2));
 }
 
+// Check that reserve() extends the buffer to the exact size and keeps
+// the data.
+TEST_F(BufferTest, outputBufferReserve) {
+    obuffer.reserve(300);
+    EXPECT_EQ(300, obuffer.getCapacity());
+    obuffer.writeUint16(data16);
+    obuffer.reserve(2);
+    EXPECT_EQ(300, obuffer.getCapacity());
+    EXPECT_EQ(2, obuffer.getLength());
+    EXPECT_EQ(2, obuffer[0]);
+    EXPECT_EQ(3, obuffer[1]);
+
+    // No reallocation while writing the reserved length.
+    const void* data = obuffer.getData();
+    std::vector<uint8_t> bytes(298, 1);
+    obuffer.writeData(&bytes[0], bytes.size());
+    EXPECT_EQ(data, obuffer.getData());
+    EXPECT_EQ(300, obuffer.getLength());
+
+    // The data is kept when the buffer is extended.
+    obuffer.reserve(5000);
+    EXPECT_EQ(5000, obuffer.getCapacity());
+    EXPECT_EQ(2, obuffer[0]);
+    EXPECT_EQ(1, obuffer[299]);
+}
+
+// Check that swap() exchanges the storage and the data of the buffers.
+TEST_F(BufferTest, outputBufferSwap) {
+    obuffer.writeUint32(data32);
+    OutputBuffer other(100);
+    other.writeUint8(1);
+    const void* data = obuffer.getData();
+    const void* other_data = other.getData();
+    const size_t capacity = obuffer.getCapacity();
+
+    obuffer.swap(other);
+    EXPECT_EQ(other_data, obuffer.getData());
+    EXPECT_EQ(100, obuffer.getCapacity());
+    ASSERT_EQ(1, obuffer.getLength());
+    EXPECT_EQ(1, obuffer[0]);
+    EXPECT_EQ(data, other.getData());
+    EXPECT_EQ(capacity, other.getCapacity());
+    ASSERT_EQ(4, other.getLength());
+    EXPECT_EQ(7, other[3]);
+}
+
 }